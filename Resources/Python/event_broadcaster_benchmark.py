@@ -0,0 +1,134 @@
+"""
+    Measures EventBroadcaster throughput and latency.
+
+    Subscribes to every event published by an Event Broadcaster and reports
+    events/s and messages/s once per second. Optionally, it also sends
+    numbered messages through a Network Events processor in the same signal
+    chain and times how long each one takes to come back as a MESSAGE event,
+    which gives the end-to-end latency of the chain plus the broadcaster.
+
+    Example, with Network Events on 5556 and Event Broadcaster on 5557:
+
+        python event_broadcaster_benchmark.py --seconds 30 --probe-port 5556
+"""
+
+from __future__ import print_function, unicode_literals
+
+import argparse
+import struct
+import time
+
+import zmq
+
+
+MESSAGE = 5
+PROBE_PREFIX = 'latency_probe '
+
+
+def percentile(values, fraction):
+    if not values:
+        return float('nan')
+    values = sorted(values)
+    return values[min(len(values) - 1, int(fraction * len(values)))]
+
+
+def run(hostname='localhost', port=5557, seconds=10.0, probe_port=None,
+        probe_interval=0.05):
+    with zmq.Context() as ctx:
+        sub = ctx.socket(zmq.SUB)
+        sub.setsockopt(zmq.RCVHWM, 0)
+        sub.setsockopt(zmq.SUBSCRIBE, b'')
+        sub.connect('tcp://%s:%d' % (hostname, port))
+
+        req = None
+        if probe_port is not None:
+            req = ctx.socket(zmq.REQ)
+            req.connect('tcp://%s:%d' % (hostname, probe_port))
+
+        poller = zmq.Poller()
+        poller.register(sub, zmq.POLLIN)
+
+        # give the subscription time to reach the publisher
+        time.sleep(0.5)
+
+        probes_sent = {}
+        latencies = []
+        next_probe = 0
+        total_events = total_messages = 0
+        interval_events = interval_messages = 0
+
+        start = last_report = next_probe_time = time.time()
+        while time.time() - start < seconds:
+            now = time.time()
+
+            if req is not None and now >= next_probe_time:
+                probes_sent[next_probe] = time.time()
+                req.send_string(PROBE_PREFIX + str(next_probe))
+                req.recv()
+                next_probe += 1
+                next_probe_time = now + probe_interval
+
+            if poller.poll(10):
+                while True:
+                    try:
+                        parts = sub.recv_multipart(zmq.NOBLOCK)
+                    except zmq.Again:
+                        break
+
+                    received = time.time()
+                    n = (len(parts) - 1) // 2
+                    interval_events += n
+                    interval_messages += 1
+
+                    if struct.unpack('<H', parts[0][:2])[0] == MESSAGE:
+                        for body in parts[2::2]:
+                            text = body.decode('utf-8', 'ignore')
+                            index = text.find(PROBE_PREFIX)
+                            if index >= 0:
+                                probe = int(text[index + len(PROBE_PREFIX):].split()[0].strip('\0'))
+                                if probe in probes_sent:
+                                    latencies.append(received - probes_sent.pop(probe))
+
+            if now - last_report >= 1.0:
+                elapsed = now - last_report
+                print('%8.0f events/s  %8.0f messages/s' %
+                      (interval_events / elapsed, interval_messages / elapsed))
+                total_events += interval_events
+                total_messages += interval_messages
+                interval_events = interval_messages = 0
+                last_report = now
+
+        total_events += interval_events
+        total_messages += interval_messages
+        elapsed = time.time() - start
+
+        print()
+        print('Events:   %d (%.0f/s)' % (total_events, total_events / elapsed))
+        print('Messages: %d (%.1f events per message)' %
+              (total_messages, float(total_events) / max(1, total_messages)))
+
+        if req is not None:
+            print('Latency:  %d probes, %d lost, median %.2f ms, p99 %.2f ms, max %.2f ms' %
+                  (len(latencies), len(probes_sent),
+                   1000 * percentile(latencies, 0.5),
+                   1000 * percentile(latencies, 0.99),
+                   1000 * max(latencies) if latencies else float('nan')))
+            req.close()
+
+        sub.close()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='EventBroadcaster benchmark')
+    parser.add_argument('--host', default='localhost')
+    parser.add_argument('--port', type=int, default=5557,
+                        help='Event Broadcaster port')
+    parser.add_argument('--seconds', type=float, default=10.0)
+    parser.add_argument('--probe-port', type=int, default=None,
+                        help='Network Events port, to measure latency')
+    parser.add_argument('--probe-interval', type=float, default=0.05,
+                        help='Seconds between latency probes')
+    args = parser.parse_args()
+
+    run(args.host, args.port, args.seconds, args.probe_port,
+        args.probe_interval)
@@ -60,6 +60,30 @@ unpack_spike = unpacker('<2q2x5H3B2fH',
                         )
 
 
+def handle_event(etype, timestamp_seconds, body):
+    if etype == SPIKE:
+        spike, body = unpack_spike(body)
+        print('%g: Spike: %s' % (timestamp_seconds, spike))
+        body = ''  # TODO: unpack other data
+
+    else:
+        header, body = unpack_standard(body)
+
+        if etype == TTL:
+            word, body = unpack_ttl(body)
+            print('%g: TTL: Channel %d: %s' %
+                  (timestamp_seconds,
+                   header['event_channel'] + 1,
+                   'ON' if header['event_id'] else 'OFF'))
+
+        elif etype == MESSAGE:
+            msg, body = body.decode('utf-8'), ''
+            print('%g: Message: %s' % (timestamp_seconds, msg))
+
+    # Check that all data was consumed
+    assert len(body) == 0
+
+
 def run(hostname='localhost', port=5557):
     with zmq.Context() as ctx:
         with ctx.socket(zmq.SUB) as sock:
@@ -70,35 +94,15 @@ def run(hostname='localhost', port=5557):
 
             while True:
                 try:
+                    # A message holds one event type followed by one or more
+                    # (timestamp, body) pairs, batched by the sender thread
                     parts = sock.recv_multipart()
-                    assert len(parts) == 3
-
-                    etype = ord(parts[0])
-                    timestamp_seconds = struct.unpack('d', parts[1])[0]
-                    body = parts[2]
-
-                    if etype == SPIKE:
-                        spike, body = unpack_spike(body)
-                        print('%g: Spike: %s' % (timestamp_seconds, spike))
-                        body = ''  # TODO: unpack other data
-
-                    else:
-                        header, body = unpack_standard(body)
-    
-                        if etype == TTL:
-                            word, body = unpack_ttl(body)
-                            print('%g: TTL: Channel %d: %s' %
-                                  (timestamp_seconds,
-                                   header['event_channel'] + 1,
-                                   'ON' if header['event_id'] else 'OFF'))
-    
-                        elif etype == MESSAGE:
-                            msg, body = body.decode('utf-8'), ''
-                            print('%g: Message: %s' % (timestamp_seconds, msg))
-
-
-                    # Check that all data was consumed
-                    assert len(body) == 0
+                    assert len(parts) % 2 == 1
+
+                    etype = ord(parts[0][:1])
+                    for ts_part, body in izip(parts[1::2], parts[2::2]):
+                        timestamp_seconds = struct.unpack('d', ts_part)[0]
+                        handle_event(etype, timestamp_seconds, body)
 
                 except KeyboardInterrupt:
                     print()  # Add final newline
@@ -0,0 +1,91 @@
+"""
+    Expands compact continuous timestamps back to one timestamp per sample.
+
+    With the "Compact timestamps" option of the Binary and NWB record engines,
+    continuous data is saved with its start and sample rate plus a table of
+    (sample index, timestamp) rows, one for the first sample and one for every
+    sample whose timestamp does not follow the previous one. Timestamps are in
+    source samples.
+
+    Binary format, one folder per continuous stream:
+
+        python expand_timestamps.py path/to/recording1/structure.oebin
+
+    writes a timestamps.npy next to each continuous.dat recorded that way.
+
+    NWB format (needs h5py):
+
+        python expand_timestamps.py path/to/experiment_1.nwb
+
+    prints the expanded timestamps of every continuous series. Use
+    nwb_timestamps() to get them as arrays.
+"""
+
+from __future__ import print_function
+
+import json
+import os
+import sys
+
+import numpy as np
+
+
+def expand(discontinuities, num_samples):
+    """Per sample timestamps from an (N, 2) array of (sample index, timestamp) rows"""
+    discontinuities = np.asarray(discontinuities, dtype=np.int64).reshape(-1, 2)
+    timestamps = np.arange(num_samples, dtype=np.int64)
+    if len(discontinuities) == 0:
+        return timestamps
+
+    starts = discontinuities[:, 0]
+    # every sample is offset by the timestamp of the last discontinuity before it
+    segment = np.searchsorted(starts, timestamps, side='right') - 1
+    segment = np.maximum(segment, 0)
+    return timestamps - starts[segment] + discontinuities[segment, 1]
+
+
+def binary_timestamps(oebin_path):
+    """Yields (folder, timestamps) for every compact continuous stream of a recording"""
+    root = os.path.dirname(os.path.abspath(oebin_path))
+    with open(oebin_path) as f:
+        structure = json.load(f)
+
+    for stream in structure.get('continuous', []):
+        if stream.get('timestamps') != 'compact':
+            continue
+        folder = os.path.join(root, 'continuous', stream['folder_name'])
+        data_size = os.path.getsize(os.path.join(folder, 'continuous.dat'))
+        num_samples = data_size // (2 * stream['num_channels'])
+        table = np.load(os.path.join(folder, 'timestamp_discontinuities.npy'))
+        yield folder, expand(table, num_samples)
+
+
+def nwb_timestamps(nwb_path):
+    """Yields (series path, timestamps in seconds) for every compact continuous series"""
+    import h5py
+
+    with h5py.File(nwb_path, 'r') as f:
+        for recording in f['acquisition/timeseries'].values():
+            for name, series in recording['continuous'].items():
+                if 'oe_timestamp_discontinuities' not in series:
+                    continue
+                rate = float(series['starting_time'].attrs['rate'])
+                table = series['oe_timestamp_discontinuities'][()]
+                num_samples = series['data'].shape[0]
+                yield series.name, expand(table, num_samples) / rate
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        print(__doc__)
+        sys.exit(1)
+
+    path = sys.argv[1]
+    if path.endswith('.nwb'):
+        for name, timestamps in nwb_timestamps(path):
+            print(name, timestamps)
+    else:
+        for folder, timestamps in binary_timestamps(path):
+            out = os.path.join(folder, 'timestamps.npy')
+            np.save(out, timestamps)
+            print('Wrote %d timestamps to %s' % (len(timestamps), out))
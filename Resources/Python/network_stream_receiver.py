@@ -0,0 +1,155 @@
+"""
+    Receives continuous data from a Network Stream processor.
+
+    Subscribes to the stream, checks frame numbers for gaps and reports
+    throughput once per second. When it runs on the same machine as the GUI,
+    it also reports the latency of each frame: the time from the moment the
+    last block of the frame was queued by the processor to its arrival here.
+
+    Each message is one frame:
+
+        header (64 bytes), bitVolts (float32 x channels), samples
+
+    Samples are float32, or int16 in units of bitVolts if flag 1 is set, stored
+    channel after channel. Everything is little-endian.
+
+        python network_stream_receiver.py --port 5560 --seconds 30
+"""
+
+from __future__ import print_function
+
+import argparse
+import struct
+import sys
+import time
+
+import zmq
+
+
+HEADER = struct.Struct('<4sHHIIQqqfIQ8x')
+INT16_SAMPLES = 1
+
+
+def monotonic_ns():
+    """Same clock as the processor: QueryPerformanceCounter on Windows,
+    CLOCK_MONOTONIC elsewhere. None if this Python cannot read it."""
+    if sys.platform == 'win32' and hasattr(time, 'perf_counter_ns'):
+        return time.perf_counter_ns()
+    if hasattr(time, 'monotonic_ns'):
+        return time.monotonic_ns()
+    return None
+
+
+def parse_frame(message):
+    """Returns the header fields as a dict, the bitVolts and the raw samples"""
+    (magic, version, flags, channels, samples, frame_number, first_timestamp,
+     queue_time_ns, sample_rate, blocks, blocks_dropped) = HEADER.unpack_from(message)
+    if magic != b'OECF':
+        raise ValueError('not a Network Stream frame')
+    header = dict(version=version, flags=flags, channels=channels,
+                  samples=samples, frame_number=frame_number,
+                  first_timestamp=first_timestamp, queue_time_ns=queue_time_ns,
+                  sample_rate=sample_rate, blocks=blocks,
+                  blocks_dropped=blocks_dropped)
+    offset = HEADER.size
+    bit_volts = struct.unpack_from('<%df' % channels, message, offset)
+    offset += 4 * channels
+    return header, bit_volts, message[offset:]
+
+
+def percentile(values, fraction):
+    if not values:
+        return float('nan')
+    values = sorted(values)
+    return values[min(len(values) - 1, int(fraction * len(values)))]
+
+
+def run(hostname='localhost', port=5560, seconds=10.0, measure_latency=True):
+    with zmq.Context() as ctx:
+        sub = ctx.socket(zmq.SUB)
+        sub.setsockopt(zmq.RCVHWM, 0)
+        sub.setsockopt(zmq.SUBSCRIBE, b'')
+        sub.connect('tcp://%s:%d' % (hostname, port))
+
+        latencies = []
+        expected_frame = None
+        frames_missed = 0
+        blocks_dropped = 0
+        total_frames = total_bytes = total_samples = 0
+        interval_frames = interval_bytes = interval_samples = 0
+        header = None
+
+        start = last_report = time.time()
+        while time.time() - start < seconds:
+            if sub.poll(100):
+                message = sub.recv(copy=True)
+                received_ns = monotonic_ns() if measure_latency else None
+                header, bit_volts, data = parse_frame(message)
+
+                if received_ns is not None:
+                    latencies.append((received_ns - header['queue_time_ns']) / 1e6)
+
+                frame_number = header['frame_number']
+                if expected_frame is not None and frame_number > expected_frame:
+                    frames_missed += frame_number - expected_frame
+                expected_frame = frame_number + 1
+                blocks_dropped = header['blocks_dropped']
+
+                sample_size = 2 if header['flags'] & INT16_SAMPLES else 4
+                if len(data) != header['channels'] * header['samples'] * sample_size:
+                    print('Frame %d has %d bytes of samples, expected %d' %
+                          (frame_number, len(data),
+                           header['channels'] * header['samples'] * sample_size))
+
+                interval_frames += 1
+                interval_bytes += len(message)
+                interval_samples += header['samples']
+
+            now = time.time()
+            if now - last_report >= 1.0:
+                elapsed = now - last_report
+                print('%7.0f frames/s  %8.2f MB/s  %9.0f samples/s' %
+                      (interval_frames / elapsed, interval_bytes / elapsed / 1e6,
+                       interval_samples / elapsed))
+                total_frames += interval_frames
+                total_bytes += interval_bytes
+                total_samples += interval_samples
+                interval_frames = interval_bytes = interval_samples = 0
+                last_report = now
+
+        total_frames += interval_frames
+        total_bytes += interval_bytes
+        total_samples += interval_samples
+        elapsed = time.time() - start
+
+        print()
+        if header is None:
+            print('No frames received. Is acquisition running?')
+        else:
+            print('Stream:   %d channels at %g Hz, %s, %d blocks per frame' %
+                  (header['channels'], header['sample_rate'],
+                   'int16' if header['flags'] & INT16_SAMPLES else 'float32',
+                   header['blocks']))
+            print('Frames:   %d (%.1f MB/s), %d missed by the network, %d blocks dropped by the sender' %
+                  (total_frames, total_bytes / elapsed / 1e6, frames_missed,
+                   blocks_dropped))
+            print('Samples:  %d per channel' % total_samples)
+            if latencies:
+                print('Latency:  median %.3f ms, p99 %.3f ms, max %.3f ms' %
+                      (percentile(latencies, 0.5), percentile(latencies, 0.99),
+                       max(latencies)))
+
+        sub.close()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Network Stream receiver')
+    parser.add_argument('--host', default='localhost')
+    parser.add_argument('--port', type=int, default=5560,
+                        help='Network Stream port')
+    parser.add_argument('--seconds', type=float, default=10.0)
+    parser.add_argument('--no-latency', action='store_true',
+                        help='Do not report latency, e.g. when the GUI runs on another machine')
+    args = parser.parse_args()
+
+    run(args.host, args.port, args.seconds, not args.no_latency)
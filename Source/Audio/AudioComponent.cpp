@@ -25,8 +25,12 @@
 #include "AudioComponent.h"
 #include <stdio.h>
 
-AudioComponent::AudioComponent() : isPlaying(false)
+AudioComponent::AudioComponent(AudioIODeviceType* deviceType) : isPlaying(false)
 {
+    // the system device types are only created if none was added before initialising
+    if (deviceType != nullptr)
+        deviceManager.addAudioDeviceType(deviceType);
+
     bool initialized = false;
     while (!initialized)
     {
@@ -47,8 +47,11 @@ class AudioComponent
 
 public:
     /** Constructor. Finds the audio component (if there is one), and sets the
-    default sample rate and buffer size.*/
-    AudioComponent();
+    default sample rate and buffer size.
+
+    If a device type is given, the AudioComponent takes ownership of it and uses it
+    instead of the system audio devices (e.g. an OfflineAudioDeviceType).*/
+    AudioComponent(AudioIODeviceType* deviceType = nullptr);
     ~AudioComponent();
 
     /** Begins the audio callbacks that drive data acquisition.*/
@@ -0,0 +1,238 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "OfflineAudioDevice.h"
+
+OfflineAudioDevice::OfflineAudioDevice(const String& deviceName, bool realTime)
+	: AudioIODevice(deviceName, "Offline"),
+	Thread("Offline audio device"),
+	m_realTime(realTime),
+	m_isOpen(false),
+	m_sampleRate(44100.0),
+	m_bufferSize(1024),
+	m_callback(nullptr)
+{
+}
+
+OfflineAudioDevice::~OfflineAudioDevice()
+{
+	close();
+}
+
+StringArray OfflineAudioDevice::getOutputChannelNames()
+{
+	StringArray names;
+	for (int i = 0; i < numOutputChannels; i++)
+		names.add("Output " + String(i + 1));
+	return names;
+}
+
+StringArray OfflineAudioDevice::getInputChannelNames()
+{
+	return StringArray();
+}
+
+Array<double> OfflineAudioDevice::getAvailableSampleRates()
+{
+	Array<double> rates;
+	rates.add(44100.0);
+	rates.add(48000.0);
+	rates.add(96000.0);
+	return rates;
+}
+
+Array<int> OfflineAudioDevice::getAvailableBufferSizes()
+{
+	Array<int> sizes;
+	for (int size = 64; size <= 4096; size *= 2)
+		sizes.add(size);
+	return sizes;
+}
+
+int OfflineAudioDevice::getDefaultBufferSize()
+{
+	return 1024;
+}
+
+String OfflineAudioDevice::open(const BigInteger& inputChannels, const BigInteger& outputChannels, double sampleRate, int bufferSizeSamples)
+{
+	close();
+
+	m_sampleRate = sampleRate > 0 ? sampleRate : 44100.0;
+	m_bufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+	m_outputChannels.clear();
+	for (int i = 0; i < numOutputChannels; i++)
+		m_outputChannels.setBit(i, outputChannels[i]);
+	m_outputBuffer.setSize(m_outputChannels.countNumberOfSetBits(), m_bufferSize);
+	m_isOpen = true;
+
+	return String::empty;
+}
+
+void OfflineAudioDevice::close()
+{
+	stop();
+	m_isOpen = false;
+}
+
+bool OfflineAudioDevice::isOpen()
+{
+	return m_isOpen;
+}
+
+void OfflineAudioDevice::start(AudioIODeviceCallback* callback)
+{
+	if (!m_isOpen || callback == nullptr || isThreadRunning())
+		return;
+
+	m_callback = callback;
+	m_callback->audioDeviceAboutToStart(this);
+	startThread(9);
+}
+
+void OfflineAudioDevice::stop()
+{
+	if (!isThreadRunning())
+		return;
+
+	stopThread(2000);
+	if (m_callback != nullptr)
+		m_callback->audioDeviceStopped();
+	m_callback = nullptr;
+}
+
+bool OfflineAudioDevice::isPlaying()
+{
+	return isThreadRunning();
+}
+
+void OfflineAudioDevice::run()
+{
+	//Blocks are scheduled against the start time, so an occasional long callback is caught up
+	//afterwards instead of slowing down the average rate
+	const double ticksPerBlock = Time::getHighResolutionTicksPerSecond() * m_bufferSize / m_sampleRate;
+	const int64 startTicks = Time::getHighResolutionTicks();
+	int64 numBlocks = 0;
+
+	while (!threadShouldExit())
+	{
+		m_outputBuffer.clear();
+		m_callback->audioDeviceIOCallback(nullptr, 0, m_outputBuffer.getArrayOfWritePointers(), m_outputBuffer.getNumChannels(), m_bufferSize);
+		numBlocks++;
+
+		if (m_realTime)
+		{
+			const int64 due = startTicks + int64(numBlocks * ticksPerBlock);
+			const double remaining = Time::highResolutionTicksToSeconds(due - Time::getHighResolutionTicks()) * 1000.0;
+			if (remaining >= 1.0)
+				wait(int(remaining));
+		}
+	}
+}
+
+String OfflineAudioDevice::getLastError()
+{
+	return String::empty;
+}
+
+int OfflineAudioDevice::getCurrentBufferSizeSamples()
+{
+	return m_bufferSize;
+}
+
+double OfflineAudioDevice::getCurrentSampleRate()
+{
+	return m_sampleRate;
+}
+
+int OfflineAudioDevice::getCurrentBitDepth()
+{
+	return 32;
+}
+
+BigInteger OfflineAudioDevice::getActiveOutputChannels() const
+{
+	return m_outputChannels;
+}
+
+BigInteger OfflineAudioDevice::getActiveInputChannels() const
+{
+	return BigInteger();
+}
+
+int OfflineAudioDevice::getOutputLatencyInSamples()
+{
+	return 0;
+}
+
+int OfflineAudioDevice::getInputLatencyInSamples()
+{
+	return 0;
+}
+
+OfflineAudioDeviceType::OfflineAudioDeviceType(bool realTime)
+	: AudioIODeviceType("Offline"),
+	m_realTime(realTime)
+{
+}
+
+OfflineAudioDeviceType::~OfflineAudioDeviceType()
+{
+}
+
+void OfflineAudioDeviceType::scanForDevices()
+{
+}
+
+StringArray OfflineAudioDeviceType::getDeviceNames(bool wantInputNames) const
+{
+	StringArray names;
+	if (!wantInputNames)
+		names.add(m_realTime ? "Offline clock" : "Offline, unthrottled");
+	return names;
+}
+
+int OfflineAudioDeviceType::getDefaultDeviceIndex(bool forInput) const
+{
+	return forInput ? -1 : 0;
+}
+
+int OfflineAudioDeviceType::getIndexOfDevice(AudioIODevice* device, bool asInput) const
+{
+	if (asInput || dynamic_cast<OfflineAudioDevice*>(device) == nullptr)
+		return -1;
+	return 0;
+}
+
+bool OfflineAudioDeviceType::hasSeparateInputsAndOutputs() const
+{
+	return false;
+}
+
+AudioIODevice* OfflineAudioDeviceType::createDevice(const String& outputDeviceName, const String& inputDeviceName)
+{
+	if (outputDeviceName.isNotEmpty() && !getDeviceNames().contains(outputDeviceName))
+		return nullptr;
+
+	return new OfflineAudioDevice(getDeviceNames()[0], m_realTime);
+}
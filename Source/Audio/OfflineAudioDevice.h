@@ -0,0 +1,111 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef OFFLINEAUDIODEVICE_H_INCLUDED
+#define OFFLINEAUDIODEVICE_H_INCLUDED
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Audio device that is not backed by any hardware.
+
+	A thread calls the audio callback with silent buffers, either at the pace a
+	real device with the same sample rate and buffer size would, or back to back
+	as fast as the callback returns. Output is discarded.
+
+	Used to drive the ProcessorGraph when running headless.
+
+	@see OfflineAudioDeviceType, AudioComponent
+*/
+class OfflineAudioDevice : public AudioIODevice, private Thread
+{
+public:
+	OfflineAudioDevice(const String& deviceName, bool realTime);
+	~OfflineAudioDevice();
+
+	StringArray getOutputChannelNames() override;
+	StringArray getInputChannelNames() override;
+	Array<double> getAvailableSampleRates() override;
+	Array<int> getAvailableBufferSizes() override;
+	int getDefaultBufferSize() override;
+
+	String open(const BigInteger& inputChannels, const BigInteger& outputChannels, double sampleRate, int bufferSizeSamples) override;
+	void close() override;
+	bool isOpen() override;
+
+	void start(AudioIODeviceCallback* callback) override;
+	void stop() override;
+	bool isPlaying() override;
+
+	String getLastError() override;
+	int getCurrentBufferSizeSamples() override;
+	double getCurrentSampleRate() override;
+	int getCurrentBitDepth() override;
+	BigInteger getActiveOutputChannels() const override;
+	BigInteger getActiveInputChannels() const override;
+	int getOutputLatencyInSamples() override;
+	int getInputLatencyInSamples() override;
+
+private:
+	void run() override;
+
+	const bool m_realTime;
+	bool m_isOpen;
+	double m_sampleRate;
+	int m_bufferSize;
+	BigInteger m_outputChannels;
+	AudioSampleBuffer m_outputBuffer;
+	AudioIODeviceCallback* m_callback;
+
+	static const int numOutputChannels = 2;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineAudioDevice);
+};
+
+/**
+	Device type exposing a single OfflineAudioDevice.
+
+	Registering it in an AudioDeviceManager before initialise() makes it the only
+	device type available, so no sound card is ever opened.
+*/
+class OfflineAudioDeviceType : public AudioIODeviceType
+{
+public:
+	/** If realTime is false, created devices run the callback back to back */
+	OfflineAudioDeviceType(bool realTime);
+	~OfflineAudioDeviceType();
+
+	void scanForDevices() override;
+	StringArray getDeviceNames(bool wantInputNames = false) const override;
+	int getDefaultDeviceIndex(bool forInput) const override;
+	int getIndexOfDevice(AudioIODevice* device, bool asInput) const override;
+	bool hasSeparateInputsAndOutputs() const override;
+	AudioIODevice* createDevice(const String& outputDeviceName, const String& inputDeviceName) override;
+
+private:
+	const bool m_realTime;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineAudioDeviceType);
+};
+
+#endif  // OFFLINEAUDIODEVICE_H_INCLUDED
@@ -85,7 +85,25 @@ public:
         customLookAndFeel = new CustomLookAndFeel();
         LookAndFeel::setDefaultLookAndFeel(customLookAndFeel);
 
-        mainWindow = new MainWindow();
+        if (PipelineBenchmark::isRequested(parameters))
+        {
+            PipelineBenchmark::Settings settings;
+            String error;
+
+            if (!PipelineBenchmark::parseCommandLine(parameters, settings, error))
+            {
+                std::cerr << error << std::endl << PipelineBenchmark::getUsage() << std::endl;
+                setApplicationReturnValue(1);
+                quit();
+                return;
+            }
+
+            mainWindow = new MainWindow(&settings);
+        }
+        else
+        {
+            mainWindow = new MainWindow();
+        }
 
 
 
@@ -24,6 +24,7 @@
 #include "MainWindow.h"
 #include "UI/UIComponent.h"
 #include "UI/EditorViewport.h"
+#include "Audio/OfflineAudioDevice.h"
 #include <stdio.h>
 //-----------------------------------------------------------------------
 
@@ -39,10 +40,11 @@ static inline File getSavedStateDirectory() {
 #endif
 }
 
-	MainWindow::MainWindow()
+	MainWindow::MainWindow(const PipelineBenchmark::Settings* benchmarkSettings)
 : DocumentWindow(JUCEApplication::getInstance()->getApplicationName(),
 		Colour(Colours::black),
-		DocumentWindow::allButtons)
+		DocumentWindow::allButtons),
+		isHeadless(benchmarkSettings != nullptr)
 {
 
 	setResizable(true,      // isResizable
@@ -58,7 +60,10 @@ static inline File getSavedStateDirectory() {
 	std::cout << "Created processor graph." << std::endl;
 	std::cout << std::endl;
 
-	audioComponent = new AudioComponent();
+	if (isHeadless)
+		audioComponent = new AudioComponent(new OfflineAudioDeviceType(benchmarkSettings->realTime));
+	else
+		audioComponent = new AudioComponent();
 	std::cout << "Created audio component." << std::endl;
 
 	audioComponent->connectToProcessorGraph(processorGraph);
@@ -75,6 +80,14 @@ static inline File getSavedStateDirectory() {
 	addKeyListener(commandManager.getKeyMappings());
 
 	loadWindowBounds();
+
+	if (isHeadless)
+	{
+		benchmark = new PipelineBenchmark(*benchmarkSettings);
+		benchmark->start();
+		return;
+	}
+
 	setUsingNativeTitleBar(true);
 	Component::addToDesktop(getDesktopWindowStyleFlags());  // prevents the maximize
 	// button from randomly disappearing
@@ -86,7 +99,7 @@ static inline File getSavedStateDirectory() {
 	if (shouldReloadOnStartup)
 	{
 		File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
-		ui->getEditorViewport()->loadState(file);
+		ui->getEditorViewport()->loadStateAsync(file);
 	}
 
 
@@ -95,6 +108,7 @@ static inline File getSavedStateDirectory() {
 
 MainWindow::~MainWindow()
 {
+	benchmark = nullptr;
 
 	if (audioComponent->callbacksAreActive())
 	{
@@ -102,14 +116,19 @@ MainWindow::~MainWindow()
 		processorGraph->disableProcessors();
 	}
 
-	saveWindowBounds();
+	// a benchmark run must not overwrite the user's window state or last configuration
+	if (!isHeadless)
+		saveWindowBounds();
 
 	audioComponent->disconnectProcessorGraph();
 	UIComponent* ui = (UIComponent*) getContentComponent();
 	ui->disableDataViewport();
 
-	File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
-	ui->getEditorViewport()->saveState(file);
+	if (!isHeadless)
+	{
+		File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
+		ui->getEditorViewport()->saveState(file);
+	}
 
 	setMenuBar(0);
 
@@ -28,6 +28,7 @@
 #include "UI/UIComponent.h"
 #include "Audio/AudioComponent.h"
 #include "Processors/ProcessorGraph/ProcessorGraph.h"
+#include "Utils/PipelineBenchmark.h"
 
 /**
   The main window for the GUI application.
@@ -45,8 +46,11 @@ class MainWindow   : public DocumentWindow
 public:
 
     /** Initializes the MainWindow, creates the AudioComponent, ProcessorGraph,
-        and UIComponent, and sets the window boundaries. */
-    MainWindow();
+        and UIComponent, and sets the window boundaries.
+
+        If benchmark settings are given, the window stays hidden, the graph is driven
+        by an offline audio device and a PipelineBenchmark is started. */
+    MainWindow(const PipelineBenchmark::Settings* benchmarkSettings = nullptr);
 
     /** Destroys the AudioComponent, ProcessorGraph, and UIComponent, and saves the window boundaries. */
     ~MainWindow();
@@ -78,6 +82,12 @@ private:
     /** A pointer to the application's ProcessorGraph (owned by the MainWindow). */
     ScopedPointer<ProcessorGraph> processorGraph;
 
+    /** True when running a benchmark without showing the window. */
+    const bool isHeadless;
+
+    /** The benchmark being run, if any. */
+    ScopedPointer<PipelineBenchmark> benchmark;
+
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
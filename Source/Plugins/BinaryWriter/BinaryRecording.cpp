@@ -27,7 +27,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 using namespace BinaryRecordingEngine;
 
-BinaryRecording::BinaryRecording()
+BinaryRecording::BinaryRecording() : BinaryRecording(false)
+{
+}
+
+BinaryRecording::BinaryRecording(bool compressContinuous) :
+m_compressContinuous(compressContinuous)
 {
     m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
     m_intBuffer.malloc(MAX_BUFFER_SIZE);
@@ -75,6 +80,7 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
 
     Array<const DataChannel*> indexedDataChannels;
     Array<unsigned int> indexedChannelCount;
+    Array<int> indexedFirstChannels;
     Array<var> jsonContinuousfiles;
     Array<var> jsonChannels;
     StringArray continuousFileNames;
@@ -119,15 +125,23 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
             if (!found)
             {
                 String datPath = getProcessorString(channelInfo);
-                continuousFileNames.add(contPath + datPath + "continuous.dat");
-
-                ScopedPointer<NpyFile> tFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::INT64,1));
+                continuousFileNames.add(contPath + datPath + (m_compressContinuous ? "continuous.oecd" : "continuous.dat"));
+
+                //compact timestamps only store (sample index, timestamp) rows where the timestamps jump
+                ScopedPointer<NpyFile> tFile;
+                if (m_compactTimestamps)
+                    tFile = new NpyFile(contPath + datPath + "timestamp_discontinuities.npy", NpyType(BaseType::INT64, 2));
+                else
+                    tFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::INT64,1));
                 m_dataTimestampFiles.add(tFile.release());
+                m_nextTimestamps.add(0);
+                m_writtenSamples.add(0);
 
                 m_fileIndexes.set(recordedChan, nInfoArrays);
                 m_channelIndexes.set(recordedChan, 0);
                 indexedChannelCount.add(1);
                 indexedDataChannels.add(channelInfo);
+                indexedFirstChannels.add(recordedChan);
 
                 Array<var> jsonChanArray;
                 jsonChanArray.add(var(jsonChan));
@@ -140,23 +154,54 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
                 jsonFile->setProperty("source_processor_sub_idx", channelInfo->getSubProcessorIdx());
                 jsonFile->setProperty("recorded_processor", channelInfo->getCurrentNodeName());
                 jsonFile->setProperty("recorded_processor_id", channelInfo->getCurrentNodeID());
+                if (m_compactTimestamps)
+                {
+                    jsonFile->setProperty("timestamps", "compact");
+                    jsonFile->setProperty("start_timestamp", getTimestamp(recordedChan));
+                }
                 jsonContinuousfiles.add(var(jsonFile));
             }
         }
         lastId = indexedDataChannels.size();
     }
     int nFiles = continuousFileNames.size();
+    if (m_compressContinuous)
+        m_compressionPool = new ThreadPool(m_compressionThreads);
     for (int i = 0; i < nFiles; i++)
     {
         int numChannels = jsonChannels.getReference(i).size();
-        ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
-        if (bFile->openFile(continuousFileNames[i]))
-            m_DataFiles.add(bFile.release());
+        if (m_compressContinuous)
+        {
+            m_compressedFiles.add(new CompressedBlockFile(numChannels, compressedSamplesPerBlock, m_compressionPool));
+        }
         else
-            m_DataFiles.add(nullptr);
+        {
+            ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
+            if (bFile->openFile(continuousFileNames[i]))
+                m_DataFiles.add(bFile.release());
+            else
+                m_DataFiles.add(nullptr);
+        }
         DynamicObject::Ptr jsonFile = jsonContinuousfiles.getReference(i).getDynamicObject();
         jsonFile->setProperty("num_channels", numChannels);
         jsonFile->setProperty("channels", jsonChannels.getReference(i));
+        if (m_compressContinuous)
+            jsonFile->setProperty("compressed", true);
+    }
+    if (m_compressContinuous)
+    {
+        //compressed files are self-contained, so their header repeats the basic channel information
+        int nRecordedChannels = getNumRecordedChannels();
+        for (int i = 0; i < nRecordedChannels; i++)
+        {
+            const DataChannel* channelInfo = getDataChannel(getRealChannel(i));
+            m_compressedFiles[m_fileIndexes[i]]->setChannelInfo(m_channelIndexes[i], channelInfo->getName(), channelInfo->getBitVolts());
+        }
+        for (int i = 0; i < nFiles; i++)
+        {
+            m_compressedFiles[i]->openFile(continuousFileNames[i], indexedDataChannels[i]->getSampleRate(),
+                                           getTimestamp(indexedFirstChannels[i]));
+        }
     }
 
     int nChans = getNumRecordedChannels();
@@ -456,9 +501,14 @@ void BinaryRecording::closeFiles()
 void BinaryRecording::resetChannels()
 {
     m_DataFiles.clear();
+    //compressed files wait for their pending blocks when deleted, so they go before the pool
+    m_compressedFiles.clear();
+    m_compressionPool = nullptr;
     m_channelIndexes.clear();
     m_fileIndexes.clear();
     m_dataTimestampFiles.clear();
+    m_nextTimestamps.clear();
+    m_writtenSamples.clear();
     m_eventFiles.clear();
     m_spikeChannelIndexes.clear();
     m_spikeFileIndexes.clear();
@@ -490,11 +540,30 @@ void BinaryRecording::writeData(int writeChannel, int realChannel, const float*
     AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(),
                                                size);
     int fileIndex = m_fileIndexes[writeChannel];
-    m_DataFiles[fileIndex]->writeChannel(getTimestamp(writeChannel) - m_startTS[writeChannel],
-                                         m_channelIndexes[writeChannel],
-                                         m_intBuffer.getData(), size);
+    if (m_compressContinuous)
+        m_compressedFiles[fileIndex]->writeChannel(getTimestamp(writeChannel) - m_startTS[writeChannel],
+                                                   m_channelIndexes[writeChannel],
+                                                   m_intBuffer.getData(), size);
+    else
+        m_DataFiles[fileIndex]->writeChannel(getTimestamp(writeChannel) - m_startTS[writeChannel],
+                                             m_channelIndexes[writeChannel],
+                                             m_intBuffer.getData(), size);
 
-    if (m_channelIndexes[writeChannel] == 0)
+    if (m_channelIndexes[writeChannel] == 0 && m_compactTimestamps)
+    {
+        // the sample rate is implicit, so only blocks that don't start where the previous one ended are written
+        int64 baseTS = getTimestamp(writeChannel);
+        int64 written = m_writtenSamples[fileIndex];
+        if (written == 0 || baseTS != m_nextTimestamps[fileIndex])
+        {
+            int64 row[2] = { written, baseTS };
+            m_dataTimestampFiles[fileIndex]->writeData(row, sizeof(row));
+            m_dataTimestampFiles[fileIndex]->increaseRecordCount();
+        }
+        m_nextTimestamps.set(fileIndex, baseTS + size);
+        m_writtenSamples.set(fileIndex, written + size);
+    }
+    else if (m_channelIndexes[writeChannel] == 0)
     {
         int64 baseTS = getTimestamp(writeChannel);
         //Let's hope that the compiler is smart enough to vectorize this.
@@ -552,6 +621,31 @@ void BinaryRecording::writeEvent(int eventIndex, const MidiMessage& event)
     increaseEventCounts(rec);
 }
 
+void BinaryRecording::writeTTLWordChange(int eventIndex, const TTLWordChange& change)
+{
+    //Same rows as the TTL event of each changed bit, read straight from the word
+    EventRecording* rec = m_eventFiles[eventIndex];
+    if (!rec) return;
+    const EventChannel* info = getEventChannel(eventIndex);
+    int64 ts = change.getTimestamp();
+    uint64 word = change.getWord();
+
+    for (int bit = change.getNextChangedBit(-1); bit >= 0; bit = change.getNextChangedBit(bit))
+    {
+        rec->timestampFile->writeData(&ts, sizeof(int64));
+
+        uint16 chan = bit + 1;
+        rec->channelFile->writeData(&chan, sizeof(uint16));
+
+        int16 data = (bit + 1) * (change.getState(bit) ? 1 : -1);
+        rec->mainFile->writeData(&data, sizeof(int16));
+        if (rec->extraFile)
+            rec->extraFile->writeData(&word, info->getDataSize());
+
+        increaseEventCounts(rec);
+    }
+}
+
 void BinaryRecording::writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx,
                                              int64 timestamp, float, String text)
 {
@@ -611,12 +705,16 @@ RecordEngineManager* BinaryRecording::getEngineManager()
     EngineParameter* param;
     param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
     man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 1, "Compact timestamps", false);
+    man->addParameter(param);
     return man;
 }
 
 void BinaryRecording::setParameter(EngineParameter& parameter)
 {
     boolParameter(0, m_saveTTLWords);
+    boolParameter(1, m_compactTimestamps);
+    intParameter(2, m_compressionThreads);
 }
 
 String BinaryRecording::jsonTypeValue(BaseType type)
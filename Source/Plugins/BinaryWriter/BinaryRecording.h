@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <RecordingLib.h>
 #include "SequentialBlockFile.h"
+#include "CompressedBlockFile.h"
 #include "NpyFile.h"
 
 namespace BinaryRecordingEngine
@@ -41,6 +42,7 @@ namespace BinaryRecordingEngine
         void closeFiles() override;
         void writeData(int writeChannel, int realChannel, const float* buffer, int size) override;
         void writeEvent(int eventIndex, const MidiMessage& event) override;
+        void writeTTLWordChange(int eventIndex, const TTLWordChange& change) override;
         void resetChannels() override;
         void addSpikeElectrode(int index, const SpikeChannel* elec) override;
         void writeSpike(int electrodeIndex, const SpikeEvent* spike) override;
@@ -49,6 +51,10 @@ namespace BinaryRecordingEngine
 
         static RecordEngineManager* getEngineManager();
 
+    protected:
+        /** With compressContinuous, continuous data goes to compressed .oecd files instead of .dat ones */
+        explicit BinaryRecording(bool compressContinuous);
+
     private:
 
         class EventRecording
@@ -70,6 +76,9 @@ namespace BinaryRecordingEngine
         static String getProcessorString(const InfoObjectCommon* channelInfo);
 
         bool m_saveTTLWords{ true };
+        bool m_compactTimestamps{ false };
+        const bool m_compressContinuous;
+        int m_compressionThreads{ 2 };
 
         HeapBlock<float> m_scaledBuffer;
         HeapBlock<int16> m_intBuffer;
@@ -77,11 +86,16 @@ namespace BinaryRecordingEngine
         int m_bufferSize;
 
         OwnedArray<SequentialBlockFile> m_DataFiles;
+        ScopedPointer<ThreadPool> m_compressionPool;
+        OwnedArray<CompressedBlockFile> m_compressedFiles;
         Array<unsigned int> m_channelIndexes;
         Array<unsigned int> m_fileIndexes;
         OwnedArray<EventRecording> m_eventFiles;
         OwnedArray<EventRecording> m_spikeFiles;
         OwnedArray<NpyFile> m_dataTimestampFiles;
+        //per continuous file, for compact timestamps
+        Array<int64> m_nextTimestamps;
+        Array<int64> m_writtenSamples;
         ScopedPointer<FileOutputStream> m_syncTextFile;
 
         Array<unsigned int> m_spikeFileIndexes;
@@ -93,6 +107,7 @@ namespace BinaryRecordingEngine
 
         //Compile-time constants
         const int samplesPerBlock{ 4096 };
+        const int compressedSamplesPerBlock{ 1024 };
 
     };
 
@@ -0,0 +1,375 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BlockCompressor.h"
+
+using namespace BinaryRecordingEngine;
+
+// residuals of int16 samples with an order 2 predictor need at most 18 bits
+#define MAX_RESIDUAL_BITS 20
+#define PACKED_GROUP_SIZE 64
+#define PACKED_WIDTH_BITS 5
+// Rice quotients this large are replaced by a raw residual
+#define RICE_ESCAPE 16
+#define MAX_RICE_K 18
+#define HEADER_SIZE 2
+
+namespace
+{
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8* dest) : m_dest(dest) {}
+
+        void put(uint32 value, int bits)
+        {
+            m_acc |= uint64(value) << m_numBits;
+            m_numBits += bits;
+            while (m_numBits >= 8)
+            {
+                m_dest[m_pos++] = uint8(m_acc);
+                m_acc >>= 8;
+                m_numBits -= 8;
+            }
+        }
+
+        void putOnes(int count)
+        {
+            while (count > 0)
+            {
+                int bits = jmin(count, 24);
+                put((1u << bits) - 1, bits);
+                count -= bits;
+            }
+        }
+
+        int finish()
+        {
+            if (m_numBits > 0)
+                m_dest[m_pos++] = uint8(m_acc);
+            m_acc = 0;
+            m_numBits = 0;
+            return m_pos;
+        }
+
+    private:
+        uint8* const m_dest;
+        int m_pos{ 0 };
+        uint64 m_acc{ 0 };
+        int m_numBits{ 0 };
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8* source, int size) : m_source(source), m_size(size) {}
+
+        bool get(int bits, uint32& value)
+        {
+            while (m_numBits < bits)
+            {
+                if (m_pos >= m_size)
+                    return false;
+                m_acc |= uint64(m_source[m_pos++]) << m_numBits;
+                m_numBits += 8;
+            }
+            value = uint32(m_acc & ((uint64(1) << bits) - 1));
+            m_acc >>= bits;
+            m_numBits -= bits;
+            return true;
+        }
+
+        /** Counts ones up to the first zero, which is consumed, or up to max ones */
+        bool getOnes(int max, int& count)
+        {
+            count = 0;
+            uint32 bit;
+            while (count < max)
+            {
+                if (!get(1, bit))
+                    return false;
+                if (bit == 0)
+                    return true;
+                count++;
+            }
+            return true;
+        }
+
+    private:
+        const uint8* const m_source;
+        const int m_size;
+        int m_pos{ 0 };
+        uint64 m_acc{ 0 };
+        int m_numBits{ 0 };
+    };
+
+    inline int bitWidth(uint32 value)
+    {
+        int bits = 0;
+        while (value != 0)
+        {
+            value >>= 1;
+            bits++;
+        }
+        return bits;
+    }
+
+    inline void writeInt16(uint8* dest, int16 value)
+    {
+        dest[0] = uint8(value);
+        dest[1] = uint8(uint16(value) >> 8);
+    }
+
+    inline int16 readInt16(const uint8* source)
+    {
+        return int16(uint16(source[0]) | (uint16(source[1]) << 8));
+    }
+}
+
+BlockCompressor::BlockCompressor(int maxSamples) :
+m_maxSamples(maxSamples)
+{
+    m_residuals.malloc(maxSamples);
+}
+
+BlockCompressor::~BlockCompressor()
+{
+}
+
+int BlockCompressor::getMaxCompressedSize(int numSamples)
+{
+    return HEADER_SIZE + numSamples * sizeof(int16);
+}
+
+int BlockCompressor::compress(const int16* samples, int numSamples, uint8* dest)
+{
+    jassert(numSamples <= m_maxSamples);
+
+    //Choose the predictor with the smallest sum of absolute residuals
+    int64 cost[3] = { 0, 0, 0 };
+    for (int i = 0; i < jmin(2, numSamples); i++)
+        cost[0] += std::abs(int32(samples[i]));
+    if (numSamples > 1)
+        cost[1] += std::abs(samples[1] - samples[0]);
+    for (int i = 2; i < numSamples; i++)
+    {
+        int32 x = samples[i];
+        int32 delta = x - samples[i - 1];
+        cost[0] += std::abs(x);
+        cost[1] += std::abs(delta);
+        cost[2] += std::abs(delta - samples[i - 1] + samples[i - 2]);
+    }
+    int order = 0;
+    for (int o = 1; o <= 2 && o < numSamples; o++)
+    {
+        if (cost[o] < cost[order])
+            order = o;
+    }
+
+    //Zigzag encoded residuals
+    int numResiduals = numSamples - order;
+    uint64 sum = 0;
+    for (int i = order; i < numSamples; i++)
+    {
+        int32 prediction = 0;
+        if (order == 1)
+            prediction = samples[i - 1];
+        else if (order == 2)
+            prediction = 2 * samples[i - 1] - samples[i - 2];
+        int32 residual = samples[i] - prediction;
+        uint32 u = (uint32(residual) << 1) ^ uint32(residual >> 31);
+        m_residuals[i - order] = u;
+        sum += u;
+    }
+
+    //Pick the Rice parameter around log2 of the mean, then the smallest coder
+    int k = 0;
+    if (numResiduals > 0)
+    {
+        uint64 mean = sum / numResiduals;
+        while (k < MAX_RICE_K && (uint64(1) << (k + 1)) <= mean)
+            k++;
+    }
+    int64 riceBits = getRiceBits(numResiduals, k);
+    if (k < MAX_RICE_K)
+    {
+        int64 bits = getRiceBits(numResiduals, k + 1);
+        if (bits < riceBits)
+        {
+            riceBits = bits;
+            k++;
+        }
+    }
+    int64 packedBits = getPackedBits(numResiduals);
+
+    int64 rawBytes = int64(numSamples) * sizeof(int16);
+    int64 riceBytes = order * sizeof(int16) + (riceBits + 7) / 8;
+    int64 packedBytes = order * sizeof(int16) + (packedBits + 7) / 8;
+
+    if (rawBytes <= riceBytes && rawBytes <= packedBytes)
+    {
+        dest[0] = uint8(RAW << 4);
+        dest[1] = 0;
+        for (int i = 0; i < numSamples; i++)
+            writeInt16(dest + HEADER_SIZE + i * sizeof(int16), samples[i]);
+        return HEADER_SIZE + int(rawBytes);
+    }
+
+    Coder coder = packedBytes <= riceBytes ? PACKED : RICE;
+    dest[0] = uint8(order | (coder << 4));
+    dest[1] = uint8(coder == RICE ? k : 0);
+    for (int i = 0; i < order; i++)
+        writeInt16(dest + HEADER_SIZE + i * sizeof(int16), samples[i]);
+
+    BitWriter writer(dest + HEADER_SIZE + order * sizeof(int16));
+    if (coder == PACKED)
+    {
+        for (int start = 0; start < numResiduals; start += PACKED_GROUP_SIZE)
+        {
+            int end = jmin(numResiduals, start + PACKED_GROUP_SIZE);
+            uint32 bits = 0;
+            for (int i = start; i < end; i++)
+                bits |= m_residuals[i];
+            int width = bitWidth(bits);
+            writer.put(width, PACKED_WIDTH_BITS);
+            for (int i = start; i < end; i++)
+                writer.put(m_residuals[i], width);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numResiduals; i++)
+        {
+            uint32 u = m_residuals[i];
+            uint32 q = u >> k;
+            if (q >= RICE_ESCAPE)
+            {
+                writer.putOnes(RICE_ESCAPE);
+                writer.put(u, MAX_RESIDUAL_BITS);
+            }
+            else
+            {
+                writer.putOnes(q);
+                writer.put(0, 1);
+                writer.put(u & ((1u << k) - 1), k);
+            }
+        }
+    }
+    return HEADER_SIZE + order * sizeof(int16) + writer.finish();
+}
+
+int64 BlockCompressor::getPackedBits(int numResiduals) const
+{
+    int64 bits = 0;
+    for (int start = 0; start < numResiduals; start += PACKED_GROUP_SIZE)
+    {
+        int end = jmin(numResiduals, start + PACKED_GROUP_SIZE);
+        uint32 all = 0;
+        for (int i = start; i < end; i++)
+            all |= m_residuals[i];
+        bits += PACKED_WIDTH_BITS + int64(end - start) * bitWidth(all);
+    }
+    return bits;
+}
+
+int64 BlockCompressor::getRiceBits(int numResiduals, int k) const
+{
+    int64 bits = 0;
+    for (int i = 0; i < numResiduals; i++)
+    {
+        uint32 q = m_residuals[i] >> k;
+        bits += (q >= RICE_ESCAPE) ? (RICE_ESCAPE + MAX_RESIDUAL_BITS) : (q + 1 + k);
+    }
+    return bits;
+}
+
+bool BlockCompressor::decompress(const uint8* source, int sourceSize, int16* samples, int numSamples)
+{
+    if (sourceSize < HEADER_SIZE)
+        return false;
+
+    int order = source[0] & 0x0F;
+    int coder = source[0] >> 4;
+    int k = source[1];
+
+    if (coder == RAW)
+    {
+        if (sourceSize < HEADER_SIZE + numSamples * int(sizeof(int16)))
+            return false;
+        for (int i = 0; i < numSamples; i++)
+            samples[i] = readInt16(source + HEADER_SIZE + i * sizeof(int16));
+        return true;
+    }
+
+    if (order > 2 || order > numSamples || k > MAX_RICE_K || (coder != PACKED && coder != RICE))
+        return false;
+    int dataStart = HEADER_SIZE + order * sizeof(int16);
+    if (sourceSize < dataStart)
+        return false;
+    for (int i = 0; i < order; i++)
+        samples[i] = readInt16(source + HEADER_SIZE + i * sizeof(int16));
+
+    BitReader reader(source + dataStart, sourceSize - dataStart);
+    uint32 width = 0;
+    for (int i = order; i < numSamples; i++)
+    {
+        uint32 u;
+        if (coder == PACKED)
+        {
+            if ((i - order) % PACKED_GROUP_SIZE == 0)
+            {
+                if (!reader.get(PACKED_WIDTH_BITS, width) || width > MAX_RESIDUAL_BITS)
+                    return false;
+            }
+            if (!reader.get(width, u))
+                return false;
+        }
+        else
+        {
+            int q;
+            if (!reader.getOnes(RICE_ESCAPE, q))
+                return false;
+            if (q == RICE_ESCAPE)
+            {
+                if (!reader.get(MAX_RESIDUAL_BITS, u))
+                    return false;
+            }
+            else
+            {
+                uint32 low;
+                if (!reader.get(k, low))
+                    return false;
+                u = (uint32(q) << k) | low;
+            }
+        }
+
+        int32 residual = int32(u >> 1) ^ -int32(u & 1);
+        int32 prediction = 0;
+        if (order == 1)
+            prediction = samples[i - 1];
+        else if (order == 2)
+            prediction = 2 * samples[i - 1] - samples[i - 2];
+        samples[i] = int16(prediction + residual);
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BLOCKCOMPRESSOR_H
+#define BLOCKCOMPRESSOR_H
+
+#include <BasicJuceHeader.h>
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Lossless compression of one channel block of int16 samples.
+
+    Each block is predicted with a fixed linear predictor of order 0 (none),
+    1 (delta) or 2, picking the one with the smallest residuals. The zigzag
+    encoded residuals are then either bit-packed, in groups of 64 sharing a
+    bit width, or Rice coded, whichever is smaller. Blocks that don't compress
+    are stored raw. Layout, little endian:
+
+        uint8 predictor order | (coder << 4)
+        uint8 Rice parameter
+        int16 warm-up samples[order]
+        coded residuals, or the raw samples
+
+    Blocks are independent, so any of them can be decoded on its own.
+    */
+    class BlockCompressor
+    {
+    public:
+        enum Coder { RAW = 0, PACKED = 1, RICE = 2 };
+
+        BlockCompressor(int maxSamples);
+        ~BlockCompressor();
+
+        /** Compresses numSamples samples into dest, which must hold getMaxCompressedSize(numSamples) bytes.
+        Returns the number of bytes written */
+        int compress(const int16* samples, int numSamples, uint8* dest);
+
+        /** Returns false if the block is corrupt */
+        static bool decompress(const uint8* source, int sourceSize, int16* samples, int numSamples);
+
+        static int getMaxCompressedSize(int numSamples);
+
+    private:
+        int64 getPackedBits(int numResiduals) const;
+        int64 getRiceBits(int numResiduals, int k) const;
+
+        HeapBlock<uint32> m_residuals;
+        const int m_maxSamples;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockCompressor);
+    };
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedBinaryRecording.h"
+
+using namespace BinaryRecordingEngine;
+
+CompressedBinaryRecording::CompressedBinaryRecording() : BinaryRecording(true)
+{
+}
+
+CompressedBinaryRecording::~CompressedBinaryRecording()
+{
+}
+
+String CompressedBinaryRecording::getEngineID() const
+{
+    return "COMPRESSEDBINARY";
+}
+
+RecordEngineManager* CompressedBinaryRecording::getEngineManager()
+{
+    RecordEngineManager* man = new RecordEngineManager("COMPRESSEDBINARY", "Compressed binary",
+                                                       &(engineFactory<CompressedBinaryRecording>));
+    EngineParameter* param;
+    param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 1, "Compact timestamps", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 2, "Compression threads",
+                                jlimit(1, 8, SystemStats::getNumCpus() / 2), 1, 32);
+    man->addParameter(param);
+    return man;
+}
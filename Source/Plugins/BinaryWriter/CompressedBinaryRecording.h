@@ -0,0 +1,52 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDBINARYRECORDING_H
+#define COMPRESSEDBINARYRECORDING_H
+
+#include "BinaryRecording.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    The binary format with lossless compression of the continuous data.
+
+    Events, spikes and timestamps are saved as in the Binary engine, but each continuous
+    stream goes to a continuous.oecd file (see CompressedBlockFile) that is compressed on a
+    pool of worker threads. These files can be played back with the File Reader.
+    */
+    class CompressedBinaryRecording : public BinaryRecording
+    {
+    public:
+        CompressedBinaryRecording();
+        ~CompressedBinaryRecording();
+
+        String getEngineID() const override;
+
+        static RecordEngineManager* getEngineManager();
+    };
+
+}
+
+#endif
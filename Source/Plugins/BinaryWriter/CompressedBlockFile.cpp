@@ -0,0 +1,263 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedBlockFile.h"
+
+using namespace BinaryRecordingEngine;
+
+CompressedBlockFile::Block::Block(int nChannels, int samplesPerBlock) :
+ThreadPoolJob("Compressed block"),
+number(0),
+numSamples(0),
+channelsDone(0),
+outputSize(0),
+m_nChannels(nChannels),
+m_samplesPerBlock(samplesPerBlock),
+m_samples(nChannels * samplesPerBlock, true),
+m_compressor(samplesPerBlock)
+{
+    output.malloc(blockHeaderSize + nChannels * (sizeof(uint32) + BlockCompressor::getMaxCompressedSize(samplesPerBlock)));
+}
+
+void CompressedBlockFile::Block::reset(int64 blockNumber)
+{
+    number = blockNumber;
+    numSamples = 0;
+    channelsDone = 0;
+    outputSize = 0;
+    //channels that skip over a timestamp gap leave zeroes behind, as in the uncompressed files
+    zeromem(m_samples, m_nChannels * m_samplesPerBlock * sizeof(int16));
+}
+
+int16* CompressedBlockFile::Block::getChannelData(int channel)
+{
+    return m_samples + channel * m_samplesPerBlock;
+}
+
+ThreadPoolJob::JobStatus CompressedBlockFile::Block::runJob()
+{
+    int pos = blockHeaderSize;
+    for (int i = 0; i < m_nChannels; i++)
+    {
+        int size = m_compressor.compress(getChannelData(i), numSamples, output + pos + sizeof(uint32));
+        *reinterpret_cast<uint32*>(output + pos) = ByteOrder::swapIfBigEndian(uint32(size));
+        pos += sizeof(uint32) + size;
+    }
+    outputSize = pos;
+
+    MemoryOutputStream header(output, blockHeaderSize);
+    header.write("OEBK", 4);
+    header.writeInt(outputSize);
+    header.writeInt(numSamples);
+    header.writeInt(0);
+    header.writeInt64(number * m_samplesPerBlock);
+
+    return jobHasFinished;
+}
+
+CompressedBlockFile::CompressedBlockFile(int nChannels, int samplesPerBlock, ThreadPool* pool) :
+m_file(nullptr),
+m_pool(pool),
+m_nChannels(nChannels),
+m_samplesPerBlock(samplesPerBlock),
+m_firstOpenBlock(0),
+m_lastPosition(0),
+m_totalSamples(0)
+{
+    for (int i = 0; i < nChannels; i++)
+    {
+        m_channelNames.add(String::empty);
+        m_channelBitVolts.add(1.0f);
+        m_channelPositions.add(0);
+    }
+}
+
+CompressedBlockFile::~CompressedBlockFile()
+{
+    if (!m_file)
+        return;
+
+    //whatever is still open is the last, partial, stretch of data
+    while (m_openBlocks.size() > 0)
+    {
+        Block* block = m_openBlocks[0];
+        uint64 start = block->number * m_samplesPerBlock;
+        if (m_lastPosition <= start)
+            break;
+        block->numSamples = int(jmin(uint64(m_samplesPerBlock), m_lastPosition - start));
+        m_openBlocks.remove(0);
+        m_queuedBlocks.add(block);
+        m_pool->addJob(block, false);
+    }
+    writeFinishedBlocks(true);
+    writeIndex();
+}
+
+void CompressedBlockFile::setChannelInfo(int channel, const String& name, float bitVolts)
+{
+    m_channelNames.set(channel, name);
+    m_channelBitVolts.set(channel, bitVolts);
+}
+
+bool CompressedBlockFile::openFile(String filename, float sampleRate, int64 firstTimestamp)
+{
+    File file(filename);
+    Result res = file.create();
+    if (res.failed())
+    {
+        std::cerr << "Error creating file " << filename << ":" << res.getErrorMessage() << std::endl;
+        return false;
+    }
+    file.deleteFile();
+    m_file = file.createOutputStream();
+    if (!m_file)
+        return false;
+
+    int headerSize = fileHeaderSize;
+    for (int i = 0; i < m_nChannels; i++)
+        headerSize += sizeof(float) + sizeof(uint32) + m_channelNames[i].getNumBytesAsUTF8();
+
+    m_file->write("OECD", 4);
+    m_file->writeInt(formatVersion);
+    m_file->writeInt(headerSize);
+    m_file->writeInt(m_nChannels);
+    m_file->writeInt(m_samplesPerBlock);
+    m_file->writeFloat(sampleRate);
+    m_file->writeInt64(firstTimestamp);
+    for (int i = 0; i < m_nChannels; i++)
+    {
+        m_file->writeFloat(m_channelBitVolts[i]);
+        m_file->writeInt(m_channelNames[i].getNumBytesAsUTF8());
+        m_file->write(m_channelNames[i].toUTF8(), m_channelNames[i].getNumBytesAsUTF8());
+    }
+    return true;
+}
+
+bool CompressedBlockFile::writeChannel(uint64 startPos, int channel, int16* data, int nSamples)
+{
+    if (!m_file)
+        return false;
+
+    uint64 channelPos = m_channelPositions[channel];
+    if (startPos < channelPos)
+    {
+        std::cerr << "COMPRESSED WRITER: Data for chan " << channel << " start " << startPos << " ns " << nSamples
+            << " overlaps data already written up to " << channelPos << std::endl;
+        return false;
+    }
+
+    int written = 0;
+    while (written < nSamples)
+    {
+        uint64 pos = startPos + written;
+        Block* block = getBlock(pos / m_samplesPerBlock);
+        int blockIdx = int(pos % m_samplesPerBlock);
+        int samplesToWrite = jmin(nSamples - written, m_samplesPerBlock - blockIdx);
+        memcpy(block->getChannelData(channel) + blockIdx, data + written, samplesToWrite * sizeof(int16));
+        written += samplesToWrite;
+    }
+
+    uint64 endPos = startPos + nSamples;
+    markChannelDone(channel, channelPos, endPos);
+    m_channelPositions.set(channel, endPos);
+    if (endPos > m_lastPosition)
+        m_lastPosition = endPos;
+
+    submitFilledBlocks();
+    writeFinishedBlocks(false);
+    return true;
+}
+
+CompressedBlockFile::Block* CompressedBlockFile::getBlock(int64 blockNumber)
+{
+    jassert(blockNumber >= m_firstOpenBlock);
+    while (m_openBlocks.size() <= blockNumber - m_firstOpenBlock)
+    {
+        Block* block;
+        if (m_freeBlocks.size() > 0)
+            block = m_freeBlocks.remove(m_freeBlocks.size() - 1);
+        else
+            block = m_blocks.add(new Block(m_nChannels, m_samplesPerBlock));
+        block->reset(m_firstOpenBlock + m_openBlocks.size());
+        m_openBlocks.add(block);
+    }
+    return m_openBlocks[int(blockNumber - m_firstOpenBlock)];
+}
+
+void CompressedBlockFile::markChannelDone(int channel, uint64 fromPos, uint64 toPos)
+{
+    //every block whose end the channel has reached, written or skipped over, is done for it
+    for (int64 b = fromPos / m_samplesPerBlock; uint64(b + 1) * m_samplesPerBlock <= toPos; b++)
+        getBlock(b)->channelsDone++;
+}
+
+void CompressedBlockFile::submitFilledBlocks()
+{
+    while (m_openBlocks.size() > 0 && m_openBlocks[0]->channelsDone == m_nChannels)
+    {
+        Block* block = m_openBlocks.remove(0);
+        block->numSamples = m_samplesPerBlock;
+        m_firstOpenBlock++;
+        m_queuedBlocks.add(block);
+        m_pool->addJob(block, false);
+    }
+}
+
+void CompressedBlockFile::writeFinishedBlocks(bool waitForAll)
+{
+    while (m_queuedBlocks.size() > 0)
+    {
+        Block* block = m_queuedBlocks[0];
+        //blocks are written in order, so wait for the oldest if too many are piling up
+        if (waitForAll || m_queuedBlocks.size() > maxQueuedBlocks)
+            m_pool->waitForJobToFinish(block, -1);
+        else if (m_pool->contains(block))
+            break;
+
+        m_indexOffsets.add(m_file->getPosition());
+        m_indexFirstSamples.add(block->number * m_samplesPerBlock);
+        m_file->write(block->output, block->outputSize);
+
+        m_totalSamples = block->number * m_samplesPerBlock + block->numSamples;
+
+        m_queuedBlocks.remove(0);
+        m_freeBlocks.add(block);
+    }
+}
+
+void CompressedBlockFile::writeIndex()
+{
+    int64 indexOffset = m_file->getPosition();
+    int numBlocks = m_indexOffsets.size();
+    for (int i = 0; i < numBlocks; i++)
+    {
+        m_file->writeInt64(m_indexOffsets[i]);
+        m_file->writeInt64(m_indexFirstSamples[i]);
+    }
+    m_file->writeInt64(indexOffset);
+    m_file->writeInt64(numBlocks);
+    m_file->writeInt64(m_totalSamples);
+    m_file->writeInt(formatVersion);
+    m_file->write("OEIX", 4);
+    m_file->flush();
+}
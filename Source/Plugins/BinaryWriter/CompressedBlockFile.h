@@ -0,0 +1,124 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDBLOCKFILE_H
+#define COMPRESSEDBLOCKFILE_H
+
+#include "BlockCompressor.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Compressed counterpart of SequentialBlockFile, with the same writeChannel() interface.
+
+    Samples are gathered in blocks of samplesPerBlock samples for all channels. Once every
+    channel has gone past a block it is compressed by a job on the shared thread pool, one
+    BlockCompressor block per channel, and compressed blocks are appended to the file in
+    order from the record thread. Layout of a .oecd file, little endian:
+
+        header:  "OECD", uint32 version, uint32 header size, uint32 channels,
+                 uint32 samples per block, float sample rate, int64 first timestamp,
+                 then per channel float bit volts, uint32 name size, name
+        blocks:  "OEBK", uint32 block size, uint32 samples, uint32 0, int64 first sample,
+                 then per channel uint32 size, compressed channel block
+        index:   per block int64 file offset, int64 first sample
+        trailer: int64 index offset, int64 blocks, int64 samples, uint32 version, "OEIX"
+
+    The index and trailer are written when the file is closed. Files that were not closed
+    can still be read by walking the block headers.
+    */
+    class CompressedBlockFile
+    {
+    public:
+        CompressedBlockFile(int nChannels, int samplesPerBlock, ThreadPool* pool);
+        ~CompressedBlockFile();
+
+        /** Call for every channel before openFile */
+        void setChannelInfo(int channel, const String& name, float bitVolts);
+        bool openFile(String filename, float sampleRate, int64 firstTimestamp);
+        bool writeChannel(uint64 startPos, int channel, int16* data, int nSamples);
+
+        static const uint32 formatVersion{ 1 };
+        static const int fileHeaderSize{ 32 };
+        static const int blockHeaderSize{ 24 };
+        static const int trailerSize{ 32 };
+
+    private:
+        class Block : public ThreadPoolJob
+        {
+        public:
+            Block(int nChannels, int samplesPerBlock);
+            JobStatus runJob() override;
+            void reset(int64 blockNumber);
+            int16* getChannelData(int channel);
+
+            int64 number;
+            int numSamples;
+            int channelsDone;
+
+            HeapBlock<uint8> output;
+            int outputSize;
+
+        private:
+            const int m_nChannels;
+            const int m_samplesPerBlock;
+            HeapBlock<int16> m_samples;
+            BlockCompressor m_compressor;
+        };
+
+        Block* getBlock(int64 blockNumber);
+        void markChannelDone(int channel, uint64 fromPos, uint64 toPos);
+        void submitFilledBlocks();
+        void writeFinishedBlocks(bool waitForAll);
+        void writeIndex();
+
+        ScopedPointer<FileOutputStream> m_file;
+        ThreadPool* const m_pool;
+        const int m_nChannels;
+        const int m_samplesPerBlock;
+        StringArray m_channelNames;
+        Array<float> m_channelBitVolts;
+
+        OwnedArray<Block> m_blocks;
+        Array<Block*> m_freeBlocks;
+        Array<Block*> m_openBlocks; //being filled, in order
+        Array<Block*> m_queuedBlocks; //being compressed, in order
+        int64 m_firstOpenBlock;
+        Array<uint64> m_channelPositions;
+        uint64 m_lastPosition;
+
+        Array<int64> m_indexOffsets;
+        Array<int64> m_indexFirstSamples;
+        int64 m_totalSamples;
+
+        //Compile-time parameters
+        //blocks waiting for compression before the record thread waits for them
+        const int maxQueuedBlocks{ 16 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedBlockFile);
+    };
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedFileSource.h"
+#include "CompressedBlockFile.h"
+
+using namespace BinaryRecordingEngine;
+
+CompressedFileSource::CompressedFileSource() :
+m_numChannels(0),
+m_samplesPerBlock(0),
+m_sampleRate(0),
+m_numSamples(0),
+m_dataStart(0),
+m_loadedBlock(-1),
+m_loadedSamples(0),
+m_samplePos(0)
+{
+}
+
+CompressedFileSource::~CompressedFileSource()
+{
+}
+
+bool CompressedFileSource::Open(File file)
+{
+    ScopedPointer<FileInputStream> stream = file.createInputStream();
+    if (!stream || stream->getTotalLength() < CompressedBlockFile::fileHeaderSize)
+        return false;
+
+    char magic[4];
+    stream->read(magic, 4);
+    if (memcmp(magic, "OECD", 4) != 0)
+        return false;
+
+    uint32 version = stream->readInt();
+    if (version > CompressedBlockFile::formatVersion)
+    {
+        std::cerr << "Unsupported compressed file version " << version << std::endl;
+        return false;
+    }
+    int headerSize = stream->readInt();
+    m_numChannels = stream->readInt();
+    m_samplesPerBlock = stream->readInt();
+    m_sampleRate = stream->readFloat();
+    stream->readInt64(); //first timestamp, not used by the File Reader
+    if (m_numChannels < 1 || m_samplesPerBlock < 1)
+        return false;
+
+    m_channelNames.clear();
+    m_channelBitVolts.clear();
+    for (int i = 0; i < m_numChannels; i++)
+    {
+        m_channelBitVolts.add(stream->readFloat());
+        int nameSize = stream->readInt();
+        MemoryBlock name;
+        stream->readIntoMemoryBlock(name, nameSize);
+        m_channelNames.add(name.toString());
+    }
+    m_dataStart = headerSize;
+    m_file = stream;
+
+    if (!readIndex())
+    {
+        std::cout << "No block index in " << file.getFullPathName() << ", the recording was not closed properly. Scanning blocks" << std::endl;
+        scanBlocks();
+    }
+
+    //files are named after the stream folder, as with the uncompressed binary format
+    m_streamName = file.getParentDirectory().getFileName();
+    m_decoded.malloc(m_numChannels * m_samplesPerBlock);
+    m_loadedBlock = -1;
+    return m_blockOffsets.size() > 0;
+}
+
+bool CompressedFileSource::readIndex()
+{
+    int64 length = m_file->getTotalLength();
+    if (length < m_dataStart + CompressedBlockFile::trailerSize)
+        return false;
+
+    m_file->setPosition(length - CompressedBlockFile::trailerSize);
+    int64 indexOffset = m_file->readInt64();
+    int64 numBlocks = m_file->readInt64();
+    int64 numSamples = m_file->readInt64();
+    m_file->readInt(); //version
+    char magic[4];
+    m_file->read(magic, 4);
+    if (memcmp(magic, "OEIX", 4) != 0 || indexOffset < m_dataStart
+        || indexOffset + numBlocks * int64(2 * sizeof(int64)) > length)
+        return false;
+
+    m_blockOffsets.clear();
+    m_blockFirstSamples.clear();
+    m_file->setPosition(indexOffset);
+    for (int64 i = 0; i < numBlocks; i++)
+    {
+        m_blockOffsets.add(m_file->readInt64());
+        m_blockFirstSamples.add(m_file->readInt64());
+    }
+    m_numSamples = numSamples;
+    return true;
+}
+
+void CompressedFileSource::scanBlocks()
+{
+    m_blockOffsets.clear();
+    m_blockFirstSamples.clear();
+    m_numSamples = 0;
+
+    int64 length = m_file->getTotalLength();
+    int64 pos = m_dataStart;
+    while (pos + CompressedBlockFile::blockHeaderSize <= length)
+    {
+        m_file->setPosition(pos);
+        char magic[4];
+        m_file->read(magic, 4);
+        uint32 blockSize = m_file->readInt();
+        int numSamples = m_file->readInt();
+        m_file->readInt();
+        int64 firstSample = m_file->readInt64();
+
+        //a block cut short by a crash ends the scan
+        if (memcmp(magic, "OEBK", 4) != 0 || blockSize < CompressedBlockFile::blockHeaderSize || pos + blockSize > length)
+            break;
+
+        m_blockOffsets.add(pos);
+        m_blockFirstSamples.add(firstSample);
+        m_numSamples = firstSample + numSamples;
+        pos += blockSize;
+    }
+}
+
+void CompressedFileSource::fillRecordInfo()
+{
+    RecordInfo info;
+    info.name = m_streamName;
+    info.sampleRate = m_sampleRate;
+    info.numSamples = m_numSamples;
+    for (int i = 0; i < m_numChannels; i++)
+    {
+        RecordedChannelInfo c;
+        c.name = m_channelNames[i].isEmpty() ? "CH" + String(i) : m_channelNames[i];
+        c.bitVolts = m_channelBitVolts[i];
+        info.channels.add(c);
+    }
+    infoArray.add(info);
+    numRecords++;
+}
+
+void CompressedFileSource::updateActiveRecord()
+{
+    m_samplePos = 0;
+    m_loadedBlock = -1;
+}
+
+void CompressedFileSource::seekTo(int64 sample)
+{
+    m_samplePos = sample % getActiveNumSamples();
+}
+
+bool CompressedFileSource::loadBlock(int index)
+{
+    if (index == m_loadedBlock)
+        return true;
+
+    m_loadedBlock = -1;
+    int64 offset = m_blockOffsets[index];
+    m_file->setPosition(offset);
+
+    char magic[4];
+    m_file->read(magic, 4);
+    uint32 blockSize = m_file->readInt();
+    int numSamples = m_file->readInt();
+    m_file->readInt();
+    m_file->readInt64();
+    if (memcmp(magic, "OEBK", 4) != 0 || numSamples < 0 || numSamples > m_samplesPerBlock
+        || blockSize < CompressedBlockFile::blockHeaderSize)
+    {
+        std::cerr << "Corrupt compressed block at " << offset << std::endl;
+        return false;
+    }
+
+    int dataSize = blockSize - CompressedBlockFile::blockHeaderSize;
+    m_compressed.ensureSize(dataSize);
+    if (m_file->read(m_compressed.getData(), dataSize) != dataSize)
+        return false;
+
+    const uint8* data = static_cast<const uint8*>(m_compressed.getData());
+    int pos = 0;
+    for (int i = 0; i < m_numChannels; i++)
+    {
+        if (pos + int(sizeof(uint32)) > dataSize)
+            return false;
+        int size = int(ByteOrder::littleEndianInt(data + pos));
+        pos += sizeof(uint32);
+        if (size < 0 || pos + size > dataSize
+            || !BlockCompressor::decompress(data + pos, size, m_decoded + i * m_samplesPerBlock, numSamples))
+        {
+            std::cerr << "Corrupt compressed block at " << offset << ", channel " << i << std::endl;
+            return false;
+        }
+        pos += size;
+    }
+
+    m_loadedBlock = index;
+    m_loadedSamples = numSamples;
+    return true;
+}
+
+int CompressedFileSource::readData(int16* buffer, int nSamples)
+{
+    int samplesToRead = int(jmin(int64(nSamples), getActiveNumSamples() - m_samplePos));
+    int samplesRead = 0;
+
+    while (samplesRead < samplesToRead)
+    {
+        //last block starting at or before the current position
+        int64* first = m_blockFirstSamples.begin();
+        int index = int(std::upper_bound(first, m_blockFirstSamples.end(), m_samplePos) - first) - 1;
+        if (index < 0 || !loadBlock(index))
+            break;
+
+        int blockIdx = int(m_samplePos - m_blockFirstSamples[index]);
+        int count = jmin(samplesToRead - samplesRead, m_loadedSamples - blockIdx);
+        if (count <= 0)
+            break;
+
+        //blocks are stored channel after channel, the File Reader wants them interleaved
+        int16* dest = buffer + samplesRead * m_numChannels;
+        for (int ch = 0; ch < m_numChannels; ch++)
+        {
+            const int16* src = m_decoded + ch * m_samplesPerBlock + blockIdx;
+            for (int i = 0; i < count; i++)
+                dest[i * m_numChannels + ch] = src[i];
+        }
+        samplesRead += count;
+        m_samplePos += count;
+    }
+    return samplesRead;
+}
+
+void CompressedFileSource::processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+    int n = getActiveNumChannels();
+    float bitVolts = getChannelInfo(channel).bitVolts;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        *(outBuffer + i) = *(inBuffer + (n*i) + channel) * bitVolts;
+    }
+}
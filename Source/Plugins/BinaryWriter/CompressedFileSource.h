@@ -0,0 +1,80 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDFILESOURCE_H
+#define COMPRESSEDFILESOURCE_H
+
+#include <FileSourceHeaders.h>
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Reads the .oecd files written by the compressed binary engine, see CompressedBlockFile.
+
+    Each file holds a single stream. Blocks are found through the index at the end of the
+    file or, if the recording was not closed cleanly, by walking the block headers.
+    */
+    class CompressedFileSource : public FileSource
+    {
+    public:
+        CompressedFileSource();
+        ~CompressedFileSource();
+
+        int readData(int16* buffer, int nSamples) override;
+        void seekTo(int64 sample) override;
+        void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+
+    private:
+        bool Open(File file) override;
+        void fillRecordInfo() override;
+        void updateActiveRecord() override;
+
+        bool readIndex();
+        void scanBlocks();
+        bool loadBlock(int index);
+
+        ScopedPointer<FileInputStream> m_file;
+        String m_streamName;
+        int m_numChannels;
+        int m_samplesPerBlock;
+        float m_sampleRate;
+        int64 m_numSamples;
+        int64 m_dataStart;
+        StringArray m_channelNames;
+        Array<float> m_channelBitVolts;
+
+        Array<int64> m_blockOffsets;
+        Array<int64> m_blockFirstSamples;
+
+        int m_loadedBlock;
+        int m_loadedSamples;
+        MemoryBlock m_compressed;
+        HeapBlock<int16> m_decoded; //channel after channel
+
+        int64 m_samplePos;
+    };
+
+}
+
+#endif
@@ -23,6 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <PluginInfo.h>
 #include "BinaryRecording.h"
+#include "CompressedBinaryRecording.h"
+#include "CompressedFileSource.h"
 #include <string>
 #ifdef WIN32
 #include <Windows.h>
@@ -33,7 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 using namespace Plugin;
-#define NUM_PLUGINS 1
+#define NUM_PLUGINS 3
 
 extern "C" EXPORT void getLibInfo(Plugin::LibraryInfo* info)
 {
@@ -52,6 +54,17 @@ extern "C" EXPORT int getPluginInfo(int index, Plugin::PluginInfo* info)
         info->recordEngine.name = "Binary";
         info->recordEngine.creator = &(Plugin::createRecordEngine<BinaryRecordingEngine::BinaryRecording>);
         break;
+    case 1:
+        info->type = Plugin::PLUGIN_TYPE_RECORD_ENGINE;
+        info->recordEngine.name = "Compressed binary";
+        info->recordEngine.creator = &(Plugin::createRecordEngine<BinaryRecordingEngine::CompressedBinaryRecording>);
+        break;
+    case 2:
+        info->type = Plugin::PLUGIN_TYPE_FILE_SOURCE;
+        info->fileSource.name = "Compressed binary file";
+        info->fileSource.extensions = "oecd";
+        info->fileSource.creator = &(Plugin::createFileSource<BinaryRecordingEngine::CompressedFileSource>);
+        break;
     default:
         return -1;
     }
@@ -0,0 +1,225 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2016 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ChannelGatherPlan.h"
+
+
+ChannelGatherPlan::ChannelGatherPlan()
+    : channelBuffer     (1, 10000)
+    , numInputs         (0)
+    , numOutputs        (0)
+    , numSteps          (0)
+    , numSaved          (0)
+{
+}
+
+
+void ChannelGatherPlan::prepare (int numInputs_)
+{
+    numInputs = numInputs_;
+    numOutputs = 0;
+    numSteps = 0;
+    numSaved = 0;
+
+    if (numInputs > 0)
+        channelBuffer.setSize (numInputs, 10000, false, false, true);
+
+    const int maxOutputs = jmax (1, numInputs);
+
+    steps.malloc         (2 * maxOutputs);
+    sources.malloc       (maxOutputs);
+    references.malloc    (maxOutputs);
+    pending.malloc       (maxOutputs);
+    saved.malloc         (maxOutputs);
+    ready.malloc         (maxOutputs);
+    outputSamples.malloc (maxOutputs);
+    emitted.malloc       (maxOutputs);
+}
+
+
+void ChannelGatherPlan::build (const Array<int>& channelArray, const Array<bool>& enabledChannelArray,
+                               const Array<int>& referenceArray, const Array<int>& referenceChannels, int maxOutputs)
+{
+    numSteps = 0;
+    numOutputs = 0;
+    numSaved = 0;
+
+    // same selection as the channels ChannelMappingNode::updateSettings keeps
+    for (int i = 0; i < channelArray.size() && numOutputs < jmin (maxOutputs, numInputs); ++i)
+    {
+        const int realChan = channelArray[i];
+
+        if (realChan < 0 || realChan >= numInputs || ! enabledChannelArray[realChan])
+            continue;
+
+        const int j = numOutputs++;
+        const int reference = referenceArray[realChan];
+
+        sources[j] = realChan;
+        references[j] = -1;
+
+        if (reference > -1
+            && referenceChannels[reference] > -1
+            && referenceChannels[reference] < numInputs
+            && channelArray[referenceChannels[reference]] < numInputs)
+        {
+            references[j] = channelArray[referenceChannels[reference]];
+        }
+    }
+
+    const int n = numOutputs;
+
+    // an output has to wait until every other output reading its channel has been written
+    for (int j = 0; j < n; ++j)
+    {
+        pending[j] = 0;
+        saved[j] = -1;
+        emitted[j] = (sources[j] == j && references[j] < 0);
+    }
+
+    for (int k = 0; k < n; ++k)
+    {
+        if (emitted[k])
+            continue;
+
+        const int reads[2] = { sources[k], references[k] };
+
+        for (int r = 0; r < 2; ++r)
+        {
+            if (reads[r] >= 0 && reads[r] != k && reads[r] < n && ! emitted[reads[r]])
+                ++pending[reads[r]];
+        }
+    }
+
+    int readyStart = 0;
+    int readyEnd = 0;
+    int remaining = 0;
+    int nextStuck = 0;
+
+    for (int j = 0; j < n; ++j)
+    {
+        if (! emitted[j])
+        {
+            ++remaining;
+
+            if (pending[j] == 0)
+                ready[readyEnd++] = j;
+        }
+    }
+
+    while (remaining > 0)
+    {
+        if (readyStart == readyEnd)
+        {
+            // only cycles are left, keeping one channel aside breaks one
+            while (emitted[nextStuck] || pending[nextStuck] == 0)
+                ++nextStuck;
+
+            GatherStep& save = steps[numSteps++];
+            save.type = GatherStep::SAVE;
+            save.dest = numSaved;
+            save.source = nextStuck;
+            save.reference = -1;
+            save.sourceSaved = false;
+            save.referenceSaved = false;
+
+            saved[nextStuck] = numSaved++;
+            pending[nextStuck] = 0;
+            ready[readyEnd++] = nextStuck;
+        }
+
+        const int k = ready[readyStart++];
+        const int source = sources[k];
+        const int reference = references[k];
+
+        GatherStep& step = steps[numSteps++];
+        step.type = reference >= 0 ? GatherStep::SUBTRACT : GatherStep::COPY;
+        step.dest = k;
+        step.sourceSaved = source < n && saved[source] >= 0;
+        step.source = step.sourceSaved ? saved[source] : source;
+        step.referenceSaved = reference >= 0 && reference < n && saved[reference] >= 0;
+        step.reference = step.referenceSaved ? saved[reference] : reference;
+
+        emitted[k] = true;
+        --remaining;
+
+        const int reads[2] = { source, reference };
+
+        for (int r = 0; r < 2; ++r)
+        {
+            const int c = reads[r];
+
+            if (c >= 0 && c != k && c < n && ! emitted[c] && saved[c] < 0 && --pending[c] == 0)
+                ready[readyEnd++] = c;
+        }
+    }
+}
+
+
+void ChannelGatherPlan::process (AudioSampleBuffer& buffer)
+{
+    if (numSteps == 0)
+        return;
+
+    // channels kept aside have to cover the longest output reading them
+    int savedSamples = 0;
+
+    for (int s = 0; s < numSteps; ++s)
+    {
+        const GatherStep& step = steps[s];
+
+        if (step.type != GatherStep::SAVE)
+            savedSamples = jmax (savedSamples, outputSamples[step.dest]);
+    }
+
+    if (savedSamples > channelBuffer.getNumSamples())
+        channelBuffer.setSize (channelBuffer.getNumChannels(), savedSamples, true, false, true);
+
+    for (int s = 0; s < numSteps; ++s)
+    {
+        const GatherStep& step = steps[s];
+
+        if (step.type == GatherStep::SAVE)
+        {
+            FloatVectorOperations::copy (channelBuffer.getWritePointer (step.dest),
+                                         buffer.getReadPointer (step.source),
+                                         savedSamples);
+            continue;
+        }
+
+        const float* source = step.sourceSaved ? channelBuffer.getReadPointer (step.source)
+                                               : buffer.getReadPointer (step.source);
+        float* dest = buffer.getWritePointer (step.dest);
+
+        if (step.type == GatherStep::COPY)
+        {
+            FloatVectorOperations::copy (dest, source, outputSamples[step.dest]);
+        }
+        else
+        {
+            // the channel and its reference in a single pass
+            const float* reference = step.referenceSaved ? channelBuffer.getReadPointer (step.reference)
+                                                         : buffer.getReadPointer (step.reference);
+            FloatVectorOperations::subtract (dest, source, reference, outputSamples[step.dest]);
+        }
+    }
+}
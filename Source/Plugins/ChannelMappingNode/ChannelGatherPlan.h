@@ -0,0 +1,103 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2016 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CHANNELGATHERPLAN_H__
+#define __CHANNELGATHERPLAN_H__
+
+#include <BasicJuceHeader.h>
+
+/**
+    A channel map compiled into a list of steps that rearranges the channels of a buffer
+    in place.
+
+    Each output is copied, or copied and referenced in one pass, from its source channel.
+    Outputs are ordered so that channels are read before they are overwritten, and only
+    channels in a cycle of the mapping are saved to a scratch buffer first. Outputs that
+    stay where they are cost nothing.
+
+    @see ChannelMappingNode
+*/
+class ChannelGatherPlan
+{
+public:
+    ChannelGatherPlan();
+
+    /** Allocates for any mapping of the given number of inputs */
+    void prepare (int numInputs);
+
+    /** Compiles a mapping and its references into steps. Only uses the memory allocated by
+        prepare(), so it can run while acquiring.
+        @param channelArray        the input channel of each output, in order
+        @param enabledChannelArray which input channels are kept
+        @param referenceArray      the reference of each input channel, or -1
+        @param referenceChannels   the position in channelArray of each reference, or -1
+        @param maxOutputs          outputs to compile at most
+    */
+    void build (const Array<int>& channelArray, const Array<bool>& enabledChannelArray,
+                const Array<int>& referenceArray, const Array<int>& referenceChannels, int maxOutputs);
+
+    int getNumOutputs() const { return numOutputs; }
+
+    /** Channels kept aside in the scratch buffer to break cycles of the mapping */
+    int getNumSavedChannels() const { return numSaved; }
+
+    /** Sets the number of samples in an output channel for the next process() call */
+    void setNumSamples (int output, int numSamples) { outputSamples[output] = numSamples; }
+
+    /** Rearranges the channels of the buffer */
+    void process (AudioSampleBuffer& buffer);
+
+private:
+    struct GatherStep
+    {
+        enum Type { SAVE, COPY, SUBTRACT };
+
+        Type type;
+        // output channel, or scratch channel for SAVE
+        int dest;
+        int source;
+        int reference;
+        bool sourceSaved;
+        bool referenceSaved;
+    };
+
+    // channels that have to be kept before being overwritten
+    AudioSampleBuffer channelBuffer;
+
+    int numInputs;
+    int numOutputs;
+    HeapBlock<GatherStep> steps;
+    int numSteps;
+    int numSaved;
+    HeapBlock<int> sources;
+    HeapBlock<int> references;
+    HeapBlock<int> pending;
+    HeapBlock<int> saved;
+    HeapBlock<int> ready;
+    HeapBlock<int> outputSamples;
+    HeapBlock<bool> emitted;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelGatherPlan);
+};
+
+
+#endif  // __CHANNELGATHERPLAN_H__
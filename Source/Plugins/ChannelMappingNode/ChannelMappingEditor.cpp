@@ -58,8 +58,10 @@ ChannelMappingEditor::ChannelMappingEditor(GenericProcessor* parentNode, bool us
     addAndMakeVisible(electrodeButtonViewport = new Viewport());
     electrodeButtonViewport->setBounds(10,30,330,70);
     electrodeButtonViewport->setScrollBarsShown(true,false,true,true);
-    electrodeButtonHolder = new Component();
-    electrodeButtonViewport->setViewedComponent(electrodeButtonHolder,false);
+    electrodeGrid = new ChannelGrid();
+    electrodeGrid->setCellSize(19,15);
+    electrodeGrid->setListener(this);
+    electrodeButtonViewport->setViewedComponent(electrodeGrid,false);
     
 
     loadButton = new LoadButton();
@@ -136,7 +138,7 @@ void ChannelMappingEditor::createElectrodeButtons(int numNeeded, bool clearPrevi
 
     if (clearPrevious)
     {
-        electrodeButtons.clear();
+        electrodeGrid->setNumCells(0);
 
         referenceArray.clear();
         channelArray.clear();
@@ -154,36 +156,19 @@ void ChannelMappingEditor::createElectrodeButtons(int numNeeded, bool clearPrevi
     }
     else
     {
-        startButton = electrodeButtons.size();
+        startButton = electrodeGrid->getNumCells();
         if (startButton > numNeeded) return;
         //row = startButton/16;
         //column = startButton % 16;
     }
 
+    // the new cells are numbered after their position
+    electrodeGrid->setNumCells(numNeeded);
+    electrodeGrid->setClickingTogglesState(!reorderActive);
+
     for (int i = startButton; i < numNeeded; i++)
     {
-        ElectrodeButton* button = new ElectrodeButton(i+1);
-        electrodeButtons.add(button);
-
-        button->setRadioGroupId(0);
-
-        // if (!getCollapsedState())
-        //     addAndMakeVisible(button);
-        // else
-        electrodeButtonHolder->addAndMakeVisible(button); // determine visibility in refreshButtonLocations()
-
-        button->addListener(this);
-        if (reorderActive)
-        {
-            button->setToggleState(true,dontSendNotification);
-            electrodeButtons[i]->setClickingTogglesState(false);
-            electrodeButtons[i]->addMouseListener(this,false);
-        }
-        else
-        {
-            button->setToggleState(false,dontSendNotification);
-            electrodeButtons[i]->setClickingTogglesState(true);
-        }
+        electrodeGrid->setCellSelected(i, reorderActive);
 
         referenceArray.add(-1);
 
@@ -218,27 +203,12 @@ void ChannelMappingEditor::refreshButtonLocations()
     electrodeButtonViewport->setVisible(!getCollapsedState());
     int width = 19;
     int height = 15;
-    int row = 0;
-    int column = 0;
-    int totalWidth = 0;
-    int totalHeight = 0;
-    for (int i = 0; i < electrodeButtons.size(); i++)
-    {
-        ElectrodeButton* button = electrodeButtons[i];
-        button->setBounds(column*width, row*height, width, height);
-        totalWidth =  jmax(totalWidth, ++column*width);
-        
-        if (column == 1)
-        {
-            totalHeight = jmax(totalHeight, (row + 1)*height);
-        }
-        else if (column == 16)
-        {
-            row++;
-            column = 0;            
-        }
-    }
-    electrodeButtonHolder->setSize(totalWidth,totalHeight);
+    int numCells = electrodeGrid->getNumCells();
+
+    // 16 channels per row
+    int totalWidth = jmin(numCells, 16) * width;
+    int totalHeight = ((numCells + 15) / 16) * height;
+    electrodeGrid->setSize(totalWidth,totalHeight);
 }
 
 void ChannelMappingEditor::collapsedStateChanged()
@@ -251,10 +221,10 @@ void ChannelMappingEditor::buttonEvent(Button* button)
 
     if (button == selectAllButton)
     {
-        for (int i = 0; i < electrodeButtons.size(); i++)
+        for (int i = 0; i < electrodeGrid->getNumCells(); i++)
         {
-            electrodeButtons[i]->setToggleState(true,dontSendNotification);
-            setChannelReference(electrodeButtons[i]);
+            electrodeGrid->setCellSelected(i, true);
+            setChannelReference(i);
         }
         previousClickedChan = -1;
         setConfigured(true);
@@ -305,25 +275,26 @@ void ChannelMappingEditor::buttonEvent(Button* button)
             }
             channelSelector->setActiveChannels(a);
 
-            for (int i = 0; i < electrodeButtons.size(); i++)
+            electrodeGrid->setClickingTogglesState(true);
+            electrodeGrid->removeMouseListener(this);
+
+            for (int i = 0; i < electrodeGrid->getNumCells(); i++)
             {
-                electrodeButtons[i]->setClickingTogglesState(true);
-                electrodeButtons[i]->removeMouseListener(this);
-                if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == selectedReference)
+                if (referenceArray[electrodeGrid->getCellLabel(i)-1] == selectedReference)
                 {
-                    electrodeButtons[i]->setToggleState(true, dontSendNotification);
+                    electrodeGrid->setCellSelected(i, true);
                 }
                 else
                 {
-                    electrodeButtons[i]->setToggleState(false, dontSendNotification);
+                    electrodeGrid->setCellSelected(i, false);
                 }
-                if ((enabledChannelArray[electrodeButtons[i]->getChannelNum()-1]) && (electrodeButtons[i]->getChannelNum() <= getProcessor()->getNumInputs()))
+                if ((enabledChannelArray[electrodeGrid->getCellLabel(i)-1]) && (electrodeGrid->getCellLabel(i) <= getProcessor()->getNumInputs()))
                 {
-                    electrodeButtons[i]->setEnabled(true);
+                    electrodeGrid->setCellEnabled(i, true);
                 }
                 else
                 {
-                    electrodeButtons[i]->setEnabled(false);
+                    electrodeGrid->setCellEnabled(i, false);
                 }
             }
             selectAllButton->setEnabled(true);
@@ -339,20 +310,20 @@ void ChannelMappingEditor::buttonEvent(Button* button)
                 referenceButtons[i]->setToggleState(false, dontSendNotification);
             }
 
-            for (int i = 0; i < electrodeButtons.size(); i++)
+            electrodeGrid->setClickingTogglesState(false);
+            electrodeGrid->addMouseListener(this,false);
+
+            for (int i = 0; i < electrodeGrid->getNumCells(); i++)
             {
-                electrodeButtons[i]->setClickingTogglesState(false);
-                electrodeButtons[i]->setEnabled(true);
-                if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1])
+                electrodeGrid->setCellEnabled(i, true);
+                if (enabledChannelArray[electrodeGrid->getCellLabel(i)-1])
                 {
-                    electrodeButtons[i]->setToggleState(true, dontSendNotification);
+                    electrodeGrid->setCellSelected(i, true);
                 }
                 else
                 {
-                    electrodeButtons[i]->setToggleState(false, dontSendNotification);
+                    electrodeGrid->setCellSelected(i, false);
                 }
-                electrodeButtons[i]->addMouseListener(this,false);
-
             }
             selectAllButton->setEnabled(false);
         }
@@ -370,154 +341,21 @@ void ChannelMappingEditor::buttonEvent(Button* button)
         }
         channelSelector->setActiveChannels(a);
 
-        for (int i = 0; i < electrodeButtons.size(); i++)
+        for (int i = 0; i < electrodeGrid->getNumCells(); i++)
         {
-            if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == selectedReference)
+            if (referenceArray[electrodeGrid->getCellLabel(i)-1] == selectedReference)
             {
-                electrodeButtons[i]->setToggleState(true, dontSendNotification);
+                electrodeGrid->setCellSelected(i, true);
             }
             else
             {
-                electrodeButtons[i]->setToggleState(false, dontSendNotification);
+                electrodeGrid->setCellSelected(i, false);
             }
         }
         previousClickedChan = -1;
 
     }
-    else if (electrodeButtons.contains((ElectrodeButton*)button))
-    {
-        if (!reorderActive)
-        {
-            setConfigured(true);
-            int clickedChan = electrodeButtons.indexOf((ElectrodeButton*)button);
-
-            if (ModifierKeys::getCurrentModifiers().isShiftDown() && (previousClickedChan >= 0))
-            {
-                int toChanA = 0;
-                int toChanD = 0;
-                int fromChanA = 0;
-                int fromChanD = 0;
-
-                if (previousShiftClickedChan < 0)
-                {
-                    previousShiftClickedChan = clickedChan;
-                    if (clickedChan > previousClickedChan)
-                    {
-                        toChanA = clickedChan;
-                        fromChanA = previousClickedChan;
-                    }
-                    else
-                    {
-                        toChanA = previousClickedChan;
-                        fromChanA = clickedChan;
-                    }
-                    for (int i = fromChanA; i <= toChanA; i++)
-                    {
-                        electrodeButtons[i]->setToggleState(previousClickedState, dontSendNotification);
-                        setChannelReference(electrodeButtons[i]);
-                    }
-                }
-                else
-                {
-                    if ((clickedChan > previousClickedChan) && (clickedChan > previousShiftClickedChan))
-                    {
-                        fromChanA = previousShiftClickedChan+1;
-                        toChanA = clickedChan;
-                        if (previousShiftClickedChan < previousClickedChan)
-                        {
-                            fromChanD = previousShiftClickedChan;
-                            toChanD = previousClickedChan-1;
-                        }
-                        else
-                        {
-                            fromChanD = -1;
-                        }
-                    }
-                    else if ((clickedChan > previousClickedChan) && (clickedChan < previousShiftClickedChan))
-                    {
-                        fromChanA = -1;
-                        fromChanD = clickedChan+1;
-                        toChanD = previousShiftClickedChan;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                    }
-                    else if ((clickedChan < previousClickedChan) && (clickedChan < previousShiftClickedChan))
-                    {
-                        fromChanA = clickedChan;
-                        toChanA = previousShiftClickedChan-1;
-                        if (previousShiftClickedChan > previousClickedChan)
-                        {
-                            fromChanD = previousClickedChan+1;
-                            toChanD = previousShiftClickedChan;
-                        }
-                        else
-                        {
-                            fromChanD = -1;
-                        }
-                    }
-                    else if ((clickedChan < previousClickedChan) && (clickedChan > previousShiftClickedChan))
-                    {
-                        fromChanA = -1;
-                        fromChanD = previousShiftClickedChan;
-                        toChanD = clickedChan - 1;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                    }
-                    else if (clickedChan == previousShiftClickedChan)
-                    {
-                        fromChanA = -1;
-                        fromChanD = -1;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                    }
-                    else
-                    {
-                        fromChanA = -1;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                        if (previousShiftClickedChan < previousClickedChan)
-                        {
-                            fromChanD = previousShiftClickedChan;
-                            toChanD = previousClickedChan - 1;
-                        }
-                        else if (previousShiftClickedChan > previousClickedChan)
-                        {
-                            fromChanD = previousClickedChan + 1;
-                            toChanD = previousShiftClickedChan;
-                        }
-                        else
-                        {
-                            fromChanD = -1;
-                        }
-                    }
-
-                    if (fromChanA >= 0)
-                    {
-                        for (int i = fromChanA; i <= toChanA; i++)
-                        {
-                            electrodeButtons[i]->setToggleState(previousClickedState, dontSendNotification);
-                            setChannelReference(electrodeButtons[i]);
-                        }
-                    }
-                    if (fromChanD >= 0)
-                    {
-                        for (int i = fromChanD; i <= toChanD; i++)
-                        {
-                            electrodeButtons[i]->setToggleState(!previousClickedState, dontSendNotification);
-                            setChannelReference(electrodeButtons[i]);
-                        }
-                    }
-                }
-
-                previousShiftClickedChan = clickedChan;
-            }
-            else
-            {
-                previousClickedChan = clickedChan;
-                previousShiftClickedChan = -1;
-                setChannelReference((ElectrodeButton*)button);
-                previousClickedState = button->getToggleState();
-            }
-
-
-        }
-    } else if (button == saveButton)
+    else if (button == saveButton)
     {
         //std::cout << "Save button clicked." << std::endl;
 
@@ -565,12 +403,145 @@ void ChannelMappingEditor::buttonEvent(Button* button)
     }
 }
 
-void ChannelMappingEditor::setChannelReference(ElectrodeButton* button)
+void ChannelMappingEditor::channelGridCellClicked(ChannelGrid* grid, int cell)
+{
+    if (!reorderActive)
+    {
+        setConfigured(true);
+        int clickedChan = cell;
+
+        if (ModifierKeys::getCurrentModifiers().isShiftDown() && (previousClickedChan >= 0))
+        {
+            int toChanA = 0;
+            int toChanD = 0;
+            int fromChanA = 0;
+            int fromChanD = 0;
+
+            if (previousShiftClickedChan < 0)
+            {
+                previousShiftClickedChan = clickedChan;
+                if (clickedChan > previousClickedChan)
+                {
+                    toChanA = clickedChan;
+                    fromChanA = previousClickedChan;
+                }
+                else
+                {
+                    toChanA = previousClickedChan;
+                    fromChanA = clickedChan;
+                }
+                for (int i = fromChanA; i <= toChanA; i++)
+                {
+                    electrodeGrid->setCellSelected(i, previousClickedState);
+                    setChannelReference(i);
+                }
+            }
+            else
+            {
+                if ((clickedChan > previousClickedChan) && (clickedChan > previousShiftClickedChan))
+                {
+                    fromChanA = previousShiftClickedChan+1;
+                    toChanA = clickedChan;
+                    if (previousShiftClickedChan < previousClickedChan)
+                    {
+                        fromChanD = previousShiftClickedChan;
+                        toChanD = previousClickedChan-1;
+                    }
+                    else
+                    {
+                        fromChanD = -1;
+                    }
+                }
+                else if ((clickedChan > previousClickedChan) && (clickedChan < previousShiftClickedChan))
+                {
+                    fromChanA = -1;
+                    fromChanD = clickedChan+1;
+                    toChanD = previousShiftClickedChan;
+                    electrodeGrid->setCellSelected(clickedChan, previousClickedState); // Do not toggle this channel;
+                }
+                else if ((clickedChan < previousClickedChan) && (clickedChan < previousShiftClickedChan))
+                {
+                    fromChanA = clickedChan;
+                    toChanA = previousShiftClickedChan-1;
+                    if (previousShiftClickedChan > previousClickedChan)
+                    {
+                        fromChanD = previousClickedChan+1;
+                        toChanD = previousShiftClickedChan;
+                    }
+                    else
+                    {
+                        fromChanD = -1;
+                    }
+                }
+                else if ((clickedChan < previousClickedChan) && (clickedChan > previousShiftClickedChan))
+                {
+                    fromChanA = -1;
+                    fromChanD = previousShiftClickedChan;
+                    toChanD = clickedChan - 1;
+                    electrodeGrid->setCellSelected(clickedChan, previousClickedState); // Do not toggle this channel;
+                }
+                else if (clickedChan == previousShiftClickedChan)
+                {
+                    fromChanA = -1;
+                    fromChanD = -1;
+                    electrodeGrid->setCellSelected(clickedChan, previousClickedState); // Do not toggle this channel;
+                }
+                else
+                {
+                    fromChanA = -1;
+                    electrodeGrid->setCellSelected(clickedChan, previousClickedState); // Do not toggle this channel;
+                    if (previousShiftClickedChan < previousClickedChan)
+                    {
+                        fromChanD = previousShiftClickedChan;
+                        toChanD = previousClickedChan - 1;
+                    }
+                    else if (previousShiftClickedChan > previousClickedChan)
+                    {
+                        fromChanD = previousClickedChan + 1;
+                        toChanD = previousShiftClickedChan;
+                    }
+                    else
+                    {
+                        fromChanD = -1;
+                    }
+                }
+
+                if (fromChanA >= 0)
+                {
+                    for (int i = fromChanA; i <= toChanA; i++)
+                    {
+                        electrodeGrid->setCellSelected(i, previousClickedState);
+                        setChannelReference(i);
+                    }
+                }
+                if (fromChanD >= 0)
+                {
+                    for (int i = fromChanD; i <= toChanD; i++)
+                    {
+                        electrodeGrid->setCellSelected(i, !previousClickedState);
+                        setChannelReference(i);
+                    }
+                }
+            }
+
+            previousShiftClickedChan = clickedChan;
+        }
+        else
+        {
+            previousClickedChan = clickedChan;
+            previousShiftClickedChan = -1;
+            setChannelReference(clickedChan);
+            previousClickedState = electrodeGrid->isCellSelected(clickedChan);
+        }
+    }
+}
+
+void ChannelMappingEditor::setChannelReference(int position)
 {
-    int chan = button->getChannelNum()-1;
+    int chan = electrodeGrid->getCellLabel(position)-1;
     getProcessor()->setCurrentChannel(chan);
 
-    if (button->getToggleState())
+    if (electrodeGrid->isCellSelected(position))
     {
         referenceArray.set(chan,selectedReference);
         getProcessor()->setParameter(1,selectedReference);
@@ -648,9 +619,8 @@ void ChannelMappingEditor::loadCustomParameters(XmlElement* xml)
             referenceArray.set(mapping-1, reference);
             enabledChannelArray.set(mapping-1,enabled);
 
-            electrodeButtons[i]->setChannelNum(mapping);
-            electrodeButtons[i]->setEnabled(enabled);
-            electrodeButtons[i]->repaint();
+            electrodeGrid->setCellLabel(i, mapping);
+            electrodeGrid->setCellEnabled(i, enabled);
 
 
             getProcessor()->setCurrentChannel(i);
@@ -682,15 +652,15 @@ void ChannelMappingEditor::loadCustomParameters(XmlElement* xml)
         }
     }
 
-    for (int i = 0; i < electrodeButtons.size(); i++)
+    for (int i = 0; i < electrodeGrid->getNumCells(); i++)
     {
-        if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == selectedReference)
+        if (referenceArray[electrodeGrid->getCellLabel(i)-1] == selectedReference)
         {
-            electrodeButtons[i]->setToggleState(true, dontSendNotification);
+            electrodeGrid->setCellSelected(i, true);
         }
         else
         {
-            electrodeButtons[i]->setToggleState(false, dontSendNotification);
+            electrodeGrid->setCellSelected(i, false);
         }
     }
 
@@ -702,20 +672,23 @@ void ChannelMappingEditor::mouseDrag(const MouseEvent& e)
 {
     if (reorderActive)
     {
-        if ((!isDragging) && (electrodeButtons.contains((ElectrodeButton*) e.originalComponent)))
+        int cell = -1;
+        if ((!isDragging) && (e.originalComponent == electrodeGrid))
+            cell = electrodeGrid->getCellAt(e.getEventRelativeTo(electrodeGrid).getMouseDownPosition());
+
+        if (cell >= 0)
         {
-            ElectrodeButton* button = (ElectrodeButton*)e.originalComponent;
             isDragging = true;
 
             String desc = "EditorDrag/MAP/";
-            desc += button->getChannelNum();
+            desc += electrodeGrid->getCellLabel(cell);
 
             const String dragDescription = desc;
 
             Image dragImage(Image::ARGB,20,15,true);
 
             Graphics g(dragImage);
-            if (button->getToggleState())
+            if (electrodeGrid->isCellSelected(cell))
             {
                 g.setColour(Colours::orange);
             }
@@ -725,15 +698,15 @@ void ChannelMappingEditor::mouseDrag(const MouseEvent& e)
             }
             g.fillAll();
             g.setColour(Colours::black);
-            g.drawText(String(button->getChannelNum()),0,0,20,15,Justification::centred,true);
+            g.drawText(String(electrodeGrid->getCellLabel(cell)),0,0,20,15,Justification::centred,true);
 
             dragImage.multiplyAllAlphas(0.6f);
 
             startDragging(dragDescription,this,dragImage,false);
-            button->setVisible(false);
-            initialDraggedButton = electrodeButtons.indexOf(button);
+            electrodeGrid->setCellHidden(cell, true);
+            initialDraggedButton = cell;
             lastHoverButton = initialDraggedButton;
-            draggingChannel = button->getChannelNum();
+            draggingChannel = electrodeGrid->getCellLabel(cell);
         }
         else if (isDragging)
         {
@@ -762,29 +735,29 @@ void ChannelMappingEditor::mouseDrag(const MouseEvent& e)
 
             int hoverButton = row*16+col;
 
-            if (hoverButton >= electrodeButtons.size())
+            if (hoverButton >= electrodeGrid->getNumCells())
             {
-                hoverButton = electrodeButtons.size() -1;
+                hoverButton = electrodeGrid->getNumCells() -1;
             }
 
             if (hoverButton != lastHoverButton)
             {
 
-                electrodeButtons[lastHoverButton]->setVisible(true);
-                electrodeButtons[hoverButton]->setVisible(false);
+                electrodeGrid->setCellHidden(lastHoverButton, false);
+                electrodeGrid->setCellHidden(hoverButton, true);
 
                 if (lastHoverButton > hoverButton)
                 {
                     for (int i = lastHoverButton; i > hoverButton; i--)
                     {
-                        electrodeButtons[i]->setChannelNum(electrodeButtons[i-1]->getChannelNum());
-                        if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1]) //Could be more compact, but definitely less legible
+                        electrodeGrid->setCellLabel(i, electrodeGrid->getCellLabel(i-1));
+                        if (enabledChannelArray[electrodeGrid->getCellLabel(i)-1]) //Could be more compact, but definitely less legible
                         {
-                            electrodeButtons[i]->setToggleState(true, dontSendNotification);
+                            electrodeGrid->setCellSelected(i, true);
                         }
                         else
                         {
-                            electrodeButtons[i]->setToggleState(false, dontSendNotification);
+                            electrodeGrid->setCellSelected(i, false);
                         }
                     }
                 }
@@ -792,19 +765,19 @@ void ChannelMappingEditor::mouseDrag(const MouseEvent& e)
                 {
                     for (int i = lastHoverButton; i < hoverButton; i++)
                     {
-                        electrodeButtons[i]->setChannelNum(electrodeButtons[i+1]->getChannelNum());
-                        if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1])
+                        electrodeGrid->setCellLabel(i, electrodeGrid->getCellLabel(i+1));
+                        if (enabledChannelArray[electrodeGrid->getCellLabel(i)-1])
                         {
-                            electrodeButtons[i]->setToggleState(true, dontSendNotification);
+                            electrodeGrid->setCellSelected(i, true);
                         }
                         else
                         {
-                            electrodeButtons[i]->setToggleState(false, dontSendNotification);
+                            electrodeGrid->setCellSelected(i, false);
                         }
                     }
                 }
-                electrodeButtons[hoverButton]->setChannelNum(draggingChannel);
-                electrodeButtons[hoverButton]->setToggleState(enabledChannelArray[draggingChannel-1], dontSendNotification);
+                electrodeGrid->setCellLabel(hoverButton, draggingChannel);
+                electrodeGrid->setCellSelected(hoverButton, enabledChannelArray[draggingChannel-1]);
 
                 lastHoverButton = hoverButton;
                 repaint();
@@ -820,7 +793,7 @@ void ChannelMappingEditor::mouseUp(const MouseEvent& e)
     if (isDragging)
     {
         isDragging = false;
-        electrodeButtons[lastHoverButton]->setVisible(true);
+        electrodeGrid->setCellHidden(lastHoverButton, false);
         int from, to;
         if (lastHoverButton == initialDraggedButton)
         {
@@ -839,7 +812,7 @@ void ChannelMappingEditor::mouseUp(const MouseEvent& e)
 
         for (int i=from; i <= to; i++)
         {
-            setChannelPosition(i,electrodeButtons[i]->getChannelNum());
+            setChannelPosition(i,electrodeGrid->getCellLabel(i));
         }
         setConfigured(true);
 		CoreServices::updateSignalChain(this);
@@ -855,22 +828,26 @@ void ChannelMappingEditor::setChannelPosition(int position, int channel)
 
 void ChannelMappingEditor::mouseDoubleClick(const MouseEvent& e)
 {
-    if ((reorderActive) && electrodeButtons.contains((ElectrodeButton*)e.originalComponent))
+    int cell = -1;
+    if ((reorderActive) && (e.originalComponent == electrodeGrid))
+        cell = electrodeGrid->getCellAt(e.getEventRelativeTo(electrodeGrid).getPosition());
+
+    if (cell >= 0)
     {
         setConfigured(true);
-        ElectrodeButton* button = (ElectrodeButton*)e.originalComponent;
-        if (button->getToggleState())
+        int channel = electrodeGrid->getCellLabel(cell);
+        if (electrodeGrid->isCellSelected(cell))
         {
-            button->setToggleState(false, dontSendNotification);
-            enabledChannelArray.set(button->getChannelNum()-1,false);
-            getProcessor()->setCurrentChannel(button->getChannelNum()-1);
+            electrodeGrid->setCellSelected(cell, false);
+            enabledChannelArray.set(channel-1,false);
+            getProcessor()->setCurrentChannel(channel-1);
             getProcessor()->setParameter(3,0);
         }
         else
         {
-            button->setToggleState(true, dontSendNotification);
-            enabledChannelArray.set(button->getChannelNum()-1,true);
-            getProcessor()->setCurrentChannel(button->getChannelNum()-1);
+            electrodeGrid->setCellSelected(cell, true);
+            enabledChannelArray.set(channel-1,true);
+            getProcessor()->setCurrentChannel(channel-1);
             getProcessor()->setParameter(3,1);
         }
 		CoreServices::updateSignalChain(this);
@@ -879,21 +856,21 @@ void ChannelMappingEditor::mouseDoubleClick(const MouseEvent& e)
 
 void ChannelMappingEditor::checkUnusedChannels()
 {
-    for (int i = 0; i < electrodeButtons.size(); i++)
+    for (int i = 0; i < electrodeGrid->getNumCells(); i++)
     {
-        if (electrodeButtons[i]->getChannelNum() > getProcessor()->getNumInputs())
+        if (electrodeGrid->getCellLabel(i) > getProcessor()->getNumInputs())
         {
-            electrodeButtons[i]->setEnabled(false);
+            electrodeGrid->setCellEnabled(i, false);
         }
         else
         {
-            if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1])
+            if (enabledChannelArray[electrodeGrid->getCellLabel(i)-1])
             {
-                electrodeButtons[i]->setEnabled(true);
+                electrodeGrid->setCellEnabled(i, true);
             }
             else
             {
-                electrodeButtons[i]->setEnabled(false);
+                electrodeGrid->setCellEnabled(i, false);
             }
         }
     }
@@ -1023,8 +1000,8 @@ String ChannelMappingEditor::loadPrbFile(File filename)
         bool en = enbl->getUnchecked(i);
         enabledChannelArray.set(ch-1, en);
 
-        electrodeButtons[i]->setChannelNum(ch);
-        electrodeButtons[i]->setEnabled(en);
+        electrodeGrid->setCellLabel(i, ch);
+        electrodeGrid->setCellEnabled(i, en);
 		
 		getProcessor()->setCurrentChannel(i);
 		getProcessor()->setParameter(0,ch-1);
@@ -1048,15 +1025,15 @@ String ChannelMappingEditor::loadPrbFile(File filename)
 
     referenceButtons[0]->setToggleState(true, sendNotificationSync);
 
-    for (int i = 0; i < electrodeButtons.size(); i++)
+    for (int i = 0; i < electrodeGrid->getNumCells(); i++)
     {
-        if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == 0)
+        if (referenceArray[electrodeGrid->getCellLabel(i)-1] == 0)
         {
-            electrodeButtons[i]->setToggleState(true, dontSendNotification);
+            electrodeGrid->setCellSelected(i, true);
         }
         else
         {
-            electrodeButtons[i]->setToggleState(false, dontSendNotification);
+            electrodeGrid->setCellSelected(i, false);
         }
     }
 
@@ -39,7 +39,8 @@
 */
 
 class ChannelMappingEditor : public GenericEditor,
-    public DragAndDropContainer
+    public DragAndDropContainer,
+    public ChannelGrid::Listener
 
 {
 public:
@@ -57,6 +58,8 @@ public:
 
     void channelChanged (int channel, bool newState) override;
 
+    void channelGridCellClicked (ChannelGrid* grid, int cell) override;
+
     void mouseDrag(const MouseEvent& e);
 
     void mouseUp(const MouseEvent& e);
@@ -74,14 +77,13 @@ public:
 
 private:
 
-    void setChannelReference(ElectrodeButton* button);
+    void setChannelReference(int position);
     void setChannelPosition(int position, int channel);
     void checkUnusedChannels();
     void setConfigured(bool state);
 
     void refreshButtonLocations();
 
-    OwnedArray<ElectrodeButton> electrodeButtons;
     OwnedArray<ElectrodeButton> referenceButtons;
     ScopedPointer<ElectrodeEditorButton> selectAllButton;
     ScopedPointer<ElectrodeEditorButton> modifyButton;
@@ -89,7 +91,7 @@ private:
     ScopedPointer<LoadButton> loadButton;
     ScopedPointer<SaveButton> saveButton;
     ScopedPointer<Viewport> electrodeButtonViewport;
-    ScopedPointer<Component> electrodeButtonHolder;
+    ScopedPointer<ChannelGrid> electrodeGrid;
 
     Array<int> channelArray;
     Array<int> referenceArray;
@@ -27,7 +27,7 @@
 
 ChannelMappingNode::ChannelMappingNode()
     : GenericProcessor  ("Channel Map")
-    , channelBuffer     (1, 10000)
+    , planVersion       (-1)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
@@ -65,9 +65,6 @@ AudioProcessorEditor* ChannelMappingNode::createEditor()
 
 void ChannelMappingNode::updateSettings()
 {
-    if (getNumInputs() > 0)
-        channelBuffer.setSize (getNumInputs(), 10000);
-
     if (editorIsConfigured)
     {
         OwnedArray<DataChannel> oldChannels;
@@ -96,6 +93,12 @@ void ChannelMappingNode::updateSettings()
             dataChannelArray[i]->setRecordState (recordStates[i]);
         }
     }
+
+    // sized for any mapping of these inputs, so changing references while acquiring does not allocate
+    gatherPlan.prepare (getNumInputs());
+
+    planVersion = mappingVersion.get();
+    gatherPlan.build (channelArray, enabledChannelArray, referenceArray, referenceChannels, settings.numOutputs);
 }
 
 
@@ -121,51 +124,21 @@ void ChannelMappingNode::setParameter (int parameterIndex, float newValue)
     {
         channelArray.set (currentChannel, (int) newValue);
     }
+
+    ++mappingVersion;
 }
 
 
 void ChannelMappingNode::process (AudioSampleBuffer& buffer)
 {
-    int j = 0;
-    int i = 0;
-    int realChan;
-
-    // use copy constructor to set the data to refer to
-    channelBuffer = buffer;
-
-   // buffer.clear();
-
-    while (j < settings.numOutputs)
+    if (planVersion != mappingVersion.get())
     {
-        realChan = channelArray[i];
-        if ((realChan < channelBuffer.getNumChannels())
-            && (enabledChannelArray[realChan]))
-        {
-            // copy it back into the buffer according to the channel mapping
-            buffer.copyFrom (j,                                       // destChannel
-                             0,                                       // destStartSample
-                             channelBuffer.getReadPointer (realChan), // source
-                             getNumSamples (j),                       // numSamples
-                             1.0f); // gain to apply to source (positive for original signal)
-
-            // now do the referencing
-            if ((referenceArray[realChan] > -1)
-                && (referenceChannels[referenceArray[realChan]] > -1)
-                && (referenceChannels[referenceArray[realChan]] < channelBuffer.getNumChannels()))
-            {
-                buffer.addFrom (j,                                                                // destChannel
-                                0,                                                                // destStartSample
-                                channelBuffer,                                                    // source
-                                channelArray[referenceChannels[referenceArray[realChan]]], // sourceChannel
-                                0,                                                                // sourceStartSample
-                                getNumSamples (j),                                                // numSamples
-                                -1.0f); // gain to apply to source (negative for reference)
-            }
+        planVersion = mappingVersion.get();
+        gatherPlan.build (channelArray, enabledChannelArray, referenceArray, referenceChannels, settings.numOutputs);
+    }
 
-            ++j;
-        }
+    for (int j = 0; j < gatherPlan.getNumOutputs(); ++j)
+        gatherPlan.setNumSamples (j, getNumSamples (j));
 
-        ++i;
-    }
+    gatherPlan.process (buffer);
 }
-
@@ -25,6 +25,7 @@
 
 
 #include <ProcessorHeaders.h>
+#include "ChannelGatherPlan.h"
 
 
 /**
@@ -33,6 +34,8 @@
     Allows the user to select a subset of channels, remap their order, and reference them against
     any other channel.
 
+    The mapping is compiled into a ChannelGatherPlan, which rearranges the channels in place.
+
     @see GenericProcessor
 */
 class ChannelMappingNode : public GenericProcessor
@@ -60,7 +63,11 @@ private:
 
     bool editorIsConfigured;
 
-    AudioSampleBuffer channelBuffer;
+    ChannelGatherPlan gatherPlan;
+
+    // bumped by parameter changes, references can change while acquiring
+    Atomic<int> mappingVersion;
+    int planVersion;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelMappingNode);
 };
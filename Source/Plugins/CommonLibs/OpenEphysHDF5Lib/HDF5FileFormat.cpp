@@ -24,13 +24,21 @@
 #include <H5Cpp.h>
 #include "HDF5FileFormat.h"
 
+//H5Dwrite_chunk is part of the main library since 1.10.2. With older versions the datasets are still
+//compressed, but by HDF5 itself inside H5Dwrite
+#if H5_VERSION_GE(1,10,2)
+#define HDF5_DIRECT_CHUNK_WRITE
+#endif
+
+//compressed chunks waiting to be written before the record thread waits for them
+#define MAX_QUEUED_CHUNKS 8
 
 using namespace H5;
 using namespace OpenEphysHDF5;
 
 //HDF5FileBase
 
-HDF5FileBase::HDF5FileBase() : readyToOpen(false), opened(false)
+HDF5FileBase::HDF5FileBase() : readyToOpen(false), opened(false), compressionLevel(0), compressionPool(nullptr)
 {
     Exception::dontPrint();
 };
@@ -50,6 +58,12 @@ bool HDF5FileBase::isReadyToOpen() const
 	return readyToOpen;
 }
 
+void HDF5FileBase::setCompression(int deflateLevel, ThreadPool* pool)
+{
+	compressionLevel = jlimit(0, 9, deflateLevel);
+	compressionPool = pool;
+}
+
 int HDF5FileBase::open()
 {
 	return open(-1);
@@ -335,29 +349,29 @@ HDF5RecordingData* HDF5FileBase::getDataSet(String path)
     }
 }
 
-HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int chunkX, String path)
+HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int chunkX, String path, bool compressed)
 {
     int chunks[3] = {chunkX, 0, 0};
-    return createDataSet(type,1,&sizeX,chunks,path);
+    return createDataSet(type,1,&sizeX,chunks,path,compressed);
 }
 
-HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int sizeY, int chunkX, String path)
+HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int sizeY, int chunkX, String path, bool compressed)
 {
     int size[2];
     int chunks[3] = {chunkX, 0, 0};
     size[0] = sizeX;
     size[1] = sizeY;
-    return createDataSet(type,2,size,chunks,path);
+    return createDataSet(type,2,size,chunks,path,compressed);
 }
 
-HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int sizeY, int sizeZ, int chunkX, String path)
+HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int sizeY, int sizeZ, int chunkX, String path, bool compressed)
 {
     int size[3];
     int chunks[3] = {chunkX, 0, 0};
     size[0] = sizeX;
     size[1] = sizeY;
     size[2] = sizeZ;
-    return createDataSet(type,3,size,chunks,path);
+    return createDataSet(type,3,size,chunks,path,compressed);
 }
 
 HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int sizeY, int sizeZ, int chunkX, int chunkY, String path)
@@ -367,10 +381,10 @@ HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int sizeX, int
     size[0] = sizeX;
     size[1] = sizeY;
     size[2] = sizeZ;
-    return createDataSet(type,3,size,chunks,path);
+    return createDataSet(type,3,size,chunks,path,false);
 }
 
-HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int dimension, int* size, int* chunking, String path)
+HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int dimension, int* size, int* chunking, String path, bool compressed)
 {
     ScopedPointer<DataSet> data;
     DSetCreatPropList prop;
@@ -382,6 +396,14 @@ HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int dimension,
 
     DataType H5type = getH5Type(type);
 
+    //the chunk writer only handles datasets that grow along x in chunks spanning the other dimensions
+    bool compress = compressed && compressionLevel > 0 && chunking[0] > 0;
+    for (int i = 1; i < dimension; i++)
+    {
+        if (chunking[i] > 0)
+            compress = false;
+    }
+
     hsize_t dims[3], chunk_dims[3], max_dims[3];
 
     for (int i=0; i < dimension; i++)
@@ -403,9 +425,20 @@ HDF5RecordingData* HDF5FileBase::createDataSet(BaseDataType type, int dimension,
     {
         DataSpace dSpace(dimension,dims,max_dims);
         prop.setChunk(dimension,chunk_dims);
+        if (compress)
+        {
+            //the order matters, the chunk writer applies shuffle first and deflate second
+            prop.setShuffle();
+            prop.setDeflate(compressionLevel);
+        }
 
         data = new DataSet(file->createDataSet(path.toUTF8(),H5type,dSpace,prop));
-        return new HDF5RecordingData(data.release());
+        HDF5RecordingData* recData = new HDF5RecordingData(data.release());
+#ifdef HDF5_DIRECT_CHUNK_WRITE
+        if (compress && compressionPool != nullptr)
+            recData->setChunkCompression(compressionLevel, compressionPool);
+#endif
+        return recData;
     }
     catch (DataSetIException error)
     {
@@ -553,6 +586,273 @@ const HDF5FileBase::BaseDataType HDF5FileBase::BaseDataType::F32 = HDF5FileBase:
 const HDF5FileBase::BaseDataType HDF5FileBase::BaseDataType::F64 = HDF5FileBase::BaseDataType(T_F64, 1);
 const HDF5FileBase::BaseDataType HDF5FileBase::BaseDataType::DSTR = HDF5FileBase::BaseDataType(T_STR, DEFAULT_STR_SIZE);
 
+//ChunkWriter
+
+/** Gathers the rows of a compressed dataset into chunks, shuffles and deflates full chunks on a
+thread pool and writes them in order with H5Dwrite_chunk. Only the calling thread touches HDF5. */
+class HDF5RecordingData::ChunkWriter
+{
+public:
+	ChunkWriter(DataSet* dataSet, int chunkX, int numColumns, int numZ, size_t elementSize, int deflateLevel, ThreadPool* pool);
+	~ChunkWriter();
+
+	bool accepts(HDF5FileBase::BaseDataType type);
+	/** Copies whole rows, laid out as in the dataset */
+	void writeRows(int64 xStart, int numRows, const void* data);
+	/** Copies numRows values of a single column of a 2D dataset */
+	void writeColumn(int column, int64 xStart, int numRows, const void* data);
+	/** Writes out the chunks holding data up to xEnd, the last one padded with zeroes */
+	void finish(int64 xEnd);
+
+private:
+	class Chunk : public ThreadPoolJob
+	{
+	public:
+		Chunk(size_t numBytes, size_t elementSize, int deflateLevel);
+		JobStatus runJob() override;
+		void reset(int64 chunkIndex);
+		const void* getOutput() const;
+		size_t getOutputSize() const;
+
+		int64 index;
+		int columnsDone;
+		HeapBlock<uint8> data;
+		uint32 filterMask;
+
+	private:
+		const size_t m_numBytes;
+		const size_t m_elementSize;
+		const int m_level;
+		HeapBlock<uint8> m_shuffled;
+		MemoryOutputStream m_compressed;
+	};
+
+	Chunk* getChunk(int64 chunkIndex);
+	void submitFullChunks();
+	void writeCompressedChunks(bool waitForAll);
+
+	DataSet* const dSet;
+	ThreadPool* const pool;
+	const int chunkX;
+	const int numColumns;
+	const size_t elementSize;
+	const size_t rowBytes;
+	const int level;
+	HDF5FileBase::BaseDataType checkedType;
+
+	OwnedArray<Chunk> chunks;
+	Array<Chunk*> freeChunks;
+	Array<Chunk*> openChunks; //being filled, in order
+	Array<Chunk*> queuedChunks; //being compressed, in order
+	int64 firstOpenChunk;
+	bool failed;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChunkWriter);
+};
+
+HDF5RecordingData::ChunkWriter::Chunk::Chunk(size_t numBytes, size_t elementSize, int deflateLevel) :
+ThreadPoolJob("HDF5 chunk"),
+index(0),
+columnsDone(0),
+filterMask(0),
+m_numBytes(numBytes),
+m_elementSize(elementSize),
+m_level(deflateLevel),
+m_compressed(numBytes)
+{
+	data.malloc(numBytes);
+	if (elementSize > 1)
+		m_shuffled.malloc(numBytes);
+}
+
+void HDF5RecordingData::ChunkWriter::Chunk::reset(int64 chunkIndex)
+{
+	index = chunkIndex;
+	columnsDone = 0;
+	//the end of the last chunk is never written
+	zeromem(data, m_numBytes);
+}
+
+ThreadPoolJob::JobStatus HDF5RecordingData::ChunkWriter::Chunk::runJob()
+{
+	//same byte order as the HDF5 shuffle filter: first bytes of all elements, then second bytes...
+	const uint8* source = data;
+	if (m_elementSize > 1)
+	{
+		const size_t numElements = m_numBytes / m_elementSize;
+		for (size_t b = 0; b < m_elementSize; b++)
+		{
+			const uint8* in = data + b;
+			uint8* out = m_shuffled + b * numElements;
+			for (size_t i = 0; i < numElements; i++)
+				out[i] = in[i * m_elementSize];
+		}
+		source = m_shuffled;
+	}
+
+	//zlib format, as written by the deflate filter
+	m_compressed.reset();
+	{
+		GZIPCompressorOutputStream zip(&m_compressed, m_level, false);
+		zip.write(source, m_numBytes);
+	}
+
+	//both filters are optional, so chunks that don't compress are stored as they are
+	filterMask = (m_compressed.getDataSize() < m_numBytes) ? 0 : 0x3;
+	return jobHasFinished;
+}
+
+const void* HDF5RecordingData::ChunkWriter::Chunk::getOutput() const
+{
+	return filterMask == 0 ? m_compressed.getData() : data.getData();
+}
+
+size_t HDF5RecordingData::ChunkWriter::Chunk::getOutputSize() const
+{
+	return filterMask == 0 ? m_compressed.getDataSize() : m_numBytes;
+}
+
+HDF5RecordingData::ChunkWriter::ChunkWriter(DataSet* dataSet, int chunkX_, int numColumns_, int numZ, size_t elementSize_, int deflateLevel, ThreadPool* pool_) :
+dSet(dataSet),
+pool(pool_),
+chunkX(chunkX_),
+numColumns(numColumns_),
+elementSize(elementSize_),
+rowBytes(numColumns_ * numZ * elementSize_),
+level(deflateLevel),
+checkedType(HDF5FileBase::BaseDataType::T_STR, 0),
+firstOpenChunk(0),
+failed(false)
+{
+}
+
+HDF5RecordingData::ChunkWriter::~ChunkWriter()
+{
+	//jobs still running would outlive their chunks
+	for (int i = 0; i < queuedChunks.size(); i++)
+		pool->waitForJobToFinish(queuedChunks[i], -1);
+}
+
+bool HDF5RecordingData::ChunkWriter::accepts(HDF5FileBase::BaseDataType type)
+{
+	if (type.type == checkedType.type && type.typeSize == checkedType.typeSize)
+		return true;
+	if (HDF5FileBase::getNativeType(type).getSize() != elementSize)
+		return false;
+	checkedType = type;
+	return true;
+}
+
+HDF5RecordingData::ChunkWriter::Chunk* HDF5RecordingData::ChunkWriter::getChunk(int64 chunkIndex)
+{
+	//rows only move forward, so chunks already handed to the pool are never written again
+	jassert(chunkIndex >= firstOpenChunk);
+	while (openChunks.size() <= chunkIndex - firstOpenChunk)
+	{
+		Chunk* chunk;
+		if (freeChunks.size() > 0)
+			chunk = freeChunks.remove(freeChunks.size() - 1);
+		else
+			chunk = chunks.add(new Chunk(chunkX * rowBytes, elementSize, level));
+		chunk->reset(firstOpenChunk + openChunks.size());
+		openChunks.add(chunk);
+	}
+	return openChunks[int(chunkIndex - firstOpenChunk)];
+}
+
+void HDF5RecordingData::ChunkWriter::writeRows(int64 xStart, int numRows, const void* data)
+{
+	const uint8* source = static_cast<const uint8*>(data);
+	int done = 0;
+	while (done < numRows)
+	{
+		int64 x = xStart + done;
+		Chunk* chunk = getChunk(x / chunkX);
+		int row = int(x % chunkX);
+		int count = jmin(numRows - done, chunkX - row);
+		memcpy(chunk->data + row * rowBytes, source + done * rowBytes, count * rowBytes);
+		if (row + count == chunkX)
+			chunk->columnsDone = numColumns;
+		done += count;
+	}
+	submitFullChunks();
+	writeCompressedChunks(false);
+}
+
+void HDF5RecordingData::ChunkWriter::writeColumn(int column, int64 xStart, int numRows, const void* data)
+{
+	const uint8* source = static_cast<const uint8*>(data);
+	int done = 0;
+	while (done < numRows)
+	{
+		int64 x = xStart + done;
+		Chunk* chunk = getChunk(x / chunkX);
+		int row = int(x % chunkX);
+		int count = jmin(numRows - done, chunkX - row);
+		uint8* dest = chunk->data + row * rowBytes + column * elementSize;
+		if (elementSize == sizeof(int16))
+		{
+			//continuous data, worth avoiding a memcpy call per sample
+			const int16* in = reinterpret_cast<const int16*>(source + done * elementSize);
+			for (int i = 0; i < count; i++)
+				*reinterpret_cast<int16*>(dest + i * rowBytes) = in[i];
+		}
+		else
+		{
+			for (int i = 0; i < count; i++)
+				memcpy(dest + i * rowBytes, source + (done + i) * elementSize, elementSize);
+		}
+		if (row + count == chunkX)
+			chunk->columnsDone++;
+		done += count;
+	}
+	submitFullChunks();
+	writeCompressedChunks(false);
+}
+
+void HDF5RecordingData::ChunkWriter::submitFullChunks()
+{
+	while (openChunks.size() > 0 && openChunks[0]->columnsDone >= numColumns)
+	{
+		Chunk* chunk = openChunks.remove(0);
+		firstOpenChunk++;
+		queuedChunks.add(chunk);
+		pool->addJob(chunk, false);
+	}
+}
+
+void HDF5RecordingData::ChunkWriter::writeCompressedChunks(bool waitForAll)
+{
+	while (queuedChunks.size() > 0)
+	{
+		Chunk* chunk = queuedChunks[0];
+		//chunks are written in order, so wait for the oldest if too many are piling up
+		if (waitForAll || queuedChunks.size() > MAX_QUEUED_CHUNKS)
+			pool->waitForJobToFinish(chunk, -1);
+		else if (pool->contains(chunk))
+			break;
+
+#ifdef HDF5_DIRECT_CHUNK_WRITE
+		hsize_t offset[3] = { hsize_t(chunk->index * chunkX), 0, 0 };
+		if (!failed && H5Dwrite_chunk(dSet->getId(), H5P_DEFAULT, chunk->filterMask, offset, chunk->getOutputSize(), chunk->getOutput()) < 0)
+		{
+			std::cerr << "Error writing compressed chunk " << chunk->index << ", the rest of the dataset will be empty" << std::endl;
+			failed = true;
+		}
+#endif
+		queuedChunks.remove(0);
+		freeChunks.add(chunk);
+	}
+}
+
+void HDF5RecordingData::ChunkWriter::finish(int64 xEnd)
+{
+	for (int i = 0; i < openChunks.size() && openChunks[i]->index * chunkX < xEnd; i++)
+		openChunks[i]->columnsDone = numColumns;
+	submitFullChunks();
+	writeCompressedChunks(true);
+}
+
 //H5RecordingData
 
 HDF5RecordingData::HDF5RecordingData(DataSet* data)
@@ -573,7 +873,7 @@ HDF5RecordingData::HDF5RecordingData(DataSet* data)
         this->size[1] = (int) dims[1];
     else
         this->size[1] = 1;
-    if (dimension > 1)
+    if (dimension > 2)
         this->size[2] = (int) dims[2];
     else
         this->size[2] = 1;
@@ -587,9 +887,22 @@ HDF5RecordingData::HDF5RecordingData(DataSet* data)
 
 HDF5RecordingData::~HDF5RecordingData()
 {
+	if (chunkWriter != nullptr)
+	{
+		chunkWriter->finish(xPos);
+		chunkWriter = nullptr;
+	}
 	//Safety
 	dSet->flush(H5F_SCOPE_GLOBAL);
 }
+
+void HDF5RecordingData::setChunkCompression(int deflateLevel, ThreadPool* pool)
+{
+	size_t elementSize = dSet->getDataType().getSize();
+	if (size[1] * size[2] * elementSize == 0 || xPos > 0)
+		return;
+	chunkWriter = new ChunkWriter(dSet, xChunkSize, size[1], size[2], elementSize, deflateLevel, pool);
+}
 int HDF5RecordingData::writeDataBlock(int xDataSize, HDF5FileBase::BaseDataType type, const void* data)
 {
     return writeDataBlock(xDataSize,size[1],type,data);
@@ -608,6 +921,13 @@ int HDF5RecordingData::writeDataBlock(int xDataSize, int yDataSize, HDF5FileBase
     else
         dim[1] = size[1];
     dim[0] = xPos + xDataSize;
+
+    if (chunkWriter != nullptr && (yDataSize != size[1] || !chunkWriter->accepts(type)))
+    {
+        std::cerr << "Compressed datasets can only be written in whole rows of their own type" << std::endl;
+        return -3;
+    }
+
     try
     {
         //First be sure that we have enough space
@@ -619,6 +939,13 @@ int HDF5RecordingData::writeDataBlock(int xDataSize, int yDataSize, HDF5FileBase
         if (dimension > 1)
             size[1] = (int) dim[1];
 
+        if (chunkWriter != nullptr)
+        {
+            chunkWriter->writeRows(xPos, xDataSize, data);
+            xPos += xDataSize;
+            return 0;
+        }
+
         //Create memory space
         dim[0]=xDataSize;
         dim[1]=yDataSize;
@@ -657,6 +984,7 @@ int HDF5RecordingData::writeDataRow(int yPos, int xDataSize, HDF5FileBase::BaseD
     if (dimension > 2) return -4; //We're not going to write rows in datasets bigger than 2d.
     //    if (xDataSize != rowDataSize) return -2;
     if ((yPos < 0) || (yPos >= size[1])) return -2;
+    if (chunkWriter != nullptr && !chunkWriter->accepts(type)) return -3;
 
     try
     {
@@ -675,6 +1003,13 @@ int HDF5RecordingData::writeDataRow(int yPos, int xDataSize, HDF5FileBase::BaseD
             xPos = rowXPos[yPos]+xDataSize;
         }
 
+        if (chunkWriter != nullptr)
+        {
+            chunkWriter->writeColumn(yPos, rowXPos[yPos], xDataSize, data);
+            rowXPos.set(yPos, rowXPos[yPos] + xDataSize);
+            return 0;
+        }
+
         dim[0] = xDataSize;
         dim[1] = 1;
         DataSpace mSpace(dimension,dim);
@@ -59,6 +59,10 @@ public:
     virtual String getFileName() = 0;
     bool isOpen() const;
 	bool isReadyToOpen() const;
+	/** Enables shuffle and deflate on the datasets created afterwards with compression requested.
+	Chunks are compressed by jobs on the given pool and handed to H5Dwrite_chunk, so the library only
+	does the I/O. The pool must outlive the datasets. A level of 0 turns compression off. */
+	void setCompression(int deflateLevel, ThreadPool* pool);
 	class COMMON_LIB BaseDataType {
 	public:
 		enum Type { T_U8, T_U16, T_U32, T_U64, T_I8, T_I16, T_I32, T_I64, T_F32, T_F64, T_STR };
@@ -98,10 +102,10 @@ protected:
 
     HDF5RecordingData* getDataSet(String path);
 
-    //aliases for createDataSet
-	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int chunkX, String path);
-	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int sizeY, int chunkX, String path);
-	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int sizeY, int sizeZ, int chunkX, String path);
+    //aliases for createDataSet. Compression only applies to datasets chunked along x alone
+	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int chunkX, String path, bool compressed = false);
+	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int sizeY, int chunkX, String path, bool compressed = false);
+	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int sizeY, int sizeZ, int chunkX, String path, bool compressed = false);
 	HDF5RecordingData* createDataSet(BaseDataType type, int sizeX, int sizeY, int sizeZ, int chunkX, int chunkY, String path);
 
     bool readyToOpen;
@@ -110,10 +114,12 @@ private:
 	int setAttributeStrArray(Array<const char*>& data, int maxSize, String path, String name);
 
     //create an extendable dataset
-	HDF5RecordingData* createDataSet(BaseDataType type, int dimension, int* size, int* chunking, String path);
+	HDF5RecordingData* createDataSet(BaseDataType type, int dimension, int* size, int* chunking, String path, bool compressed);
     int open(bool newfile, int nChans);
     ScopedPointer<H5::H5File> file;
     bool opened;
+	int compressionLevel;
+	ThreadPool* compressionPool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HDF5FileBase);
 };
@@ -131,13 +137,20 @@ public:
 
     void getRowXPositions(Array<uint32>& rows);
 
+	/** Compresses full chunks on the pool and writes them with H5Dwrite_chunk instead of going
+	through H5Dwrite. The dataset must already have the shuffle and deflate filters */
+	void setChunkCompression(int deflateLevel, ThreadPool* pool);
+
 private:
+	class ChunkWriter;
+
     int xPos;
     int xChunkSize;
     int size[3];
     int dimension;
     Array<uint32> rowXPos;
     ScopedPointer<H5::DataSet> dSet;
+	ScopedPointer<ChunkWriter> chunkWriter;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HDF5RecordingData);
 };
@@ -116,6 +116,8 @@ void EventBroadcaster::reportActualListeningPort(int port)
 EventBroadcaster::EventBroadcaster()
     : GenericProcessor  ("Event Broadcaster")
     , listeningPort     (0)
+    , sendHighWaterMark (1000)
+    , pendingQueueSize  (0)
 {
     setProcessorType (PROCESSOR_TYPE_SINK);
 
@@ -146,6 +148,9 @@ int EventBroadcaster::setListeningPort(int port, bool forceRestart)
     if ((listeningPort != port) || forceRestart)
     {
 #ifdef ZEROMQ
+        // the sender thread owns the socket while it runs
+        sender.stop();
+
         // unbind current socket (if any) to free up port
         unbindZMQSocket();
         ZMQSocketPtr newSocket;
@@ -159,6 +164,8 @@ int EventBroadcaster::setListeningPort(int port, bool forceRestart)
         }
         else
         {
+            zmq_setsockopt(newSocket.get(), ZMQ_SNDHWM, &sendHighWaterMark, sizeof(sendHighWaterMark));
+
             if (0 != zmq_bind(newSocket.get(), getEndpoint(port).toRawUTF8()))
             {
                 status = zmq_errno();
@@ -169,6 +176,7 @@ int EventBroadcaster::setListeningPort(int port, bool forceRestart)
                 // success
                 zmqSocket.swap(newSocket);
                 reportActualListeningPort(port);
+                sender.start(zmqSocket.get());
                 return status;
             }
         }
@@ -182,10 +190,13 @@ int EventBroadcaster::setListeningPort(int port, bool forceRestart)
         {
             reportActualListeningPort(0);
         }
+        sender.start(zmqSocket.get());
         return status;
 
 #else
+        sender.stop();
         reportActualListeningPort(port);
+        sender.start(nullptr);
         return 0;
 #endif
     }
@@ -193,26 +204,108 @@ int EventBroadcaster::setListeningPort(int port, bool forceRestart)
 }
 
 
+bool EventBroadcaster::enable()
+{
+    applyQueueSize();
+    sender.resetCounters();
+    return true;
+}
+
+
+bool EventBroadcaster::disable()
+{
+    sender.flush();
+    return true;
+}
+
+
 void EventBroadcaster::process(AudioSampleBuffer& continuousBuffer)
 {
     checkForEvents(true);
+
+    // publish everything from this block in as few messages as possible
+    sender.flush();
+}
+
+
+int EventBroadcaster::getSendHighWaterMark() const
+{
+    return sendHighWaterMark;
+}
+
+
+void EventBroadcaster::setSendHighWaterMark(int messages)
+{
+    if (messages != sendHighWaterMark)
+    {
+        sendHighWaterMark = messages;
+        // only applies to new sockets
+        setListeningPort(listeningPort, true);
+    }
+}
+
+
+int EventBroadcaster::getQueueSize() const
+{
+    return pendingQueueSize > 0 ? pendingQueueSize : sender.getQueueSize();
+}
+
+
+void EventBroadcaster::setQueueSize(int bytes)
+{
+    pendingQueueSize = jmax(1, bytes);
+
+    // the processing thread writes into the ring while acquiring, so it is only replaced when stopped
+    if (!CoreServices::getAcquisitionStatus())
+        applyQueueSize();
+}
+
+
+void EventBroadcaster::applyQueueSize()
+{
+    if (pendingQueueSize <= 0)
+        return;
+
+    const int bytes = pendingQueueSize;
+    pendingQueueSize = 0;
+
+    const bool wasRunning = sender.isThreadRunning();
+    void* socket = zmqSocket.get();
+
+    sender.stop();
+    sender.setQueueSize(bytes);
+
+    if (wasRunning)
+        sender.start(socket);
+}
+
+
+int EventBroadcaster::getMaxBatchSize() const
+{
+    return sender.getMaxBatchSize();
+}
+
+
+void EventBroadcaster::setMaxBatchSize(int events)
+{
+    sender.setMaxBatchSize(events);
+}
+
+
+const EventSender& EventBroadcaster::getSender() const
+{
+    return sender;
 }
 
 
 //IMPORTANT: The structure of the event buffers has changed drastically, so we need to find a better way of doing this
-void EventBroadcaster::sendEvent(const MidiMessage& event, float eventSampleRate) const
+void EventBroadcaster::sendEvent(const MidiMessage& event, float eventSampleRate)
 {
 	double timestampSeconds = double(Event::getTimestamp(event)) / eventSampleRate;
 	uint16 type = Event::getBaseType(event);
 
-#ifdef ZEROMQ
-	if (-1 == zmq_send(zmqSocket.get(), &type, sizeof(type), ZMQ_SNDMORE) ||
-		-1 == zmq_send(zmqSocket.get(), &timestampSeconds, sizeof(timestampSeconds), ZMQ_SNDMORE) ||
-		-1 == zmq_send(zmqSocket.get(), event.getRawData(), event.getRawDataSize(), 0))
-	{
-		std::cout << "Failed to send message: " << zmq_strerror(zmq_errno()) << std::endl;
-	}
-#endif
+	// the sender thread does the actual publishing
+	sender.queueEvent(type, timestampSeconds, event.getRawData(), event.getRawDataSize());
 }
 
 void EventBroadcaster::handleEvent(const EventChannel* channelInfo, const MidiMessage& event, int samplePosition)
@@ -229,6 +322,9 @@ void EventBroadcaster::saveCustomParametersToXml(XmlElement* parentElement)
 {
     XmlElement* mainNode = parentElement->createNewChildElement("EVENTBROADCASTER");
     mainNode->setAttribute("port", listeningPort);
+    mainNode->setAttribute("send_hwm", sendHighWaterMark);
+    mainNode->setAttribute("queue_size", getQueueSize());
+    mainNode->setAttribute("max_batch", getMaxBatchSize());
 }
 
 
@@ -240,7 +336,10 @@ void EventBroadcaster::loadCustomParametersFromXml()
         {
             if (mainNode->hasTagName("EVENTBROADCASTER"))
             {
-                setListeningPort(mainNode->getIntAttribute("port"));
+                setQueueSize(mainNode->getIntAttribute("queue_size", getQueueSize()));
+                setMaxBatchSize(mainNode->getIntAttribute("max_batch", getMaxBatchSize()));
+                sendHighWaterMark = mainNode->getIntAttribute("send_hwm", sendHighWaterMark);
+                setListeningPort(mainNode->getIntAttribute("port"), true);
             }
         }
     }
@@ -24,6 +24,8 @@
 
 #include <memory>
 
+#include "EventSender.h"
+
 class EventBroadcaster : public GenericProcessor
 {
 public:
@@ -39,9 +41,27 @@ public:
     void handleEvent (const EventChannel* channelInfo, const MidiMessage& event, int samplePosition = 0) override;
 	void handleSpike(const SpikeChannel* channelInfo, const MidiMessage& event, int samplePosition = 0) override;
 
+    bool enable() override;
+    bool disable() override;
+
     void saveCustomParametersToXml (XmlElement* parentElement) override;
     void loadCustomParametersFromXml() override;
 
+    /** Maximum number of messages ZMQ queues per subscriber before dropping. Restarts the socket */
+    int getSendHighWaterMark() const;
+    void setSendHighWaterMark (int messages);
+
+    /** Size of the ring between the processing and sender threads, in bytes.
+    Changes made while acquiring take effect at the next start */
+    int getQueueSize() const;
+    void setQueueSize (int bytes);
+
+    /** Maximum number of events published as a single multipart message */
+    int getMaxBatchSize() const;
+    void setMaxBatchSize (int events);
+
+    const EventSender& getSender() const;
+
 
 private:
     class ZMQContext : public ReferenceCountedObject
@@ -68,7 +88,8 @@ private:
     int unbindZMQSocket();
     int rebindZMQSocket();
 
-	void sendEvent(const MidiMessage& event, float eventSampleRate) const;
+	void sendEvent(const MidiMessage& event, float eventSampleRate);
+    void applyQueueSize();
     static String getEndpoint(int port);
     // called from getListeningPort() depending on success/failure of ZMQ operations
     void reportActualListeningPort(int port);
@@ -80,6 +101,12 @@ private:
     static CriticalSection sharedContextLock;
     ZMQSocketPtr zmqSocket;
     int listeningPort;
+    int sendHighWaterMark;
+    // queue size waiting for acquisition to stop, 0 if none
+    int pendingQueueSize;
+
+    // declared after the socket so it stops before the socket is closed
+    EventSender sender;
 };
 
 
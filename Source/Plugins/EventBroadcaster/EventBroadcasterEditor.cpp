@@ -14,6 +14,7 @@
 
 EventBroadcasterEditor::EventBroadcasterEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors)
     : GenericEditor(parentNode, useDefaultParameterEditors)
+    , statsMonitor(*this)
 
 {
     desiredWidth = 180;
@@ -37,10 +38,24 @@ EventBroadcasterEditor::EventBroadcasterEditor(GenericProcessor* parentNode, boo
     portLabel->addListener(this);
     addAndMakeVisible(portLabel);
 
+    statsLabel = new Label("Stats", String::empty);
+    statsLabel->setBounds(20,108,150,16);
+    statsLabel->setFont(Font("Default", 12, Font::plain));
+    statsLabel->setTooltip("Events published (multipart messages), and events dropped because the queue to the sender thread was full");
+    addAndMakeVisible(statsLabel);
+    updateStatsLabel();
+    statsMonitor.startTimer(500);
+
     setEnabledState(false);
 }
 
 
+EventBroadcasterEditor::~EventBroadcasterEditor()
+{
+    statsMonitor.stopTimer();
+}
+
+
 void EventBroadcasterEditor::buttonEvent(Button* button)
 {
     if (button == restartConnection)
@@ -80,3 +95,10 @@ void EventBroadcasterEditor::setDisplayedPort(int port)
 {
     portLabel->setText(String(port), dontSendNotification);
 }
+
+void EventBroadcasterEditor::updateStatsLabel()
+{
+    const EventSender& sender = static_cast<EventBroadcaster*>(getProcessor())->getSender();
+    statsLabel->setText("Sent: " + String(sender.getNumEventsSent()) + " (" + String(sender.getNumMessagesSent())
+        + ") Lost: " + String(sender.getNumEventsDropped()), dontSendNotification);
+}
@@ -26,16 +26,32 @@ class EventBroadcasterEditor : public GenericEditor, public Label::Listener
 {
 public:
     EventBroadcasterEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    ~EventBroadcasterEditor();
 
     void buttonEvent(Button* button) override;
     void labelTextChanged(juce::Label* label) override;
 
     void setDisplayedPort(int port);
 
+    /** Shows the sender statistics */
+    void updateStatsLabel();
+
 private:
+    /** GenericEditor's own timer drives the fade-in, so the statistics get a separate one */
+    class StatsMonitor : public Timer
+    {
+    public:
+        StatsMonitor(EventBroadcasterEditor& e) : editor(e) {}
+        void timerCallback() override { editor.updateStatsLabel(); }
+    private:
+        EventBroadcasterEditor& editor;
+    };
+
     ScopedPointer<UtilityButton> restartConnection;
     ScopedPointer<Label> urlLabel;
     ScopedPointer<Label> portLabel;
+    ScopedPointer<Label> statsLabel;
+    StatsMonitor statsMonitor;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventBroadcasterEditor);
 
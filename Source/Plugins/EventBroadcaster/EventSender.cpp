@@ -0,0 +1,248 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "EventSender.h"
+
+#ifdef ZEROMQ
+    #include <zmq.h>
+#endif
+
+EventSender::EventSender()
+    : Thread("EventSender")
+    , fifo(1)
+    , maxBatchSize(64)
+    , socket(nullptr)
+    , batchDataSize(0)
+{
+    setQueueSize(1 << 20);
+}
+
+EventSender::~EventSender()
+{
+    stop();
+}
+
+void EventSender::start(void* newSocket)
+{
+    jassert(!isThreadRunning());
+    socket = newSocket;
+    startThread();
+}
+
+void EventSender::stop()
+{
+    if (isThreadRunning())
+    {
+        signalThreadShouldExit();
+        notify();
+        if (!waitForThreadToExit(2000))
+        {
+            std::cout << "Event sender did not stop, forcing it" << std::endl;
+            stopThread(100);
+        }
+    }
+    socket = nullptr;
+}
+
+void EventSender::setQueueSize(int bytes)
+{
+    jassert(!isThreadRunning());
+    bytes = jmax(int(sizeof(RecordHeader)) * 16, bytes);
+
+    // AbstractFifo keeps one slot free
+    fifo.setTotalSize(bytes + 1);
+    ring.malloc(bytes + 1);
+    batchData.malloc(bytes);
+    resetCounters();
+}
+
+int EventSender::getQueueSize() const
+{
+    return fifo.getTotalSize() - 1;
+}
+
+void EventSender::setMaxBatchSize(int events)
+{
+    maxBatchSize = jmax(1, events);
+}
+
+int EventSender::getMaxBatchSize() const
+{
+    return maxBatchSize;
+}
+
+bool EventSender::queueEvent(uint16 type, double timestampSeconds, const void* data, int size)
+{
+    RecordHeader header;
+    header.size = uint32(size);
+    header.type = type;
+    header.timestamp = timestampSeconds;
+
+    const int recordSize = int(sizeof(header)) + size;
+    if (fifo.getFreeSpace() < recordSize)
+    {
+        ++numEventsDropped;
+        return false;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(recordSize, start1, size1, start2, size2);
+    writeToRing(0, &header, sizeof(header), start1, size1, start2);
+    writeToRing(sizeof(header), data, size, start1, size1, start2);
+    fifo.finishedWrite(recordSize);
+
+    const int used = fifo.getNumReady();
+    if (used > highWaterMark.get())
+        highWaterMark = used;
+
+    return true;
+}
+
+void EventSender::flush()
+{
+    notify();
+}
+
+void EventSender::writeToRing(int offset, const void* data, int size, int start1, int size1, int start2)
+{
+    // offset is relative to the region returned by prepareToWrite, which may wrap around
+    const int first = jlimit(0, size, size1 - offset);
+    memcpy(ring + start1 + offset, data, first);
+    if (size > first)
+        memcpy(ring + start2 + jmax(0, offset - size1), static_cast<const uint8*>(data) + first, size - first);
+}
+
+void EventSender::readFromRing(void* dest, int size, int start1, int size1, int start2)
+{
+    const int first = jmin(size, size1);
+    memcpy(dest, ring + start1, first);
+    if (size > first)
+        memcpy(static_cast<uint8*>(dest) + first, ring + start2, size - first);
+}
+
+void EventSender::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(100);
+        sendQueuedEvents();
+    }
+    sendQueuedEvents();
+}
+
+void EventSender::sendQueuedEvents()
+{
+    batchHeaders.clearQuick();
+    batchOffsets.clearQuick();
+    batchDataSize = 0;
+
+    int start1, size1, start2, size2;
+
+    while (fifo.getNumReady() >= int(sizeof(RecordHeader)))
+    {
+        // records are written whole, so once the header is readable the payload is too
+        RecordHeader header;
+        fifo.prepareToRead(sizeof(header), start1, size1, start2, size2);
+        readFromRing(&header, sizeof(header), start1, size1, start2);
+
+        const bool sameRun = batchHeaders.size() > 0 && batchHeaders.getLast().type == header.type;
+        if (batchHeaders.size() > 0 && (!sameRun || batchHeaders.size() >= maxBatchSize
+                                        || batchDataSize + int(header.size) > getQueueSize()))
+        {
+            sendBatch();
+            batchHeaders.clearQuick();
+            batchOffsets.clearQuick();
+            batchDataSize = 0;
+        }
+        fifo.finishedRead(sizeof(header));
+
+        fifo.prepareToRead(header.size, start1, size1, start2, size2);
+        readFromRing(batchData + batchDataSize, header.size, start1, size1, start2);
+        fifo.finishedRead(header.size);
+
+        batchHeaders.add(header);
+        batchOffsets.add(batchDataSize);
+        batchDataSize += header.size;
+    }
+
+    if (batchHeaders.size() > 0)
+        sendBatch();
+}
+
+void EventSender::sendBatch()
+{
+    const int numEvents = batchHeaders.size();
+
+#ifdef ZEROMQ
+    if (socket != nullptr)
+    {
+        const uint16 type = batchHeaders.getReference(0).type;
+        bool failed = (-1 == zmq_send(socket, &type, sizeof(type), ZMQ_SNDMORE));
+
+        for (int i = 0; i < numEvents && !failed; i++)
+        {
+            const RecordHeader& header = batchHeaders.getReference(i);
+            failed = (-1 == zmq_send(socket, &header.timestamp, sizeof(header.timestamp), ZMQ_SNDMORE))
+                || (-1 == zmq_send(socket, batchData + batchOffsets[i], header.size, i < numEvents - 1 ? ZMQ_SNDMORE : 0));
+        }
+
+        if (failed)
+        {
+            std::cout << "Failed to send message: " << zmq_strerror(zmq_errno()) << std::endl;
+            numEventsDropped += numEvents;
+            return;
+        }
+    }
+#endif
+
+    numEventsSent += numEvents;
+    ++numMessagesSent;
+}
+
+void EventSender::resetCounters()
+{
+    numEventsSent = 0;
+    numMessagesSent = 0;
+    numEventsDropped = 0;
+    highWaterMark = 0;
+}
+
+int64 EventSender::getNumEventsSent() const
+{
+    return numEventsSent.get();
+}
+
+int64 EventSender::getNumMessagesSent() const
+{
+    return numMessagesSent.get();
+}
+
+int64 EventSender::getNumEventsDropped() const
+{
+    return numEventsDropped.get();
+}
+
+int EventSender::getQueueHighWaterMark() const
+{
+    return highWaterMark.get();
+}
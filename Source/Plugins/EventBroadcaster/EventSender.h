@@ -0,0 +1,114 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef EVENTSENDER_H_INCLUDED
+#define EVENTSENDER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/**
+    Publishes events on a ZMQ socket from its own thread.
+
+    The processing thread serializes each event into a lock-free byte ring with
+    queueEvent() and calls flush() once per block; it never touches the socket.
+    The sender thread then drains the ring and publishes runs of consecutive
+    events of the same type as single multipart messages:
+
+        type, timestamp 1, payload 1, timestamp 2, payload 2, ...
+
+    so subscribers can still filter on the type frame. A batch of one event is
+    the original three-frame message. Events that do not fit in the ring are
+    dropped and counted.
+
+    @see EventBroadcaster
+*/
+class EventSender : public Thread
+{
+public:
+    EventSender();
+    ~EventSender();
+
+    /** Sets the socket to publish on and starts the thread. The socket must not be
+    used by anyone else until stop() is called */
+    void start(void* socket);
+
+    /** Sends what is left in the ring and stops the thread */
+    void stop();
+
+    /** Ring size, in bytes. Clears the ring, so only call while the thread is stopped */
+    void setQueueSize(int bytes);
+    int getQueueSize() const;
+
+    /** Maximum number of events per multipart message */
+    void setMaxBatchSize(int events);
+    int getMaxBatchSize() const;
+
+    /** Called from the processing thread. Returns false if the event was dropped */
+    bool queueEvent(uint16 type, double timestampSeconds, const void* data, int size);
+
+    /** Called from the processing thread at the end of each block to wake the sender */
+    void flush();
+
+    void resetCounters();
+    int64 getNumEventsSent() const;
+    int64 getNumMessagesSent() const;
+    int64 getNumEventsDropped() const;
+
+    /** Highest fill level of the ring since resetCounters(), in bytes */
+    int getQueueHighWaterMark() const;
+
+    void run() override;
+
+private:
+    struct RecordHeader
+    {
+        uint32 size;
+        uint16 type;
+        double timestamp;
+    };
+
+    void sendQueuedEvents();
+    void writeToRing(int offset, const void* data, int size, int start1, int size1, int start2);
+    void readFromRing(void* dest, int size, int start1, int size1, int start2);
+    void sendBatch();
+
+    AbstractFifo fifo;
+    HeapBlock<uint8> ring;
+    int maxBatchSize;
+    void* socket;
+
+    // Sender thread staging area for one batch
+    HeapBlock<uint8> batchData;
+    int batchDataSize;
+    Array<RecordHeader> batchHeaders;
+    Array<int> batchOffsets;
+
+    Atomic<int64> numEventsSent;
+    Atomic<int64> numMessagesSent;
+    Atomic<int64> numEventsDropped;
+    Atomic<int> highWaterMark;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventSender);
+};
+
+#endif  // EVENTSENDER_H_INCLUDED
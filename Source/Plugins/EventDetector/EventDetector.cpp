@@ -23,16 +23,38 @@
 
 #include <stdio.h>
 #include "EventDetector.h"
-//#include "Editors/EventDetectorEditor.h"
 
 
 EventDetector::EventDetector()
-    : GenericProcessor("Event Detector"), threshold(200.0), bufferZone(5.0f), state(false)
-
+    : GenericProcessor ("Event Detector")
+    , ttlChannel       (nullptr)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
-    parameters.add (Parameter ("thresh", 0.0, 500.0, 200.0, 0));
+    Parameter* detect = new Parameter ("Detect", false, DETECT, true);
+    detect->setDescription ("Send events for the selected channels");
+    detect->setEditorDesiredBounds (0, 5, 80, 14);
+    parameters.add (detect);
+
+    Parameter* threshold = new Parameter ("Threshold", "Threshold", -100000.0, 100000.0, 2.5, THRESHOLD);
+    threshold->setDescription ("Level the signal has to go past to start a pulse");
+    threshold->setEditorDesiredBounds (0, 28, 60, 40);
+    parameters.add (threshold);
+
+    Parameter* hysteresis = new Parameter ("Hysteresis", "Hysteresis", 0.0, 100000.0, 0.1, HYSTERESIS);
+    hysteresis->setDescription ("How far back past the threshold the signal has to come to end the pulse");
+    hysteresis->setEditorDesiredBounds (65, 28, 60, 40);
+    parameters.add (hysteresis);
+
+    Parameter* falling = new Parameter ("Falling", false, FALLING);
+    falling->setDescription ("Pulses start when the signal goes below the threshold");
+    falling->setEditorDesiredBounds (85, 5, 80, 14);
+    parameters.add (falling);
+
+    Parameter* deadTime = new Parameter ("Dead time (ms)", "Dead time (ms)", 0.0, 10000.0, 0.0, DEAD_TIME);
+    deadTime->setDescription ("Pulses starting this soon after the previous one are ignored");
+    deadTime->setEditorDesiredBounds (130, 28, 60, 40);
+    parameters.add (deadTime);
 }
 
 
@@ -41,36 +63,222 @@ EventDetector::~EventDetector()
 }
 
 
+AudioProcessorEditor* EventDetector::createEditor()
+{
+    editor = new GenericEditor (this, true);
+    editor->setDesiredWidth (220);
+
+    return editor;
+}
+
+
 void EventDetector::setParameter (int parameterIndex, float newValue)
 {
     editor->updateParameterButtons (parameterIndex);
 
-    Parameter& p =  parameters.getReference (parameterIndex);
-    p.setValue (newValue, 0);
+    if (currentChannel < 0 || currentChannel >= settings.size())
+        return;
+
+    parameters[parameterIndex]->setValue (newValue, currentChannel);
+
+    ChannelSettings& s = settings.getReference (currentChannel);
+
+    switch (parameterIndex)
+    {
+        case DETECT:
+            s.detect = newValue != 0;
+            activeChannelsChanged.set (1);
+            break;
+
+        case THRESHOLD:
+            s.threshold = newValue;
+            break;
+
+        case HYSTERESIS:
+            s.hysteresis = std::abs (newValue);
+            break;
+
+        case FALLING:
+            s.falling = newValue != 0;
+            break;
+
+        case DEAD_TIME:
+            s.deadTimeMs = jmax (0.0f, newValue);
+            break;
+
+        default:
+            return;
+    }
+
+    applySettings (currentChannel);
+}
+
+
+void EventDetector::applySettings (int channel)
+{
+    if (! isPositiveAndBelow (channel, detectors.size()))
+        return;
 
-    threshold = newValue;
+    const ChannelSettings& s = settings.getReference (channel);
+    const DataChannel* in = getDataChannel (channel);
+    const float sampleRate = in != nullptr ? in->getSampleRate() : CoreServices::getGlobalSampleRate();
 
-    //std::cout << float(p[0]) << std::endl;
+    detectors[channel]->setLevels (s.threshold, s.hysteresis, s.falling);
+    detectors[channel]->setDeadTime (roundToInt (s.deadTimeMs * sampleRate / 1000.0f));
 }
 
 
-void EventDetector::process (AudioSampleBuffer& buffer, MidiBuffer& events)
+void EventDetector::createEventChannels()
 {
-    //std::cout << *buffer.getReadPointer(0, 0) << std::endl;
+    ttlChannel = nullptr;
+
+    if (getNumInputs() == 0)
+        return;
+
+    EventChannel* ev = new EventChannel (EventChannel::TTL, getNumInputs(), 1, getDataChannel (0)->getSampleRate(), this);
+    ev->setName ("Event detector output");
+    ev->setDescription ("Pulses of the continuous inputs past their thresholds, one TTL line per input channel");
+    ev->setIdentifier ("dataderived.threshold");
+    ev->addEventMetaData (new MetaDataDescriptor (MetaDataDescriptor::FLOAT, 1, "Crossing offset",
+                                                  "Fraction of a sample by which the threshold crossing precedes the event timestamp",
+                                                  "timestamp.offset.subsample"));
+    eventChannelArray.add (ev);
+    ttlChannel = ev;
+}
+
+
+void EventDetector::updateSettings()
+{
+    const int numInputs = getNumInputs();
+
+    if (settings.size() > numInputs)
+        settings.removeRange (numInputs, settings.size() - numInputs);
 
-    for (int i = 0; i < getNumSamples(channels[0]->sourceNodeId); ++i)
+    while (settings.size() < numInputs)
     {
-        if ((*buffer.getReadPointer (0, i) < -threshold) && !state)
-        {
-            // generate midi event
-            //std::cout << "Value = " << *buffer.getSampleData(0, i) << std::endl;
-            addEvent (events, TTL, i);
+        ChannelSettings s = { false, 2.5f, 0.1f, false, 0.0f };
+        settings.add (s);
+    }
+
+    detectors.clear();
+
+    for (int i = 0; i < numInputs; ++i)
+    {
+        detectors.add (new ThresholdDetector());
+        applySettings (i);
+    }
+
+    ttlWord.calloc (jmax<size_t> (1, ttlChannel != nullptr ? ttlChannel->getDataSize() : 0));
+}
 
-            state = true;
+
+bool EventDetector::enable()
+{
+    activeChannels.clearQuick();
+    activeChannels.ensureStorageAllocated (detectors.size());
+
+    for (int i = 0; i < detectors.size(); ++i)
+    {
+        detectors[i]->reset();
+
+        if (ttlChannel != nullptr && getDataChannel (i)->getSampleRate() != ttlChannel->getSampleRate())
+            CoreServices::sendStatusMessage ("Event detector: channel " + String (i + 1)
+                                             + " has another sample rate than the first one, and is not scanned");
+    }
+
+    if (ttlChannel != nullptr)
+        zeromem (ttlWord, ttlChannel->getDataSize());
+
+    pendingEvents.ensureStorageAllocated (256);
+
+    activeChannelsChanged.set (0);
+    updateActiveChannels();
+
+    return true;
+}
+
+
+void EventDetector::updateActiveChannels()
+{
+    if (ttlChannel == nullptr)
+        return;
+
+    // a line left on by a channel no longer scanned is turned off at the start of the block
+    for (int i = 0; i < activeChannels.size(); ++i)
+    {
+        const int chan = activeChannels.getUnchecked (i);
+
+        if (! settings[chan].detect && (ttlWord[chan / 8] & (1 << (chan % 8))) != 0)
+        {
+            PendingEvent pending = { 0, chan, 0.0f, false };
+            pendingEvents.add (pending);
         }
-        else if ((*buffer.getReadPointer (0, i) > -threshold + bufferZone)  && state)
+    }
+
+    activeChannels.clearQuick();
+
+    for (int i = 0; i < detectors.size(); ++i)
+    {
+        if (settings[i].detect && getDataChannel (i)->getSampleRate() == ttlChannel->getSampleRate())
+            activeChannels.add (i);
+        else
+            detectors[i]->reset();
+    }
+}
+
+
+void EventDetector::process (AudioSampleBuffer& buffer)
+{
+    if (ttlChannel == nullptr)
+        return;
+
+    pendingEvents.clearQuick();
+
+    // detection was turned on or off for a channel since the last block
+    if (activeChannelsChanged.compareAndSetBool (0, 1))
+        updateActiveChannels();
+
+    for (int i = 0; i < activeChannels.size(); ++i)
+    {
+        const int chan = activeChannels.getUnchecked (i);
+        ThresholdDetector* detector = detectors.getUnchecked (chan);
+
+        detector->process (buffer.getReadPointer (chan), getNumSamples (chan));
+
+        const Array<ThresholdDetector::Crossing>& crossings = detector->getCrossings();
+
+        for (int c = 0; c < crossings.size(); ++c)
         {
-            state = false;
+            const ThresholdDetector::Crossing& crossing = crossings.getReference (c);
+            PendingEvent pending = { crossing.sample, chan, crossing.offset, crossing.isOnset };
+            pendingEvents.add (pending);
         }
     }
+
+    // every event carries the state of all the lines, so they go out in time order
+    if (pendingEvents.size() > 1)
+    {
+        PendingEventComparator comparator;
+        pendingEvents.sort (comparator, true);
+    }
+
+    for (int i = 0; i < pendingEvents.size(); ++i)
+    {
+        const PendingEvent& pending = pendingEvents.getReference (i);
+        const uint8 bit = uint8 (1 << (pending.channel % 8));
+
+        if (pending.isOnset)
+            ttlWord[pending.channel / 8] |= bit;
+        else
+            ttlWord[pending.channel / 8] &= ~bit;
+
+        MetaDataValueArray metaData;
+        MetaDataValuePtr offset = new MetaDataValue (*ttlChannel->getEventMetaDataDescriptor (0));
+        offset->setValue (pending.offset);
+        metaData.add (offset);
+
+        TTLEventPtr event = TTLEvent::createTTLEvent (ttlChannel, getTimestamp (pending.channel) + pending.sample,
+                                                      ttlWord, ttlChannel->getDataSize(), metaData, pending.channel);
+        addEvent (ttlChannel, event, pending.sample);
+    }
 }
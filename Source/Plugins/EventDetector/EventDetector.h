@@ -24,14 +24,23 @@
 #ifndef __EVENTDETECTOR_H_91811542__
 #define __EVENTDETECTOR_H_91811542__
 
-#include "../../../JuceLibraryCode/JuceHeader.h"
-#include "../GenericProcessor/GenericProcessor.h"
+#include <ProcessorHeaders.h>
+#include "ThresholdDetector.h"
 
 
 /**
     Searches for threshold crossings and sends out TTL events.
 
-    @see GenericProcessor
+    Every input channel has its own threshold, hysteresis, direction and dead time,
+    set for the channels selected in the editor. Each channel with detection turned
+    on is scanned by a ThresholdDetector, and its pulses turn the TTL line with the
+    same index as the channel on and off. As TTL timestamps are whole samples, each
+    event also carries how far before it the signal crossed the threshold.
+
+    All lines share one event channel at the sample rate of the first input;
+    channels at another sample rate are not scanned.
+
+    @see GenericProcessor, ThresholdDetector
 */
 class EventDetector : public GenericProcessor
 {
@@ -39,15 +48,70 @@ public:
     EventDetector();
     ~EventDetector();
 
-    void process (AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
+    AudioProcessorEditor* createEditor() override;
+
+    void process (AudioSampleBuffer& buffer) override;
 
     void setParameter (int parameterIndex, float newValue) override;
 
+    bool enable() override;
+
+    void createEventChannels() override;
+
+    void updateSettings() override;
+
 
 private:
-    float threshold;
-    float bufferZone;
-    bool state;
+    enum ParameterIndex
+    {
+        DETECT = 0, THRESHOLD, HYSTERESIS, FALLING, DEAD_TIME
+    };
+
+    struct ChannelSettings
+    {
+        bool detect;
+        float threshold;
+        float hysteresis;
+        bool falling;
+        float deadTimeMs;
+    };
+
+    struct PendingEvent
+    {
+        int sample;
+        int channel;
+        float offset;
+        bool isOnset;
+    };
+
+    // orders the events of all channels by sample, keeping the order within a channel
+    struct PendingEventComparator
+    {
+        static int compareElements (const PendingEvent& first, const PendingEvent& second)
+        {
+            return first.sample - second.sample;
+        }
+    };
+
+    void applySettings (int channel);
+
+    /** Rebuilds the list of scanned channels from the detect settings, turning off the
+        lines of the channels dropped from it. */
+    void updateActiveChannels();
+
+    Array<ChannelSettings> settings;
+    OwnedArray<ThresholdDetector> detectors;
+
+    // channels scanned while acquiring
+    Array<int> activeChannels;
+    // set when detection is turned on or off, the list is rebuilt at the start of the next block
+    Atomic<int> activeChannelsChanged;
+    Array<PendingEvent> pendingEvents;
+
+    // state of all the lines, sent with every event
+    HeapBlock<uint8> ttlWord;
+
+    const EventChannel* ttlChannel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EventDetector);
 };
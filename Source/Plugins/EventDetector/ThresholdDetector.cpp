@@ -0,0 +1,168 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ThresholdDetector.h"
+
+
+// the level lies between the two samples, at distance / step of a sample before the second one
+static inline float getOffset (float distance, float step, bool hasPrevious)
+{
+    return hasPrevious && step > 0 ? jlimit (0.0f, 1.0f, distance / step) : 0.0f;
+}
+
+
+ThresholdDetector::ThresholdDetector()
+    : sign      (1.0f)
+    , onLevel   (0.0f)
+    , offLevel  (0.0f)
+    , deadTime  (0)
+{
+    crossings.ensureStorageAllocated (chunkSize);
+    reset();
+}
+
+
+void ThresholdDetector::setLevels (float threshold, float hysteresis, bool falling)
+{
+    const float newSign = falling ? -1.0f : 1.0f;
+
+    // the last sample is kept multiplied by the sign
+    if (newSign != sign)
+        lastSample = -lastSample;
+
+    sign     = newSign;
+    onLevel  = sign * threshold;
+    offLevel = onLevel - std::abs (hysteresis);
+}
+
+
+void ThresholdDetector::setDeadTime (int samples)
+{
+    deadTime = jmax (0, samples);
+}
+
+
+void ThresholdDetector::reset()
+{
+    state = false;
+    suppressed = false;
+    hasLastSample = false;
+    lastSample = 0.0f;
+    position = 0;
+    lastOnset = std::numeric_limits<int64>::min() / 2;
+    crossings.clearQuick();
+}
+
+
+void ThresholdDetector::process (const float* data, int nSamples)
+{
+    crossings.clearQuick();
+
+    for (int start = 0; start < nSamples; start += chunkSize)
+    {
+        const int n = jmin (chunkSize, nSamples - start);
+        const float* x = data + start;
+
+        // four independent accumulators so the compiler can keep them in one vector register
+        float low[4]  = { sign * x[0], sign * x[0], sign * x[0], sign * x[0] };
+        float high[4] = { low[0], low[0], low[0], low[0] };
+
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                const float v = sign * x[i + k];
+                low[k]  = v < low[k]  ? v : low[k];
+                high[k] = v > high[k] ? v : high[k];
+            }
+        }
+        for (; i < n; ++i)
+        {
+            const float v = sign * x[i];
+            low[0]  = v < low[0]  ? v : low[0];
+            high[0] = v > high[0] ? v : high[0];
+        }
+
+        const float chunkLow  = jmin (jmin (low[0], low[1]), jmin (low[2], low[3]));
+        const float chunkHigh = jmax (jmax (high[0], high[1]), jmax (high[2], high[3]));
+
+        if (state ? chunkLow < offLevel : chunkHigh > onLevel)
+        {
+            runStateMachine (x, start, n);
+        }
+        else
+        {
+            lastSample = sign * x[n - 1];
+            hasLastSample = true;
+        }
+    }
+
+    position += nSamples;
+}
+
+
+void ThresholdDetector::runStateMachine (const float* x, int start, int n)
+{
+    float previous = lastSample;
+    bool hasPrevious = hasLastSample;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const float v = sign * x[i];
+
+        if (! state && v > onLevel)
+        {
+            state = true;
+
+            // a pulse starting within the dead time is dropped, end included
+            suppressed = position + start + i - lastOnset < deadTime;
+
+            if (! suppressed)
+            {
+                lastOnset = position + start + i;
+
+                Crossing crossing = { start + i, getOffset (v - onLevel, v - previous, hasPrevious), true };
+                crossings.add (crossing);
+            }
+        }
+        else if (state && v < offLevel)
+        {
+            state = false;
+
+            if (! suppressed)
+            {
+                Crossing crossing = { start + i, getOffset (offLevel - v, previous - v, hasPrevious), false };
+                crossings.add (crossing);
+            }
+
+            suppressed = false;
+        }
+
+        previous = v;
+        hasPrevious = true;
+    }
+
+    lastSample = previous;
+    hasLastSample = true;
+}
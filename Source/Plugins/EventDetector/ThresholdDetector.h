@@ -0,0 +1,102 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __THRESHOLDDETECTOR_H__
+#define __THRESHOLDDETECTOR_H__
+
+#include <ProcessorHeaders.h>
+
+/**
+
+    Turns a continuous signal into pulses with a threshold and some hysteresis.
+
+    A pulse starts when the signal goes above the threshold, or below it when
+    detecting falling signals, and ends when it comes back past the threshold by
+    more than the hysteresis. Pulses starting within the dead time of the previous
+    one are ignored, end included.
+
+    Each block is scanned in chunks. A branch-free pass, which the compiler turns into
+    SIMD code, finds the extremes of the chunk; the state machine only runs on chunks
+    whose extremes reach the level the current state is waiting for, so a quiet
+    channel costs one pass over its samples. Crossing times are interpolated
+    linearly between the two samples around them.
+
+    @see EventDetector
+
+*/
+class ThresholdDetector
+{
+public:
+    struct Crossing
+    {
+        // first sample past the level
+        int sample;
+        // how long before that sample the signal crossed the level, from 0 to 1 samples
+        float offset;
+        // start or end of a pulse
+        bool isOnset;
+    };
+
+    ThresholdDetector();
+
+    void setLevels (float threshold, float hysteresis, bool falling);
+
+    /** In samples, counted from the start of the previous pulse */
+    void setDeadTime (int samples);
+
+    /** Forgets the previous samples and pulses */
+    void reset();
+
+    /** Replaces the crossings with those of a new block */
+    void process (const float* data, int nSamples);
+
+    const Array<Crossing>& getCrossings() const { return crossings; }
+
+    /** True while inside a pulse that was reported */
+    bool isHigh() const { return state && ! suppressed; }
+
+private:
+    static const int chunkSize = 64;
+
+    void runStateMachine (const float* data, int start, int nSamples);
+
+    Array<Crossing> crossings;
+
+    // the signal is multiplied by sign, so pulses always start above onLevel
+    float sign;
+    float onLevel;
+    float offLevel;
+    int deadTime;
+
+    bool state;
+    bool suppressed;
+    bool hasLastSample;
+    float lastSample;
+
+    int64 position;
+    int64 lastOnset;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThresholdDetector);
+};
+
+#endif  // __THRESHOLDDETECTOR_H__
@@ -26,6 +26,7 @@
 
 #include <ProcessorHeaders.h>
 #include "EvntTrigAvgEditor.h"
+#include "PsthEngine.h"
 #include <vector>
 #include <map>
 
@@ -33,8 +34,11 @@ class EvntTrigAvgEditor;
 
 /**
 Aligns spike times with TTL input.
+
+Spikes are binned as they come by a PsthEngine, which the canvas reads through
+snapshots.
  
-@see EvntTrigAvgCanvas, EvntTrigAvgEditor
+@see EvntTrigAvgCanvas, EvntTrigAvgEditor, PsthEngine
 
 */
 
@@ -76,20 +80,9 @@ public:
     uint64 getWindowSize();
     uint64 getBinSize();
     std::vector<String> getElectrodeLabels();
-    CriticalSection* getMutex() { return &mut; }
-    //get pointers to shared data
-    Array<uint64 *> getHistoData();
-    Array<float *> getMinMaxMean();
-
-    //create histogram data
-    uint64* createHistogramData(std::vector<uint64> spikeData, std::vector<uint64> ttlData); // shared data
-    uint64 binDataPoint(uint64 startBin, uint64 endBin, uint64 binSize, uint64 dataPoint); // shared data
-    void processSpikeData(std::vector<std::vector<std::vector<uint64>>> spikeData,std::vector<uint64> ttlData);
-    uint64* binCount(std::vector<uint64> binData, uint64 numberOfBins); // shared data
-    bool shouldReadHistoData();
-    float findMin(uint64* data_);
-    float findMax(uint64* data_);
-    float findMean(uint64* data_); // TODO make running
+
+    /** Copies the histograms last published by the processing thread */
+    void getHistograms(PsthEngine::Snapshot& snapshot);
     
     //TODO electrodeMap is not being used right now, fix it to actually work with SourceInfo instead of just indexes
     //std::map<SourceChannelInfo,int> createElectrodeMap();
@@ -98,33 +91,20 @@ public:
     void saveCustomParametersToXml (XmlElement* parentElement) override;
     void loadCustomParametersFromXml() override;
 private:
-    CriticalSection mut;
-    void initializeHistogramArray();
-    void initializeMinMaxMean();
-    void clearHistogramArray();
-    void clearMinMaxMean();
-    void addNewSortedIdHistoData(int electrode, int sortedId);
-    void addNewSortedIdMinMaxMean(int electrode,int sortedID);
     std::atomic<int> triggerEvent;
     std::atomic<int> triggerChannel;
 
-    uint64 bins[1000]; // workspace for bin counting
-
     int numChannels = 0;
-    bool recalc = false;
-    int lastTTLCalculated = 0;
     uint64 windowSize;
     uint64 binSize;
-    
-    std::vector<uint64> ttlTimestampBuffer;
-    std::vector<std::vector<std::vector<uint64>>> spikeData;// channel.sortedID.spikeInstance.timestamp
-    void clearHistogramData(uint64 * const);
-    Array<uint64*> histogramData; // shared data
-    Array<float*> minMaxMean; // shared data
+
+    PsthEngine psth;
+    // set when the histograms have to start over, applied by the processing thread
+    std::atomic<bool> clearRequested;
+    int64 lastPublished = 0;
+
     //std::map<SourceChannelInfo,int> electrodeMap; // Used to identify what electrode a spike came from
     std::vector<String> electrodeLabels;
-    std::vector<int> idIndex; //sorted ID, electrode. used to match a sortedID with its electrode
-    std::vector<std::vector<int>> electrodeSortedId; 
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EvntTrigAvg);
 
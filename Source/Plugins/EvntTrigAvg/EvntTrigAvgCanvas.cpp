@@ -87,6 +87,7 @@ void EvntTrigAvgCanvas::update()
 
 void EvntTrigAvgCanvas::refreshState()
 {
+    refresh();
     resized();
 }
 
@@ -118,17 +119,15 @@ void EvntTrigAvgCanvas::paint(Graphics& g)
     g.setColour(Colours::snow);
     
     g.drawText("Electrode",5, 5, width/8, 20, juce::Justification::left);
-    g.drawText("Trials: " + String(processor->getLastTTLCalculated()),(xOffset+drawWidth)/2-50,5,100,20,Justification::centred);
+    g.drawText("Trials: " + String(snapshot.numTrials),(xOffset+drawWidth)/2-50,5,100,20,Justification::centred);
     g.drawText("Min.", width-180-scrollBarThickness, 5, 60, 20, Justification::right);
     g.drawText("Max", width-120-scrollBarThickness, 5, 60, 20, Justification::right);
     g.drawText("Mean", width-60-scrollBarThickness, 5, 60, 20, Justification::right);
-    //delete scale;
-    //scale = new Timescale(processor->getWindowSize(),processor->getSampleRate(),data,bin,processor->getBinSize());
-    //removeChildComponent(scale);
-    scale = new Timescale(processor->getWindowSize(),processor->getSampleRate(),data,bin,processor->getBinSize());
-    scale->setBounds(0, getHeight()-40, width-scrollBarThickness, 40);
-    addAndMakeVisible(scale,true);
-    repaint();
+    scale->update(processor->getWindowSize(),processor->getSampleRate());
+    scale->setBin(bin);
+    scale->setData(data);
+    scale->setBinSize(processor->getBinSize());
+    scale->repaint();
 }
 
 void EvntTrigAvgCanvas::repaintDisplay(){
@@ -138,7 +137,13 @@ void EvntTrigAvgCanvas::repaintDisplay(){
 void EvntTrigAvgCanvas::refresh()
 {
     // called every 10 Hz
-    display->refresh(); // dont know if this ever gets called
+    processor->getHistograms(snapshot);
+    if (snapshot.layout != shownLayout){
+        shownLayout = snapshot.layout;
+        display->rebuild(&snapshot);
+        resized();
+    }
+    display->refresh();
     repaint();
 }
 
@@ -150,9 +155,8 @@ bool EvntTrigAvgCanvas::keyPressed(const KeyPress& key)
 void EvntTrigAvgCanvas::buttonClicked(Button* button)
 {
     if (button == clearHisto){
-        histoData.clear();
-        minMaxMean.clear();
         processor->setParameter(4,0);
+        refresh();
     }
      repaint();
 }
@@ -211,40 +215,43 @@ void EvntTrigAvgDisplay::resized()
 {
     int width = getWidth();
     for(int i = 0 ; i < graphs.size() ; i++){
-        graphs[i]->setBounds(20, 40*(i+1), width-20-width/4, 40);
-        graphs[i]->resized();
+        graphs[i]->setBounds(0, 40*i, width-20, 40);
     }
 }
 
 void EvntTrigAvgDisplay::paint(Graphics &g)
 {
+}
 
-    histoData.clear();
-    histoData = processor->getHistoData();
-    minMaxMean.clear();
-    minMaxMean = processor->getMinMaxMean();
-    int width=getWidth();
-    g.setColour(Colours::snow);
-    std::vector<String> labels = processor->getElectrodeLabels();
+void EvntTrigAvgDisplay::rebuild(const PsthEngine::Snapshot* snapshot)
+{
     deleteAllChildren();
     graphs.clear();
-    int graphCount = 0;
-    
-    for (int i = 0 ; i < histoData.size() ; i++){
-        GraphUnit* graph;
-        ScopedLock myScopedLock(*processor->getMutex());
-        if(histoData[i][1]==0){ // if sortedId == 0
-                graph = new GraphUnit(processor,canvas,channelColours[(histoData[i][0])%16],labels[histoData[i][0]],&minMaxMean[i][2],&histoData[i][2]); // pass &histoData[i][2] instead of 3 to pass on how many bins are used
-        }
-            else{
-                graph = new GraphUnit(processor,canvas,channelColours[(histoData[i][0])%16],"ID "+String(histoData[i][1]),&minMaxMean[i][2],&histoData[i][2]);
-            }
-            graphs.push_back(graph);
-            graph->setBounds(0, 40*(graphCount), width-20, 40);
-            addAndMakeVisible(graph,true);
-            graphCount += 1;
+
+    std::vector<String> labels = processor->getElectrodeLabels();
+    std::vector<int> order(snapshot->units.size());
+    for (int i = 0 ; i < int(order.size()) ; i++)
+        order[i] = i;
+    // all spikes of an electrode first, then its sorted units
+    std::sort(order.begin(), order.end(), [snapshot](int a, int b){
+        const PsthEngine::Unit& ua = snapshot->units[a];
+        const PsthEngine::Unit& ub = snapshot->units[b];
+        return ua.electrode != ub.electrode ? ua.electrode < ub.electrode : ua.sortedId < ub.sortedId;
+    });
+
+    int width=getWidth();
+    for (int i = 0 ; i < int(order.size()) ; i++){
+        const PsthEngine::Unit& unit = snapshot->units[order[i]];
+        String name;
+        if (unit.sortedId == 0)
+            name = unit.electrode < int(labels.size()) ? labels[unit.electrode] : String(unit.electrode+1);
+        else
+            name = "ID " + String(unit.sortedId);
+        GraphUnit* graph = new GraphUnit(processor,canvas,channelColours[unit.electrode%16],name,snapshot,order[i]);
+        graphs.push_back(graph);
+        graph->setBounds(0, 40*i, width-20, 40);
+        addAndMakeVisible(graph,true);
     }
-    repaint(); // ideally find better method than this
 }
 
 void EvntTrigAvgDisplay::refresh()
@@ -327,17 +334,16 @@ void inline Timescale::setBinSize(int binSize_)
 //--------------------------------------------------------------------
 
 
-GraphUnit::GraphUnit(EvntTrigAvg* processor_, EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, float  * stats_,uint64 * data_){
-    ScopedLock myScopedLock(*processor_->getMutex());
+GraphUnit::GraphUnit(EvntTrigAvg* processor_, EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, const PsthEngine::Snapshot* snapshot_, int unit_){
     color = color_;
     LD = new LabelDisplay(color_,name_);
     LD->setBounds(0,0,30,40);
     addAndMakeVisible(LD,false);
     
-    HG = new HistoGraph(processor_,canvas_,color_,data_[0], stats_[1], &data_[1]);
+    HG = new HistoGraph(processor_,canvas_,color_,snapshot_,unit_);
     HG->setBounds(30,0,getWidth()-210,40);
     addAndMakeVisible(HG,false);
-    SD = new StatDisplay(processor_,color_,stats_);
+    SD = new StatDisplay(processor_,color_,snapshot_,unit_);
     SD->setBounds(getWidth()-180,0,180,40);
     addAndMakeVisible(SD,false);
 }
@@ -379,12 +385,11 @@ void LabelDisplay::resized()
 
 //----------------
 
-HistoGraph::HistoGraph(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_, juce::Colour color_, uint64 bins_, float max_, uint64 * histoData_)
+HistoGraph::HistoGraph(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_, juce::Colour color_, const PsthEngine::Snapshot* snapshot_, int unit_)
 {
     color = color_;
-    histoData = histoData_;
-    bins = bins_;
-    max = uint64(max_);
+    snapshot = snapshot_;
+    unit = unit_;
     processor=processor_;
     canvas = canvas_;
 }
@@ -401,8 +406,10 @@ void HistoGraph::paint(Graphics& g)
     g.setOpacity(0.5);
     g.drawVerticalLine(getWidth()/2,5, getHeight());
     g.setColour(color);
+    const int bins = snapshot->numBins;
+    const uint64* histoData = snapshot->getCounts(unit);
+    const float max = snapshot->summaries[unit].max;
     for (int i = 1 ; i < bins ; i++){
-        ScopedLock myScopedLock(*processor->getMutex());
         if(max!=0){
             g.drawLine(float(i-1)*float(getWidth())/float(bins),getHeight()-(histoData[i-1]*getHeight()/max),float(i)*float(getWidth())/float(bins),getHeight()-(histoData[i]*getHeight()/max));
         }
@@ -433,10 +440,10 @@ void HistoGraph::clear()
 
 void HistoGraph::mouseMove(const MouseEvent &event)
 {
+    const int bins = snapshot->numBins;
     if(bins>0){
         int posX = event.x;
-        ScopedLock myScopedLock(*processor->getMutex());
-        int valueY = histoData[int(float(posX)/float(getWidth())*float(bins))];
+        int valueY = snapshot->getCounts(unit)[jlimit(0, bins-1, int(float(posX)/float(getWidth())*float(bins)))];
         canvas->setData(valueY);
         canvas->setBin(int(float(posX)/float(getWidth())*float(bins))-(bins/2));
         canvas->repaint();
@@ -445,11 +452,12 @@ void HistoGraph::mouseMove(const MouseEvent &event)
 
 //----------------
 
-StatDisplay::StatDisplay(EvntTrigAvg* processor_, juce::Colour c, float * s)
+StatDisplay::StatDisplay(EvntTrigAvg* processor_, juce::Colour c, const PsthEngine::Snapshot* snapshot_, int unit_)
 {
     processor=processor_;
     color = c;
-    stats = s;
+    snapshot = snapshot_;
+    unit = unit_;
 }
 
 StatDisplay::~StatDisplay()
@@ -459,11 +467,11 @@ StatDisplay::~StatDisplay()
 
 void StatDisplay::paint(Graphics& g)
 {
-    ScopedLock myScopedLock(*processor->getMutex());
+    const PsthEngine::Summary& stats = snapshot->summaries[unit];
     g.setColour(color);
-    g.drawText(String(stats[0]),0, 0, 60, 40, juce::Justification::right);
-    g.drawText(String(stats[1]),60, 0, 60, 40, juce::Justification::right);
-    g.drawText(String(stats[2]),120, 0, 60, 40, juce::Justification::right);
+    g.drawText(String(stats.min),0, 0, 60, 40, juce::Justification::right);
+    g.drawText(String(stats.max),60, 0, 60, 40, juce::Justification::right);
+    g.drawText(String(stats.mean),120, 0, 60, 40, juce::Justification::right);
     }
 
 void StatDisplay::resized()
@@ -74,8 +74,9 @@ public:
 
 private:
 
-    Array<uint64*> histoData;
-    std::vector<std::vector<float>> minMaxMean;
+    // copy of the processor's histograms, refreshed by the visualizer callbacks
+    PsthEngine::Snapshot snapshot;
+    int shownLayout = -1;
     void removeUnitOrBox();
     ScopedPointer<Viewport> viewport;
     ScopedPointer<EvntTrigAvgDisplay> display;
@@ -109,6 +110,8 @@ public:
     void resized();
     void paint(Graphics &g);
     void refresh();
+    /** Creates a graph per unit of the snapshot, electrode by electrode */
+    void rebuild(const PsthEngine::Snapshot* snapshot);
     int getNumGraphs();
 private:
 
@@ -117,8 +120,6 @@ private:
     Viewport* viewport;
     std::vector<GraphUnit*> graphs;
     juce::Colour channelColours[16];
-    Array<uint64 *> histoData;
-    Array<float *> minMaxMean;
     int border = 20;
 };
 
@@ -153,7 +154,7 @@ private:
 class GraphUnit : public Component
 {
 public:
-    GraphUnit(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, float * stats_, uint64 * data_);
+    GraphUnit(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, const PsthEngine::Snapshot* snapshot_, int unit_);
     ~GraphUnit();
     void paint(Graphics& g);
     void resized();
@@ -184,7 +185,7 @@ class HistoGraph : public Component
 {
     
 public:
-    HistoGraph(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_,juce::Colour color_, uint64 bins_, float max_, uint64 * histoData_);
+    HistoGraph(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_,juce::Colour color_, const PsthEngine::Snapshot* snapshot_, int unit_);
     ~HistoGraph();
     
     void paint(Graphics& g);
@@ -197,10 +198,9 @@ public:
     
     
 private:
-    uint64 bins = 0;
     Colour color;
-    float max;
-    uint64 const * histoData;
+    const PsthEngine::Snapshot* snapshot;
+    int unit;
     int valueY=0;
     EvntTrigAvg* processor;
     EvntTrigAvgCanvas* canvas;
@@ -212,14 +212,15 @@ private:
 class StatDisplay : public Component
 {
 public:
-    StatDisplay(EvntTrigAvg* display_, juce::Colour c, float * s);
+    StatDisplay(EvntTrigAvg* display_, juce::Colour c, const PsthEngine::Snapshot* snapshot_, int unit_);
     ~StatDisplay();
     void paint(Graphics& g);
     void resized();
 private:
     EvntTrigAvg* processor;
     Colour color;
-    float const * stats;
+    const PsthEngine::Snapshot* snapshot;
+    int unit;
     
 };
 
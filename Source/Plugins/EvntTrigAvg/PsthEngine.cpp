@@ -0,0 +1,279 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PsthEngine.h"
+
+PsthEngine::Snapshot::Snapshot()
+    : numBins    (0)
+    , numTrials  (0)
+    , layout     (0)
+{
+}
+
+
+PsthEngine::PsthEngine()
+    : windowSize    (0)
+    , halfWindow    (0)
+    , binSize       (1)
+    , numBins       (0)
+    , numTrials     (0)
+    , layout        (0)
+{
+}
+
+
+void PsthEngine::configure (int numElectrodes, int64 windowSize_, int64 binSize_)
+{
+    windowSize = jmax<int64> (1, windowSize_);
+    halfWindow = windowSize / 2;
+    binSize = jmax<int64> (1, binSize_);
+    numBins = int (jmax<int64> (1, windowSize / binSize));
+
+    units.clear();
+    electrodeUnits.clear();
+    electrodeUnits.resize (numElectrodes);
+    counts.clear();
+    summaries.clear();
+    totals.clear();
+    binsAtMin.clear();
+
+    for (int i = 0; i < numElectrodes; ++i)
+        addUnit (i, 0);
+
+    triggers.reserve (1024);
+    spikes.reserve (4096);
+    reset();
+}
+
+
+void PsthEngine::reset()
+{
+    std::fill (counts.begin(), counts.end(), 0);
+    std::fill (totals.begin(), totals.end(), 0);
+    std::fill (binsAtMin.begin(), binsAtMin.end(), numBins);
+
+    for (size_t i = 0; i < summaries.size(); ++i)
+    {
+        summaries[i].min = 0;
+        summaries[i].max = 0;
+        summaries[i].mean = 0;
+    }
+
+    triggers.clear();
+    spikes.clear();
+    numTrials = 0;
+    ++layout;
+}
+
+
+int PsthEngine::findUnit (int electrode, int sortedId)
+{
+    const std::vector<SortedUnit>& list = electrodeUnits[electrode];
+
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        if (list[i].sortedId == sortedId)
+            return list[i].unit;
+    }
+
+    return -1;
+}
+
+
+int PsthEngine::addUnit (int electrode, int sortedId)
+{
+    Unit unit;
+    unit.electrode = electrode;
+    unit.sortedId = sortedId;
+
+    SortedUnit entry;
+    entry.sortedId = sortedId;
+    entry.unit = int (units.size());
+
+    Summary summary;
+    summary.min = 0;
+    summary.max = 0;
+    summary.mean = 0;
+
+    units.push_back (unit);
+    electrodeUnits[electrode].push_back (entry);
+    counts.resize (counts.size() + numBins, 0);
+    summaries.push_back (summary);
+    totals.push_back (0);
+    binsAtMin.push_back (numBins);
+    ++layout;
+
+    return entry.unit;
+}
+
+
+void PsthEngine::addTrigger (int64 timestamp)
+{
+    triggers.push (timestamp);
+
+    // triggers from one channel come in order, this only runs if they do not
+    for (int i = triggers.size() - 1; i > 0 && triggers[i - 1] > triggers[i]; --i)
+        std::swap (triggers[i - 1], triggers[i]);
+}
+
+
+void PsthEngine::addSpike (int electrode, int sortedId, int64 timestamp)
+{
+    if (electrode < 0 || electrode >= int (electrodeUnits.size()))
+        return;
+
+    PendingSpike spike;
+    spike.timestamp = timestamp;
+    spike.allUnit = findUnit (electrode, 0);
+    spike.sortedUnit = -1;
+
+    if (sortedId != 0)
+    {
+        spike.sortedUnit = findUnit (electrode, sortedId);
+
+        if (spike.sortedUnit < 0)
+            spike.sortedUnit = addUnit (electrode, sortedId);
+    }
+
+    spikes.push (spike);
+}
+
+
+void PsthEngine::advance (int64 now)
+{
+    // every trigger whose window holds the spike has arrived once the stream is half a window past it
+    while (spikes.size() > 0 && spikes[0].timestamp + halfWindow < now)
+    {
+        binSpike (spikes[0]);
+        spikes.pop();
+    }
+
+    int64 binnedUpTo = now - halfWindow;
+
+    if (spikes.size() > 0)
+        binnedUpTo = jmin (binnedUpTo, spikes[0].timestamp);
+
+    while (triggers.size() > 0 && triggers[0] + halfWindow <= binnedUpTo)
+    {
+        triggers.pop();
+        ++numTrials;
+    }
+}
+
+
+void PsthEngine::binSpike (const PendingSpike& spike)
+{
+    // first trigger with the spike less than half a window after it
+    const int64 earliest = spike.timestamp - halfWindow;
+    int low = 0;
+    int high = triggers.size();
+
+    while (low < high)
+    {
+        const int middle = (low + high) / 2;
+
+        if (triggers[middle] <= earliest)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    for (int i = low; i < triggers.size(); ++i)
+    {
+        const int64 offset = spike.timestamp - triggers[i] + halfWindow;
+
+        if (offset < 0)
+            break;
+
+        const int64 bin = offset / binSize;
+
+        if (bin >= numBins)
+            continue;
+
+        if (spike.allUnit >= 0)
+            count (spike.allUnit, int (bin));
+
+        if (spike.sortedUnit >= 0)
+            count (spike.sortedUnit, int (bin));
+    }
+}
+
+
+void PsthEngine::count (int unit, int bin)
+{
+    const uint64 value = ++counts[size_t (unit) * numBins + bin];
+    Summary& summary = summaries[unit];
+
+    ++totals[unit];
+    summary.mean = float (totals[unit]) / float (numBins);
+
+    if (value > summary.max)
+        summary.max = float (value);
+
+    // counts only go up, so the minimum moves up by one when its last bin leaves it
+    if (value - 1 == uint64 (summary.min) && --binsAtMin[unit] == 0)
+    {
+        summary.min += 1.0f;
+
+        const uint64* unitCounts = &counts[size_t (unit) * numBins];
+        const uint64 minimum = uint64 (summary.min);
+        int atMin = 0;
+
+        for (int i = 0; i < numBins; ++i)
+            atMin += unitCounts[i] == minimum;
+
+        binsAtMin[unit] = atMin;
+    }
+}
+
+
+void PsthEngine::publish()
+{
+    const ScopedTryLock lock (snapshotLock);
+
+    if (! lock.isLocked())
+        return;
+
+    snapshot.units = units;
+    snapshot.summaries = summaries;
+    snapshot.counts = counts;
+    snapshot.numBins = numBins;
+    snapshot.numTrials = numTrials;
+    snapshot.layout = layout;
+}
+
+
+void PsthEngine::getSnapshot (Snapshot& destination) const
+{
+    const ScopedLock lock (snapshotLock);
+
+    destination = snapshot;
+}
+
+
+int64 PsthEngine::getPublishedTrials() const
+{
+    const ScopedLock lock (snapshotLock);
+
+    return snapshot.numTrials;
+}
@@ -0,0 +1,190 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PSTHENGINE_H__
+#define __PSTHENGINE_H__
+
+#include <BasicJuceHeader.h>
+#include <vector>
+
+/**
+    Peri-stimulus time histograms of spikes around triggers, built incrementally.
+
+    The window spans from windowSize/2 samples before each trigger to windowSize/2
+    after it. A spike can only be binned once every trigger whose window contains it
+    has arrived, so spikes wait in a queue until the stream is windowSize/2 past them.
+    They are then binned once against the triggers around them, found by binary search
+    in a sorted ring of recent triggers, and counted in place in a flat array of bins
+    per unit. Triggers leave the ring, and count as a trial, once no queued spike can
+    fall in their window.
+
+    Every electrode has a unit with all its spikes (sorted ID 0) and one per sorted ID
+    seen on it. Minimum, maximum and mean counts are kept up to date on every count.
+
+    All methods but getSnapshot() are called from the processing thread. publish()
+    copies the histograms to a snapshot that getSnapshot() reads from the message thread.
+
+    @see EvntTrigAvg
+*/
+class PsthEngine
+{
+public:
+    struct Unit
+    {
+        int electrode;
+        int sortedId;
+    };
+
+    struct Summary
+    {
+        float min;
+        float max;
+        float mean;
+    };
+
+    /** Copy of the histograms, for displays */
+    struct Snapshot
+    {
+        Snapshot();
+
+        const uint64* getCounts (int unit) const { return &counts[size_t (unit) * numBins]; }
+
+        std::vector<Unit> units;
+        std::vector<Summary> summaries;
+        std::vector<uint64> counts;
+        int numBins;
+        int64 numTrials;
+        // changes when units are added or the bins change, so displays know to rebuild
+        int layout;
+    };
+
+    PsthEngine();
+
+    /** Sets the window and bins and clears everything. Allocates */
+    void configure (int numElectrodes, int64 windowSize, int64 binSize);
+
+    /** Clears the histograms and the queued triggers and spikes, keeping the units */
+    void reset();
+
+    void addTrigger (int64 timestamp);
+    void addSpike (int electrode, int sortedId, int64 timestamp);
+
+    /** Bins the spikes the stream has gone far enough past, now being the latest timestamp */
+    void advance (int64 now);
+
+    /** Copies the histograms to the snapshot, unless the message thread is reading it */
+    void publish();
+
+    /** Copies the last published snapshot */
+    void getSnapshot (Snapshot& destination) const;
+
+    /** Number of trials in the last published snapshot */
+    int64 getPublishedTrials() const;
+
+    int getNumBins() const { return numBins; }
+
+private:
+    /** Power of two ring, grown when full */
+    template <typename Type>
+    class Ring
+    {
+    public:
+        Ring() : head (0), count (0) {}
+
+        void clear() { head = 0; count = 0; }
+        int size() const { return count; }
+        Type& operator[] (int i) { return items[(head + i) & (items.size() - 1)]; }
+
+        void push (const Type& item)
+        {
+            if (count == int (items.size()))
+                grow();
+            items[(head + count++) & (items.size() - 1)] = item;
+        }
+
+        void pop() { head = (head + 1) & (items.size() - 1); --count; }
+
+        void reserve (int capacity)
+        {
+            while (int (items.size()) < capacity)
+                grow();
+        }
+
+    private:
+        void grow()
+        {
+            std::vector<Type> larger (jmax<size_t> (64, items.size() * 2));
+            for (int i = 0; i < count; ++i)
+                larger[i] = (*this)[i];
+            items.swap (larger);
+            head = 0;
+        }
+
+        std::vector<Type> items;
+        int head;
+        int count;
+    };
+
+    struct SortedUnit
+    {
+        int sortedId;
+        int unit;
+    };
+
+    struct PendingSpike
+    {
+        int64 timestamp;
+        int allUnit;
+        int sortedUnit;
+    };
+
+    int findUnit (int electrode, int sortedId);
+    int addUnit (int electrode, int sortedId);
+    void binSpike (const PendingSpike& spike);
+    void count (int unit, int bin);
+
+    int64 windowSize;
+    int64 halfWindow;
+    int64 binSize;
+    int numBins;
+
+    std::vector<Unit> units;
+    // per electrode, the units of its sorted IDs
+    std::vector<std::vector<SortedUnit>> electrodeUnits;
+    std::vector<uint64> counts;
+    std::vector<Summary> summaries;
+    std::vector<uint64> totals;
+    std::vector<int> binsAtMin;
+
+    Ring<int64> triggers;
+    Ring<PendingSpike> spikes;
+    int64 numTrials;
+    int layout;
+
+    CriticalSection snapshotLock;
+    Snapshot snapshot;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PsthEngine);
+};
+
+#endif  // __PSTHENGINE_H__
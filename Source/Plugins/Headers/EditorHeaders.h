@@ -31,6 +31,7 @@ which should use VisualizerEditorHeaders.
 #include "../../Processors/Editors/GenericEditor.h"
 #include "../../Processors/Editors/ImageIcon.h"
 #include "../../Processors/Editors/ElectrodeButtons.h"
+#include "../../Processors/Editors/ChannelGrid.h"
 #include "../../Processors/Editors/ChannelSelector.h"
 
 
@@ -30,3 +30,4 @@ Should be included in the source files which declare a processor class.
 #include "../../Processors/GenericProcessor/GenericProcessor.h"
 #include "../../Processors/Events/Events.h"
 
+#include "../../Processors/GenericProcessor/ChannelStatistics.h"
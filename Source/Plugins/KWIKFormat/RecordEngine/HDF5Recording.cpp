@@ -27,7 +27,7 @@
 #define CHANNEL_TIMESTAMP_MIN_WRITE	32
 #define TIMESTAMP_EACH_NSAMPLES 1024
 
-HDF5Recording::HDF5Recording() : processorIndex(-1), bufferSize(MAX_BUFFER_SIZE), hasAcquired(false)
+HDF5Recording::HDF5Recording() : processorIndex(-1), bufferSize(MAX_BUFFER_SIZE), hasAcquired(false), compressionLevel(0), compressionThreads(2)
 {
     //timestamp = 0;
     scaledBuffer.malloc(MAX_BUFFER_SIZE);
@@ -139,6 +139,8 @@ void HDF5Recording::openFiles(File rootFolder, int experimentNumber, int recordi
 		channelLeftOverSamples.add(0);
 	} 
 
+	if (compressionLevel > 0)
+		compressionPool = new ThreadPool(compressionThreads);
     for (int i = 0; i < fileArray.size(); i++)
     {
 		if ((!fileArray[i]->isOpen()) && (fileArray[i]->isReadyToOpen()))
@@ -157,6 +159,7 @@ void HDF5Recording::openFiles(File rootFolder, int experimentNumber, int recordi
             infoArray[i]->bitVolts.addArray(*bitVoltsArray[i]);
             infoArray[i]->channelSampleRates.clear();
             infoArray[i]->channelSampleRates.addArray(*sampleRatesArray[i]);
+            fileArray[i]->setCompression(compressionLevel, compressionPool);
             fileArray[i]->startNewRecording(recordingNumber,bitVoltsArray[i]->size(),infoArray[i]);
         }
     }
@@ -182,6 +185,7 @@ void HDF5Recording::closeFiles()
         }
 		channelsPerProcessor.set(i, 0);
     }
+	compressionPool = nullptr;
 	recordedChanToKWDChan.clear();
 	channelTimestampArray.clear();
 	channelLeftOverSamples.clear();
@@ -289,5 +293,16 @@ void HDF5Recording::startAcquisition()
 RecordEngineManager* HDF5Recording::getEngineManager()
 {
     RecordEngineManager* man = new RecordEngineManager("KWIK","Kwik",&(engineFactory<HDF5Recording>));
+	EngineParameter* param;
+	param = new EngineParameter(EngineParameter::INT, 0, "Compression level", 0, 0, 9);
+	man->addParameter(param);
+	param = new EngineParameter(EngineParameter::INT, 1, "Compression threads", jlimit(1, 8, SystemStats::getNumCpus() / 2), 1, 32);
+	man->addParameter(param);
     return man;
 }
+
+void HDF5Recording::setParameter(EngineParameter& parameter)
+{
+	intParameter(0, compressionLevel);
+	intParameter(1, compressionThreads);
+}
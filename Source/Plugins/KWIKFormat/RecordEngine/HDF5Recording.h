@@ -45,6 +45,7 @@ public:
 	void resetChannels() override;
 	void startAcquisition() override;
 	void endChannelBlock(bool lastBlock) override;
+	void setParameter(EngineParameter& parameter) override;
 
     static RecordEngineManager* getEngineManager();
 private:
@@ -58,6 +59,8 @@ private:
     OwnedArray<Array<float>> sampleRatesArray;
 	OwnedArray<Array<int64>> channelTimestampArray;
 	Array<int> channelLeftOverSamples;
+	//declared before the files so it outlives the datasets waiting for their chunks
+	ScopedPointer<ThreadPool> compressionPool;
     OwnedArray<KWDFile> fileArray;
     OwnedArray<KWIKRecordingInfo> infoArray;
     ScopedPointer<KWEFile> eventFile;
@@ -69,6 +72,8 @@ private:
     //int16* intBuffer;
 
     bool hasAcquired;
+	int compressionLevel;
+	int compressionThreads;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HDF5Recording);
 };
@@ -89,7 +89,7 @@ void KWDFile::startNewRecording(int recordingNumber, int nChannels, KWIKRecordin
 	else
 		std::cerr << "Error creating sample rates data set" << std::endl;
 
-	recdata = createDataSet(BaseDataType::I16, 0, nChannels, CHUNK_XSIZE, recordPath + "/data");
+	recdata = createDataSet(BaseDataType::I16, 0, nChannels, CHUNK_XSIZE, recordPath + "/data", true);
     if (!recdata.get())
         std::cerr << "Error creating data set" << std::endl;
 
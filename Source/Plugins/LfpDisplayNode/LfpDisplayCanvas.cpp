@@ -609,37 +609,20 @@ const int LfpDisplayCanvas::getSampleCountPerPixel(int px)
 
 float LfpDisplayCanvas::getMean(int chan)
 {
-    float total = 0.0f;
-    float numPts = 0;
+    ChannelStatistics::Values values;
+    if (!processor->getChannelValues(chan, values))
+        return 0.0f;
 
-    float sample = 0.0f;
-    for (int samp = 0; samp < (lfpDisplay->getWidth() - leftmargin); samp += 10)
-    {
-        sample = *screenBuffer->getReadPointer(chan, samp);
-        total += sample;
-        numPts++;
-    }
-
-    //std::cout << sample << std::endl;
-
-    return total / numPts;
+    return values.mean;
 }
 
 float LfpDisplayCanvas::getStd(int chan)
 {
-    float std = 0.0f;
-
-    float mean = getMean(chan);
-    float numPts = 1;
-
-    for (int samp = 0; samp < (lfpDisplay->getWidth() - leftmargin); samp += 10)
-    {
-        std += pow((*screenBuffer->getReadPointer(chan, samp) - mean),2);
-        numPts++;
-    }
-
-    return sqrt(std / numPts);
+    ChannelStatistics::Values values;
+    if (!processor->getChannelValues(chan, values))
+        return 0.0f;
 
+    return values.std;
 }
 
 bool LfpDisplayCanvas::getInputInvertedState()
@@ -3266,6 +3249,7 @@ void LfpChannelDisplay::pxPaint()
     }
     
     bool drawWithOffsetCorrection = display->getMedianOffsetPlotting();
+    const float channelMean = drawWithOffsetCorrection ? canvas->getMean(chan) : 0.0f;
     
     LfpBitmapPlotterInfo plotterInfo; // hold and pass plotting info for each plotting method class
     
@@ -3326,7 +3310,7 @@ void LfpChannelDisplay::pxPaint()
             double a = (canvas->getYCoordMax(chan, i)/range*channelHeightFloat);
             double b = (canvas->getYCoordMin(chan, i)/range*channelHeightFloat);
             
-            double mean = (canvas->getMean(chan)/range*channelHeightFloat);
+            double mean = (channelMean/range*channelHeightFloat);
             
             if (drawWithOffsetCorrection)
             {
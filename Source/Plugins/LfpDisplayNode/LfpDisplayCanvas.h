@@ -133,6 +133,7 @@ public:
     const float getYCoordMean(int chan, int samp);
     const float getYCoordMax(int chan, int samp);
 
+    /** Mean and standard deviation of a channel over the last seconds, from the processor's statistics */
     float getMean(int chan);
     float getStd(int chan);
 
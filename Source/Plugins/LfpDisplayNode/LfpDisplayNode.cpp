@@ -177,6 +177,18 @@ bool LfpDisplayNode::resizeBuffer()
 		displayBufferIndex.clear();
 		displayBufferIndex.insertMultiple(0, 0, numChannelsInSubprocessor + numEventChannels);
 
+		// computed upstream, and shared with every other processor reading the same channels
+		channelStatistics.clearQuick();
+		for (int chan = 0; chan < getNumInputs(); chan++)
+		{
+			if (getDataChannel(chan)->getSubProcessorIdx() == subprocessorToDraw)
+			{
+				ChannelStatistics::Channel statistics = getInputStatistics(chan, 2.0f);
+				statistics.watch();
+				channelStatistics.add(statistics);
+			}
+		}
+
 		return true;
 	}
 	else
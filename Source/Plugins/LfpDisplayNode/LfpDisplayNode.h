@@ -72,6 +72,9 @@ public:
 
 	float getSubprocessorSampleRate();
 
+    /** Statistics of a channel being drawn. Returns false if there are none */
+    bool getChannelValues(int channel, ChannelStatistics::Values& values) const { return channelStatistics[channel].getValues(values); }
+
 private:
     void initializeEventChannels();
     void finalizeEventChannels();
@@ -104,6 +107,8 @@ private:
     CriticalSection displayMutex;
 	bool updateSubprocessorsFlag;
 
+    Array<ChannelStatistics::Channel> channelStatistics;
+
 	uint32 getChannelSourceID(const EventChannel* event) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfpDisplayNode);
@@ -118,6 +118,15 @@ bool LfpDisplayNode::resizeBuffer()
         abstractFifo.setTotalSize (nSamples);
         displayBuffer->setSize (nInputs + numEventChannels, nSamples); // add extra channels for TTLs
 
+        // computed upstream, and shared with every other processor reading the same channels
+        channelStatistics.clearQuick();
+        for (int chan = 0; chan < nInputs; ++chan)
+        {
+            ChannelStatistics::Channel statistics = getInputStatistics (chan, 2.0f);
+            statistics.watch();
+            channelStatistics.add (statistics);
+        }
+
         return true;
     }
     else
@@ -67,6 +67,9 @@ public:
 
     CriticalSection* getMutex() { return &displayMutex; }
 
+    /** Statistics of an input channel. Returns false if there are none */
+    bool getChannelValues (int channel, ChannelStatistics::Values& values) const { return channelStatistics[channel].getValues (values); }
+
 
 private:
     void initializeEventChannels();
@@ -93,6 +96,8 @@ private:
 
     CriticalSection displayMutex;
 
+    Array<ChannelStatistics::Channel> channelStatistics;
+
 	uint32 getChannelSourceID(const EventChannel* event) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfpDisplayNode);
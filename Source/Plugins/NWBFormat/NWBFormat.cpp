@@ -34,6 +34,27 @@
 
 #ifndef SPIKE_CHUNK_YSIZE
 #define SPIKE_CHUNK_YSIZE 40
+#endif
+
+//Events and spikes are staged in memory and appended when a series holds this many bytes...
+#ifndef EVENT_STAGING_BYTES
+#define EVENT_STAGING_BYTES (1 << 20)
+#endif
+
+//...or its oldest staged row is this old
+#ifndef EVENT_FLUSH_INTERVAL_MS
+#define EVENT_FLUSH_INTERVAL_MS 1000
+#endif
+
+//Staged datasets get chunks of about one flush interval of rows, between EVENT_CHUNK_SIZE
+//(or SPIKE_CHUNK_XSIZE) rows and this many bytes
+#ifndef MAX_EVENT_CHUNK_BYTES
+#define MAX_EVENT_CHUNK_BYTES (1 << 20)
+#endif
+
+//Rows per chunk of the continuous timestamp discontinuity tables, which only grow on gaps
+#ifndef DISCONTINUITY_CHUNK_SIZE
+#define DISCONTINUITY_CHUNK_SIZE 16
 #endif
 
  #define MAX_BUFFER_SIZE 40960
@@ -46,18 +67,39 @@
 	 scaledBuffer.malloc(MAX_BUFFER_SIZE);
 	 intBuffer.malloc(MAX_BUFFER_SIZE);
 	 bufferSize = MAX_BUFFER_SIZE;
+	 recordingStartTime = 0;
+	 compactTimestamps = false;
  }
  
  NWBFile::~NWBFile()
  {
  }
 
+ StagedDataSet::StagedDataSet(const String& p, HDF5FileBase::BaseDataType t, int dim, int y, int z)
+	 : path(p), type(t), dimension(dim), sizeY(y), sizeZ(z), rowSize(t.typeSize * y * z)
+ {
+ }
+
+ void* StagedDataSet::appendRow()
+ {
+	 const size_t offset = numRows * rowSize;
+	 if (rows.getSize() < offset + rowSize)
+		 rows.setSize(jmax(offset + rowSize, rows.getSize() * 2), false);
+	 numRows++;
+	 return static_cast<char*>(rows.getData()) + offset;
+ }
+
 
  void NWBFile::setXmlText(const String& xmlText)
  {
 	 this->xmlText = &xmlText;
  }
 
+ void NWBFile::setCompactTimestamps(bool compact)
+ {
+	 compactTimestamps = compact;
+ }
+
 //All int return values are 0 if succesful, other number otherwise
 int NWBFile::createFileStructure()
 {
@@ -108,6 +150,9 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 	 spikeDataSets.clearQuick(true);
 	 eventDataSets.clearQuick(true);
 
+	 //staged datasets use the time since now to estimate their rates
+	 recordingStartTime = Time::getMillisecondCounter();
+
 	 ScopedPointer<TimeSeries> tsStruct;
 	 ScopedPointer<HDF5RecordingData> dSet;
 
@@ -129,7 +174,7 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 		 if (!createTimeSeriesBase(basePath, name, "Stores acquired voltage data from extracellular recordings", "", ancestry)) return false;
 		 tsStruct = new TimeSeries();
 		 tsStruct->basePath = basePath;
-		 dSet = createDataSet(BaseDataType::I16, 0, continuousArray.getReference(i).size(), CHUNK_XSIZE, basePath + "/data");
+		 dSet = createDataSet(BaseDataType::I16, 0, continuousArray.getReference(i).size(), CHUNK_XSIZE, basePath + "/data", true);
 		 if (dSet == nullptr)
 		 {
 			 std::cerr << "Error creating dataset for " << name << std::endl;
@@ -141,7 +186,14 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 		 }
 		 tsStruct->baseDataSet = dSet;
 
-		 dSet = createTimestampDataSet(basePath, CHUNK_XSIZE);
+		 if (compactTimestamps)
+		 {
+			 //starting_time is written along with the first discontinuity, when the first timestamp is known
+			 tsStruct->sampleRate = info->getSampleRate();
+			 dSet = createDiscontinuityDataSet(basePath);
+		 }
+		 else
+			 dSet = createTimestampDataSet(basePath, CHUNK_XSIZE);
 		 if (dSet == nullptr) return false;
 		 tsStruct->timestampDataSet = dSet;
 
@@ -173,20 +225,17 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 		 tsStruct = new TimeSeries();
 		 tsStruct->basePath = basePath;
 
-		 dSet = createDataSet(BaseDataType::I16, 0, info->getNumChannels(), info->getTotalSamples(), SPIKE_CHUNK_XSIZE, basePath + "/data");
-		 if (dSet == nullptr)
-		 {
-			 std::cerr << "Error creating dataset for electrode " << i << std::endl;
-			 return false;
-		 }
-		 else
-		 {
-			 createDataAttributes(basePath, info->getChannelBitVolts(0), info->getChannelBitVolts(0) / 65536, "volt");
-		 }
-		 tsStruct->baseDataSet = dSet;
-		 dSet = createTimestampDataSet(basePath, SPIKE_CHUNK_XSIZE);
-		 if (dSet == nullptr) return false;
-		 tsStruct->timestampDataSet = dSet;
+		 StagedDataSet* staged = addStagedDataSet(tsStruct, basePath + "/data", BaseDataType::I16, 3, info->getNumChannels(), info->getTotalSamples());
+		 staged->numericAttributes.set("conversion", double(info->getChannelBitVolts(0)));
+		 staged->numericAttributes.set("resolution", double(info->getChannelBitVolts(0) / 65536));
+		 staged->textAttributes.set("unit", "volt");
+		 staged->compressed = true;
+		 tsStruct->stagedData = staged;
+
+		 staged = addStagedDataSet(tsStruct, basePath + "/timestamps", BaseDataType::F64, 1);
+		 staged->numericAttributes.set("interval", 1);
+		 staged->textAttributes.set("unit", "seconds");
+		 tsStruct->stagedTimestamps = staged;
 
 		 basePath = basePath + "/oe_extra_info";
 		 createExtraInfo(basePath, info->getName(), info->getDescription(), info->getIdentifier(), info->getSourceIndex(), info->getSourceTypeIndex());
@@ -241,40 +290,30 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 		 tsStruct = new TimeSeries();
 		 tsStruct->basePath = basePath;
 
+		 StagedDataSet* staged;
 		 if (info->getChannelType() >= EventChannel::BINARY_BASE_VALUE) //only binary events have length greater than 1
 		 {
-			 dSet = createDataSet(getEventH5Type(info->getChannelType(), info->getLength()), 0, info->getLength(), EVENT_CHUNK_SIZE, basePath + "/data");;
+			 staged = addStagedDataSet(tsStruct, basePath + "/data", getEventH5Type(info->getChannelType(), info->getLength()), 2, info->getLength());
 		 }
 		 else
 		 {
-			 dSet = createDataSet(getEventH5Type(info->getChannelType(), info->getLength()), 0, EVENT_CHUNK_SIZE, basePath + "/data");
+			 staged = addStagedDataSet(tsStruct, basePath + "/data", getEventH5Type(info->getChannelType(), info->getLength()), 1);
 		 }
+		 staged->numericAttributes.set("conversion", double(NAN));
+		 staged->numericAttributes.set("resolution", double(NAN));
+		 staged->textAttributes.set("unit", "n/a");
+		 tsStruct->stagedData = staged;
 
-		 if (dSet == nullptr)
-		 {
-			 std::cerr << "Error creating dataset for event " << info->getName() << std::endl;
-			 return false;
-		 }
-		 else
-		 {
-			 createDataAttributes(basePath, NAN, NAN, "n/a");
-		 }
+		 staged = addStagedDataSet(tsStruct, basePath + "/timestamps", BaseDataType::F64, 1);
+		 staged->numericAttributes.set("interval", 1);
+		 staged->textAttributes.set("unit", "seconds");
+		 tsStruct->stagedTimestamps = staged;
 
-
-		 tsStruct->baseDataSet = dSet;
-		 dSet = createTimestampDataSet(basePath, EVENT_CHUNK_SIZE);
-		 if (dSet == nullptr) return false;
-		 tsStruct->timestampDataSet = dSet;
-
-		 dSet = createDataSet(BaseDataType::U8, 0, EVENT_CHUNK_SIZE, basePath + "/control");
-		 if (dSet == nullptr) return false;
-		 tsStruct->controlDataSet = dSet;
+		 tsStruct->stagedControl = addStagedDataSet(tsStruct, basePath + "/control", BaseDataType::U8, 1);
 
 		 if (info->getChannelType() == EventChannel::TTL)
 		 {
-			 dSet = createDataSet(BaseDataType::U8, 0, info->getDataSize(), EVENT_CHUNK_SIZE, basePath + "/full_word");
-			 if (dSet == nullptr) return false;
-			 tsStruct->ttlWordDataSet = dSet;
+			 tsStruct->stagedTTLWord = addStagedDataSet(tsStruct, basePath + "/full_word", BaseDataType::U8, 2, info->getDataSize());
 		 }
 
 		 basePath = basePath + "/oe_extra_info";
@@ -317,6 +356,12 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
  
  void NWBFile::stopRecording()
  {
+	 //Forced flush, so no staged event is lost. Series without events still get their (empty) datasets
+	 for (int i = 0; i < spikeDataSets.size(); i++)
+		 flushTimeSeries(spikeDataSets[i], true);
+	 for (int i = 0; i < eventDataSets.size(); i++)
+		 flushTimeSeries(eventDataSets[i], true);
+
 	 int nObjs = continuousDataSets.size();
 	 const TimeSeries* tsStruct;
 	 for (int i = 0; i < nObjs; i++)
@@ -382,6 +427,34 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 	 CHECK_ERROR(continuousDataSets[datasetID]->timestampDataSet->writeDataBlock(nSamples, BaseDataType::F64, data));
  }
 
+ void NWBFile::writeTimestampDiscontinuity(int datasetID, uint64 sampleIndex, int64 timestamp)
+ {
+	 TimeSeries* tsStruct = continuousDataSets[datasetID];
+	 if (!tsStruct)
+		 return;
+
+	 if (sampleIndex == 0)
+	 {
+		 String path = tsStruct->basePath + "/starting_time";
+		 ScopedPointer<HDF5RecordingData> dSet = createDataSet(BaseDataType::F64, 0, 1, path);
+		 if (dSet == nullptr)
+		 {
+			 std::cerr << "Error creating starting_time in " << tsStruct->basePath << std::endl;
+		 }
+		 else
+		 {
+			 const double startTime = timestamp / tsStruct->sampleRate;
+			 const float rate = tsStruct->sampleRate;
+			 CHECK_ERROR(dSet->writeDataBlock(1, BaseDataType::F64, &startTime));
+			 CHECK_ERROR(setAttribute(BaseDataType::F32, &rate, path, "rate"));
+			 CHECK_ERROR(setAttributeStr("Seconds", path, "unit"));
+		 }
+	 }
+
+	 const int64 row[2] = { (int64)sampleIndex, timestamp };
+	 CHECK_ERROR(tsStruct->timestampDataSet->writeDataBlock(1, BaseDataType::I64, row));
+ }
+
  void NWBFile::writeSpike(int electrodeId, const SpikeChannel* channel, const SpikeEvent* event)
  {
 	 if (!spikeDataSets[electrodeId])
@@ -396,17 +469,15 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 		 intBuffer.malloc(nSamples);
 	 }
 
+	 TimeSeries* tsStruct = spikeDataSets[electrodeId];
+
 	 double multFactor = 1 / (float(0x7fff) * channel->getChannelBitVolts(0));
 	 FloatVectorOperations::copyWithMultiply(scaledBuffer.getData(), event->getDataPointer(), multFactor, nSamples);
-	 AudioDataConverters::convertFloatToInt16LE(scaledBuffer.getData(), intBuffer.getData(), nSamples);
-
-	 double timestampSec = event->getTimestamp() / channel->getSampleRate();
-
-	 CHECK_ERROR(spikeDataSets[electrodeId]->baseDataSet->writeDataBlock(1, BaseDataType::I16, intBuffer));
-	 CHECK_ERROR(spikeDataSets[electrodeId]->timestampDataSet->writeDataBlock(1, BaseDataType::F64, &timestampSec));
-	 writeEventMetaData(spikeDataSets[electrodeId], channel, event);
+	 AudioDataConverters::convertFloatToInt16LE(scaledBuffer.getData(), tsStruct->stagedData->appendRow(), nSamples);
 
-	 spikeDataSets[electrodeId]->numSamples += 1;
+	 stageTimestamp(tsStruct, event->getTimestamp() / channel->getSampleRate());
+	 stageEventMetaData(tsStruct, channel, event);
+	 finishStagedRow(tsStruct);
 
  }
 
@@ -415,44 +486,179 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 	 if (!eventDataSets[eventID])
 		 return;
 	 
-	 const void* dataSrc;
-	 BaseDataType type;
-	 int8 ttlVal;
-	 String text;
+	 TimeSeries* tsStruct = eventDataSets[eventID];
+	 StagedDataSet* staged = tsStruct->stagedData;
+	 void* row = staged->appendRow();
 
 	 switch (event->getEventType())
 	 {
 	 case EventChannel::TTL:
-		 ttlVal = (static_cast<const TTLEvent*>(event)->getState() ? 1 : -1) * (event->getChannel() + 1);
-		 dataSrc = &ttlVal;
-		 type = BaseDataType::I8;
+		 *static_cast<int8*>(row) = (static_cast<const TTLEvent*>(event)->getState() ? 1 : -1) * (event->getChannel() + 1);
 		 break;
 	 case EventChannel::TEXT:
-		 text = static_cast<const TextEvent*>(event)->getText();
-		 dataSrc = text.toUTF8().getAddress();
-		 type = BaseDataType::STR(text.length());
+	 {
+		 //rows have the fixed string length of the channel
+		 const String text = static_cast<const TextEvent*>(event)->getText();
+		 const size_t textSize = jmin(text.getNumBytesAsUTF8(), staged->rowSize);
+		 zeromem(row, staged->rowSize);
+		 memcpy(row, text.toRawUTF8(), textSize);
 		 break;
+	 }
 	 default:
-		 dataSrc = static_cast<const BinaryEvent*>(event)->getBinaryDataPointer();
-		 type = getEventH5Type(event->getEventType());
+		 memcpy(row, static_cast<const BinaryEvent*>(event)->getBinaryDataPointer(), staged->rowSize);
 		 break;
 	 }
-	 CHECK_ERROR(eventDataSets[eventID]->baseDataSet->writeDataBlock(1, type, dataSrc));
 
-	 double timeSec = event->getTimestamp() / channel->getSampleRate();
+	 stageTimestamp(tsStruct, event->getTimestamp() / channel->getSampleRate());
 
-	 CHECK_ERROR(eventDataSets[eventID]->timestampDataSet->writeDataBlock(1, BaseDataType::F64, &timeSec));
+	 *static_cast<uint8*>(tsStruct->stagedControl->appendRow()) = event->getChannel() + 1;
 
-	 uint8 controlValue = event->getChannel() + 1;
+	 if (event->getEventType() == EventChannel::TTL)
+	 {
+		 memcpy(tsStruct->stagedTTLWord->appendRow(), static_cast<const TTLEvent*>(event)->getTTLWordPointer(), tsStruct->stagedTTLWord->rowSize);
+	 }
 
-	 CHECK_ERROR(eventDataSets[eventID]->controlDataSet->writeDataBlock(1, BaseDataType::U8, &controlValue));
+	 stageEventMetaData(tsStruct, channel, event);
+	 finishStagedRow(tsStruct);
+ }
 
-	 if (event->getEventType() == EventChannel::TTL)
+ void NWBFile::writeTTLWordChange(int eventID, const EventChannel* channel, const TTLWordChange& change)
+ {
+	 if (!eventDataSets[eventID])
+		 return;
+
+	 TimeSeries* tsStruct = eventDataSets[eventID];
+	 const double timestampSec = change.getTimestamp() / channel->getSampleRate();
+	 const uint64 word = change.getWord();
+
+	 for (int bit = change.getNextChangedBit(-1); bit >= 0; bit = change.getNextChangedBit(bit))
 	 {
-		 CHECK_ERROR(eventDataSets[eventID]->ttlWordDataSet->writeDataBlock(1, BaseDataType::U8, static_cast<const TTLEvent*>(event)->getTTLWordPointer()));
+		 *static_cast<int8*>(tsStruct->stagedData->appendRow()) = (change.getState(bit) ? 1 : -1) * (bit + 1);
+		 stageTimestamp(tsStruct, timestampSec);
+		 *static_cast<uint8*>(tsStruct->stagedControl->appendRow()) = bit + 1;
+		 memcpy(tsStruct->stagedTTLWord->appendRow(), &word, jmin(tsStruct->stagedTTLWord->rowSize, sizeof(uint64)));
+		 finishStagedRow(tsStruct);
+	 }
+ }
+
+ void NWBFile::stageTimestamp(TimeSeries* timeSeries, double timestampSec)
+ {
+	 *static_cast<double*>(timeSeries->stagedTimestamps->appendRow()) = timestampSec;
+ }
+
+ void NWBFile::finishStagedRow(TimeSeries* timeSeries)
+ {
+	 if (timeSeries->numStagedRows == 0)
+		 timeSeries->firstStagedTime = Time::getMillisecondCounter();
+	 timeSeries->numStagedRows++;
+	 timeSeries->numSamples += 1;
+
+	 size_t stagedBytes = 0;
+	 for (int i = 0; i < timeSeries->stagedDataSets.size(); i++)
+		 stagedBytes += timeSeries->stagedDataSets[i]->numRows * timeSeries->stagedDataSets[i]->rowSize;
+
+	 if (stagedBytes >= EVENT_STAGING_BYTES)
+		 flushTimeSeries(timeSeries);
+ }
+
+ void NWBFile::flushStaleEvents()
+ {
+	 const uint32 now = Time::getMillisecondCounter();
+	 for (int i = 0; i < spikeDataSets.size(); i++)
+	 {
+		 if (spikeDataSets[i]->numStagedRows > 0 && now - spikeDataSets[i]->firstStagedTime >= EVENT_FLUSH_INTERVAL_MS)
+			 flushTimeSeries(spikeDataSets[i]);
+	 }
+	 for (int i = 0; i < eventDataSets.size(); i++)
+	 {
+		 if (eventDataSets[i]->numStagedRows > 0 && now - eventDataSets[i]->firstStagedTime >= EVENT_FLUSH_INTERVAL_MS)
+			 flushTimeSeries(eventDataSets[i]);
 	 }
-	 
-	 eventDataSets[eventID]->numSamples += 1;
+ }
+
+ void NWBFile::flushEvents()
+ {
+	 for (int i = 0; i < spikeDataSets.size(); i++)
+		 flushTimeSeries(spikeDataSets[i]);
+	 for (int i = 0; i < eventDataSets.size(); i++)
+		 flushTimeSeries(eventDataSets[i]);
+ }
+
+ void NWBFile::flushTimeSeries(TimeSeries* timeSeries, bool createIfEmpty)
+ {
+	 if (timeSeries->numStagedRows == 0 && !createIfEmpty)
+		 return;
+
+	 //The first flush fixes the chunk size: about one flush interval worth of rows at the rate seen so far
+	 const double elapsed = jmax(0.001, (Time::getMillisecondCounter() - recordingStartTime) / 1000.0);
+	 const double rowsPerInterval = timeSeries->numStagedRows / elapsed * EVENT_FLUSH_INTERVAL_MS / 1000.0;
+	 const int minChunk = timeSeries->stagedControl == nullptr ? SPIKE_CHUNK_XSIZE : EVENT_CHUNK_SIZE;
+
+	 for (int i = 0; i < timeSeries->stagedDataSets.size(); i++)
+	 {
+		 StagedDataSet* staged = timeSeries->stagedDataSets[i];
+
+		 if (staged->dataSet == nullptr)
+		 {
+			 const int maxChunk = jmax(minChunk, int(MAX_EVENT_CHUNK_BYTES / staged->rowSize));
+			 const int chunk = jlimit(minChunk, maxChunk, nextPowerOfTwo(int(rowsPerInterval)));
+			 if (!createStagedDataSet(staged, chunk))
+			 {
+				 //nowhere to write the rows, but keep the other datasets of the series going
+				 staged->numRows = 0;
+				 continue;
+			 }
+		 }
+
+		 if (staged->numRows > 0)
+			 CHECK_ERROR(staged->dataSet->writeDataBlock(staged->numRows, staged->type, staged->rows.getData()));
+		 staged->numRows = 0;
+	 }
+	 timeSeries->numStagedRows = 0;
+ }
+
+ bool NWBFile::createStagedDataSet(StagedDataSet* staged, int chunkRows)
+ {
+	 switch (staged->dimension)
+	 {
+	 case 1:
+		 staged->dataSet = createDataSet(staged->type, 0, chunkRows, staged->path, staged->compressed);
+		 break;
+	 case 2:
+		 staged->dataSet = createDataSet(staged->type, 0, staged->sizeY, chunkRows, staged->path, staged->compressed);
+		 break;
+	 default:
+		 staged->dataSet = createDataSet(staged->type, 0, staged->sizeY, staged->sizeZ, chunkRows, staged->path, staged->compressed);
+		 break;
+	 }
+
+	 if (staged->dataSet == nullptr)
+	 {
+		 std::cerr << "Error creating dataset " << staged->path << std::endl;
+		 return false;
+	 }
+
+	 for (int i = 0; i < staged->numericAttributes.size(); i++)
+	 {
+		 const var& value = staged->numericAttributes.getValueAt(i);
+		 const String name = staged->numericAttributes.getName(i).toString();
+		 if (value.isInt())
+		 {
+			 const int32 intValue = value;
+			 CHECK_ERROR(setAttribute(BaseDataType::I32, &intValue, staged->path, name));
+		 }
+		 else
+		 {
+			 const float floatValue = value;
+			 CHECK_ERROR(setAttribute(BaseDataType::F32, &floatValue, staged->path, name));
+		 }
+	 }
+
+	 const StringArray& keys = staged->textAttributes.getAllKeys();
+	 for (int i = 0; i < keys.size(); i++)
+		 CHECK_ERROR(setAttributeStr(staged->textAttributes[keys[i]], staged->path, keys[i]));
+
+	 return true;
  }
 
  void NWBFile::writeTimestampSyncText(uint16 sourceID, int64 timestamp, float sourceSampleRate, String text)
@@ -503,6 +709,20 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 	  return tsSet;
   }
 
+  HDF5RecordingData* NWBFile::createDiscontinuityDataSet(String basePath)
+  {
+	  String path = basePath + "/oe_timestamp_discontinuities";
+	  HDF5RecordingData* tsSet = createDataSet(BaseDataType::I64, 0, 2, DISCONTINUITY_CHUNK_SIZE, path);
+	  if (!tsSet)
+		  std::cerr << "Error creating timestamp discontinuity dataset in " << basePath << std::endl;
+	  else
+	  {
+		  CHECK_ERROR(setAttributeStr("openephys:<timestamp_discontinuities>/", path, "schema_id"));
+		  CHECK_ERROR(setAttributeStr("(sample index, timestamp in source samples) of every sample whose timestamp does not follow the previous one. The first row is the first sample", path, "description"));
+	  }
+	  return tsSet;
+  }
+
   bool NWBFile::createExtraInfo(String basePath, String name, String desc, String id, uint16 index, uint16 typeIndex)
   {
 	  if (createGroup(basePath)) return false;
@@ -551,7 +771,7 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 	  CHECK_ERROR(setAttributeStr("openephys:<metadata>/", basePath, "schema_id"));
 	  int nMetaData = info->getEventMetaDataCount();
 
-	  timeSeries->metaDataSet.clear(); //just in case
+	  timeSeries->stagedMetaData.clear(); //just in case
 	  for (int i = 0; i < nMetaData; i++)
 	  {
 		  const MetaDataDescriptor* desc = info->getEventMetaDataDescriptor(i);
@@ -562,27 +782,31 @@ bool NWBFile::startNewRecording(int recordingNumber, const Array<ContinuousGroup
 		  BaseDataType type = getMetaDataH5Type(desc->getType(), desc->getLength()); //only string types use length, for others is always set to 1. If array types are implemented, change this
 		  int length = desc->getType() == MetaDataDescriptor::CHAR ? 1 : desc->getLength(); //strings are a single element of length set in the type (see above) while other elements are saved as arrays
 		  String fullPath = basePath + "/" + fieldName;
-		  HDF5RecordingData* dSet = createDataSet(type, 0, length, EVENT_CHUNK_SIZE, fullPath);
-		  if (!dSet) return false;
-		  timeSeries->metaDataSet.add(dSet);
+		  StagedDataSet* staged = addStagedDataSet(timeSeries, fullPath, type, 2, length);
+		  timeSeries->stagedMetaData.add(staged);
 
-		  CHECK_ERROR(setAttributeStr("openephys:<metadata>/", fullPath, "schema_id"));
-		  CHECK_ERROR(setAttributeStr(name, fullPath, "name"));
-		  CHECK_ERROR(setAttributeStr(description, fullPath, "description"));
-		  CHECK_ERROR(setAttributeStr(identifier, fullPath, "identifier"));
+		  staged->textAttributes.set("schema_id", "openephys:<metadata>/");
+		  staged->textAttributes.set("name", name);
+		  staged->textAttributes.set("description", description);
+		  staged->textAttributes.set("identifier", identifier);
 	  }
       return true;
   }
 
-  void NWBFile::writeEventMetaData(TimeSeries* timeSeries, const MetaDataEventObject* info, const MetaDataEvent* event)
+  StagedDataSet* NWBFile::addStagedDataSet(TimeSeries* timeSeries, String path, HDF5FileBase::BaseDataType type, int dimension, int sizeY, int sizeZ)
+  {
+	  return timeSeries->stagedDataSets.add(new StagedDataSet(path, type, dimension, sizeY, sizeZ));
+  }
+
+  void NWBFile::stageEventMetaData(TimeSeries* timeSeries, const MetaDataEventObject* info, const MetaDataEvent* event)
   {
-	  jassert(timeSeries->metaDataSet.size() == event->getMetadataValueCount());
+	  jassert(timeSeries->stagedMetaData.size() == event->getMetadataValueCount());
 	  jassert(info->getEventMetaDataCount() == event->getMetadataValueCount());
 	  int nMetaData = event->getMetadataValueCount();
 	  for (int i = 0; i < nMetaData; i++)
 	  {
-		  BaseDataType type = getMetaDataH5Type(info->getEventMetaDataDescriptor(i)->getType(), info->getEventMetaDataDescriptor(i)->getLength());
-		  timeSeries->metaDataSet[i]->writeDataBlock(1, type, event->getMetaDataValue(i)->getRawValuePointer());
+		  StagedDataSet* staged = timeSeries->stagedMetaData[i];
+		  memcpy(staged->appendRow(), event->getMetaDataValue(i)->getRawValuePointer(), staged->rowSize);
 	  }
 
   }
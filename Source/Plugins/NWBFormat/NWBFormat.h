@@ -31,16 +31,52 @@ using namespace OpenEphysHDF5;
 namespace NWBRecording
 {
 	typedef Array<const DataChannel*> ContinuousGroup;
+
+	/** Rows of an event or spike dataset kept in memory until they are appended as a block.
+	The HDF5 dataset is only created on the first flush, when the rate of the rows is known,
+	so the attributes that go on it are stored here until then. */
+	class StagedDataSet
+	{
+	public:
+		StagedDataSet(const String& path, HDF5FileBase::BaseDataType type, int dimension, int sizeY = 1, int sizeZ = 1);
+		/** Returns space for a new row of rowSize bytes */
+		void* appendRow();
+
+		const String path;
+		const HDF5FileBase::BaseDataType type;
+		const int dimension;
+		const int sizeY;
+		const int sizeZ;
+		const size_t rowSize;
+
+		MemoryBlock rows;
+		int numRows{ 0 };
+		bool compressed{ false }; //see HDF5FileBase::setCompression
+		ScopedPointer<HDF5RecordingData> dataSet;
+
+		StringPairArray textAttributes;
+		NamedValueSet numericAttributes; //ints are written as I32, doubles as F32
+	};
+
 	class TimeSeries
 	{
 	public:
 		ScopedPointer<HDF5RecordingData> baseDataSet;
 		ScopedPointer<HDF5RecordingData> timestampDataSet;
 		ScopedPointer<HDF5RecordingData> controlDataSet; //for all but spikes
-		ScopedPointer<HDF5RecordingData> ttlWordDataSet; //just for ttl events
-		OwnedArray<HDF5RecordingData> metaDataSet;
 		String basePath;
 		uint64 numSamples{ 0 };
+		double sampleRate{ 0 }; //only used by continuous series with compact timestamps
+
+		//Event and spike series are staged instead, see NWBFile::flushTimeSeries
+		OwnedArray<StagedDataSet> stagedDataSets;
+		StagedDataSet* stagedData{ nullptr };
+		StagedDataSet* stagedTimestamps{ nullptr };
+		StagedDataSet* stagedControl{ nullptr }; //for all but spikes
+		StagedDataSet* stagedTTLWord{ nullptr }; //just for ttl events
+		Array<StagedDataSet*> stagedMetaData;
+		int numStagedRows{ 0 };
+		uint32 firstStagedTime{ 0 };
 	};
 
 	class NWBFile : public HDF5FileBase
@@ -53,11 +89,23 @@ namespace NWBRecording
 		void stopRecording();
 		void writeData(int datasetID, int channel, int nSamples, const float* data, float bitVolts);
 		void writeTimestamps(int datasetID, int nSamples, const double* data);
+		/** With compact timestamps, records that the sample at sampleIndex has the given timestamp, in source samples.
+		The first call for a dataset (sampleIndex 0) also writes its starting_time */
+		void writeTimestampDiscontinuity(int datasetID, uint64 sampleIndex, int64 timestamp);
 		void writeSpike(int electrodeId, const SpikeChannel* channel, const SpikeEvent* event);
 		void writeEvent(int eventID, const EventChannel* channel, const Event* event);
+		/** Stages a row per changed bit, as writeEvent would for their TTL events */
+		void writeTTLWordChange(int eventID, const EventChannel* channel, const TTLWordChange& change);
 		void writeTimestampSyncText(uint16 sourceID, int64 timestamp, float sourceSampleRate, String text);
+		/** Appends the staged events and spikes that have waited longer than the flush interval */
+		void flushStaleEvents();
+		/** Appends all staged events and spikes */
+		void flushEvents();
 		String getFileName() override;
 		void setXmlText(const String& xmlText);
+		/** Continuous series store starting_time, rate and a discontinuity table instead of
+		one timestamp per sample. Must be set before startNewRecording */
+		void setCompactTimestamps(bool compact);
 
 	protected:
 		int createFileStructure() override;
@@ -72,11 +120,17 @@ namespace NWBRecording
 		bool createTimeSeriesBase(String basePath, String source, String helpText, String description, StringArray ancestry);
 		bool createExtraInfo(String basePath, String name, String desc, String id, uint16 index, uint16 typeIndex);
 		HDF5RecordingData* createTimestampDataSet(String basePath, int chunk_size);
+		HDF5RecordingData* createDiscontinuityDataSet(String basePath);
 		void createDataAttributes(String basePath, float conversion, float resolution, String unit);
 		bool createChannelMetaDataSets(String basePath, const MetaDataInfoObject* info);
 		bool createEventMetaDataSets(String basePath, TimeSeries* timeSeries, const MetaDataEventObject* info);
 
-		void writeEventMetaData(TimeSeries* timeSeries, const MetaDataEventObject* info, const MetaDataEvent* event);
+		StagedDataSet* addStagedDataSet(TimeSeries* timeSeries, String path, HDF5FileBase::BaseDataType type, int dimension, int sizeY = 1, int sizeZ = 1);
+		void stageTimestamp(TimeSeries* timeSeries, double timestampSec);
+		void stageEventMetaData(TimeSeries* timeSeries, const MetaDataEventObject* info, const MetaDataEvent* event);
+		void finishStagedRow(TimeSeries* timeSeries);
+		void flushTimeSeries(TimeSeries* timeSeries, bool createIfEmpty = false);
+		bool createStagedDataSet(StagedDataSet* staged, int chunkRows);
 		
 
 		const String filename;
@@ -93,6 +147,8 @@ namespace NWBRecording
 		HeapBlock<float> scaledBuffer;
 		HeapBlock<int16> intBuffer;
 		size_t bufferSize;
+		uint32 recordingStartTime;
+		bool compactTimestamps;
 
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NWBFile);
 
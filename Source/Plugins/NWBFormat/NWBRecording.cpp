@@ -49,6 +49,10 @@
 	 
 	 recordFile = new NWBFile(basepath, CoreServices::getGUIVersion(), identifierText);
 	 recordFile->setXmlText(getLatestSettingsXml());
+	 recordFile->setCompactTimestamps(compactTimestamps);
+	 if (compressionLevel > 0)
+		 compressionPool = new ThreadPool(compressionThreads);
+	 recordFile->setCompression(compressionLevel, compressionPool);
 
 	 int recProcs = getNumRecordedProcessors();
 
@@ -94,6 +98,8 @@
 		 }
 		 lastId = continuousChannels.size();
 	 }
+	 nextTimestamps.insertMultiple(0, 0, continuousChannels.size());
+	 writtenSamples.insertMultiple(0, 0, continuousChannels.size());
 	 int nEvents = getNumRecordedEvents();
 	 for (int i = 0; i < nEvents; i++)
 		 eventChannels.add(getEventChannel(i));
@@ -114,9 +120,11 @@
  void NWBRecordEngine::closeFiles()
  {
 	 //Called when acquisition stops. Should close the files and leave the processor in a reset status
+	 //stopRecording flushes the staged events and spikes before the file is closed
 	 recordFile->stopRecording();
 	 recordFile->close();
 	 recordFile = nullptr;
+	 compressionPool = nullptr;
 	 resetChannels();
  }
 
@@ -129,6 +137,8 @@
 	 continuousChannels.clear();
 	 datasetIndexes.clear();
 	 writeChannelIndexes.clear();
+	 nextTimestamps.clear();
+	 writtenSamples.clear();
 	 tsBuffer.malloc(MAX_BUFFER_SIZE);
 	 bufferSize = MAX_BUFFER_SIZE;
  }
@@ -141,7 +151,18 @@
 	 /* All channels in a dataset have the same number of samples and share timestamps. But since this method is called 
 		asynchronously, the timestamps might not be in sync during acquisition, so we chose a channel and write the
 		timestamps when writing that channel's data */
-	 if (writeChannelIndexes[writeChannel] == 0)
+	 if (writeChannelIndexes[writeChannel] == 0 && compactTimestamps)
+	 {
+		 //The rate is implicit, so only blocks that don't start where the previous one ended are written
+		 int datasetIndex = datasetIndexes[writeChannel];
+		 int64 baseTS = getTimestamp(writeChannel);
+		 uint64 written = writtenSamples[datasetIndex];
+		 if (written == 0 || baseTS != nextTimestamps[datasetIndex])
+			 recordFile->writeTimestampDiscontinuity(datasetIndex, written, baseTS);
+		 nextTimestamps.set(datasetIndex, baseTS + size);
+		 writtenSamples.set(datasetIndex, written + size);
+	 }
+	 else if (writeChannelIndexes[writeChannel] == 0)
 	 {
 		 int64 baseTS = getTimestamp(writeChannel);
 		 double fs = getDataChannel(realChannel)->getSampleRate();
@@ -154,7 +175,13 @@
 	 }
 		 
  }
- 
+
+void NWBRecordEngine::endChannelBlock(bool lastBlock)
+{
+	//events and spikes are staged in memory, this appends the ones waiting for too long
+	recordFile->flushStaleEvents();
+}
+
 void NWBRecordEngine::writeEvent(int eventIndex, const MidiMessage& event) 
 {
 	const EventChannel* channel = getEventChannel(eventIndex);
@@ -163,6 +190,11 @@ void NWBRecordEngine::writeEvent(int eventIndex, const MidiMessage& event)
 	recordFile->writeEvent(eventIndex, channel, eventStruct);
 }
 
+void NWBRecordEngine::writeTTLWordChange(int eventIndex, const TTLWordChange& change)
+{
+	recordFile->writeTTLWordChange(eventIndex, getEventChannel(eventIndex), change);
+}
+
 void NWBRecordEngine::writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text)
 {
 	recordFile->writeTimestampSyncText(sourceID, timestamp, sourceSampleRate, text);
@@ -186,6 +218,12 @@ RecordEngineManager* NWBRecordEngine::getEngineManager()
 	EngineParameter* param;
 	param = new EngineParameter(EngineParameter::STR, 0, "Identifier Text", String::empty);
 	man->addParameter(param);
+	param = new EngineParameter(EngineParameter::BOOL, 1, "Compact timestamps", false);
+	man->addParameter(param);
+	param = new EngineParameter(EngineParameter::INT, 2, "Compression level", 0, 0, 9);
+	man->addParameter(param);
+	param = new EngineParameter(EngineParameter::INT, 3, "Compression threads", jlimit(1, 8, SystemStats::getNumCpus() / 2), 1, 32);
+	man->addParameter(param);
 	return man;
 	
 }
@@ -193,4 +231,7 @@ RecordEngineManager* NWBRecordEngine::getEngineManager()
 void NWBRecordEngine::setParameter(EngineParameter& parameter)
 {
 	strParameter(0, identifierText);
+	boolParameter(1, compactTimestamps);
+	intParameter(2, compressionLevel);
+	intParameter(3, compressionThreads);
 }
\ No newline at end of file
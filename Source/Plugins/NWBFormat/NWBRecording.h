@@ -38,7 +38,9 @@
 			void openFiles(File rootFolder, int experimentNumber, int recordingNumber) override;
 			void closeFiles() override;
 			void writeData(int writeChannel, int realChannel, const float* buffer, int size) override;
+			void endChannelBlock(bool lastBlock) override;
 			void writeEvent(int eventIndex, const MidiMessage& event) override;
+			void writeTTLWordChange(int eventIndex, const TTLWordChange& change) override;
 			void addSpikeElectrode(int index,const  SpikeChannel* elec) override;
 			void writeSpike(int electrodeIndex, const SpikeEvent* spike) override;
 			void writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text) override;
@@ -48,6 +50,8 @@
 			static RecordEngineManager* getEngineManager();
 			
 		private:
+			//declared before the file so it outlives the datasets waiting for their chunks
+			ScopedPointer<ThreadPool> compressionPool;
 			ScopedPointer<NWBFile> recordFile;
 			Array<int> datasetIndexes;
 			Array<int> writeChannelIndexes;
@@ -59,7 +63,14 @@
 			HeapBlock<double> tsBuffer;
 			size_t bufferSize;
 
+			//per dataset, for compact timestamps
+			Array<int64> nextTimestamps;
+			Array<uint64> writtenSamples;
+
 			String identifierText;
+			bool compactTimestamps{ false };
+			int compressionLevel{ 0 };
+			int compressionThreads{ 2 };
 			
 			JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NWBRecordEngine);
 
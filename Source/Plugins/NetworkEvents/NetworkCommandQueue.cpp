@@ -0,0 +1,222 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkCommandQueue.h"
+
+
+static bool tokenEquals (const char* token, int length, const char* name)
+{
+    for (int i = 0; i < length; ++i)
+    {
+        if (name[i] == 0 || CharacterFunctions::toLowerCase ((juce_wchar) token[i])
+                            != CharacterFunctions::toLowerCase ((juce_wchar) name[i]))
+            return false;
+    }
+
+    return name[length] == 0;
+}
+
+
+void NetworkCommand::parse (const void* data, int size, int64 timestamp)
+{
+    static const struct { const char* name; Type type; } commandNames[] =
+    {
+        { "StartAcquisition",    START_ACQUISITION },
+        { "StopAcquisition",     STOP_ACQUISITION },
+        { "StartRecord",         START_RECORD },
+        { "StopRecord",          STOP_RECORD },
+        { "IsAcquiring",         IS_ACQUIRING },
+        { "IsRecording",         IS_RECORDING },
+        { "GetRecordingPath",    GET_RECORDING_PATH },
+        { "GetRecordingNumber",  GET_RECORDING_NUMBER },
+        { "GetExperimentNumber", GET_EXPERIMENT_NUMBER }
+    };
+
+    softwareTimestamp = timestamp;
+    truncated = size > maxLength;
+    length = jlimit (0, (int) maxLength, size);
+    memcpy (text, data, length);
+    text[length] = 0;
+
+    numTokens = 0;
+    int i = 0;
+    while (i < length && numTokens < maxTokens)
+    {
+        while (i < length && text[i] == ' ')
+            ++i;
+
+        const int start = i;
+        while (i < length && text[i] != ' ')
+            ++i;
+
+        if (i > start)
+        {
+            tokenStart[numTokens]  = (uint16) start;
+            tokenLength[numTokens] = (uint16) (i - start);
+            ++numTokens;
+        }
+    }
+
+    type = UNKNOWN;
+    if (numTokens > 0)
+    {
+        for (int c = 0; c < numElementsInArray (commandNames); ++c)
+        {
+            if (tokenEquals (text + tokenStart[0], tokenLength[0], commandNames[c].name))
+            {
+                type = commandNames[c].type;
+                break;
+            }
+        }
+    }
+}
+
+
+String NetworkCommand::getText() const
+{
+    return String::fromUTF8 (text, length);
+}
+
+
+String NetworkCommand::getToken (int index) const
+{
+    if (index < 0 || index >= numTokens)
+        return String::empty;
+
+    return String::fromUTF8 (text + tokenStart[index], tokenLength[index]);
+}
+
+
+String NetworkCommand::getTextAfterToken (int index) const
+{
+    if (index < 0 || index >= numTokens)
+        return String::empty;
+
+    const int start = tokenStart[index] + tokenLength[index];
+    return String::fromUTF8 (text + start, length - start);
+}
+
+
+/*********************************************/
+NetworkCommandQueue::NetworkCommandQueue (int capacity)
+    : mask (nextPowerOfTwo (jmax (2, capacity)) - 1)
+{
+    sequences.calloc (mask + 1);
+    commands.malloc (mask + 1);
+
+    for (int i = 0; i <= mask; ++i)
+        sequences[i].set ((uint32) i);
+}
+
+
+NetworkCommandQueue::~NetworkCommandQueue()
+{
+}
+
+
+bool NetworkCommandQueue::push (const NetworkCommand& command)
+{
+    uint32 position = enqueuePosition.get();
+
+    // Claim a slot: it is free when its sequence equals the position we want to write
+    for (;;)
+    {
+        const int difference = (int) (sequences[position & mask].get() - position);
+
+        if (difference == 0)
+        {
+            if (enqueuePosition.compareAndSetBool (position + 1, position))
+                break;
+        }
+        else if (difference < 0)
+        {
+            ++numDropped;
+            return false;
+        }
+
+        position = enqueuePosition.get();
+    }
+
+    commands[position & mask] = command;
+    Atomic<uint32>::memoryBarrier();
+    sequences[position & mask].set (position + 1);
+
+    const int depth = (int) (position + 1 - dequeuePosition.get());
+    for (int highest = highWaterMark.get(); depth > highest; highest = highWaterMark.get())
+    {
+        if (highWaterMark.compareAndSetBool (depth, highest))
+            break;
+    }
+
+    return true;
+}
+
+
+bool NetworkCommandQueue::pop (NetworkCommand& command)
+{
+    const uint32 position = dequeuePosition.get();
+    Atomic<uint32>& sequence = sequences[position & mask];
+
+    if ((int) (sequence.get() - (position + 1)) < 0)
+        return false;
+
+    command = commands[position & mask];
+    Atomic<uint32>::memoryBarrier();
+
+    // Hand the slot back to the producers for the next lap around the ring
+    sequence.set (position + (uint32) mask + 1);
+    dequeuePosition.set (position + 1);
+
+    return true;
+}
+
+
+int NetworkCommandQueue::getCapacity() const
+{
+    return mask + 1;
+}
+
+
+int NetworkCommandQueue::getNumReady() const
+{
+    return jlimit (0, mask + 1, (int) (enqueuePosition.get() - dequeuePosition.get()));
+}
+
+
+int NetworkCommandQueue::getHighWaterMark() const
+{
+    return highWaterMark.get();
+}
+
+
+int NetworkCommandQueue::getNumDropped() const
+{
+    return numDropped.get();
+}
+
+
+void NetworkCommandQueue::resetCounters()
+{
+    highWaterMark = getNumReady();
+    numDropped = 0;
+}
@@ -0,0 +1,124 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NETWORKCOMMANDQUEUE_H_INCLUDED
+#define NETWORKCOMMANDQUEUE_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+
+/**
+    A network message, already split into space separated tokens and with its
+    command identified. Fixed size, so it can be passed between threads without
+    allocating. Messages longer than maxLength are truncated.
+*/
+struct NetworkCommand
+{
+    enum Type
+    {
+        UNKNOWN = 0,
+        START_ACQUISITION,
+        STOP_ACQUISITION,
+        START_RECORD,
+        STOP_RECORD,
+        IS_ACQUIRING,
+        IS_RECORDING,
+        GET_RECORDING_PATH,
+        GET_RECORDING_NUMBER,
+        GET_EXPERIMENT_NUMBER
+    };
+
+    static const int maxLength = 1024;
+    static const int maxTokens = 32;
+
+    /** Copies and tokenizes a raw message. Called from the thread that received it */
+    void parse (const void* data, int size, int64 timestamp);
+
+    String getText() const;
+    String getToken (int index) const;
+
+    /** Everything after the given token, e.g. the parameters following the command */
+    String getTextAfterToken (int index) const;
+
+    Type type;
+    int64 softwareTimestamp;
+    int length;
+    bool truncated;
+    int numTokens;
+    uint16 tokenStart[maxTokens];
+    uint16 tokenLength[maxTokens];
+    char text[maxLength + 1];
+};
+
+
+/**
+    Bounded lock-free queue of NetworkCommands.
+
+    Any number of threads can push() (the network thread and the simulation
+    helpers); only the audio thread pops. Each slot carries a sequence number
+    that tells producers and the consumer whose turn it is, so neither side
+    ever blocks. When the queue is full the command is dropped and counted.
+
+    @see NetworkEvents
+*/
+class NetworkCommandQueue
+{
+public:
+    /** The capacity is rounded up to a power of two */
+    NetworkCommandQueue (int capacity);
+    ~NetworkCommandQueue();
+
+    /** Copies a command into the queue. Returns false if it was full */
+    bool push (const NetworkCommand& command);
+
+    /** Takes the oldest command out of the queue. Consumer thread only */
+    bool pop (NetworkCommand& command);
+
+    int getCapacity() const;
+
+    /** Commands waiting to be popped */
+    int getNumReady() const;
+
+    /** Largest number of commands waiting at once since the last resetCounters() */
+    int getHighWaterMark() const;
+
+    /** Commands rejected because the queue was full since the last resetCounters() */
+    int getNumDropped() const;
+
+    void resetCounters();
+
+private:
+    HeapBlock<Atomic<uint32>> sequences;
+    HeapBlock<NetworkCommand> commands;
+    const int mask;
+
+    Atomic<uint32> enqueuePosition;
+    Atomic<uint32> dequeuePosition;
+    Atomic<int> highWaterMark;
+    Atomic<int> numDropped;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NetworkCommandQueue);
+};
+
+
+#endif  // NETWORKCOMMANDQUEUE_H_INCLUDED
@@ -27,6 +27,7 @@
 
 
 const int MAX_MESSAGE_LENGTH = 64000;
+const int COMMAND_QUEUE_SIZE = 256;
 
 
 #ifdef WIN32
@@ -163,6 +164,7 @@ NetworkEvents::NetworkEvents()
     , threshold         (200.0)
     , bufferZone        (5.0f)
     , state             (false)
+    , commandQueue      (COMMAND_QUEUE_SIZE)
 {
     setProcessorType (PROCESSOR_TYPE_SOURCE);
 
@@ -212,11 +214,9 @@ bool NetworkEvents::closesocket()
 #ifdef ZEROMQ
     if (threadRunning)
     {
-		lock.enter();
         zmq_close (responder);
         zmq_ctx_destroy (zmqcontext); // this will cause the thread to exit
         zmqcontext = nullptr;
-		lock.exit();
 
 		if (!stopThread(500))
 		{
@@ -234,7 +234,7 @@ bool NetworkEvents::closesocket()
 
 void NetworkEvents::createEventChannels()
 {
-	EventChannel* chan = new EventChannel(EventChannel::TEXT, 1, MAX_MESSAGE_LENGTH, CoreServices::getGlobalSampleRate(), this);
+	EventChannel* chan = new EventChannel(EventChannel::TEXT, 1, NetworkCommand::maxLength, CoreServices::getGlobalSampleRate(), this);
 	chan->setName("Network messages");
 	chan->setDescription("Messages received through the network events module");
 	chan->setIdentifier("external.network.rawData");
@@ -290,10 +290,13 @@ void NetworkEvents::simulateDesignAndTrials ()
         StringTS S = simulation.front();
         if (currenttime > S.timestamp)
         {
+            NetworkCommand command;
+            command.parse (S.str, S.len, S.timestamp);
+
             // handle special messages
-            handleSpecialMessages (S);
+            handleSpecialMessages (command);
 
-            postTimestamppedStringToMidiBuffer (S);
+            commandQueue.push (command);
             //getUIComponent()->getLogWindow()->addLineToLog(S.getString());
             simulation.pop();
         }
@@ -305,11 +308,11 @@ void NetworkEvents::simulateDesignAndTrials ()
 
 }
 
-void NetworkEvents::postTimestamppedStringToMidiBuffer (StringTS s)
+void NetworkEvents::postCommandToEventBuffer (const NetworkCommand& command)
 {
 	MetaDataValueArray md;
-	md.add(new MetaDataValue(MetaDataDescriptor::INT64, 1, &s.timestamp));
-	TextEventPtr event = TextEvent::createTextEvent(messageChannel, CoreServices::getGlobalTimestamp(), String::fromUTF8(reinterpret_cast<const char*>(s.str), s.len), md);
+	md.add(new MetaDataValue(MetaDataDescriptor::INT64, 1, &command.softwareTimestamp));
+	TextEventPtr event = TextEvent::createTextEvent(messageChannel, CoreServices::getGlobalTimestamp(), command.getText(), md);
 	addEvent(messageChannel, event, 0);
 }
 
@@ -369,7 +372,7 @@ void NetworkEvents::simulateSingleTrial()
 }
 
 
-String NetworkEvents::handleSpecialMessages (StringTS msg)
+String NetworkEvents::handleSpecialMessages (const NetworkCommand& command)
 {
     /*
     std::vector<String> input = msg.splitString(' ');
@@ -423,108 +426,92 @@ String NetworkEvents::handleSpecialMessages (StringTS msg)
     */
 
     /** Start/stop data acquisition */
-    String s = msg.getString();
-
-    /** Command is first substring */
-    StringArray inputs = StringArray::fromTokens (s, " ");
-    String cmd = String (inputs[0]);
-
     const MessageManagerLock mmLock;
-    if (cmd.compareIgnoreCase ("StartAcquisition") == 0)
-    {
-        if (! CoreServices::getAcquisitionStatus())
-        {
-            CoreServices::setAcquisitionStatus (true);
-        }
-        return String ("StartedAcquisition");
-    }
-    else if (cmd.compareIgnoreCase ("StopAcquisition") == 0)
-    {
-        if (CoreServices::getAcquisitionStatus())
-        {
-            CoreServices::setAcquisitionStatus (false);
-        }
-        return String ("StoppedAcquisition");
-    }
-    else if (String ("StartRecord").compareIgnoreCase (cmd) == 0)
+    switch (command.type)
     {
-        if (! CoreServices::getRecordingStatus() 
-            && CoreServices::getAcquisitionStatus())
-        {
-            /** First set optional parameters (name/value pairs)*/
-            if (s.contains ("="))
+        case NetworkCommand::START_ACQUISITION:
+            if (! CoreServices::getAcquisitionStatus())
+            {
+                CoreServices::setAcquisitionStatus (true);
+            }
+            return String ("StartedAcquisition");
+
+        case NetworkCommand::STOP_ACQUISITION:
+            if (CoreServices::getAcquisitionStatus())
             {
-                String params = s.substring (cmd.length());
-                StringPairArray dict = parseNetworkMessage (params);
+                CoreServices::setAcquisitionStatus (false);
+            }
+            return String ("StoppedAcquisition");
 
-                StringArray keys = dict.getAllKeys();
-                for (int i = 0; i < keys.size(); ++i)
+        case NetworkCommand::START_RECORD:
+            if (! CoreServices::getRecordingStatus()
+                && CoreServices::getAcquisitionStatus())
+            {
+                /** First set optional parameters (name/value pairs)*/
+                String params = command.getTextAfterToken (0);
+                if (params.contains ("="))
                 {
-                    String key   = keys[i];
-                    String value = dict[key];
+                    StringPairArray dict = parseNetworkMessage (params);
 
-                    if (key.compareIgnoreCase ("CreateNewDir") == 0)
+                    StringArray keys = dict.getAllKeys();
+                    for (int i = 0; i < keys.size(); ++i)
                     {
-                        if (value.compareIgnoreCase ("1") == 0)
+                        String key   = keys[i];
+                        String value = dict[key];
+
+                        if (key.compareIgnoreCase ("CreateNewDir") == 0)
                         {
-                            CoreServices::createNewRecordingDir();
+                            if (value.compareIgnoreCase ("1") == 0)
+                            {
+                                CoreServices::createNewRecordingDir();
+                            }
+                        }
+                        else if (key.compareIgnoreCase ("RecDir") == 0)
+                        {
+                            CoreServices::setRecordingDirectory (value);
+                        }
+                        else if (key.compareIgnoreCase ("PrependText") == 0)
+                        {
+                            CoreServices::setPrependTextToRecordingDir (value);
+                        }
+                        else if (key.compareIgnoreCase ("AppendText") == 0)
+                        {
+                            CoreServices::setAppendTextToRecordingDir (value);
                         }
-                    }
-                    else if (key.compareIgnoreCase ("RecDir") == 0)
-                    {
-                        CoreServices::setRecordingDirectory (value);
-                    }
-                    else if (key.compareIgnoreCase ("PrependText") == 0)
-                    {
-                        CoreServices::setPrependTextToRecordingDir (value);
-                    }
-                    else if (key.compareIgnoreCase ("AppendText") == 0)
-                    {
-                        CoreServices::setAppendTextToRecordingDir (value);
                     }
                 }
+
+                /** Start recording */
+                CoreServices::setRecordingStatus (true);
+                return String ("StartedRecording");
             }
+            break;
 
-            /** Start recording */
-            CoreServices::setRecordingStatus (true);
-            return String ("StartedRecording");
-        }
-    }
-    else if (String ("StopRecord").compareIgnoreCase (cmd) == 0)
-    {
-        if (CoreServices::getRecordingStatus())
-        {
-            CoreServices::setRecordingStatus (false);
-            return String ("StoppedRecording");
-        }
-    }
-    else if (cmd.compareIgnoreCase ("IsAcquiring") == 0)
-    {
-        String status = CoreServices::getAcquisitionStatus() ? String ("1") : String ("0");
-        return status;
-    }
-    else if (cmd.compareIgnoreCase ("IsRecording") == 0)
-    {
-        String status = CoreServices::getRecordingStatus() ? String ("1") : String ("0");
-        return status;
-    }
-    else if (cmd.compareIgnoreCase ("GetRecordingPath") == 0)
-    {
-        File file = CoreServices::RecordNode::getRecordingPath();
-        String msg (file.getFullPathName());
-        return msg;
-    }
-    else if (cmd.compareIgnoreCase ("GetRecordingNumber") == 0)
-    {
-        String status;
-        status += (CoreServices::RecordNode::getRecordingNumber() + 1);
-        return status;
-    }
-    else if (cmd.compareIgnoreCase ("GetExperimentNumber") == 0)
-    {
-        String status;
-        status += CoreServices::RecordNode::getExperimentNumber();
-        return status;
+        case NetworkCommand::STOP_RECORD:
+            if (CoreServices::getRecordingStatus())
+            {
+                CoreServices::setRecordingStatus (false);
+                return String ("StoppedRecording");
+            }
+            break;
+
+        case NetworkCommand::IS_ACQUIRING:
+            return CoreServices::getAcquisitionStatus() ? String ("1") : String ("0");
+
+        case NetworkCommand::IS_RECORDING:
+            return CoreServices::getRecordingStatus() ? String ("1") : String ("0");
+
+        case NetworkCommand::GET_RECORDING_PATH:
+            return CoreServices::RecordNode::getRecordingPath().getFullPathName();
+
+        case NetworkCommand::GET_RECORDING_NUMBER:
+            return String (CoreServices::RecordNode::getRecordingNumber() + 1);
+
+        case NetworkCommand::GET_EXPERIMENT_NUMBER:
+            return String (CoreServices::RecordNode::getExperimentNumber());
+
+        default:
+            break;
     }
 
     return String ("NotHandled");
@@ -535,16 +522,33 @@ void NetworkEvents::process (AudioSampleBuffer& buffer)
 {
     setTimestampAndSamples(CoreServices::getGlobalTimestamp(),0);
 
-    lock.enter();
-    while (! networkMessagesQueue.empty())
-    {
-        StringTS msg = networkMessagesQueue.front();
-        postTimestamppedStringToMidiBuffer (msg);
-        CoreServices::sendStatusMessage ( ("Network event received: " + msg.getString()).toRawUTF8());
-        networkMessagesQueue.pop();
-    }
+    // Messages were parsed on the network thread, only the events are created here
+    while (commandQueue.pop (pendingCommand))
+        postCommandToEventBuffer (pendingCommand);
+}
+
+
+int NetworkEvents::getQueueDepth() const
+{
+    return commandQueue.getNumReady();
+}
+
 
-    lock.exit();
+int NetworkEvents::getQueueCapacity() const
+{
+    return commandQueue.getCapacity();
+}
+
+
+int NetworkEvents::getQueueHighWaterMark() const
+{
+    return commandQueue.getHighWaterMark();
+}
+
+
+int NetworkEvents::getNumDroppedMessages() const
+{
+    return commandQueue.getNumDropped();
 }
 
 
@@ -569,6 +573,7 @@ void NetworkEvents::run()
     }
 
     threadRunning = true;
+    commandQueue.resetCounters();
     unsigned char* buffer = new unsigned char[MAX_MESSAGE_LENGTH];
     int result = -1;
 
@@ -581,16 +586,22 @@ void NetworkEvents::run()
         if (result < 0) // will only happen when responder dies.
             break;
 
-        StringTS Msg (buffer, result, timestamp_software);
         if (result > 0)
         {
-            lock.enter();
-            networkMessagesQueue.push (Msg);
-            lock.exit();
+            // zmq_recv reports the full message size even when it had to truncate it
+            receivedCommand.parse (buffer, jmin (result, MAX_MESSAGE_LENGTH - 1), timestamp_software);
+
+            if (receivedCommand.truncated)
+                std::cout << "Network event longer than " << NetworkCommand::maxLength << " bytes, truncated" << std::endl;
+
+            if (commandQueue.push (receivedCommand))
+                CoreServices::sendStatusMessage ("Network event received: " + receivedCommand.getText());
+            else
+                std::cout << "Network event queue full, " << commandQueue.getNumDropped() << " messages dropped" << std::endl;
 
             //std::cout << "Received message!" << std::endl;
             // handle special messages
-            String response = handleSpecialMessages (Msg);
+            String response = handleSpecialMessages (receivedCommand);
 
             zmq_send (responder, response.getCharPointer(), response.length(), 0);
         }
@@ -666,10 +677,8 @@ void NetworkEvents::loadCustomParametersFromXml()
 void NetworkEvents::createZmqContext()
 {
 #ifdef ZEROMQ
-	lock.enter();
     if (zmqcontext == nullptr)
         zmqcontext = zmq_ctx_new(); //<-- this is only available in version 3+
-	lock.exit();
 #endif
 }
 
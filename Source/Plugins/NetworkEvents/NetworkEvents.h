@@ -36,6 +36,7 @@
 #endif
 
 #include <ProcessorHeaders.h>
+#include "NetworkCommandQueue.h"
 
 #include <list>
 #include <queue>
@@ -100,7 +101,7 @@ public:
 
     //int64 getExtrapolatedHardwareTimestamp (int64 softwareTS) const;
 
-    String handleSpecialMessages    (StringTS msg);
+    String handleSpecialMessages    (const NetworkCommand& command);
     std::vector<String> splitString (String S, char sep);
 
     void initSimulation();
@@ -112,9 +113,17 @@ public:
     void opensocket();
     bool closesocket();
 
-    void postTimestamppedStringToMidiBuffer (StringTS s);
+    void postCommandToEventBuffer (const NetworkCommand& command);
     void setNewListeningPort (int port);
 
+    /** Messages received but not yet sent as events */
+    int getQueueDepth() const;
+    int getQueueCapacity() const;
+    int getQueueHighWaterMark() const;
+
+    /** Messages lost because the event queue was full, since the socket was opened */
+    int getNumDroppedMessages() const;
+
     int urlport;
     String socketStatus;
     std::atomic<bool> threadRunning;
@@ -140,10 +149,13 @@ private:
 
     Time timer;
 
-    std::queue<StringTS> networkMessagesQueue;
+    /** Filled by the network thread, drained by process() */
+    NetworkCommandQueue commandQueue;
+    NetworkCommand receivedCommand;
+    NetworkCommand pendingCommand;
+
     std::queue<StringTS> simulation;
 
-    CriticalSection lock;
     int64 simulationStartTime;
 
 	const EventChannel* messageChannel{ nullptr };
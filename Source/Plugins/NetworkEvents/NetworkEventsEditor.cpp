@@ -27,7 +27,8 @@
 #include <stdio.h>
 
 NetworkEventsEditor::NetworkEventsEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
-    : GenericEditor(parentNode, useDefaultParameterEditors)
+    : GenericEditor(parentNode, useDefaultParameterEditors),
+      queueMonitor(*this)
 
 {
 	desiredWidth = 180;
@@ -75,6 +76,14 @@ NetworkEventsEditor::NetworkEventsEditor(GenericProcessor* parentNode, bool useD
     labelPort->addListener(this);
     addAndMakeVisible(labelPort);
 
+    queueLabel = new Label("Queue", String::empty);
+    queueLabel->setBounds(20,108,150,16);
+    queueLabel->setFont(Font("Default", 12, Font::plain));
+    queueLabel->setTooltip("Received messages waiting to be sent as events (peak), and messages dropped because the queue was full");
+    addAndMakeVisible(queueLabel);
+    updateQueueLabel();
+    queueMonitor.startTimer(500);
+
     setEnabledState(false);
 
 }
@@ -110,6 +119,13 @@ void NetworkEventsEditor::buttonEvent(Button* button)
 
 }
 
+void NetworkEventsEditor::updateQueueLabel()
+{
+	NetworkEvents *p= (NetworkEvents *)getProcessor();
+	queueLabel->setText("Queue: " + String(p->getQueueDepth()) + "/" + String(p->getQueueCapacity())
+		+ " (" + String(p->getQueueHighWaterMark()) + ") Lost: " + String(p->getNumDroppedMessages()), dontSendNotification);
+}
+
 void NetworkEventsEditor::setLabelColor(juce::Colour color)
 {
 	labelPort->setColour(Label::backgroundColourId, color);
@@ -130,6 +146,7 @@ void NetworkEventsEditor::labelTextChanged(juce::Label *label)
 
 NetworkEventsEditor::~NetworkEventsEditor()
 {
+	queueMonitor.stopTimer();
 
 }
 
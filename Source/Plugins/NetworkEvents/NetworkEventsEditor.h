@@ -47,11 +47,25 @@ public:
     void buttonEvent(Button* button);
 	void labelTextChanged(juce::Label *);
 	void setLabelColor(juce::Colour color);
+
+	/** Shows the event queue statistics */
+	void updateQueueLabel();
 private:
+	/** GenericEditor's own timer drives the fade-in, so the statistics get a separate one */
+	class QueueMonitor : public Timer
+	{
+	public:
+		QueueMonitor(NetworkEventsEditor& e) : editor(e) {}
+		void timerCallback() override { editor.updateQueueLabel(); }
+	private:
+		NetworkEventsEditor& editor;
+	};
 
 	ScopedPointer<UtilityButton> restartConnection;
     ScopedPointer<Label> urlLabel;
 	ScopedPointer<Label> labelPort;
+	ScopedPointer<Label> queueLabel;
+	QueueMonitor queueMonitor;
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NetworkEventsEditor);
@@ -0,0 +1,340 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FrameSender.h"
+
+#ifdef ZEROMQ
+    #include <zmq.h>
+#endif
+
+#ifdef _WIN32
+    #include <Windows.h>
+#elif defined(__APPLE__)
+    #include <mach/mach_time.h>
+#else
+    #include <time.h>
+#endif
+
+static_assert(sizeof(FrameSender::FrameHeader) == 64, "FrameHeader layout changed");
+
+namespace
+{
+    const int conversionChunk = 1024;
+}
+
+FrameSender::FrameSender()
+    : Thread("FrameSender")
+    , fifo(1)
+    , blocksPerFrame(4)
+    , socket(nullptr)
+    , numChannels(0)
+    , sampleRate(0)
+    , int16Samples(false)
+    , frameNumber(0)
+{
+    conversionBuffer.malloc(conversionChunk);
+    setQueueSize(32 << 20);
+}
+
+FrameSender::~FrameSender()
+{
+    stop();
+}
+
+int64 FrameSender::getMonotonicTimeNs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER ticks, frequency;
+    QueryPerformanceCounter(&ticks);
+    QueryPerformanceFrequency(&frequency);
+    return int64(double(ticks.QuadPart) * 1.0e9 / double(frequency.QuadPart));
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return int64(mach_absolute_time() * timebase.numer / timebase.denom);
+#else
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return int64(t.tv_sec) * 1000000000 + t.tv_nsec;
+#endif
+}
+
+void FrameSender::start(void* newSocket, float newSampleRate, const Array<float>& newBitVolts, bool asInt16)
+{
+    jassert(!isThreadRunning());
+    socket = newSocket;
+    sampleRate = newSampleRate;
+    bitVolts = newBitVolts;
+    numChannels = bitVolts.size();
+    int16Samples = asInt16;
+    frameNumber = 0;
+    fifo.reset();
+    startThread();
+}
+
+void FrameSender::stop()
+{
+    if (isThreadRunning())
+    {
+        signalThreadShouldExit();
+        notify();
+        if (!waitForThreadToExit(2000))
+        {
+            std::cout << "Frame sender did not stop, forcing it" << std::endl;
+            stopThread(100);
+        }
+    }
+    socket = nullptr;
+}
+
+void FrameSender::setQueueSize(int bytes)
+{
+    jassert(!isThreadRunning());
+    bytes = jmax(1 << 16, bytes);
+
+    // AbstractFifo keeps one slot free
+    fifo.setTotalSize(bytes + 1);
+    ring.malloc(bytes + 1);
+    resetCounters();
+}
+
+int FrameSender::getQueueSize() const
+{
+    return fifo.getTotalSize() - 1;
+}
+
+void FrameSender::setBlocksPerFrame(int blocks)
+{
+    blocksPerFrame = jmax(1, blocks);
+}
+
+int FrameSender::getBlocksPerFrame() const
+{
+    return blocksPerFrame;
+}
+
+int FrameSender::getBlockSize(int numSamples) const
+{
+    return int(sizeof(BlockHeader)) + numChannels * numSamples * (int16Samples ? int(sizeof(int16)) : int(sizeof(float)));
+}
+
+bool FrameSender::queueBlock(const float* const* channelData, int nSamples, int64 timestamp)
+{
+    const int blockSize = getBlockSize(nSamples);
+    if (fifo.getFreeSpace() < blockSize)
+    {
+        ++numBlocksDropped;
+        return false;
+    }
+
+    BlockHeader header;
+    header.timestamp = timestamp;
+    header.queueTimeNs = getMonotonicTimeNs();
+    header.numSamples = uint32(nSamples);
+    header.reserved = 0;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(blockSize, start1, size1, start2, size2);
+    writeToRing(0, &header, sizeof(header), start1, size1, start2);
+
+    int offset = sizeof(header);
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        if (!int16Samples)
+        {
+            writeToRing(offset, channelData[ch], nSamples * sizeof(float), start1, size1, start2);
+            offset += nSamples * sizeof(float);
+            continue;
+        }
+
+        const float scale = bitVolts[ch] != 0 ? 1.0f / bitVolts[ch] : 1.0f;
+        for (int done = 0; done < nSamples; done += conversionChunk)
+        {
+            const int count = jmin(conversionChunk, nSamples - done);
+            const float* src = channelData[ch] + done;
+            for (int i = 0; i < count; i++)
+                conversionBuffer[i] = int16(jlimit(-32768.0f, 32767.0f, std::round(src[i] * scale)));
+            writeToRing(offset, conversionBuffer, count * sizeof(int16), start1, size1, start2);
+            offset += count * sizeof(int16);
+        }
+    }
+    fifo.finishedWrite(blockSize);
+
+    const int used = fifo.getNumReady();
+    if (used > highWaterMark.get())
+        highWaterMark = used;
+
+    return true;
+}
+
+void FrameSender::flush()
+{
+    notify();
+}
+
+void FrameSender::writeToRing(int offset, const void* data, int size, int start1, int size1, int start2)
+{
+    // offset is relative to the region returned by prepareToWrite, which may wrap around
+    const int first = jlimit(0, size, size1 - offset);
+    memcpy(ring + start1 + offset, data, first);
+    if (size > first)
+        memcpy(ring + start2 + jmax(0, offset - size1), static_cast<const uint8*>(data) + first, size - first);
+}
+
+void FrameSender::copyFromRing(void* dest, int position, int size) const
+{
+    // position is a ring index, possibly past the end
+    const int total = fifo.getTotalSize();
+    position %= total;
+    const int first = jmin(size, total - position);
+    memcpy(dest, ring + position, first);
+    if (size > first)
+        memcpy(static_cast<uint8*>(dest) + first, ring, size - first);
+}
+
+void FrameSender::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(100);
+        sendQueuedFrames(false);
+    }
+    sendQueuedFrames(true);
+}
+
+void FrameSender::sendQueuedFrames(bool sendPartialFrame)
+{
+    for (;;)
+    {
+        const int ready = fifo.getNumReady();
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(ready, start1, size1, start2, size2);
+
+        // blocks are written whole, so once a header is readable the samples are too
+        blockOffsets.clearQuick();
+        blockHeaders.clearQuick();
+        int offset = 0;
+        int numSamples = 0;
+        while (blockHeaders.size() < blocksPerFrame && offset + int(sizeof(BlockHeader)) <= ready)
+        {
+            BlockHeader header;
+            copyFromRing(&header, start1 + offset, sizeof(header));
+            blockOffsets.add(offset);
+            blockHeaders.add(header);
+            offset += getBlockSize(header.numSamples);
+            numSamples += header.numSamples;
+        }
+
+        if (blockHeaders.size() == 0 || (blockHeaders.size() < blocksPerFrame && !sendPartialFrame))
+            return;
+
+        sendFrame(start1, blockHeaders.size(), numSamples);
+        fifo.finishedRead(offset);
+    }
+}
+
+void FrameSender::sendFrame(int readStart, int numBlocks, int numSamples)
+{
+    const int sampleSize = int16Samples ? sizeof(int16) : sizeof(float);
+    const size_t frameSize = sizeof(FrameHeader) + numChannels * sizeof(float) + size_t(numChannels) * numSamples * sampleSize;
+
+    FrameHeader header;
+    zerostruct(header);
+    memcpy(header.magic, "OECF", 4);
+    header.version = 1;
+    header.flags = int16Samples ? INT16_SAMPLES : 0;
+    header.numChannels = numChannels;
+    header.numSamples = numSamples;
+    header.frameNumber = frameNumber++;
+    header.firstTimestamp = blockHeaders.getReference(0).timestamp;
+    header.queueTimeNs = blockHeaders.getReference(numBlocks - 1).queueTimeNs;
+    header.sampleRate = sampleRate;
+    header.numBlocks = numBlocks;
+    header.blocksDropped = numBlocksDropped.get();
+
+#ifdef ZEROMQ
+    if (socket == nullptr)
+        return;
+
+    // the frame is gathered straight into the message ZMQ sends
+    zmq_msg_t message;
+    if (zmq_msg_init_size(&message, frameSize) != 0)
+        return;
+    uint8* dest = static_cast<uint8*>(zmq_msg_data(&message));
+
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    memcpy(dest, bitVolts.begin(), numChannels * sizeof(float));
+    dest += numChannels * sizeof(float);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        for (int b = 0; b < numBlocks; b++)
+        {
+            const int blockSamples = blockHeaders.getReference(b).numSamples;
+            const int rowSize = blockSamples * sampleSize;
+            copyFromRing(dest, readStart + blockOffsets[b] + int(sizeof(BlockHeader)) + ch * rowSize, rowSize);
+            dest += rowSize;
+        }
+    }
+
+    if (zmq_msg_send(&message, socket, 0) == -1)
+    {
+        std::cout << "Failed to send frame: " << zmq_strerror(zmq_errno()) << std::endl;
+        zmq_msg_close(&message);
+        return;
+    }
+#endif
+
+    ++numFramesSent;
+    numBytesSent += int64(frameSize);
+}
+
+void FrameSender::resetCounters()
+{
+    numFramesSent = 0;
+    numBytesSent = 0;
+    numBlocksDropped = 0;
+    highWaterMark = 0;
+}
+
+int64 FrameSender::getNumFramesSent() const
+{
+    return numFramesSent.get();
+}
+
+int64 FrameSender::getNumBytesSent() const
+{
+    return numBytesSent.get();
+}
+
+int64 FrameSender::getNumBlocksDropped() const
+{
+    return numBlocksDropped.get();
+}
+
+int FrameSender::getQueueHighWaterMark() const
+{
+    return highWaterMark.get();
+}
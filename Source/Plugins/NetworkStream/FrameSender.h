@@ -0,0 +1,147 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FRAMESENDER_H_INCLUDED
+#define FRAMESENDER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/**
+    Publishes continuous data on a ZMQ socket from its own thread.
+
+    The processing thread copies each block into a lock-free byte ring with
+    queueBlock(), converting to int16 on the way if requested, and never touches
+    the socket. The sender thread gathers blocksPerFrame blocks and publishes them
+    as a single message:
+
+        FrameHeader, bitVolts[numChannels], samples
+
+    Samples are float32 or int16 (flag 1), channel after channel, numSamples each.
+    Everything is little-endian. Blocks that do not fit in the ring are dropped and
+    counted, and frameNumber and firstTimestamp let receivers see the gap. ZMQ PUB
+    sockets also drop frames for subscribers that fall behind the high water mark.
+
+    @see NetworkStream
+*/
+class FrameSender : public Thread
+{
+public:
+    struct FrameHeader
+    {
+        char magic[4];              // "OECF"
+        uint16 version;
+        uint16 flags;
+        uint32 numChannels;
+        uint32 numSamples;
+        uint64 frameNumber;
+        int64 firstTimestamp;
+        int64 queueTimeNs;          // monotonic clock when the last block of the frame was queued
+        float sampleRate;
+        uint32 numBlocks;
+        uint64 blocksDropped;       // since the start of acquisition
+        uint8 reserved[8];
+    };
+
+    enum Flags
+    {
+        INT16_SAMPLES = 1
+    };
+
+    FrameSender();
+    ~FrameSender();
+
+    /** Sets the socket and the stream layout and starts the thread. The socket must not
+    be used by anyone else until stop() is called */
+    void start(void* socket, float sampleRate, const Array<float>& bitVolts, bool asInt16);
+
+    /** Sends what is left in the ring, including a last partial frame, and stops the thread */
+    void stop();
+
+    /** Ring size, in bytes. Clears the ring, so only call while the thread is stopped */
+    void setQueueSize(int bytes);
+    int getQueueSize() const;
+
+    void setBlocksPerFrame(int blocks);
+    int getBlocksPerFrame() const;
+
+    /** Called from the processing thread with one pointer per channel. Returns false if the
+    block was dropped */
+    bool queueBlock(const float* const* channelData, int nSamples, int64 timestamp);
+
+    /** Called from the processing thread at the end of each block to wake the sender */
+    void flush();
+
+    void resetCounters();
+    int64 getNumFramesSent() const;
+    int64 getNumBytesSent() const;
+    int64 getNumBlocksDropped() const;
+
+    /** Highest fill level of the ring since resetCounters(), in bytes */
+    int getQueueHighWaterMark() const;
+
+    /** Same clock as the bundled receiver, comparable between processes on one machine */
+    static int64 getMonotonicTimeNs();
+
+    void run() override;
+
+private:
+    struct BlockHeader
+    {
+        int64 timestamp;
+        int64 queueTimeNs;
+        uint32 numSamples;
+        uint32 reserved;
+    };
+
+    void sendQueuedFrames(bool sendPartialFrame);
+    void sendFrame(int readStart, int numBlocks, int numSamples);
+    void writeToRing(int offset, const void* data, int size, int start1, int size1, int start2);
+    void copyFromRing(void* dest, int position, int size) const;
+    int getBlockSize(int numSamples) const;
+
+    AbstractFifo fifo;
+    HeapBlock<uint8> ring;
+    int blocksPerFrame;
+    void* socket;
+
+    // stream layout, fixed between start() and stop()
+    int numChannels;
+    float sampleRate;
+    Array<float> bitVolts;
+    bool int16Samples;
+    HeapBlock<int16> conversionBuffer;
+
+    // sender thread state for the frame being gathered
+    Array<int> blockOffsets;
+    Array<BlockHeader> blockHeaders;
+    uint64 frameNumber;
+
+    Atomic<int64> numFramesSent;
+    Atomic<int64> numBytesSent;
+    Atomic<int64> numBlocksDropped;
+    Atomic<int> highWaterMark;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameSender);
+};
+
+#endif  // FRAMESENDER_H_INCLUDED
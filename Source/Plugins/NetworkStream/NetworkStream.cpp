@@ -0,0 +1,238 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkStream.h"
+#include "NetworkStreamEditor.h"
+
+#ifdef ZEROMQ
+    #include <zmq.h>
+#endif
+
+NetworkStream::NetworkStream()
+    : GenericProcessor  ("Network Stream")
+    , port              (5560)
+    , sendInt16         (false)
+    , sendHighWaterMark (100)
+    , context           (nullptr)
+    , socket            (nullptr)
+{
+    setProcessorType(PROCESSOR_TYPE_SINK);
+
+#ifdef ZEROMQ
+    context = zmq_ctx_new();
+#endif
+}
+
+NetworkStream::~NetworkStream()
+{
+    sender.stop();
+    closeSocket();
+#ifdef ZEROMQ
+    if (context != nullptr)
+        zmq_ctx_destroy(context);
+#endif
+}
+
+AudioProcessorEditor* NetworkStream::createEditor()
+{
+    editor = new NetworkStreamEditor(this);
+    return editor;
+}
+
+void NetworkStream::selectChannels()
+{
+    streamedChannels.clear();
+
+    Array<int> activeChannels = editor->getActiveChannels();
+    const DataChannel* first = nullptr;
+    int skipped = 0;
+    for (int i = 0; i < activeChannels.size(); i++)
+    {
+        const DataChannel* chan = getDataChannel(activeChannels[i]);
+        if (chan == nullptr)
+            continue;
+        if (first == nullptr)
+            first = chan;
+        // a frame carries the same number of samples for every channel
+        if (chan->getSourceNodeID() != first->getSourceNodeID() || chan->getSubProcessorIdx() != first->getSubProcessorIdx())
+        {
+            skipped++;
+            continue;
+        }
+        streamedChannels.add(activeChannels[i]);
+    }
+
+    if (skipped > 0)
+        CoreServices::sendStatusMessage("Network stream: " + String(skipped) + " channels from other subprocessors are not sent");
+}
+
+void NetworkStream::closeSocket()
+{
+#ifdef ZEROMQ
+    if (socket != nullptr)
+        zmq_close(socket);
+#endif
+    socket = nullptr;
+}
+
+bool NetworkStream::enable()
+{
+    sender.resetCounters();
+    selectChannels();
+    if (streamedChannels.size() == 0)
+        return true;
+
+#ifdef ZEROMQ
+    socket = zmq_socket(context, ZMQ_PUB);
+    if (socket == nullptr)
+    {
+        CoreServices::sendStatusMessage(String("Network stream: failed to create socket: ") + zmq_strerror(zmq_errno()));
+        streamedChannels.clear();
+        return true;
+    }
+
+    // frames still queued when acquisition stops are not worth waiting for
+    int linger = 0;
+    zmq_setsockopt(socket, ZMQ_SNDHWM, &sendHighWaterMark, sizeof(sendHighWaterMark));
+    zmq_setsockopt(socket, ZMQ_LINGER, &linger, sizeof(linger));
+
+    String endpoint = "tcp://*:" + String(port);
+    if (zmq_bind(socket, endpoint.toRawUTF8()) != 0)
+    {
+        CoreServices::sendStatusMessage("Network stream: could not bind " + endpoint + ": " + zmq_strerror(zmq_errno()));
+        closeSocket();
+        streamedChannels.clear();
+        return true;
+    }
+#endif
+
+    Array<float> bitVolts;
+    for (int i = 0; i < streamedChannels.size(); i++)
+        bitVolts.add(getDataChannel(streamedChannels[i])->getBitVolts());
+
+    channelPointers.malloc(streamedChannels.size());
+    sender.start(socket, getDataChannel(streamedChannels[0])->getSampleRate(), bitVolts, sendInt16);
+    return true;
+}
+
+bool NetworkStream::disable()
+{
+    // sends the last partial frame before the socket goes away
+    sender.stop();
+    closeSocket();
+    return true;
+}
+
+void NetworkStream::process(AudioSampleBuffer& continuousBuffer)
+{
+    int numChannels = streamedChannels.size();
+    if (numChannels == 0)
+        return;
+
+    int nSamples = getNumSamples(streamedChannels[0]);
+    if (nSamples <= 0)
+        return;
+
+    for (int i = 0; i < numChannels; i++)
+        channelPointers[i] = continuousBuffer.getReadPointer(streamedChannels[i]);
+    sender.queueBlock(channelPointers, nSamples, getTimestamp(streamedChannels[0]));
+    sender.flush();
+}
+
+int NetworkStream::getPort() const
+{
+    return port;
+}
+
+void NetworkStream::setPort(int newPort)
+{
+    if (newPort > 0 && newPort < 65536)
+        port = newPort;
+}
+
+int NetworkStream::getBlocksPerFrame() const
+{
+    return sender.getBlocksPerFrame();
+}
+
+void NetworkStream::setBlocksPerFrame(int blocks)
+{
+    sender.setBlocksPerFrame(jlimit(1, 1000, blocks));
+}
+
+bool NetworkStream::getSendInt16() const
+{
+    return sendInt16;
+}
+
+void NetworkStream::setSendInt16(bool int16)
+{
+    sendInt16 = int16;
+}
+
+int NetworkStream::getQueueSize() const
+{
+    return sender.getQueueSize();
+}
+
+void NetworkStream::setQueueSize(int bytes)
+{
+    if (!sender.isThreadRunning())
+        sender.setQueueSize(bytes);
+}
+
+int NetworkStream::getNumStreamedChannels() const
+{
+    return streamedChannels.size();
+}
+
+const FrameSender& NetworkStream::getSender() const
+{
+    return sender;
+}
+
+void NetworkStream::saveCustomParametersToXml(XmlElement* parentElement)
+{
+    XmlElement* mainNode = parentElement->createNewChildElement("NETWORKSTREAM");
+    mainNode->setAttribute("port", port);
+    mainNode->setAttribute("blocks_per_frame", getBlocksPerFrame());
+    mainNode->setAttribute("int16", sendInt16);
+    mainNode->setAttribute("queue_size", getQueueSize());
+    mainNode->setAttribute("send_hwm", sendHighWaterMark);
+}
+
+void NetworkStream::loadCustomParametersFromXml()
+{
+    if (parametersAsXml)
+    {
+        forEachXmlChildElementWithTagName(*parametersAsXml, mainNode, "NETWORKSTREAM")
+        {
+            setPort(mainNode->getIntAttribute("port", port));
+            setBlocksPerFrame(mainNode->getIntAttribute("blocks_per_frame", getBlocksPerFrame()));
+            setSendInt16(mainNode->getBoolAttribute("int16", sendInt16));
+            setQueueSize(mainNode->getIntAttribute("queue_size", getQueueSize()));
+            sendHighWaterMark = jmax(1, mainNode->getIntAttribute("send_hwm", sendHighWaterMark));
+            static_cast<NetworkStreamEditor*>(getEditor())->updateLabels();
+        }
+    }
+}
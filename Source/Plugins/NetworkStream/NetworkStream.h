@@ -0,0 +1,96 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NETWORKSTREAM_H_INCLUDED
+#define NETWORKSTREAM_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include "FrameSender.h"
+
+/**
+    Streams the selected continuous channels over a ZMQ PUB socket, several blocks per
+    message, for clients on other machines. The frame layout is described in FrameSender
+    and Resources/Python/network_stream_receiver.py is a receiver that reports throughput
+    and latency.
+
+    Channels are those selected in the editor's channel selector. They all have to come
+    from the same subprocessor; the ones that do not are left out.
+
+    @see FrameSender
+*/
+class NetworkStream : public GenericProcessor
+{
+public:
+    NetworkStream();
+    ~NetworkStream();
+
+    AudioProcessorEditor* createEditor() override;
+
+    void process(AudioSampleBuffer& continuousBuffer) override;
+
+    bool enable() override;
+    bool disable() override;
+
+    void saveCustomParametersToXml(XmlElement* parentElement) override;
+    void loadCustomParametersFromXml() override;
+
+    /** Port the socket binds to on all interfaces. Applies on the next start */
+    int getPort() const;
+    void setPort(int port);
+
+    /** Number of processing blocks sent as one message */
+    int getBlocksPerFrame() const;
+    void setBlocksPerFrame(int blocks);
+
+    /** Sends samples as int16 in units of each channel's bitVolts instead of float32 */
+    bool getSendInt16() const;
+    void setSendInt16(bool int16);
+
+    /** Size of the ring between the processing and sender threads, in bytes */
+    int getQueueSize() const;
+    void setQueueSize(int bytes);
+
+    int getNumStreamedChannels() const;
+    const FrameSender& getSender() const;
+
+private:
+    /** Picks the selected channels from the first selected channel's subprocessor */
+    void selectChannels();
+    void closeSocket();
+
+    int port;
+    bool sendInt16;
+    int sendHighWaterMark;
+
+    void* context;
+    void* socket;
+
+    Array<int> streamedChannels;
+    HeapBlock<const float*> channelPointers;
+
+    FrameSender sender;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NetworkStream);
+};
+
+#endif  // NETWORKSTREAM_H_INCLUDED
@@ -0,0 +1,147 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkStreamEditor.h"
+#include "NetworkStream.h"
+
+NetworkStreamEditor::NetworkStreamEditor(NetworkStream* parentNode)
+    : GenericEditor(parentNode, true)
+    , processor(parentNode)
+    , statsMonitor(*this)
+    , lastBytesSent(0)
+    , lastStatsTime(0)
+{
+    desiredWidth = 190;
+
+    portLabel = addLabel("Port", 35);
+    portLabel->setTooltip("TCP port the stream is published on, on all interfaces");
+    blocksLabel = addLabel("Blocks", 57);
+    blocksLabel->setTooltip("Processing blocks sent as one message. More blocks mean fewer, larger messages and more latency");
+
+    int16Button = new UtilityButton("INT16", Font("Small Text", 11, Font::plain));
+    int16Button->setBounds(70, 79, 50, 18);
+    int16Button->setClickingTogglesState(true);
+    int16Button->setTooltip("Send samples as int16 in units of each channel's bitVolts instead of float32");
+    int16Button->addListener(this);
+    addAndMakeVisible(int16Button);
+
+    statsLabel = new Label("Stats", String::empty);
+    statsLabel->setFont(Font("Small Text", 11, Font::plain));
+    statsLabel->setBounds(10, 100, 175, 28);
+    statsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    statsLabel->setJustificationType(Justification::topLeft);
+    statsLabel->setTooltip("Frames published, throughput and blocks dropped because the queue to the sender thread was full");
+    addAndMakeVisible(statsLabel);
+    labels.add(statsLabel);
+
+    updateLabels();
+    updateStatsLabel();
+}
+
+NetworkStreamEditor::~NetworkStreamEditor()
+{
+    statsMonitor.stopTimer();
+}
+
+Label* NetworkStreamEditor::addLabel(const String& name, int y)
+{
+    Label* nameLabel = new Label(name, name);
+    nameLabel->setFont(Font("Small Text", 11, Font::plain));
+    nameLabel->setBounds(10, y, 55, 18);
+    nameLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(nameLabel);
+    labels.add(nameLabel);
+
+    Label* valueLabel = new Label(name + " value", String::empty);
+    valueLabel->setFont(Font("Default", 13, Font::plain));
+    valueLabel->setBounds(70, y, 110, 18);
+    valueLabel->setColour(Label::textColourId, Colours::white);
+    valueLabel->setColour(Label::backgroundColourId, Colours::grey);
+    valueLabel->setEditable(true);
+    valueLabel->addListener(this);
+    addAndMakeVisible(valueLabel);
+    labels.add(valueLabel);
+    return valueLabel;
+}
+
+void NetworkStreamEditor::buttonEvent(Button* button)
+{
+    if (button == int16Button)
+        processor->setSendInt16(int16Button->getToggleState());
+}
+
+void NetworkStreamEditor::labelTextChanged(Label* label)
+{
+    if (label == portLabel)
+        processor->setPort(label->getText().getIntValue());
+    else if (label == blocksLabel)
+        processor->setBlocksPerFrame(label->getText().getIntValue());
+    updateLabels();
+}
+
+void NetworkStreamEditor::updateLabels()
+{
+    portLabel->setText(String(processor->getPort()), dontSendNotification);
+    blocksLabel->setText(String(processor->getBlocksPerFrame()), dontSendNotification);
+    int16Button->setToggleState(processor->getSendInt16(), dontSendNotification);
+}
+
+void NetworkStreamEditor::updateStatsLabel()
+{
+    if (processor->getNumStreamedChannels() == 0)
+    {
+        statsLabel->setText("Not streaming", dontSendNotification);
+        return;
+    }
+
+    const FrameSender& sender = processor->getSender();
+    const int64 bytesSent = sender.getNumBytesSent();
+    const uint32 now = Time::getMillisecondCounter();
+    double rate = 0;
+    if (lastStatsTime != 0 && now > lastStatsTime)
+        rate = double(bytesSent - lastBytesSent) / (now - lastStatsTime) / 1000.0;
+    lastBytesSent = bytesSent;
+    lastStatsTime = now;
+
+    statsLabel->setText("Frames: " + String(sender.getNumFramesSent()) + " (" + String(rate, 2) + " MB/s)\n"
+        + "Dropped blocks: " + String(sender.getNumBlocksDropped()), dontSendNotification);
+}
+
+void NetworkStreamEditor::startAcquisition()
+{
+    portLabel->setEditable(false);
+    blocksLabel->setEditable(false);
+    int16Button->setEnabled(false);
+    lastBytesSent = 0;
+    lastStatsTime = 0;
+    statsMonitor.startTimer(500);
+}
+
+void NetworkStreamEditor::stopAcquisition()
+{
+    statsMonitor.stopTimer();
+    updateStatsLabel();
+    portLabel->setEditable(true);
+    blocksLabel->setEditable(true);
+    int16Button->setEnabled(true);
+}
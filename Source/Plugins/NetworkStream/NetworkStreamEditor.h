@@ -0,0 +1,82 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NETWORKSTREAMEDITOR_H_INCLUDED
+#define NETWORKSTREAMEDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+class NetworkStream;
+
+/**
+    User interface for the Network Stream: port, blocks per frame, sample format and
+    the sender statistics.
+
+    @see NetworkStream
+*/
+class NetworkStreamEditor : public GenericEditor, public Label::Listener
+{
+public:
+    NetworkStreamEditor(NetworkStream* parentNode);
+    ~NetworkStreamEditor();
+
+    void buttonEvent(Button* button) override;
+    void labelTextChanged(Label* label) override;
+
+    void startAcquisition() override;
+    void stopAcquisition() override;
+
+    /** Rewrites the controls from the processor settings */
+    void updateLabels();
+
+    /** Shows frames sent, throughput and dropped blocks */
+    void updateStatsLabel();
+
+private:
+    /** GenericEditor's own timer drives the fade-in, so the statistics get a separate one */
+    class StatsMonitor : public Timer
+    {
+    public:
+        StatsMonitor(NetworkStreamEditor& e) : editor(e) {}
+        void timerCallback() override { editor.updateStatsLabel(); }
+    private:
+        NetworkStreamEditor& editor;
+    };
+
+    Label* addLabel(const String& name, int y);
+
+    NetworkStream* processor;
+    OwnedArray<Label> labels;
+    Label* portLabel;
+    Label* blocksLabel;
+    Label* statsLabel;
+    ScopedPointer<UtilityButton> int16Button;
+    StatsMonitor statsMonitor;
+
+    int64 lastBytesSent;
+    uint32 lastStatsTime;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NetworkStreamEditor);
+};
+
+#endif  // NETWORKSTREAMEDITOR_H_INCLUDED
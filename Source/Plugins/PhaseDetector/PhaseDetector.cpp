@@ -28,10 +28,6 @@
 PhaseDetector::PhaseDetector()
     : GenericProcessor      ("Phase Detector")
     , activeModule          (-1)
-    , risingPos             (false)
-    , risingNeg             (false)
-    , fallingPos            (false)
-    , fallingNeg            (false)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 	lastNumInputs = 0;
@@ -59,13 +55,15 @@ void PhaseDetector::addModule()
     m.outputChan = -1;
     m.gateChan = -1;
     m.isActive = true;
-    m.lastSample = 0.0f;
     m.type = NONE;
-    m.samplesSinceTrigger = 5000;
+    m.samplesUntilOff = 0;
     m.wasTriggered = false;
-    m.phase = NO_PHASE;
+    m.targetPhase = -1.0f;
+    m.lowCut = 4.0f;
+    m.highCut = 8.0f;
 
     modules.add (m);
+    phaseEstimators.add (new PhaseEstimator());
 }
 
 
@@ -105,6 +103,10 @@ void PhaseDetector::setParameter (int parameterIndex, float newValue)
                 module.type = RISING_ZERO;
                 break;
 
+            case 5:
+                module.type = TARGET_PHASE;
+                break;
+
             default:
                 module.type = NONE;
         }
@@ -129,6 +131,18 @@ void PhaseDetector::setParameter (int parameterIndex, float newValue)
             module.isActive = false;
         }
     }
+    else if (parameterIndex == 5)   // target phase, in degrees
+    {
+        module.targetPhase = newValue < 0 ? -1.0f : std::fmod (newValue, 360.0f);
+    }
+    else if (parameterIndex == 6)   // low edge of the band
+    {
+        module.lowCut = newValue;
+    }
+    else if (parameterIndex == 7)   // high edge of the band
+    {
+        module.highCut = newValue;
+    }
 }
 
 //Usually, to be more ordered, we'd create the event channels overriding the createEventChannels() method.
@@ -154,6 +168,11 @@ void PhaseDetector::updateSettings()
 		case FALLING_ZERO: typeDesc = "Zero crossing with negative slope"; identifier += "zero.negative";  break;
 		case TROUGH: typeDesc = "Negative peak"; identifier += "peak.negative"; break;
 		case RISING_ZERO: typeDesc = "Zero crossing with positive slope"; identifier += "zero.positive"; break;
+		case TARGET_PHASE:
+			typeDesc = "Phase " + String(roundToInt(modules[i].targetPhase)) + " deg, "
+				+ String(modules[i].lowCut, 1) + "-" + String(modules[i].highCut, 1) + " Hz";
+			identifier += "target";
+			break;
 		default: typeDesc = "No phase selected"; break;
 		}
 		ev->setIdentifier(identifier);
@@ -182,6 +201,54 @@ void PhaseDetector::updateSettings()
 
 bool PhaseDetector::enable()
 {
+    transitionDetectors.clear();
+    detectorChannels.clear();
+    moduleDetectors.clear();
+
+    for (int m = 0; m < modules.size(); ++m)
+    {
+        DetectorModule& module = modules.getReference (m);
+
+        module.samplesUntilOff = 0;
+        module.wasTriggered = false;
+
+        const DataChannel* in = getDataChannel (module.inputChan);
+        int detector = -1;
+
+        if (in == nullptr)
+        {
+            phaseEstimators[m]->clear();
+        }
+        else if (module.type == TARGET_PHASE)
+        {
+            if (module.lowCut <= 0 || module.highCut <= module.lowCut || module.highCut >= in->getSampleRate() / 2)
+            {
+                CoreServices::sendStatusMessage ("Phase detector " + String (m + 1) + ": invalid band "
+                                                 + String (module.lowCut) + "-" + String (module.highCut) + " Hz");
+                phaseEstimators[m]->clear();
+            }
+            else
+            {
+                phaseEstimators[m]->prepare (in->getSampleRate(), module.lowCut, module.highCut);
+            }
+        }
+        else
+        {
+            detector = detectorChannels.indexOf (module.inputChan);
+
+            if (detector < 0)
+            {
+                detector = detectorChannels.size();
+                detectorChannels.add (module.inputChan);
+                transitionDetectors.add (new TransitionDetector());
+            }
+        }
+
+        moduleDetectors.add (detector);
+    }
+
+    triggers.ensureStorageAllocated (64);
+
     return true;
 }
 
@@ -217,99 +284,91 @@ void PhaseDetector::handleEvent (const EventChannel* channelInfo, const MidiMess
 }
 
 
+void PhaseDetector::addTrigger (int m, int triggerSample, int64 timestamp)
+{
+    DetectorModule& module = modules.getReference (m);
+
+    if (module.wasTriggered && module.samplesUntilOff < triggerSample)
+    {
+        uint8 ttlData = 0;
+        TTLEventPtr event = TTLEvent::createTTLEvent (moduleEventChannels[m], timestamp + module.samplesUntilOff, &ttlData, sizeof (uint8), module.outputChan);
+        addEvent (moduleEventChannels[m], event, module.samplesUntilOff);
+    }
+
+    uint8 ttlData = 1 << module.outputChan;
+    TTLEventPtr event = TTLEvent::createTTLEvent (moduleEventChannels[m], timestamp + triggerSample, &ttlData, sizeof (uint8), module.outputChan);
+    addEvent (moduleEventChannels[m], event, triggerSample);
+
+    module.samplesUntilOff = triggerSample + 1001;
+    module.wasTriggered = true;
+}
+
+
 void PhaseDetector::process (AudioSampleBuffer& buffer)
 {
     checkForEvents ();
 
-    // loop through the modules
+    // each channel is scanned once, whatever the number of modules using it
+    for (int d = 0; d < transitionDetectors.size(); ++d)
+    {
+        const int chan = detectorChannels[d];
+        transitionDetectors[d]->process (buffer.getReadPointer (chan), getNumSamples (chan));
+    }
+
     for (int m = 0; m < modules.size(); ++m)
     {
         DetectorModule& module = modules.getReference (m);
 
-        // check to see if it's active and has a channel
-        if (module.isActive && module.outputChan >= 0
-            && module.inputChan >= 0
-            && module.inputChan < buffer.getNumChannels())
+        if (module.inputChan < 0 || module.inputChan >= buffer.getNumChannels())
+            continue;
+
+        const int nSamples = getNumSamples (module.inputChan);
+
+        // the filter needs the signal also while the module is gated off
+        triggers.clearQuick();
+        if (module.type == TARGET_PHASE && phaseEstimators[m]->isPrepared())
         {
-            for (int i = 0; i < getNumSamples (module.inputChan); ++i)
+            phaseEstimators[m]->process (buffer.getReadPointer (module.inputChan), nSamples,
+                                         module.targetPhase * float_Pi / 180.0f, triggers);
+            if (module.targetPhase < 0)
+                triggers.clearQuick();
+        }
+
+        if (! module.isActive || module.outputChan < 0)
+            continue;
+
+        const int64 timestamp = getTimestamp (module.inputChan);
+
+        if (module.type == TARGET_PHASE)
+        {
+            for (int i = 0; i < triggers.size(); ++i)
+                addTrigger (m, triggers.getUnchecked (i), timestamp);
+        }
+        else if (moduleDetectors[m] >= 0 && module.type != NONE)
+        {
+            // module types are in the same order as the quadrants they trigger on, shifted by one
+            const int quadrant = (int) module.type % 4 + 1;
+            const Array<TransitionDetector::Transition>& transitions = transitionDetectors[moduleDetectors[m]]->getTransitions();
+
+            for (int i = 0; i < transitions.size(); ++i)
+            {
+                if (transitions.getReference (i).quadrant == quadrant)
+                    addTrigger (m, transitions.getReference (i).sample, timestamp);
+            }
+        }
+
+        if (module.wasTriggered)
+        {
+            if (module.samplesUntilOff < nSamples)
+            {
+                uint8 ttlData = 0;
+                TTLEventPtr event = TTLEvent::createTTLEvent (moduleEventChannels[m], timestamp + module.samplesUntilOff, &ttlData, sizeof (uint8), module.outputChan);
+                addEvent (moduleEventChannels[m], event, module.samplesUntilOff);
+                module.wasTriggered = false;
+            }
+            else
             {
-                const float sample = *buffer.getReadPointer (module.inputChan, i);
-
-                if (sample < module.lastSample
-                    && sample > 0
-                    && module.phase != FALLING_POS)
-                {
-                    if (module.type == PEAK)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
-
-                    module.phase = FALLING_POS;
-                }
-                else if (sample < 0
-                         && module.lastSample >= 0
-                         && module.phase != FALLING_NEG)
-                {
-                    if (module.type == FALLING_ZERO)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
-
-                    module.phase = FALLING_NEG;
-                }
-                else if (sample > module.lastSample && sample < 0 && module.phase != RISING_NEG)
-                {
-                    if (module.type == TROUGH)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
-
-                    module.phase = RISING_NEG;
-                }
-                else if (sample > 0
-                         && module.lastSample <= 0
-                         && module.phase != RISING_POS)
-                {
-                    if (module.type == RISING_ZERO)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
-
-                    module.phase = RISING_POS;
-                }
-
-                module.lastSample = sample;
-
-                if (module.wasTriggered)
-                {
-                    if (module.samplesSinceTrigger > 1000)
-                    {
-						uint8 ttlData = 0;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.wasTriggered = false;
-                    }
-                    else
-                    {
-                        module.samplesSinceTrigger++;
-                    }
-                }
+                module.samplesUntilOff -= nSamples;
             }
         }
     }
@@ -26,6 +26,8 @@
 
 
 #include <ProcessorHeaders.h>
+#include "TransitionDetector.h"
+#include "PhaseEstimator.h"
 
 #define NUM_INTERVALS 5
 
@@ -34,6 +36,11 @@
 
     Uses peaks to estimate the phase of a continuous signal.
 
+    Each input channel used by a module is scanned once per block by a
+    TransitionDetector, and every module on that channel picks its events from the
+    resulting list. Modules in target phase mode instead follow the instantaneous
+    phase of a frequency band with a PhaseEstimator.
+
     @see GenericProcessor, PhaseDetectorEditor
 */
 class PhaseDetector : public GenericProcessor
@@ -62,14 +69,12 @@ private:
 
     void estimateFrequency();
 
-    enum ModuleType
-    {
-        NONE, PEAK, FALLING_ZERO, TROUGH, RISING_ZERO
-    };
+    /** Adds the on event at triggerSample, and the pending off event first if it is due before */
+    void addTrigger (int module, int triggerSample, int64 timestamp);
 
-    enum PhaseType
+    enum ModuleType
     {
-        NO_PHASE, RISING_POS, FALLING_POS, FALLING_NEG, RISING_NEG
+        NONE, PEAK, FALLING_ZERO, TROUGH, RISING_ZERO, TARGET_PHASE
     };
 
     struct DetectorModule
@@ -77,25 +82,34 @@ private:
         int inputChan;
         int gateChan;
         int outputChan;
-        int samplesSinceTrigger;
 
-        float lastSample;
+        // samples until the off event, relative to the start of the block
+        int samplesUntilOff;
 
         bool isActive;
         bool wasTriggered;
 
         ModuleType type;
-        PhaseType phase;
+
+        // target phase mode, in degrees with 0 at the rising zero crossing
+        float targetPhase;
+        float lowCut;
+        float highCut;
     };
 
     Array<DetectorModule> modules;
 
+    // one detector per input channel in use, shared by the modules on that channel
+    OwnedArray<TransitionDetector> transitionDetectors;
+    Array<int> detectorChannels;
+    Array<int> moduleDetectors;
+
+    // parallel to modules
+    OwnedArray<PhaseEstimator> phaseEstimators;
+    Array<int> triggers;
+
     int activeModule;
 
-    bool risingPos;
-    bool risingNeg;
-    bool fallingPos;
-    bool fallingNeg;
 	int lastNumInputs;
 
 	Array<const EventChannel*> moduleEventChannels;
@@ -189,6 +189,9 @@ void PhaseDetectorEditor::saveCustomParameters(XmlElement* xml)
         d->setAttribute("INPUT",interfaces[i]->getInputChan());
         d->setAttribute("GATE",interfaces[i]->getGateChan());
         d->setAttribute("OUTPUT",interfaces[i]->getOutputChan());
+        d->setAttribute("TARGET",interfaces[i]->getTargetPhase());
+        d->setAttribute("LOW",interfaces[i]->getLowCut());
+        d->setAttribute("HIGH",interfaces[i]->getHighCut());
     }
 }
 
@@ -211,6 +214,9 @@ void PhaseDetectorEditor::loadCustomParameters(XmlElement* xml)
             interfaces[i]->setInputChan(xmlNode->getIntAttribute("INPUT"));
             interfaces[i]->setGateChan(xmlNode->getIntAttribute("GATE"));
             interfaces[i]->setOutputChan(xmlNode->getIntAttribute("OUTPUT"));
+            interfaces[i]->setBand(xmlNode->getDoubleAttribute("LOW", 4.0), xmlNode->getDoubleAttribute("HIGH", 8.0));
+            if (xmlNode->getDoubleAttribute("TARGET", -1.0) >= 0)
+                interfaces[i]->setTargetPhase(xmlNode->getDoubleAttribute("TARGET"));
 
             i++;
         }
@@ -221,7 +227,7 @@ void PhaseDetectorEditor::loadCustomParameters(XmlElement* xml)
 // ===================================================================
 
 DetectorInterface::DetectorInterface(PhaseDetector* pd, Colour c, int id) :
-    backgroundColour(c), idNum(id), processor(pd)
+    backgroundColour(c), idNum(id), processor(pd), targetPhase(-1.0f), lowCut(4.0f), highCut(8.0f)
 {
 
     font = Font("Small Text", 10, Font::plain);
@@ -293,6 +299,24 @@ DetectorInterface::DetectorInterface(PhaseDetector* pd, Colour c, int id) :
     outputSelector->setSelectedId(1);
     addAndMakeVisible(outputSelector);
 
+    targetLabel = new Label("target", "-");
+    targetLabel->setBounds(5,60,40,16);
+    targetLabel->setFont(font);
+    targetLabel->setEditable(true);
+    targetLabel->setColour(Label::textColourId, Colours::darkgrey);
+    targetLabel->setTooltip("Target phase in degrees (0 = rising zero crossing, 90 = peak), predicted from the band below. \"-\" uses the phase buttons");
+    targetLabel->addListener(this);
+    addAndMakeVisible(targetLabel);
+
+    bandLabel = new Label("band", "4-8");
+    bandLabel->setBounds(48,60,60,16);
+    bandLabel->setFont(font);
+    bandLabel->setEditable(true);
+    bandLabel->setColour(Label::textColourId, Colours::darkgrey);
+    bandLabel->setTooltip("Frequency band (Hz) for the target phase");
+    bandLabel->addListener(this);
+    addAndMakeVisible(bandLabel);
+
 
     std::cout << "Updating channels" << std::endl;
 
@@ -350,6 +374,31 @@ void DetectorInterface::buttonClicked(Button* b)
 
     processor->setParameter(1, (float) i+1);
 
+    targetPhase = -1.0f;
+    targetLabel->setText("-", dontSendNotification);
+
+}
+
+void DetectorInterface::labelTextChanged(Label* label)
+{
+    if (label == targetLabel)
+    {
+        String text = label->getText().trim();
+        setTargetPhase(text.isEmpty() || text == "-" ? -1.0f : text.getFloatValue());
+    }
+    else if (label == bandLabel)
+    {
+        String text = label->getText();
+        float low = text.upToFirstOccurrenceOf("-", false, false).getFloatValue();
+        float high = text.fromFirstOccurrenceOf("-", false, false).getFloatValue();
+
+        if (low > 0 && high > low)
+            setBand(low, high);
+        else
+            setBand(lowCut, highCut);
+    }
+
+    CoreServices::updateSignalChain(processor->getEditor());
 }
 
 void DetectorInterface::updateChannels(int numChannels)
@@ -434,6 +483,55 @@ void DetectorInterface::setGateChan(int chan)
     processor->setParameter(4, (float) chan);
 }
 
+void DetectorInterface::setTargetPhase(float degrees)
+{
+    processor->setActiveModule(idNum);
+
+    if (degrees < 0)
+    {
+        targetPhase = -1.0f;
+        targetLabel->setText("-", dontSendNotification);
+        processor->setParameter(5, -1.0f);
+        processor->setParameter(1, (float) getPhase()+1);
+        return;
+    }
+
+    targetPhase = std::fmod(degrees, 360.0f);
+    targetLabel->setText(String(targetPhase, 1), dontSendNotification);
+
+    for (int i = 0; i < phaseButtons.size(); i++)
+        phaseButtons[i]->setToggleState(false, dontSendNotification);
+
+    processor->setParameter(5, targetPhase);
+    processor->setParameter(1, 5.0f);
+}
+
+void DetectorInterface::setBand(float low, float high)
+{
+    lowCut = low;
+    highCut = high;
+    bandLabel->setText(String(lowCut, 1) + "-" + String(highCut, 1), dontSendNotification);
+
+    processor->setActiveModule(idNum);
+    processor->setParameter(6, lowCut);
+    processor->setParameter(7, highCut);
+}
+
+float DetectorInterface::getTargetPhase()
+{
+    return targetPhase;
+}
+
+float DetectorInterface::getLowCut()
+{
+    return lowCut;
+}
+
+float DetectorInterface::getHighCut()
+{
+    return highCut;
+}
+
 int DetectorInterface::getInputChan()
 {
     return inputSelector->getSelectedId()-2;
@@ -453,4 +551,6 @@ void DetectorInterface::setEnableStatus(bool status)
 	inputSelector->setEnabled(status);
 	for (int i = 0; i < phaseButtons.size(); i++)
 		phaseButtons[i]->setEnabled(status);
+	targetLabel->setEnabled(status);
+	bandLabel->setEnabled(status);
 }
\ No newline at end of file
@@ -85,7 +85,8 @@ private:
 
 class DetectorInterface : public Component,
     public ComboBox::Listener,
-    public Button::Listener
+    public Button::Listener,
+    public Label::Listener
 {
 public:
     DetectorInterface(PhaseDetector*, Colour, int);
@@ -95,6 +96,7 @@ public:
 
     void comboBoxChanged(ComboBox*);
     void buttonClicked(Button*);
+    void labelTextChanged(Label*);
 
     void updateChannels(int);
 
@@ -103,11 +105,19 @@ public:
     void setOutputChan(int);
     void setGateChan(int);
 
+    /** Target phase in degrees, with 0 at the rising zero crossing. A negative value goes back to the phase buttons */
+    void setTargetPhase(float);
+    void setBand(float low, float high);
+
     int getPhase();
     int getInputChan();
     int getOutputChan();
     int getGateChan();
 
+    float getTargetPhase();
+    float getLowCut();
+    float getHighCut();
+
 	void setEnableStatus(bool status);
 
 private:
@@ -127,6 +137,13 @@ private:
     ScopedPointer<ComboBox> gateSelector;
     ScopedPointer<ComboBox> outputSelector;
 
+    ScopedPointer<Label> targetLabel;
+    ScopedPointer<Label> bandLabel;
+
+    float targetPhase;
+    float lowCut;
+    float highCut;
+
 };
 
 #endif  // __PHASEDETECTOREDITOR_H_136829C6__
@@ -0,0 +1,226 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PhaseEstimator.h"
+
+#include <cmath>
+
+namespace
+{
+    const int maxTaps = 255;
+
+    float wrapPhase (float phase)
+    {
+        while (phase > float_Pi)
+            phase -= 2 * float_Pi;
+        while (phase <= -float_Pi)
+            phase += 2 * float_Pi;
+        return phase;
+    }
+
+    float dotProduct (const float* a, const float* b, int n)
+    {
+        // independent partial sums so the loop vectorizes without reassociating a single sum
+        float s[4] = { 0, 0, 0, 0 };
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            for (int k = 0; k < 4; ++k)
+                s[k] += a[i + k] * b[i + k];
+        for (; i < n; ++i)
+            s[0] += a[i] * b[i];
+        return (s[0] + s[1]) + (s[2] + s[3]);
+    }
+}
+
+
+PhaseEstimator::PhaseEstimator()
+    : decimation        (1)
+    , numTaps           (0)
+    , delay             (0)
+    , minOmega          (0)
+    , maxOmega          (0)
+{
+    reset();
+}
+
+
+void PhaseEstimator::prepare (float sampleRate, float lowHz, float highHz)
+{
+    clear();
+    if (sampleRate <= 0 || lowHz <= 0 || highHz <= lowHz)
+        return;
+
+    decimation = jmax (1, int (sampleRate / (10 * highHz)));
+    const float rate = sampleRate / decimation;
+
+    // the negative image of the band has to be rejected, so the transition can be no
+    // wider than the distance from the band to DC, nor than the band itself
+    const float transition = jmin (lowHz, highHz - lowHz);
+    numTaps = jlimit (15, maxTaps, int (3.3f * rate / transition)) | 1;
+    delay = (numTaps - 1) / 2;
+
+    const double centre = 0.5 * (lowHz + highHz) / rate;
+    const double cutoff = (0.5 * (highHz - lowHz) + 0.5 * transition) / rate;
+
+    coefficientsRe.malloc (numTaps);
+    coefficientsIm.malloc (numTaps);
+    for (int k = 0; k < numTaps; ++k)
+    {
+        // Hamming-windowed low-pass shifted up to the centre of the band
+        const int t = k - delay;
+        const double sinc = t == 0 ? 2 * cutoff : std::sin (2 * double_Pi * cutoff * t) / (double_Pi * t);
+        const double window = 0.54 - 0.46 * std::cos (2 * double_Pi * k / (numTaps - 1));
+        const double angle = 2 * double_Pi * centre * t;
+
+        // stored reversed, so the newest sample meets tap 0
+        coefficientsRe[numTaps - 1 - k] = float (sinc * window * std::cos (angle));
+        coefficientsIm[numTaps - 1 - k] = float (sinc * window * std::sin (angle));
+    }
+
+    minOmega = float (2 * double_Pi * lowHz / rate);
+    maxOmega = float (2 * double_Pi * highHz / rate);
+
+    // each sample is written twice so the last numTaps are always contiguous
+    history.calloc (2 * numTaps);
+    reset();
+}
+
+
+void PhaseEstimator::reset()
+{
+    if (history != nullptr)
+        zeromem (history, 2 * numTaps * sizeof (float));
+    historyPosition = 0;
+    historyCount = 0;
+    accumulator = 0;
+    accumulated = 0;
+    lastPhase = 0;
+    omega = 0.5f * (minOmega + maxOmega);
+    hasPhase = false;
+    pendingTrigger = -1;
+    refractory = 0;
+}
+
+
+void PhaseEstimator::clear()
+{
+    numTaps = 0;
+    delay = 0;
+    coefficientsRe.free();
+    coefficientsIm.free();
+    history.free();
+    reset();
+}
+
+
+int PhaseEstimator::getLatencySamples() const
+{
+    return delay * decimation + decimation / 2;
+}
+
+
+void PhaseEstimator::process (const float* data, int nSamples, float targetPhase, Array<int>& triggers)
+{
+    if (numTaps == 0)
+        return;
+
+    // a trigger predicted near the end of the previous block
+    if (pendingTrigger >= 0 && pendingTrigger < nSamples)
+    {
+        triggers.add (pendingTrigger);
+        pendingTrigger = -1;
+    }
+
+    for (int i = 0; i < nSamples; ++i)
+    {
+        accumulator += data[i];
+
+        if (++accumulated == decimation)
+        {
+            addDecimatedSample (accumulator / decimation, i, nSamples, targetPhase, triggers);
+            accumulator = 0;
+            accumulated = 0;
+        }
+    }
+
+    if (pendingTrigger >= 0)
+        pendingTrigger -= nSamples;
+    refractory = jmax (0, refractory - nSamples);
+}
+
+
+void PhaseEstimator::addDecimatedSample (float sample, int inputSample, int nSamples, float targetPhase, Array<int>& triggers)
+{
+    history[historyPosition] = sample;
+    history[historyPosition + numTaps] = sample;
+    historyPosition = (historyPosition + 1) % numTaps;
+
+    if (historyCount < numTaps)
+    {
+        ++historyCount;
+        return;
+    }
+
+    const float* window = history + historyPosition;
+    const float re = dotProduct (window, coefficientsRe, numTaps);
+    const float im = dotProduct (window, coefficientsIm, numTaps);
+
+    // cosine phase of the band as it was delay decimated samples ago
+    const float phase = std::atan2 (im, re);
+
+    if (hasPhase)
+    {
+        const float step = jlimit (minOmega, maxOmega, wrapPhase (phase - lastPhase));
+        omega += 0.1f * (step - omega);
+    }
+    lastPhase = phase;
+    hasPhase = true;
+
+    // project to the newest input sample; the average is centred half a decimation back
+    const float lag = delay + 0.5f * (decimation - 1) / decimation;
+    const float current = phase + omega * lag + 0.5f * float_Pi;
+
+    // input samples until the phase reaches the target
+    float remaining = wrapPhase (targetPhase - current);
+    if (remaining < 0)
+        remaining += 2 * float_Pi;
+
+    // only place triggers due before the next estimate, which will be more accurate. The
+    // test is on the phase, not the rounded sample, or a target between the last sample
+    // before the next estimate and the next estimate itself would be missed
+    if (remaining >= omega || pendingTrigger >= 0)
+        return;
+
+    // current is the phase at inputSample, so a target reached now lands on it
+    const int target = inputSample + roundToInt (remaining / omega * decimation);
+    if (target < refractory)
+        return;
+
+    // at most one trigger per half cycle
+    refractory = target + roundToInt (float_Pi / omega * decimation);
+
+    if (target < nSamples)
+        triggers.add (target);
+    else
+        pendingTrigger = target;
+}
@@ -0,0 +1,101 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PHASEESTIMATOR_H__
+#define __PHASEESTIMATOR_H__
+
+#include <BasicJuceHeader.h>
+
+/**
+
+    Estimates the instantaneous phase of a band of a continuous signal and predicts
+    when it will reach a target phase, for closed-loop stimulation.
+
+    The input is averaged down to about ten times the upper edge of the band, then
+    filtered with a complex FIR band-pass that only passes positive frequencies, so its
+    output is the analytic signal of the band (a band-limited Hilbert transform) and
+    its angle is the phase. The filter is linear phase, so the estimate lags the input
+    by a fixed, known delay: getLatencySamples(). The phase is projected forward over
+    that delay with the smoothed instantaneous frequency, and triggers are placed at
+    the input sample where the projected phase reaches the target.
+
+    Phases are in radians with the sine convention: 0 is the rising zero crossing and
+    pi/2 the peak.
+
+    @see PhaseDetector
+
+*/
+class PhaseEstimator
+{
+public:
+    PhaseEstimator();
+
+    /** Designs the filter. Allocates, so only call while not processing */
+    void prepare (float sampleRate, float lowHz, float highHz);
+
+    /** Clears the filter history */
+    void reset();
+
+    /** Forgets the filter, so nothing is detected until prepare() succeeds again */
+    void clear();
+
+    bool isPrepared() const { return numTaps > 0; }
+
+    /** Adds a block and appends to triggers the samples, relative to the block, at which
+        the phase is predicted to reach targetPhase */
+    void process (const float* data, int nSamples, float targetPhase, Array<int>& triggers);
+
+    /** Delay of the filtered phase behind the input, in input samples. It is compensated
+        by prediction, so this is how far ahead the prediction reaches */
+    int getLatencySamples() const;
+
+private:
+    void addDecimatedSample (float sample, int inputSample, int nSamples, float targetPhase, Array<int>& triggers);
+
+    int decimation;
+    int numTaps;
+    int delay;
+    float minOmega;
+    float maxOmega;
+
+    HeapBlock<float> coefficientsRe;
+    HeapBlock<float> coefficientsIm;
+    HeapBlock<float> history;
+    int historyPosition;
+    int historyCount;
+
+    float accumulator;
+    int accumulated;
+
+    float lastPhase;
+    float omega;
+    bool hasPhase;
+
+    // in input samples, relative to the start of the next block
+    int pendingTrigger;
+    int refractory;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseEstimator);
+};
+
+#endif  // __PHASEESTIMATOR_H__
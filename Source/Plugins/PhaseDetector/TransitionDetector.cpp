@@ -0,0 +1,82 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TransitionDetector.h"
+
+
+TransitionDetector::TransitionDetector()
+{
+    codes.malloc (chunkSize);
+    transitions.ensureStorageAllocated (chunkSize);
+    reset();
+}
+
+
+void TransitionDetector::reset()
+{
+    lastSample = 0.0f;
+    quadrant = NO_QUADRANT;
+    transitions.clearQuick();
+}
+
+
+void TransitionDetector::process (const float* data, int nSamples)
+{
+    transitions.clearQuick();
+
+    for (int start = 0; start < nSamples; start += chunkSize)
+    {
+        const int n = jmin (chunkSize, nSamples - start);
+        const float* x = data + start;
+        uint8* code = codes;
+
+        // at most one of the four conditions holds for a pair of samples, so they can be summed
+        const float first = x[0];
+        code[0] = uint8 ((first > 0 && first < lastSample) * FALLING_POS
+                         + (first < 0 && lastSample >= 0) * FALLING_NEG
+                         + (first < 0 && first > lastSample) * RISING_NEG
+                         + (first > 0 && lastSample <= 0) * RISING_POS);
+
+        for (int i = 1; i < n; ++i)
+        {
+            const float sample = x[i];
+            const float previous = x[i - 1];
+            code[i] = uint8 ((sample > 0) * (sample < previous) * FALLING_POS
+                             + (sample < 0) * (previous >= 0) * FALLING_NEG
+                             + (sample < 0) * (sample > previous) * RISING_NEG
+                             + (sample > 0) * (previous <= 0) * RISING_POS);
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (code[i] != NO_QUADRANT && code[i] != quadrant)
+            {
+                quadrant = code[i];
+                Transition transition = { start + i, quadrant };
+                transitions.add (transition);
+            }
+        }
+
+        lastSample = x[n - 1];
+    }
+}
@@ -0,0 +1,79 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __TRANSITIONDETECTOR_H__
+#define __TRANSITIONDETECTOR_H__
+
+#include <ProcessorHeaders.h>
+
+/**
+
+    Finds the samples at which a continuous signal enters a new quadrant of its
+    cycle: rising through zero, falling while positive (a peak), falling through zero
+    and rising while negative (a trough).
+
+    Each block is classified in one branch-free pass over pairs of consecutive samples,
+    which the compiler turns into SIMD code. A scalar pass then only compares one byte
+    per sample to keep the transitions, so any number of detector modules can share
+    the result for their input channel without looking at the samples again.
+
+    @see PhaseDetector
+
+*/
+class TransitionDetector
+{
+public:
+    enum Quadrant
+    {
+        NO_QUADRANT = 0, RISING_POS, FALLING_POS, FALLING_NEG, RISING_NEG
+    };
+
+    struct Transition
+    {
+        int sample;
+        int quadrant;
+    };
+
+    TransitionDetector();
+
+    /** Forgets the previous sample and quadrant */
+    void reset();
+
+    /** Replaces the transitions with those of a new block */
+    void process (const float* data, int nSamples);
+
+    const Array<Transition>& getTransitions() const { return transitions; }
+
+private:
+    static const int chunkSize = 1024;
+
+    HeapBlock<uint8> codes;
+    Array<Transition> transitions;
+
+    float lastSample;
+    int quadrant;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TransitionDetector);
+};
+
+#endif  // __TRANSITIONDETECTOR_H__
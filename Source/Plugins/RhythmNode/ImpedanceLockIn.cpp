@@ -0,0 +1,88 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ImpedanceLockIn.h"
+
+#include <cmath>
+
+using namespace RhythmNode;
+
+#define TWO_PI  6.28318530718
+
+ImpedanceLockIn::ImpedanceLockIn() : startIndex(0), length(0)
+{
+}
+
+void ImpedanceLockIn::setWindow(int startIndex_, int endIndex, double sampleRate, double frequency)
+{
+	const double k = TWO_PI * frequency / sampleRate;
+
+	startIndex = startIndex_;
+	length = endIndex - startIndex + 1;
+	cosTable.resize(length);
+	sinTable.resize(length);
+
+	// The phase is taken from the start of the acquisition, so all windows share one reference.
+	for (int i = 0; i < length; ++i)
+	{
+		cosTable[i] = cos(k * (startIndex + i));
+		sinTable[i] = -1.0 * sin(k * (startIndex + i));
+	}
+}
+
+// Correlates every row with the sine and cosine references. The sums are split in four
+// so that the compiler can keep them in vector registers.
+void ImpedanceLockIn::measure(const double* rows, int numRows, int rowLength,
+	double* realComponents, double* imagComponents) const
+{
+	const double* cosine = cosTable.data();
+	const double* sine = sinTable.data();
+
+	for (int row = 0; row < numRows; ++row)
+	{
+		const double* x = rows + (size_t)row * rowLength + startIndex;
+		double i0 = 0.0, i1 = 0.0, i2 = 0.0, i3 = 0.0;
+		double q0 = 0.0, q1 = 0.0, q2 = 0.0, q3 = 0.0;
+		int t = 0;
+
+		for (; t + 4 <= length; t += 4)
+		{
+			i0 += x[t] * cosine[t];
+			i1 += x[t + 1] * cosine[t + 1];
+			i2 += x[t + 2] * cosine[t + 2];
+			i3 += x[t + 3] * cosine[t + 3];
+			q0 += x[t] * sine[t];
+			q1 += x[t + 1] * sine[t + 1];
+			q2 += x[t + 2] * sine[t + 2];
+			q3 += x[t + 3] * sine[t + 3];
+		}
+		for (; t < length; ++t)
+		{
+			i0 += x[t] * cosine[t];
+			q0 += x[t] * sine[t];
+		}
+
+		realComponents[row] = 2.0 * ((i0 + i1) + (i2 + i3)) / (double)length;
+		imagComponents[row] = 2.0 * ((q0 + q1) + (q2 + q3)) / (double)length;
+	}
+}
@@ -0,0 +1,63 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __IMPEDANCELOCKIN_H
+#define __IMPEDANCELOCKIN_H
+
+#include <vector>
+
+namespace RhythmNode
+{
+
+	/**
+		Measures one frequency component on many channels at once, as a lock-in amplifier would.
+
+		The reference cosine and sine are tabulated once for the measurement window. Samples are
+		held channel by channel in one flat array, so every channel is two dot products against
+		the tables instead of a cos() and a sin() per sample.
+		*/
+	class ImpedanceLockIn
+	{
+	public:
+		ImpedanceLockIn();
+
+		/** Tabulates the references for samples startIndex to endIndex, both included */
+		void setWindow(int startIndex, int endIndex, double sampleRate, double frequency);
+
+		/** Writes the real and imaginary amplitudes of numRows rows of samples, rowLength apart.
+			Rows are indexed from the start of the acquisition, not from the start of the window. */
+		void measure(const double* rows, int numRows, int rowLength,
+			double* realComponents, double* imagComponents) const;
+
+		int getStartIndex() const { return startIndex; }
+		int getEndIndex() const { return startIndex + length - 1; }
+
+	private:
+		int startIndex;
+		int length;
+		std::vector<double> cosTable;
+		std::vector<double> sinTable;
+	};
+
+}
+#endif  // __IMPEDANCELOCKIN_H
@@ -49,24 +49,6 @@ using namespace RhythmNode;
 
 #define INIT_STEP ( evalBoard->isUSB3() ? 256 : 60)
 
-// Allocates memory for a 3-D array of doubles.
-void allocateDoubleArray3D(std::vector<std::vector<std::vector<double> > >& array3D,
-                           int xSize, int ySize, int zSize)
-{
-    int i, j;
-
-    if (xSize == 0) return;
-    array3D.resize(xSize);
-    for (i = 0; i < xSize; ++i)
-    {
-        array3D[i].resize(ySize);
-        for (j = 0; j < ySize; ++j)
-        {
-            array3D[i][j].resize(zSize);
-        }
-    }
-}
-
 DataThread* RHD2000Thread::createDataThread(SourceNode *sn)
 {
 	return new RHD2000Thread(sn);
@@ -1851,8 +1833,7 @@ RHDImpedanceMeasure::RHDImpedanceMeasure(RHD2000Thread* b) : Thread(""), data(nu
 {
 	// to perform electrode impedance measurements at very low frequencies.
 	const int maxNumBlocks = 120;
-	int numStreams = 8;
-	allocateDoubleArray3D(amplifierPreFilter, numStreams, 32, MAX_SAMPLES_PER_DATA_BLOCK * maxNumBlocks);
+	amplifierPreFilter.reserve(MAX_NUM_DATA_STREAMS_USB3 * MAX_SAMPLES_PER_DATA_BLOCK * maxNumBlocks);
 }
 
 RHDImpedanceMeasure::~RHDImpedanceMeasure()
@@ -1937,49 +1918,32 @@ float RHDImpedanceMeasure::updateImpedanceFrequency(float desiredImpedanceFreq,
 
 
 // Reads numBlocks blocks of raw USB data stored in a queue of Rhd2000DataBlock
-// objects, loads this data into this SignalProcessor object, scaling the raw
-// data to generate waveforms with units of volts or microvolts.
+// objects and loads the samples of one amplifier channel of every stream, scaled
+// to microvolts, into amplifierPreFilter, one row of numBlocks blocks per stream.
 int RHDImpedanceMeasure::loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
-	int numBlocks, int numDataStreams)
+	int numBlocks, int numDataStreams, int chipChannel)
 {
-
-	int block, t, channel, stream;
+	const int samplesPerBlock = SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3());
+	const int rowLength = samplesPerBlock * numBlocks;
+	int block, t, stream;
 	int indexAmp = 0;
-    /*
-	int indexAux = 0;
-	int indexSupply = 0;
-	int indexAdc = 0;
-	int indexDig = 0;
-	int numWordsWritten = 0;
-
-	int bufferIndex;
-	int16 tempQint16;
-	uint16 tempQuint16;
-	int32 tempQint32;
-
-	bool triggerFound = false;
-	const double AnalogTriggerThreshold = 1.65;
-     */
 
+	amplifierPreFilter.resize(numDataStreams * rowLength);
 
 	for (block = 0; block < numBlocks; ++block)
 	{
-
 		// Load and scale RHD2000 amplifier waveforms
 		// (sampled at amplifier sampling rate)
-		for (t = 0; t < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()); ++t)
+		for (stream = 0; stream < numDataStreams; ++stream)
 		{
-			for (channel = 0; channel < 32; ++channel)
-			{
-				for (stream = 0; stream < numDataStreams; ++stream)
-				{
-					// Amplifier waveform units = microvolts
-					amplifierPreFilter[stream][channel][indexAmp] = 0.195 *
-						(dataQueue.front().amplifierData[stream][channel][t] - 32768);
-				}
-			}
-			++indexAmp;
+			const vector<int>& samples = dataQueue.front().amplifierData[stream][chipChannel];
+			double* row = &amplifierPreFilter[stream * rowLength + indexAmp];
+
+			// Amplifier waveform units = microvolts
+			for (t = 0; t < samplesPerBlock; ++t)
+				row[t] = 0.195 * (samples[t] - 32768);
 		}
+		indexAmp += samplesPerBlock;
 		// We are done with this Rhd2000DataBlock object; remove it from dataQueue
 		dataQueue.pop();
 	}
@@ -1992,58 +1956,58 @@ int RHDImpedanceMeasure::loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
 #define DEGREES_TO_RADIANS  0.0174532925199
 #define RADIANS_TO_DEGREES  57.2957795132
 
-// Return the magnitude and phase (in degrees) of a selected frequency component (in Hz)
-// for a selected amplifier channel on the selected USB data stream.
-void RHDImpedanceMeasure::measureComplexAmplitude(std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
-	std::vector<std::vector<std::vector<double>>>& measuredPhase,
-	int capIndex, int stream, int chipChannel, int numBlocks,
-	double sampleRate, double frequency, int numPeriods)
+// Switches the Zcheck DAC to a channel and starts the board on one acquisition.
+void RHDImpedanceMeasure::startAcquisition(int zcheckChannel)
 {
-	int period = (sampleRate / frequency);
-	int startIndex = 0;
-	int endIndex = startIndex + numPeriods * period - 1;
+	vector<int> commandList;
 
-	// Move the measurement window to the end of the waveform to ignore start-up transient.
-	while (endIndex < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()) * numBlocks - period)
-	{
-		startIndex += period;
-		endIndex += period;
-	}
+	board->chipRegisters.setZcheckChannel(zcheckChannel);
+	board->chipRegisters.createCommandListRegisterConfig(commandList, false);
+	// Upload version with no ADC calibration to AuxCmd3 RAM Bank 1.
+	board->evalBoard->uploadCommandList(commandList, Rhd2000EvalBoard::AuxCmd3, 3);
 
-	double iComponent, qComponent;
+	board->evalBoard->run();
+}
 
-	// Measure real (iComponent) and imaginary (qComponent) amplitude of frequency component.
-	amplitudeOfFreqComponent(iComponent, qComponent, amplifierPreFilter[stream][chipChannel],
-		startIndex, endIndex, sampleRate, frequency);
-	// Calculate magnitude and phase from real (I) and imaginary (Q) components.
-	measuredMagnitude[stream][chipChannel][capIndex] =
-		sqrt(iComponent * iComponent + qComponent * qComponent);
-	measuredPhase[stream][chipChannel][capIndex] =
-		RADIANS_TO_DEGREES *atan2(qComponent, iComponent);
+// Waits for the board to finish the acquisition and reads it.
+void RHDImpedanceMeasure::finishAcquisition(Acquisition& acquisition, int numBlocks)
+{
+	while (board->evalBoard->isRunning())
+	{
+
+	}
+	board->evalBoard->readDataBlocks(numBlocks, acquisition.dataQueue);
 }
 
-// Returns the real and imaginary amplitudes of a selected frequency component in the vector
-// data, between a start index and end index.
-void RHDImpedanceMeasure::amplitudeOfFreqComponent(double& realComponent, double& imagComponent,
-	const std::vector<double>& data, int startIndex,
-	int endIndex, double sampleRate, double frequency)
+// Measures the magnitude and phase (in degrees) of the test frequency on the channel
+// under test, on all the streams the acquisition was for.
+void RHDImpedanceMeasure::analyzeAcquisition(Acquisition& acquisition, int numBlocks, int numDataStreams,
+	std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
+	std::vector<std::vector<std::vector<double>>>& measuredPhase)
 {
-	int length = endIndex - startIndex + 1;
-	const double k = TWO_PI * frequency / sampleRate;  // precalculate for speed
+	const int rowLength = SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()) * numBlocks;
 
-	// Perform correlation with sine and cosine waveforms.
-	double meanI = 0.0;
-	double meanQ = 0.0;
-	for (int t = startIndex; t <= endIndex; ++t)
+	loadAmplifierData(acquisition.dataQueue, numBlocks, numDataStreams, acquisition.chipChannel);
+
+	realComponents.resize(numDataStreams);
+	imagComponents.resize(numDataStreams);
+	lockIn.measure(amplifierPreFilter.data(), numDataStreams, rowLength,
+		realComponents.data(), imagComponents.data());
+
+	for (int stream = 0; stream < numDataStreams; ++stream)
 	{
-		meanI += data.at(t) * cos(k * t);
-		meanQ += data.at(t) * -1.0 * sin(k * t);
-	}
-	meanI /= (double)length;
-	meanQ /= (double)length;
+		if ((board->chipId[stream] == CHIP_ID_RHD2164_B) != acquisition.rhd2164)
+			continue;
+
+		const double iComponent = realComponents[stream];
+		const double qComponent = imagComponents[stream];
 
-	realComponent = 2.0 * meanI;
-	imagComponent = 2.0 * meanQ;
+		// Calculate magnitude and phase from real (I) and imaginary (Q) components.
+		measuredMagnitude[stream][acquisition.chipChannel][acquisition.capIndex] =
+			sqrt(iComponent * iComponent + qComponent * qComponent);
+		measuredPhase[stream][acquisition.chipChannel][acquisition.capIndex] =
+			RADIANS_TO_DEGREES * atan2(qComponent, iComponent);
+	}
 }
 
 
@@ -2217,6 +2181,23 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
 
 	int bestAmplitudeIndex;
 
+	// Move the measurement window to the end of the waveform to ignore start-up transient.
+	int periodSamples = period;
+	int startIndex = 0;
+	int endIndex = startIndex + numPeriods * periodSamples - 1;
+	while (endIndex < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()) * numBlocks - periodSamples)
+	{
+		startIndex += periodSamples;
+		endIndex += periodSamples;
+	}
+	lockIn.setWindow(startIndex, endIndex, board->boardSampleRate, actualImpedanceFreq);
+
+	// The board measures one channel at a time. Every acquisition is analyzed while the
+	// board is taking the next one, rather than after it.
+	Acquisition acquisitions[2];
+	Acquisition* pendingAcquisition = nullptr;
+	int nextAcquisition = 0;
+
 	// We execute three complete electrode impedance measurements: one each with
 	// Cseries set to 0.1 pF, 1 pF, and 10 pF.  Then we select the best measurement
 	// for each channel so that we achieve a wide impedance measurement range.
@@ -2245,65 +2226,36 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
 		// Check all 32 channels across all active data streams.
 		for (channel = 0; channel < 32; ++channel)
 		{
-			CHECK_EXIT;
-			cout << "running impedance on channel " << channel << endl;
-
-			board->chipRegisters.setZcheckChannel(channel);
-			commandSequenceLength =
-				board->chipRegisters.createCommandListRegisterConfig(commandList, false);
-			// Upload version with no ADC calibration to AuxCmd3 RAM Bank 1.
-			board->evalBoard->uploadCommandList(commandList, Rhd2000EvalBoard::AuxCmd3, 3);
-
-			board->evalBoard->run();
-			while (board->evalBoard->isRunning())
-			{
-
-			}
-			queue<Rhd2000DataBlock> dataQueue;
-			board->evalBoard->readDataBlocks(numBlocks, dataQueue);
-			loadAmplifierData(dataQueue, numBlocks, numdataStreams);
-			for (stream = 0; stream < numdataStreams; ++stream)
-			{
-				if (board->chipId[stream] != CHIP_ID_RHD2164_B)
-				{
-					measureComplexAmplitude(measuredMagnitude, measuredPhase,
-						capRange, stream, channel, numBlocks, board->boardSampleRate,
-						actualImpedanceFreq, numPeriods);
-				}
-			}
-
 			// If an RHD2164 chip is plugged in, we have to set the Zcheck select register to channels 32-63
-			// and repeat the previous steps.
-			if (rhd2164ChipPresent)
+			// and repeat the acquisition.
+			for (int pass = 0; pass < (rhd2164ChipPresent ? 2 : 1); ++pass)
 			{
 				CHECK_EXIT;
-				board->chipRegisters.setZcheckChannel(channel + 32); // address channels 32-63
-				commandSequenceLength =
-					board->chipRegisters.createCommandListRegisterConfig(commandList, false);
-				// Upload version with no ADC calibration to AuxCmd3 RAM Bank 1.
-				board->evalBoard->uploadCommandList(commandList, Rhd2000EvalBoard::AuxCmd3, 3);
-
-				board->evalBoard->run();
-				while (board->evalBoard->isRunning())
-				{
+				if (pass == 0)
+					cout << "running impedance on channel " << channel << endl;
 
-				}
-				board->evalBoard->readDataBlocks(numBlocks, dataQueue);
-				loadAmplifierData(dataQueue, numBlocks, numdataStreams);
+				Acquisition& acquisition = acquisitions[nextAcquisition];
+				nextAcquisition = 1 - nextAcquisition;
+				acquisition.capIndex = capRange;
+				acquisition.chipChannel = channel;
+				acquisition.rhd2164 = (pass == 1);
 
-				for (stream = 0; stream < board->evalBoard->getNumEnabledDataStreams(); ++stream)
-				{
-					if (board->chipId[stream] == CHIP_ID_RHD2164_B)
-					{
-						measureComplexAmplitude(measuredMagnitude, measuredPhase,
-							capRange, stream, channel, numBlocks, board->boardSampleRate,
-							actualImpedanceFreq, numPeriods);
-					}
-				}
+				startAcquisition(pass == 1 ? channel + 32 : channel);
+
+				if (pendingAcquisition != nullptr)
+					analyzeAcquisition(*pendingAcquisition, numBlocks, numdataStreams,
+						measuredMagnitude, measuredPhase);
+
+				finishAcquisition(acquisition, numBlocks);
+				pendingAcquisition = &acquisition;
 			}
 		}
 	}
 
+	if (pendingAcquisition != nullptr)
+		analyzeAcquisition(*pendingAcquisition, numBlocks, numdataStreams,
+			measuredMagnitude, measuredPhase);
+
 	data->streams.clear();
 	data->channels.clear();
 	data->magnitudes.clear();
@@ -35,6 +35,7 @@
 #include "rhythm-api/rhd2000registers.h"
 #include "rhythm-api/rhd2000datablock.h"
 #include "rhythm-api/okFrontPanelDLL.h"
+#include "ImpedanceLockIn.h"
 
 #define MAX_NUM_DATA_STREAMS_USB2 8
 #define MAX_NUM_DATA_STREAMS_USB3 16
@@ -285,14 +286,20 @@ namespace RhythmNode
 		void runImpedanceMeasurement();
 		void restoreFPGA();
 
-		void measureComplexAmplitude(std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
-			std::vector<std::vector<std::vector<double>>>& measuredPhase,
-			int capIndex, int stream, int chipChannel, int numBlocks,
-			double sampleRate, double frequency, int numPeriods);
-
-		void amplitudeOfFreqComponent(double& realComponent, double& imagComponent,
-			const std::vector<double>& data, int startIndex,
-			int endIndex, double sampleRate, double frequency);
+		/** One acquisition with the Zcheck DAC connected to a channel */
+		struct Acquisition
+		{
+			queue<Rhd2000DataBlock> dataQueue;
+			int capIndex;
+			int chipChannel;
+			bool rhd2164;   // measures the streams of RHD2164 chips, which hold channels 32-63
+		};
+
+		void startAcquisition(int zcheckChannel);
+		void finishAcquisition(Acquisition& acquisition, int numBlocks);
+		void analyzeAcquisition(Acquisition& acquisition, int numBlocks, int numDataStreams,
+			std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
+			std::vector<std::vector<std::vector<double>>>& measuredPhase);
 
 		void factorOutParallelCapacitance(double& impedanceMagnitude, double& impedancePhase,
 			double frequency, double parasiticCapacitance);
@@ -302,9 +309,13 @@ namespace RhythmNode
 
 		float updateImpedanceFrequency(float desiredImpedanceFreq, bool& impedanceFreqValid);
 		int loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
-			int numBlocks, int numDataStreams);
+			int numBlocks, int numDataStreams, int chipChannel);
 
-		std::vector<std::vector<std::vector<double>>> amplifierPreFilter;
+		// the channel under test on every stream, one row of samples per stream
+		std::vector<double> amplifierPreFilter;
+		std::vector<double> realComponents;
+		std::vector<double> imagComponents;
+		ImpedanceLockIn lockIn;
 
 		ImpedanceData* data;
 		RHD2000Thread* board;
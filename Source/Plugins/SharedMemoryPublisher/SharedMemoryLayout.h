@@ -0,0 +1,104 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHAREDMEMORYLAYOUT_H_INCLUDED
+#define SHAREDMEMORYLAYOUT_H_INCLUDED
+
+/*
+	Layout of the shared memory segment written by the Shared Memory Publisher.
+	Plain C so the client library in client/ uses the same definitions.
+
+	The segment starts with an oe_shm_header, followed by numChannels oe_shm_channel
+	entries, a ring of capacity int64 timestamps and, for each channel in turn, a ring
+	of capacity float samples in microvolts. Sample n of the stream is stored at ring
+	position n & (capacity - 1). All offsets are from the start of the segment.
+
+	writeIndex is the number of samples written since acquisition started. It is
+	protected by a seqlock: the publisher makes sequence odd, writes at most
+	maxBlockSamples samples, advances writeIndex and makes sequence even again.
+	A reader that sees the same even sequence before and after copying has a
+	consistent snapshot; otherwise it must check that the samples it copied were not
+	overwritten (see oe_shm_read).
+
+	When acquisition restarts, session changes and writeIndex starts from 0 again.
+	If the channel layout changes, the publisher sets closed and creates a new segment
+	under the same name, so readers have to reopen it.
+*/
+
+#include <stdint.h>
+
+#define OE_SHM_MAGIC 0x4D48534F /* "OSHM" */
+#define OE_SHM_VERSION 1
+#define OE_SHM_CHANNEL_NAME_SIZE 32
+#define OE_SHM_DEFAULT_NAME "open-ephys"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct oe_shm_header
+{
+	/* fixed while the segment exists */
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numChannels;
+	uint32_t capacity;           /* samples per channel, a power of two */
+	uint32_t maxBlockSamples;    /* most samples written between two sequence changes */
+	uint32_t reserved0;
+	uint64_t segmentSize;
+	uint64_t channelTableOffset;
+	uint64_t timestampOffset;
+	uint64_t dataOffset;
+	double sampleRate;
+
+	/* changed when acquisition starts and stops */
+	volatile uint32_t session;
+	volatile uint32_t running;
+	volatile uint32_t closed;
+	uint32_t reserved1;
+
+	/* written on every block, on a cache line of their own */
+	uint8_t pad[128 - 80];
+	volatile uint32_t sequence;
+	uint32_t reserved2;
+	volatile uint64_t writeIndex;
+	volatile int64_t publishTimeNs; /* monotonic clock when the last block was published */
+	uint8_t pad2[64 - 24];
+} oe_shm_header;
+
+typedef struct oe_shm_channel
+{
+	char name[OE_SHM_CHANNEL_NAME_SIZE];
+	float bitVolts;
+	uint16_t sourceNodeId;
+	uint16_t sourceSubProcessor;
+	uint32_t sourceIndex;        /* index of the channel in its source processor */
+	uint32_t globalIndex;        /* index of the channel in the publisher's input */
+	uint8_t pad[16];
+} oe_shm_channel;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
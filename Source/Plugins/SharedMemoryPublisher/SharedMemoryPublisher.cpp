@@ -0,0 +1,194 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SharedMemoryPublisher.h"
+#include "SharedMemoryPublisherEditor.h"
+
+SharedMemoryPublisher::SharedMemoryPublisher()
+	: GenericProcessor("Shared Memory"),
+	m_segmentName(OE_SHM_DEFAULT_NAME),
+	m_ringSeconds(2.0f),
+	m_sampleRate(0)
+{
+	setProcessorType(PROCESSOR_TYPE_SINK);
+}
+
+SharedMemoryPublisher::~SharedMemoryPublisher()
+{
+	m_ring.close();
+}
+
+AudioProcessorEditor* SharedMemoryPublisher::createEditor()
+{
+	editor = new SharedMemoryPublisherEditor(this);
+	return editor;
+}
+
+void SharedMemoryPublisher::selectChannels()
+{
+	m_publishedChannels.clear();
+
+	Array<int> activeChannels = editor->getActiveChannels();
+	const DataChannel* first = nullptr;
+	int skipped = 0;
+	for (int i = 0; i < activeChannels.size(); i++)
+	{
+		const DataChannel* chan = getDataChannel(activeChannels[i]);
+		if (chan == nullptr)
+			continue;
+		if (first == nullptr)
+			first = chan;
+		//a block carries the same number of samples for every published channel
+		if (chan->getSourceNodeID() != first->getSourceNodeID() || chan->getSubProcessorIdx() != first->getSubProcessorIdx())
+		{
+			skipped++;
+			continue;
+		}
+		m_publishedChannels.add(activeChannels[i]);
+	}
+	m_sampleRate = first != nullptr ? first->getSampleRate() : 0;
+
+	if (skipped > 0)
+		CoreServices::sendStatusMessage("Shared memory: " + String(skipped) + " channels from other subprocessors are not published");
+}
+
+bool SharedMemoryPublisher::enable()
+{
+	selectChannels();
+	if (m_publishedChannels.size() == 0)
+	{
+		m_ring.close();
+		return true;
+	}
+
+	Array<oe_shm_channel> channels;
+	for (int i = 0; i < m_publishedChannels.size(); i++)
+	{
+		const DataChannel* chan = getDataChannel(m_publishedChannels[i]);
+		oe_shm_channel info;
+		zerostruct(info);
+		chan->getName().copyToUTF8(info.name, OE_SHM_CHANNEL_NAME_SIZE);
+		info.bitVolts = chan->getBitVolts();
+		info.sourceNodeId = chan->getSourceNodeID();
+		info.sourceSubProcessor = chan->getSubProcessorIdx();
+		info.sourceIndex = chan->getSourceIndex();
+		info.globalIndex = m_publishedChannels[i];
+		channels.add(info);
+	}
+
+	int capacity = SharedMemoryRing::getRingCapacity(int(m_ringSeconds * m_sampleRate));
+	String error;
+	if (!m_ring.create(m_segmentName, channels, m_sampleRate, capacity, error))
+	{
+		CoreServices::sendStatusMessage("Shared memory: " + error);
+		m_publishedChannels.clear();
+		return true;
+	}
+
+	m_channelPointers.malloc(m_publishedChannels.size());
+	m_ring.start();
+	return true;
+}
+
+bool SharedMemoryPublisher::disable()
+{
+	m_ring.stop();
+	return true;
+}
+
+void SharedMemoryPublisher::process(AudioSampleBuffer& continuousBuffer)
+{
+	int numChannels = m_publishedChannels.size();
+	if (numChannels == 0)
+		return;
+
+	int nSamples = getNumSamples(m_publishedChannels[0]);
+	if (nSamples <= 0)
+		return;
+
+	for (int i = 0; i < numChannels; i++)
+		m_channelPointers[i] = continuousBuffer.getReadPointer(m_publishedChannels[i]);
+	m_ring.write(m_channelPointers, nSamples, getTimestamp(m_publishedChannels[0]));
+}
+
+String SharedMemoryPublisher::getSegmentName() const
+{
+	return m_segmentName;
+}
+
+void SharedMemoryPublisher::setSegmentName(const String& name)
+{
+	String newName = name.retainCharacters("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.");
+	if (newName.isEmpty() || newName == m_segmentName)
+		return;
+
+	//the old name goes away, readers of the old segment see it closed
+	m_ring.close();
+	m_segmentName = newName;
+}
+
+float SharedMemoryPublisher::getRingSeconds() const
+{
+	return m_ringSeconds;
+}
+
+void SharedMemoryPublisher::setRingSeconds(float seconds)
+{
+	if (seconds > 0)
+		m_ringSeconds = jmin(seconds, 60.0f);
+}
+
+int SharedMemoryPublisher::getNumPublishedChannels() const
+{
+	return m_publishedChannels.size();
+}
+
+uint64 SharedMemoryPublisher::getSamplesWritten() const
+{
+	return m_ring.getWriteIndex();
+}
+
+float SharedMemoryPublisher::getPublishedSampleRate() const
+{
+	return m_sampleRate;
+}
+
+void SharedMemoryPublisher::saveCustomParametersToXml(XmlElement* parentElement)
+{
+	XmlElement* mainNode = parentElement->createNewChildElement("SHAREDMEMORY");
+	mainNode->setAttribute("name", m_segmentName);
+	mainNode->setAttribute("ringSeconds", m_ringSeconds);
+}
+
+void SharedMemoryPublisher::loadCustomParametersFromXml()
+{
+	if (parametersAsXml)
+	{
+		forEachXmlChildElementWithTagName(*parametersAsXml, mainNode, "SHAREDMEMORY")
+		{
+			setSegmentName(mainNode->getStringAttribute("name", m_segmentName));
+			setRingSeconds(float(mainNode->getDoubleAttribute("ringSeconds", m_ringSeconds)));
+			static_cast<SharedMemoryPublisherEditor*>(getEditor())->updateLabels();
+		}
+	}
+}
@@ -0,0 +1,84 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHAREDMEMORYPUBLISHER_H_INCLUDED
+#define SHAREDMEMORYPUBLISHER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include "SharedMemoryRing.h"
+
+/**
+	Publishes the selected continuous channels into a shared memory ring, so processes on
+	the same machine can read them with sub-millisecond latency without going through disk
+	or the network.
+
+	Channels are those selected in the editor's channel selector. They all have to come
+	from the same subprocessor; the ones that do not are left out. The segment layout is
+	in SharedMemoryLayout.h and client/oe_shm_client.h is a C library to read it.
+
+	@see SharedMemoryRing
+*/
+class SharedMemoryPublisher : public GenericProcessor
+{
+public:
+	SharedMemoryPublisher();
+	~SharedMemoryPublisher();
+
+	AudioProcessorEditor* createEditor() override;
+
+	void process(AudioSampleBuffer& continuousBuffer) override;
+
+	bool enable() override;
+	bool disable() override;
+
+	void saveCustomParametersToXml(XmlElement* parentElement) override;
+	void loadCustomParametersFromXml() override;
+
+	/** Name of the segment, without the leading '/' of POSIX names. Applies on the next start */
+	String getSegmentName() const;
+	void setSegmentName(const String& name);
+
+	/** Length of the ring in seconds, rounded up to a power of two samples */
+	float getRingSeconds() const;
+	void setRingSeconds(float seconds);
+
+	int getNumPublishedChannels() const;
+	uint64 getSamplesWritten() const;
+	float getPublishedSampleRate() const;
+
+private:
+	/** Picks the selected channels from the first selected channel's subprocessor */
+	void selectChannels();
+
+	String m_segmentName;
+	float m_ringSeconds;
+
+	SharedMemoryRing m_ring;
+	Array<int> m_publishedChannels;
+	HeapBlock<const float*> m_channelPointers;
+	float m_sampleRate;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedMemoryPublisher);
+};
+
+#endif
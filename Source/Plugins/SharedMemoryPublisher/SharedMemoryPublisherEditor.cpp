@@ -0,0 +1,117 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SharedMemoryPublisherEditor.h"
+#include "SharedMemoryPublisher.h"
+
+SharedMemoryPublisherEditor::SharedMemoryPublisherEditor(SharedMemoryPublisher* parentNode)
+	: GenericEditor(parentNode, true), m_processor(parentNode), m_statusMonitor(*this)
+{
+	desiredWidth = 190;
+
+	m_nameLabel = addLabel("Name", 35, true);
+	m_nameLabel->setTooltip("Name of the shared memory segment read by the clients");
+	m_ringLabel = addLabel("Ring (s)", 57, true);
+	m_ringLabel->setTooltip("Seconds of data kept in the ring, rounded up to a power of two samples");
+
+	m_statusLabel = new Label("Status", String::empty);
+	m_statusLabel->setFont(Font("Small Text", 11, Font::plain));
+	m_statusLabel->setBounds(10, 82, 175, 30);
+	m_statusLabel->setColour(Label::textColourId, Colours::darkgrey);
+	m_statusLabel->setJustificationType(Justification::topLeft);
+	addAndMakeVisible(m_statusLabel);
+	m_labels.add(m_statusLabel);
+
+	updateLabels();
+	updateStatusLabel();
+}
+
+SharedMemoryPublisherEditor::~SharedMemoryPublisherEditor()
+{
+	m_statusMonitor.stopTimer();
+}
+
+Label* SharedMemoryPublisherEditor::addLabel(const String& name, int y, bool editable)
+{
+	Label* nameLabel = new Label(name, name);
+	nameLabel->setFont(Font("Small Text", 11, Font::plain));
+	nameLabel->setBounds(10, y, 55, 18);
+	nameLabel->setColour(Label::textColourId, Colours::darkgrey);
+	addAndMakeVisible(nameLabel);
+	m_labels.add(nameLabel);
+
+	Label* valueLabel = new Label(name + " value", String::empty);
+	valueLabel->setFont(Font("Default", 13, Font::plain));
+	valueLabel->setBounds(70, y, 110, 18);
+	valueLabel->setColour(Label::textColourId, Colours::white);
+	valueLabel->setColour(Label::backgroundColourId, Colours::grey);
+	valueLabel->setEditable(editable);
+	valueLabel->addListener(this);
+	addAndMakeVisible(valueLabel);
+	m_labels.add(valueLabel);
+	return valueLabel;
+}
+
+void SharedMemoryPublisherEditor::labelTextChanged(Label* label)
+{
+	if (label == m_nameLabel)
+		m_processor->setSegmentName(label->getText());
+	else if (label == m_ringLabel)
+		m_processor->setRingSeconds(label->getText().getFloatValue());
+	updateLabels();
+}
+
+void SharedMemoryPublisherEditor::updateLabels()
+{
+	m_nameLabel->setText(m_processor->getSegmentName(), dontSendNotification);
+	m_ringLabel->setText(String(m_processor->getRingSeconds()), dontSendNotification);
+}
+
+void SharedMemoryPublisherEditor::updateStatusLabel()
+{
+	int numChannels = m_processor->getNumPublishedChannels();
+	if (numChannels == 0)
+	{
+		m_statusLabel->setText("Not publishing", dontSendNotification);
+		return;
+	}
+	float sampleRate = m_processor->getPublishedSampleRate();
+	double seconds = sampleRate > 0 ? m_processor->getSamplesWritten() / sampleRate : 0;
+	m_statusLabel->setText(String(numChannels) + " ch at " + String(sampleRate) + " Hz\n"
+		+ String(seconds, 1) + " s published", dontSendNotification);
+}
+
+void SharedMemoryPublisherEditor::startAcquisition()
+{
+	m_nameLabel->setEditable(false);
+	m_ringLabel->setEditable(false);
+	m_statusMonitor.startTimer(500);
+}
+
+void SharedMemoryPublisherEditor::stopAcquisition()
+{
+	m_statusMonitor.stopTimer();
+	updateStatusLabel();
+	m_nameLabel->setEditable(true);
+	m_ringLabel->setEditable(true);
+}
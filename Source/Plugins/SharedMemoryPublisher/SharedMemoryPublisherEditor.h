@@ -0,0 +1,77 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHAREDMEMORYPUBLISHEREDITOR_H_INCLUDED
+#define SHAREDMEMORYPUBLISHEREDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+class SharedMemoryPublisher;
+
+/**
+	User interface for the Shared Memory Publisher: segment name, ring length and
+	what is being published.
+
+	@see SharedMemoryPublisher
+*/
+class SharedMemoryPublisherEditor : public GenericEditor, public Label::Listener
+{
+public:
+	SharedMemoryPublisherEditor(SharedMemoryPublisher* parentNode);
+	~SharedMemoryPublisherEditor();
+
+	void labelTextChanged(Label* label) override;
+
+	void startAcquisition() override;
+	void stopAcquisition() override;
+
+	/** Rewrites the labels from the processor settings */
+	void updateLabels();
+
+	/** Shows the published channels and samples written */
+	void updateStatusLabel();
+
+private:
+	/** GenericEditor's own timer drives the fade-in, so the status gets a separate one */
+	class StatusMonitor : public Timer
+	{
+	public:
+		StatusMonitor(SharedMemoryPublisherEditor& e) : editor(e) {}
+		void timerCallback() override { editor.updateStatusLabel(); }
+	private:
+		SharedMemoryPublisherEditor& editor;
+	};
+
+	Label* addLabel(const String& name, int y, bool editable);
+
+	SharedMemoryPublisher* m_processor;
+	OwnedArray<Label> m_labels;
+	Label* m_nameLabel;
+	Label* m_ringLabel;
+	Label* m_statusLabel;
+	StatusMonitor m_statusMonitor;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedMemoryPublisherEditor);
+};
+
+#endif
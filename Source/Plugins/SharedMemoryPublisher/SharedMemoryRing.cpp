@@ -0,0 +1,345 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SharedMemoryRing.h"
+#include <atomic>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+#endif
+
+static_assert(sizeof(oe_shm_header) == 192, "oe_shm_header layout changed");
+static_assert(sizeof(oe_shm_channel) == 64, "oe_shm_channel layout changed");
+
+namespace
+{
+	const size_t segmentAlignment = 64;
+
+	size_t alignSize(size_t size)
+	{
+		return (size + segmentAlignment - 1) & ~(segmentAlignment - 1);
+	}
+
+	String getSystemName(const String& name)
+	{
+#ifdef _WIN32
+		return "Local\\" + name;
+#else
+		return "/" + name;
+#endif
+	}
+}
+
+SharedMemoryRing::SharedMemoryRing() :
+m_size(0),
+m_memory(nullptr),
+#ifdef _WIN32
+m_handle(nullptr),
+#endif
+m_header(nullptr),
+m_timestamps(nullptr),
+m_data(nullptr),
+m_numChannels(0),
+m_capacity(0),
+m_writeIndex(0)
+{
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+	close();
+}
+
+int SharedMemoryRing::getRingCapacity(int minSamples)
+{
+	int capacity = 1024;
+	while (capacity < minSamples && capacity < (1 << 28))
+		capacity <<= 1;
+	return capacity;
+}
+
+int64 SharedMemoryRing::getMonotonicTimeNs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER ticks, frequency;
+	QueryPerformanceCounter(&ticks);
+	QueryPerformanceFrequency(&frequency);
+	return int64(double(ticks.QuadPart) * 1.0e9 / double(frequency.QuadPart));
+#elif defined(__APPLE__)
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0)
+		mach_timebase_info(&timebase);
+	return int64(mach_absolute_time() * timebase.numer / timebase.denom);
+#else
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return int64(t.tv_sec) * 1000000000 + t.tv_nsec;
+#endif
+}
+
+bool SharedMemoryRing::create(const String& name, const Array<oe_shm_channel>& channels, double sampleRate,
+	int capacity, String& errorMessage)
+{
+	jassert(isPowerOfTwo(capacity));
+	int numChannels = channels.size();
+
+	size_t channelTableOffset = alignSize(sizeof(oe_shm_header));
+	size_t timestampOffset = alignSize(channelTableOffset + numChannels * sizeof(oe_shm_channel));
+	size_t dataOffset = alignSize(timestampOffset + capacity * sizeof(int64));
+	size_t size = alignSize(dataOffset + size_t(numChannels) * capacity * sizeof(float));
+
+	//a restart with the same layout keeps the segment, so attached readers just see a new session
+	if (isOpen() && name == m_name && size == m_size && numChannels == m_numChannels && capacity == m_capacity
+		&& m_header->sampleRate == sampleRate
+		&& memcmp(channels.begin(), addBytesToPointer(m_memory, channelTableOffset), numChannels * sizeof(oe_shm_channel)) == 0)
+		return true;
+
+	close();
+	if (!map(name, size, errorMessage))
+		return false;
+
+	m_header = static_cast<oe_shm_header*>(m_memory);
+	m_timestamps = addBytesToPointer(static_cast<int64*>(m_memory), timestampOffset);
+	m_data = addBytesToPointer(static_cast<float*>(m_memory), dataOffset);
+	m_numChannels = numChannels;
+	m_capacity = capacity;
+	m_writeIndex = 0;
+
+	zeromem(m_memory, size);
+	memcpy(addBytesToPointer(m_memory, channelTableOffset), channels.begin(), numChannels * sizeof(oe_shm_channel));
+	m_header->version = OE_SHM_VERSION;
+	m_header->numChannels = numChannels;
+	m_header->capacity = capacity;
+	m_header->maxBlockSamples = capacity / 4;
+	m_header->segmentSize = size;
+	m_header->channelTableOffset = channelTableOffset;
+	m_header->timestampOffset = timestampOffset;
+	m_header->dataOffset = dataOffset;
+	m_header->sampleRate = sampleRate;
+	m_header->session = Random::getSystemRandom().nextInt();
+
+	//readers check the magic last
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->magic = OE_SHM_MAGIC;
+	return true;
+}
+
+bool SharedMemoryRing::map(const String& name, size_t size, String& errorMessage)
+{
+	String systemName = getSystemName(name);
+#ifdef _WIN32
+	HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		DWORD(uint64(size) >> 32), DWORD(size & 0xffffffff), systemName.toRawUTF8());
+	if (handle == nullptr)
+	{
+		errorMessage = "Could not create " + systemName + ": error " + String(int(GetLastError()));
+		return false;
+	}
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		//the mapping lives as long as a reader holds it, and its size cannot change
+		CloseHandle(handle);
+		errorMessage = systemName + " is still open in another process. Close the readers to change the channels";
+		return false;
+	}
+	void* memory = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (memory == nullptr)
+	{
+		CloseHandle(handle);
+		errorMessage = "Could not map " + systemName + ": error " + String(int(GetLastError()));
+		return false;
+	}
+	m_handle = handle;
+#else
+	//a segment left behind with the same name, by this or another instance, is flagged for its readers and replaced
+	int fd = shm_open(systemName.toRawUTF8(), O_RDWR, 0);
+	if (fd >= 0)
+	{
+		struct stat st;
+		if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(oe_shm_header))
+		{
+			void* old = mmap(nullptr, sizeof(oe_shm_header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (old != MAP_FAILED)
+			{
+				oe_shm_header* header = static_cast<oe_shm_header*>(old);
+				if (header->magic == OE_SHM_MAGIC)
+					header->closed = 1;
+				munmap(old, sizeof(oe_shm_header));
+			}
+		}
+		::close(fd);
+		shm_unlink(systemName.toRawUTF8());
+	}
+
+	fd = shm_open(systemName.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0666);
+	if (fd < 0)
+	{
+		errorMessage = "Could not create " + systemName + ": " + String(strerror(errno));
+		return false;
+	}
+	if (ftruncate(fd, off_t(size)) != 0)
+	{
+		errorMessage = "Could not allocate " + String(size / 1048576.0, 1) + " MB for " + systemName + ": " + String(strerror(errno));
+		::close(fd);
+		shm_unlink(systemName.toRawUTF8());
+		return false;
+	}
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED)
+	{
+		errorMessage = "Could not map " + systemName + ": " + String(strerror(errno));
+		shm_unlink(systemName.toRawUTF8());
+		return false;
+	}
+#endif
+	m_memory = memory;
+	m_size = size;
+	m_name = name;
+	return true;
+}
+
+void SharedMemoryRing::close()
+{
+	if (!isOpen())
+		return;
+
+	m_header->running = 0;
+	m_header->closed = 1;
+	unmap();
+}
+
+void SharedMemoryRing::unmap()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(m_memory);
+	CloseHandle(m_handle);
+	m_handle = nullptr;
+#else
+	munmap(m_memory, m_size);
+	//readers keep their mapping, the name goes away
+	shm_unlink(getSystemName(m_name).toRawUTF8());
+#endif
+	m_memory = nullptr;
+	m_header = nullptr;
+	m_timestamps = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+	m_numChannels = 0;
+	m_capacity = 0;
+}
+
+bool SharedMemoryRing::isOpen() const
+{
+	return m_memory != nullptr;
+}
+
+void SharedMemoryRing::start()
+{
+	if (!isOpen())
+		return;
+
+	uint32 sequence = m_header->sequence;
+	m_header->sequence = sequence + 1;
+	std::atomic_thread_fence(std::memory_order_release);
+	m_writeIndex = 0;
+	m_header->writeIndex = 0;
+	m_header->session = m_header->session + 1;
+	m_header->running = 1;
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->sequence = sequence + 2;
+}
+
+void SharedMemoryRing::stop()
+{
+	if (isOpen())
+		m_header->running = 0;
+}
+
+void SharedMemoryRing::write(const float* const* channelData, int nSamples, int64 firstTimestamp)
+{
+	if (!isOpen())
+		return;
+
+	//readers only have to check for overwrites of one block past the write index
+	int maxBlock = m_capacity / 4;
+	for (int offset = 0; offset < nSamples; offset += maxBlock)
+		writeBlock(channelData, offset, jmin(maxBlock, nSamples - offset), firstTimestamp + offset);
+}
+
+void SharedMemoryRing::writeBlock(const float* const* channelData, int offset, int nSamples, int64 firstTimestamp)
+{
+	uint32 sequence = m_header->sequence;
+	m_header->sequence = sequence + 1;
+	std::atomic_thread_fence(std::memory_order_release);
+
+	int mask = m_capacity - 1;
+	int start = int(m_writeIndex & mask);
+	int firstPart = jmin(nSamples, m_capacity - start);
+
+	for (int i = 0; i < firstPart; i++)
+		m_timestamps[start + i] = firstTimestamp + i;
+	for (int i = firstPart; i < nSamples; i++)
+		m_timestamps[i - firstPart] = firstTimestamp + i;
+
+	for (int ch = 0; ch < m_numChannels; ch++)
+	{
+		float* ring = m_data + size_t(ch) * m_capacity;
+		const float* src = channelData[ch] + offset;
+		memcpy(ring + start, src, firstPart * sizeof(float));
+		if (firstPart < nSamples)
+			memcpy(ring, src + firstPart, (nSamples - firstPart) * sizeof(float));
+	}
+
+	m_writeIndex += nSamples;
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->writeIndex = m_writeIndex;
+	m_header->publishTimeNs = getMonotonicTimeNs();
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->sequence = sequence + 2;
+}
+
+uint64 SharedMemoryRing::getWriteIndex() const
+{
+	return m_writeIndex;
+}
+
+int SharedMemoryRing::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+int SharedMemoryRing::getCapacity() const
+{
+	return m_capacity;
+}
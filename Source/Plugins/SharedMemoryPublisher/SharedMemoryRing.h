@@ -0,0 +1,97 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHAREDMEMORYRING_H_INCLUDED
+#define SHAREDMEMORYRING_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include "SharedMemoryLayout.h"
+
+/**
+	Writer side of the shared memory segment described in SharedMemoryLayout.h.
+
+	The segment is a POSIX shared memory object (a named file mapping on Windows).
+	Samples go straight from the processor's buffer into the ring, one memcpy per
+	channel and block, so the only copy is the one readers need anyway.
+
+	Only the processing thread writes to the ring. create() and close() are called
+	while acquisition is stopped.
+
+	@see SharedMemoryPublisher
+*/
+class SharedMemoryRing
+{
+public:
+	SharedMemoryRing();
+	~SharedMemoryRing();
+
+	/** Creates, or reuses if it has the same layout, the segment with the given name.
+	Returns false and fills errorMessage if it could not be mapped. */
+	bool create(const String& name, const Array<oe_shm_channel>& channels, double sampleRate,
+		int capacity, String& errorMessage);
+
+	/** Marks the segment as closed for the readers and removes its name */
+	void close();
+
+	bool isOpen() const;
+
+	/** Starts a new session: readers restart from writeIndex 0 */
+	void start();
+	void stop();
+
+	/** Appends nSamples samples. channelData has one pointer per published channel. */
+	void write(const float* const* channelData, int nSamples, int64 firstTimestamp);
+
+	uint64 getWriteIndex() const;
+	int getNumChannels() const;
+	int getCapacity() const;
+
+	/** Smallest power of two holding at least the given number of samples */
+	static int getRingCapacity(int minSamples);
+
+	/** Same clock as the client library, comparable between processes */
+	static int64 getMonotonicTimeNs();
+
+private:
+	bool map(const String& name, size_t size, String& errorMessage);
+	void unmap();
+	void writeBlock(const float* const* channelData, int offset, int nSamples, int64 firstTimestamp);
+
+	String m_name;
+	size_t m_size;
+	void* m_memory;
+#ifdef _WIN32
+	void* m_handle;
+#endif
+
+	oe_shm_header* m_header;
+	int64* m_timestamps;
+	float* m_data;
+	int m_numChannels;
+	int m_capacity;
+	uint64 m_writeIndex;
+
+	JUCE_DECLARE_NON_COPYABLE(SharedMemoryRing);
+};
+
+#endif
@@ -0,0 +1,259 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "oe_shm_client.h"
+
+#include <string.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#define OE_SHM_ACQUIRE() MemoryBarrier()
+#define OE_SHM_PAUSE() YieldProcessor()
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+#define OE_SHM_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#if defined(__i386__) || defined(__x86_64__)
+#define OE_SHM_PAUSE() __builtin_ia32_pause()
+#else
+#define OE_SHM_PAUSE() ((void)0)
+#endif
+#endif
+
+int64_t oe_shm_clock_ns(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER ticks, frequency;
+	QueryPerformanceCounter(&ticks);
+	QueryPerformanceFrequency(&frequency);
+	return (int64_t)((double)ticks.QuadPart * 1.0e9 / (double)frequency.QuadPart);
+#elif defined(__APPLE__)
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0)
+		mach_timebase_info(&timebase);
+	return (int64_t)(mach_absolute_time() * timebase.numer / timebase.denom);
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+#endif
+}
+
+static void unmap_segment(oe_shm_reader* reader)
+{
+#ifdef _WIN32
+	if (reader->header)
+		UnmapViewOfFile(reader->header);
+	if (reader->handle)
+		CloseHandle(reader->handle);
+#else
+	if (reader->header)
+		munmap((void*)reader->header, reader->size);
+#endif
+	memset(reader, 0, sizeof(*reader));
+}
+
+int oe_shm_open(oe_shm_reader* reader, const char* name)
+{
+	char systemName[256];
+	const oe_shm_header* header;
+	const char* base;
+
+	memset(reader, 0, sizeof(*reader));
+
+#ifdef _WIN32
+	{
+		MEMORY_BASIC_INFORMATION info;
+		snprintf(systemName, sizeof(systemName), "Local\\%s", name);
+		reader->handle = OpenFileMappingA(FILE_MAP_READ, FALSE, systemName);
+		if (reader->handle == NULL)
+			return OE_SHM_NOT_FOUND;
+		header = (const oe_shm_header*)MapViewOfFile(reader->handle, FILE_MAP_READ, 0, 0, 0);
+		if (header == NULL)
+		{
+			unmap_segment(reader);
+			return OE_SHM_ERROR;
+		}
+		reader->header = header;
+		VirtualQuery(header, &info, sizeof(info));
+		reader->size = info.RegionSize;
+	}
+#else
+	{
+		struct stat st;
+		void* memory;
+		int fd;
+		snprintf(systemName, sizeof(systemName), "/%s", name);
+		fd = shm_open(systemName, O_RDONLY, 0);
+		if (fd < 0)
+			return OE_SHM_NOT_FOUND;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(oe_shm_header))
+		{
+			close(fd);
+			return OE_SHM_NOT_FOUND;
+		}
+		memory = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (memory == MAP_FAILED)
+			return OE_SHM_ERROR;
+		reader->header = header = (const oe_shm_header*)memory;
+		reader->size = (size_t)st.st_size;
+	}
+#endif
+
+	/* the publisher writes the magic once everything else is in place */
+	if (header->magic != OE_SHM_MAGIC)
+	{
+		unmap_segment(reader);
+		return OE_SHM_NOT_FOUND;
+	}
+	OE_SHM_ACQUIRE();
+	if (header->version != OE_SHM_VERSION || header->segmentSize > reader->size)
+	{
+		unmap_segment(reader);
+		return OE_SHM_BAD_VERSION;
+	}
+
+	base = (const char*)header;
+	reader->channels = (const oe_shm_channel*)(base + header->channelTableOffset);
+	reader->timestamps = (const int64_t*)(base + header->timestampOffset);
+	reader->data = (const float*)(base + header->dataOffset);
+	reader->session = header->session;
+	/* start with what is published from now on */
+	reader->cursor = header->writeIndex;
+	return OE_SHM_OK;
+}
+
+void oe_shm_close(oe_shm_reader* reader)
+{
+	unmap_segment(reader);
+}
+
+int oe_shm_num_channels(const oe_shm_reader* reader)
+{
+	return (int)reader->header->numChannels;
+}
+
+double oe_shm_sample_rate(const oe_shm_reader* reader)
+{
+	return reader->header->sampleRate;
+}
+
+const oe_shm_channel* oe_shm_channel_info(const oe_shm_reader* reader, int channel)
+{
+	if (channel < 0 || channel >= (int)reader->header->numChannels)
+		return NULL;
+	return reader->channels + channel;
+}
+
+int oe_shm_is_running(const oe_shm_reader* reader)
+{
+	return reader->header->running != 0 && reader->header->closed == 0;
+}
+
+uint64_t oe_shm_available(const oe_shm_reader* reader)
+{
+	const oe_shm_header* header = reader->header;
+	uint64_t writeIndex = header->writeIndex;
+	uint64_t readable = header->capacity - header->maxBlockSamples;
+
+	if (header->session != reader->session)
+		return writeIndex;
+	if (writeIndex < reader->cursor)
+		return 0;
+	return writeIndex - reader->cursor > readable ? readable : writeIndex - reader->cursor;
+}
+
+static void copy_ring(const void* ring, void* dest, size_t elementSize, uint32_t capacity, uint64_t start, int count)
+{
+	uint32_t pos = (uint32_t)(start & (capacity - 1));
+	uint32_t first = capacity - pos < (uint32_t)count ? capacity - pos : (uint32_t)count;
+
+	memcpy(dest, (const char*)ring + pos * elementSize, first * elementSize);
+	if (first < (uint32_t)count)
+		memcpy((char*)dest + first * elementSize, ring, (count - first) * elementSize);
+}
+
+int oe_shm_read(oe_shm_reader* reader, float* data, int64_t* timestamps, int maxSamples)
+{
+	const oe_shm_header* header = reader->header;
+	uint32_t capacity = header->capacity;
+	uint64_t maxBlock = header->maxBlockSamples;
+	/* the next block may overwrite the oldest maxBlock samples while they are copied */
+	uint64_t readable = capacity - maxBlock;
+
+	for (;;)
+	{
+		uint32_t sequence, session, c;
+		uint64_t writeIndex, start, lost = 0;
+		int count;
+
+		if (header->closed)
+			return OE_SHM_CLOSED;
+
+		sequence = header->sequence;
+		OE_SHM_ACQUIRE();
+		if (sequence & 1)
+		{
+			OE_SHM_PAUSE();
+			continue;
+		}
+		session = header->session;
+		writeIndex = header->writeIndex;
+
+		start = session == reader->session ? reader->cursor : 0;
+		if (start > writeIndex)
+			start = writeIndex;
+		if (writeIndex - start > readable)
+		{
+			lost = writeIndex - readable - start;
+			start = writeIndex - readable;
+		}
+		count = writeIndex - start < (uint64_t)maxSamples ? (int)(writeIndex - start) : maxSamples;
+
+		for (c = 0; c < header->numChannels; c++)
+			copy_ring(reader->data + (size_t)c * capacity, data + (size_t)c * maxSamples, sizeof(float), capacity, start, count);
+		if (timestamps)
+			copy_ring(reader->timestamps, timestamps, sizeof(int64_t), capacity, start, count);
+
+		OE_SHM_ACQUIRE();
+		if (header->sequence != sequence)
+		{
+			/* blocks were written meanwhile: the copy is good if none of them reached back to it */
+			if (header->session != session || header->writeIndex + maxBlock > start + capacity)
+				continue;
+		}
+
+		reader->session = session;
+		reader->cursor = start + count;
+		reader->samplesLost += lost;
+		return count;
+	}
+}
@@ -0,0 +1,108 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef OE_SHM_CLIENT_H_INCLUDED
+#define OE_SHM_CLIENT_H_INCLUDED
+
+/*
+	Reads the continuous data published by the Shared Memory plugin of the Open Ephys GUI.
+	Plain C with no dependencies, so it can be built into any process on the same machine:
+
+		cc -O2 -c oe_shm_client.c           (add -lrt when linking on Linux)
+
+	A reader keeps its own position in the stream, so any number of them can attach.
+	The typical loop is
+
+		oe_shm_reader reader;
+		if (oe_shm_open(&reader, "open-ephys") == OE_SHM_OK)
+			for (;;)
+			{
+				int n = oe_shm_read(&reader, samples, timestamps, maxSamples);
+				if (n == OE_SHM_CLOSED) reopen...
+				...
+			}
+
+	Samples are floats in microvolts, as in the GUI. The publisher never waits for
+	readers: one that falls more than a ring behind skips ahead and the skipped samples
+	are counted in samplesLost.
+*/
+
+#include <stddef.h>
+#include "../SharedMemoryLayout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	OE_SHM_OK = 0,
+	OE_SHM_ERROR = -1,        /* the segment could not be mapped */
+	OE_SHM_NOT_FOUND = -2,    /* no segment with that name, or not initialized yet */
+	OE_SHM_BAD_VERSION = -3,  /* written by an incompatible version of the plugin */
+	OE_SHM_CLOSED = -4        /* the publisher closed or replaced the segment, open it again */
+};
+
+typedef struct oe_shm_reader
+{
+	const oe_shm_header* header;
+	const oe_shm_channel* channels;
+	const int64_t* timestamps;
+	const float* data;
+	size_t size;
+	void* handle;
+
+	uint32_t session;
+	uint64_t cursor;         /* index of the next sample to read */
+	uint64_t samplesLost;    /* samples overwritten before they could be read */
+} oe_shm_reader;
+
+/* Maps the segment with the given name. Returns OE_SHM_OK or one of the errors above */
+int oe_shm_open(oe_shm_reader* reader, const char* name);
+
+void oe_shm_close(oe_shm_reader* reader);
+
+int oe_shm_num_channels(const oe_shm_reader* reader);
+double oe_shm_sample_rate(const oe_shm_reader* reader);
+const oe_shm_channel* oe_shm_channel_info(const oe_shm_reader* reader, int channel);
+
+/* Nonzero while the GUI is acquiring */
+int oe_shm_is_running(const oe_shm_reader* reader);
+
+/* Number of samples written and not read yet, ignoring those already overwritten */
+uint64_t oe_shm_available(const oe_shm_reader* reader);
+
+/* Copies up to maxSamples new samples of every channel, channel after channel:
+   channel c, sample i goes to data[c * maxSamples + i]. timestamps, which may be NULL,
+   receives one timestamp per sample. Returns the number of samples copied (0 if there
+   is nothing new) or OE_SHM_CLOSED. A new acquisition restarts the reader at sample 0. */
+int oe_shm_read(oe_shm_reader* reader, float* data, int64_t* timestamps, int maxSamples);
+
+/* Monotonic clock in nanoseconds, the one the publisher uses for publishTimeNs */
+int64_t oe_shm_clock_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Measures how long published blocks take to reach a reader in another process.
+
+		cc -O2 -o shm_latency_benchmark shm_latency_benchmark.c oe_shm_client.c -lrt
+		./shm_latency_benchmark [name] [seconds]
+
+	Start acquisition in the GUI with a Shared Memory processor in the signal chain,
+	then run the benchmark. It spins on the segment and, every time new samples show up,
+	takes the difference between its clock and the publish time of the newest block.
+	Spinning gives the best case; a reader that sleeps adds its wake-up latency.
+*/
+
+#include "oe_shm_client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int compare_int64(const void* a, const void* b)
+{
+	int64_t x = *(const int64_t*)a;
+	int64_t y = *(const int64_t*)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+int main(int argc, char** argv)
+{
+	const char* name = argc > 1 ? argv[1] : OE_SHM_DEFAULT_NAME;
+	double seconds = argc > 2 ? atof(argv[2]) : 10.0;
+	const int maxSamples = 4096;
+	const size_t maxLatencies = 1 << 20;
+
+	oe_shm_reader reader;
+	float* data;
+	int64_t* timestamps;
+	int64_t* latencies;
+	size_t numLatencies = 0;
+	uint64_t samplesRead = 0;
+	int64_t start, end;
+	int status;
+
+	status = oe_shm_open(&reader, name);
+	if (status != OE_SHM_OK)
+	{
+		fprintf(stderr, "Could not open shared memory segment '%s' (%d)\n", name, status);
+		return 1;
+	}
+	printf("%s: %d channels at %g Hz, ring of %u samples\n", name, oe_shm_num_channels(&reader),
+		oe_shm_sample_rate(&reader), reader.header->capacity);
+
+	data = (float*)malloc(sizeof(float) * maxSamples * oe_shm_num_channels(&reader));
+	timestamps = (int64_t*)malloc(sizeof(int64_t) * maxSamples);
+	latencies = (int64_t*)malloc(sizeof(int64_t) * maxLatencies);
+	if (!data || !timestamps || !latencies)
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	start = oe_shm_clock_ns();
+	end = start + (int64_t)(seconds * 1e9);
+	while (oe_shm_clock_ns() < end)
+	{
+		int n = oe_shm_read(&reader, data, timestamps, maxSamples);
+		if (n == OE_SHM_CLOSED)
+		{
+			fprintf(stderr, "The publisher closed the segment\n");
+			break;
+		}
+		if (n > 0)
+		{
+			/* only whole blocks count, not the rest of one that did not fit in the buffer */
+			if (oe_shm_available(&reader) == 0 && numLatencies < maxLatencies)
+			{
+				int64_t published = reader.header->publishTimeNs;
+				latencies[numLatencies++] = oe_shm_clock_ns() - published;
+			}
+			samplesRead += n;
+		}
+	}
+
+	if (numLatencies == 0)
+	{
+		printf("No data received. Is acquisition running?\n");
+	}
+	else
+	{
+		qsort(latencies, numLatencies, sizeof(int64_t), compare_int64);
+		printf("%lu blocks, %llu samples read, %llu lost\n", (unsigned long)numLatencies,
+			(unsigned long long)samplesRead, (unsigned long long)reader.samplesLost);
+		printf("latency (us): min %.1f  median %.1f  99%% %.1f  99.9%% %.1f  max %.1f\n",
+			latencies[0] / 1000.0,
+			latencies[numLatencies / 2] / 1000.0,
+			latencies[(size_t)(numLatencies * 0.99)] / 1000.0,
+			latencies[(size_t)(numLatencies * 0.999)] / 1000.0,
+			latencies[numLatencies - 1] / 1000.0);
+	}
+
+	free(data);
+	free(timestamps);
+	free(latencies);
+	oe_shm_close(&reader);
+	return 0;
+}
@@ -26,166 +26,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "SpikeSortBoxes.h"
 #include "SpikeSorter.h"
 
-PointD::PointD()
-{
-    X = Y = 0;
-}
-
-
-PointD::PointD(float x, float y)
-{
-    X = x;
-    Y = y;
-}
-
-PointD::PointD(const PointD& P)
-{
-    X = P.X;
-    Y = P.Y;
-}
-
-PointD& PointD::operator+=(const PointD& rhs)
-{
-    X += rhs.X;
-    Y += rhs.Y;
-    return *this;
-}
-
-PointD& PointD::operator-=(const PointD& rhs)
-{
-    X -= rhs.X;
-    Y -= rhs.Y;
-    return *this;
-}
-
-const PointD PointD::operator+(const PointD& other) const
-{
-    PointD result = *this;
-    result += other;
-    return result;
-}
-
-
-const PointD PointD::operator-(const PointD& other) const
-{
-    PointD result = *this;
-    result -= other;
-    return result;
-}
-
-
-const PointD PointD::operator*(const PointD& other) const
-{
-    PointD result = *this;
-    result.X *= other.X;
-    result.Y *= other.Y;
-    return result;
-
-}
-
-float PointD::cross(PointD c) const
-{
-    return X*c.Y-Y*c.X;
-}
-
-/**************************************/
-
-
-Box::Box()
-{
-    x = -0.2; // in ms
-    y = -10; // in uV
-    w = 0.5; // in ms
-    h = 70; // in uV
-    channel=0;
-}
-
-
-Box::Box(int ch)
-{
-    x = -0.2; // in ms
-    y = -10; // in uV
-    w = 0.5; // in ms
-    h = 70; // in uV
-    channel = ch;
-}
-
-Box::Box(float X, float Y, float W, float H, int ch)
-{
-    x = X;
-    y = Y;
-    w = W;
-    h = H;
-    channel = ch;
-}
-
-bool Box::LineSegmentIntersection(PointD p11, PointD p12, PointD p21, PointD p22)
-{
-    PointD r = (p12 - p11);
-    PointD s = (p22 - p21);
-    PointD q = p21;
-    PointD p = p11;
-    double rs = r.cross(s);
-    double eps = 1e-6;
-    if (fabs(rs) < eps)
-        return false; // lines are parallel
-    double t = (q - p).cross(s) / rs;
-    double u = (q - p).cross(r) / rs;
-    return (t>=0&&t<=1 &&u>0&&u<=1);
-}
-
-#ifndef MAX
-#define MAX(x,y)((x)>(y))?(x):(y)
-#endif
-
-#ifndef MIN
-#define MIN(x,y)((x)<(y))?(x):(y)
-#endif
-
-bool Box::isWaveFormInside(SorterSpikePtr so)
-{
-    PointD BoxTopLeft(x, y);
-    PointD BoxBottomLeft(x, (y - h));
-
-    PointD BoxTopRight(x + w, y);
-    PointD BoxBottomRight(x + w, (y - h));
-
-    // y,and h are given in micro volts.
-    // x and w and given in micro seconds.
-
-    // no point testing all wave form points. Just ones that are between x and x+w...
-    int BinLeft = microSecondsToSpikeTimeBin(so,x);
-    int BinRight = microSecondsToSpikeTimeBin(so,x+w);
-
-    /*
-    float minValue=1e10, maxValue=1e-10;
-    for (int pt = 0; pt < so->nSamples; pt++)
-    {
-    	float v = spikeDataBinToMicrovolts(so, pt, channel);
-    	minValue = MIN(minValue,v);
-    	maxValue = MAX(maxValue,v);
-    }
-    */
-
-    for (int pt = BinLeft; pt < BinRight; pt++)
-    {
-        PointD Pwave1(spikeTimeBinToMicrosecond(so,pt),spikeDataBinToMicrovolts(so, pt, channel));
-        PointD Pwave2(spikeTimeBinToMicrosecond(so,pt+1),spikeDataBinToMicrovolts(so, pt+1, channel));
-
-        bool bLeft = LineSegmentIntersection(Pwave1,Pwave2,BoxTopLeft,BoxBottomLeft) ;
-        bool bRight = LineSegmentIntersection(Pwave1,Pwave2,BoxTopRight,BoxBottomRight);
-        bool bTop = LineSegmentIntersection(Pwave1,Pwave2,BoxTopLeft,BoxTopRight);
-        bool bBottom = LineSegmentIntersection(Pwave1, Pwave2, BoxBottomLeft, BoxBottomRight);
-        if (bLeft || bRight || bTop || bBottom)
-        {
-            return true;
-        }
-
-    }
-    return false;
-}
-
-
 BoxUnit::BoxUnit()
 {
 
@@ -230,12 +70,7 @@ BoxUnit::BoxUnit(Box B, int ID, int localID_) : UnitID(ID), localID(localID_)
 
 bool BoxUnit::isWaveFormInsideAllBoxes(SorterSpikePtr so)
 {
-    for (int k=0; k< lstBoxes.size(); k++)
-    {
-        if (!lstBoxes[k].isWaveFormInside(so))
-            return false;
-    }
-    return lstBoxes.size() == 0 ? false : true;
+    return Box::isWaveFormInsideAll(lstBoxes, so->getData(), so->getChannel()->getSampleRate(), so->getChannel()->getTotalSamples());
 }
 
 bool BoxUnit::isActivated()
@@ -611,6 +446,9 @@ SpikeSortBoxes::SpikeSortBoxes(UniqueIDgenerator* uniqueIDgenerator_,PCAcomputin
     pc2max = 1;
     numChannels = numch;
     waveformLength = WaveFormLength;
+    maskSampleRate = SamplingRate;
+    maskTotalSamples = WaveFormLength;
+    spikesSinceTemplates = 0;
 
     pc1 = new float[numChannels * waveformLength];
     pc2 = new float[numChannels * waveformLength];
@@ -645,6 +483,11 @@ void SpikeSortBoxes::resizeWaveform(int numSamples)
     {
         boxUnits[k].resizeWaveform(waveformLength);
     }
+    maskTotalSamples = waveformLength;
+    compileBoxMasks();
+    templates = nullptr;
+    templateJob = nullptr;
+    spikesSinceTemplates = 0;
     //EndCriticalSection();
 }
 
@@ -754,6 +597,8 @@ void SpikeSortBoxes::loadCustomParametersFromXml(XmlElement* electrodeNode)
             }
         }
     }
+    compileBoxMasks();
+    compilePolygonMasks();
 }
 
 void SpikeSortBoxes::saveCustomParametersToXml(XmlElement* electrodeNode)
@@ -929,6 +774,7 @@ void SpikeSortBoxes::addPCAunit(PCAUnit unit)
     const ScopedLock myScopedLock(mut);
     //StartCriticalSection();
     pcaUnits.push_back(unit);
+    compilePolygonMasks();
     //EndCriticalSection();
 }
 
@@ -941,6 +787,7 @@ int SpikeSortBoxes::addBoxUnit(int channel)
     int unusedID = uniqueIDgenerator->generateUniqueID(); //generateUnitID();
     BoxUnit unit(unusedID, generateLocalID());
     boxUnits.push_back(unit);
+    compileBoxMasks();
     setSelectedUnitAndBox(unusedID, 0);
     //EndCriticalSection();
     return unusedID;
@@ -963,6 +810,7 @@ int SpikeSortBoxes::addBoxUnit(int channel, Box B)
     int unusedID = uniqueIDgenerator->generateUniqueID(); //generateUnitID();
     BoxUnit unit(B, unusedID,generateLocalID());
     boxUnits.push_back(unit);
+    compileBoxMasks();
     setSelectedUnitAndBox(unusedID, 0);
     //EndCriticalSection();
     return unusedID;
@@ -1052,6 +900,8 @@ void SpikeSortBoxes::removeAllUnits()
     const ScopedLock myScopedLock(mut);
     boxUnits.clear();
     pcaUnits.clear();
+    compileBoxMasks();
+    compilePolygonMasks();
 }
 
 bool SpikeSortBoxes::removeUnit(int unitID)
@@ -1063,6 +913,7 @@ bool SpikeSortBoxes::removeUnit(int unitID)
         if (boxUnits[k].getUnitID() == unitID)
         {
             boxUnits.erase(boxUnits.begin()+k);
+            compileBoxMasks();
             //EndCriticalSection();
             return true;
         }
@@ -1073,6 +924,7 @@ bool SpikeSortBoxes::removeUnit(int unitID)
         if (pcaUnits[k].getUnitID() == unitID)
         {
             pcaUnits.erase(pcaUnits.begin()+k);
+            compilePolygonMasks();
             //EndCriticalSection();
             return true;
         }
@@ -1098,6 +950,7 @@ bool SpikeSortBoxes::addBoxToUnit(int channel, int unitID)
             B.y -= 30;
             B.channel = channel;
             boxUnits[k].addBox(B);
+            compileBoxMasks();
             setSelectedUnitAndBox(unitID, (int) boxUnits[k].lstBoxes.size() - 1);
             // EndCriticalSection();
             return true;
@@ -1117,6 +970,7 @@ bool SpikeSortBoxes::addBoxToUnit(int channel, int unitID, Box B)
         if (boxUnits[k].getUnitID() == unitID)
         {
             boxUnits[k].addBox(B);
+            compileBoxMasks();
             // EndCriticalSection();
             return true;
         }
@@ -1149,6 +1003,7 @@ void SpikeSortBoxes::updatePCAUnits(std::vector<PCAUnit> _units)
     //StartCriticalSection();
     const ScopedLock myScopedLock(mut);
     pcaUnits = _units;
+    compilePolygonMasks();
     //EndCriticalSection();
 }
 
@@ -1157,22 +1012,55 @@ void SpikeSortBoxes::updateBoxUnits(std::vector<BoxUnit> _units)
     const ScopedLock myScopedLock(mut);
     //StartCriticalSection();
     boxUnits = _units;
+    compileBoxMasks();
     //EndCriticalSection();
 }
 
+void SpikeSortBoxes::compileBoxMasks()
+{
+    boxMasks.resize(boxUnits.size());
+    for (int k = 0; k < boxUnits.size(); k++)
+    {
+        boxMasks[k].compile(boxUnits[k].lstBoxes, maskSampleRate, maskTotalSamples);
+    }
+}
+
+void SpikeSortBoxes::compilePolygonMasks()
+{
+    polygonMasks.resize(pcaUnits.size());
+    for (int k = 0; k < pcaUnits.size(); k++)
+    {
+        polygonMasks[k].compile(pcaUnits[k].poly);
+    }
+}
+
 
 
 
 // tests whether a candidate spike belongs to one of the defined units
-bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
+bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst, bool useTemplates)
 {
     const ScopedLock myScopedLock(mut);
+
+    if (useTemplates)
+    {
+        updateTemplates();
+    }
+
+    // the masks were compiled for another waveform length or rate, only happens once
+    if (so->getChannel()->getSampleRate() != maskSampleRate
+        || so->getChannel()->getTotalSamples() != maskTotalSamples)
+    {
+        maskSampleRate = so->getChannel()->getSampleRate();
+        maskTotalSamples = so->getChannel()->getTotalSamples();
+        compileBoxMasks();
+    }
     if (PCAfirst)
     {
 
         for (int k=0; k<pcaUnits.size(); k++)
         {
-            if (pcaUnits[k].isWaveFormInsidePolygon(so))
+            if (polygonMasks[k].isPointInside(PointD(so->pcProj[0], so->pcProj[1])))
             {
                 so->sortedId = pcaUnits[k].getUnitID();
                 so->color[0] = pcaUnits[k].ColorRGB[0];
@@ -1184,7 +1072,7 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
 
         for (int k=0; k<boxUnits.size(); k++)
         {
-            if (boxUnits[k].isWaveFormInsideAllBoxes(so))
+            if (boxMasks[k].isWaveFormInside(so->getData(), so->getChannel()->getSampleRate(), so->getChannel()->getTotalSamples()))
             {
                 so->sortedId = boxUnits[k].getUnitID();
                 so->color[0] = boxUnits[k].ColorRGB[0];
@@ -1200,7 +1088,7 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
 
         for (int k=0; k<boxUnits.size(); k++)
         {
-            if (boxUnits[k].isWaveFormInsideAllBoxes(so))
+            if (boxMasks[k].isWaveFormInside(so->getData(), so->getChannel()->getSampleRate(), so->getChannel()->getTotalSamples()))
             {
                 so->sortedId = boxUnits[k].getUnitID();
                 so->color[0] = boxUnits[k].ColorRGB[0];
@@ -1212,7 +1100,7 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
         }
         for (int k=0; k<pcaUnits.size(); k++)
         {
-            if (pcaUnits[k].isWaveFormInsidePolygon(so))
+            if (polygonMasks[k].isPointInside(PointD(so->pcProj[0], so->pcProj[1])))
             {
                 so->sortedId = pcaUnits[k].getUnitID();
                 so->color[0] = pcaUnits[k].ColorRGB[0];
@@ -1225,9 +1113,47 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
 
     }
 
+    // spikes none of the drawn units took go to the closest learned template
+    if (useTemplates && templates != nullptr
+        && templates->getDimension() == so->getChannel()->getNumChannels() * so->getChannel()->getTotalSamples())
+    {
+        int index = templates->match(so->getData());
+        if (index >= 0)
+        {
+            const uint8* color = templates->getColor(index);
+            so->sortedId = templates->getUnitID(index);
+            so->color[0] = color[0];
+            so->color[1] = color[1];
+            so->color[2] = color[2];
+            return true;
+        }
+    }
+
     return false;
 }
 
+void SpikeSortBoxes::updateTemplates()
+{
+    if (templateJob != nullptr)
+    {
+        if (!templateJob->finished)
+            return;
+
+        // a single pointer swap, matching never sees a library being built
+        if (templateJob->result != nullptr)
+            templates = templateJob->result;
+        templateJob = nullptr;
+        spikesSinceTemplates = 0;
+    }
+
+    // learn again once the buffer holds only new spikes
+    if (++spikesSinceTemplates >= bufferSize)
+    {
+        templateJob = new TemplateJob(spikeBuffer, templates, uniqueIDgenerator);
+        computingThread->addTemplateJob(templateJob);
+    }
+}
+
 
 bool  SpikeSortBoxes::removeBoxFromUnit(int unitID, int boxIndex)
 {
@@ -1238,6 +1164,7 @@ bool  SpikeSortBoxes::removeBoxFromUnit(int unitID, int boxIndex)
         if (boxUnits[k].getUnitID() == unitID)
         {
             bool s= boxUnits[k].deleteBox(boxIndex);
+            compileBoxMasks();
             setSelectedUnitAndBox(-1,-1);
             //EndCriticalSection();
             return s;
@@ -1583,62 +1510,6 @@ int SpikeSortBoxes::getNumBoxes(int unitID)
 
 /**************************/
 
-cPolygon::cPolygon()
-{
-};
-
-bool cPolygon::isPointInside(PointD p)
-{
-    PointD p1, p2;
-
-    bool inside = false;
-
-    if (pts.size() < 3)
-    {
-        return inside;
-    }
-
-    PointD oldPoint(pts[pts.size()- 1].X + offset.X, pts[pts.size()- 1].Y + offset.Y);
-
-    for (int i = 0; i < pts.size(); i++)
-    {
-        PointD newPoint(pts[i].X + offset.X, pts[i].Y + offset.Y);
-
-        if (newPoint.X > oldPoint.X)
-        {
-            p1 = oldPoint;
-            p2 = newPoint;
-        }
-        else
-        {
-            p1 = newPoint;
-            p2 = oldPoint;
-        }
-
-        if ((newPoint.X < p.X) == (p.X <= oldPoint.X)
-            && ((p.Y - p1.Y) * (p2.X - p1.X)	< (p2.Y - p1.Y) * (p.X - p1.X)))
-        {
-            inside = !inside;
-        }
-
-        oldPoint = newPoint;
-    }
-
-    return inside;
-}
-
-
-
-
-
-
-
-
-
-/*****************/
-
-
-/*************************/
 PCAUnit::PCAUnit()
 {
 
@@ -2150,26 +2021,57 @@ void PCAcomputingThread::addPCAjob(PCAJobPtr job)
     {
         startThread();
     }
+    notify();
+}
+
+void PCAcomputingThread::addTemplateJob(TemplateJobPtr job)
+{
+	{
+		ScopedLock critical(lock);
+		templateJobs.add(job);
+	}
+
+    if (!isThreadRunning())
+    {
+        startThread();
+    }
+    notify();
 }
 
 void PCAcomputingThread::run()
 {
-    while (jobs.size() > 0)
+    while (!threadShouldExit())
     {
 		lock.enter();
         PCAJobPtr J = jobs.removeAndReturn(0);
-	if (J == nullptr) continue;
+        TemplateJobPtr T = templateJobs.removeAndReturn(0);
 		lock.exit();
-        // compute PCA
-        // 1. Compute Covariance matrix
-        // 2. Apply SVD on covariance matrix
-        // 3. Extract the two principal components corresponding to the largest singular values
 
-        J->computeCov();
-        J->computeSVD();
+        // a job added after the queues were found empty has already signalled, so this returns at once
+        if (J == nullptr && T == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
 
-        // 4. Report to the spike sorting electrode that PCA is finished
-        J->reportDone = true;
+        if (J != nullptr)
+        {
+            // compute PCA
+            // 1. Compute Covariance matrix
+            // 2. Apply SVD on covariance matrix
+            // 3. Extract the two principal components corresponding to the largest singular values
+
+            J->computeCov();
+            J->computeSVD();
+
+            // 4. Report to the spike sorting electrode that PCA is finished
+            J->reportDone = true;
+        }
+
+        if (T != nullptr)
+        {
+            T->run();
+        }
     }
 }
 
@@ -2179,6 +2081,71 @@ PCAcomputingThread::PCAcomputingThread() : Thread("PCA")
 
 }
 
+PCAcomputingThread::~PCAcomputingThread()
+{
+    // stopThread signals the thread to exit and wakes it up
+    stopThread(5000);
+}
+
+/**************************/
+
+TemplateJob::TemplateJob(SorterSpikeArray& _spikes, TemplateLibraryPtr _previous, UniqueIDgenerator* _uniqueIDgenerator)
+    : finished(false), spikes(_spikes), previous(_previous), uniqueIDgenerator(_uniqueIDgenerator)
+{
+}
+
+void TemplateJob::run()
+{
+    // the spikes that fill the buffer, all of the same length
+    std::vector<float> waveforms;
+    int dim = 0;
+    for (int k = 0; k < spikes.size(); k++)
+    {
+        SorterSpikePtr spike = spikes[k];
+        if (spike == nullptr)
+            continue;
+
+        int length = spike->getChannel()->getNumChannels() * spike->getChannel()->getTotalSamples();
+        if (dim == 0)
+            dim = length;
+        if (length != dim)
+            continue;
+
+        waveforms.insert(waveforms.end(), spike->getData(), spike->getData() + dim);
+    }
+    const int numSpikes = dim > 0 ? (int) waveforms.size() / dim : 0;
+
+    TemplateLearner learner;
+    const int numUnits = learner.learn(waveforms.data(), numSpikes, dim, previous);
+
+    TemplateLibraryPtr library = new TemplateLibrary(dim);
+    bool colorTaken[6] = { false, false, false, false, false, false };
+
+    for (int u = 0; u < numUnits; u++)
+    {
+        const int match = learner.getPreviousIndex(u);
+        if (match >= 0)
+        {
+            library->addTemplate(learner.getTemplate(u), learner.getMaxDistance(u), previous->getUnitID(match), previous->getColor(match));
+        }
+        else
+        {
+            uint8 color[3];
+            int colorIndex = 0;
+            while (colorIndex < 5 && colorTaken[colorIndex])
+                colorIndex++;
+            colorTaken[colorIndex] = true;
+            BoxUnit::setDefaultColors(color, colorIndex + 1);
+            library->addTemplate(learner.getTemplate(u), learner.getMaxDistance(u), uniqueIDgenerator->generateUniqueID(), color);
+        }
+    }
+
+    if (library->getNumTemplates() > 0)
+        result = library;
+
+    finished = true;
+}
+
 
 /**************************/
 
@@ -2199,8 +2166,8 @@ float spikeDataIndexToMicrovolts(SorterSpikePtr s, int index)
 
 float spikeTimeBinToMicrosecond(SorterSpikePtr s, int bin, int ch)
 {
-	float spikeTimeSpan = 1.0f / s->getChannel()->getSampleRate() * s->getChannel()->getTotalSamples() * 1e6;
-	return float(bin) / (s->getChannel()->getTotalSamples() - 1) * spikeTimeSpan;
+	unsigned int totalSamples = s->getChannel()->getTotalSamples();
+	return timeBinToMicrosecond(bin, getSpikeTimeSpan(s->getChannel()->getSampleRate(), totalSamples), totalSamples);
 }
 
 int microSecondsToSpikeTimeBin(SorterSpikePtr s, float t, int ch)
@@ -2208,8 +2175,8 @@ int microSecondsToSpikeTimeBin(SorterSpikePtr s, float t, int ch)
 	// Lets say we have 32 samples per wave form
 
 	// t = 0 corresponds to the left most index.
-	float spikeTimeSpan = (1.0f / s->getChannel()->getSampleRate() * s->getChannel()->getTotalSamples())*1e6;
-	return MIN(s->getChannel()->getTotalSamples() - 1, MAX(0, t / spikeTimeSpan * (s->getChannel()->getTotalSamples() - 1)));
+	unsigned int totalSamples = s->getChannel()->getTotalSamples();
+	return microSecondsToTimeBin(t, getSpikeTimeSpan(s->getChannel()->getSampleRate(), totalSamples), totalSamples);
 }
 
 
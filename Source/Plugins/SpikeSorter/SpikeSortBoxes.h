@@ -25,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define __SPIKESORTBOXES_H
 
 #include "SpikeSorterEditor.h"
+#include "SpikeTemplates.h"
+#include "SpikeSortGeometry.h"
 #include <algorithm>    // std::sort
 #include <list>
 #include <queue>
@@ -53,38 +55,6 @@ typedef ReferenceCountedArray<SorterSpikeContainer, CriticalSection> SorterSpike
 
 class PCAcomputingThread;
 class UniqueIDgenerator;
-class PointD
-{
-public:
-
-    PointD();
-    PointD(float x, float y);
-    PointD(const PointD& P);
-    const PointD operator+(const PointD& c1) const;
-    PointD& operator+=(const PointD& rhs);
-    PointD& operator-=(const PointD& rhs);
-
-
-    const PointD operator-(const PointD& c1) const;
-    const PointD operator*(const PointD& c1) const;
-
-    float cross(PointD c) const;
-    float X,Y;
-};
-
-
-class Box
-{
-public:
-    Box();
-    Box(int channel);
-    Box(float X, float Y, float W, float H, int ch=0);
-    bool LineSegmentIntersection(PointD p11, PointD p12, PointD p21, PointD p22);
-    bool isWaveFormInside(SorterSpikePtr so);
-    double x,y,w,h; // x&w and specified in microseconds. y&h in microvolts
-    int channel;
-};
-
 
 /************************/
 class Histogram
@@ -200,26 +170,42 @@ private:
 typedef ReferenceCountedObjectPtr<PCAjob> PCAJobPtr;
 typedef ReferenceCountedArray<PCAjob, CriticalSection> PCAJobArray;
 
-class cPolygon
+// Learns a template library from the spikes an electrode buffered, on the computing
+// thread, with a TemplateLearner. Units that are drifted versions of one of the previous
+// library keep its unit ID and color, so units stay the same as they drift.
+class TemplateJob : public ReferenceCountedObject
 {
 public:
-    cPolygon();
-    bool isPointInside(PointD p);
-    std::vector<PointD> pts;
-    PointD offset;
-};
+    TemplateJob(SorterSpikeArray& _spikes, TemplateLibraryPtr _previous, UniqueIDgenerator* _uniqueIDgenerator);
+    void run();
+
+    // set once run() is done, result can then be read
+    std::atomic<bool> finished;
+    TemplateLibraryPtr result;
 
+private:
+    SorterSpikeArray spikes;
+    TemplateLibraryPtr previous;
+    UniqueIDgenerator* uniqueIDgenerator;
+};
 
+typedef ReferenceCountedObjectPtr<TemplateJob> TemplateJobPtr;
+typedef ReferenceCountedArray<TemplateJob, CriticalSection> TemplateJobArray;
 
+// Runs PCA and template jobs in the background. The thread is started by the first job
+// and then sleeps until the next one, so a job can never be added while it is exiting.
 class PCAcomputingThread : juce::Thread
 {
 public:
     PCAcomputingThread();
-    void run(); // computes PCA on waveforms
+    ~PCAcomputingThread();
+    void run(); // computes PCA on waveforms and learns templates
     void addPCAjob(PCAJobPtr job);
+    void addTemplateJob(TemplateJobPtr job);
 
 private:
     PCAJobArray jobs;
+    TemplateJobArray templateJobs;
 	CriticalSection lock;
 };
 
@@ -260,7 +246,7 @@ public:
 
 
 	void projectOnPrincipalComponents(SorterSpikePtr so);
-	bool sortSpike(SorterSpikePtr so, bool PCAfirst);
+	bool sortSpike(SorterSpikePtr so, bool PCAfirst, bool useTemplates = false);
     void RePCA();
     void addPCAunit(PCAUnit unit);
     int addBoxUnit(int channel);
@@ -295,12 +281,22 @@ public:
 private:
     //void  StartCriticalSection();
     //void  EndCriticalSection();
+    // recompile the masks sortSpike uses, whenever the units change
+    void compileBoxMasks();
+    void compilePolygonMasks();
+    // swaps in a finished template library and starts learning the next one
+    void updateTemplates();
     UniqueIDgenerator* uniqueIDgenerator;
     int numChannels, waveformLength;
     int selectedUnit, selectedBox;
     CriticalSection mut;
     std::vector<BoxUnit> boxUnits;
     std::vector<PCAUnit> pcaUnits;
+    std::vector<BoxUnitMask> boxMasks;
+    std::vector<PolygonMask> polygonMasks;
+    // waveform geometry the box masks are compiled for
+    float maskSampleRate;
+    unsigned int maskTotalSamples;
     float* pc1, *pc2;
     std::atomic<float> pc1min, pc2min, pc1max, pc2max;
     SorterSpikeArray spikeBuffer;
@@ -308,6 +304,10 @@ private:
     PCAcomputingThread* computingThread;
     bool bPCAJobSubmitted,bPCAcomputed,bRePCA;
     std::atomic<bool> bPCAjobFinished ;
+    // template matching, learned again every bufferSize spikes to follow drift
+    TemplateLibraryPtr templates;
+    TemplateJobPtr templateJob;
+    int spikesSinceTemplates;
 
 
 };
@@ -0,0 +1,507 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpikeSortGeometry.h"
+#include <cmath>
+
+PointD::PointD()
+{
+    X = Y = 0;
+}
+
+
+PointD::PointD(float x, float y)
+{
+    X = x;
+    Y = y;
+}
+
+PointD::PointD(const PointD& P)
+{
+    X = P.X;
+    Y = P.Y;
+}
+
+PointD& PointD::operator+=(const PointD& rhs)
+{
+    X += rhs.X;
+    Y += rhs.Y;
+    return *this;
+}
+
+PointD& PointD::operator-=(const PointD& rhs)
+{
+    X -= rhs.X;
+    Y -= rhs.Y;
+    return *this;
+}
+
+const PointD PointD::operator+(const PointD& other) const
+{
+    PointD result = *this;
+    result += other;
+    return result;
+}
+
+
+const PointD PointD::operator-(const PointD& other) const
+{
+    PointD result = *this;
+    result -= other;
+    return result;
+}
+
+
+const PointD PointD::operator*(const PointD& other) const
+{
+    PointD result = *this;
+    result.X *= other.X;
+    result.Y *= other.Y;
+    return result;
+
+}
+
+float PointD::cross(PointD c) const
+{
+    return X*c.Y-Y*c.X;
+}
+
+/**************************************/
+
+
+Box::Box()
+{
+    x = -0.2; // in ms
+    y = -10; // in uV
+    w = 0.5; // in ms
+    h = 70; // in uV
+    channel=0;
+}
+
+
+Box::Box(int ch)
+{
+    x = -0.2; // in ms
+    y = -10; // in uV
+    w = 0.5; // in ms
+    h = 70; // in uV
+    channel = ch;
+}
+
+Box::Box(float X, float Y, float W, float H, int ch)
+{
+    x = X;
+    y = Y;
+    w = W;
+    h = H;
+    channel = ch;
+}
+
+bool Box::LineSegmentIntersection(PointD p11, PointD p12, PointD p21, PointD p22)
+{
+    PointD r = (p12 - p11);
+    PointD s = (p22 - p21);
+    PointD q = p21;
+    PointD p = p11;
+    double rs = r.cross(s);
+    double eps = 1e-6;
+    if (fabs(rs) < eps)
+        return false; // lines are parallel
+    double t = (q - p).cross(s) / rs;
+    double u = (q - p).cross(r) / rs;
+    return (t>=0&&t<=1 &&u>0&&u<=1);
+}
+
+#ifndef MAX
+#define MAX(x,y)((x)>(y))?(x):(y)
+#endif
+
+#ifndef MIN
+#define MIN(x,y)((x)<(y))?(x):(y)
+#endif
+
+float getSpikeTimeSpan(float sampleRate, unsigned int totalSamples)
+{
+    return 1.0f / sampleRate * totalSamples * 1e6;
+}
+
+float timeBinToMicrosecond(int bin, float spikeTimeSpan, unsigned int totalSamples)
+{
+    return float(bin) / (totalSamples - 1) * spikeTimeSpan;
+}
+
+int microSecondsToTimeBin(float t, float spikeTimeSpan, unsigned int totalSamples)
+{
+    return MIN(totalSamples - 1, MAX(0, t / spikeTimeSpan * (totalSamples - 1)));
+}
+
+bool Box::isWaveFormInside(const float* data, float sampleRate, unsigned int totalSamples) const
+{
+    PointD BoxTopLeft(x, y);
+    PointD BoxBottomLeft(x, (y - h));
+
+    PointD BoxTopRight(x + w, y);
+    PointD BoxBottomRight(x + w, (y - h));
+
+    // y,and h are given in micro volts.
+    // x and w and given in micro seconds.
+
+    // no point testing all wave form points. Just ones that are between x and x+w...
+    float spikeTimeSpan = getSpikeTimeSpan(sampleRate, totalSamples);
+    int BinLeft = microSecondsToTimeBin(x, spikeTimeSpan, totalSamples);
+    int BinRight = microSecondsToTimeBin(x + w, spikeTimeSpan, totalSamples);
+    const float* wave = data + channel * totalSamples;
+
+    /*
+    float minValue=1e10, maxValue=1e-10;
+    for (int pt = 0; pt < so->nSamples; pt++)
+    {
+    	float v = spikeDataBinToMicrovolts(so, pt, channel);
+    	minValue = MIN(minValue,v);
+    	maxValue = MAX(maxValue,v);
+    }
+    */
+
+    for (int pt = BinLeft; pt < BinRight; pt++)
+    {
+        PointD Pwave1(timeBinToMicrosecond(pt, spikeTimeSpan, totalSamples), wave[pt]);
+        PointD Pwave2(timeBinToMicrosecond(pt + 1, spikeTimeSpan, totalSamples), wave[pt + 1]);
+
+        bool bLeft = LineSegmentIntersection(Pwave1,Pwave2,BoxTopLeft,BoxBottomLeft) ;
+        bool bRight = LineSegmentIntersection(Pwave1,Pwave2,BoxTopRight,BoxBottomRight);
+        bool bTop = LineSegmentIntersection(Pwave1,Pwave2,BoxTopLeft,BoxTopRight);
+        bool bBottom = LineSegmentIntersection(Pwave1, Pwave2, BoxBottomLeft, BoxBottomRight);
+        if (bLeft || bRight || bTop || bBottom)
+        {
+            return true;
+        }
+
+    }
+    return false;
+}
+
+bool Box::isWaveFormInsideAll(const std::vector<Box>& boxes, const float* data, float sampleRate, unsigned int totalSamples)
+{
+    for (int k=0; k< boxes.size(); k++)
+    {
+        if (!boxes[k].isWaveFormInside(data, sampleRate, totalSamples))
+            return false;
+    }
+    return boxes.size() == 0 ? false : true;
+}
+
+/**************************/
+
+cPolygon::cPolygon()
+{
+};
+
+bool cPolygon::isPointInside(PointD p)
+{
+    PointD p1, p2;
+
+    bool inside = false;
+
+    if (pts.size() < 3)
+    {
+        return inside;
+    }
+
+    PointD oldPoint(pts[pts.size()- 1].X + offset.X, pts[pts.size()- 1].Y + offset.Y);
+
+    for (int i = 0; i < pts.size(); i++)
+    {
+        PointD newPoint(pts[i].X + offset.X, pts[i].Y + offset.Y);
+
+        if (newPoint.X > oldPoint.X)
+        {
+            p1 = oldPoint;
+            p2 = newPoint;
+        }
+        else
+        {
+            p1 = newPoint;
+            p2 = oldPoint;
+        }
+
+        if ((newPoint.X < p.X) == (p.X <= oldPoint.X)
+            && ((p.Y - p1.Y) * (p2.X - p1.X)	< (p2.Y - p1.Y) * (p.X - p1.X)))
+        {
+            inside = !inside;
+        }
+
+        oldPoint = newPoint;
+    }
+
+    return inside;
+}
+
+/**************************/
+
+// How far, relative to the magnitudes involved, a segment has to be from a box edge
+// or a point from a polygon edge before rounding in the geometric tests cannot matter.
+// Float arithmetic there is good to about 1e-7, so this leaves a wide safety margin.
+static const float maskTolerance = 1e-4f;
+
+// Cells per side of the polygon bitmaps
+static const int polygonMaskSize = 64;
+
+BoxUnitMask::BoxUnitMask() : sampleRate(0), totalSamples(0), exactOnly(true)
+{
+}
+
+void BoxUnitMask::compile(const std::vector<Box>& unitBoxes, float sampleRate_, unsigned int totalSamples_)
+{
+    sampleRate = sampleRate_;
+    totalSamples = totalSamples_;
+    boxes.clear();
+
+    for (int k = 0; k < unitBoxes.size(); k++)
+    {
+        CompiledBox b;
+        b.box = unitBoxes[k];
+        boxes.push_back(b);
+    }
+
+    // a waveform too short to have a time axis keeps to the geometric test
+    exactOnly = totalSamples < 2 || ! (sampleRate > 0);
+
+    if (exactOnly)
+        return;
+
+    float spikeTimeSpan = getSpikeTimeSpan(sampleRate, totalSamples);
+
+    binTimes.resize(totalSamples);
+    for (int pt = 0; pt < totalSamples; pt++)
+        binTimes[pt] = timeBinToMicrosecond(pt, spikeTimeSpan, totalSamples);
+
+    for (int k = 0; k < boxes.size(); k++)
+    {
+        CompiledBox& b = boxes[k];
+        const Box& box = b.box;
+
+        // the same corners and bins as Box::isWaveFormInside
+        b.topLeft = PointD(box.x, box.y);
+        b.bottomLeft = PointD(box.x, (box.y - box.h));
+        b.topRight = PointD(box.x + box.w, box.y);
+        b.bottomRight = PointD(box.x + box.w, (box.y - box.h));
+        b.binLeft = microSecondsToTimeBin(box.x, spikeTimeSpan, totalSamples);
+        b.binRight = microSecondsToTimeBin(box.x + box.w, spikeTimeSpan, totalSamples);
+
+        b.low = jmin(b.topLeft.Y, b.bottomLeft.Y);
+        b.high = jmax(b.topLeft.Y, b.bottomLeft.Y);
+        b.scale = 1.0f + fabs(b.low) + fabs(b.high);
+
+        float start = jmin(b.topLeft.X, b.topRight.X);
+        float end = jmax(b.topLeft.X, b.topRight.X);
+        float timeMargin = maskTolerance * (1.0f + fabs(start) + fabs(end) + spikeTimeSpan);
+
+        b.innerBegin = b.binRight;
+        b.innerEnd = b.binRight;
+        for (int pt = b.binLeft; pt < b.binRight; pt++)
+        {
+            if (binTimes[pt] > start + timeMargin && binTimes[pt + 1] < end - timeMargin)
+            {
+                if (b.innerBegin == b.binRight)
+                    b.innerBegin = pt;
+                b.innerEnd = pt + 1;
+            }
+        }
+    }
+}
+
+bool BoxUnitMask::isWaveFormInside(const float* data, float sampleRate_, unsigned int totalSamples_)
+{
+    if (exactOnly || sampleRate_ != sampleRate || totalSamples_ != totalSamples)
+    {
+        for (int k = 0; k < boxes.size(); k++)
+        {
+            if (!boxes[k].box.isWaveFormInside(data, sampleRate_, totalSamples_))
+                return false;
+        }
+        return boxes.size() > 0;
+    }
+
+    for (int k = 0; k < boxes.size(); k++)
+    {
+        if (!isWaveFormInside(boxes[k], data + boxes[k].box.channel * totalSamples))
+            return false;
+    }
+    return boxes.size() > 0;
+}
+
+bool BoxUnitMask::isWaveFormInside(const CompiledBox& b, const float* data)
+{
+    for (int pt = b.binLeft; pt < b.binRight; pt++)
+    {
+        float v1 = data[pt];
+        float v2 = data[pt + 1];
+        float low = jmin(v1, v2);
+        float high = jmax(v1, v2);
+        float margin = maskTolerance * (b.scale + jmax(fabs(v1), fabs(v2)));
+
+        // clearly above or below the box
+        if (low > b.high + margin || high < b.low - margin)
+            continue;
+
+        // clearly inside it
+        if (pt >= b.innerBegin && pt < b.innerEnd && low > b.low + margin && high < b.high - margin)
+            continue;
+
+        PointD Pwave1(binTimes[pt], v1);
+        PointD Pwave2(binTimes[pt + 1], v2);
+
+        if (Box::LineSegmentIntersection(Pwave1, Pwave2, b.topLeft, b.bottomLeft)
+            || Box::LineSegmentIntersection(Pwave1, Pwave2, b.topRight, b.bottomRight)
+            || Box::LineSegmentIntersection(Pwave1, Pwave2, b.topLeft, b.topRight)
+            || Box::LineSegmentIntersection(Pwave1, Pwave2, b.bottomLeft, b.bottomRight))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**************************/
+
+PolygonMask::PolygonMask() : left(0), bottom(0), right(0), top(0), cellWidth(0), cellHeight(0), exactOnly(false)
+{
+}
+
+void PolygonMask::compile(const cPolygon& poly)
+{
+    polygon = poly;
+    cells.clear();
+    exactOnly = false;
+
+    // cPolygon::isPointInside is never true for these, an empty bitmap says the same
+    if (poly.pts.size() < 3)
+        return;
+
+    // the vertices as cPolygon::isPointInside sees them
+    std::vector<PointD> vertices;
+    for (int i = 0; i < poly.pts.size(); i++)
+        vertices.push_back(PointD(poly.pts[i].X + poly.offset.X, poly.pts[i].Y + poly.offset.Y));
+
+    double minX = vertices[0].X, maxX = vertices[0].X;
+    double minY = vertices[0].Y, maxY = vertices[0].Y;
+    for (int i = 1; i < vertices.size(); i++)
+    {
+        minX = jmin(minX, double(vertices[i].X));
+        maxX = jmax(maxX, double(vertices[i].X));
+        minY = jmin(minY, double(vertices[i].Y));
+        maxY = jmax(maxY, double(vertices[i].Y));
+    }
+
+    double margin = maskTolerance * (1.0 + jmax(fabs(minX), fabs(maxX), jmax(fabs(minY), fabs(maxY))));
+
+    if (! std::isfinite(margin))
+    {
+        exactOnly = true;
+        return;
+    }
+
+    // beyond the margin around the vertices a point is outside: isPointInside either
+    // finds no edge spanning it or, above and below, an even number of them
+    left = minX - margin;
+    right = maxX + margin;
+    bottom = minY - margin;
+    top = maxY + margin;
+    cellWidth = (right - left) / polygonMaskSize;
+    cellHeight = (top - bottom) / polygonMaskSize;
+
+    cells.resize(polygonMaskSize * polygonMaskSize, CELL_OUTSIDE);
+
+    for (int i = 0; i < vertices.size(); i++)
+    {
+        const PointD& a = vertices[i];
+        const PointD& b = vertices[(i + 1) % vertices.size()];
+        double dx = b.X - a.X;
+        double dy = b.Y - a.Y;
+
+        int firstColumn = jlimit(0, polygonMaskSize - 1, int((jmin(a.X, b.X) - margin - left) / cellWidth));
+        int lastColumn = jlimit(0, polygonMaskSize - 1, int((jmax(a.X, b.X) + margin - left) / cellWidth));
+        int firstRow = jlimit(0, polygonMaskSize - 1, int((jmin(a.Y, b.Y) - margin - bottom) / cellHeight));
+        int lastRow = jlimit(0, polygonMaskSize - 1, int((jmax(a.Y, b.Y) + margin - bottom) / cellHeight));
+
+        for (int row = firstRow; row <= lastRow; row++)
+        {
+            for (int column = firstColumn; column <= lastColumn; column++)
+            {
+                // the cell grown by the margin, tested against the edge's line; the
+                // bounding boxes already overlap
+                double x0 = left + column * cellWidth - margin - a.X;
+                double x1 = left + (column + 1) * cellWidth + margin - a.X;
+                double y0 = bottom + row * cellHeight - margin - a.Y;
+                double y1 = bottom + (row + 1) * cellHeight + margin - a.Y;
+                double c00 = dx * y0 - dy * x0;
+                double c01 = dx * y1 - dy * x0;
+                double c10 = dx * y0 - dy * x1;
+                double c11 = dx * y1 - dy * x1;
+
+                bool allAbove = c00 > 0 && c01 > 0 && c10 > 0 && c11 > 0;
+                bool allBelow = c00 < 0 && c01 < 0 && c10 < 0 && c11 < 0;
+
+                if (!allAbove && !allBelow)
+                    cells[row * polygonMaskSize + column] = CELL_EDGE;
+            }
+        }
+    }
+
+    // nothing crosses the other cells, so their centres tell for all of them
+    for (int row = 0; row < polygonMaskSize; row++)
+    {
+        for (int column = 0; column < polygonMaskSize; column++)
+        {
+            uint8& cell = cells[row * polygonMaskSize + column];
+            if (cell == CELL_EDGE)
+                continue;
+
+            PointD centre(left + (column + 0.5) * cellWidth, bottom + (row + 0.5) * cellHeight);
+            cell = polygon.isPointInside(centre) ? CELL_INSIDE : CELL_OUTSIDE;
+        }
+    }
+}
+
+bool PolygonMask::isPointInside(PointD p)
+{
+    if (exactOnly)
+        return polygon.isPointInside(p);
+
+    // written so that NaN is outside too
+    if (cells.empty() || !(p.X >= left && p.X < right && p.Y >= bottom && p.Y < top))
+        return false;
+
+    int column = jmin(polygonMaskSize - 1, int((p.X - left) / cellWidth));
+    int row = jmin(polygonMaskSize - 1, int((p.Y - bottom) / cellHeight));
+
+    switch (cells[row * polygonMaskSize + column])
+    {
+        case CELL_INSIDE:
+            return true;
+        case CELL_OUTSIDE:
+            return false;
+        default:
+            return polygon.isPointInside(p);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SPIKESORTGEOMETRY_H
+#define __SPIKESORTGEOMETRY_H
+
+#include <BasicJuceHeader.h>
+#include <vector>
+
+// The time axis of a spike waveform. Box tests and the compiled masks share this arithmetic,
+// so they see the waveform at exactly the same times.
+float getSpikeTimeSpan(float sampleRate, unsigned int totalSamples);
+float timeBinToMicrosecond(int bin, float spikeTimeSpan, unsigned int totalSamples);
+int microSecondsToTimeBin(float t, float spikeTimeSpan, unsigned int totalSamples);
+
+class PointD
+{
+public:
+
+    PointD();
+    PointD(float x, float y);
+    PointD(const PointD& P);
+    const PointD operator+(const PointD& c1) const;
+    PointD& operator+=(const PointD& rhs);
+    PointD& operator-=(const PointD& rhs);
+
+
+    const PointD operator-(const PointD& c1) const;
+    const PointD operator*(const PointD& c1) const;
+
+    float cross(PointD c) const;
+    float X,Y;
+};
+
+
+class Box
+{
+public:
+    Box();
+    Box(int channel);
+    Box(float X, float Y, float W, float H, int ch=0);
+    static bool LineSegmentIntersection(PointD p11, PointD p12, PointD p21, PointD p22);
+    bool isWaveFormInside(const float* data, float sampleRate, unsigned int totalSamples) const;
+    // true if the waveform goes through every one of the boxes, false if there are none
+    static bool isWaveFormInsideAll(const std::vector<Box>& boxes, const float* data, float sampleRate, unsigned int totalSamples);
+    double x,y,w,h; // x&w and specified in microseconds. y&h in microvolts
+    int channel;
+};
+
+class cPolygon
+{
+public:
+    cPolygon();
+    bool isPointInside(PointD p);
+    std::vector<PointD> pts;
+    PointD offset;
+};
+
+// A box unit compiled for one waveform geometry, giving the same answer as
+// BoxUnit::isWaveFormInsideAllBoxes. Each box keeps the bins its test runs over, their
+// times and its value band. A segment of the waveform that is clearly above or below
+// the band, or clearly inside the box, cannot cross an edge and is skipped with a few
+// comparisons. Only the remaining ones, close to an edge, go through the geometric test.
+class BoxUnitMask
+{
+public:
+    BoxUnitMask();
+    void compile(const std::vector<Box>& unitBoxes, float sampleRate, unsigned int totalSamples);
+    bool isWaveFormInside(const float* data, float sampleRate, unsigned int totalSamples);
+private:
+    struct CompiledBox
+    {
+        Box box;
+        PointD topLeft, bottomLeft, topRight, bottomRight;
+        int binLeft, binRight;
+        // segments starting in [innerBegin, innerEnd) are clear of the left and right edges
+        int innerBegin, innerEnd;
+        float low, high, scale;
+    };
+    bool isWaveFormInside(const CompiledBox& b, const float* data);
+    std::vector<CompiledBox> boxes;
+    std::vector<float> binTimes;
+    float sampleRate;
+    unsigned int totalSamples;
+    bool exactOnly;
+};
+
+// A polygon rasterized over its bounding box in PC space, giving the same answer as
+// cPolygon::isPointInside. Cells no edge comes near are wholly inside or outside and
+// answer with one lookup. Cells an edge passes through fall back to the polygon test.
+class PolygonMask
+{
+public:
+    PolygonMask();
+    void compile(const cPolygon& poly);
+    bool isPointInside(PointD p);
+private:
+    enum CellState { CELL_OUTSIDE = 0, CELL_INSIDE, CELL_EDGE };
+    cPolygon polygon;
+    std::vector<uint8> cells;
+    double left, bottom, right, top;
+    double cellWidth, cellHeight;
+    bool exactOnly;
+};
+
+#endif // __SPIKESORTGEOMETRY_H
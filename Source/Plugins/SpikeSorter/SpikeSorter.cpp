@@ -47,6 +47,7 @@ SpikeSorter::SpikeSorter()
     autoDACassignment = false;
     syncThresholds = false;
     flipSignal = false;
+    templateSorting = false;
 }
 
 bool SpikeSorter::getFlipSignalState()
@@ -70,6 +71,17 @@ void SpikeSorter::setFlipSignalState(bool state)
 
 }
 
+bool SpikeSorter::getTemplateSortingState()
+{
+    return templateSorting;
+}
+
+
+void SpikeSorter::setTemplateSortingState(bool state)
+{
+    templateSorting = state;
+}
+
 int SpikeSorter::getNumPreSamples()
 {
     return numPreSamples;
@@ -230,7 +242,6 @@ Electrode::~Electrode()
     delete[] isActive;
     delete[] voltageScale;
     delete[] channels;
-    delete[] runningStats;
 }
 
 Electrode::Electrode(int ID, UniqueIDgenerator* uniqueIDgenerator_, PCAcomputingThread* pth, String _name, int _numChannels, int* _channels, float default_threshold, int pre, int post, float samplingRate , int sourceId, int subIdx)
@@ -250,7 +261,6 @@ Electrode::Electrode(int ID, UniqueIDgenerator* uniqueIDgenerator_, PCAcomputing
     isActive = new bool[numChannels];
     channels = new int[numChannels];
     voltageScale = new double[numChannels];
-    runningStats = new RunningStat[numChannels];
     depthOffsetMM = 0.0;
 
     advancerID = -1;
@@ -428,6 +438,7 @@ void SpikeSorter::addElectrode(Electrode* newElectrode)
 {
     mut.enter();
     resetElectrode(newElectrode);
+    watchElectrodeChannels(newElectrode);
     electrodes.add(newElectrode);
     // inform PSTH sink, if it exists, about this new electrode.
 //    updateSinks(newElectrode);
@@ -478,6 +489,7 @@ bool SpikeSorter::addElectrode(int nChans, String name, double Depth)
     delete[] chans;
 
     resetElectrode(newElectrode);
+    watchElectrodeChannels(newElectrode);
     electrodes.add(newElectrode);
  //   updateSinks(newElectrode);
     setCurrentElectrodeIndex(electrodes.size()-1);
@@ -508,6 +520,13 @@ void SpikeSorter::resetElectrode(Electrode* e)
     e->lastBufferIndex = 0;
 }
 
+void SpikeSorter::watchElectrodeChannels(Electrode* e)
+{
+    // the window was allocated in enable(), so this is safe while acquiring
+    for (int k = 0; k < e->numChannels; k++)
+        channelStatistics[e->channels[k]].watch();
+}
+
 bool SpikeSorter::removeElectrode(int index)
 {
     mut.enter();
@@ -566,6 +585,7 @@ void SpikeSorter::setChannel(int electrodeIndex, int channelNum, int newChannel)
    // updateSinks(electrodes[electrodeIndex]->electrodeID, channelNum,newChannel);
 
     *(electrodes[electrodeIndex]->channels+channelNum) = newChannel;
+    watchElectrodeChannels(electrodes[electrodeIndex]);
     mut.exit();
 }
 
@@ -674,6 +694,12 @@ bool SpikeSorter::enable()
     for (int i = 0; i < electrodes.size(); i++)
         useOverflowBuffer.add(false);
 
+    channelStatistics.clearQuick();
+    for (int i = 0; i < getNumInputs(); i++)
+        channelStatistics.add(getInputStatistics(i, 5.0f));
+    for (int i = 0; i < electrodes.size(); i++)
+        watchElectrodeChannels(electrodes[i]);
+
 
     SpikeSorterEditor* editor = (SpikeSorterEditor*) getEditor();
     editor->enable();
@@ -682,6 +708,12 @@ bool SpikeSorter::enable()
 }
 
 
+bool SpikeSorter::changesContinuousData() const
+{
+    return false;
+}
+
+
 bool SpikeSorter::isReady()
 {
     return true;
@@ -838,7 +870,11 @@ float SpikeSorter::getSelectedElectrodeNoise()
         return 0.0;
 
     // TODO, change "0" to active channel to support tetrodes.
-    return electrodes[currentElectrode]->runningStats[0].StandardDeviation();
+    ChannelStatistics::Values values;
+    if (!channelStatistics[electrodes[currentElectrode]->channels[0]].getValues(values))
+        return 0.0;
+
+    return values.std;
 }
 
 
@@ -847,7 +883,7 @@ void SpikeSorter::clearRunningStatForSelectedElectrode()
     if (electrodes.size() == 0)
         return;
     // TODO, change "0" to active channel to support tetrodes.
-    electrodes[currentElectrode]->runningStats[0].Clear();
+    channelStatistics[electrodes[currentElectrode]->channels[0]].requestClear();
 }
 
 void SpikeSorter::process(AudioSampleBuffer& buffer)
@@ -895,7 +931,6 @@ void SpikeSorter::process(AudioSampleBuffer& buffer)
 
                     int currentChannel = electrode->channels[chan];
                     float currentValue = getNextSample(currentChannel);
-                    electrode->runningStats[chan].Push(currentValue);
 
                     bool bSpikeDetectedPositive  = electrode->thresholds[chan] > 0 &&
                                                    (currentValue > electrode->thresholds[chan]); // rising edge
@@ -966,7 +1001,7 @@ void SpikeSorter::process(AudioSampleBuffer& buffer)
 						electrode->spikeSort->projectOnPrincipalComponents(sorterSpike);
 
                         // Add spike to drawing buffer....
-						electrode->spikeSort->sortSpike(sorterSpike, PCAbeforeBoxes);
+						electrode->spikeSort->sortSpike(sorterSpike, PCAbeforeBoxes, templateSorting);
 
 
                         // transfer buffered spikes to spike plot
@@ -1194,6 +1229,7 @@ void SpikeSorter::saveCustomParametersToXml(XmlElement* parentElement)
     mainNode->setAttribute("syncThresholds",syncThresholds);
     mainNode->setAttribute("uniqueID",uniqueID);
     mainNode->setAttribute("flipSignal",flipSignal);
+    mainNode->setAttribute("templateSorting",templateSorting);
 
     XmlElement* countNode = mainNode->createNewChildElement("ELECTRODE_COUNTER");
 
@@ -1256,6 +1292,7 @@ void SpikeSorter::loadCustomParametersFromXml()
                 syncThresholds = mainNode->getBoolAttribute("syncThresholds");
                 uniqueID = mainNode->getIntAttribute("uniqueID");
                 flipSignal = mainNode->getBoolAttribute("flipSignal");
+                templateSorting = mainNode->getBoolAttribute("templateSorting");
 
                 forEachXmlChildElement(*mainNode, xmlNode)
                 {
@@ -72,6 +72,7 @@ public:
     {
         globalUniqueID=0;
     }
+    // also called from the computing thread for learned templates
     int generateUniqueID()
     {
         return ++globalUniqueID;
@@ -82,67 +83,10 @@ public:
     }
     int getLastUniqueID()
     {
-        return globalUniqueID;
+        return globalUniqueID.get();
     }
 private:
-    int globalUniqueID;
-};
-
-/* snatched from http://www.johndcook.com/blog/standard_deviation/ */
-class RunningStat
-{
-public:
-    RunningStat() : m_n(0) {}
-
-    void Clear()
-    {
-        m_n = 0;
-    }
-
-    void Push(double x)
-    {
-        m_n++;
-
-        // See Knuth TAOCP vol 2, 3rd edition, page 232
-        if (m_n == 1)
-        {
-            m_oldM = m_newM = x;
-            m_oldS = 0.0;
-        }
-        else
-        {
-            m_newM = m_oldM + (x - m_oldM) / m_n;
-            m_newS = m_oldS + (x - m_oldM)*(x - m_newM);
-
-            // set up for next iteration
-            m_oldM = m_newM;
-            m_oldS = m_newS;
-        }
-    }
-
-    int NumDataValues() const
-    {
-        return m_n;
-    }
-
-    double Mean() const
-    {
-        return (m_n > 0) ? m_newM : 0.0;
-    }
-
-    double Variance() const
-    {
-        return ((m_n > 1) ? m_newS / (m_n - 1) : 0.0);
-    }
-
-    double StandardDeviation() const
-    {
-        return sqrt(Variance());
-    }
-
-private:
-    int m_n;
-    double m_oldM, m_newM, m_oldS, m_newS;
+    Atomic<int> globalUniqueID;
 };
 
 class Electrode
@@ -171,7 +115,6 @@ public:
     double* voltageScale;
     //float PCArange[4];
 
-    RunningStat* runningStats;
     SpikeHistogramPlot* spikePlot;
     
     PCAcomputingThread* computingThread;
@@ -248,6 +191,10 @@ public:
     /** Creates the SpikeSorterEditor. */
     AudioProcessorEditor* createEditor() override;
 
+    /** Spikes are added as events, the continuous channels are passed on as they came in. */
+    bool changesContinuousData() const override;
+
+    /** Standard deviation of the first channel of the selected electrode over the last seconds */
     float getSelectedElectrodeNoise();
     void clearRunningStatForSelectedElectrode();
 
@@ -353,6 +300,8 @@ public:
     void setThresholdSyncStatus(bool status);
     bool getFlipSignalState();
     void setFlipSignalState(bool state);
+    bool getTemplateSortingState();
+    void setTemplateSortingState(bool state);
     void startRecording();
     std::vector<float> getElectrodeVoltageScales(int electrodeID);
     //void getElectrodePCArange(int electrodeID, float &minX,float &maxX,float &minY,float &maxY);
@@ -424,13 +373,18 @@ private:
 
     bool PCAbeforeBoxes;
     ContinuousCircularBuffer* channelBuffers; // used to compute auto threshold
+    /** Statistics of the input channels, computed upstream. Only the electrode channels are watched */
+    Array<ChannelStatistics::Channel> channelStatistics;
 
     void resetElectrode(Electrode*);
+    void watchElectrodeChannels(Electrode*);
     CriticalSection mut;
     bool autoDACassignment;
     bool syncThresholds;
  //   RHD2000Thread* getRhythmAccess();
     bool flipSignal;
+    // sort the spikes drawn units leave with templates learned on each electrode
+    bool templateSorting;
 
 	bool sorterReady{ false };
 
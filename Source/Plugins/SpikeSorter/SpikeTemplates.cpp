@@ -0,0 +1,397 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpikeTemplates.h"
+#include <limits>
+
+// Units the template learning looks for, at most
+static const int maxTemplates = 6;
+
+// Clusters closer than this many standard deviations are one unit split in two
+static const float minSeparation = 5.0f;
+
+// four running sums, so the compiler can keep them in one vector register
+static float dotProduct(const float* a, const float* b, int n)
+{
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static float squaredDistance(const float* a, const float* b, int n)
+{
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        float d0 = a[i] - b[i];
+        float d1 = a[i + 1] - b[i + 1];
+        float d2 = a[i + 2] - b[i + 2];
+        float d3 = a[i + 3] - b[i + 3];
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+        s2 += d2 * d2;
+        s3 += d3 * d3;
+    }
+    for (; i < n; i++)
+        s0 += (a[i] - b[i]) * (a[i] - b[i]);
+    return (s0 + s1) + (s2 + s3);
+}
+
+TemplateLibrary::TemplateLibrary(int dimension_) : dimension(dimension_)
+{
+}
+
+int TemplateLibrary::match(const float* waveform) const
+{
+    int best = -1;
+    float bestScore = 0;
+    for (int k = 0; k < int(unitIDs.size()); k++)
+    {
+        float score = dotProduct(waveform, &templates[k * dimension], dimension) - halfNorms[k];
+        if (best < 0 || score > bestScore)
+        {
+            best = k;
+            bestScore = score;
+        }
+    }
+
+    if (best < 0)
+        return -1;
+
+    // |x - t|^2 = |x|^2 - 2 (x.t - |t|^2 / 2)
+    float distance = dotProduct(waveform, waveform, dimension) - 2 * bestScore;
+    return distance <= maxDistances[best] ? best : -1;
+}
+
+int TemplateLibrary::getNumTemplates() const
+{
+    return (int) unitIDs.size();
+}
+
+int TemplateLibrary::getDimension() const
+{
+    return dimension;
+}
+
+const float* TemplateLibrary::getTemplate(int index) const
+{
+    return &templates[index * dimension];
+}
+
+float TemplateLibrary::getMaxDistance(int index) const
+{
+    return maxDistances[index];
+}
+
+int TemplateLibrary::getUnitID(int index) const
+{
+    return unitIDs[index];
+}
+
+const uint8* TemplateLibrary::getColor(int index) const
+{
+    return &colors[index * 3];
+}
+
+void TemplateLibrary::addTemplate(const float* waveform, float maxDistance, int unitID, const uint8 color[3])
+{
+    templates.insert(templates.end(), waveform, waveform + dimension);
+    halfNorms.push_back(0.5f * dotProduct(waveform, waveform, dimension));
+    maxDistances.push_back(maxDistance);
+    unitIDs.push_back(unitID);
+    colors.insert(colors.end(), color, color + 3);
+}
+
+/**************************/
+
+TemplateLearner::TemplateLearner() : waveforms(nullptr), numSpikes(0), dim(0)
+{
+}
+
+int TemplateLearner::learn(const float* waveforms_, int numSpikes_, int dimension, const TemplateLibrary* previous)
+{
+    waveforms = waveforms_;
+    numSpikes = numSpikes_;
+    dim = dimension;
+    unitTemplates.clear();
+    unitMaxDistances.clear();
+    unitPrevious.clear();
+
+    const int minClusterSize = jmax(5, numSpikes / 20);
+    if (dim <= 0 || numSpikes < 2 * minClusterSize)
+        return 0;
+
+    // the same spikes always give the same units
+    Random random(numSpikes);
+    std::vector<int> labels(numSpikes), bestLabels(numSpikes, 0);
+    int numClusters = 1;
+
+    for (int k = 2; k <= maxTemplates && k * minClusterSize <= numSpikes; k++)
+    {
+        // a few seedings, keeping the tightest clusters
+        double bestSum = std::numeric_limits<double>::max();
+        std::vector<int> kLabels(numSpikes);
+        for (int attempt = 0; attempt < 5; attempt++)
+        {
+            double sum = kmeans(k, random, labels);
+            if (sum < bestSum)
+            {
+                bestSum = sum;
+                kLabels = labels;
+            }
+        }
+
+        // centers of the kept seeding
+        updateCenters(k, kLabels);
+        if (separation(k, kLabels) >= minSeparation)
+        {
+            numClusters = k;
+            bestLabels = kLabels;
+        }
+    }
+
+    centers.assign(numClusters * dim, 0.0f);
+    updateCenters(numClusters, bestLabels);
+
+    bool compatible = previous != nullptr && previous->getDimension() == dim;
+    std::vector<bool> previousTaken(compatible ? previous->getNumTemplates() : 0, false);
+
+    for (int c = 0; c < numClusters; c++)
+    {
+        const float* center = &centers[c * dim];
+
+        // spikes of a unit are within three standard deviations of their mean distance
+        int count = 0;
+        double sum = 0, sumSquares = 0;
+        for (int i = 0; i < numSpikes; i++)
+        {
+            if (bestLabels[i] != c)
+                continue;
+            double d = squaredDistance(&waveforms[i * dim], center, dim);
+            count++;
+            sum += d;
+            sumSquares += d * d;
+        }
+        if (count < minClusterSize)
+            continue;
+
+        double mean = sum / count;
+        double deviation = sqrt(jmax(0.0, sumSquares / count - mean * mean));
+        float maxDistance = float(mean + 3 * deviation);
+
+        // the unit of the previous library this template is a drifted version of
+        int match = -1;
+        float matchDistance = 0;
+        for (int k = 0; k < int(previousTaken.size()); k++)
+        {
+            float d = squaredDistance(center, previous->getTemplate(k), dim);
+            if (!previousTaken[k] && d <= previous->getMaxDistance(k) && (match < 0 || d < matchDistance))
+            {
+                match = k;
+                matchDistance = d;
+            }
+        }
+
+        if (match >= 0)
+            previousTaken[match] = true;
+
+        unitTemplates.insert(unitTemplates.end(), center, center + dim);
+        unitMaxDistances.push_back(maxDistance);
+        unitPrevious.push_back(match);
+    }
+
+    return getNumUnits();
+}
+
+int TemplateLearner::getNumUnits() const
+{
+    return (int) unitPrevious.size();
+}
+
+const float* TemplateLearner::getTemplate(int unit) const
+{
+    return &unitTemplates[unit * dim];
+}
+
+float TemplateLearner::getMaxDistance(int unit) const
+{
+    return unitMaxDistances[unit];
+}
+
+int TemplateLearner::getPreviousIndex(int unit) const
+{
+    return unitPrevious[unit];
+}
+
+double TemplateLearner::assign(int numClusters, std::vector<int>& labels)
+{
+    double sum = 0;
+    for (int i = 0; i < numSpikes; i++)
+    {
+        int best = 0;
+        float bestDistance = squaredDistance(&waveforms[i * dim], &centers[0], dim);
+        for (int c = 1; c < numClusters; c++)
+        {
+            float d = squaredDistance(&waveforms[i * dim], &centers[c * dim], dim);
+            if (d < bestDistance)
+            {
+                best = c;
+                bestDistance = d;
+            }
+        }
+        labels[i] = best;
+        sum += bestDistance;
+    }
+    return sum;
+}
+
+void TemplateLearner::updateCenters(int numClusters, const std::vector<int>& labels)
+{
+    std::vector<int> counts(numClusters, 0);
+    for (int i = 0; i < numSpikes; i++)
+        counts[labels[i]]++;
+
+    for (int c = 0; c < numClusters; c++)
+    {
+        // an empty cluster keeps its center
+        if (counts[c] > 0)
+            std::fill(centers.begin() + c * dim, centers.begin() + (c + 1) * dim, 0.0f);
+    }
+
+    for (int i = 0; i < numSpikes; i++)
+    {
+        float* center = &centers[labels[i] * dim];
+        const float* waveform = &waveforms[i * dim];
+        float scale = 1.0f / counts[labels[i]];
+        for (int j = 0; j < dim; j++)
+            center[j] += waveform[j] * scale;
+    }
+}
+
+double TemplateLearner::kmeans(int numClusters, Random& random, std::vector<int>& labels)
+{
+    centers.resize(numClusters * dim);
+
+    // k-means++ seeding, each center drawn with a probability growing with its distance
+    // to the ones already chosen
+    std::vector<float> nearest(numSpikes, std::numeric_limits<float>::max());
+    int chosen = random.nextInt(numSpikes);
+    for (int c = 0; c < numClusters; c++)
+    {
+        std::copy(&waveforms[chosen * dim], &waveforms[(chosen + 1) * dim], &centers[c * dim]);
+
+        double total = 0;
+        for (int i = 0; i < numSpikes; i++)
+        {
+            nearest[i] = jmin(nearest[i], squaredDistance(&waveforms[i * dim], &centers[c * dim], dim));
+            total += nearest[i];
+        }
+
+        double target = random.nextDouble() * total;
+        chosen = numSpikes - 1;
+        for (int i = 0; i < numSpikes; i++)
+        {
+            target -= nearest[i];
+            if (target < 0)
+            {
+                chosen = i;
+                break;
+            }
+        }
+    }
+
+    std::vector<int> previousLabels(numSpikes, -1);
+    double sum = 0;
+    for (int iteration = 0; iteration < 50; iteration++)
+    {
+        sum = assign(numClusters, labels);
+        if (labels == previousLabels)
+            break;
+        updateCenters(numClusters, labels);
+        previousLabels = labels;
+    }
+    return sum;
+}
+
+float TemplateLearner::separation(int numClusters, const std::vector<int>& labels)
+{
+    // how far each mean is from where it would be without noise, squared: with few spikes
+    // in many samples that alone puts the means of one unit split in two far apart
+    std::vector<double> meanErrors(numClusters, 0.0);
+    std::vector<int> counts(numClusters, 0);
+    for (int i = 0; i < numSpikes; i++)
+    {
+        meanErrors[labels[i]] += squaredDistance(&waveforms[i * dim], &centers[labels[i] * dim], dim);
+        counts[labels[i]]++;
+    }
+    for (int c = 0; c < numClusters; c++)
+        meanErrors[c] = counts[c] > 1 ? meanErrors[c] / (double(counts[c]) * (counts[c] - 1)) : 0.0;
+
+    float smallest = std::numeric_limits<float>::max();
+    std::vector<float> direction(dim);
+
+    for (int a = 0; a < numClusters; a++)
+    {
+        for (int b = a + 1; b < numClusters; b++)
+        {
+            const float* centerA = &centers[a * dim];
+            const float* centerB = &centers[b * dim];
+            float squaredLength = squaredDistance(centerA, centerB, dim);
+            float length = sqrtf(squaredLength);
+            double signal = squaredLength - meanErrors[a] - meanErrors[b];
+            if (length <= 0 || signal <= 0)
+                return 0;
+
+            for (int j = 0; j < dim; j++)
+                direction[j] = (centerA[j] - centerB[j]) / length;
+
+            // spread of both clusters along the line joining their means
+            double sumSquares = 0;
+            int count = 0;
+            float offsetA = dotProduct(centerA, &direction[0], dim);
+            float offsetB = dotProduct(centerB, &direction[0], dim);
+            for (int i = 0; i < numSpikes; i++)
+            {
+                if (labels[i] != a && labels[i] != b)
+                    continue;
+                float d = dotProduct(&waveforms[i * dim], &direction[0], dim) - (labels[i] == a ? offsetA : offsetB);
+                sumSquares += d * d;
+                count++;
+            }
+
+            float deviation = float(sqrt(sumSquares / jmax(1, count - 2)));
+            smallest = jmin(smallest, float(sqrt(signal)) / jmax(deviation, 1e-6f));
+        }
+    }
+    return smallest;
+}
@@ -0,0 +1,103 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SPIKETEMPLATES_H
+#define __SPIKETEMPLATES_H
+
+#include <BasicJuceHeader.h>
+#include <vector>
+
+// Mean waveforms of the units found on one electrode, with how far a spike may be from
+// each one and still belong to it. A library is never changed once built: the sorter
+// swaps in a new one when the computing thread has learned it.
+class TemplateLibrary : public ReferenceCountedObject
+{
+public:
+    TemplateLibrary(int dimension);
+
+    // index of the closest template, if the waveform is close enough to it, -1 otherwise
+    int match(const float* waveform) const;
+
+    int getNumTemplates() const;
+    int getDimension() const;
+    const float* getTemplate(int index) const;
+    float getMaxDistance(int index) const;
+    int getUnitID(int index) const;
+    const uint8* getColor(int index) const;
+
+    void addTemplate(const float* waveform, float maxDistance, int unitID, const uint8 color[3]);
+
+private:
+    int dimension;
+    // templates one after the other
+    std::vector<float> templates;
+    // half the squared norm of each template, the nearest one maximises dot - halfNorm
+    std::vector<float> halfNorms;
+    // largest squared distance of a spike of the unit
+    std::vector<float> maxDistances;
+    std::vector<int> unitIDs;
+    std::vector<uint8> colors;
+};
+
+typedef ReferenceCountedObjectPtr<TemplateLibrary> TemplateLibraryPtr;
+
+// Clusters the waveforms an electrode buffered into units. k-means, with k-means++
+// seeding, runs for every number of units up to maxTemplates, and the most units that
+// are all well apart from each other are kept. Clusters too small to be a unit are
+// dropped. Needs nothing but the waveforms, so it can be checked on synthetic data.
+class TemplateLearner
+{
+public:
+    TemplateLearner();
+
+    // numSpikes waveforms of dimension samples, one after the other. Returns the number
+    // of units found. Units close to a template of previous are marked as drifted versions of it
+    int learn(const float* waveforms, int numSpikes, int dimension, const TemplateLibrary* previous);
+
+    int getNumUnits() const;
+    const float* getTemplate(int unit) const;
+    // largest squared distance of a spike of the unit
+    float getMaxDistance(int unit) const;
+    // index of the template of the previous library the unit is a drifted version of, -1 for a new unit
+    int getPreviousIndex(int unit) const;
+
+private:
+    // assigns every waveform to its closest center, returns the sum of squared distances
+    double assign(int numClusters, std::vector<int>& labels);
+    void updateCenters(int numClusters, const std::vector<int>& labels);
+    double kmeans(int numClusters, Random& random, std::vector<int>& labels);
+    // smallest distance between two cluster means, in standard deviations along the line
+    // joining them, so that noise in the other directions does not count
+    float separation(int numClusters, const std::vector<int>& labels);
+
+    const float* waveforms;
+    int numSpikes, dim;
+    std::vector<float> centers;
+
+    std::vector<float> unitTemplates;
+    std::vector<float> unitMaxDistances;
+    std::vector<int> unitPrevious;
+};
+
+
+#endif // __SPIKETEMPLATES_H
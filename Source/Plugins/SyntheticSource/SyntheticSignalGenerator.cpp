@@ -0,0 +1,240 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SyntheticSignalGenerator.h"
+#include <cmath>
+#include <limits>
+
+SyntheticSignalGenerator::SyntheticSignalGenerator(int numChannels, float sampleRate, int numTTLLines, int maxBlockSize)
+	: m_numChannels(numChannels),
+	m_sampleRate(sampleRate),
+	m_numTTLLines(numTTLLines),
+	m_maxBlockSize(jmin(maxBlockSize, int(noiseTableSize))),
+	m_seed(0),
+	m_block(numChannels, jmin(maxBlockSize, int(noiseTableSize))),
+	m_spikeLength(0),
+	m_refractorySamples(1),
+	m_sampleNumber(0),
+	m_ttlIntervalSamples(1),
+	m_ttlMask(0)
+{
+	m_timestamps.malloc(m_maxBlockSize);
+	m_eventCodes.malloc(m_maxBlockSize);
+	m_sinBlock.malloc(m_maxBlockSize);
+	m_cosBlock.malloc(m_maxBlockSize);
+	m_noiseTable.malloc(noiseTableSize);
+
+	m_sinGain.malloc(numChannels);
+	m_cosGain.malloc(numChannels);
+	m_spikeGain.malloc(numChannels);
+	m_nextSpike.malloc(numChannels);
+	m_lastSpike.malloc(numChannels);
+	m_spikeSeed.malloc(numChannels);
+
+	createSpikeWaveform();
+	reset(SyntheticSignalSettings(), 0);
+}
+
+SyntheticSignalGenerator::~SyntheticSignalGenerator()
+{
+}
+
+void SyntheticSignalGenerator::createSpikeWaveform()
+{
+	//Biphasic extracellular-like waveform, 1.5ms long: sharp trough followed by a slower repolarization peak
+	m_spikeLength = jmax(8, roundToInt(0.0015 * m_sampleRate));
+	m_spikeWaveform.malloc(m_spikeLength);
+
+	float minValue = 0;
+	for (int i = 0; i < m_spikeLength; i++)
+	{
+		const double t = 1000.0 * i / m_sampleRate; //ms
+		const double trough = (t - 0.35) / 0.1;
+		const double peak = (t - 0.7) / 0.25;
+		m_spikeWaveform[i] = float(-std::exp(-trough * trough) + 0.35 * std::exp(-peak * peak));
+		minValue = jmin(minValue, m_spikeWaveform[i]);
+	}
+	if (minValue < 0)
+		FloatVectorOperations::multiply(m_spikeWaveform, -1.0f / minValue, m_spikeLength);
+
+	m_refractorySamples = jmax(int64(m_spikeLength), int64(roundToInt(0.002 * m_sampleRate)));
+}
+
+void SyntheticSignalGenerator::reset(const SyntheticSignalSettings& settings, int subProcessorIdx)
+{
+	m_settings = settings;
+	m_seed = settings.seed * 7919 + subProcessorIdx;
+	m_sampleNumber = 0;
+
+	Random random(m_seed);
+
+	//Box-Muller transform into a table of unit variance noise. Each channel reads it from an offset that depends on the sample number
+	for (int i = 0; i < noiseTableSize; i += 2)
+	{
+		const double u1 = 1.0 - random.nextDouble();
+		const double u2 = random.nextDouble();
+		const double r = std::sqrt(-2.0 * std::log(u1));
+		m_noiseTable[i] = float(r * std::cos(2 * double_Pi * u2));
+		m_noiseTable[i + 1] = float(r * std::sin(2 * double_Pi * u2));
+	}
+
+	//sin(wt + phi) = sin(wt)cos(phi) + cos(wt)sin(phi), so channels only differ in the two gains
+	for (int c = 0; c < m_numChannels; c++)
+	{
+		const double phase = 2 * double_Pi * c / jmax(1, m_numChannels);
+		m_sinGain[c] = float(settings.sineAmplitude * std::cos(phase));
+		m_cosGain[c] = float(settings.sineAmplitude * std::sin(phase));
+		m_spikeGain[c] = settings.spikeAmplitude * (0.5f + 0.5f * random.nextFloat());
+
+		//Each channel draws its spike times from its own sequence, advanced once per spike
+		m_spikeSeed[c] = m_seed * 104729 + c;
+		m_lastSpike[c] = std::numeric_limits<int64>::min() / 2;
+		m_nextSpike[c] = drawSpikeInterval(c);
+	}
+
+	m_ttlIntervalSamples = jmax(int64(1), int64(settings.ttlInterval * m_sampleRate / 1000.0f));
+	if (m_numTTLLines >= 64)
+		m_ttlMask = ~uint64(0);
+	else
+		m_ttlMask = (uint64(1) << jmax(0, m_numTTLLines)) - 1;
+}
+
+int64 SyntheticSignalGenerator::drawSpikeInterval(int channel)
+{
+	if (m_settings.spikeRate <= 0)
+		return std::numeric_limits<int64>::max() / 2;
+
+	const double meanInterval = jmax(0.0, double(m_sampleRate) / m_settings.spikeRate - double(m_refractorySamples));
+	Random random(m_spikeSeed[channel]);
+	const double u = random.nextDouble();
+	m_spikeSeed[channel] = random.getSeed();
+
+	return m_refractorySamples + int64(-std::log(1.0 - u) * meanInterval);
+}
+
+void SyntheticSignalGenerator::generateBlock(int nSamples)
+{
+	jassert(nSamples <= m_maxBlockSize);
+	nSamples = jmin(nSamples, m_maxBlockSize);
+
+	const bool hasSine = m_settings.sineAmplitude != 0;
+	if (hasSine)
+	{
+		const double w = 2 * double_Pi * m_settings.sineFrequency / m_sampleRate;
+		const double basePhase = std::fmod(w * double(m_sampleNumber), 2 * double_Pi);
+		for (int i = 0; i < nSamples; i++)
+		{
+			m_sinBlock[i] = float(std::sin(basePhase + w * i));
+			m_cosBlock[i] = float(std::cos(basePhase + w * i));
+		}
+	}
+
+	for (int c = 0; c < m_numChannels; c++)
+	{
+		float* dest = m_block.getWritePointer(c);
+
+		addNoise(dest, c, nSamples);
+
+		if (hasSine)
+		{
+			FloatVectorOperations::addWithMultiply(dest, m_sinBlock, m_sinGain[c], nSamples);
+			FloatVectorOperations::addWithMultiply(dest, m_cosBlock, m_cosGain[c], nSamples);
+		}
+
+		addSpikes(dest, c, nSamples);
+	}
+
+	int64 counter = m_sampleNumber / m_ttlIntervalSamples;
+	int64 remaining = m_ttlIntervalSamples - (m_sampleNumber % m_ttlIntervalSamples);
+	for (int i = 0; i < nSamples; i++)
+	{
+		m_timestamps[i] = m_sampleNumber + i;
+		m_eventCodes[i] = uint64(counter) & m_ttlMask;
+		if (--remaining == 0)
+		{
+			counter++;
+			remaining = m_ttlIntervalSamples;
+		}
+	}
+
+	m_sampleNumber += nSamples;
+}
+
+int SyntheticSignalGenerator::getNoiseOffset(int channel, int64 pass) const
+{
+	Random random(m_seed ^ (int64(channel) << 40) ^ (pass * 2654435761LL));
+	return random.nextInt(noiseTableSize);
+}
+
+void SyntheticSignalGenerator::addNoise(float* dest, int c, int nSamples)
+{
+	//Sample n of a channel reads the table at n plus an offset drawn once per pass over the table,
+	//so the noise neither depends on block boundaries nor repeats every table length
+	int64 sample = m_sampleNumber;
+	int done = 0;
+	while (done < nSamples)
+	{
+		const int64 pass = sample / noiseTableSize;
+		const int position = int(sample % noiseTableSize);
+		const int index = (position + getNoiseOffset(c, pass)) % noiseTableSize;
+		const int n = jmin(nSamples - done, noiseTableSize - position, noiseTableSize - index);
+		FloatVectorOperations::copyWithMultiply(dest + done, m_noiseTable + index, m_settings.noiseAmplitude, n);
+		done += n;
+		sample += n;
+	}
+}
+
+void SyntheticSignalGenerator::addSpikes(float* dest, int c, int nSamples)
+{
+	const int64 blockStart = m_sampleNumber;
+	const int64 blockEnd = blockStart + nSamples;
+
+	//Tail of a spike that started in the previous block. The refractory period guarantees there is at most one
+	const int64 last = m_lastSpike[c];
+	if (last < blockStart && last + m_spikeLength > blockStart)
+	{
+		const int offset = int(blockStart - last);
+		FloatVectorOperations::addWithMultiply(dest, m_spikeWaveform + offset, m_spikeGain[c], jmin(m_spikeLength - offset, nSamples));
+	}
+
+	while (m_nextSpike[c] < blockEnd)
+	{
+		const int64 start = m_nextSpike[c];
+		const int pos = int(start - blockStart);
+		FloatVectorOperations::addWithMultiply(dest + pos, m_spikeWaveform, m_spikeGain[c], jmin(m_spikeLength, nSamples - pos));
+		m_lastSpike[c] = start;
+		m_nextSpike[c] = start + drawSpikeInterval(c);
+	}
+}
+
+const float* const* SyntheticSignalGenerator::getChannelData() const
+{
+	return m_block.getArrayOfReadPointers();
+}
+
+const int64* SyntheticSignalGenerator::getTimestamps() const { return m_timestamps; }
+const uint64* SyntheticSignalGenerator::getEventCodes() const { return m_eventCodes; }
+int64 SyntheticSignalGenerator::getNextSampleNumber() const { return m_sampleNumber; }
+int SyntheticSignalGenerator::getNumChannels() const { return m_numChannels; }
+float SyntheticSignalGenerator::getSampleRate() const { return m_sampleRate; }
+int SyntheticSignalGenerator::getMaxBlockSize() const { return m_maxBlockSize; }
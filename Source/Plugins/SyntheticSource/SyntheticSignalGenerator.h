@@ -0,0 +1,121 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SYNTHETICSIGNALGENERATOR_H_INCLUDED
+#define SYNTHETICSIGNALGENERATOR_H_INCLUDED
+
+#include <BasicJuceHeader.h>
+
+/** Signal parameters shared by every subprocessor of a synthetic source.
+    Amplitudes are in microvolts. */
+struct SyntheticSignalSettings
+{
+	float noiseAmplitude{ 10.0f };
+	float sineFrequency{ 8.0f };
+	float sineAmplitude{ 50.0f };
+	float spikeRate{ 5.0f };
+	float spikeAmplitude{ 120.0f };
+	float ttlInterval{ 100.0f }; //milliseconds between TTL word increments
+	int64 seed{ 1 };
+};
+
+/**
+	Deterministic generator for one synthetic subprocessor.
+
+	Produces channel-major blocks of gaussian noise, a per-channel phase shifted sinusoid
+	and spike-like transients at Poisson times, plus a binary counter TTL word. All the
+	per-channel work is done with FloatVectorOperations over whole blocks; the only
+	per-sample scalar loops are the shared sine/cosine reference and the TTL word.
+	The output only depends on the parameters, the seed and the sample number, so the
+	same seed gives the same samples however generation is split into blocks.
+
+	@see SyntheticThread
+*/
+class SyntheticSignalGenerator
+{
+public:
+	SyntheticSignalGenerator(int numChannels, float sampleRate, int numTTLLines, int maxBlockSize);
+	~SyntheticSignalGenerator();
+
+	/** Restarts generation from sample zero using the given settings */
+	void reset(const SyntheticSignalSettings& settings, int subProcessorIdx);
+
+	/** Generates the next nSamples (at most getMaxBlockSize()) into the internal block */
+	void generateBlock(int nSamples);
+
+	/** Per-channel pointers to the last generated block */
+	const float* const* getChannelData() const;
+
+	const int64* getTimestamps() const;
+	const uint64* getEventCodes() const;
+
+	/** Sample number of the first sample the next call to generateBlock will produce */
+	int64 getNextSampleNumber() const;
+
+	int getNumChannels() const;
+	float getSampleRate() const;
+	int getMaxBlockSize() const;
+
+private:
+	void createSpikeWaveform();
+	void addNoise(float* dest, int channel, int nSamples);
+	int getNoiseOffset(int channel, int64 pass) const;
+	void addSpikes(float* dest, int channel, int nSamples);
+	int64 drawSpikeInterval(int channel);
+
+	const int m_numChannels;
+	const float m_sampleRate;
+	const int m_numTTLLines;
+	const int m_maxBlockSize;
+
+	SyntheticSignalSettings m_settings;
+	int64 m_seed;
+
+	AudioSampleBuffer m_block;
+	HeapBlock<int64> m_timestamps;
+	HeapBlock<uint64> m_eventCodes;
+
+	HeapBlock<float> m_noiseTable;
+	HeapBlock<float> m_sinBlock;
+	HeapBlock<float> m_cosBlock;
+	HeapBlock<float> m_sinGain;
+	HeapBlock<float> m_cosGain;
+
+	HeapBlock<float> m_spikeWaveform;
+	HeapBlock<float> m_spikeGain;
+	HeapBlock<int64> m_nextSpike;
+	HeapBlock<int64> m_lastSpike;
+	HeapBlock<int64> m_spikeSeed; //state of each channel's spike time sequence
+	int m_spikeLength;
+	int64 m_refractorySamples;
+
+	int64 m_sampleNumber;
+	int64 m_ttlIntervalSamples;
+	uint64 m_ttlMask;
+
+	static const int noiseTableSize = 1 << 16;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticSignalGenerator);
+};
+
+#endif  // SYNTHETICSIGNALGENERATOR_H_INCLUDED
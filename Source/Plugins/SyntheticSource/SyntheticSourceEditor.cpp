@@ -0,0 +1,226 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SyntheticSourceEditor.h"
+#include "SyntheticThread.h"
+
+SyntheticSourceEditor::SyntheticSourceEditor(GenericProcessor* parentNode, SyntheticThread* thread)
+	: GenericEditor(parentNode, false), m_thread(thread)
+{
+	desiredWidth = 270;
+
+	addField(CHANNELS, "Channels", "Number of channels of each subprocessor, comma separated");
+	addField(RATES, "Rates", "Sample rate of each subprocessor in Hz, comma separated");
+	addField(TTL_LINES, "TTL lines", "Number of TTL lines per subprocessor (0-64)");
+	addField(TTL_INTERVAL, "TTL ms", "Interval between TTL word changes. Line N toggles every 2^N intervals");
+	addField(SPEED, "Speed", "Multiple of real time. 0 generates data as fast as it is consumed");
+	addField(SEED, "Seed", "Random seed. The same seed always produces the same data");
+	addField(NOISE, "Noise uV", "Standard deviation of the gaussian noise");
+	addField(SINE_FREQUENCY, "Sine Hz", "Frequency of the sinusoid added to every channel");
+	addField(SINE_AMPLITUDE, "Sine uV", "Amplitude of the sinusoid added to every channel");
+	addField(SPIKE_RATE, "Spike Hz", "Mean spike rate per channel");
+	addField(SPIKE_AMPLITUDE, "Spike uV", "Maximum spike trough amplitude");
+
+	updateLabels();
+}
+
+SyntheticSourceEditor::~SyntheticSourceEditor()
+{
+}
+
+void SyntheticSourceEditor::addField(Field field, const String& name, const String& tooltip)
+{
+	const int column = field < NOISE ? 0 : 1;
+	const int row = column == 0 ? field : field - NOISE;
+	const int x = 5 + column * 130;
+	const int y = 27 + row * 17;
+
+	Label* nameLabel = new Label(name, name);
+	nameLabel->setFont(Font("Small Text", 11, Font::plain));
+	nameLabel->setBounds(x, y, 60, 16);
+	nameLabel->setColour(Label::textColourId, Colours::darkgrey);
+	addAndMakeVisible(nameLabel);
+	m_nameLabels.add(nameLabel);
+
+	Label* valueLabel = new Label(name + " value", String::empty);
+	valueLabel->setFont(Font("Default", 12, Font::plain));
+	valueLabel->setBounds(x + 60, y, 65, 16);
+	valueLabel->setColour(Label::textColourId, Colours::white);
+	valueLabel->setColour(Label::backgroundColourId, Colours::grey);
+	valueLabel->setEditable(true);
+	valueLabel->setTooltip(tooltip);
+	valueLabel->addListener(this);
+	addAndMakeVisible(valueLabel);
+	m_valueLabels.add(valueLabel);
+}
+
+void SyntheticSourceEditor::setFieldText(Field field, const String& text)
+{
+	m_valueLabels[field]->setText(text, dontSendNotification);
+}
+
+String SyntheticSourceEditor::getFieldText(Field field) const
+{
+	return m_valueLabels[field]->getText();
+}
+
+void SyntheticSourceEditor::labelTextChanged(Label* label)
+{
+	applySettings();
+}
+
+void SyntheticSourceEditor::applySettings()
+{
+	Array<int> oldChannels;
+	Array<float> oldRates;
+	m_thread->getLayout(oldChannels, oldRates);
+	const int oldTTLLines = m_thread->getNumTTLLines();
+
+	StringArray channelTokens, rateTokens;
+	channelTokens.addTokens(getFieldText(CHANNELS), ",; ", String::empty);
+	channelTokens.removeEmptyStrings();
+	rateTokens.addTokens(getFieldText(RATES), ",; ", String::empty);
+	rateTokens.removeEmptyStrings();
+
+	Array<int> channels;
+	Array<float> rates;
+	for (int i = 0; i < channelTokens.size(); i++)
+	{
+		int nChans = channelTokens[i].getIntValue();
+		if (nChans <= 0)
+		{
+			CoreServices::sendStatusMessage("Invalid channel count: " + channelTokens[i]);
+			updateLabels();
+			return;
+		}
+		//Missing rates repeat the last one given
+		float rate = rateTokens.size() > 0 ? rateTokens[jmin(i, rateTokens.size() - 1)].getFloatValue() : 30000.0f;
+		if (rate <= 0)
+		{
+			CoreServices::sendStatusMessage("Invalid sample rate: " + rateTokens[jmin(i, rateTokens.size() - 1)]);
+			updateLabels();
+			return;
+		}
+		channels.add(nChans);
+		rates.add(rate);
+	}
+	if (channels.size() == 0)
+	{
+		CoreServices::sendStatusMessage("At least one subprocessor is needed");
+		updateLabels();
+		return;
+	}
+
+	SyntheticSignalSettings settings;
+	settings.noiseAmplitude = jmax(0.0f, getFieldText(NOISE).getFloatValue());
+	settings.sineFrequency = getFieldText(SINE_FREQUENCY).getFloatValue();
+	settings.sineAmplitude = getFieldText(SINE_AMPLITUDE).getFloatValue();
+	settings.spikeRate = jmax(0.0f, getFieldText(SPIKE_RATE).getFloatValue());
+	settings.spikeAmplitude = getFieldText(SPIKE_AMPLITUDE).getFloatValue();
+	settings.ttlInterval = jmax(0.0f, getFieldText(TTL_INTERVAL).getFloatValue());
+	settings.seed = getFieldText(SEED).getLargeIntValue();
+
+	m_thread->setLayout(channels, rates);
+	m_thread->setNumTTLLines(getFieldText(TTL_LINES).getIntValue());
+	m_thread->setSignalSettings(settings);
+	m_thread->setSpeed(jmax(0.0f, getFieldText(SPEED).getFloatValue()));
+
+	updateLabels();
+
+	if (channels != oldChannels || rates != oldRates || m_thread->getNumTTLLines() != oldTTLLines)
+		CoreServices::updateSignalChain(this);
+}
+
+void SyntheticSourceEditor::updateLabels()
+{
+	Array<int> channels;
+	Array<float> rates;
+	m_thread->getLayout(channels, rates);
+
+	StringArray channelText, rateText;
+	for (int i = 0; i < channels.size(); i++)
+	{
+		channelText.add(String(channels[i]));
+		rateText.add(String(rates[i]));
+	}
+	setFieldText(CHANNELS, channelText.joinIntoString(","));
+	setFieldText(RATES, rateText.joinIntoString(","));
+	setFieldText(TTL_LINES, String(m_thread->getNumTTLLines()));
+	setFieldText(SPEED, String(m_thread->getSpeed()));
+
+	const SyntheticSignalSettings& settings = m_thread->getSignalSettings();
+	setFieldText(TTL_INTERVAL, String(settings.ttlInterval));
+	setFieldText(SEED, String(settings.seed));
+	setFieldText(NOISE, String(settings.noiseAmplitude));
+	setFieldText(SINE_FREQUENCY, String(settings.sineFrequency));
+	setFieldText(SINE_AMPLITUDE, String(settings.sineAmplitude));
+	setFieldText(SPIKE_RATE, String(settings.spikeRate));
+	setFieldText(SPIKE_AMPLITUDE, String(settings.spikeAmplitude));
+}
+
+void SyntheticSourceEditor::startAcquisition()
+{
+	for (int i = 0; i < m_valueLabels.size(); i++)
+		m_valueLabels[i]->setEditable(false);
+}
+
+void SyntheticSourceEditor::stopAcquisition()
+{
+	for (int i = 0; i < m_valueLabels.size(); i++)
+		m_valueLabels[i]->setEditable(true);
+}
+
+void SyntheticSourceEditor::saveCustomParameters(XmlElement* xml)
+{
+	XmlElement* settingsXml = xml->createNewChildElement("SYNTHETIC");
+	settingsXml->setAttribute("channels", getFieldText(CHANNELS));
+	settingsXml->setAttribute("rates", getFieldText(RATES));
+	settingsXml->setAttribute("ttlLines", getFieldText(TTL_LINES));
+	settingsXml->setAttribute("ttlInterval", getFieldText(TTL_INTERVAL));
+	settingsXml->setAttribute("speed", getFieldText(SPEED));
+	settingsXml->setAttribute("seed", getFieldText(SEED));
+	settingsXml->setAttribute("noise", getFieldText(NOISE));
+	settingsXml->setAttribute("sineFrequency", getFieldText(SINE_FREQUENCY));
+	settingsXml->setAttribute("sineAmplitude", getFieldText(SINE_AMPLITUDE));
+	settingsXml->setAttribute("spikeRate", getFieldText(SPIKE_RATE));
+	settingsXml->setAttribute("spikeAmplitude", getFieldText(SPIKE_AMPLITUDE));
+}
+
+void SyntheticSourceEditor::loadCustomParameters(XmlElement* xml)
+{
+	forEachXmlChildElementWithTagName(*xml, settingsXml, "SYNTHETIC")
+	{
+		setFieldText(CHANNELS, settingsXml->getStringAttribute("channels", getFieldText(CHANNELS)));
+		setFieldText(RATES, settingsXml->getStringAttribute("rates", getFieldText(RATES)));
+		setFieldText(TTL_LINES, settingsXml->getStringAttribute("ttlLines", getFieldText(TTL_LINES)));
+		setFieldText(TTL_INTERVAL, settingsXml->getStringAttribute("ttlInterval", getFieldText(TTL_INTERVAL)));
+		setFieldText(SPEED, settingsXml->getStringAttribute("speed", getFieldText(SPEED)));
+		setFieldText(SEED, settingsXml->getStringAttribute("seed", getFieldText(SEED)));
+		setFieldText(NOISE, settingsXml->getStringAttribute("noise", getFieldText(NOISE)));
+		setFieldText(SINE_FREQUENCY, settingsXml->getStringAttribute("sineFrequency", getFieldText(SINE_FREQUENCY)));
+		setFieldText(SINE_AMPLITUDE, settingsXml->getStringAttribute("sineAmplitude", getFieldText(SINE_AMPLITUDE)));
+		setFieldText(SPIKE_RATE, settingsXml->getStringAttribute("spikeRate", getFieldText(SPIKE_RATE)));
+		setFieldText(SPIKE_AMPLITUDE, settingsXml->getStringAttribute("spikeAmplitude", getFieldText(SPIKE_AMPLITUDE)));
+		applySettings();
+	}
+}
@@ -0,0 +1,87 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SYNTHETICSOURCEEDITOR_H_INCLUDED
+#define SYNTHETICSOURCEEDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+class SyntheticThread;
+
+/**
+	User interface for the synthetic source.
+
+	"Channels" and "Rates" accept comma separated lists, one entry per subprocessor
+	(e.g. "1024,8" and "30000,2500"). A speed of 0 generates data as fast as it is consumed.
+
+	@see SyntheticThread
+*/
+class SyntheticSourceEditor : public GenericEditor, public Label::Listener
+{
+public:
+	SyntheticSourceEditor(GenericProcessor* parentNode, SyntheticThread* thread);
+	~SyntheticSourceEditor();
+
+	void labelTextChanged(Label* label) override;
+
+	void startAcquisition() override;
+	void stopAcquisition() override;
+
+	void saveCustomParameters(XmlElement* xml) override;
+	void loadCustomParameters(XmlElement* xml) override;
+
+private:
+	enum Field
+	{
+		CHANNELS = 0,
+		RATES,
+		TTL_LINES,
+		TTL_INTERVAL,
+		SPEED,
+		SEED,
+		NOISE,
+		SINE_FREQUENCY,
+		SINE_AMPLITUDE,
+		SPIKE_RATE,
+		SPIKE_AMPLITUDE,
+		NUM_FIELDS
+	};
+
+	void addField(Field field, const String& name, const String& tooltip);
+	void setFieldText(Field field, const String& text);
+	String getFieldText(Field field) const;
+
+	/** Pushes the label contents to the thread, updating the signal chain if the channel layout changed */
+	void applySettings();
+
+	/** Rewrites every label from the current thread configuration */
+	void updateLabels();
+
+	SyntheticThread* m_thread;
+	OwnedArray<Label> m_nameLabels;
+	OwnedArray<Label> m_valueLabels;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticSourceEditor);
+};
+
+#endif  // SYNTHETICSOURCEEDITOR_H_INCLUDED
@@ -0,0 +1,214 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SyntheticThread.h"
+#include "SyntheticSourceEditor.h"
+
+SyntheticThread::SyntheticThread(SourceNode* sn)
+	: DataThread(sn),
+	m_numTTLLines(8),
+	m_speed(1.0f),
+	m_startTicks(0)
+{
+	m_numChannels.add(64);
+	m_sampleRates.add(30000.0f);
+}
+
+SyntheticThread::~SyntheticThread()
+{
+}
+
+bool SyntheticThread::foundInputSource()
+{
+	return true;
+}
+
+void SyntheticThread::resizeBuffers()
+{
+	int nSub = m_numChannels.size();
+
+	while (sourceBuffers.size() > nSub)
+		sourceBuffers.removeLast();
+
+	for (int i = 0; i < nSub; i++)
+	{
+		if (i < sourceBuffers.size())
+			sourceBuffers[i]->resize(m_numChannels[i], bufferSize);
+		else
+			sourceBuffers.add(new DataBuffer(m_numChannels[i], bufferSize));
+	}
+}
+
+bool SyntheticThread::startAcquisition()
+{
+	m_generators.clear();
+	for (int i = 0; i < m_numChannels.size(); i++)
+	{
+		SyntheticSignalGenerator* gen = new SyntheticSignalGenerator(m_numChannels[i], m_sampleRates[i], m_numTTLLines, blockSize);
+		gen->reset(m_settings, i);
+		m_generators.add(gen);
+		sourceBuffers[i]->clear();
+	}
+	m_droppedSamples = 0;
+	m_startTicks = Time::getHighResolutionTicks();
+
+	startThread();
+	return true;
+}
+
+bool SyntheticThread::stopAcquisition()
+{
+	if (isThreadRunning())
+		signalThreadShouldExit();
+
+	waitForThreadToExit(500);
+
+	if (m_droppedSamples.get() > 0)
+		std::cout << "Synthetic source dropped " << m_droppedSamples.get() << " samples" << std::endl;
+
+	return true;
+}
+
+bool SyntheticThread::updateBuffer()
+{
+	const double elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - m_startTicks) * m_speed;
+	bool generated = false;
+
+	for (int sub = 0; sub < m_generators.size(); sub++)
+	{
+		SyntheticSignalGenerator* gen = m_generators[sub];
+		DataBuffer* buffer = sourceBuffers[sub];
+
+		int64 target;
+		if (m_speed > 0)
+			target = int64(elapsed * gen->getSampleRate());
+		else
+			target = gen->getNextSampleNumber() + buffer->getNumFreeSamples();
+
+		while (gen->getNextSampleNumber() < target && !threadShouldExit())
+		{
+			const int nSamples = int(jmin(target - gen->getNextSampleNumber(), int64(gen->getMaxBlockSize())));
+			gen->generateBlock(nSamples);
+			const int written = buffer->addBlockToBuffer(gen->getChannelData(), gen->getTimestamps(), gen->getEventCodes(), nSamples);
+			if (written < nSamples)
+				m_droppedSamples += nSamples - written;
+			generated = true;
+		}
+	}
+
+	if (!generated)
+		wait(1);
+
+	return true;
+}
+
+int SyntheticThread::getNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx) const
+{
+	if (type == DataChannel::HEADSTAGE_CHANNEL)
+		return m_numChannels[subProcessorIdx];
+	return 0;
+}
+
+int SyntheticThread::getNumTTLOutputs(int subProcessorIdx) const
+{
+	return m_numTTLLines;
+}
+
+float SyntheticThread::getSampleRate(int subProcessorIdx) const
+{
+	return m_sampleRates[subProcessorIdx];
+}
+
+unsigned int SyntheticThread::getNumSubProcessors() const
+{
+	return m_numChannels.size();
+}
+
+float SyntheticThread::getBitVolts(const DataChannel* chan) const
+{
+	return 0.195f;
+}
+
+String SyntheticThread::getChannelUnits(int chanIndex) const
+{
+	return "uV";
+}
+
+GenericEditor* SyntheticThread::createEditor(SourceNode* sn)
+{
+	return new SyntheticSourceEditor(sn, this);
+}
+
+void SyntheticThread::setLayout(const Array<int>& numChannels, const Array<float>& sampleRates)
+{
+	jassert(numChannels.size() == sampleRates.size());
+	if (isThreadRunning() || numChannels.size() == 0 || numChannels.size() != sampleRates.size())
+		return;
+
+	m_numChannels = numChannels;
+	m_sampleRates = sampleRates;
+}
+
+void SyntheticThread::getLayout(Array<int>& numChannels, Array<float>& sampleRates) const
+{
+	numChannels = m_numChannels;
+	sampleRates = m_sampleRates;
+}
+
+void SyntheticThread::setNumTTLLines(int lines)
+{
+	if (!isThreadRunning())
+		m_numTTLLines = jlimit(0, 64, lines);
+}
+
+int SyntheticThread::getNumTTLLines() const
+{
+	return m_numTTLLines;
+}
+
+void SyntheticThread::setSignalSettings(const SyntheticSignalSettings& settings)
+{
+	if (!isThreadRunning())
+		m_settings = settings;
+}
+
+const SyntheticSignalSettings& SyntheticThread::getSignalSettings() const
+{
+	return m_settings;
+}
+
+void SyntheticThread::setSpeed(float speed)
+{
+	if (!isThreadRunning())
+		m_speed = speed;
+}
+
+float SyntheticThread::getSpeed() const
+{
+	return m_speed;
+}
+
+int64 SyntheticThread::getNumDroppedSamples() const
+{
+	return m_droppedSamples.get();
+}
@@ -0,0 +1,98 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SYNTHETICTHREAD_H_INCLUDED
+#define SYNTHETICTHREAD_H_INCLUDED
+
+#include <DataThreadHeaders.h>
+#include "SyntheticSignalGenerator.h"
+
+/**
+	Hardware-free data source that generates a known, reproducible load.
+
+	Each subprocessor has its own channel count and sample rate and is fed by a
+	SyntheticSignalGenerator. Data can be paced at any multiple of real time, or
+	produced as fast as the downstream DataBuffer accepts it (speed <= 0), which is
+	what headless benchmarks want.
+
+	Configuration can only be changed while acquisition is stopped.
+
+	@see DataThread, SyntheticSignalGenerator
+*/
+class SyntheticThread : public DataThread
+{
+public:
+	SyntheticThread(SourceNode* sn);
+	~SyntheticThread();
+
+	bool updateBuffer() override;
+	bool foundInputSource() override;
+	bool startAcquisition() override;
+	bool stopAcquisition() override;
+
+	int getNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx) const override;
+	int getNumTTLOutputs(int subProcessorIdx) const override;
+	float getSampleRate(int subProcessorIdx) const override;
+	unsigned int getNumSubProcessors() const override;
+	float getBitVolts(const DataChannel* chan) const override;
+	String getChannelUnits(int chanIndex) const override;
+
+	void resizeBuffers() override;
+
+	GenericEditor* createEditor(SourceNode* sn) override;
+
+	/** Sets one subprocessor per array entry. Both arrays must have the same size */
+	void setLayout(const Array<int>& numChannels, const Array<float>& sampleRates);
+	void getLayout(Array<int>& numChannels, Array<float>& sampleRates) const;
+
+	void setNumTTLLines(int lines);
+	int getNumTTLLines() const;
+
+	void setSignalSettings(const SyntheticSignalSettings& settings);
+	const SyntheticSignalSettings& getSignalSettings() const;
+
+	/** Multiple of real time at which data is generated. Values <= 0 generate data as fast as it is consumed */
+	void setSpeed(float speed);
+	float getSpeed() const;
+
+	/** Number of generated samples that did not fit in the buffers since acquisition started, summed over subprocessors */
+	int64 getNumDroppedSamples() const;
+
+private:
+	Array<int> m_numChannels;
+	Array<float> m_sampleRates;
+	int m_numTTLLines;
+	SyntheticSignalSettings m_settings;
+	float m_speed;
+
+	OwnedArray<SyntheticSignalGenerator> m_generators;
+	int64 m_startTicks;
+	Atomic<int64> m_droppedSamples;
+
+	static const int blockSize = 1024;
+	static const int bufferSize = 30000;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticThread);
+};
+
+#endif  // SYNTHETICTHREAD_H_INCLUDED
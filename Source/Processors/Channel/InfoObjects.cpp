@@ -63,15 +63,15 @@ HistoryObject::~HistoryObject()
 
 String HistoryObject::getHistoricString() const
 {
-	return m_historicString;
+	StringArray entries;
+	for (const HistoryEntry* e = m_history; e != nullptr; e = e->previous)
+		entries.insert(0, e->entry);
+	return entries.joinIntoString(" -> ");
 }
 
 void HistoryObject::addToHistoricString(String entry)
 {
-	if (m_historicString.isEmpty())
-		m_historicString = entry;
-	else
-		m_historicString += (" -> " + entry);
+	m_history = new HistoryEntry(entry, m_history);
 }
 
 //SourceProcessorInfo
@@ -215,7 +215,8 @@ DataChannel::DataChannel(const DataChannel& ch)
 		m_bitVolts(ch.m_bitVolts),
 		m_isEnabled(true),
 		m_isMonitored(false),
-		m_isRecording(false)
+		m_isRecording(false),
+		m_statistics(ch.m_statistics)
 {
 }
 
@@ -283,6 +284,17 @@ bool DataChannel::getRecordState() const
 	return m_isRecording;
 }
 
+ChannelStatistics::Channel DataChannel::getStatistics() const
+{
+	return m_statistics;
+}
+
+void DataChannel::setStatistics(ChannelStatistics* statistics, int index)
+{
+	m_statistics.statistics = statistics;
+	m_statistics.index = index;
+}
+
 void DataChannel::reset()
 {
 	m_bitVolts = 1.0f;
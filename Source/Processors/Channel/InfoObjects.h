@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../PluginManager/OpenEphysPlugin.h"
 #include "MetaData.h"
+#include "../GenericProcessor/ChannelStatistics.h"
 
 class GenericProcessor;
 
@@ -80,7 +81,19 @@ public:
 	void addToHistoricString(String entry);
 
 private:
-	String m_historicString;
+	//GenericProcessor shares the entry it adds between all the channels coming from the same history
+	friend class GenericProcessor;
+
+	/** Entries are chained to the ones added upstream and shared by reference, so copying an object
+	down the signal chain does not copy its history */
+	class HistoryEntry : public ReferenceCountedObject
+	{
+	public:
+		HistoryEntry(const String& e, HistoryEntry* prev) : entry(e), previous(prev) {}
+		const String entry;
+		const ReferenceCountedObjectPtr<HistoryEntry> previous;
+	};
+	ReferenceCountedObjectPtr<HistoryEntry> m_history;
 };
 
 class PLUGIN_API SourceProcessorInfo
@@ -254,6 +267,14 @@ public:
 	/** Informs whether or not the channel will record. */
 	bool getRecordState() const;
 
+	//--------- STATISTICS METHODS ----------//
+	/** Statistics of the channel's samples as output by the last processor that changed them.
+		Copies of the channel share them. */
+	ChannelStatistics::Channel getStatistics() const;
+
+	/** Sets the statistics of the channel, done by GenericProcessor::update() */
+	void setStatistics(ChannelStatistics* statistics, int index);
+
 	//---------- OTHER METHODS ------------//
 	/** Restores the default settings for a given channel. */
 	void reset();
@@ -268,6 +289,7 @@ private:
 	bool m_isMonitored{ false };
 	bool m_isRecording{ false };
 	String m_unitName{ "uV" };
+	ChannelStatistics::Channel m_statistics;
 
 	JUCE_LEAK_DETECTOR(DataChannel);
 };
@@ -106,8 +106,47 @@ int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes,
 }
 
 
+int DataBuffer::addBlockToBuffer (const float* const* data, const int64* timestamps, const uint64* eventCodes, int numItems)
+{
+    int startIndex1, blockSize1, startIndex2, blockSize2;
+
+    abstractFifo.prepareToWrite (numItems, startIndex1, blockSize1, startIndex2, blockSize2);
+
+    const int numWritten = blockSize1 + blockSize2;
+
+    if (numWritten <= 0)
+        return 0;
+
+    for (int chan = 0; chan < numChans; ++chan)
+    {
+        if (blockSize1 > 0)
+            buffer.copyFrom (chan, startIndex1, data[chan], blockSize1);
+
+        if (blockSize2 > 0)
+            buffer.copyFrom (chan, startIndex2, data[chan] + blockSize1, blockSize2);
+    }
+
+    memcpy (timestampBuffer + startIndex1, timestamps, blockSize1 * sizeof (int64));
+    memcpy (eventCodeBuffer + startIndex1, eventCodes, blockSize1 * sizeof (uint64));
+
+    if (blockSize2 > 0)
+    {
+        memcpy (timestampBuffer + startIndex2, timestamps + blockSize1, blockSize2 * sizeof (int64));
+        memcpy (eventCodeBuffer + startIndex2, eventCodes + blockSize1, blockSize2 * sizeof (uint64));
+    }
+
+    lastTimestamp = timestamps[numWritten - 1];
+
+    abstractFifo.finishedWrite (numWritten);
+
+    return numWritten;
+}
+
+
 int DataBuffer::getNumSamples() const { return abstractFifo.getNumReady(); }
 
+int DataBuffer::getNumFreeSamples() const { return abstractFifo.getFreeSpace(); }
+
 
 int DataBuffer::readAllFromBuffer (AudioSampleBuffer& data, uint64* timestamp, uint64* eventCodes, int maxSize, int dstStartChannel, int numChannels)
 {
@@ -55,6 +55,22 @@ public:
     */
     int addToBuffer (float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize=1);
 
+    /** Add a block of non-interleaved data to the buffer.
+
+        @param data Array of pointers, one per channel, each one pointing to numItems
+        consecutive samples.
+        @param timestamps Array of timestamps. Same length as numItems.
+        @param eventCodes Array of event codes. Same length as numItems.
+        @param numItems Total number of samples per channel.
+
+        @return The number of items actually written. May be less than numItems if
+        the buffer doesn't have space.
+    */
+    int addBlockToBuffer (const float* const* data, const int64* timestamps, const uint64* eventCodes, int numItems);
+
+    /** Returns the number of samples that can be written before the buffer is full.*/
+    int getNumFreeSamples() const;
+
     /** Returns the number of samples currently available in the buffer.*/
     int getNumSamples() const;
 
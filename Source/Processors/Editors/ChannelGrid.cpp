@@ -0,0 +1,465 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ChannelGrid.h"
+
+
+ChannelGrid::ChannelGrid()
+    : listener              (nullptr)
+    , clickingTogglesState  (true)
+    , radioMode             (false)
+    , fastSelectionMode     (false)
+    , cellWidth             (10)
+    , cellHeight            (10)
+    , minPadding            (0)
+    , numColumns            (1)
+    , padding               (0)
+    , hoverCell             (-1)
+    , mouseDownCell         (-1)
+    , firstDraggedCell      (-1)
+    , lastDraggedCell       (-1)
+    , selectByDragging      (false)
+{
+}
+
+
+ChannelGrid::~ChannelGrid()
+{
+}
+
+
+void ChannelGrid::setListener (Listener* newListener)
+{
+    listener = newListener;
+}
+
+
+void ChannelGrid::setNumCells (int numCells)
+{
+    numCells = jmax (0, numCells);
+
+    const int previousNumCells = labels.size();
+
+    if (numCells < previousNumCells)
+    {
+        labels.removeLast (previousNumCells - numCells);
+        flags.removeLast (previousNumCells - numCells);
+    }
+    else
+    {
+        labels.ensureStorageAllocated (numCells);
+        flags.ensureStorageAllocated (numCells);
+
+        for (int i = previousNumCells; i < numCells; ++i)
+        {
+            labels.add (i + 1);
+            flags.add (0);
+        }
+    }
+
+    if (hoverCell >= numCells)
+        hoverCell = -1;
+
+    if (mouseDownCell >= numCells)
+        mouseDownCell = -1;
+
+    repaint();
+}
+
+
+int ChannelGrid::getNumCells() const
+{
+    return labels.size();
+}
+
+
+void ChannelGrid::setCellLabel (int cell, int label)
+{
+    if (isPositiveAndBelow (cell, labels.size()) && labels.getUnchecked (cell) != label)
+    {
+        labels.set (cell, label);
+        repaintCell (cell);
+    }
+}
+
+
+int ChannelGrid::getCellLabel (int cell) const
+{
+    return labels[cell];
+}
+
+
+void ChannelGrid::setCellSelected (int cell, bool shouldBeSelected, NotificationType notification)
+{
+    if (! isPositiveAndBelow (cell, flags.size()) || isCellSelected (cell) == shouldBeSelected)
+        return;
+
+    // like a radio button group, the others are turned off before this one turns on
+    if (shouldBeSelected && radioMode)
+    {
+        for (int i = flags.size(); --i >= 0;)
+        {
+            if (i != cell && isCellSelected (i))
+                setCellSelected (i, false, notification);
+        }
+
+        // the listener may have removed it
+        if (! isPositiveAndBelow (cell, flags.size()))
+            return;
+    }
+
+    setFlag (cell, SELECTED, shouldBeSelected);
+
+    if (notification != dontSendNotification && listener != nullptr)
+        listener->channelGridCellClicked (this, cell);
+}
+
+
+bool ChannelGrid::isCellSelected (int cell) const
+{
+    return (flags[cell] & SELECTED) != 0;
+}
+
+
+void ChannelGrid::setCellEnabled (int cell, bool shouldBeEnabled)
+{
+    setFlag (cell, DISABLED, ! shouldBeEnabled);
+
+    if (! shouldBeEnabled && hoverCell == cell)
+        hoverCell = -1;
+}
+
+
+bool ChannelGrid::isCellEnabled (int cell) const
+{
+    return isPositiveAndBelow (cell, flags.size()) && (flags.getUnchecked (cell) & DISABLED) == 0;
+}
+
+
+void ChannelGrid::setCellHidden (int cell, bool shouldBeHidden)
+{
+    setFlag (cell, HIDDEN, shouldBeHidden);
+}
+
+
+void ChannelGrid::setClickingTogglesState (bool shouldToggle)
+{
+    if (clickingTogglesState != shouldToggle)
+    {
+        clickingTogglesState = shouldToggle;
+        repaint();
+    }
+}
+
+
+bool ChannelGrid::getClickingTogglesState() const
+{
+    return clickingTogglesState;
+}
+
+
+void ChannelGrid::setRadioMode (bool isRadioMode)
+{
+    radioMode = isRadioMode;
+}
+
+
+bool ChannelGrid::isRadioMode() const
+{
+    return radioMode;
+}
+
+
+void ChannelGrid::setFastSelectionModeEnabled (bool isFastSelectionMode)
+{
+    fastSelectionMode = isFastSelectionMode;
+}
+
+
+void ChannelGrid::setCellSize (int newCellWidth, int newCellHeight)
+{
+    cellWidth  = jmax (1, newCellWidth);
+    cellHeight = jmax (1, newCellHeight);
+
+    updateLayout();
+}
+
+
+void ChannelGrid::setMinPaddingBetweenCells (int newMinPadding)
+{
+    minPadding = jmax (0, newMinPadding);
+
+    updateLayout();
+}
+
+
+int ChannelGrid::getRequiredHeight (int width) const
+{
+    const int columns = jmax (1, width / (cellWidth + minPadding));
+    const int gap = jmax (minPadding, (width - columns * cellWidth) / jmax (columns - 1, 1));
+    const int rows = (labels.size() + columns - 1) / columns;
+
+    return rows > 0 ? rows * cellHeight + (rows - 1) * gap : 0;
+}
+
+
+int ChannelGrid::getCellAt (Point<int> position) const
+{
+    if (position.x < 0 || position.y < 0)
+        return -1;
+
+    const int column = position.x / (cellWidth + padding);
+    const int row    = position.y / (cellHeight + padding);
+
+    if (column >= numColumns)
+        return -1;
+
+    const int cell = row * numColumns + column;
+
+    // positions in the padding between cells do not hit anything
+    if (cell >= labels.size() || ! getCellBounds (cell).contains (position))
+        return -1;
+
+    return cell;
+}
+
+
+juce::Rectangle<int> ChannelGrid::getCellBounds (int cell) const
+{
+    const int row    = cell / numColumns;
+    const int column = cell % numColumns;
+
+    return juce::Rectangle<int> (column * (cellWidth + padding), row * (cellHeight + padding),
+                                 cellWidth, cellHeight);
+}
+
+
+void ChannelGrid::paint (Graphics& g)
+{
+    const juce::Rectangle<int> clip = g.getClipBounds();
+    const int rowHeight = cellHeight + padding;
+    const int numCells  = labels.size();
+
+    // only the rows inside the area being redrawn
+    const int firstRow = jmax (0, clip.getY() / rowHeight);
+    const int lastRow  = (clip.getBottom() - 1) / rowHeight;
+
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+        for (int column = 0; column < numColumns; ++column)
+        {
+            const int cell = row * numColumns + column;
+
+            if (cell >= numCells)
+                return;
+
+            if ((flags.getUnchecked (cell) & HIDDEN) != 0)
+                continue;
+
+            const juce::Rectangle<int> bounds = getCellBounds (cell);
+
+            if (bounds.intersects (clip))
+                paintCell (g, cell, bounds, cell == hoverCell);
+        }
+    }
+}
+
+
+void ChannelGrid::paintCell (Graphics& g, int cell, const juce::Rectangle<int>& bounds, bool isMouseOver)
+{
+    const bool enabled = isCellEnabled (cell);
+    const int label = labels.getUnchecked (cell);
+
+    if (isCellSelected (cell))
+        g.setColour (Colours::orange);
+    else
+        g.setColour (Colours::darkgrey);
+
+    if (isMouseOver)
+        g.setColour (Colours::white);
+
+    if (! enabled)
+        g.setColour (Colours::black);
+
+    g.fillRect (bounds);
+
+    g.setColour (Colours::black);
+    g.drawRect (bounds, 1);
+
+    if (! enabled)
+        g.setColour (Colours::grey);
+
+    if (label < 100)
+        g.setFont (10.f);
+    else
+        g.setFont (8.f);
+
+    if (label >= 0)
+        g.drawText (String (label), bounds, Justification::centred, true);
+}
+
+
+void ChannelGrid::resized()
+{
+    updateLayout();
+}
+
+
+void ChannelGrid::updateLayout()
+{
+    const int width = getWidth();
+
+    numColumns = jmax (1, width / (cellWidth + minPadding));
+    padding    = jmax (minPadding, (width - numColumns * cellWidth) / jmax (numColumns - 1, 1));
+
+    repaint();
+}
+
+
+void ChannelGrid::mouseMove (const MouseEvent& e)
+{
+    int cell = getCellAt (e.getPosition());
+
+    if (! isCellEnabled (cell))
+        cell = -1;
+
+    if (cell != hoverCell)
+    {
+        repaintCell (hoverCell);
+        hoverCell = cell;
+        repaintCell (hoverCell);
+    }
+}
+
+
+void ChannelGrid::mouseExit (const MouseEvent& e)
+{
+    repaintCell (hoverCell);
+    hoverCell = -1;
+}
+
+
+void ChannelGrid::mouseDown (const MouseEvent& e)
+{
+    const int cell = getCellAt (e.getPosition());
+
+    mouseDownCell    = isCellEnabled (cell) ? cell : -1;
+    firstDraggedCell = -1;
+    lastDraggedCell  = -1;
+    selectByDragging = false;
+}
+
+
+void ChannelGrid::mouseDrag (const MouseEvent& e)
+{
+    if (! fastSelectionMode
+        || radioMode
+        || ! clickingTogglesState
+        || ! e.mouseWasDraggedSinceMouseDown())
+        return;
+
+    selectByDragging = true;
+
+    // dragging selects the cells, shift + dragging deselects them
+    const bool shouldBeSelected = ! e.mods.isShiftDown();
+    const int cell = getCellAt (e.getPosition());
+
+    if (firstDraggedCell == -1 && cell >= 0)
+        firstDraggedCell = cell;
+
+    if (cell != -1 && cell != lastDraggedCell)
+    {
+        lastDraggedCell = cell;
+
+        const int fromCell = jmin (firstDraggedCell, lastDraggedCell);
+        const int toCell   = jmax (firstDraggedCell, lastDraggedCell);
+
+        for (int i = fromCell; i <= toCell && i < flags.size(); ++i)
+        {
+            if (isCellEnabled (i) && isCellSelected (i) != shouldBeSelected)
+                setCellSelected (i, shouldBeSelected, sendNotification);
+        }
+    }
+}
+
+
+void ChannelGrid::mouseUp (const MouseEvent& e)
+{
+    const int cell = mouseDownCell;
+    const bool wasSelectingByDragging = selectByDragging;
+
+    mouseDownCell    = -1;
+    firstDraggedCell = -1;
+    lastDraggedCell  = -1;
+    selectByDragging = false;
+
+    // like a button, a click counts if the mouse is released over the cell it was pressed on
+    if (! wasSelectingByDragging
+        && cell >= 0
+        && isCellEnabled (cell)
+        && getCellAt (e.getPosition()) == cell)
+    {
+        clickCell (cell);
+    }
+}
+
+
+void ChannelGrid::clickCell (int cell)
+{
+    if (clickingTogglesState)
+    {
+        const bool shouldBeSelected = radioMode || ! isCellSelected (cell);
+
+        if (shouldBeSelected != isCellSelected (cell))
+        {
+            setCellSelected (cell, shouldBeSelected, sendNotification);
+            return;
+        }
+    }
+
+    if (listener != nullptr)
+        listener->channelGridCellClicked (this, cell);
+}
+
+
+void ChannelGrid::setFlag (int cell, uint8 flag, bool on)
+{
+    if (! isPositiveAndBelow (cell, flags.size()))
+        return;
+
+    const uint8 oldFlags = flags.getUnchecked (cell);
+    const uint8 newFlags = (uint8) (on ? (oldFlags | flag) : (oldFlags & ~flag));
+
+    if (newFlags != oldFlags)
+    {
+        flags.set (cell, newFlags);
+        repaintCell (cell);
+    }
+}
+
+
+void ChannelGrid::repaintCell (int cell)
+{
+    if (isPositiveAndBelow (cell, labels.size()))
+        repaint (getCellBounds (cell));
+}
@@ -0,0 +1,159 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __CHANNELGRID_H_5A1E3C07__
+#define __CHANNELGRID_H_5A1E3C07__
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+
+  A grid of toggleable channel cells drawn by a single component.
+
+  Cells are not components: the grid keeps a label and a few state flags per cell,
+  paints only the cells inside the area being redrawn, and hit-tests the mouse itself,
+  so sources with thousands of channels cost a couple of arrays instead of a button
+  per channel. Changing a cell only repaints that cell.
+
+  Cells are laid out in rows, as many per row as fit the width of the grid. Put the
+  grid in a Viewport to scroll it; getRequiredHeight() gives the height it needs.
+
+  Clicking a cell toggles it like a toggle button, or turns it on and the others off
+  in radio mode. With fast selection enabled, dragging across cells selects the range
+  between the first and the current one, or deselects it if shift is held.
+
+  @see ChannelSelector
+
+*/
+
+class PLUGIN_API ChannelGrid : public Component
+{
+public:
+    ChannelGrid();
+    ~ChannelGrid();
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() {}
+
+        /** Called when a cell is clicked or changed by a radio group or a drag selection,
+            once its new state is set. */
+        virtual void channelGridCellClicked (ChannelGrid* grid, int cell) = 0;
+    };
+
+    /** Sets the listener that receives the cell clicks */
+    void setListener (Listener* listener);
+
+    /** Adds or removes cells at the end. New cells are enabled, not selected and labelled
+        with their index plus one. */
+    void setNumCells (int numCells);
+    int getNumCells() const;
+
+    void setCellLabel (int cell, int label);
+    int getCellLabel (int cell) const;
+
+    void setCellSelected (int cell, bool shouldBeSelected, NotificationType notification = dontSendNotification);
+    bool isCellSelected (int cell) const;
+
+    /** Disabled cells are drawn greyed out and ignore the mouse */
+    void setCellEnabled (int cell, bool shouldBeEnabled);
+    bool isCellEnabled (int cell) const;
+
+    /** Hidden cells leave a gap in the grid, e.g. while one is being dragged */
+    void setCellHidden (int cell, bool shouldBeHidden);
+
+    /** When off, clicks are still reported but do not change the cells */
+    void setClickingTogglesState (bool shouldToggle);
+    bool getClickingTogglesState() const;
+
+    /** In radio mode at most one cell is selected */
+    void setRadioMode (bool isRadioMode);
+    bool isRadioMode() const;
+
+    /** Enables selecting cells by dragging the mouse across them */
+    void setFastSelectionModeEnabled (bool isFastSelectionMode);
+
+    void setCellSize (int cellWidth, int cellHeight);
+    void setMinPaddingBetweenCells (int minPadding);
+
+    /** Height that holds all the cells at a given width */
+    int getRequiredHeight (int width) const;
+
+    /** Returns the cell at a position, or -1 */
+    int getCellAt (Point<int> position) const;
+    juce::Rectangle<int> getCellBounds (int cell) const;
+
+    void paint (Graphics& g) override;
+    void resized() override;
+
+    void mouseMove (const MouseEvent& e) override;
+    void mouseExit (const MouseEvent& e) override;
+    void mouseDown (const MouseEvent& e) override;
+    void mouseDrag (const MouseEvent& e) override;
+    void mouseUp (const MouseEvent& e) override;
+
+protected:
+    /** Draws one cell, looking like an ElectrodeButton by default */
+    virtual void paintCell (Graphics& g, int cell, const juce::Rectangle<int>& bounds, bool isMouseOver);
+
+private:
+    enum
+    {
+        SELECTED = 1,
+        DISABLED = 2,
+        HIDDEN = 4
+    };
+
+    void clickCell (int cell);
+    void setFlag (int cell, uint8 flag, bool on);
+    void repaintCell (int cell);
+    void updateLayout();
+
+    Listener* listener;
+
+    Array<int> labels;
+    Array<uint8> flags;
+
+    bool clickingTogglesState;
+    bool radioMode;
+    bool fastSelectionMode;
+
+    int cellWidth;
+    int cellHeight;
+    int minPadding;
+    int numColumns;
+    int padding;
+
+    int hoverCell;
+    int mouseDownCell;
+    int firstDraggedCell;
+    int lastDraggedCell;
+    bool selectByDragging;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelGrid);
+};
+
+
+#endif  // __CHANNELGRID_H_5A1E3C07__
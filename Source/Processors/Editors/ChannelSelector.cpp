@@ -80,29 +80,34 @@ ChannelSelector::ChannelSelector(bool createButtons, Font& titleFont_) :
     noneButton->addListener(this);
     addAndMakeVisible(noneButton);
 
-    // Buttons managers
+    // Channel grids
     // ====================================================================
-    addAndMakeVisible (audioButtonsManager);
-    addAndMakeVisible (recordButtonsManager);
-    addAndMakeVisible (parameterButtonsManager);
-
-    // Enable fast mode selection for buttons
-    audioButtonsManager.setFastSelectionModeEnabled     (true);
-    recordButtonsManager.setFastSelectionModeEnabled    (true);
-    parameterButtonsManager.setFastSelectionModeEnabled (true);
-
-    audioButtonsManager.setMinPaddingBetweenButtons     (0);
-    recordButtonsManager.setMinPaddingBetweenButtons    (0);
-    parameterButtonsManager.setMinPaddingBetweenButtons (0);
-
-    audioButtonsManager.setColour       (ButtonGroupManager::outlineColourId, Colour (0x0));
-    recordButtonsManager.setColour      (ButtonGroupManager::outlineColourId, Colour (0x0));
-    parameterButtonsManager.setColour   (ButtonGroupManager::outlineColourId, Colour (0x0));
-
-    // Register listeners for buttons
-    audioButtonsManager.setButtonListener      (this);
-    recordButtonsManager.setButtonListener     (this);
-    parameterButtonsManager.setButtonListener  (this);
+    audioGrid     = new ChannelSelectorGrid (AUDIO, titleFont);
+    recordGrid    = new ChannelSelectorGrid (RECORD, titleFont);
+    parameterGrid = new ChannelSelectorGrid (PARAMETER, titleFont);
+
+    // Scrolled with the mouse wheel, without scrollbars
+    audioViewport.setViewedComponent     (audioGrid, false);
+    recordViewport.setViewedComponent    (recordGrid, false);
+    parameterViewport.setViewedComponent (parameterGrid, false);
+
+    audioViewport.setScrollBarsShown     (false, false, true, false);
+    recordViewport.setScrollBarsShown    (false, false, true, false);
+    parameterViewport.setScrollBarsShown (false, false, true, false);
+
+    addAndMakeVisible (audioViewport);
+    addAndMakeVisible (recordViewport);
+    addAndMakeVisible (parameterViewport);
+
+    // Enable fast mode selection for channels
+    audioGrid->setFastSelectionModeEnabled     (true);
+    recordGrid->setFastSelectionModeEnabled    (true);
+    parameterGrid->setFastSelectionModeEnabled (true);
+
+    // Register listeners for channels
+    audioGrid->setListener     (this);
+    recordGrid->setListener    (this);
+    parameterGrid->setListener (this);
     // ====================================================================
 
     // Slicer channels selectors
@@ -133,13 +138,13 @@ ChannelSelector::ChannelSelector(bool createButtons, Font& titleFont_) :
 
 ChannelSelector::~ChannelSelector()
 {
-    // Just a temporary workaround as we don't want to delete these buttons managers by hands.
+    // Just a temporary workaround as we don't want to delete these viewports by hands.
     // We will remove it after getting rid of the ugly calling of deleteAllChildren() method.
     // We should really use some RAII technuiqes to avoid calling this method.
     // TODO: refactor the code to follow RAII best principles and to avoid using raw pointers after merge with priyanjitdey94
-    removeChildComponent (&audioButtonsManager);
-    removeChildComponent (&recordButtonsManager);
-    removeChildComponent (&parameterButtonsManager);
+    removeChildComponent (&audioViewport);
+    removeChildComponent (&recordViewport);
+    removeChildComponent (&parameterViewport);
 
     removeChildComponent (&audioSlicerChannelSelector);
     removeChildComponent (&recordSlicerChannelSelector);
@@ -172,36 +177,29 @@ void ChannelSelector::paint(Graphics& g)
 
 void ChannelSelector::setNumChannels(int numChans)
 {
-    int difference = numChans - parameterButtonsManager.getNumButtons();
+    const int previousNumChans = parameterGrid->getNumCells();
 
-    // std::cout << difference << " buttons needed." << std::endl;
+    parameterGrid->setNumCells (numChans);
 
-    if (difference > 0)
-    {
-        for (int n = 0; n < difference; n++)
-        {
-            addButton();
-        }
-    }
-    else if (difference < 0)
+    if (isNotSink)
     {
-        for (int n = 0; n < -difference; n++)
-        {
-            removeButton();
-        }
+        recordGrid->setNumCells (numChans);
+        audioGrid->setNumCells  (numChans);
     }
 
-    const int numButtons = parameterButtonsManager.getNumButtons();
+    for (int n = previousNumChans; n < numChans; ++n)
+        parameterGrid->setCellSelected (n, paramsToggled);
+
     //Reassign numbers according to the actual channels (useful for channel mapper)
-    for (int n = 0; n < numButtons; ++n)
+    for (int n = 0; n < numChans; ++n)
     {
         int num = ( (GenericEditor*)getParentComponent())->getChannelDisplayNumber (n);
-        static_cast<ChannelSelectorButton*> (parameterButtonsManager.getButtonAt  (n))->setChannel (n + 1, num + 1);
+        parameterGrid->setCellLabel (n, num + 1);
 
         if (isNotSink)
         {
-            static_cast<ChannelSelectorButton*> (recordButtonsManager.getButtonAt (n))->setChannel (n + 1, num + 1);
-            static_cast<ChannelSelectorButton*> (audioButtonsManager.getButtonAt  (n))->setChannel (n + 1, num + 1);
+            recordGrid->setCellLabel (n, num + 1);
+            audioGrid->setCellLabel  (n, num + 1);
         }
     }
 
@@ -210,12 +208,12 @@ void ChannelSelector::setNumChannels(int numChans)
 
 int ChannelSelector::getNumChannels()
 {
-    return parameterButtonsManager.getNumButtons();
+    return parameterGrid->getNumCells();
 }
 
 void ChannelSelector::shiftChannelsVertical(float amount)
 {
-    if (parameterButtonsManager.getNumButtons() > 16)
+    if (parameterGrid->getNumCells() > 16)
     {
         offsetUD -= amount * 10;
         offsetUD = jmin(offsetUD, 0.0f);
@@ -232,9 +230,9 @@ void ChannelSelector::refreshButtonBoundaries()
     const int columnWidth   = getDesiredWidth() / (numColumnsGreaterThan100 + 1) + 1;
     const int rowHeight     = 14;
 
-    audioButtonsManager.setButtonSize      (columnWidth, rowHeight);
-    recordButtonsManager.setButtonSize     (columnWidth, rowHeight);
-    parameterButtonsManager.setButtonSize  (columnWidth, rowHeight);
+    audioGrid->setCellSize      (columnWidth, rowHeight);
+    recordGrid->setCellSize     (columnWidth, rowHeight);
+    parameterGrid->setCellSize  (columnWidth, rowHeight);
 
     const int xLoc = offsetLR + 3;
 
@@ -251,30 +249,34 @@ void ChannelSelector::refreshButtonBoundaries()
                                           .withY (audioSlicerChannelSelector.getY())
                                           .withHeight (audioSlicerChannelSelector.getHeight()));
 
-    // Set bounds for buttons managers
+    // Set bounds for channel grids
     // ===================================================================================================
     const int headerHeight              = 25;
     const int tabButtonHeight           = 15;
-    const int buttonsManagerWidth       = getDesiredWidth() - 6;
-    const int defaultButtonsManagerY    = headerHeight;
+    const int gridWidth                 = getDesiredWidth() - 6;
+    const int defaultGridY              = headerHeight;
 
     // We will use just some hacks to set initial y and height if height is zero,
-    // otherwise we will use the same bounds for buttons maangers
-    int buttonsManagerX = xLoc;
-    parameterButtonsManager.setBounds   (buttonsManagerX,
-                                         parameterButtonsManager.getHeight() == 0 ? defaultButtonsManagerY : parameterButtonsManager.getY(),
-                                         buttonsManagerWidth,
-                                         getHeight() - parameterButtonsManager.getY() - tabButtonHeight);
-    buttonsManagerX -= getDesiredWidth();
-    recordButtonsManager.setBounds      (buttonsManagerX,
-                                         recordButtonsManager.getHeight() == 0 ? defaultButtonsManagerY : recordButtonsManager.getY(),
-                                         buttonsManagerWidth,
-                                         getHeight() - recordButtonsManager.getY() - tabButtonHeight);
-    buttonsManagerX -= getDesiredWidth();
-    audioButtonsManager.setBounds       (buttonsManagerX,
-                                         audioButtonsManager.getHeight() == 0 ? defaultButtonsManagerY : audioButtonsManager.getY(),
-                                         buttonsManagerWidth,
-                                         getHeight() - audioButtonsManager.getY() - tabButtonHeight);
+    // otherwise we will use the same bounds for the grids
+    int gridX = xLoc;
+    parameterViewport.setBounds (gridX,
+                                 parameterViewport.getHeight() == 0 ? defaultGridY : parameterViewport.getY(),
+                                 gridWidth,
+                                 getHeight() - parameterViewport.getY() - tabButtonHeight);
+    gridX -= getDesiredWidth();
+    recordViewport.setBounds    (gridX,
+                                 recordViewport.getHeight() == 0 ? defaultGridY : recordViewport.getY(),
+                                 gridWidth,
+                                 getHeight() - recordViewport.getY() - tabButtonHeight);
+    gridX -= getDesiredWidth();
+    audioViewport.setBounds     (gridX,
+                                 audioViewport.getHeight() == 0 ? defaultGridY : audioViewport.getY(),
+                                 gridWidth,
+                                 getHeight() - audioViewport.getY() - tabButtonHeight);
+
+    parameterGrid->fitToParent();
+    recordGrid->fitToParent();
+    audioGrid->fitToParent();
     // ===================================================================================================
 
     /*
@@ -322,54 +324,16 @@ void ChannelSelector::timerCallback()
     refreshButtonBoundaries();
 }
 
-void ChannelSelector::addButton()
-{
-    const int size = parameterButtonsManager.getNumButtons();
-
-    ChannelSelectorButton* b = new ChannelSelectorButton (size + 1, PARAMETER, titleFont);
-    parameterButtonsManager.addButton (b);
-
-    if (paramsToggled)
-        b->setToggleState(true, dontSendNotification);
-    else
-        b->setToggleState(false, dontSendNotification);
-
-    if (!paramsActive)
-        b->setActive(false);
-
-    if (isNotSink)
-    {
-        ChannelSelectorButton* br = new ChannelSelectorButton(size + 1, RECORD, titleFont);
-        recordButtonsManager.addButton (br);
-
-        ChannelSelectorButton* ba = new ChannelSelectorButton(size + 1, AUDIO, titleFont);
-        audioButtonsManager.addButton (ba);
-    }
-}
-
-void ChannelSelector::removeButton()
-{
-    int size = parameterButtonsManager.getNumButtons();
-
-    parameterButtonsManager.removeButton (size - 1);
-
-    if (isNotSink)
-    {
-        recordButtonsManager.removeButton (size - 1);
-        audioButtonsManager.removeButton  (size - 1);
-    }
-}
-
 Array<int> ChannelSelector::getActiveChannels()
 {
     Array<int> a;
 
     if (! eventsOnly)
     {
-        const int numButtons = parameterButtonsManager.getNumButtons();
-        for (int i = 0; i < numButtons; ++i)
+        const int numChans = parameterGrid->getNumCells();
+        for (int i = 0; i < numChans; ++i)
         {
-            if (parameterButtonsManager.getButtonAt (i)->getToggleState())
+            if (parameterGrid->isCellSelected (i))
                 a.add (i);
         }
     }
@@ -385,17 +349,17 @@ void ChannelSelector::setActiveChannels(Array<int> a)
 {
     //std::cout << "Setting active channels!" << std::endl;
 
-    const int numButtons = parameterButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
+    const int numChans = parameterGrid->getNumCells();
+    for (int i = 0; i < numChans; ++i)
     {
-        parameterButtonsManager.getButtonAt (i)->setToggleState (false, dontSendNotification);
+        parameterGrid->setCellSelected (i, false, dontSendNotification);
     }
 
     for (int i = 0; i < a.size(); i++)
     {
-        if (a[i] < numButtons)
+        if (a[i] < numChans)
         {
-            parameterButtonsManager.getButtonAt (a[i])->setToggleState (true, dontSendNotification);
+            parameterGrid->setCellSelected (a[i], true, dontSendNotification);
         }
     }
 }
@@ -403,53 +367,25 @@ void ChannelSelector::setActiveChannels(Array<int> a)
 void ChannelSelector::inactivateButtons()
 {
     paramsActive = false;
-
-    const int numButtons = parameterButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (parameterButtonsManager.getButtonAt (i));
-        button->setActive (false);
-        button->repaint();
-    }
+    parameterGrid->setActive (false);
 }
 
 void ChannelSelector::activateButtons()
 {
     paramsActive = true;
-
-    const int numButtons = parameterButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (parameterButtonsManager.getButtonAt (i));
-        button->setActive (true);
-        button->repaint();
-    }
+    parameterGrid->setActive (true);
 }
 
 void ChannelSelector::inactivateRecButtons()
 {
     recActive = false;
-
-    const int numButtons = recordButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (recordButtonsManager.getButtonAt (i));
-        button->setActive (false);
-        button->repaint();
-    }
+    recordGrid->setActive (false);
 }
 
 void ChannelSelector::activateRecButtons()
 {
     recActive = true;
-
-    const int numButtons = recordButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (recordButtonsManager.getButtonAt (i));
-        button->setActive (true);
-        button->repaint();
-    }
+    recordGrid->setActive (true);
 }
 
 void ChannelSelector::refreshParameterColors()
@@ -479,63 +415,51 @@ void ChannelSelector::setRadioStatus(bool radioOn)
     {
         radioStatus = radioOn;
 
-        const int numButtons = parameterButtonsManager.getNumButtons();
-        for (int i = 0; i < numButtons; ++i)
+        const int numChans = parameterGrid->getNumCells();
+        for (int i = 0; i < numChans; ++i)
         {
-            parameterButtonsManager.getButtonAt (i)->setToggleState (false, dontSendNotification);
+            parameterGrid->setCellSelected (i, false, dontSendNotification);
         }
 
-        parameterButtonsManager.setRadioButtonMode (radioStatus);
+        parameterGrid->setRadioMode (radioStatus);
     }
 }
 
 bool ChannelSelector::getParamStatus(int chan)
 {
-    if (chan >= 0 && chan < parameterButtonsManager.getNumButtons())
-        return parameterButtonsManager.getButtonAt (chan)->getToggleState();
-    else
-        return false;
+    return parameterGrid->isCellSelected (chan);
 }
 
 bool ChannelSelector::getRecordStatus(int chan)
 {
-    if (chan >= 0 && chan < recordButtonsManager.getNumButtons())
-        return recordButtonsManager.getButtonAt (chan)->getToggleState();
-    else
-        return false;
+    return recordGrid->isCellSelected (chan);
 }
 
 bool ChannelSelector::getAudioStatus(int chan)
 {
-    if (chan >= 0 && chan < audioButtonsManager.getNumButtons())
-        return audioButtonsManager.getButtonAt (chan)->getToggleState();
-    else
-        return false;
+    return audioGrid->isCellSelected (chan);
 }
 
 void ChannelSelector::setParamStatus(int chan, bool b)
 {
-    if (chan >= 0 && chan < parameterButtonsManager.getNumButtons())
-        parameterButtonsManager.getButtonAt (chan)->setToggleState(b, sendNotification);
+    parameterGrid->setCellSelected (chan, b, sendNotification);
 }
 
 void ChannelSelector::setRecordStatus(int chan, bool b)
 {
-    if (chan >= 0 && chan < recordButtonsManager.getNumButtons())
-        recordButtonsManager.getButtonAt (chan)->setToggleState(b, sendNotification);
+    recordGrid->setCellSelected (chan, b, sendNotification);
 }
 
 void ChannelSelector::setAudioStatus(int chan, bool b)
 {
-    if (chan >= 0 && chan < audioButtonsManager.getNumButtons())
-        audioButtonsManager.getButtonAt (chan)->setToggleState (b, sendNotification);
+    audioGrid->setCellSelected (chan, b, sendNotification);
 }
 
 void ChannelSelector::clearAudio()
 {
-    const int numButtons = audioButtonsManager.getNumButtons();
-    for (int chan = 0; chan < numButtons; ++chan)
-        audioButtonsManager.getButtonAt (chan)->setToggleState (false, sendNotification);
+    const int numChans = audioGrid->getNumCells();
+    for (int chan = 0; chan < numChans; ++chan)
+        audioGrid->setCellSelected (chan, false, sendNotification);
 }
 
 int ChannelSelector::getDesiredWidth()
@@ -543,6 +467,30 @@ int ChannelSelector::getDesiredWidth()
     return 150;
 }
 
+ChannelSelectorGrid* ChannelSelector::getGrid (Channels::ChannelsType channelsType)
+{
+    if (channelsType == Channels::AUDIO_CHANNELS)
+        return audioGrid;
+    else if (channelsType == Channels::RECORD_CHANNELS)
+        return recordGrid;
+    else if (channelsType == Channels::PARAM_CHANNELS)
+        return parameterGrid;
+
+    return nullptr;
+}
+
+Viewport* ChannelSelector::getViewport (Channels::ChannelsType channelsType)
+{
+    if (channelsType == Channels::AUDIO_CHANNELS)
+        return &audioViewport;
+    else if (channelsType == Channels::RECORD_CHANNELS)
+        return &recordViewport;
+    else if (channelsType == Channels::PARAM_CHANNELS)
+        return &parameterViewport;
+
+    return nullptr;
+}
+
 void ChannelSelector::buttonClicked(Button* button)
 {
     //checkChannelSelectors();
@@ -591,17 +539,17 @@ void ChannelSelector::buttonClicked(Button* button)
         // select all active buttons
         if (offsetLR == recordOffset)
         {
-            for (int i = 0; i < recordButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < recordGrid->getNumCells(); ++i)
             {
-                recordButtonsManager.getButtonAt (i)->setToggleState (true, sendNotification);
+                recordGrid->setCellSelected (i, true, sendNotification);
             }
 
         }
         else if (offsetLR == parameterOffset)
         {
-            for (int i = 0; i < parameterButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < parameterGrid->getNumCells(); ++i)
             {
-                parameterButtonsManager.getButtonAt (i)->setToggleState (true, sendNotification);
+                parameterGrid->setCellSelected (i, true, sendNotification);
             }
         }
         else if (offsetLR == audioOffset)
@@ -614,23 +562,23 @@ void ChannelSelector::buttonClicked(Button* button)
         // deselect all active buttons
         if (offsetLR == recordOffset)
         {
-            for (int i = 0; i < recordButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < recordGrid->getNumCells(); ++i)
             {
-                recordButtonsManager.getButtonAt (i)->setToggleState (false, sendNotification);
+                recordGrid->setCellSelected (i, false, sendNotification);
             }
         }
         else if (offsetLR == parameterOffset)
         {
-            for (int i = 0; i < parameterButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < parameterGrid->getNumCells(); ++i)
             {
-                parameterButtonsManager.getButtonAt (i)->setToggleState (false, sendNotification);
+                parameterGrid->setCellSelected (i, false, sendNotification);
             }
         }
         else if (offsetLR == audioOffset)
         {
-            for (int i = 0; i < audioButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < audioGrid->getNumCells(); ++i)
             {
-                audioButtonsManager.getButtonAt (i)->setToggleState (false, sendNotification);
+                audioGrid->setCellSelected (i, false, sendNotification);
             }
         }
 
@@ -641,78 +589,73 @@ void ChannelSelector::buttonClicked(Button* button)
             editor->channelChanged (-1, false);
         }
     }
-    else
+    refreshParameterColors();
+}
+
+void ChannelSelector::channelGridCellClicked (ChannelGrid* grid, int cell)
+{
+    ChannelSelectorGrid* g = (ChannelSelectorGrid*) grid;
+    const int channel = cell + 1;
+
+    if (g->getType() == AUDIO)
     {
-        ChannelSelectorButton* b = (ChannelSelectorButton*)button;
+        // get audio node, and inform it of the change
+        GenericEditor* editor = (GenericEditor*)getParentComponent();
+
+        const DataChannel* ch = editor->getChannel(channel - 1);
+        bool status = g->isCellSelected(cell);
+
+        // change parameter directly on editor
+        //     This is another of those ugly things that will go away once the
+        //     probe audio system is implemented, but is needed to maintain compatibility
+        //     between the older recording system and the newer channel objects.
+        const_cast<DataChannel*>(ch)->setMonitored(status);
 
-        if (b->getType() == AUDIO)
+
+        if (acquisitionIsActive) // use setParameter to change audio node's copy of parameter safely, if running
         {
-            // get audio node, and inform it of the change
-            GenericEditor* editor = (GenericEditor*)getParentComponent();
-
-            const DataChannel* ch = editor->getChannel(b->getChannel() - 1);
-            //int channelNum = editor->getStartChannel() + b->getChannel() - 1;
-            bool status = b->getToggleState();
-
-         //   std::cout << "Requesting audio monitor for channel " << ch->nodeIndex + 1 << std::endl;
-            
-            // change parameter directly on editor
-            //     This is another of those ugly things that will go away once the
-            //     probe audio system is implemented, but is needed to maintain compatibility
-            //     between the older recording system and the newer channel objects.
-            const_cast<DataChannel*>(ch)->setMonitored(status);
-
-            
-            if (acquisitionIsActive) // use setParameter to change audio node's copy of parameter safely, if running
-            {
-                AccessClass::getProcessorGraph()->
-                getAudioNode()->setChannelStatus(ch, status);
-            }
+            AccessClass::getProcessorGraph()->
+            getAudioNode()->setChannelStatus(ch, status);
         }
-        else if (b->getType() == RECORD)
-        {
-			
-            // get record node, and inform it of the change
-            GenericEditor* editor = (GenericEditor*)getParentComponent();
+    }
+    else if (g->getType() == RECORD)
+    {
+        // get record node, and inform it of the change
+        GenericEditor* editor = (GenericEditor*)getParentComponent();
 
-            const DataChannel* ch = editor->getChannel(b->getChannel() - 1);
-            //int channelNum = editor->getStartChannel() + b->getChannel() - 1;
-            bool status = b->getToggleState();
+        const DataChannel* ch = editor->getChannel(channel - 1);
+        bool status = g->isCellSelected(cell);
 
-            if (acquisitionIsActive) // use setParameter to change parameter safely
-            {
-                               
-                // disable toggling when acquisition is active
-                b->setToggleState(const_cast<DataChannel*>(ch)->getRecordState(), dontSendNotification);
-            }
-            else     // change parameter directly
-            {
-                //std::cout << "Setting record status for channel " << b->getChannel() << std::endl;
+        if (acquisitionIsActive) // use setParameter to change parameter safely
+        {
+            // disable toggling when acquisition is active
+            g->setCellSelected(cell, const_cast<DataChannel*>(ch)->getRecordState(), dontSendNotification);
+        }
+        else     // change parameter directly
+        {
+            //This is another of those ugly things that will go away once the
+            //probe recording system is implemented, but is needed to maintain compatibility
+            //between the older recording system and the newer channel objects.
+            const_cast<DataChannel*>(ch)->setRecordState(status);
+        }
 
-				//This is another of those ugly things that will go away once the
-				//probe recording system is implemented, but is needed to maintain compatibility
-				//between the older recording system and the newer channel objects.
-                const_cast<DataChannel*>(ch)->setRecordState(status);
-            }
+        AccessClass::getGraphViewer()->repaint();
 
-            AccessClass::getGraphViewer()->repaint();
+    }
+    else // parameter type
+    {
+        GenericEditor* editor = (GenericEditor*) getParentComponent();
+        editor->channelChanged (channel - 1, g->isCellSelected(cell));
 
-        }
-        else // parameter type
+        // do nothing
+        if (radioStatus) // if radio buttons are active
         {
+            // send a message to parent
             GenericEditor* editor = (GenericEditor*) getParentComponent();
-            editor->channelChanged (b->getChannel() - 1, b->getToggleState());
-
-            // do nothing
-            if (radioStatus) // if radio buttons are active
-            {
-                // send a message to parent
-                GenericEditor* editor = (GenericEditor*) getParentComponent();
-                editor->channelChanged (b->getChannel(), b->getToggleState());
-            }
+            editor->channelChanged (channel, g->isCellSelected(cell));
         }
-
     }
+
     refreshParameterColors();
 }
 
@@ -721,19 +664,11 @@ void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelecto
                                                             Button* buttonThatWasClicked,
                                                             bool isSelect)
 {
-    const Channels::ChannelsType channelsType = sender->getChannelsType();
-
-    TiledButtonGroupManager* buttonsManager = nullptr;
-    if (channelsType == Channels::AUDIO_CHANNELS)
-        buttonsManager = &audioButtonsManager;
-    else if (channelsType == Channels::RECORD_CHANNELS)
-        buttonsManager = &recordButtonsManager;
-    else if (channelsType == Channels::PARAM_CHANNELS)
-        buttonsManager = &parameterButtonsManager;
+    ChannelSelectorGrid* grid = getGrid (sender->getChannelsType());
 
-    jassert (buttonsManager != nullptr);
+    jassert (grid != nullptr);
 
-    Array<int> getBoxList = ListSliceParser::parseStringIntoRange (sender->getText(), audioButtonsManager.getNumButtons());
+    Array<int> getBoxList = ListSliceParser::parseStringIntoRange (sender->getText(), grid->getNumCells());
     if (getBoxList.size() < 3)
         return;
 
@@ -744,7 +679,7 @@ void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelecto
         const int comd = getBoxList[i + 2];
         for (int fa = getBoxList[i]; fa <= lim; fa += comd)
         {
-            buttonsManager->getButtonAt (fa)->setToggleState (isSelect, sendNotification);
+            grid->setCellSelected (fa, isSelect, sendNotification);
         }
         i += 3;
     }
@@ -754,17 +689,9 @@ void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelecto
 void ChannelSelector::channelSelectorCollapsedStateChanged (SlicerChannelSelectorComponent* sender,
                                                             bool isCollapsed)
 {
-    const Channels::ChannelsType channelsType = sender->getChannelsType();
-
-    TiledButtonGroupManager* buttonsManager = nullptr;
-    if (channelsType == Channels::AUDIO_CHANNELS)
-        buttonsManager = &audioButtonsManager;
-    else if (channelsType == Channels::RECORD_CHANNELS)
-        buttonsManager = &recordButtonsManager;
-    else if (channelsType == Channels::PARAM_CHANNELS)
-        buttonsManager = &parameterButtonsManager;
+    Viewport* viewport = getViewport (sender->getChannelsType());
 
-    jassert (buttonsManager != nullptr);
+    jassert (viewport != nullptr);
 
     const int headerHeight      = 25;
     const int tabButtonHeight   = 15;
@@ -774,10 +701,10 @@ void ChannelSelector::channelSelectorCollapsedStateChanged (SlicerChannelSelecto
         yPos += SlicerChannelSelectorComponent::MAX_HEIGHT - 20;
 
     const int height = getHeight() - yPos - tabButtonHeight;
-    const juce::Rectangle<int> finalBounds (buttonsManager->getX(), yPos, buttonsManager->getWidth(), height);
+    const juce::Rectangle<int> finalBounds (viewport->getX(), yPos, viewport->getWidth(), height);
 
     auto& componentAnimator = Desktop::getInstance().getAnimator();
-    componentAnimator.animateComponent (buttonsManager, finalBounds, 1.f, DURATION_ANIMATION_COLLAPSE_MS, false, 1.0, 1.0);
+    componentAnimator.animateComponent (viewport, finalBounds, 1.f, DURATION_ANIMATION_COLLAPSE_MS, false, 1.0, 1.0);
 }
 
 ///////////// BUTTONS //////////////////////
@@ -979,47 +906,40 @@ void EditorButton::paintButton(Graphics& g, bool isMouseOver, bool isButtonDown)
 }
 
 
-ChannelSelectorButton::ChannelSelectorButton(int num_, int type_, Font& f) : Button("name")
+ChannelSelectorGrid::ChannelSelectorGrid(int type_, Font& f) : type(type_)
 {
-    isActive = true;
-    num = num_;
-    displayNum = num_;
-    type = type_;
-
-    setClickingTogglesState(true);
-
     buttonFont = f;
     buttonFont.setHeight (11);
 }
 
-ChannelSelectorButton::~ChannelSelectorButton() {}
+ChannelSelectorGrid::~ChannelSelectorGrid() {}
 
-int ChannelSelectorButton::getType()
+int ChannelSelectorGrid::getType()
 {
     return type;
 }
 
-int ChannelSelectorButton::getChannel()
+void ChannelSelectorGrid::setActive(bool t)
 {
-    return num;
+    setClickingTogglesState(t);
 }
 
-void ChannelSelectorButton::setChannel(int n)
+void ChannelSelectorGrid::fitToParent()
 {
-    num = n;
-    displayNum = n;
+    if (Component* parent = getParentComponent())
+        setSize(parent->getWidth(), jmax(parent->getHeight(), getRequiredHeight(parent->getWidth())));
 }
-void ChannelSelectorButton::setChannel(int n, int d)
+
+void ChannelSelectorGrid::parentSizeChanged()
 {
-    num = n;
-    displayNum = d;
+    fitToParent();
 }
 
-void ChannelSelectorButton::paintButton(Graphics& g, bool isMouseOver, bool isButtonDown)
+void ChannelSelectorGrid::paintCell(Graphics& g, int cell, const juce::Rectangle<int>& bounds, bool isMouseOver)
 {
-    if (isActive)
+    if (getClickingTogglesState())
     {
-        if (getToggleState() == true)
+        if (isCellSelected(cell))
             g.setColour(Colours::orange);
         else
             g.setColour(Colours::darkgrey);
@@ -1029,25 +949,15 @@ void ChannelSelectorButton::paintButton(Graphics& g, bool isMouseOver, bool isBu
     }
     else
     {
-        if (getToggleState() == true)
+        if (isCellSelected(cell))
             g.setColour(Colours::yellow);
         else
             g.setColour(Colours::lightgrey);
     }
 
-    // g.fillRect(0,0,getWidth(),getHeight());
-
     g.setFont(buttonFont);
 
-    // g.drawRect(0,0,getWidth(),getHeight(),1.0);
-
-    g.drawText(String(displayNum), 0, 0, getWidth(), getHeight(), Justification::centred, true);
-}
-
-void ChannelSelectorButton::setActive(bool t)
-{
-    isActive = t;
-    setClickingTogglesState(t);
+    g.drawText(String(getCellLabel(cell)), bounds, Justification::centred, true);
 }
 
 
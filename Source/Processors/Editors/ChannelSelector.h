@@ -26,13 +26,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../Editors/GenericEditor.h"
-#include "../../UI/Utils/TiledButtonGroupManager.h"
+#include "ChannelGrid.h"
 #include "../Channel/InfoObjects.h"
 
 #include <stdio.h>
 
 class ChannelSelectorRegion;
-class ChannelSelectorButton;
+class ChannelSelectorGrid;
 class EditorButton;
 class ChannelSelectorBox;
 class ShowAlertMessage;
@@ -127,6 +127,7 @@ channels to be selected for different purposes.
 class PLUGIN_API ChannelSelector : public Component
                                  , public Button::Listener
                                  , private SlicerChannelSelectorComponent::Listener
+                                 , private ChannelGrid::Listener
                                  , public Timer
 {
 public:
@@ -181,22 +182,22 @@ public:
     /** Called immediately after data acquisition ends.*/
     void stopAcquisition();
 
-    /** Inactivates all the ChannelSelectorButtons under the "param" tab.*/
+    /** Inactivates all the channels under the "param" tab.*/
     void inactivateButtons();
 
-    /** Activates all the ChannelSelectorButtons under the "param" tab.*/
+    /** Activates all the channels under the "param" tab.*/
     void activateButtons();
 
-    /** Inactivates all the ChannelSelectorButtons under the "rec" tab.*/
+    /** Inactivates all the channels under the "rec" tab.*/
     void inactivateRecButtons();
 
-    /** Activates all the ChannelSelectorButtons under the "rec" tab.*/
+    /** Activates all the channels under the "rec" tab.*/
     void activateRecButtons();
 
     /** Refreshes Parameter Colors on change*/
     void refreshParameterColors();
 
-    /** Controls the behavior of ChannelSelectorButtons; they can either behave
+    /** Controls the behavior of the channels; they can either behave
     like radio buttons (only one selected at a time) or like toggle buttons (an
     arbitrary number can be selected at once).*/
     void setRadioStatus(bool);
@@ -216,25 +217,25 @@ private:
     EditorButton* allButton;
     EditorButton* noneButton;
 
-    /** An array of ChannelSelectorButtons used to select the channels that
-    will be updated when a parameter is changed.
+    /** A grid of the channels that will be updated when a parameter is changed.
     paramBox: TextBox where user input is taken for param tab.
     */
-    TiledButtonGroupManager parameterButtonsManager;
+    ScopedPointer<ChannelSelectorGrid> parameterGrid;
+    Viewport parameterViewport;
     SlicerChannelSelectorComponent parameterSlicerChannelSelector;
 
-    /** An array of ChannelSelectorButtons used to select the channels that
-    are sent to the audio monitor.
+    /** A grid of the channels that are sent to the audio monitor.
     audioBox: TextBox where user input is taken for audio tab
     */
-    TiledButtonGroupManager audioButtonsManager;
+    ScopedPointer<ChannelSelectorGrid> audioGrid;
+    Viewport audioViewport;
     SlicerChannelSelectorComponent audioSlicerChannelSelector;
 
-    /** An array of ChannelSelectorButtons used to select the channels that
-    will be written to disk when the record button is pressed.
+    /** A grid of the channels that will be written to disk when the record button is pressed.
     recordBox: TextBox where user input is taken for record tab
     */
-    TiledButtonGroupManager recordButtonsManager;
+    ScopedPointer<ChannelSelectorGrid> recordGrid;
+    Viewport recordViewport;
     SlicerChannelSelectorComponent recordSlicerChannelSelector;
 
     bool paramsToggled;
@@ -261,10 +262,15 @@ private:
 
     void resized();
 
-    void addButton();
-    void removeButton();
     void refreshButtonBoundaries();
 
+    /** Returns the grid and viewport of the param, audio or record channels */
+    ChannelSelectorGrid* getGrid (Channels::ChannelsType channelsType);
+    Viewport* getViewport (Channels::ChannelsType channelsType);
+
+    /** Reacts to a click on a channel of one of the grids */
+    void channelGridCellClicked (ChannelGrid* grid, int cell) override;
+
     /** Controls the speed of animations. */
     void timerCallback();
 
@@ -330,35 +336,32 @@ private:
 
 /**
 
-A button within the ChannelSelector representing an individual channel.
+The channels of one tab of the ChannelSelector, drawn as their numbers.
 
 @see ChannelSelector
 
 */
 
-class ChannelSelectorButton : public Button
+class ChannelSelectorGrid : public ChannelGrid
 {
 public:
-    ChannelSelectorButton(int num, int type, Font& f);
-    ~ChannelSelectorButton();
+    ChannelSelectorGrid(int type, Font& f);
+    ~ChannelSelectorGrid();
 
     int getType();
-    int getChannel();
-    //Channel* getChannel() {return ch;}
+
+    /** Inactive channels report clicks but do not toggle */
     void setActive(bool t);
-    void setChannel(int n);
-    void setChannel(int n, int d);
 
-private:
-    void paintButton(Graphics& g, bool isMouseOver, bool isButtonDown);
+    /** Fills the width of the viewport holding the grid, and at least its height */
+    void fitToParent();
 
-    //Channel* ch;
+private:
+    void paintCell(Graphics& g, int cell, const juce::Rectangle<int>& bounds, bool isMouseOver) override;
+    void parentSizeChanged() override;
 
     int type;
-    int num;
-    int displayNum;
     Font buttonFont;
-    bool isActive;
 };
 
 
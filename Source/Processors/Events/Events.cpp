@@ -466,6 +466,101 @@ TTLEventPtr TTLEvent::deserializeFromMessage(const MidiMessage& msg, const Event
 	}
 }
 
+//TTLWordChange
+
+TTLWordChange::TTLWordChange(const MidiMessage& msg)
+	: m_data(msg.getRawData())
+{
+	jassert(isWordChange(msg));
+}
+
+TTLWordChange::TTLWordChange(const void* serializedEvent)
+	: m_data(static_cast<const uint8*>(serializedEvent))
+{
+}
+
+juce::int64 TTLWordChange::getTimestamp() const
+{
+	return *reinterpret_cast<const juce::int64*>(m_data + 8);
+}
+
+juce::uint64 TTLWordChange::getWord() const
+{
+	return *reinterpret_cast<const juce::uint64*>(m_data + EVENT_BASE_SIZE);
+}
+
+juce::uint64 TTLWordChange::getChangedBits() const
+{
+	return *reinterpret_cast<const juce::uint64*>(m_data + EVENT_BASE_SIZE + 8);
+}
+
+bool TTLWordChange::getState(int bit) const
+{
+	return ((getWord() >> bit) & 0x01) != 0;
+}
+
+int TTLWordChange::getNextChangedBit(int previousBit) const
+{
+	if (previousBit >= 63)
+		return -1;
+
+	juce::uint64 remaining = getChangedBits() >> (previousBit + 1);
+	if (remaining == 0)
+		return -1;
+
+	int bit = previousBit + 1;
+	while ((remaining & 0x01) == 0)
+	{
+		remaining >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+MidiMessage TTLWordChange::getBitEvent(const EventChannel* channelInfo, int bit) const
+{
+	//Same header, with the bit as the virtual channel, followed by as many bytes of the word as the channel holds
+	uint8 buffer[EVENT_BASE_SIZE + sizeof(juce::uint64)];
+	const size_t dataSize = jmin(channelInfo->getDataSize(), sizeof(juce::uint64));
+
+	memcpy(buffer, m_data, EVENT_BASE_SIZE);
+	*(reinterpret_cast<uint16*>(buffer + 16)) = static_cast<uint16>(bit);
+	memcpy(buffer + EVENT_BASE_SIZE, m_data + EVENT_BASE_SIZE, dataSize);
+
+	return MidiMessage(buffer, int(EVENT_BASE_SIZE + dataSize));
+}
+
+bool TTLWordChange::isWordChange(const MidiMessage& msg)
+{
+	return isWordChange(msg.getRawData(), msg.getRawDataSize());
+}
+
+bool TTLWordChange::isWordChange(const void* serializedEvent, size_t size)
+{
+	const uint8* data = static_cast<const uint8*>(serializedEvent);
+	//TODO: remove the mask when the probe system is implemented
+	return size == TTL_WORD_CHANGE_SIZE
+		&& static_cast<EventType>(*(data + 0) & 0x7F) == PROCESSOR_EVENT
+		&& static_cast<EventChannel::EventChannelTypes>(*(data + 1)) == EventChannel::TTL
+		&& *reinterpret_cast<const uint16*>(data + 16) == TTL_WORD_CHANGE;
+}
+
+void TTLWordChange::serialize(void* dstBuffer, const EventChannel* channelInfo, juce::int64 timestamp, juce::uint64 word, juce::uint64 changedBits)
+{
+	jassert(channelInfo->getChannelType() == EventChannel::TTL && channelInfo->getEventMetaDataCount() == 0);
+	char* buffer = static_cast<char*>(dstBuffer);
+
+	*(buffer + 0) = PROCESSOR_EVENT;
+	*(buffer + 1) = static_cast<char>(EventChannel::TTL);
+	*(reinterpret_cast<uint16*>(buffer + 2)) = channelInfo->getSourceNodeID();
+	*(reinterpret_cast<uint16*>(buffer + 4)) = channelInfo->getSubProcessorIdx();
+	*(reinterpret_cast<uint16*>(buffer + 6)) = channelInfo->getSourceIndex();
+	*(reinterpret_cast<juce::int64*>(buffer + 8)) = timestamp;
+	*(reinterpret_cast<uint16*>(buffer + 16)) = TTL_WORD_CHANGE;
+	*(reinterpret_cast<juce::uint64*>(buffer + EVENT_BASE_SIZE)) = word;
+	*(reinterpret_cast<juce::uint64*>(buffer + EVENT_BASE_SIZE + 8)) = changedBits;
+}
+
 //TextEvent
 TextEvent::TextEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const String& text)
 	: Event(channelInfo, timestamp, channel)
@@ -938,9 +1033,13 @@ SpikeEventPtr SpikeEvent::createSpikeEvent(const SpikeChannel* channelInfo, juce
 }
 
 SpikeEventPtr SpikeEvent::deserializeFromMessage(const MidiMessage& msg, const SpikeChannel* channelInfo)
+{
+	return deserializeFromBuffer(msg.getRawData(), msg.getRawDataSize(), channelInfo);
+}
+
+SpikeEventPtr SpikeEvent::deserializeFromBuffer(const void* serialized, size_t totalSize, const SpikeChannel* channelInfo)
 {
 	int nChans = channelInfo->getNumChannels();
-	size_t totalSize = msg.getRawDataSize();
 	size_t dataSize = channelInfo->getDataSize();
 	size_t thresholdSize = nChans*sizeof(float);
 	size_t metaDataSize = channelInfo->getTotalEventMetaDataSize();
@@ -956,7 +1055,7 @@ SpikeEventPtr SpikeEvent::deserializeFromMessage(const MidiMessage& msg, const S
 		jassertfalse;
 		return nullptr;
 	}
-	const uint8* buffer = msg.getRawData();
+	const uint8* buffer = static_cast<const uint8*>(serialized);
 	//TODO: remove the mask when the probe system is implemented
 	if (static_cast<EventType>(*(buffer + 0)&0x7F) != SPIKE_EVENT)
 	{
@@ -57,6 +57,16 @@ sortedID - 2 bytes (defaults to 0)
 Thresholds - 4bytes*nChannels
 Data - 4bytes*nChannels*nSamples
 */
+
+/**
+TTL word change packet structure
+Same header as a TTL event, with TTL_WORD_CHANGE as the virtual channel
+TTL word - 8 bytes
+Changed bits mask - 8 bytes
+*/
+#define TTL_WORD_CHANGE 0xFFFF
+#define TTL_WORD_CHANGE_SIZE (EVENT_BASE_SIZE + 16)
+
 class EventBase;
 class Event;
 class TTLEvent;
@@ -190,6 +200,47 @@ private:
 	JUCE_LEAK_DETECTOR(TTLEvent);
 };
 
+/**
+Compact form of the TTL events of a source: a single event per change of the TTL word, carrying
+the whole word and the mask of the bits that changed, instead of one TTL event per changed bit.
+
+This class is a view on a serialized word change and does not copy it, so the message must outlive it.
+Changed bits are expanded lazily, either by iterating them or by building the per-bit event of one bit:
+
+for (int bit = change.getNextChangedBit(-1); bit >= 0; bit = change.getNextChangedBit(bit))
+	doSomething(bit, change.getState(bit));
+
+Processors only get word changes if acceptsTTLWordChanges() returns true, others get the per-bit events.
+*/
+class PLUGIN_API TTLWordChange
+{
+public:
+	TTLWordChange(const MidiMessage& msg);
+	TTLWordChange(const void* serializedEvent);
+
+	juce::int64 getTimestamp() const;
+	juce::uint64 getWord() const;
+	juce::uint64 getChangedBits() const;
+
+	/** State of a bit after the change */
+	bool getState(int bit) const;
+
+	/** Next changed bit after previousBit, -1 to get the first one. Returns -1 after the last one */
+	int getNextChangedBit(int previousBit) const;
+
+	/** The per-bit TTL event of one of the changed bits, as if the source had sent it */
+	MidiMessage getBitEvent(const EventChannel* channelInfo, int bit) const;
+
+	static bool isWordChange(const MidiMessage& msg);
+	static bool isWordChange(const void* serializedEvent, size_t size);
+
+	/** Serializes a word change. The channel must be a TTL channel without event metadata */
+	static void serialize(void* dstBuffer, const EventChannel* channelInfo, juce::int64 timestamp, juce::uint64 word, juce::uint64 changedBits);
+
+private:
+	const uint8* m_data;
+};
+
 typedef ScopedPointer<TextEvent> TextEventPtr;
 class PLUGIN_API TextEvent
 	: public Event
@@ -300,6 +351,8 @@ public:
 	static SpikeEventPtr createSpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, SpikeBuffer& dataSource, uint16 sortedID, const MetaDataValueArray& metaData);
 
 	static SpikeEventPtr deserializeFromMessage(const MidiMessage& msg, const SpikeChannel* channelInfo);
+	/** Same as deserializeFromMessage, reading a serialized spike straight from memory */
+	static SpikeEventPtr deserializeFromBuffer(const void* serialized, size_t size, const SpikeChannel* channelInfo);
 private:
 	SpikeEvent() = delete;
 	SpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, HeapBlock<float>& data, uint16 sortedID);
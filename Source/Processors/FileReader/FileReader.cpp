@@ -199,6 +199,13 @@ bool FileReader::setFile (String fullpath)
     if (isExtensionSupported)
     {
         const int index = supportedExtensions[ext] - 1;
+
+        if (! AccessClass::getPluginManager()->loadPluginLibrary (Plugin::PLUGIN_TYPE_FILE_SOURCE, index))
+        {
+            CoreServices::sendStatusMessage ("Could not load the file source plugin");
+            return false;
+        }
+
         Plugin::FileSourceInfo sourceInfo = AccessClass::getPluginManager()->getFileSourceInfo (index);
         input = sourceInfo.creator();
     }
@@ -0,0 +1,414 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ChannelStatistics.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	// sums are accumulated in float over chunks of this size, then added in double
+	const int sumChunk = 256;
+}
+
+ChannelStatistics::ChannelStatistics()
+	: m_windowSeconds(1.0f),
+	m_bandLow(0),
+	m_bandHigh(0),
+	m_numChannels(0),
+	m_sampleRate(0),
+	m_reserved(false),
+	m_segmentLength(1),
+	m_keepStep(1),
+	m_b0(0), m_b2(0), m_a1(0), m_a2(0),
+	m_dirty(false)
+{
+}
+
+ChannelStatistics::~ChannelStatistics()
+{
+}
+
+void ChannelStatistics::setWindow(float seconds)
+{
+	if (seconds > 0)
+		m_windowSeconds = seconds;
+}
+
+float ChannelStatistics::getWindow() const
+{
+	return m_windowSeconds;
+}
+
+void ChannelStatistics::setBand(float lowHz, float highHz)
+{
+	m_bandLow = lowHz;
+	m_bandHigh = highHz;
+}
+
+int ChannelStatistics::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+void ChannelStatistics::prepare(int numChannels, float sampleRate)
+{
+	m_numChannels = jmax(0, numChannels);
+	m_sampleRate = sampleRate;
+	m_reserved = false;
+
+	m_channels.free();
+	m_segments.free();
+	m_kept.free();
+	m_scratch.free();
+	m_pending.free();
+	m_snapshots[0].calloc(jmax(1, m_numChannels));
+	m_snapshots[1].calloc(jmax(1, m_numChannels));
+	m_clearRequests.calloc(jmax(1, m_numChannels));
+	m_watched.calloc(jmax(1, m_numChannels));
+	m_snapshotSequence[0] = 0;
+	m_snapshotSequence[1] = 0;
+	m_front = 0;
+	m_generation = 0;
+	m_dirty = false;
+}
+
+void ChannelStatistics::reserve(float minimumWindowSeconds)
+{
+	if (m_reserved && minimumWindowSeconds <= m_windowSeconds)
+		return;
+
+	m_windowSeconds = jmax(m_windowSeconds, minimumWindowSeconds);
+	const float sampleRate = m_sampleRate;
+	m_segmentLength = jmax(1, roundToInt(m_windowSeconds * sampleRate / numSegments));
+	m_keepStep = (m_segmentLength + maxKeptPerSegment - 1) / maxKeptPerSegment;
+
+	// RBJ band-pass with 0 dB peak gain, centred on the geometric mean of the band
+	m_b0 = m_b2 = m_a1 = m_a2 = 0;
+	if (m_bandLow > 0 && m_bandHigh > m_bandLow && m_bandHigh < sampleRate / 2)
+	{
+		double f0 = std::sqrt(double(m_bandLow) * m_bandHigh);
+		double w0 = 2 * double_Pi * f0 / sampleRate;
+		double alpha = std::sin(w0) * (m_bandHigh - m_bandLow) / (2 * f0);
+		double a0 = 1 + alpha;
+		m_b0 = float(alpha / a0);
+		m_b2 = float(-alpha / a0);
+		m_a1 = float(-2 * std::cos(w0) / a0);
+		m_a2 = float((1 - alpha) / a0);
+	}
+
+	m_channels.calloc(jmax(1, m_numChannels));
+	m_segments.calloc(jmax(1, m_numChannels * numSegments));
+	m_kept.calloc(jmax(1, m_numChannels * numSegments * maxKeptPerSegment));
+	m_scratch.calloc(numSegments * maxKeptPerSegment);
+	m_pending.calloc(jmax(1, m_numChannels));
+	for (int ch = 0; ch < m_numChannels; ch++)
+	{
+		clearChannel(ch);
+		m_channels[ch].clearGeneration = m_clearRequests[ch].get();
+	}
+	m_reserved = true;
+	// readers see the cleared values too
+	publish();
+}
+
+bool ChannelStatistics::isReserved() const
+{
+	return m_reserved;
+}
+
+void ChannelStatistics::watch(int channel)
+{
+	if (channel >= 0 && channel < m_numChannels)
+		m_watched[channel] = 1;
+}
+
+bool ChannelStatistics::isWatched(int channel) const
+{
+	return channel >= 0 && channel < m_numChannels && m_watched[channel].get() != 0;
+}
+
+ChannelStatistics::Segment& ChannelStatistics::getSegment(int channel, int index)
+{
+	return m_segments[channel * numSegments + index];
+}
+
+float* ChannelStatistics::getKept(int channel, int index)
+{
+	return m_kept + (channel * numSegments + index) * maxKeptPerSegment;
+}
+
+void ChannelStatistics::clearChannel(int channel)
+{
+	ChannelState& state = m_channels[channel];
+	state.current = 0;
+	state.numComplete = 0;
+	state.ref = 0;
+	state.keepPhase = 0;
+	state.z1 = 0;
+	state.z2 = 0;
+
+	for (int i = 0; i < numSegments; i++)
+	{
+		Segment& segment = getSegment(channel, i);
+		zerostruct(segment);
+		segment.min = std::numeric_limits<float>::max();
+		segment.max = -std::numeric_limits<float>::max();
+	}
+
+	zerostruct(m_pending[channel]);
+	m_dirty = true;
+}
+
+void ChannelStatistics::addBlock(int channel, const float* data, int nSamples)
+{
+	if (channel < 0 || channel >= m_numChannels || !m_reserved)
+		return;
+
+	ChannelState& state = m_channels[channel];
+	const int clearGeneration = m_clearRequests[channel].get();
+	if (clearGeneration != state.clearGeneration)
+	{
+		clearChannel(channel);
+		state.clearGeneration = clearGeneration;
+	}
+
+	while (nSamples > 0)
+	{
+		const int count = jmin(nSamples, m_segmentLength - getSegment(channel, state.current).count);
+		addToSegment(channel, data, count);
+		if (getSegment(channel, state.current).count == m_segmentLength)
+			completeSegment(channel);
+		data += count;
+		nSamples -= count;
+	}
+}
+
+void ChannelStatistics::addToSegment(int channel, const float* data, int nSamples)
+{
+	ChannelState& state = m_channels[channel];
+	Segment& segment = getSegment(channel, state.current);
+
+	if (segment.count == 0)
+	{
+		// until there is a mean, the first sample is as good a reference as any
+		if (state.numComplete == 0)
+			state.ref = data[0];
+		segment.ref = state.ref;
+	}
+	const float ref = segment.ref;
+
+	// four independent accumulators so the compiler can keep them in one SIMD register
+	for (int start = 0; start < nSamples; start += sumChunk)
+	{
+		const float* x = data + start;
+		const int n = jmin(sumChunk, nSamples - start);
+		float s[4] = { 0, 0, 0, 0 };
+		float q[4] = { 0, 0, 0, 0 };
+		int i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				const float d = x[i + k] - ref;
+				s[k] += d;
+				q[k] += d * d;
+			}
+		}
+		for (; i < n; i++)
+		{
+			const float d = x[i] - ref;
+			s[0] += d;
+			q[0] += d * d;
+		}
+		segment.sum += double(s[0]) + s[1] + s[2] + s[3];
+		segment.sumSquares += double(q[0]) + q[1] + q[2] + q[3];
+	}
+
+	Range<float> range = FloatVectorOperations::findMinAndMax(data, nSamples);
+	segment.min = jmin(segment.min, range.getStart());
+	segment.max = jmax(segment.max, range.getEnd());
+
+	float* kept = getKept(channel, state.current);
+	int i = state.keepPhase;
+	for (; i < nSamples && segment.numKept < maxKeptPerSegment; i += m_keepStep)
+		kept[segment.numKept++] = data[i];
+	state.keepPhase = jmax(0, i - nSamples);
+
+	if (m_b0 != 0)
+	{
+		float z1 = state.z1;
+		float z2 = state.z2;
+		for (int start = 0; start < nSamples; start += sumChunk)
+		{
+			const int n = jmin(sumChunk, nSamples - start);
+			float power = 0;
+			for (int j = start; j < start + n; j++)
+			{
+				const float y = m_b0 * data[j] + z1;
+				z1 = -m_a1 * y + z2;
+				z2 = m_b2 * data[j] - m_a2 * y;
+				power += y * y;
+			}
+			segment.bandSquares += power;
+		}
+		// keep denormals out of the filter state when the input goes silent
+		state.z1 = std::abs(z1) < 1.0e-15f ? 0 : z1;
+		state.z2 = std::abs(z2) < 1.0e-15f ? 0 : z2;
+	}
+
+	segment.count += nSamples;
+}
+
+void ChannelStatistics::completeSegment(int channel)
+{
+	ChannelState& state = m_channels[channel];
+	state.numComplete = jmin(state.numComplete + 1, int(numSegments));
+	computeValues(channel);
+
+	state.current = (state.current + 1) % numSegments;
+	Segment& next = getSegment(channel, state.current);
+	zerostruct(next);
+	next.min = std::numeric_limits<float>::max();
+	next.max = -std::numeric_limits<float>::max();
+	state.keepPhase = 0;
+}
+
+void ChannelStatistics::computeValues(int channel)
+{
+	ChannelState& state = m_channels[channel];
+	const double ref = getSegment(channel, state.current).ref;
+
+	int64 n = 0;
+	double sum = 0, sumSquares = 0, bandSquares = 0;
+	float minValue = std::numeric_limits<float>::max();
+	float maxValue = -std::numeric_limits<float>::max();
+	int numKept = 0;
+
+	for (int k = 0; k < state.numComplete; k++)
+	{
+		const int index = (state.current - k + numSegments) % numSegments;
+		const Segment& segment = getSegment(channel, index);
+
+		// move the segment's sums from its reference to the window's
+		const double d = segment.ref - ref;
+		sum += segment.sum + segment.count * d;
+		sumSquares += segment.sumSquares + 2 * d * segment.sum + segment.count * d * d;
+		bandSquares += segment.bandSquares;
+		minValue = jmin(minValue, segment.min);
+		maxValue = jmax(maxValue, segment.max);
+		n += segment.count;
+
+		memcpy(m_scratch + numKept, getKept(channel, index), segment.numKept * sizeof(float));
+		numKept += segment.numKept;
+	}
+
+	if (n == 0)
+		return;
+
+	const double offset = sum / n;
+	const double mean = ref + offset;
+	const double variance = jmax(0.0, sumSquares / n - offset * offset);
+
+	Values& values = m_pending[channel];
+	values.mean = float(mean);
+	values.std = float(std::sqrt(variance));
+	values.rms = float(std::sqrt(variance + mean * mean));
+	values.min = minValue;
+	values.max = maxValue;
+	values.bandPower = m_b0 != 0 ? float(bandSquares / n) : 0;
+	values.numSamples = int(n);
+
+	for (int i = 0; i < numKept; i++)
+		m_scratch[i] = std::abs(m_scratch[i] - values.mean);
+	std::nth_element(m_scratch.getData(), m_scratch + numKept / 2, m_scratch + numKept);
+	values.noise = numKept > 0 ? m_scratch[numKept / 2] / 0.6745f : 0;
+
+	state.ref = values.mean;
+	m_dirty = true;
+}
+
+void ChannelStatistics::publish()
+{
+	if (!m_dirty)
+		return;
+
+	const int back = 1 - m_front.get();
+	++m_snapshotSequence[back];
+	memcpy(m_snapshots[back], m_pending, m_numChannels * sizeof(Values));
+	++m_snapshotSequence[back];
+	m_front = back;
+	++m_generation;
+	m_dirty = false;
+}
+
+void ChannelStatistics::requestClear(int channel)
+{
+	if (channel >= 0 && channel < m_numChannels)
+		++m_clearRequests[channel];
+}
+
+bool ChannelStatistics::getValues(int channel, Values& values) const
+{
+	if (channel < 0 || channel >= m_numChannels)
+		return false;
+
+	for (;;)
+	{
+		const int front = m_front.get();
+		const int sequence = m_snapshotSequence[front].get();
+		if (sequence & 1)
+			continue;
+		values = m_snapshots[front][channel];
+		if (m_snapshotSequence[front].get() == sequence)
+			return true;
+	}
+}
+
+int ChannelStatistics::getGeneration() const
+{
+	return m_generation.get();
+}
+
+ChannelStatistics::Channel::Channel()
+	: index(-1)
+{
+}
+
+bool ChannelStatistics::Channel::getValues(Values& values) const
+{
+	return statistics != nullptr && statistics->getValues(index, values);
+}
+
+void ChannelStatistics::Channel::watch() const
+{
+	if (statistics != nullptr)
+		statistics->watch(index);
+}
+
+void ChannelStatistics::Channel::requestClear() const
+{
+	if (statistics != nullptr)
+		statistics->requestClear(index);
+}
@@ -0,0 +1,202 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHANNELSTATISTICS_H_INCLUDED
+#define CHANNELSTATISTICS_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Per-channel statistics over a sliding window, updated once per block by the
+	processing thread and read lock-free from any other thread.
+
+	The window is split into segments. Each block is folded into the current segment
+	of its channel with one vectorizable pass (sum, sum of squares, min and max) and,
+	if a band is set, a band-pass biquad whose output power is accumulated too. Every
+	segment also keeps a decimated copy of its samples for the median absolute
+	deviation. When a segment is complete the values of its channel are recomputed
+	from the segments in the window, so the cost of a full window is paid once per
+	segment and not once per query.
+
+	publish() makes the values computed since the last call visible to readers. There
+	are two snapshots: the processing thread fills the one readers are not using and
+	then swaps them, and readers retry if the snapshot changed while they copied it.
+
+	Every processor that changes its continuous data owns one instance for its output
+	channels, and the copies of its DataChannels carry it downstream. Processors read the
+	statistics of their input through GenericProcessor::getInputStatistics(), so all the
+	processors looking at the same data share one computation, done by the owner after
+	its process() and only for the channels some processor watches.
+
+	prepare(), reserve() and the settings are called from the message thread while the
+	owner is not processing, as processors do from updateSettings() or enable().
+*/
+class PLUGIN_API ChannelStatistics : public ReferenceCountedObject
+{
+public:
+	typedef ReferenceCountedObjectPtr<ChannelStatistics> Ptr;
+
+	struct Values
+	{
+		float mean;
+		float rms;
+		float std;
+		/** median(|x - mean|) / 0.6745, a spike-robust estimate of the noise std */
+		float noise;
+		float min;
+		float max;
+		/** Mean power in the band set by setBand(), 0 if there is no band */
+		float bandPower;
+		/** Samples the values were computed from; 0 until the first segment is complete */
+		int numSamples;
+	};
+
+	/** One channel of the statistics, as kept by the processors reading them */
+	struct Channel
+	{
+		Channel();
+
+		/** Any thread: as ChannelStatistics::getValues(). Returns false if there are no statistics */
+		bool getValues(Values& values) const;
+
+		/** Any thread: as ChannelStatistics::watch() */
+		void watch() const;
+
+		/** Any thread: as ChannelStatistics::requestClear(). Clears the values for every reader */
+		void requestClear() const;
+
+		Ptr statistics;
+		int index;
+	};
+
+	ChannelStatistics();
+	~ChannelStatistics();
+
+	/** Sets the channels and their sample rate and clears all values and watches. Cheap,
+	the memory for the window is only allocated by reserve() */
+	void prepare(int numChannels, float sampleRate);
+
+	/** Allocates the memory for the window, making it at least the given length in seconds.
+	Clears all values if it was not allocated yet or the window grows */
+	void reserve(float minimumWindowSeconds = 0);
+
+	bool isReserved() const;
+
+	/** Window length in seconds. Applies on the next reserve() */
+	void setWindow(float seconds);
+	float getWindow() const;
+
+	/** Band for bandPower, in Hz. A low frequency of 0 or less disables it. Applies on the next reserve() */
+	void setBand(float lowHz, float highHz);
+
+	int getNumChannels() const;
+
+	/** Any thread: asks the owner to compute the values of a channel. Only watched channels
+	are added, and prepare() clears the watches */
+	void watch(int channel);
+
+	bool isWatched(int channel) const;
+
+	/** Processing thread: adds one block of samples of a channel */
+	void addBlock(int channel, const float* data, int nSamples);
+
+	/** Processing thread: makes the values updated since the last call visible to readers.
+	Cheap when nothing changed, so it can be called after every block */
+	void publish();
+
+	/** Any thread: restarts the window of a channel */
+	void requestClear(int channel);
+
+	/** Any thread: copies the last published values of a channel. Returns false if the
+	channel does not exist */
+	bool getValues(int channel, Values& values) const;
+
+	/** Number of snapshots published since prepare() */
+	int getGeneration() const;
+
+private:
+	static const int numSegments = 8;
+	static const int maxKeptPerSegment = 64;
+
+	struct Segment
+	{
+		// sums are taken around ref to keep float precision with large offsets
+		float ref;
+		double sum;
+		double sumSquares;
+		double bandSquares;
+		float min;
+		float max;
+		int count;
+		int numKept;
+	};
+
+	struct ChannelState
+	{
+		int current;
+		int numComplete;
+		float ref;
+		int keepPhase;
+		// band-pass biquad, transposed direct form II
+		float z1;
+		float z2;
+		int clearGeneration;
+	};
+
+	void addToSegment(int channel, const float* data, int nSamples);
+	void completeSegment(int channel);
+	void computeValues(int channel);
+	void clearChannel(int channel);
+	Segment& getSegment(int channel, int index);
+	float* getKept(int channel, int index);
+
+	float m_windowSeconds;
+	float m_bandLow;
+	float m_bandHigh;
+
+	int m_numChannels;
+	float m_sampleRate;
+	bool m_reserved;
+	int m_segmentLength;
+	int m_keepStep;
+	float m_b0, m_b2, m_a1, m_a2;
+
+	HeapBlock<ChannelState> m_channels;
+	HeapBlock<Segment> m_segments;
+	HeapBlock<float> m_kept;
+	HeapBlock<float> m_scratch;
+	HeapBlock<Values> m_pending;
+	bool m_dirty;
+
+	HeapBlock<Values> m_snapshots[2];
+	Atomic<int> m_snapshotSequence[2];
+	Atomic<int> m_front;
+	Atomic<int> m_generation;
+	HeapBlock<Atomic<int>> m_clearRequests;
+	HeapBlock<Atomic<int>> m_watched;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelStatistics);
+};
+
+#endif  // CHANNELSTATISTICS_H_INCLUDED
@@ -41,6 +41,9 @@ GenericProcessor::GenericProcessor (const String& name)
     , editor                        (nullptr)
     , parametersAsXml               (nullptr)
     , sendSampleCount               (true)
+    , m_settingsGeneration              (0)
+    , m_settingsSourceNode              (nullptr)
+    , m_settingsSourceGeneration        (0)
     , m_processorType                   (PROCESSOR_TYPE_UTILITY)
     , m_name                            (name)
     , m_isParamsWereLoaded              (false)
@@ -329,7 +332,11 @@ void GenericProcessor::update()
                 ch->setMonitored( m_monitorStatus[i]);
             }
 
-			ch->addToHistoricString(getName());
+			//channels sharing their history upstream share the entry added here as well
+			if (i > 0 && sourceChan->m_history == sourceNode->dataChannelArray[i - 1]->m_history)
+				ch->m_history = dataChannelArray.getLast()->m_history;
+			else
+				ch->addToHistoricString(getName());
             dataChannelArray.add (ch);
         }
 
@@ -386,6 +393,17 @@ void GenericProcessor::update()
 
 	updateChannelIndexes();	
 
+	//the copies of the channels carry the statistics of the last processor that changed them
+	if (changesContinuousData())
+	{
+		m_outputStatistics = new ChannelStatistics();
+		m_outputStatistics->prepare(dataChannelArray.size(), dataChannelArray.size() > 0 ? dataChannelArray[0]->getSampleRate() : 0);
+		for (int i = 0; i < dataChannelArray.size(); i++)
+			dataChannelArray[i]->setStatistics(m_outputStatistics, i);
+	}
+	else
+		m_outputStatistics = nullptr;
+
 	m_needsToSendTimestampMessages.clear();
 	m_needsToSendTimestampMessages.insertMultiple(-1, false, getNumSubProcessors());
 
@@ -397,6 +415,23 @@ void GenericProcessor::update()
                           128);            // blockSize
 
     editor->update(); // allow the editor to update its settings
+
+	static int64 lastSettingsGeneration = 0;
+	m_settingsGeneration = ++lastSettingsGeneration;
+	m_settingsSourceNode = sourceNode;
+	m_settingsSourceGeneration = sourceNode != nullptr ? sourceNode->m_settingsGeneration : 0;
+}
+
+bool GenericProcessor::needsSettingsUpdate() const
+{
+	if (m_settingsGeneration == 0 || sourceNode != m_settingsSourceNode)
+		return true;
+	return sourceNode != nullptr && sourceNode->m_settingsGeneration != m_settingsSourceGeneration;
+}
+
+int64 GenericProcessor::getSettingsGeneration() const
+{
+	return m_settingsGeneration;
 }
 
 void GenericProcessor::updateChannelIndexes(bool updateNodeID)
@@ -468,7 +503,10 @@ void GenericProcessor::createDataChannelsByType(DataChannel::DataChannelTypes ty
 		{
 			DataChannel* chan = new DataChannel(type, getSampleRate(sub), this, sub);
 			chan->setBitVolts(getBitVolts(sub));
-			chan->addToHistoricString(getName());
+			if (i > 0)
+				chan->m_history = dataChannelArray.getLast()->m_history;
+			else
+				chan->addToHistoricString(getName());
 			chan->m_nodeID = nodeId;
 			dataChannelArray.add(chan);
 		}
@@ -779,7 +817,18 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 			{
 				int eventIndex = getEventChannelIndex(index, sourceId, subProc);
 				if (eventIndex >= 0)
-					handleEvent(eventChannelArray[eventIndex], message, samplePosition);
+				{
+					const EventChannel* channel = eventChannelArray[eventIndex];
+					if (TTLWordChange::isWordChange(message) && !acceptsTTLWordChanges())
+					{
+						//Per-bit events for processors that do not understand word changes
+						const TTLWordChange change(message);
+						for (int bit = change.getNextChangedBit(-1); bit >= 0; bit = change.getNextChangedBit(bit))
+							handleEvent(channel, change.getBitEvent(channel, bit), samplePosition);
+					}
+					else
+						handleEvent(channel, message, samplePosition);
+				}
 			}
 			else if (EventBase::getBaseType(message) == EventType::SYSTEM_EVENT && SystemEvent::getSystemEventType(message) == SystemEventType::TIMESTAMP_SYNC_TEXT)
 			{
@@ -816,6 +865,13 @@ void GenericProcessor::addEvent(const EventChannel* channel, const Event* event,
 	m_currentMidiBuffer->addEvent(buffer, size, sampleNum >= 0 ? sampleNum : 0);
 }
 
+void GenericProcessor::addTTLWordChange(const EventChannel* channel, juce::int64 timestamp, juce::uint64 word, juce::uint64 changedBits, int sampleNum)
+{
+	char buffer[TTL_WORD_CHANGE_SIZE];
+	TTLWordChange::serialize(buffer, channel, timestamp, word, changedBits);
+	m_currentMidiBuffer->addEvent(buffer, TTL_WORD_CHANGE_SIZE, sampleNum >= 0 ? sampleNum : 0);
+}
+
 void GenericProcessor::addSpike(int channelIndex, const SpikeEvent* event, int sampleNum)
 {
 	addSpike(spikeChannelArray[channelIndex], event, sampleNum);
@@ -839,6 +895,21 @@ void GenericProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& even
 	m_lastProcessTime = Time::getHighResolutionTicks();
     process (buffer);
 
+	m_timingStats.addBlock(Time::getHighResolutionTicks() - m_lastProcessTime);
+	//sources set their sample counts inside process(), so the map is only complete now
+	for (std::map<uint32, uint32>::const_iterator it = numSamples.begin(); it != numSamples.end(); ++it)
+		m_timingStats.addStreamSamples(it->first, it->second);
+
+	if (m_outputStatistics != nullptr && m_outputStatistics->isReserved())
+	{
+		const int numChannels = jmin(m_outputStatistics->getNumChannels(), buffer.getNumChannels());
+		for (int i = 0; i < numChannels; i++)
+		{
+			if (m_outputStatistics->isWatched(i))
+				m_outputStatistics->addBlock(i, buffer.getReadPointer(i), getNumSamples(i));
+		}
+		m_outputStatistics->publish();
+	}
 }
 
 const DataChannel* GenericProcessor::getDataChannel(int index) const
@@ -1165,6 +1236,20 @@ bool GenericProcessor::isSplitter()      const  { return getProcessorType() == P
 bool GenericProcessor::isMerger()        const  { return getProcessorType() == PROCESSOR_TYPE_MERGER;        }
 bool GenericProcessor::isUtility()       const  { return getProcessorType() == PROCESSOR_TYPE_UTILITY;       }
 
+bool GenericProcessor::changesContinuousData() const { return isSource() || isFilter(); }
+
+ChannelStatistics::Channel GenericProcessor::getInputStatistics(int channel, float windowSeconds)
+{
+	const DataChannel* chan = sourceNode != nullptr ? sourceNode->getDataChannel(channel) : nullptr;
+	if (chan == nullptr)
+		return ChannelStatistics::Channel();
+
+	ChannelStatistics::Channel statistics = chan->getStatistics();
+	if (statistics.statistics != nullptr)
+		statistics.statistics->reserve(windowSeconds);
+	return statistics;
+}
+
 int GenericProcessor::getNumParameters()    { return parameters.size(); }
 int GenericProcessor::getNumPrograms()      { return 0; }
 int GenericProcessor::getCurrentProgram()   { return 0; }
@@ -1228,6 +1313,8 @@ void GenericProcessor::handleSpike(const SpikeChannel* spikeInfo, const MidiMess
 
 void GenericProcessor::handleTimestampSyncTexts(const MidiMessage& event) {};
 
+bool GenericProcessor::acceptsTTLWordChanges() const { return false; }
+
 void GenericProcessor::setEnabledState (bool t)
 {
     isEnabled = t;
@@ -1235,6 +1322,11 @@ void GenericProcessor::setEnabledState (bool t)
 
 bool GenericProcessor::enableProcessor()
 {
+	Array<uint32> streams;
+	for (int i = 0; i < dataChannelArray.size(); i++)
+		streams.addIfNotAlreadyThere(getProcessorFullId(dataChannelArray[i]->getSourceNodeID(), dataChannelArray[i]->getSubProcessorIdx()));
+	m_timingStats.reset(streams);
+
 	m_lastProcessTime = Time::getHighResolutionTicks();
 	return enable();
 }
@@ -1279,6 +1371,11 @@ int64 GenericProcessor::getLastProcessedsoftwareTime() const
 	return m_lastProcessTime;
 }
 
+const ProcessorTimingStats& GenericProcessor::getTimingStats() const
+{
+	return m_timingStats;
+}
+
 void ChannelCreationIndexes::clearChannelCreationCounts()
 {
 	dataChannelCount = 0;
@@ -33,6 +33,7 @@
 #include "../../Processors/PluginManager/PluginIDs.h"
 #include "../Channel/InfoObjects.h"
 #include "../Events/Events.h"
+#include "ProcessorTimingStats.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -328,6 +329,16 @@ public:
     /** Returns true if a processor is a utility (non-merger or splitter), false otherwise.*/
     virtual bool isUtility() const;
 
+    /** Returns false if process() leaves the continuous channels as they came in, so that the processor
+    passes the statistics of its input on instead of computing its own. By default only sources and
+    filters change their data.*/
+    virtual bool changesContinuousData() const;
+
+    /** Statistics of an input channel, computed by the processor upstream that last changed its samples
+    and shared by every processor reading them. Call from updateSettings() or enable(), as this allocates
+    the window, of at least the given length. Values are only computed for watched channels.*/
+    ChannelStatistics::Channel getInputStatistics(int channel, float windowSeconds);
+
     /** Returns true if a processor is able to send its output to a given processor.
 
         Ideally, this should always return true, but there may be special cases
@@ -420,6 +431,14 @@ public:
     /** Default method for updating settings, called by every processor.*/
     void update();
 
+    /** Returns true if the settings copied from the source node are out of date: the processor was never
+    updated, its source changed, or the source was updated since. The edited processor itself is always
+    updated by the SignalChainManager, this only tells whether the processors after it need to be.*/
+    virtual bool needsSettingsUpdate() const;
+
+    /** Changes every time update() runs. Never 0 once the processor has been updated.*/
+    int64 getSettingsGeneration() const;
+
 	/** Toggles record ON for all channels */
     void setAllChannelsToRecord();
 
@@ -520,6 +539,9 @@ public:
 
 	juce::int64 getLastProcessedsoftwareTime() const;
 
+	/** Returns the time spent in process() and the samples handled per incoming stream since acquisition started */
+	const ProcessorTimingStats& getTimingStats() const;
+
 	static uint32 getProcessorFullId(uint16 processorId, uint16 subprocessorIdx);
 
 	class PLUGIN_API DefaultEventInfo
@@ -557,6 +579,10 @@ protected:
 	/** Responds to TIMESTAMP_SYNC_TEXT system events, in case a processor needs to listen to them (useful for the record node) */
 	virtual void handleTimestampSyncTexts(const MidiMessage& event);
 
+	/** Returns true if handleEvent() understands compact TTL word changes (see TTLWordChange).
+	Otherwise checkForEvents() expands each word change into a TTL event per changed bit. */
+	virtual bool acceptsTTLWordChanges() const;
+
 	/** Returns the default number of datachannels outputs for a specific type and a specific subprocessor
 	Called by createDataChannels(). It is not needed to implement if createDataChannels() is overriden */
 	virtual int getDefaultNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx = 0) const;
@@ -576,6 +602,9 @@ protected:
 	void addEvent(int channelIndex, const Event* event, int sampleNum);
 	void addEvent(const EventChannel* channel, const Event* event, int sampleNum);
 
+	/** Adds a compact TTL word change, see TTLWordChange */
+	void addTTLWordChange(const EventChannel* channel, juce::int64 timestamp, juce::uint64 word, juce::uint64 changedBits, int sampleNum);
+
 	void addSpike(int channelIndex, const SpikeEvent* event, int sampleNum);
 	void addSpike(const SpikeChannel* channel, const SpikeEvent* event, int sampleNum);
 
@@ -605,6 +634,16 @@ private:
 
 	juce::int64 m_lastProcessTime;
 
+	ProcessorTimingStats m_timingStats;
+
+	/** Generation of the current settings, and the source and source generation they were copied from.*/
+	int64 m_settingsGeneration;
+	GenericProcessor* m_settingsSourceNode;
+	int64 m_settingsSourceGeneration;
+
+	/** Statistics of the output channels, if the processor changes them.*/
+	ChannelStatistics::Ptr m_outputStatistics;
+
 	void createDataChannelsByType(DataChannel::DataChannelTypes type);
 
 	/** Each processor has a unique integer ID that can be used to identify it.*/
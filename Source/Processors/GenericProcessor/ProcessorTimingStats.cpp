@@ -0,0 +1,183 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessorTimingStats.h"
+
+ProcessorTimingStats::ProcessorTimingStats()
+{
+	reset(Array<uint32>());
+}
+
+ProcessorTimingStats::~ProcessorTimingStats()
+{
+}
+
+void ProcessorTimingStats::reset(const Array<uint32>& streamIds)
+{
+	zeromem(m_histogram, sizeof(m_histogram));
+	m_numBlocks = 0;
+	m_totalTicks = 0;
+	m_minTicks = 0;
+	m_maxTicks = 0;
+	m_resetTicks = Time::getHighResolutionTicks();
+	m_lastBlockTicks = m_resetTicks;
+	m_lastBlockDuration = 0;
+
+	m_streamIds = streamIds;
+	m_streamSamples.clearQuick();
+	m_streamSamples.insertMultiple(0, 0, streamIds.size());
+}
+
+int ProcessorTimingStats::getBucket(int64 ticks)
+{
+	//Values below 2*bucketsPerOctave get one bucket each. Above that, every octave
+	//is split in bucketsPerOctave linear steps, taken from the bits after the highest one
+	if (ticks < 2 * bucketsPerOctave)
+		return int(jmax(int64(0), ticks));
+
+	int msb = 0;
+	for (uint64 v = uint64(ticks); v > 1; v >>= 1)
+		msb++;
+
+	const int bucket = (msb - 2) * bucketsPerOctave + int((ticks >> (msb - 3)) & (bucketsPerOctave - 1));
+	return jmin(bucket, numBuckets - 1);
+}
+
+int64 ProcessorTimingStats::getBucketUpperBound(int bucket)
+{
+	if (bucket < 2 * bucketsPerOctave - 1)
+		return bucket + 1;
+
+	const int next = bucket + 1;
+	const int msb = next / bucketsPerOctave + 2;
+	return int64(bucketsPerOctave + next % bucketsPerOctave) << (msb - 3);
+}
+
+void ProcessorTimingStats::addBlock(int64 ticks)
+{
+	if (m_numBlocks == 0 || ticks < m_minTicks)
+		m_minTicks = ticks;
+	if (ticks > m_maxTicks)
+		m_maxTicks = ticks;
+
+	m_lastBlockDuration = ticks;
+	m_totalTicks += ticks;
+	m_numBlocks++;
+	m_histogram[getBucket(ticks)]++;
+	m_lastBlockTicks = Time::getHighResolutionTicks();
+}
+
+void ProcessorTimingStats::addStreamSamples(uint32 streamId, uint32 nSamples)
+{
+	const int index = m_streamIds.indexOf(streamId);
+	if (index >= 0)
+		m_streamSamples.getReference(index) += nSamples;
+}
+
+int64 ProcessorTimingStats::getNumBlocks() const
+{
+	return m_numBlocks;
+}
+
+double ProcessorTimingStats::getMinBlockTime() const
+{
+	return Time::highResolutionTicksToSeconds(m_minTicks);
+}
+
+double ProcessorTimingStats::getMeanBlockTime() const
+{
+	if (m_numBlocks == 0)
+		return 0;
+	return Time::highResolutionTicksToSeconds(m_totalTicks) / m_numBlocks;
+}
+
+double ProcessorTimingStats::getMaxBlockTime() const
+{
+	return Time::highResolutionTicksToSeconds(m_maxTicks);
+}
+
+double ProcessorTimingStats::getLastBlockTime() const
+{
+	return Time::highResolutionTicksToSeconds(m_lastBlockDuration);
+}
+
+double ProcessorTimingStats::getBlockTimePercentile(double fraction) const
+{
+	if (m_numBlocks == 0)
+		return 0;
+
+	const int64 target = jmax(int64(1), int64(std::ceil(jlimit(0.0, 1.0, fraction) * m_numBlocks)));
+	int64 count = 0;
+	for (int i = 0; i < numBuckets; i++)
+	{
+		count += m_histogram[i];
+		if (count >= target)
+		{
+			//The upper bound of a bucket can exceed any value actually seen
+			const int64 ticks = jlimit(m_minTicks, m_maxTicks, getBucketUpperBound(i) - 1);
+			return Time::highResolutionTicksToSeconds(ticks);
+		}
+	}
+	return getMaxBlockTime();
+}
+
+double ProcessorTimingStats::getTotalProcessingTime() const
+{
+	return Time::highResolutionTicksToSeconds(m_totalTicks);
+}
+
+double ProcessorTimingStats::getElapsedTime() const
+{
+	return Time::highResolutionTicksToSeconds(m_lastBlockTicks - m_resetTicks);
+}
+
+int ProcessorTimingStats::getNumStreams() const
+{
+	return m_streamIds.size();
+}
+
+uint32 ProcessorTimingStats::getStreamId(int index) const
+{
+	return m_streamIds[index];
+}
+
+int64 ProcessorTimingStats::getStreamSamples(int index) const
+{
+	return m_streamSamples[index];
+}
+
+double ProcessorTimingStats::getStreamSampleRate(int index) const
+{
+	const double elapsed = getElapsedTime();
+	if (elapsed <= 0)
+		return 0;
+	return m_streamSamples[index] / elapsed;
+}
+
+double ProcessorTimingStats::getStreamThroughput(int index) const
+{
+	const double total = getTotalProcessingTime();
+	if (total <= 0)
+		return 0;
+	return m_streamSamples[index] / total;
+}
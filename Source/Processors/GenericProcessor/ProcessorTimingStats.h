@@ -0,0 +1,111 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PROCESSORTIMINGSTATS_H_INCLUDED
+#define PROCESSORTIMINGSTATS_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Accumulates how long a processor spends in processBlock() and how many samples
+	of each incoming stream (source processor + subprocessor) it handles.
+
+	Block times are kept in a log-linear histogram of high resolution ticks
+	(8 buckets per octave, so percentiles are accurate to ~9%) so that adding a
+	block never allocates or locks. Streams are registered by reset(), before
+	acquisition starts.
+
+	The audio thread is the only writer. Values read from other threads while
+	acquisition is running are approximate; they are exact once it has stopped.
+
+	@see GenericProcessor::getTimingStats
+*/
+class PLUGIN_API ProcessorTimingStats
+{
+public:
+	ProcessorTimingStats();
+	~ProcessorTimingStats();
+
+	/** Clears all counters and sets the streams whose samples will be counted, as full source IDs
+	@see GenericProcessor::getProcessorFullId */
+	void reset(const Array<uint32>& streamIds);
+
+	/** Adds a block that took the given number of high resolution ticks */
+	void addBlock(int64 ticks);
+
+	/** Adds samples to a stream registered by reset(). Unknown streams are ignored */
+	void addStreamSamples(uint32 streamId, uint32 nSamples);
+
+	int64 getNumBlocks() const;
+
+	/** Block times, in seconds */
+	double getMinBlockTime() const;
+	double getMeanBlockTime() const;
+	double getMaxBlockTime() const;
+
+	/** Duration of the most recent block, in seconds */
+	double getLastBlockTime() const;
+
+	/** Block time below which the given fraction (0-1) of the blocks fall, in seconds */
+	double getBlockTimePercentile(double fraction) const;
+
+	/** Total time spent processing since reset(), in seconds */
+	double getTotalProcessingTime() const;
+
+	/** Wall clock time between reset() and the end of the last block, in seconds */
+	double getElapsedTime() const;
+
+	int getNumStreams() const;
+	uint32 getStreamId(int index) const;
+	int64 getStreamSamples(int index) const;
+
+	/** Samples of the stream per second of wall clock time */
+	double getStreamSampleRate(int index) const;
+
+	/** Samples of the stream per second of processing time, i.e. the rate the processor could sustain */
+	double getStreamThroughput(int index) const;
+
+private:
+	static const int bucketsPerOctave = 8;
+	static const int numBuckets = 256;
+
+	static int getBucket(int64 ticks);
+	static int64 getBucketUpperBound(int bucket);
+
+	int64 m_histogram[numBuckets];
+	int64 m_numBlocks;
+	int64 m_totalTicks;
+	int64 m_minTicks;
+	int64 m_maxTicks;
+	int64 m_resetTicks;
+	int64 m_lastBlockTicks;
+	int64 m_lastBlockDuration;
+
+	Array<uint32> m_streamIds;
+	Array<int64> m_streamSamples;
+
+	JUCE_LEAK_DETECTOR(ProcessorTimingStats);
+};
+
+#endif  // PROCESSORTIMINGSTATS_H_INCLUDED
@@ -32,7 +32,9 @@ Merger::Merger()
     : GenericProcessor("Merger"),
       mergeEventsA(true), mergeContinuousA(true),
       mergeEventsB(true), mergeContinuousB(true),
-      sourceNodeA(0), sourceNodeB(0), activePath(0)
+      sourceNodeA(0), sourceNodeB(0), activePath(0),
+      updatedSourceA(nullptr), updatedSourceB(nullptr),
+      updatedGenerationA(0), updatedGenerationB(0), updatedMergeFlags(0)
 {
     setProcessorType(PROCESSOR_TYPE_MERGER);
     sendSampleCount = false;
@@ -236,6 +238,26 @@ void Merger::updateSettings()
 
     std::cout << "Number of merger outputs: " << getNumInputs() << std::endl;
 
+    updatedSourceA = sourceNodeA;
+    updatedSourceB = sourceNodeB;
+    updatedGenerationA = sourceNodeA != nullptr ? sourceNodeA->getSettingsGeneration() : 0;
+    updatedGenerationB = sourceNodeB != nullptr ? sourceNodeB->getSettingsGeneration() : 0;
+    updatedMergeFlags = getMergeFlags();
+}
+
+int Merger::getMergeFlags() const
+{
+    return (mergeEventsA ? 1 : 0) | (mergeContinuousA ? 2 : 0) | (mergeEventsB ? 4 : 0) | (mergeContinuousB ? 8 : 0);
+}
+
+bool Merger::needsSettingsUpdate() const
+{
+    if (getSettingsGeneration() == 0 || sourceNodeA != updatedSourceA || sourceNodeB != updatedSourceB
+        || getMergeFlags() != updatedMergeFlags)
+        return true;
+
+    return (sourceNodeA != nullptr && sourceNodeA->getSettingsGeneration() != updatedGenerationA)
+        || (sourceNodeB != nullptr && sourceNodeB->getSettingsGeneration() != updatedGenerationB);
 }
 
 void Merger::saveCustomParametersToXml(XmlElement* parentElement)
@@ -68,6 +68,9 @@ public:
 
     bool stillHasSource() const override;
 
+    /** Checks both sources and the merge flags, not just the active path */
+    bool needsSettingsUpdate() const override;
+
     void saveCustomParametersToXml(XmlElement* parentElement) override;
     void loadCustomParametersFromXml() override;
 
@@ -83,6 +86,15 @@ private:
 
     int activePath;
 
+    int getMergeFlags() const;
+
+    /** Sources, their settings generations and the merge flags as of the last update */
+    GenericProcessor* updatedSourceA;
+    GenericProcessor* updatedSourceB;
+    int64 updatedGenerationA;
+    int64 updatedGenerationB;
+    int updatedMergeFlags;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Merger);
 
 };
@@ -69,6 +69,81 @@ static void errorMsg(const char *file, int line, const char *msg) {
 
 #define ERROR_MSG(msg) errorMsg(__FILE__, __LINE__, msg)
 
+static decltype(LoadedLibInfo::handle) openLibrary(const String& pluginLoc) {
+	/*
+	Load in the selected processor. This takes the
+	dynamic object (.so) and copies it into RAM
+	Dynamic linker requires a C-style string, so we
+	we have to convert first.
+	*/
+	const char* processorLocCString = static_cast<const char*>(pluginLoc.toUTF8());
+
+#ifdef WIN32
+	return LoadLibrary(processorLocCString);
+#elif defined(__APPLE__)
+    CFURLRef bundleURL = CFURLCreateFromFileSystemRepresentation(kCFAllocatorDefault,
+                                                                 reinterpret_cast<const UInt8 *>(processorLocCString),
+                                                                 strlen(processorLocCString),
+                                                                 true);
+    assert(bundleURL);
+    CFBundleRef handle = CFBundleCreate(kCFAllocatorDefault, bundleURL);
+    CFRelease(bundleURL);
+    return handle;
+#else
+	// Clear errors
+	dlerror();
+
+	/*
+	Changing this to resolve all variables immediately upon loading.
+	This will provide for quicker testing of the custom
+	processor stability and to ensure that it doesn't crash due
+	to memory mishaps.
+	*/
+	return dlopen(processorLocCString,RTLD_GLOBAL|RTLD_NOW);
+#endif
+}
+
+
+template<typename FunctionType>
+static FunctionType getLibraryFunction(decltype(LoadedLibInfo::handle) handle, const char* name) {
+#ifdef WIN32
+	return (FunctionType)GetProcAddress(handle, name);
+#elif defined(__APPLE__)
+    CFStringRef functionName = CFStringCreateWithCString(kCFAllocatorDefault, name, kCFStringEncodingASCII);
+    FunctionType function = (FunctionType)CFBundleGetFunctionPointerForName(handle, functionName);
+    CFRelease(functionName);
+    return function;
+#else
+    dlerror();
+	return (FunctionType)(dlsym(handle, name));
+#endif
+}
+
+
+static File getPluginCacheFile() {
+    // next to the saved state, see MainWindow
+#if defined(__APPLE__)
+    return File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("Application Support/open-ephys/pluginCache.xml");
+#else
+    return File::getSpecialLocation(File::currentExecutableFile).getParentDirectory().getChildFile("pluginCache.xml");
+#endif
+}
+
+
+template<class T, typename CreatorType>
+static bool setCreator(Array<LoadedPluginInfo<T>>& pluginArray, int libIndex, const char* name, CreatorType creator) {
+	for (int i = 0; i < pluginArray.size(); i++)
+	{
+		LoadedPluginInfo<T>& info = pluginArray.getReference(i);
+		if (info.libIndex == libIndex && String(info.name) == name)
+		{
+			info.creator = creator;
+			return true;
+		}
+	}
+	return false;
+}
+
 
 PluginManager::PluginManager()
 {
@@ -90,6 +165,10 @@ void PluginManager::loadAllPlugins()
 	paths.add(File::getSpecialLocation(File::currentApplicationFile).getParentDirectory().getChildFile("plugins"));
 #endif
 
+    loadCache();
+    newPluginCache = new XmlElement("PLUGINCACHE");
+    newPluginCache->setAttribute("apiVersion", PLUGIN_API_VER);
+
     for (auto &pluginPath : paths) {
         if (!pluginPath.isDirectory()) {
             std::cout << "Plugin path not found: " << pluginPath.getFullPathName() << std::endl;
@@ -97,6 +176,10 @@ void PluginManager::loadAllPlugins()
             loadPlugins(pluginPath);
         }
     }
+
+    saveCache();
+    pluginCache = nullptr;
+    newPluginCache = nullptr;
 }
 
 void PluginManager::loadPlugins(const File &pluginPath) {
@@ -119,6 +202,11 @@ void PluginManager::loadPlugins(const File &pluginPath) {
 	for (int i = 0; i < foundDLLs.size(); i++)
 	{
 		std::cout << "Loading Plugin: " << foundDLLs[i].getFileNameWithoutExtension() << "... " << std::flush;
+		if (loadCachedLibrary(foundDLLs[i]))
+		{
+			std::cout << "Cached with " << libArray.getLast().numPlugins << " plugins" << std::endl;
+			continue;
+		}
 		int res = loadPlugin(foundDLLs[i].getFullPathName());
 		if (res < 0)
 		{
@@ -127,6 +215,7 @@ void PluginManager::loadPlugins(const File &pluginPath) {
 		else
 		{
 			std::cout << "Loaded with " << res << " plugins" << std::endl;
+			addToCache(libArray.size() - 1, foundDLLs[i]);
 		}
 	}
 }
@@ -140,38 +229,7 @@ void PluginManager::loadPlugins(const File &pluginPath) {
  */
 
 int PluginManager::loadPlugin(const String& pluginLoc) {
-	/*
-	Load in the selected processor. This takes the
-	dynamic object (.so) and copies it into RAM
-	Dynamic linker requires a C-style string, so we
-	we have to convert first.
-	*/
-	const char* processorLocCString = static_cast<const char*>(pluginLoc.toUTF8());
-
-#ifdef WIN32
-	HINSTANCE handle;
-	handle = LoadLibrary(processorLocCString);
-#elif defined(__APPLE__)
-    CFURLRef bundleURL = CFURLCreateFromFileSystemRepresentation(kCFAllocatorDefault,
-                                                                 reinterpret_cast<const UInt8 *>(processorLocCString),
-                                                                 strlen(processorLocCString),
-                                                                 true);
-    assert(bundleURL);
-    CFBundleRef handle = CFBundleCreate(kCFAllocatorDefault, bundleURL);
-    CFRelease(bundleURL);
-#else
-	// Clear errors
-	dlerror();
-
-	/*
-	Changing this to resolve all variables immediately upon loading.
-	This will provide for quicker testing of the custom
-	processor stability and to ensure that it doesn't crash due
-	to memory mishaps.
-	*/
-	void *handle = 0;
-	handle = dlopen(processorLocCString,RTLD_GLOBAL|RTLD_NOW);
-#endif
+	decltype(LoadedLibInfo::handle) handle = openLibrary(pluginLoc);
 
 	if (!handle) {
 		ERROR_MSG("Failed to load plugin DLL");
@@ -179,15 +237,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 		return -1;
 	}
 
-	LibraryInfoFunction infoFunction = 0;
-#ifdef WIN32
-	infoFunction = (LibraryInfoFunction)GetProcAddress(handle, "getLibInfo");
-#elif defined(__APPLE__)
-    infoFunction = (LibraryInfoFunction)CFBundleGetFunctionPointerForName(handle, CFSTR("getLibInfo"));
-#else
-    dlerror();
-	infoFunction = (LibraryInfoFunction)(dlsym(handle, "getLibInfo"));
-#endif
+	LibraryInfoFunction infoFunction = getLibraryFunction<LibraryInfoFunction>(handle, "getLibInfo");
 
 	if (!infoFunction)
 	{
@@ -206,15 +256,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 		return -1;
 	}
 
-	PluginInfoFunction piFunction = 0;
-#ifdef WIN32
-	piFunction = (PluginInfoFunction)GetProcAddress(handle, "getPluginInfo");
-#elif defined(__APPLE__)
-    piFunction = (PluginInfoFunction)CFBundleGetFunctionPointerForName(handle, CFSTR("getPluginInfo"));
-#else
-    dlerror();
-	piFunction = (PluginInfoFunction)(dlsym(handle, "getPluginInfo"));
-#endif
+	PluginInfoFunction piFunction = getLibraryFunction<PluginInfoFunction>(handle, "getPluginInfo");
 
 	if (!piFunction)
 	{
@@ -229,6 +271,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	lib.libVersion = libInfo.libVersion;
 	lib.numPlugins = libInfo.numPlugins;
 	lib.handle = handle;
+	lib.path = pluginLoc;
 
 	libArray.add(lib);
 
@@ -273,7 +316,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.fileSource.creator;
 			info.name = pInfo.fileSource.name;
 			info.extensions = pInfo.fileSource.extensions;
-			info.libIndex = libArray.size();
+			info.libIndex = libArray.size() - 1;
 			fileSourcePlugins.add(info);
 			break;
 		}
@@ -287,6 +330,242 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	return lib.numPlugins;
 }
 
+bool PluginManager::loadCachedLibrary(const File& file)
+{
+	if (pluginCache == nullptr)
+		return false;
+
+	const String path = file.getFullPathName();
+	const String modified = String(file.getLastModificationTime().toMilliseconds());
+	const String size = String(file.getSize());
+
+	forEachXmlChildElementWithTagName(*pluginCache, entry, "LIBRARY")
+	{
+		if (entry->getStringAttribute("path") != path)
+			continue;
+
+		//A library rebuilt since the last scan is opened again
+		if (entry->getStringAttribute("modified") != modified || entry->getStringAttribute("size") != size)
+			return false;
+
+		LoadedLibInfo lib;
+		lib.apiVersion = PLUGIN_API_VER;
+		lib.name = keepString(entry->getStringAttribute("name"));
+		lib.libVersion = entry->getIntAttribute("libVersion");
+		lib.numPlugins = entry->getIntAttribute("numPlugins");
+		lib.handle = nullptr;
+		lib.path = path;
+
+		libArray.add(lib);
+		const int libIndex = libArray.size() - 1;
+
+		forEachXmlChildElementWithTagName(*entry, plugin, "PLUGIN")
+		{
+			const char* name = keepString(plugin->getStringAttribute("name"));
+			switch (plugin->getIntAttribute("type"))
+			{
+			case Plugin::PLUGIN_TYPE_PROCESSOR:
+			{
+				LoadedPluginInfo<Plugin::ProcessorInfo> info;
+				info.creator = nullptr;
+				info.name = name;
+				info.type = static_cast<Plugin::ProcessorType>(plugin->getIntAttribute("processorType"));
+				info.libIndex = libIndex;
+				processorPlugins.add(info);
+				break;
+			}
+			case Plugin::PLUGIN_TYPE_RECORD_ENGINE:
+			{
+				LoadedPluginInfo<Plugin::RecordEngineInfo> info;
+				info.creator = nullptr;
+				info.name = name;
+				info.libIndex = libIndex;
+				recordEnginePlugins.add(info);
+				break;
+			}
+			case Plugin::PLUGIN_TYPE_DATA_THREAD:
+			{
+				LoadedPluginInfo<Plugin::DataThreadInfo> info;
+				info.creator = nullptr;
+				info.name = name;
+				info.libIndex = libIndex;
+				dataThreadPlugins.add(info);
+				break;
+			}
+			case Plugin::PLUGIN_TYPE_FILE_SOURCE:
+			{
+				LoadedPluginInfo<Plugin::FileSourceInfo> info;
+				info.creator = nullptr;
+				info.name = name;
+				info.extensions = keepString(plugin->getStringAttribute("extensions"));
+				info.libIndex = libIndex;
+				fileSourcePlugins.add(info);
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		if (newPluginCache != nullptr)
+			newPluginCache->addChildElement(new XmlElement(*entry));
+		return true;
+	}
+	return false;
+}
+
+bool PluginManager::loadLibrary(int libIndex)
+{
+	if (libIndex < 0 || libIndex >= libArray.size())
+		return false;
+
+	//The signal chain loader opens libraries from its own thread
+	const ScopedLock sl(libraryLock);
+
+	LoadedLibInfo& lib = libArray.getReference(libIndex);
+	if (lib.handle)
+		return true;
+
+	std::cout << "Loading Plugin: " << lib.path << "... " << std::flush;
+
+	decltype(LoadedLibInfo::handle) handle = openLibrary(lib.path);
+	if (!handle) {
+		ERROR_MSG("Failed to load plugin DLL");
+		return false;
+	}
+
+	PluginInfoFunction piFunction = getLibraryFunction<PluginInfoFunction>(handle, "getPluginInfo");
+	if (!piFunction)
+	{
+		ERROR_MSG("Failed to load function 'getPluginInfo'");
+		closeHandle(handle);
+		return false;
+	}
+
+	Plugin::PluginInfo pInfo;
+	for (int i = 0; i < lib.numPlugins; i++)
+	{
+		if (piFunction(i, &pInfo))
+			break;
+		switch (pInfo.type)
+		{
+		case Plugin::PLUGIN_TYPE_PROCESSOR:
+			setCreator(processorPlugins, libIndex, pInfo.processor.name, pInfo.processor.creator);
+			break;
+		case Plugin::PLUGIN_TYPE_RECORD_ENGINE:
+			setCreator(recordEnginePlugins, libIndex, pInfo.recordEngine.name, pInfo.recordEngine.creator);
+			break;
+		case Plugin::PLUGIN_TYPE_DATA_THREAD:
+			setCreator(dataThreadPlugins, libIndex, pInfo.dataThread.name, pInfo.dataThread.creator);
+			break;
+		case Plugin::PLUGIN_TYPE_FILE_SOURCE:
+			setCreator(fileSourcePlugins, libIndex, pInfo.fileSource.name, pInfo.fileSource.creator);
+			break;
+		default:
+			break;
+		}
+	}
+
+	lib.handle = handle;
+	std::cout << "Loaded" << std::endl;
+	return true;
+}
+
+bool PluginManager::loadPluginLibrary(Plugin::PluginType type, int index)
+{
+	switch (type)
+	{
+	case Plugin::PLUGIN_TYPE_PROCESSOR:
+		return isPositiveAndBelow(index, processorPlugins.size()) && loadLibrary(processorPlugins[index].libIndex)
+			&& processorPlugins[index].creator != nullptr;
+	case Plugin::PLUGIN_TYPE_RECORD_ENGINE:
+		return isPositiveAndBelow(index, recordEnginePlugins.size()) && loadLibrary(recordEnginePlugins[index].libIndex)
+			&& recordEnginePlugins[index].creator != nullptr;
+	case Plugin::PLUGIN_TYPE_DATA_THREAD:
+		return isPositiveAndBelow(index, dataThreadPlugins.size()) && loadLibrary(dataThreadPlugins[index].libIndex)
+			&& dataThreadPlugins[index].creator != nullptr;
+	case Plugin::PLUGIN_TYPE_FILE_SOURCE:
+		return isPositiveAndBelow(index, fileSourcePlugins.size()) && loadLibrary(fileSourcePlugins[index].libIndex)
+			&& fileSourcePlugins[index].creator != nullptr;
+	default:
+		return false;
+	}
+}
+
+void PluginManager::addToCache(int libIndex, const File& file)
+{
+	if (newPluginCache == nullptr)
+		return;
+
+	const LoadedLibInfo& lib = libArray.getReference(libIndex);
+
+	XmlElement* entry = newPluginCache->createNewChildElement("LIBRARY");
+	entry->setAttribute("path", file.getFullPathName());
+	entry->setAttribute("modified", String(file.getLastModificationTime().toMilliseconds()));
+	entry->setAttribute("size", String(file.getSize()));
+	entry->setAttribute("name", lib.name);
+	entry->setAttribute("libVersion", lib.libVersion);
+	entry->setAttribute("numPlugins", lib.numPlugins);
+
+	for (int i = 0; i < processorPlugins.size(); i++)
+	{
+		if (processorPlugins[i].libIndex != libIndex) continue;
+		XmlElement* plugin = entry->createNewChildElement("PLUGIN");
+		plugin->setAttribute("type", Plugin::PLUGIN_TYPE_PROCESSOR);
+		plugin->setAttribute("name", processorPlugins[i].name);
+		plugin->setAttribute("processorType", processorPlugins[i].type);
+	}
+	for (int i = 0; i < recordEnginePlugins.size(); i++)
+	{
+		if (recordEnginePlugins[i].libIndex != libIndex) continue;
+		XmlElement* plugin = entry->createNewChildElement("PLUGIN");
+		plugin->setAttribute("type", Plugin::PLUGIN_TYPE_RECORD_ENGINE);
+		plugin->setAttribute("name", recordEnginePlugins[i].name);
+	}
+	for (int i = 0; i < dataThreadPlugins.size(); i++)
+	{
+		if (dataThreadPlugins[i].libIndex != libIndex) continue;
+		XmlElement* plugin = entry->createNewChildElement("PLUGIN");
+		plugin->setAttribute("type", Plugin::PLUGIN_TYPE_DATA_THREAD);
+		plugin->setAttribute("name", dataThreadPlugins[i].name);
+	}
+	for (int i = 0; i < fileSourcePlugins.size(); i++)
+	{
+		if (fileSourcePlugins[i].libIndex != libIndex) continue;
+		XmlElement* plugin = entry->createNewChildElement("PLUGIN");
+		plugin->setAttribute("type", Plugin::PLUGIN_TYPE_FILE_SOURCE);
+		plugin->setAttribute("name", fileSourcePlugins[i].name);
+		plugin->setAttribute("extensions", fileSourcePlugins[i].extensions);
+	}
+}
+
+void PluginManager::loadCache()
+{
+	pluginCache = XmlDocument::parse(getPluginCacheFile());
+
+	//Plugins built for another API version would fail to load anyway, scan them again
+	if (pluginCache != nullptr && (!pluginCache->hasTagName("PLUGINCACHE") || pluginCache->getIntAttribute("apiVersion") != PLUGIN_API_VER))
+		pluginCache = nullptr;
+}
+
+void PluginManager::saveCache()
+{
+	if (newPluginCache == nullptr || (pluginCache != nullptr && pluginCache->isEquivalentTo(newPluginCache, false)))
+		return;
+
+	File file = getPluginCacheFile();
+	file.getParentDirectory().createDirectory();
+	if (!newPluginCache->writeToFile(file, String::empty))
+		std::cerr << "Could not write plugin cache " << file.getFullPathName() << std::endl;
+}
+
+const char* PluginManager::keepString(const String& string)
+{
+	//Strings keep their text in place when the array grows, so the pointers stay valid
+	cachedStrings.add(string);
+	return cachedStrings[cachedStrings.size() - 1].toRawUTF8();
+}
+
 int PluginManager::getNumProcessors() const
 {
 	return processorPlugins.size();
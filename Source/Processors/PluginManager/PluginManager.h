@@ -46,6 +46,9 @@ struct LoadedLibInfo : public Plugin::LibraryInfo
 #else
 	void* handle;
 #endif
+	//Libraries listed from the plugin cache are not opened until one of their plugins is needed,
+	//until then handle is null and the creators of their plugins are null too
+	String path;
 };
 
 template<class T>
@@ -83,13 +86,32 @@ public:
 	int getLibraryVersion(int index) const;
 	int getLibraryIndexFromPlugin(Plugin::PluginType type, int index);
 
+	/** Opens the library of a plugin listed from the plugin cache, so the creator in its info
+	can be called. Returns false if it could not be loaded. Can be called from any thread */
+	bool loadPluginLibrary(Plugin::PluginType type, int index);
+
 private:
+	bool loadCachedLibrary(const File& file);
+	bool loadLibrary(int libIndex);
+	void addToCache(int libIndex, const File& file);
+	void loadCache();
+	void saveCache();
+	const char* keepString(const String& string);
+
 	Array<LoadedLibInfo> libArray;
 	Array<LoadedPluginInfo<Plugin::ProcessorInfo>> processorPlugins;
 	Array<LoadedPluginInfo<Plugin::DataThreadInfo>> dataThreadPlugins;
 	Array<LoadedPluginInfo<Plugin::RecordEngineInfo>> recordEnginePlugins;
 	Array<LoadedPluginInfo<Plugin::FileSourceInfo>> fileSourcePlugins;
 
+	/** Path, modification time, size, library info and plugin list of every library found
+	in the last scan, so later startups do not need to open them */
+	ScopedPointer<XmlElement> pluginCache;
+	ScopedPointer<XmlElement> newPluginCache;
+	// names of the plugins of libraries that are not loaded yet
+	StringArray cachedStrings;
+	CriticalSection libraryLock;
+
 	template<class T>
 	bool findPlugin(String name, String libName, const Array<LoadedPluginInfo<T>>& pluginArray, T& pluginInfo) const;
 
@@ -623,6 +623,11 @@ bool ProcessorGraph::enableProcessors()
 
     AccessClass::getEditorViewport()->signalChainCanBeEdited(false);
 
+	Array<GenericProcessor*> processors = getListOfProcessors();
+	processors.add(getRecordNode());
+	processors.add(getAudioNode());
+	m_watchdog.start(processors);
+
 	//Update special channels indexes, at the end
 	//To change, as many other things, when the probe system is implemented
 	getRecordNode()->updateRecordChannelIndexes();
@@ -780,4 +785,16 @@ float ProcessorGraph::getGlobalSampleRate(bool softwareOnly) const
 void ProcessorGraph::setTimestampWindow(TimestampSourceSelectionWindow* window)
 {
 	m_timestampWindow = window;
+}
+
+void ProcessorGraph::processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+	const int64 start = Time::getHighResolutionTicks();
+	AudioProcessorGraph::processBlock(buffer, midiMessages);
+	m_watchdog.checkCallback(Time::getHighResolutionTicks() - start, buffer.getNumSamples(), getSampleRate(), getGlobalTimestamp(false));
+}
+
+RealTimeWatchdog* ProcessorGraph::getWatchdog()
+{
+	return &m_watchdog;
 }
\ No newline at end of file
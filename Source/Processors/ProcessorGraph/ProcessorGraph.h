@@ -27,6 +27,7 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 
 #include "../../AccessClass.h"
+#include "RealTimeWatchdog.h"
 
 class GenericProcessor;
 class RecordNode;
@@ -99,6 +100,12 @@ public:
 
 	void setTimestampWindow(TimestampSourceSelectionWindow* window);
 
+	/** Times every callback against its real-time budget. @see RealTimeWatchdog */
+	void processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
+	using AudioProcessorGraph::processBlock;
+
+	RealTimeWatchdog* getWatchdog();
+
 private:
     int currentNodeId;
 
@@ -120,6 +127,7 @@ private:
 	int m_timestampSourceSubIdx;
 	Array<const GenericProcessor*> m_validTimestampSources;
 	WeakReference<TimestampSourceSelectionWindow> m_timestampWindow;
+	RealTimeWatchdog m_watchdog;
 };
 
 
@@ -0,0 +1,169 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "RealTimeWatchdog.h"
+#include "../GenericProcessor/GenericProcessor.h"
+
+RealTimeWatchdog::RealTimeWatchdog()
+	: m_fifo(ringSize),
+	m_experiment(0),
+	m_recording(0)
+{
+	m_ring.malloc(ringSize);
+}
+
+RealTimeWatchdog::~RealTimeWatchdog()
+{
+	closeTrace();
+}
+
+void RealTimeWatchdog::start(const Array<GenericProcessor*>& processors)
+{
+	m_processors = processors;
+	m_fifo.reset();
+	m_numOverruns = 0;
+	m_numDropped = 0;
+	m_lastDescription = String::empty;
+}
+
+void RealTimeWatchdog::checkCallback(int64 ticks, int numSamples, double sampleRate, int64 timestamp)
+{
+	if (sampleRate <= 0 || numSamples <= 0)
+		return;
+
+	const double duration = Time::highResolutionTicksToSeconds(ticks);
+	const double budget = numSamples / sampleRate;
+	if (duration <= budget)
+		return;
+
+	m_numOverruns += 1;
+
+	int start1, size1, start2, size2;
+	m_fifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 == 0)
+	{
+		m_numDropped += 1;
+		return;
+	}
+
+	Overrun& o = m_ring[start1];
+	o.timestamp = timestamp;
+	o.wallTime = Time::currentTimeMillis();
+	o.callbackTime = float(duration);
+	o.budget = float(budget);
+	o.nodeId = -1;
+	o.processorTime = 0;
+
+	for (int i = 0; i < m_processors.size(); i++)
+	{
+		const double t = m_processors.getUnchecked(i)->getTimingStats().getLastBlockTime();
+		if (t > o.processorTime)
+		{
+			o.processorTime = float(t);
+			o.nodeId = m_processors.getUnchecked(i)->getNodeId();
+		}
+	}
+
+	m_fifo.finishedWrite(1);
+}
+
+int RealTimeWatchdog::readOverruns()
+{
+	int start1, size1, start2, size2;
+	m_fifo.prepareToRead(m_fifo.getNumReady(), start1, size1, start2, size2);
+
+	for (int i = 0; i < size1 + size2; i++)
+	{
+		const Overrun& o = m_ring[i < size1 ? start1 + i : start2 + i - size1];
+		const String name = getProcessorName(o.nodeId);
+
+		m_lastDescription = name + " (" + String(o.nodeId) + ") took " + String(o.processorTime * 1000.0f, 2) + " ms of a "
+			+ String(o.callbackTime * 1000.0f, 2) + " ms callback, budget " + String(o.budget * 1000.0f, 2) + " ms";
+
+		if (m_trace != nullptr)
+		{
+			*m_trace << m_experiment << "," << m_recording << "," << o.wallTime << "," << o.timestamp << ","
+				<< String(o.callbackTime * 1000.0f, 3) << "," << String(o.budget * 1000.0f, 3) << ","
+				<< String((o.callbackTime - o.budget) * 1000.0f, 3) << "," << o.nodeId << ","
+				<< name.quoted() << "," << String(o.processorTime * 1000.0f, 3) << "\n";
+		}
+	}
+	m_fifo.finishedRead(size1 + size2);
+
+	if (m_trace != nullptr && size1 + size2 > 0)
+		m_trace->flush();
+
+	return size1 + size2;
+}
+
+void RealTimeWatchdog::openTrace(const File& file, int experiment, int recording)
+{
+	closeTrace();
+
+	const bool isNew = !file.existsAsFile();
+	m_trace = new FileOutputStream(file);
+	if (m_trace->failedToOpen())
+	{
+		std::cerr << "Could not open " << file.getFullPathName() << ": " << m_trace->getStatus().getErrorMessage() << std::endl;
+		m_trace = nullptr;
+		return;
+	}
+
+	if (isNew)
+		*m_trace << "experiment,recording,wall_time_ms,timestamp,callback_ms,budget_ms,overrun_ms,processor_id,processor_name,processor_ms\n";
+
+	m_experiment = experiment;
+	m_recording = recording;
+}
+
+void RealTimeWatchdog::closeTrace()
+{
+	if (m_trace != nullptr)
+		readOverruns();
+	m_trace = nullptr;
+}
+
+int RealTimeWatchdog::getNumOverruns() const
+{
+	return m_numOverruns.get();
+}
+
+int RealTimeWatchdog::getNumDroppedOverruns() const
+{
+	return m_numDropped.get();
+}
+
+String RealTimeWatchdog::getLastOverrunDescription() const
+{
+	return m_lastDescription;
+}
+
+String RealTimeWatchdog::getProcessorName(int nodeId) const
+{
+	for (int i = 0; i < m_processors.size(); i++)
+	{
+		if (m_processors[i]->getNodeId() == nodeId)
+			return m_processors[i]->getName();
+	}
+	return "Unknown";
+}
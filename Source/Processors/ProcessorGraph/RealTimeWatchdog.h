@@ -0,0 +1,101 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef REALTIMEWATCHDOG_H_INCLUDED
+#define REALTIMEWATCHDOG_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+class GenericProcessor;
+
+/**
+	Flags audio callbacks that take longer than the audio they process.
+
+	The ProcessorGraph reports the duration of every callback. When it exceeds
+	the block's real-time budget (samples / sample rate), the processor that spent
+	the most time on that block is blamed and the overrun is pushed into a
+	lock-free ring. The message thread drains the ring with readOverruns(), keeps
+	a summary for the ControlPanel and, while recording, appends the overruns to a
+	CSV trace so data gaps can be matched with plugins afterwards.
+
+	@see ProcessorGraph, ProcessorTimingStats
+*/
+class RealTimeWatchdog
+{
+public:
+	struct Overrun
+	{
+		int64 timestamp;
+		int64 wallTime;
+		int nodeId;
+		float callbackTime;
+		float budget;
+		float processorTime;
+	};
+
+	RealTimeWatchdog();
+	~RealTimeWatchdog();
+
+	/** Sets the processors to blame and clears all counters. Call before the callbacks start */
+	void start(const Array<GenericProcessor*>& processors);
+
+	/** Called from the audio thread at the end of every callback */
+	void checkCallback(int64 ticks, int numSamples, double sampleRate, int64 timestamp);
+
+	/** Moves the overruns recorded since the last call into the trace file, if any, and
+	updates the summary. Message thread only. Returns the number of new overruns */
+	int readOverruns();
+
+	/** Starts appending overruns to a CSV file. The header is written if the file is new */
+	void openTrace(const File& file, int experiment, int recording);
+	void closeTrace();
+
+	/** Total overruns since start(), including those not read yet */
+	int getNumOverruns() const;
+
+	/** Overruns that did not fit in the ring and were only counted */
+	int getNumDroppedOverruns() const;
+
+	/** Human readable description of the last overrun read */
+	String getLastOverrunDescription() const;
+
+private:
+	String getProcessorName(int nodeId) const;
+
+	static const int ringSize = 1024;
+
+	Array<GenericProcessor*> m_processors;
+	AbstractFifo m_fifo;
+	HeapBlock<Overrun> m_ring;
+	Atomic<int> m_numOverruns;
+	Atomic<int> m_numDropped;
+
+	ScopedPointer<FileOutputStream> m_trace;
+	int m_experiment;
+	int m_recording;
+	String m_lastDescription;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealTimeWatchdog);
+};
+
+#endif  // REALTIMEWATCHDOG_H_INCLUDED
@@ -148,6 +148,8 @@ namespace ProcessorManager
 			break;
 		case PluginProcessor:
 			{
+				if (!AccessClass::getPluginManager()->loadPluginLibrary(Plugin::PLUGIN_TYPE_PROCESSOR, index))
+					return nullptr;
 				Plugin::ProcessorInfo info = AccessClass::getPluginManager()->getProcessorInfo(index);
 				GenericProcessor* proc = info.creator();
 				proc->setPluginData(Plugin::PLUGIN_TYPE_PROCESSOR, index);
@@ -156,6 +158,8 @@ namespace ProcessorManager
 			}
 		case DataThreadProcessor:
 		{
+			if (!AccessClass::getPluginManager()->loadPluginLibrary(Plugin::PLUGIN_TYPE_DATA_THREAD, index))
+				return nullptr;
 			Plugin::DataThreadInfo info = AccessClass::getPluginManager()->getDataThreadInfo(index);
 			GenericProcessor* proc = new SourceNode(info.name, info.creator);
 			proc->setPluginData(Plugin::PLUGIN_TYPE_DATA_THREAD, index);
@@ -188,6 +192,9 @@ namespace ProcessorManager
 						int libIndex = pm->getLibraryIndexFromPlugin(Plugin::PLUGIN_TYPE_PROCESSOR, i);
 						if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex))
 						{
+							if (!pm->loadPluginLibrary(Plugin::PLUGIN_TYPE_PROCESSOR, i))
+								break;
+							info = pm->getProcessorInfo(i);
 							proc = info.creator();
 							proc->setPluginData(Plugin::PLUGIN_TYPE_PROCESSOR, i);
 							return proc;
@@ -205,6 +212,9 @@ namespace ProcessorManager
 						int libIndex = pm->getLibraryIndexFromPlugin(Plugin::PLUGIN_TYPE_DATA_THREAD, i);
 						if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex))
 						{
+							if (!pm->loadPluginLibrary(Plugin::PLUGIN_TYPE_DATA_THREAD, i))
+								break;
+							info = pm->getDataThreadInfo(i);
 							proc = new SourceNode(info.name, info.creator);
 							proc->setPluginData(Plugin::PLUGIN_TYPE_DATA_THREAD, i);
 							return proc;
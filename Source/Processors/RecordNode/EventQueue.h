@@ -25,117 +25,207 @@
 #define EVENTQUEUE_H_INCLUDED
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
-#include "../Events/Events.h"
-#include <vector>
+#include <atomic>
 
-template <class MsgContainer>
-class AsyncEventMessage :
-	public ReferenceCountedObject
-{
-public:
-	AsyncEventMessage(const MsgContainer& m, int64 t, int extra) : 
-		ReferenceCountedObject(),
-		m_data(m),
-		m_timestamp(t),
-		m_extra(extra)
-	{}
-
-	~AsyncEventMessage() {};
+/**
+	Single-producer, single-consumer queue of serialized events or spikes in a flat byte ring.
 
-	const MsgContainer& getData() const { return m_data;  }
-	const int64& getTimestamp() const { return m_timestamp; }
-	const int& getExtra() const { return m_extra;  }
+	The processing thread serializes each event straight into the ring as a record: a
+	header followed by the event bytes, padded to 8 bytes. A record never wraps around
+	the end of the ring; when it does not fit before the end, the rest of the ring is
+	skipped and it is written at the start. The record thread reads the records in
+	place and releases them, so nothing is allocated per event on either side.
 
-private:
-	const MsgContainer m_data;
-	const int64 m_timestamp;
-	const int m_extra;
-
-};
+	Records that do not fit in the free space are dropped and counted.
 
-template <class EventClass>
+	@see RecordNode, RecordThread
+*/
 class EventQueue
 {
 public:
-	typedef AsyncEventMessage<EventClass> EventContainer;
-	typedef ReferenceCountedObjectPtr<EventContainer> EventClassPtr;
-
-	EventQueue(int size) :
-		m_fifo(size)
+	struct Record
+	{
+		/** Size of the serialized event following the header, in bytes */
+		uint32 size;
+		/** Event channel or electrode index */
+		int32 extra;
+		int64 timestamp;
+
+		const uint8* getData() const { return reinterpret_cast<const uint8*>(this + 1); }
+	};
+
+	EventQueue(int sizeInBytes) :
+		m_ring(nullptr),
+		m_capacity(0),
+		m_writePosition(0),
+		m_readPosition(0),
+		m_numRecords(0),
+		m_pendingWritePosition(0),
+		m_pendingReadPosition(0),
+		m_highWaterMark(0),
+		m_numOverflows(0)
 	{
-		m_data.resize(size);
+		resize(sizeInBytes);
 	}
 
 	~EventQueue()
 	{}
 
-	int getRemainingEvents() const
+	/** Bytes taken in the ring by an event of the given size */
+	static int getRecordSize(int eventSize)
 	{
-		return m_fifo.getNumReady();
+		return (int(sizeof(Record)) + eventSize + 7) & ~7;
 	}
 
+	/** Sets the size of the ring and clears it. Neither thread may be using the queue */
+	void resize(int sizeInBytes)
+	{
+		m_capacity = jmax(getRecordSize(256), (sizeInBytes + 7) & ~7);
+		m_storage.malloc(size_t(m_capacity / sizeof(int64)));
+		m_ring = reinterpret_cast<uint8*>(m_storage.getData());
+		reset();
+	}
+
+	int getSize() const
+	{
+		return int(m_capacity);
+	}
+
+	/** Clears the ring and the counters. Neither thread may be using the queue */
 	void reset()
 	{
-		m_data.clear();
-		m_data.resize(m_fifo.getTotalSize());
+		m_writePosition = 0;
+		m_readPosition = 0;
+		m_numRecords = 0;
+		m_highWaterMark = 0;
+		m_numOverflows = 0;
 	}
 
-	void resize(int size)
+	int getRemainingEvents() const
 	{
-		m_data.clear();
-		m_fifo.setTotalSize(size);
-		m_data.resize(size);
+		return m_numRecords.load(std::memory_order_acquire);
 	}
 
-	void addEvent(const EventClass& ev, int64 t, int extra = 0)
+	/** Highest number of bytes used since the last reset */
+	int getHighWaterMark() const
 	{
-		int pos1, size1, pos2, size2;
-		size1 = 0;
-		m_fifo.prepareToWrite(1, pos1, size1, pos2, size2);
+		return m_highWaterMark.load(std::memory_order_relaxed);
+	}
 
-		/* This means there is a buffer overrun. Instead of overwritting the existing data and risking a collision of both threads
-			we just skip the incoming samples. TODO: use this to notify of the overrun and act consequently   */
-		if (size1 > 0)
-		{
-			m_data[pos1] = new EventContainer(ev, t, extra);
-			m_fifo.finishedWrite(1);
-		}
+	/** Number of events dropped because the ring was full since the last reset */
+	int64 getNumOverflows() const
+	{
+		return m_numOverflows.load(std::memory_order_relaxed);
 	}
 
-	int getEvents(std::vector<EventClassPtr>& vec, int max)
+	/** Producer side. Reserves a record and returns where to serialize its size bytes,
+	or nullptr if the ring is full. Must be followed by finishWrite() */
+	uint8* startWrite(int size, int64 timestamp, int extra)
 	{
-		int pos1, size1, pos2, size2;
-		int numAvailable = m_fifo.getNumReady();
-		int numToRead = ((max < numAvailable) && (max > 0)) ? max : numAvailable;
-		m_fifo.prepareToRead(numToRead, pos1, size1, pos2, size2);
-		vec.resize(numToRead);
-		for (int i = 0; i < size1; ++i)
+		const int64 writePosition = m_writePosition.load(std::memory_order_relaxed);
+		const int64 readPosition = m_readPosition.load(std::memory_order_acquire);
+		const int64 recordSize = getRecordSize(size);
+
+		int64 offset = writePosition % m_capacity;
+		const int64 untilEnd = m_capacity - offset;
+		const int64 skipped = (recordSize > untilEnd) ? untilEnd : 0;
+
+		if (writePosition - readPosition + skipped + recordSize > m_capacity)
+		{
+			m_numOverflows.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		if (skipped > 0)
 		{
-			vec[i] = m_data[pos1 + i];
+			// a gap too short for a header is skipped by the reader without a marker
+			if (skipped >= int64(sizeof(Record)))
+				reinterpret_cast<Record*>(m_ring + offset)->size = skipMarker;
+			offset = 0;
 		}
-		if (size2 > 0)
+
+		Record* record = reinterpret_cast<Record*>(m_ring + offset);
+		record->size = uint32(size);
+		record->extra = extra;
+		record->timestamp = timestamp;
+
+		m_pendingWritePosition = writePosition + skipped + recordSize;
+
+		const int used = int(m_pendingWritePosition - readPosition);
+		if (used > m_highWaterMark.load(std::memory_order_relaxed))
+			m_highWaterMark.store(used, std::memory_order_relaxed);
+
+		return m_ring + offset + sizeof(Record);
+	}
+
+	/** Producer side. Makes the record reserved by startWrite() visible to the reader */
+	void finishWrite()
+	{
+		m_writePosition.store(m_pendingWritePosition, std::memory_order_release);
+		m_numRecords.fetch_add(1, std::memory_order_release);
+	}
+
+	/** Producer side. Queues a serialized event */
+	bool addEvent(const MidiMessage& ev, int64 t, int extra = 0)
+	{
+		const int size = ev.getRawDataSize();
+		uint8* dest = startWrite(size, t, extra);
+		if (dest == nullptr)
+			return false;
+
+		memcpy(dest, ev.getRawData(), size);
+		finishWrite();
+		return true;
+	}
+
+	/** Consumer side. Returns the oldest record, or nullptr if there is none. The record
+	stays valid until releaseRecord() is called */
+	const Record* getNextRecord()
+	{
+		int64 readPosition = m_readPosition.load(std::memory_order_relaxed);
+		if (readPosition == m_writePosition.load(std::memory_order_acquire))
+			return nullptr;
+
+		int64 offset = readPosition % m_capacity;
+		const int64 untilEnd = m_capacity - offset;
+		if (untilEnd < int64(sizeof(Record)) || reinterpret_cast<const Record*>(m_ring + offset)->size == skipMarker)
 		{
-			for (int i = 0; i < size2; ++i)
-			{
-				vec[size1 + i] = m_data[pos2 + i];
-			}
+			readPosition += untilEnd;
+			offset = 0;
 		}
-		m_fifo.finishedRead(numToRead);
-		return numToRead;
+
+		const Record* record = reinterpret_cast<const Record*>(m_ring + offset);
+		m_pendingReadPosition = readPosition + getRecordSize(int(record->size));
+		return record;
+	}
+
+	/** Consumer side. Frees the record returned by getNextRecord() */
+	void releaseRecord()
+	{
+		m_readPosition.store(m_pendingReadPosition, std::memory_order_release);
+		m_numRecords.fetch_sub(1, std::memory_order_release);
 	}
 
 private:
-	std::vector<EventClassPtr> m_data;
-	AbstractFifo m_fifo;
+	static const uint32 skipMarker = 0xffffffff;
+
+	// int64 storage keeps the records 8-byte aligned
+	HeapBlock<int64> m_storage;
+	uint8* m_ring;
+	int64 m_capacity;
+
+	// bytes written and read since the last reset; only their difference wraps
+	std::atomic<int64> m_writePosition;
+	std::atomic<int64> m_readPosition;
+	std::atomic<int> m_numRecords;
+
+	int64 m_pendingWritePosition;
+	int64 m_pendingReadPosition;
+
+	std::atomic<int> m_highWaterMark;
+	std::atomic<int64> m_numOverflows;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventQueue);
 };
-//NOTE: Events are sent as midimessages while spikes as spike objects due to the difference on how they are passed to the record node.
-//Once the probe system is implemented, this will be normalized
-typedef EventQueue<MidiMessage> EventMsgQueue;
-typedef EventQueue<SpikeEvent> SpikeMsgQueue;
-typedef ReferenceCountedObjectPtr<AsyncEventMessage<MidiMessage>> EventMessagePtr;
-typedef ReferenceCountedObjectPtr<AsyncEventMessage<SpikeEvent>> SpikeMessagePtr;
 
 #endif  // EVENTQUEUE_H_INCLUDED
-
@@ -50,6 +50,13 @@ void RecordEngine::addSpikeElectrode(int index, const SpikeChannel* chan) {}
 
 void RecordEngine::startChannelBlock (bool lastBlock) {}
 
+void RecordEngine::writeTTLWordChange (int eventChannel, const TTLWordChange& change)
+{
+    const EventChannel* channel = getEventChannel (eventChannel);
+    for (int bit = change.getNextChangedBit (-1); bit >= 0; bit = change.getNextChangedBit (bit))
+        writeEvent (eventChannel, change.getBitEvent (channel, bit));
+}
+
 void RecordEngine::endChannelBlock (bool lastBlock) {}
 
 const DataChannel* RecordEngine::getDataChannel (int index) const
@@ -107,6 +107,10 @@ public:
     /** Write a single event to disk.  */
     virtual void writeEvent (int eventChannel, const MidiMessage& event) = 0;
 
+    /** Write a compact TTL word change to disk. By default it is expanded and written
+        as a TTL event per changed bit with writeEvent() */
+    virtual void writeTTLWordChange (int eventChannel, const TTLWordChange& change);
+
 	/** Handle the timestamp sync text messages*/
 	virtual void writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text) = 0;
 
@@ -57,8 +57,10 @@ RecordNode::RecordNode()
     setPlayConfigDetails(getNumInputs(),getNumOutputs(),44100.0,128);
 	m_recordThread = new RecordThread(engineArray);
 	m_dataQueue = new DataQueue(WRITE_BLOCK_LENGTH, DATA_BUFFER_NBLOCKS);
-	m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS);
-	m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES);
+	m_eventQueueNumEvents = EVENT_BUFFER_NEVENTS;
+	m_spikeQueueNumSpikes = SPIKE_BUFFER_NSPIKES;
+	m_eventQueue = new EventQueue(EventQueue::getRecordSize(256) * m_eventQueueNumEvents);
+	m_spikeQueue = new EventQueue(EventQueue::getRecordSize(256) * m_spikeQueueNumSpikes);
 	m_recordThread->setQueuePointers(m_dataQueue, m_eventQueue, m_spikeQueue);
 }
 
@@ -328,8 +330,7 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 		EVERY_ENGINE->setChannelMapping(channelMap, chanProcessorMap, chanOrderinProc, procInfo);
 		m_recordThread->setChannelMap(channelMap);
 		m_dataQueue->setChannels(numRecordedChannels);
-		m_eventQueue->reset();
-		m_spikeQueue->reset();
+		resizeEventQueues();
 		m_recordThread->setFirstBlockFlag(false);
 
 		setFirstBlock = false;
@@ -453,6 +454,11 @@ void RecordNode::handleEvent(const EventChannel* eventInfo, const MidiMessage& e
     }
 }
 
+bool RecordNode::acceptsTTLWordChanges() const
+{
+	return true;
+}
+
 void RecordNode::handleTimestampSyncTexts(const MidiMessage& event)
 {
 	handleEvent(nullptr, event, 0);
@@ -537,10 +543,78 @@ void RecordNode::writeSpike(const SpikeEvent* spike, const SpikeChannel* spikeEl
 	{
 		int electrodeIndex = getSpikeChannelIndex(spikeElectrode->getSourceIndex(), spikeElectrode->getSourceNodeID(), spikeElectrode->getSubProcessorIdx());
 		if (electrodeIndex >= 0)
-			m_spikeQueue->addEvent(*spike, spike->getTimestamp(), electrodeIndex);
+		{
+			//Serialized straight into the queue, the record thread rebuilds the spike
+			const int size = getSpikeSize(spikeElectrode);
+			uint8* dest = m_spikeQueue->startWrite(size, spike->getTimestamp(), electrodeIndex);
+			if (dest != nullptr)
+			{
+				spike->serialize(dest, size);
+				m_spikeQueue->finishWrite();
+			}
+		}
 	}
 }
 
+void RecordNode::setEventQueueSize(int numEvents, int numSpikes)
+{
+	m_eventQueueNumEvents = jmax(1, numEvents);
+	m_spikeQueueNumSpikes = jmax(1, numSpikes);
+}
+
+int RecordNode::getEventQueueNumEvents() const
+{
+	return m_eventQueueNumEvents;
+}
+
+int RecordNode::getSpikeQueueNumSpikes() const
+{
+	return m_spikeQueueNumSpikes;
+}
+
+const EventQueue& RecordNode::getEventQueue() const
+{
+	return *m_eventQueue;
+}
+
+const EventQueue& RecordNode::getSpikeQueue() const
+{
+	return *m_spikeQueue;
+}
+
+int RecordNode::getSpikeSize(const SpikeChannel* chan)
+{
+	return int(SPIKE_BASE_SIZE + chan->getNumChannels() * sizeof(float) + chan->getDataSize() + chan->getTotalEventMetaDataSize());
+}
+
+void RecordNode::resizeEventQueues()
+{
+	//Sized to hold the requested number of the largest events and spikes recorded.
+	//Sync texts have no channel, 256 bytes leaves room for them
+	int maxEventSize = 256;
+	for (int i = 0; i < eventChannelArray.size(); ++i)
+	{
+		const EventChannel* chan = eventChannelArray[i];
+		maxEventSize = jmax(maxEventSize, int(EVENT_BASE_SIZE + chan->getDataSize() + chan->getTotalEventMetaDataSize()));
+	}
+	int maxSpikeSize = 256;
+	for (int i = 0; i < spikeChannelArray.size(); ++i)
+		maxSpikeSize = jmax(maxSpikeSize, getSpikeSize(spikeChannelArray[i]));
+
+	const int eventQueueSize = EventQueue::getRecordSize(maxEventSize) * m_eventQueueNumEvents;
+	const int spikeQueueSize = EventQueue::getRecordSize(maxSpikeSize) * m_spikeQueueNumSpikes;
+
+	if (m_eventQueue->getSize() != eventQueueSize)
+		m_eventQueue->resize(eventQueueSize);
+	else
+		m_eventQueue->reset();
+
+	if (m_spikeQueue->getSize() != spikeQueueSize)
+		m_spikeQueue->resize(spikeQueueSize);
+	else
+		m_spikeQueue->reset();
+}
+
 void RecordNode::clearRecordEngines()
 {
     engineArray.clear();
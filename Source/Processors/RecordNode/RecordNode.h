@@ -34,8 +34,13 @@
 
 #define WRITE_BLOCK_LENGTH 1024
 #define DATA_BUFFER_NBLOCKS 300
+//Default number of events and spikes queued for the record thread. Can be changed with setEventQueueSize
+#ifndef EVENT_BUFFER_NEVENTS
 #define EVENT_BUFFER_NEVENTS 512
+#endif
+#ifndef SPIKE_BUFFER_NSPIKES
 #define SPIKE_BUFFER_NSPIKES 512
+#endif
 
 class RecordEngine;
 class RecordThread;
@@ -64,6 +69,9 @@ public:
     */
     void process(AudioSampleBuffer& buffer) override;
 
+    /** TTL word changes are queued as they are, the record engines expand them if needed */
+    bool acceptsTTLWordChanges() const override;
+
 
     /** Overrides implementation in GenericProcessor; used to change recording parameters
         on the fly.
@@ -151,6 +159,16 @@ public:
 	/** Get the last settings.xml in string form. Since the string will be large, returns a const ref.*/
 	const String& getLastSettingsXml() const;
 
+	/** Sets how many events and spikes of the largest size the queues to the record thread hold.
+	Takes effect when the next recording starts */
+	void setEventQueueSize(int numEvents, int numSpikes);
+	int getEventQueueNumEvents() const;
+	int getSpikeQueueNumSpikes() const;
+
+	/** Queues to the record thread, to read their high-water marks and overflow counts */
+	const EventQueue& getEventQueue() const;
+	const EventQueue& getSpikeQueue() const;
+
 	//Called by ProcessorGraph
 	void updateRecordChannelIndexes();
 	void addSpecialProcessorChannels(Array<EventChannel*>& channels);
@@ -198,13 +216,20 @@ private:
 
 	virtual void handleTimestampSyncTexts(const MidiMessage& event);
 
+	/** Size of a serialized spike of an electrode */
+	static int getSpikeSize(const SpikeChannel* chan);
+	/** Sizes the event and spike queues for the recorded channels and clears them */
+	void resizeEventQueues();
+
     /**RecordEngines loaded**/
     OwnedArray<RecordEngine> engineArray;
 
 	ScopedPointer<RecordThread> m_recordThread;
 	ScopedPointer<DataQueue> m_dataQueue;
-	ScopedPointer<EventMsgQueue> m_eventQueue;
-	ScopedPointer<SpikeMsgQueue> m_spikeQueue;
+	ScopedPointer<EventQueue> m_eventQueue;
+	ScopedPointer<EventQueue> m_spikeQueue;
+	int m_eventQueueNumEvents;
+	int m_spikeQueueNumSpikes;
 	
 	Array<int> m_recordedChannelMap;
 	Array<bool> m_validBlocks;
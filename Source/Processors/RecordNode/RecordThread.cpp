@@ -60,7 +60,7 @@ void RecordThread::setChannelMap(const Array<int>& channels)
 	m_numChannels = channels.size();
 }
 
-void RecordThread::setQueuePointers(DataQueue* data, EventMsgQueue* events, SpikeMsgQueue* spikes)
+void RecordThread::setQueuePointers(DataQueue* data, EventQueue* events, EventQueue* spikes)
 {
 	m_dataQueue = data;
 	m_eventQueue = events;
@@ -136,29 +136,39 @@ void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples
 	m_dataQueue->stopRead();
 	EVERY_ENGINE->endChannelBlock(lastBlock);
 
-	std::vector<EventMessagePtr> events;
-	int nEvents = m_eventQueue->getEvents(events, maxEvents);
-	for (int ev = 0; ev < nEvents; ++ev)
+	RecordNode* recordNode = AccessClass::getProcessorGraph()->getRecordNode();
+
+	//Events and spikes are read in place from the queues and released once written
+	const EventQueue::Record* record;
+	for (int ev = 0; (maxEvents <= 0 || ev < maxEvents) && (record = m_eventQueue->getNextRecord()) != nullptr; ++ev)
 	{
-		const MidiMessage& event = events[ev]->getData();
+		if (TTLWordChange::isWordChange(record->getData(), record->size))
+		{
+			EVERY_ENGINE->writeTTLWordChange(record->extra, TTLWordChange(record->getData()));
+			m_eventQueue->releaseRecord();
+			continue;
+		}
+		const MidiMessage event(record->getData(), record->size);
 		if (SystemEvent::getBaseType(event) == SYSTEM_EVENT)
 		{
 			uint16 sourceID = SystemEvent::getSourceID(event);
 			uint16 subProcIdx = SystemEvent::getSubProcessorIdx(event);
 			int64 timestamp = SystemEvent::getTimestamp(event);
 				EVERY_ENGINE->writeTimestampSyncText(sourceID, subProcIdx, timestamp,
-				AccessClass::getProcessorGraph()->getRecordNode()->getSourceTimestamp(sourceID, subProcIdx),
+				recordNode->getSourceTimestamp(sourceID, subProcIdx),
 				SystemEvent::getSyncText(event));
 		}
 		else
-			EVERY_ENGINE->writeEvent(events[ev]->getExtra(), events[ev]->getData());
+			EVERY_ENGINE->writeEvent(record->extra, event);
+		m_eventQueue->releaseRecord();
 	}
 
-	std::vector<SpikeMessagePtr> spikes;
-	int nSpikes = m_spikeQueue->getEvents(spikes, maxSpikes);
-	for (int sp = 0; sp < nSpikes; ++sp)
+	for (int sp = 0; (maxSpikes <= 0 || sp < maxSpikes) && (record = m_spikeQueue->getNextRecord()) != nullptr; ++sp)
 	{
-		EVERY_ENGINE->writeSpike(spikes[sp]->getExtra(), &spikes[sp]->getData());
+		SpikeEventPtr spike = SpikeEvent::deserializeFromBuffer(record->getData(), record->size, recordNode->getSpikeChannel(record->extra));
+		if (spike != nullptr)
+			EVERY_ENGINE->writeSpike(record->extra, spike);
+		m_spikeQueue->releaseRecord();
 	}
 }
 
@@ -43,7 +43,7 @@ public:
 	~RecordThread();
 	void setFileComponents(File rootFolder, int experimentNumber, int recordingNumber);
 	void setChannelMap(const Array<int>& channels);
-	void setQueuePointers(DataQueue* data, EventMsgQueue* events, SpikeMsgQueue* spikes);
+	void setQueuePointers(DataQueue* data, EventQueue* events, EventQueue* spikes);
 
 	void run() override;
 
@@ -57,8 +57,8 @@ private:
 	Array<int> m_channelArray;
 	
 	DataQueue* m_dataQueue;
-	EventMsgQueue* m_eventQueue;
-	SpikeMsgQueue *m_spikeQueue;
+	EventQueue* m_eventQueue;
+	EventQueue* m_spikeQueue;
 
 	std::atomic<bool> m_receivedFirstBlock;
 	std::atomic<bool> m_cleanExit;
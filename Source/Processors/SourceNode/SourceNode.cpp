@@ -34,6 +34,7 @@ SourceNode::SourceNode (const String& name_, DataThreadCreator dt)
     , wasDisabled           (true)
     , dataThread            (nullptr)
     , ttlState              (0)
+    , compactTTLEvents      (false)
 {
     setProcessorType (PROCESSOR_TYPE_SOURCE);
 
@@ -371,22 +372,38 @@ void SourceNode::process(AudioSampleBuffer& buffer)
 			int numEventChannels = ttlChannels[sub]->getNumChannels();
 			// fill event buffer
 			uint64 last = eventStates[sub];
-			for (int i = 0; i < nSamples; ++i)
+			if (compactTTLEvents)
 			{
-				uint64 current = *(static_cast<uint64*>(eventCodeBuffers[sub]->getData()) + i);
-				//If there has been no change to the TTL word, avoid doing anything at all here
-				if (last != current)
+				const uint64 channelMask = numEventChannels >= 64 ? ~uint64(0) : (uint64(1) << numEventChannels) - 1;
+				for (int i = 0; i < nSamples; ++i)
 				{
-					//Create a TTL event for each bit that has changed
-					for (int c = 0; c < numEventChannels; ++c)
+					uint64 current = *(static_cast<uint64*>(eventCodeBuffers[sub]->getData()) + i);
+					const uint64 changedBits = (last ^ current) & channelMask;
+					//A single event carrying the word for all the bits that changed
+					if (changedBits != 0)
+						addTTLWordChange(ttlChannels[sub], timestamp + i, current, changedBits, i);
+					last = current;
+				}
+			}
+			else
+			{
+				for (int i = 0; i < nSamples; ++i)
+				{
+					uint64 current = *(static_cast<uint64*>(eventCodeBuffers[sub]->getData()) + i);
+					//If there has been no change to the TTL word, avoid doing anything at all here
+					if (last != current)
 					{
-						if (((current >> c) & 0x01) != ((last >> c) & 0x01))
+						//Create a TTL event for each bit that has changed
+						for (int c = 0; c < numEventChannels; ++c)
 						{
-							TTLEventPtr event = TTLEvent::createTTLEvent(ttlChannels[sub], timestamp + i, &current, sizeof(uint64), c);
-							addEvent(ttlChannels[sub], event, i);
+							if (((current >> c) & 0x01) != ((last >> c) & 0x01))
+							{
+								TTLEventPtr event = TTLEvent::createTTLEvent(ttlChannels[sub], timestamp + i, &current, sizeof(uint64), c);
+								addEvent(ttlChannels[sub], event, i);
+							}
 						}
+						last = current;
 					}
-					last = current;
 				}
 			}
 			eventStates.set(sub, last);
@@ -395,8 +412,23 @@ void SourceNode::process(AudioSampleBuffer& buffer)
 }
 
 
+void SourceNode::setCompactTTLEvents (bool compact)
+{
+    compactTTLEvents = compact;
+}
+
+
+bool SourceNode::getCompactTTLEvents() const
+{
+    return compactTTLEvents;
+}
+
+
 void SourceNode::saveCustomParametersToXml (XmlElement* parentElement)
 {
+    XmlElement* ttlXml = parentElement->createNewChildElement ("TTL_EVENTS");
+    ttlXml->setAttribute ("compact", compactTTLEvents);
+
     XmlElement* channelXml = parentElement->createNewChildElement ("CHANNEL_INFO");
     if (dataThread->usesCustomNames())
     {
@@ -420,7 +452,11 @@ void SourceNode::loadCustomParametersFromXml()
         // use parametersAsXml to restore state
         forEachXmlChildElement (*parametersAsXml, xmlNode)
         {
-            if (xmlNode->hasTagName ("CHANNEL_INFO"))
+            if (xmlNode->hasTagName ("TTL_EVENTS"))
+            {
+                compactTTLEvents = xmlNode->getBoolAttribute ("compact", false);
+            }
+            else if (xmlNode->hasTagName ("CHANNEL_INFO"))
             {
                 forEachXmlChildElementWithTagName (*xmlNode, chan, "CHANNEL")
                 {
@@ -85,6 +85,11 @@ public:
 
     int getTTLState() const { return ttlState; }
 
+    /** When enabled, TTL inputs are sent as one TTLWordChange event per change of the TTL word
+        instead of one TTL event per changed bit */
+    void setCompactTTLEvents (bool compact);
+    bool getCompactTTLEvents() const;
+
     bool tryEnablingEditor();
 
 	void setChannelInfo(int channel, String name, float bitVolts);
@@ -113,6 +118,7 @@ private:
 	Array<EventChannel*> ttlChannels;
 
     int ttlState;
+    bool compactTTLEvents;
 	void resizeBuffers();
 
 
@@ -96,7 +96,7 @@ RecordButton::~RecordButton()
 }
 
 
-CPUMeter::CPUMeter() : Label("CPU Meter","0.0"), cpu(0.0f), lastCpu(0.0f)
+CPUMeter::CPUMeter() : Label("CPU Meter","0.0"), cpu(0.0f), lastCpu(0.0f), overruns(0)
 {
 
     font = Font("Small Text", 12, Font::plain);
@@ -119,6 +119,16 @@ void CPUMeter::updateCPU(float usage)
     cpu = usage;
 }
 
+void CPUMeter::updateOverruns(int numOverruns, const String& lastOverrun)
+{
+    overruns = numOverruns;
+
+    if (overruns > 0)
+        setTooltip("CPU usage. " + String(overruns) + " blocks over the real-time budget, last: " + lastOverrun);
+    else
+        setTooltip("CPU usage");
+}
+
 void CPUMeter::paint(Graphics& g)
 {
     g.fillAll(Colours::grey);
@@ -132,6 +142,12 @@ void CPUMeter::paint(Graphics& g)
     g.setFont(font);
     g.drawSingleLineText("CPU",65,12);
 
+    if (overruns > 0)
+    {
+        g.setColour(Colours::red);
+        g.fillEllipse(float(getWidth() - 12), 3.0f, 8.0f, 8.0f);
+    }
+
 }
 
 
@@ -419,6 +435,12 @@ ControlPanel::ControlPanel(ProcessorGraph* graph_, AudioComponent* audio_)
     recordOptionsButton->setTooltip("Configure options for selected record engine");
     addChildComponent(recordOptionsButton);
 
+    recordQueueLabel = new Label("Record queues", "");
+    recordQueueLabel->setFont(Font("Small Text", 12, Font::plain));
+    recordQueueLabel->setJustificationType(Justification::centred);
+    addChildComponent(recordQueueLabel);
+    refreshRecordQueues();
+
     newDirectoryButton = new UtilityButton("+", Font("Small Text", 15, Font::plain));
     newDirectoryButton->setEnabledState(false);
     newDirectoryButton->addListener(this);
@@ -528,6 +550,8 @@ void ControlPanel::updateRecordEngineList()
 	int selectedEngine = recordSelector->getSelectedId();
 	recordSelector->clear(dontSendNotification);
 	recordEngines.clear();
+	recordEnginePlugins.clear();
+	lastEngineIndex = -1;
 	int id = 1;
 
 	for (int i = 0; i < RecordEngineManager::getNumOfBuiltInEngines(); i++)
@@ -535,13 +559,17 @@ void ControlPanel::updateRecordEngineList()
 		RecordEngineManager* rem = RecordEngineManager::createBuiltInEngineManager(i);
 		recordSelector->addItem(rem->getName(), id++);
 		recordEngines.add(rem);
+		recordEnginePlugins.add(-1);
 	}
+	//Plugin engines are listed by the name in their library info. Their library is only opened
+	//when they are selected, and every entry keeps its id even if its library fails to load
 	for (int i = 0; i < AccessClass::getPluginManager()->getNumRecordEngines(); i++)
 	{
 		Plugin::RecordEngineInfo info;
 		info = AccessClass::getPluginManager()->getRecordEngineInfo(i);
 		recordSelector->addItem(info.name, id++);
-		recordEngines.add(info.creator());
+		recordEngines.add(nullptr);
+		recordEnginePlugins.add(i);
 	}
 	if (selectedEngine < 1)
 		recordSelector->setSelectedId(1, sendNotification);
@@ -549,6 +577,54 @@ void ControlPanel::updateRecordEngineList()
 		recordSelector->setSelectedId(selectedEngine, sendNotification);
 }
 
+RecordEngineManager* ControlPanel::getRecordEngine(int index)
+{
+	if (recordEngines[index] == nullptr && isPositiveAndBelow(index, recordEnginePlugins.size()))
+	{
+		PluginManager* pluginManager = AccessClass::getPluginManager();
+		const int plugin = recordEnginePlugins[index];
+
+		if (plugin < 0 || !pluginManager->loadPluginLibrary(Plugin::PLUGIN_TYPE_RECORD_ENGINE, plugin))
+			return nullptr;
+
+		RecordEngineManager* rem = pluginManager->getRecordEngineInfo(plugin).creator();
+		recordEngines.set(index, rem);
+
+		if (recordEnginesState != nullptr)
+		{
+			forEachXmlChildElementWithTagName(*recordEnginesState, xmlEngine, "ENGINE")
+			{
+				if (xmlEngine->getStringAttribute("id") == rem->getID())
+					rem->loadParametersFromXml(xmlEngine);
+			}
+		}
+	}
+	return recordEngines[index];
+}
+
+int ControlPanel::findRecordEngine(const String& id, const String& name)
+{
+	//Engines already created first, then the plugin listed under the saved name, and only
+	//then the other plugin engines, which has to open their libraries
+	for (int i = 0; i < recordEngines.size(); i++)
+	{
+		if (recordEngines[i] != nullptr && recordEngines[i]->getID() == id)
+			return i;
+	}
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = 0; i < recordEngines.size(); i++)
+		{
+			if (recordEngines[i] != nullptr || (pass == 0 && recordSelector->getItemText(i) != name))
+				continue;
+			RecordEngineManager* rem = getRecordEngine(i);
+			if (rem != nullptr && rem->getID() == id)
+				return i;
+		}
+	}
+	return -1;
+}
+
 String ControlPanel::getSelectedRecordEngineId()
 {
 	return recordEngines[recordSelector->getSelectedId() - 1]->getID();
@@ -561,16 +637,12 @@ bool ControlPanel::setSelectedRecordEngineId(String id)
 		return false;
 	}
 
-	int nEngines = recordEngines.size();
-	for (int i = 0; i < nEngines; ++i)
-	{
-		if (recordEngines[i]->getID() == id)
-		{
-			recordSelector->setSelectedId(i + 1, sendNotificationSync);
-			return true;
-		}
-	}
-	return false;
+	int index = findRecordEngine(id, String::empty);
+	if (index < 0)
+		return false;
+
+	recordSelector->setSelectedId(index + 1, sendNotificationSync);
+	return true;
 }
 
 void ControlPanel::createPaths()
@@ -737,7 +809,10 @@ void ControlPanel::resized()
         recordOptionsButton->setBounds ( (w - 435) > 40 ? 140 : w - 350, topBound, h - 10, h - 10);
         recordOptionsButton->setVisible (true);
 
-        filenameComponent->setBounds (165, topBound, w - 500, h - 10);
+        recordQueueLabel->setBounds (165, topBound, 45, h - 10);
+        recordQueueLabel->setVisible (true);
+
+        filenameComponent->setBounds (215, topBound, jmax (0, w - 550), h - 10);
         filenameComponent->setVisible (true);
 
         newDirectoryButton->setBounds (w - h + 4, topBound, h - 10, h - 10);
@@ -762,6 +837,7 @@ void ControlPanel::resized()
         appendText->setVisible          (false);
         recordSelector->setVisible      (false);
         recordOptionsButton->setVisible (false);
+        recordQueueLabel->setVisible    (false);
     }
 
     repaint();
@@ -796,12 +872,19 @@ void ControlPanel::startRecording()
 
     graph->setRecordState(true);
 
+    // keep a trace of callbacks that ran over their budget next to the recorded data
+    RecordNode* recordNode = graph->getRecordNode();
+    graph->getWatchdog()->openTrace(recordNode->getDataDirectory().getChildFile("realtime_overruns.csv"),
+                                    recordNode->getExperimentNumber(),
+                                    recordNode->getRecordingNumber());
+
     repaint();
 }
 
 void ControlPanel::stopRecording()
 {
     graph->setRecordState(false); // turn off recording in processor graph
+    graph->getWatchdog()->closeTrace();
 
     masterClock->stopRecording();
     newDirectoryButton->setEnabledState(true);
@@ -923,25 +1006,24 @@ void ControlPanel::buttonClicked(Button* button)
 
 void ControlPanel::comboBoxChanged(ComboBox* combo)
 {
-    if (lastEngineIndex >= 0)
+    if (recordEngines[lastEngineIndex] != nullptr)
     {
         if (recordEngines[lastEngineIndex]->isWindowOpen())
             recordEngines[lastEngineIndex]->toggleConfigWindow();
     }
     RecordEngine* re;
     AccessClass::getProcessorGraph()->getRecordNode()->clearRecordEngines();
-    if (combo->getSelectedId() > 0)
-    {
-        re = recordEngines[combo->getSelectedId()-1]->instantiateEngine();
-    }
-    else
+    // opens the library of a plugin engine the first time it is selected
+    RecordEngineManager* manager = getRecordEngine(combo->getSelectedId()-1);
+    if (manager == nullptr)
     {
-        std::cout << "Engine ComboBox: Bad ID" << std::endl;
+        std::cout << "Engine ComboBox: Bad ID or record engine library failed to load" << std::endl;
         combo->setSelectedId(1,dontSendNotification);
-        re = recordEngines[0]->instantiateEngine();
+        manager = recordEngines[0];
     }
+    re = manager->instantiateEngine();
     //re->setUIComponent(getUIComponent());
-    re->registerManager(recordEngines[combo->getSelectedId()-1]);
+    re->registerManager(manager);
     AccessClass::getProcessorGraph()->getRecordNode()->registerRecordEngine(re);
 
     graph->getRecordNode()->newDirectoryNeeded = true;
@@ -1011,6 +1093,10 @@ void ControlPanel::refreshMeters()
         cpuMeter->updateCPU(0.0f);
     }
 
+    RealTimeWatchdog* watchdog = graph->getWatchdog();
+    watchdog->readOverruns();
+    cpuMeter->updateOverruns(watchdog->getNumOverruns(), watchdog->getLastOverrunDescription());
+
     cpuMeter->repaint();
 
     masterClock->repaint();
@@ -1018,6 +1104,8 @@ void ControlPanel::refreshMeters()
     diskMeter->updateDiskSpace(graph->getRecordNode()->getFreeSpace());
     diskMeter->repaint();
 
+    refreshRecordQueues();
+
     if (initialize)
     {
         stopTimer();
@@ -1026,6 +1114,25 @@ void ControlPanel::refreshMeters()
     }
 }
 
+void ControlPanel::refreshRecordQueues()
+{
+    const EventQueue& events = graph->getRecordNode()->getEventQueue();
+    const EventQueue& spikes = graph->getRecordNode()->getSpikeQueue();
+
+    // the fuller of the two queues at its peak, since recording started
+    const int64 peak = jmax(events.getHighWaterMark() * int64(100) / events.getSize(),
+                            spikes.getHighWaterMark() * int64(100) / spikes.getSize());
+    const int64 dropped = events.getNumOverflows() + spikes.getNumOverflows();
+
+    recordQueueLabel->setText(String(peak) + "%", dontSendNotification);
+    recordQueueLabel->setColour(Label::textColourId, dropped > 0 ? Colours::red : Colours::black);
+    recordQueueLabel->setTooltip("Record queues, peak use since recording started:\n"
+                                 "Events: " + String(events.getHighWaterMark()) + " of " + String(events.getSize())
+                                 + " bytes, " + String(events.getNumOverflows()) + " dropped\n"
+                                 "Spikes: " + String(spikes.getHighWaterMark()) + " of " + String(spikes.getSize())
+                                 + " bytes, " + String(spikes.getNumOverflows()) + " dropped");
+}
+
 bool ControlPanel::keyPressed(const KeyPress& key)
 {
     std::cout << "Control panel received" << key.getKeyCode() << std::endl;
@@ -1095,22 +1202,40 @@ void ControlPanel::saveStateToXml(XmlElement* xml)
     controlPanelState->setAttribute("prependText",prependText->getText());
     controlPanelState->setAttribute("appendText",appendText->getText());
     controlPanelState->setAttribute("recordEngine",recordEngines[recordSelector->getSelectedId()-1]->getID());
+    controlPanelState->setAttribute("eventQueueEvents", graph->getRecordNode()->getEventQueueNumEvents());
+    controlPanelState->setAttribute("spikeQueueSpikes", graph->getRecordNode()->getSpikeQueueNumSpikes());
 
     audioEditor->saveStateToXml(xml);
 
-    XmlElement* recordEnginesState = xml->createNewChildElement("RECORDENGINES");
+    XmlElement* enginesState = xml->createNewChildElement("RECORDENGINES");
+    StringArray savedEngines;
     for (int i=0; i < recordEngines.size(); i++)
     {
-        XmlElement* reState = recordEnginesState->createNewChildElement("ENGINE");
+        if (recordEngines[i] == nullptr)
+            continue;
+        XmlElement* reState = enginesState->createNewChildElement("ENGINE");
         reState->setAttribute("id",recordEngines[i]->getID());
         reState->setAttribute("name",recordEngines[i]->getName());
         recordEngines[i]->saveParametersToXml(reState);
+        savedEngines.add(recordEngines[i]->getID());
+    }
+    // engines whose library was not opened keep the settings they were loaded with
+    if (recordEnginesState != nullptr)
+    {
+        forEachXmlChildElementWithTagName(*recordEnginesState, xmlEngine, "ENGINE")
+        {
+            if (!savedEngines.contains(xmlEngine->getStringAttribute("id")))
+                enginesState->addChildElement(new XmlElement(*xmlEngine));
+        }
     }
 
 }
 
 void ControlPanel::loadStateFromXml(XmlElement* xml)
 {
+    // kept for plugin engines created later, and for saving the ones never created
+    XmlElement* enginesState = xml->getChildByName("RECORDENGINES");
+    recordEnginesState = enginesState != nullptr ? new XmlElement(*enginesState) : nullptr;
 
     forEachXmlChildElement(*xml, xmlNode)
     {
@@ -1124,13 +1249,23 @@ void ControlPanel::loadStateFromXml(XmlElement* xml)
             appendText->setText(xmlNode->getStringAttribute("appendText", ""), dontSendNotification);
             prependText->setText(xmlNode->getStringAttribute("prependText", ""), dontSendNotification);
 			String selectedEngine = xmlNode->getStringAttribute("recordEngine");
-			for (int i = 0; i < recordEngines.size(); i++)
+			String selectedEngineName;
+			if (enginesState != nullptr)
 			{
-				if (recordEngines[i]->getID() == selectedEngine)
+				forEachXmlChildElementWithTagName(*enginesState, xmlEngine, "ENGINE")
 				{
-					recordSelector->setSelectedId(i + 1, sendNotification);
+					if (xmlEngine->getStringAttribute("id") == selectedEngine)
+						selectedEngineName = xmlEngine->getStringAttribute("name");
 				}
 			}
+			int selectedIndex = findRecordEngine(selectedEngine, selectedEngineName);
+			if (selectedIndex >= 0)
+			{
+				recordSelector->setSelectedId(selectedIndex + 1, sendNotification);
+			}
+
+            graph->getRecordNode()->setEventQueueSize(xmlNode->getIntAttribute("eventQueueEvents", EVENT_BUFFER_NEVENTS),
+                                                      xmlNode->getIntAttribute("spikeQueueSpikes", SPIKE_BUFFER_NSPIKES));
 
             bool isOpen = xmlNode->getBoolAttribute("isOpen");
             openState(isOpen);
@@ -1140,6 +1275,8 @@ void ControlPanel::loadStateFromXml(XmlElement* xml)
         {
             for (int i = 0; i < recordEngines.size(); i++)
             {
+                if (recordEngines[i] == nullptr)
+                    continue;
                 forEachXmlChildElementWithTagName(*xmlNode,xmlEngine,"ENGINE")
                 {
                     if (xmlEngine->getStringAttribute("id") == recordEngines[i]->getID())
@@ -106,6 +106,10 @@ public:
          the ControlPanel. */
     void updateCPU(float usage);
 
+    /** Sets the number of callbacks that exceeded their real-time budget since
+        acquisition started. Any overrun turns the meter's indicator red. */
+    void updateOverruns(int numOverruns, const String& lastOverrun);
+
     /** Draws the CPUMeter. */
     void paint(Graphics& g);
 
@@ -115,6 +119,7 @@ private:
 
     float cpu;
     float lastCpu;
+    int overruns;
 
 };
 
@@ -405,6 +410,9 @@ private:
     /** Updates the values displayed by the CPUMeter and DiskSpaceMeter.*/
     void refreshMeters();
 
+    /** Shows how full the record queues got and how many events and spikes they dropped.*/
+    void refreshRecordQueues();
+
     bool keyPressed(const KeyPress& key);
 
 
@@ -419,8 +427,22 @@ private:
 
     Colour backgroundColour;
 
+    /** Returns the manager of an engine in the record selector, creating it the first time,
+        which opens the library of a plugin engine. Returns nullptr if it failed to load.*/
+    RecordEngineManager* getRecordEngine(int index);
+
+    /** Returns the index in the record selector of the engine with the given ID, or -1. The
+        engine listed under the given name is tried before opening other plugin libraries.*/
+    int findRecordEngine(const String& id, const String& name);
+
+    // null until the engine is first selected for plugin engines
     OwnedArray<RecordEngineManager> recordEngines;
+    // index of each engine in the plugin manager, -1 for built-in engines
+    Array<int> recordEnginePlugins;
+    // settings of the record engines last loaded
+    ScopedPointer<XmlElement> recordEnginesState;
     ScopedPointer<UtilityButton> recordOptionsButton;
+    ScopedPointer<Label> recordQueueLabel;
     int lastEngineIndex;
 
 };
@@ -30,6 +30,7 @@
 #include "../Processors/MessageCenter/MessageCenterEditor.h"
 #include "ProcessorList.h"
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Processors/SourceNode/SourceNode.h"
 
 EditorViewport::EditorViewport()
     : leftmostEditor(0),
@@ -323,10 +324,10 @@ void EditorViewport::makeEditorVisible(GenericEditor* editor, bool highlight, bo
 		return;
 	}
 
-    if (!updateSettings)
-        signalChainManager->updateVisibleEditors(editor, 0, 0, ACTIVATE);
-    else
-        signalChainManager->updateVisibleEditors(editor, 0, 0, UPDATE);
+    // same as an UPDATE, but only the processors after the edited one get new settings
+    signalChainManager->updateVisibleEditors(editor, 0, 0, ACTIVATE);
+    if (updateSettings)
+        signalChainManager->updateProcessorSettings(true, (GenericProcessor*) editor->getProcessor());
 
     refreshEditors();
 
@@ -710,6 +711,15 @@ void EditorViewport::mouseDown(const MouseEvent& e)
 
                 m.addItem(1, "Rename", true);
 
+                // the TTL event format of a source, changed between acquisitions only
+                SourceNode* sourceNode = dynamic_cast<SourceNode*>(editorArray[i]->getProcessor());
+
+                if (sourceNode != nullptr)
+                {
+                    m.addSeparator();
+                    m.addItem(4, "Compact TTL events", canEdit, sourceNode->getCompactTTLEvents());
+                }
+
                 const int result = m.show();
 
                 if (result == 1)
@@ -738,6 +748,11 @@ void EditorViewport::mouseDown(const MouseEvent& e)
                     refreshEditors();
                     return;
                 }
+                else if (result == 4)
+                {
+                    sourceNode->setCompactTTLEvents(!sourceNode->getCompactTTLEvents());
+                    return;
+                }
             }
 
             // make sure uncollapsed editors don't accept clicks outside their title bar
@@ -1390,269 +1405,53 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
     return error;
 }
 
-const String EditorViewport::loadState(File fileToLoad)
+const String EditorViewport::loadState(File fileToLoad, bool interactive)
 {
+    if (isLoadingState())
+        return "A configuration is already being loaded.";
 
-    // FileChooser fc("Choose a file to load...",
-    //                CoreServices::getDefaultUserSaveDirectory(),
-    //                "*.xml",
-    //                true);
-
-    // if (fc.browseForFileToOpen())
-    // {
-    //     currentFile = fc.getResult();
-    // }
-    // else
-    // {
-    //     return "No configuration selected.";
-    // }
-    int maxID = 100;
     currentFile = fileToLoad;
 
-    std::cout << "Loading processor graph." << std::endl;
-
-    Array<GenericProcessor*> splitPoints;
-
-    XmlDocument doc(currentFile);
-    XmlElement* xml = doc.getDocumentElement();
-
-    if (xml == 0 || ! xml->hasTagName("SETTINGS"))
-    {
-        std::cout << "File not found." << std::endl;
-        delete xml;
-        return "Not a valid file.";
-    }
-
-    bool sameVersion = false;
-	bool pluginAPI = false;
-	bool rhythmNodePatch = false;
-    String versionString;
-
-    forEachXmlChildElement(*xml, element)
-    {
-        if (element->hasTagName("INFO"))
-        {
-            forEachXmlChildElement(*element, element2)
-            {
-                if (element2->hasTagName("VERSION"))
-                {
-                    versionString = element2->getAllSubText();
-					StringArray tokens;
-					tokens.addTokens(versionString, ".", String::empty);
-
-					//Patch to correctly load saved chains from before 0.4.4
-					if (tokens[0].getIntValue() == 0 && tokens[1].getIntValue() == 4 && tokens[2].getIntValue() < 4)
-						rhythmNodePatch = true;
-
-                    if (versionString.equalsIgnoreCase(JUCEApplication::getInstance()->getApplicationVersion()))
-                        sameVersion = true;
-                }
-				else if (element2->hasTagName("PLUGIN_API_VERSION"))
-				{
-					//API version should be the same between the same binary release and, in any case, do not necessarily
-					//change processor configurations. We simply check if the save file has been written from a plugin
-					//capable build, as the save format itself is different.
-					pluginAPI = true;
-				}
-            }
-            break;
-        }
-    }
-    if (!sameVersion)
-    {
-        String responseString = "Your configuration file was saved from a different version of the GUI than the one you're using. \n";
-        responseString += "The current software is version ";
-        responseString += JUCEApplication::getInstance()->getApplicationVersion();
-        responseString += ", but the file you selected ";
-        if (versionString.length() > 0)
-        {
-            responseString += " is version ";
-            responseString += versionString;
-        }
-        else
-        {
-            responseString += "does not have a version number";
-        }
-
-        responseString += ".\n This file may not load properly. Continue?";
-
-        bool response = AlertWindow::showOkCancelBox(AlertWindow::NoIcon,
-                                                     "Version mismatch", responseString,
-                                                     "Yes", "No", 0, 0);
-        if (!response)
-            return "Failed To Open " + fileToLoad.getFileName();
-
-    }
-	if (!pluginAPI)
-	{
-		String responseString = "Your configuration file was saved from a non-plugin version of the GUI.\n";
-		responseString += "Save files from non-plugin versions are incompatible with the current load system.\n";
-		responseString += "The chain file will not load.";
-		AlertWindow::showMessageBox(AlertWindow::WarningIcon, "Non-plugin save file", responseString);
-		return "Failed To Open " + fileToLoad.getFileName();
-	}
-    clearSignalChain();
-
-    String description;// = " ";
-    int loadOrder = 0;
-
-    GenericProcessor* p;
-
-    forEachXmlChildElement(*xml, element)
-    {
-
-        if (element->hasTagName("SIGNALCHAIN"))
-        {
-
-            forEachXmlChildElement(*element, processor)
-            {
-
-                if (processor->hasTagName("PROCESSOR"))
-                {
-
-                    int insertionPt = processor->getIntAttribute("insertionPoint");
-                    currentId = processor->getIntAttribute("NodeId");
-
-                    maxID= (maxID > currentId) ? maxID  : currentId ;
-
-                    if (insertionPt == 1)
-                    {
-                        insertionPoint = editorArray.size();
-                    }
-                    else
-                    {
-                        insertionPoint = 0;
-                    }
-
-                    //See ProcessorGraph::createProcessorFromDescription for description info
-					Array<var> procDesc;
-					procDesc.add(false);
-					procDesc.add(processor->getStringAttribute("pluginName"));
-					procDesc.add(processor->getIntAttribute("pluginType"));
-					procDesc.add(processor->getIntAttribute("pluginIndex"));
-					procDesc.add(processor->getStringAttribute("libraryName"));
-					procDesc.add(processor->getIntAttribute("libraryVersion"));
-					procDesc.add(processor->getBoolAttribute("isSource"));
-					procDesc.add(processor->getBoolAttribute("isSink"));
-
-					if (rhythmNodePatch) //old version, when rhythm was a plugin
-					{
-						if (int(procDesc[2]) == -1) //if builtin
-						{
-							if (int(procDesc[3]) == 0) //Rhythm node
-							{
-								procDesc.set(2, 4); //DataThread
-								procDesc.set(3, 1); //index
-								procDesc.set(4, "Rhythm FPGA"); //libraryName
-							}
-							else
-								procDesc.set(3, int(procDesc[3]) - 1); //arrange old nodes to its current index
-						}
-					}
-
-                    SourceDetails sd = SourceDetails(procDesc,
-                                                     0,
-                                                     Point<int>(0,0));
-
-                    itemDropped(sd);
-
-                    p = (GenericProcessor*) lastEditor->getProcessor();
-                    p->loadOrder = loadOrder;
-                    p->parametersAsXml = processor;
-
-                    //Sets parameters based on XML files
-                    setParametersByXML(p, processor);
-                    loadOrder++;
-
-                    if (p->isSplitter() || p->isMerger())
-                    {
-                        splitPoints.add(p);
-                    }
-
-                    signalChainManager->updateVisibleEditors(editorArray[0], 0, 0, UPDATE);
-
-                }
-                else if (processor->hasTagName("SWITCH"))
-                {
-                    int processorNum = processor->getIntAttribute("number");
-
-                    std::cout << "SWITCHING number " << processorNum << std::endl;
-
-                    for (int n = 0; n < splitPoints.size(); n++)
-                    {
-
-                        std::cout << "Trying split point " << n
-                                  << ", load order: " << splitPoints[n]->loadOrder << std::endl;
-
-                        if (splitPoints[n]->loadOrder == processorNum)
-                        {
-
-                            if (splitPoints[n]->isMerger())
-                            {
-                                std::cout << "Switching merger source." << std::endl;
-                                MergerEditor* editor = (MergerEditor*) splitPoints[n]->getEditor();
-                                editor->switchSource(1);
-                            }
-                            else
-                            {
-                                std::cout << "Switching splitter destination." << std::endl;
-                                SplitterEditor* editor = (SplitterEditor*) splitPoints[n]->getEditor();
-                                editor->switchDest(1);
-                            }
-
-                            splitPoints.remove(n);
-                        }
-                    }
-
-                    signalChainManager->updateVisibleEditors(editorArray[0], 0, 0, UPDATE);
-
-                }
+    releaseChainLoader();
+    chainLoader = new SignalChainLoader(this, fileToLoad, interactive);
+    return chainLoader->loadNow();
+}
 
-            }
+bool EditorViewport::loadStateAsync(File fileToLoad, SignalChainLoader::Listener* listener, bool interactive)
+{
+    if (isLoadingState())
+        return false;
 
-        }
-        else if (element->hasTagName("AUDIO"))
-        {
-            int bufferSize = element->getIntAttribute("bufferSize");
-            AccessClass::getAudioComponent()->setBufferSize(bufferSize);
-        }
-		else if (element->hasTagName("GLOBAL_TIMESTAMP"))
-		{
-			int tsID = element->getIntAttribute("selected_index", -1);
-			int tsSubID = element->getIntAttribute("selected_sub_index");
-			AccessClass::getProcessorGraph()->setTimestampSource(tsID, tsSubID);
-		}
+    currentFile = fileToLoad;
 
-    }
+    releaseChainLoader();
+    chainLoader = new SignalChainLoader(this, fileToLoad, interactive);
+    chainLoader->start(listener);
+    return true;
+}
 
-    for (int i = 0; i < editorArray.size(); i++)
+// The previous loader may be calling its listener, which is what started this load, so it is
+// deleted once that call has returned
+void EditorViewport::releaseChainLoader()
+{
+    if (chainLoader != nullptr)
     {
-        // deselect everything initially
-        editorArray[i]->deselect();
+        SignalChainLoader* previousLoader = chainLoader.release();
+        MessageManager::callAsync([previousLoader] { delete previousLoader; });
     }
+}
 
-    AccessClass::getProcessorGraph()->restoreParameters();
-
-    AccessClass::getControlPanel()->loadStateFromXml(xml); // save the control panel settings
-    AccessClass::getProcessorList()->loadStateFromXml(xml);
-    AccessClass::getUIComponent()->loadStateFromXml(xml);  // save the UI settings
-
-    if (editorArray.size() > 0)
-        signalChainManager->updateVisibleEditors(editorArray[0], 0, 0, UPDATE);
-
-    refreshEditors();
-
-    AccessClass::getProcessorGraph()->restoreParameters();
-
-    String error = "Opened ";
-    error += currentFile.getFileName();
-
-    delete xml;
-
-    currentId=maxID+1; // make sure future processors don't have overlapping id numbers
+bool EditorViewport::isLoadingState() const
+{
+    return chainLoader != nullptr && chainLoader->isLoading();
+}
 
-    return error;
+void EditorViewport::cancelLoadingState()
+{
+    if (chainLoader != nullptr)
+        chainLoader->cancel();
 }
+
 /* Set parameters based on XML.*/
 void EditorViewport::setParametersByXML(GenericProcessor* targetProcessor, XmlElement* processorXML)
 {
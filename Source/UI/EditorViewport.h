@@ -33,6 +33,7 @@
 #include "ControlPanel.h"
 #include "UIComponent.h"
 #include "DataViewport.h"
+#include "SignalChainLoader.h"
 
 class GenericEditor;
 class SignalChainTabButton;
@@ -152,8 +153,22 @@ public:
 	/** Save the current configuration as an XML file. Reference wrapper*/
 	const String saveState(File filename, String& xmlText);
 
-    /** Load a saved configuration from an XML file. */
-    const String loadState(File filename);
+    /** Load a saved configuration from an XML file. When not interactive, version
+        mismatches are only reported on the console instead of asking the user. */
+    const String loadState(File filename, bool interactive = true);
+
+    /** Loads a saved configuration without blocking the message thread, showing the
+        progress when interactive. The listener is told the result when done. Returns
+        false if a configuration is already being loaded.
+
+        @see SignalChainLoader */
+    bool loadStateAsync(File filename, SignalChainLoader::Listener* listener = nullptr, bool interactive = true);
+
+    /** Returns true while a configuration is being loaded asynchronously */
+    bool isLoadingState() const;
+
+    /** Stops loading a configuration, leaving the signal chain empty */
+    void cancelLoadingState();
 
     /** Converts information about a given editor to XML. */
     XmlElement* createNodeXml(GenericEditor*, int);
@@ -220,6 +235,10 @@ private:
 
     Label editorNamingLabel;
 
+    ScopedPointer<SignalChainLoader> chainLoader;
+    void releaseChainLoader();
+    friend class SignalChainLoader;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorViewport);
 
 };
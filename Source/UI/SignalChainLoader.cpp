@@ -0,0 +1,559 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SignalChainLoader.h"
+#include "EditorViewport.h"
+#include "SignalChainManager.h"
+#include "ProcessorList.h"
+#include "../AccessClass.h"
+#include "../Audio/AudioComponent.h"
+#include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Processors/PluginManager/PluginManager.h"
+
+//Same matching as ProcessorManager::createProcessorFromPluginInfo
+static int findPlugin(PluginManager* pm, Plugin::PluginType type, const String& name, const String& libName, int libVersion)
+{
+	const int numPlugins = type == Plugin::PLUGIN_TYPE_PROCESSOR ? pm->getNumProcessors() : pm->getNumDataThreads();
+
+	for (int i = 0; i < numPlugins; i++)
+	{
+		const String pluginName = type == Plugin::PLUGIN_TYPE_PROCESSOR ? pm->getProcessorInfo(i).name : pm->getDataThreadInfo(i).name;
+		if (!name.equalsIgnoreCase(pluginName))
+			continue;
+
+		const int libIndex = pm->getLibraryIndexFromPlugin(type, i);
+		if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex))
+			return i;
+	}
+	return -1;
+}
+
+SignalChainLoader::SignalChainLoader(EditorViewport* viewport, const File& file, bool interactive)
+	: Thread("Signal chain loader"),
+	m_viewport(viewport),
+	m_file(file),
+	m_interactive(interactive),
+	m_listener(nullptr),
+	m_sameVersion(false),
+	m_pluginAPI(false),
+	m_rhythmNodePatch(false),
+	m_nextStep(0),
+	m_building(false),
+	m_loadOrder(0),
+	m_maxId(100),
+	m_loading(false),
+	m_success(false),
+	m_progress(0),
+	m_startTicks(0),
+	m_prepareTicks(0),
+	m_buildTicks(0)
+{
+}
+
+SignalChainLoader::~SignalChainLoader()
+{
+	cancel();
+	stopThread(5000);
+	cancelPendingUpdate();
+	stopTimer();
+	masterReference.clear();
+}
+
+void SignalChainLoader::start(Listener* listener)
+{
+	m_listener = listener;
+	m_loading = true;
+	m_startTicks = Time::getHighResolutionTicks();
+
+	if (m_interactive)
+	{
+		m_progressWindow = new AlertWindow("Loading signal chain", m_file.getFileName(), AlertWindow::NoIcon);
+		m_progressWindow->addProgressBarComponent(m_progress);
+		m_progressWindow->addButton("Cancel", 1, KeyPress(KeyPress::escapeKey));
+		m_progressWindow->enterModalState(true,
+			ModalCallbackFunction::create(progressWindowClosed, WeakReference<SignalChainLoader>(this)));
+		startTimer(100);
+	}
+
+	startThread();
+}
+
+String SignalChainLoader::loadNow()
+{
+	m_loading = true;
+	m_startTicks = Time::getHighResolutionTicks();
+
+	prepare();
+	while (buildNextStep()) {}
+
+	return m_result;
+}
+
+void SignalChainLoader::cancel()
+{
+	m_cancelled.set(1);
+}
+
+bool SignalChainLoader::isLoading() const
+{
+	return m_loading;
+}
+
+bool SignalChainLoader::wasSuccessful() const
+{
+	return m_success;
+}
+
+String SignalChainLoader::getResult() const
+{
+	return m_result;
+}
+
+double SignalChainLoader::getProgress() const
+{
+	return m_progress;
+}
+
+String SignalChainLoader::getStatus() const
+{
+	const ScopedLock sl(m_statusLock);
+	return m_status;
+}
+
+double SignalChainLoader::getPrepareSeconds() const
+{
+	return Time::highResolutionTicksToSeconds(m_prepareTicks);
+}
+
+double SignalChainLoader::getBuildSeconds() const
+{
+	return Time::highResolutionTicksToSeconds(m_buildTicks);
+}
+
+void SignalChainLoader::run()
+{
+	prepare();
+
+	if (!threadShouldExit())
+		triggerAsyncUpdate();
+}
+
+void SignalChainLoader::handleAsyncUpdate()
+{
+	if (buildNextStep())
+		triggerAsyncUpdate();
+}
+
+void SignalChainLoader::timerCallback()
+{
+	if (m_progressWindow != nullptr)
+		m_progressWindow->setMessage(getStatus());
+}
+
+void SignalChainLoader::progressWindowClosed(int result, WeakReference<SignalChainLoader> loader)
+{
+	if (result == 1 && loader != nullptr)
+		loader->cancel();
+}
+
+void SignalChainLoader::prepare()
+{
+	setStatus("Reading " + m_file.getFileName());
+
+	if (readFile())
+		loadPluginLibraries();
+
+	m_prepareTicks = Time::getHighResolutionTicks() - m_startTicks;
+	m_progress = 0.5;
+}
+
+bool SignalChainLoader::readFile()
+{
+	std::cout << "Loading processor graph." << std::endl;
+
+	XmlDocument doc(m_file);
+	m_xml = doc.getDocumentElement();
+
+	if (m_xml == nullptr || !m_xml->hasTagName("SETTINGS"))
+	{
+		std::cout << "File not found." << std::endl;
+		m_xml = nullptr;
+		m_error = "Not a valid file.";
+		return false;
+	}
+
+	forEachXmlChildElementWithTagName(*m_xml, info, "INFO")
+	{
+		forEachXmlChildElement(*info, element)
+		{
+			if (element->hasTagName("VERSION"))
+			{
+				m_versionString = element->getAllSubText();
+				StringArray tokens;
+				tokens.addTokens(m_versionString, ".", String::empty);
+
+				//Patch to correctly load saved chains from before 0.4.4
+				if (tokens[0].getIntValue() == 0 && tokens[1].getIntValue() == 4 && tokens[2].getIntValue() < 4)
+					m_rhythmNodePatch = true;
+
+				if (m_versionString.equalsIgnoreCase(JUCEApplication::getInstance()->getApplicationVersion()))
+					m_sameVersion = true;
+			}
+			else if (element->hasTagName("PLUGIN_API_VERSION"))
+			{
+				//API version should be the same between the same binary release and, in any case, do not necessarily
+				//change processor configurations. We simply check if the save file has been written from a plugin
+				//capable build, as the save format itself is different.
+				m_pluginAPI = true;
+			}
+		}
+		break;
+	}
+
+	forEachXmlChildElementWithTagName(*m_xml, signalChain, "SIGNALCHAIN")
+	{
+		forEachXmlChildElement(*signalChain, element)
+		{
+			Step step;
+			step.element = element;
+
+			if (element->hasTagName("PROCESSOR"))
+			{
+				Array<var> procDesc;
+				procDesc.add(false);
+				procDesc.add(element->getStringAttribute("pluginName"));
+				procDesc.add(element->getIntAttribute("pluginType"));
+				procDesc.add(element->getIntAttribute("pluginIndex"));
+				procDesc.add(element->getStringAttribute("libraryName"));
+				procDesc.add(element->getIntAttribute("libraryVersion"));
+				procDesc.add(element->getBoolAttribute("isSource"));
+				procDesc.add(element->getBoolAttribute("isSink"));
+
+				if (m_rhythmNodePatch) //old version, when rhythm was a plugin
+				{
+					if (int(procDesc[2]) == -1) //if builtin
+					{
+						if (int(procDesc[3]) == 0) //Rhythm node
+						{
+							procDesc.set(2, 4); //DataThread
+							procDesc.set(3, 1); //index
+							procDesc.set(4, "Rhythm FPGA"); //libraryName
+						}
+						else
+							procDesc.set(3, int(procDesc[3]) - 1); //arrange old nodes to its current index
+					}
+				}
+				step.description = procDesc;
+				m_steps.add(step);
+			}
+			else if (element->hasTagName("SWITCH"))
+			{
+				m_steps.add(step);
+			}
+		}
+	}
+
+	m_progress = 0.1;
+	return true;
+}
+
+void SignalChainLoader::loadPluginLibraries()
+{
+	PluginManager* pm = AccessClass::getPluginManager();
+
+	for (int i = 0; i < m_steps.size() && !shouldStop(); i++)
+	{
+		const Array<var>* description = m_steps.getReference(i).description.getArray();
+
+		if (description != nullptr && int((*description)[3]) > -1)
+		{
+			const Plugin::PluginType type = static_cast<Plugin::PluginType>(int((*description)[2]));
+
+			if (type == Plugin::PLUGIN_TYPE_PROCESSOR || type == Plugin::PLUGIN_TYPE_DATA_THREAD)
+			{
+				const String libName = (*description)[4];
+				const int index = findPlugin(pm, type, (*description)[1], libName, (*description)[5]);
+
+				//Processors whose plugin is missing become placeholders later on
+				if (index > -1)
+				{
+					setStatus("Loading " + libName);
+					pm->loadPluginLibrary(type, index);
+				}
+			}
+		}
+
+		m_progress = 0.1 + 0.4 * (i + 1) / m_steps.size();
+	}
+}
+
+bool SignalChainLoader::buildNextStep()
+{
+	if (!m_building)
+	{
+		if (m_error.isNotEmpty())
+		{
+			finish(m_error, false);
+			return false;
+		}
+		if (shouldStop())
+		{
+			finish("Loading cancelled", false);
+			return false;
+		}
+		if (!beginBuilding())
+			return false;
+
+		m_building = true;
+		return true;
+	}
+
+	if (shouldStop())
+	{
+		m_viewport->clearSignalChain();
+		finish("Loading cancelled", false);
+		return false;
+	}
+
+	if (m_nextStep < m_steps.size())
+	{
+		const Step& step = m_steps.getReference(m_nextStep++);
+
+		if (step.element->hasTagName("PROCESSOR"))
+			buildProcessor(step);
+		else
+			switchPath(step);
+
+		m_progress = 0.5 + 0.5 * m_nextStep / (m_steps.size() + 1);
+		return true;
+	}
+
+	finishBuilding();
+	return false;
+}
+
+bool SignalChainLoader::beginBuilding()
+{
+	if (!m_sameVersion)
+	{
+		String responseString = "Your configuration file was saved from a different version of the GUI than the one you're using. \n";
+		responseString += "The current software is version ";
+		responseString += JUCEApplication::getInstance()->getApplicationVersion();
+		responseString += ", but the file you selected ";
+		if (m_versionString.length() > 0)
+		{
+			responseString += " is version ";
+			responseString += m_versionString;
+		}
+		else
+		{
+			responseString += "does not have a version number";
+		}
+
+		responseString += ".\n This file may not load properly. Continue?";
+
+		if (m_interactive)
+		{
+			bool response = AlertWindow::showOkCancelBox(AlertWindow::NoIcon,
+				"Version mismatch", responseString,
+				"Yes", "No", 0, 0);
+			if (!response)
+			{
+				finish("Failed To Open " + m_file.getFileName(), false);
+				return false;
+			}
+		}
+		else
+		{
+			std::cout << "Version mismatch: " << m_versionString << " / " << JUCEApplication::getInstance()->getApplicationVersion() << std::endl;
+		}
+	}
+	if (!m_pluginAPI)
+	{
+		String responseString = "Your configuration file was saved from a non-plugin version of the GUI.\n";
+		responseString += "Save files from non-plugin versions are incompatible with the current load system.\n";
+		responseString += "The chain file will not load.";
+		if (m_interactive)
+			AlertWindow::showMessageBox(AlertWindow::WarningIcon, "Non-plugin save file", responseString);
+		else
+			std::cout << responseString << std::endl;
+		finish("Failed To Open " + m_file.getFileName(), false);
+		return false;
+	}
+
+	m_viewport->clearSignalChain();
+	return true;
+}
+
+void SignalChainLoader::buildProcessor(const Step& step)
+{
+	EditorViewport* ev = m_viewport;
+	XmlElement* processor = step.element;
+
+	int insertionPt = processor->getIntAttribute("insertionPoint");
+	ev->currentId = processor->getIntAttribute("NodeId");
+
+	m_maxId = jmax(m_maxId, ev->currentId);
+
+	if (insertionPt == 1)
+		ev->insertionPoint = ev->editorArray.size();
+	else
+		ev->insertionPoint = 0;
+
+	setStatus("Creating " + step.description[1].toString());
+
+	ev->lastEditor = nullptr;
+	ev->itemDropped(DragAndDropTarget::SourceDetails(step.description, nullptr, Point<int>(0, 0)));
+
+	if (ev->lastEditor == nullptr)
+	{
+		std::cout << "Could not create " << step.description[1].toString() << std::endl;
+		m_loadOrder++;
+		return;
+	}
+
+	GenericProcessor* p = (GenericProcessor*) ev->lastEditor->getProcessor();
+	p->loadOrder = m_loadOrder;
+	p->parametersAsXml = processor;
+
+	//Sets parameters based on XML files
+	ev->setParametersByXML(p, processor);
+	m_loadOrder++;
+
+	if (p->isSplitter() || p->isMerger())
+		m_splitPoints.add(p);
+
+	ev->signalChainManager->updateVisibleEditors(ev->editorArray[0], 0, 0, EditorViewport::UPDATE);
+}
+
+void SignalChainLoader::switchPath(const Step& step)
+{
+	int processorNum = step.element->getIntAttribute("number");
+
+	std::cout << "SWITCHING number " << processorNum << std::endl;
+
+	for (int n = 0; n < m_splitPoints.size(); n++)
+	{
+		std::cout << "Trying split point " << n
+			<< ", load order: " << m_splitPoints[n]->loadOrder << std::endl;
+
+		if (m_splitPoints[n]->loadOrder == processorNum)
+		{
+			if (m_splitPoints[n]->isMerger())
+			{
+				std::cout << "Switching merger source." << std::endl;
+				MergerEditor* editor = (MergerEditor*) m_splitPoints[n]->getEditor();
+				editor->switchSource(1);
+			}
+			else
+			{
+				std::cout << "Switching splitter destination." << std::endl;
+				SplitterEditor* editor = (SplitterEditor*) m_splitPoints[n]->getEditor();
+				editor->switchDest(1);
+			}
+
+			m_splitPoints.remove(n);
+		}
+	}
+
+	if (m_viewport->editorArray.size() > 0)
+		m_viewport->signalChainManager->updateVisibleEditors(m_viewport->editorArray[0], 0, 0, EditorViewport::UPDATE);
+}
+
+void SignalChainLoader::finishBuilding()
+{
+	EditorViewport* ev = m_viewport;
+	XmlElement* xml = m_xml;
+
+	setStatus("Restoring settings");
+
+	forEachXmlChildElement(*xml, element)
+	{
+		if (element->hasTagName("AUDIO"))
+		{
+			int bufferSize = element->getIntAttribute("bufferSize");
+			AccessClass::getAudioComponent()->setBufferSize(bufferSize);
+		}
+		else if (element->hasTagName("GLOBAL_TIMESTAMP"))
+		{
+			int tsID = element->getIntAttribute("selected_index", -1);
+			int tsSubID = element->getIntAttribute("selected_sub_index");
+			AccessClass::getProcessorGraph()->setTimestampSource(tsID, tsSubID);
+		}
+	}
+
+	for (int i = 0; i < ev->editorArray.size(); i++)
+	{
+		// deselect everything initially
+		ev->editorArray[i]->deselect();
+	}
+
+	AccessClass::getProcessorGraph()->restoreParameters();
+
+	AccessClass::getControlPanel()->loadStateFromXml(xml); // save the control panel settings
+	AccessClass::getProcessorList()->loadStateFromXml(xml);
+	AccessClass::getUIComponent()->loadStateFromXml(xml);  // save the UI settings
+
+	//the restored settings can change any processor, so this time every one is updated
+	if (ev->editorArray.size() > 0)
+	{
+		ev->signalChainManager->updateVisibleEditors(ev->editorArray[0], 0, 0, EditorViewport::ACTIVATE);
+		ev->signalChainManager->updateProcessorSettings();
+	}
+
+	ev->refreshEditors();
+
+	AccessClass::getProcessorGraph()->restoreParameters();
+
+	ev->currentId = m_maxId + 1; // make sure future processors don't have overlapping id numbers
+
+	finish("Opened " + m_file.getFileName(), true);
+}
+
+void SignalChainLoader::finish(const String& result, bool success)
+{
+	m_buildTicks = Time::getHighResolutionTicks() - m_startTicks - m_prepareTicks;
+	m_result = result;
+	m_success = success;
+	m_loading = false;
+	m_progress = 1.0;
+
+	stopTimer();
+	m_progressWindow = nullptr;
+
+	std::cout << result << " (read in " << getPrepareSeconds() << " s, built in " << getBuildSeconds() << " s)" << std::endl;
+
+	if (m_listener != nullptr)
+		m_listener->signalChainLoaded(this, result);
+}
+
+bool SignalChainLoader::shouldStop() const
+{
+	return m_cancelled.get() != 0 || threadShouldExit();
+}
+
+void SignalChainLoader::setStatus(const String& status)
+{
+	const ScopedLock sl(m_statusLock);
+	m_status = status;
+}
@@ -0,0 +1,159 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SIGNALCHAINLOADER_H_INCLUDED
+#define SIGNALCHAINLOADER_H_INCLUDED
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+class EditorViewport;
+class GenericProcessor;
+
+/**
+	Loads a saved signal chain without freezing the message thread.
+
+	Loading happens in two phases. A background thread reads and checks the XML
+	and opens the libraries of the plugins the chain uses, which are only listed
+	from the plugin cache until then. The processors and their editors are then
+	created on the message thread, one per message callback, so the window keeps
+	repainting and the load can be cancelled between processors. A cancelled load
+	leaves an empty signal chain.
+
+	While loading interactively a progress window with a cancel button is shown.
+	loadNow() runs both phases at once on the message thread instead.
+
+	@see EditorViewport::loadStateAsync
+*/
+class SignalChainLoader : private Thread,
+	private AsyncUpdater,
+	private Timer
+{
+public:
+	class Listener
+	{
+	public:
+		virtual ~Listener() {}
+
+		/** Called on the message thread once the chain is loaded, cancelled or failed to load */
+		virtual void signalChainLoaded(SignalChainLoader* loader, const String& result) = 0;
+	};
+
+	/** When not interactive, no progress window is shown and version mismatches are only
+	reported on the console instead of asking the user */
+	SignalChainLoader(EditorViewport* viewport, const File& file, bool interactive);
+	~SignalChainLoader();
+
+	/** Starts loading in the background. The listener is called when done */
+	void start(Listener* listener);
+
+	/** Loads the whole chain before returning. Must be called from the message thread */
+	String loadNow();
+
+	/** Stops loading at the next processor */
+	void cancel();
+
+	bool isLoading() const;
+	bool wasSuccessful() const;
+	String getResult() const;
+
+	/** From 0 to 1 */
+	double getProgress() const;
+	String getStatus() const;
+
+	/** Time spent reading the file and opening plugin libraries */
+	double getPrepareSeconds() const;
+	/** Time spent creating the processors and restoring their settings */
+	double getBuildSeconds() const;
+
+private:
+	struct Step
+	{
+		XmlElement* element;
+		// see ProcessorGraph::createProcessorFromDescription
+		var description;
+	};
+
+	void run() override;
+	void handleAsyncUpdate() override;
+	void timerCallback() override;
+
+	/** Modal callback of the progress window. Only its cancel button cancels the load: the
+	window also closes when it is deleted, and other prompts can be shown on top of it */
+	static void progressWindowClosed(int result, WeakReference<SignalChainLoader> loader);
+
+	/** Reads the file and opens the plugin libraries. Runs on the background thread */
+	void prepare();
+	bool readFile();
+	void loadPluginLibraries();
+
+	/** Does the next bit of message thread work. Returns false when there is nothing left */
+	bool buildNextStep();
+	bool beginBuilding();
+	void buildProcessor(const Step& step);
+	void switchPath(const Step& step);
+	void finishBuilding();
+
+	void finish(const String& result, bool success);
+	bool shouldStop() const;
+	void setStatus(const String& status);
+
+	EditorViewport* m_viewport;
+	File m_file;
+	bool m_interactive;
+	Listener* m_listener;
+
+	ScopedPointer<XmlElement> m_xml;
+	String m_error;
+	String m_versionString;
+	bool m_sameVersion;
+	bool m_pluginAPI;
+	bool m_rhythmNodePatch;
+
+	Array<Step> m_steps;
+	int m_nextStep;
+	bool m_building;
+	Array<GenericProcessor*> m_splitPoints;
+	int m_loadOrder;
+	int m_maxId;
+
+	bool m_loading;
+	bool m_success;
+	Atomic<int> m_cancelled;
+	String m_result;
+	double m_progress;
+	String m_status;
+	CriticalSection m_statusLock;
+
+	int64 m_startTicks;
+	int64 m_prepareTicks;
+	int64 m_buildTicks;
+
+	ScopedPointer<AlertWindow> m_progressWindow;
+
+	WeakReference<SignalChainLoader>::Master masterReference;
+	friend class WeakReference<SignalChainLoader>;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SignalChainLoader);
+};
+
+#endif  // SIGNALCHAINLOADER_H_INCLUDED
@@ -507,11 +507,11 @@ void SignalChainManager::updateVisibleEditors(GenericEditor* activeEditor,
         }
     }
 
-    // Step 7: update all settings
+    // Step 7: update the settings the change made stale
     if (action != ACTIVATE)
     {
 
-		updateProcessorSettings();
+		updateProcessorSettings(true);
     }
 
 
@@ -519,7 +519,7 @@ void SignalChainManager::updateVisibleEditors(GenericEditor* activeEditor,
 
 }
 
-void SignalChainManager::updateProcessorSettings()
+void SignalChainManager::updateProcessorSettings(bool onlyStale, GenericProcessor* editedProcessor)
 {
 	// std::cout << "Updating settings." << std::endl;
 
@@ -539,7 +539,8 @@ void SignalChainManager::updateProcessorSettings()
 		while (p != 0)
 		{
 			// iterate through processors
-			p->update();
+			if (!onlyStale || p == editedProcessor || p->needsSettingsUpdate())
+				p->update();
 
 			if (p->isSplitter())
 			{
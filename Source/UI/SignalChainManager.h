@@ -69,7 +69,11 @@ public:
     /** Clears the signal chain.*/
     void clearSignalChain();
 
-	void updateProcessorSettings();
+	/** Updates the settings of the processors in every signal chain. If onlyStale is set, only the
+	edited processor, if any, and the ones whose source settings became stale are updated, i.e. the
+	ones downstream of the edit, of an added or moved processor or of a connection change.
+	Otherwise all of them are.*/
+	void updateProcessorSettings(bool onlyStale = false, GenericProcessor* editedProcessor = nullptr);
 
 private:
 
@@ -543,6 +543,11 @@ void UIComponent::getCommandInfo(CommandID commandID, ApplicationCommandInfo& re
 
 }
 
+void UIComponent::signalChainLoaded(SignalChainLoader* loader, const String& result)
+{
+	sendActionMessage(result);
+}
+
 bool UIComponent::perform(const InvocationInfo& info)
 {
 
@@ -558,7 +563,8 @@ bool UIComponent::perform(const InvocationInfo& info)
 				if (fc.browseForFileToOpen())
 				{
 					currentConfigFile = fc.getResult();
-					sendActionMessage(getEditorViewport()->loadState(currentConfigFile));
+					if (!getEditorViewport()->loadStateAsync(currentConfigFile, this))
+						sendActionMessage("A configuration is already being loaded.");
 				}
 				else
 				{
@@ -26,6 +26,7 @@
 
 #include "../../JuceLibraryCode/JuceHeader.h"
 #include "TimestampSourceSelection.h"
+#include "SignalChainLoader.h"
 
 
 class MainWindow;
@@ -58,9 +59,10 @@ class UIComponent : public Component,
     public ActionBroadcaster,
     public MenuBarModel,
     public ApplicationCommandTarget,
-    public DragAndDropContainer // required for
+    public DragAndDropContainer, // required for
 // drag-and-drop
 // internal components
+    public SignalChainLoader::Listener
 
 
 {
@@ -138,6 +140,9 @@ public:
     StringArray getRecentlyUsedFilenames();
 
     void setRecentlyUsedFilenames(const StringArray& filenames);
+
+    /** Reports the result of loading a configuration from the menu. */
+    void signalChainLoaded(SignalChainLoader* loader, const String& result) override;
 	
 private:
 
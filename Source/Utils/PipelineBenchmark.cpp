@@ -0,0 +1,263 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PipelineBenchmark.h"
+#include "../AccessClass.h"
+#include "../CoreServices.h"
+#include "../Audio/AudioComponent.h"
+#include "../UI/EditorViewport.h"
+#include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Processors/GenericProcessor/GenericProcessor.h"
+#include "../Processors/RecordNode/RecordNode.h"
+#include "../Processors/AudioNode/AudioNode.h"
+
+PipelineBenchmark::Settings::Settings()
+	: seconds(10.0),
+	realTime(true)
+{
+}
+
+bool PipelineBenchmark::isRequested(const StringArray& arguments)
+{
+	return arguments.contains("--benchmark", true);
+}
+
+bool PipelineBenchmark::parseCommandLine(const StringArray& arguments, Settings& settings, String& error)
+{
+	for (int i = 0; i < arguments.size(); i++)
+	{
+		const String arg = arguments[i].unquoted();
+		const bool hasValue = i + 1 < arguments.size();
+
+		if (arg.equalsIgnoreCase("--benchmark") && hasValue)
+			settings.chainFile = File::getCurrentWorkingDirectory().getChildFile(arguments[++i].unquoted());
+		else if (arg.equalsIgnoreCase("--output") && hasValue)
+			settings.reportFile = File::getCurrentWorkingDirectory().getChildFile(arguments[++i].unquoted());
+		else if (arg.equalsIgnoreCase("--seconds") && hasValue)
+			settings.seconds = arguments[++i].unquoted().getDoubleValue();
+		else if (arg.equalsIgnoreCase("--unthrottled"))
+			settings.realTime = false;
+	}
+
+	if (!settings.chainFile.existsAsFile())
+	{
+		error = "Signal chain file not found: " + settings.chainFile.getFullPathName();
+		return false;
+	}
+	if (settings.seconds <= 0)
+	{
+		error = "The benchmark duration must be positive";
+		return false;
+	}
+	if (settings.reportFile == File::nonexistent)
+		settings.reportFile = settings.chainFile.getSiblingFile(settings.chainFile.getFileNameWithoutExtension() + "_benchmark.json");
+
+	return true;
+}
+
+String PipelineBenchmark::getUsage()
+{
+	return "Usage: open-ephys --benchmark <chain.xml> [--seconds <duration>] [--output <report.json>] [--unthrottled]";
+}
+
+PipelineBenchmark::PipelineBenchmark(const Settings& settings)
+	: m_settings(settings),
+	m_startTicks(0),
+	m_cpuUsageSum(0),
+	m_numCpuUsageReadings(0),
+	m_loadReadSeconds(0),
+	m_loadBuildSeconds(0)
+{
+}
+
+PipelineBenchmark::~PipelineBenchmark()
+{
+	stopTimer();
+}
+
+void PipelineBenchmark::start()
+{
+	std::cout << "Benchmarking " << m_settings.chainFile.getFullPathName() << " for " << m_settings.seconds << " s" << std::endl;
+
+	if (!AccessClass::getEditorViewport()->loadStateAsync(m_settings.chainFile, this, false))
+		fail("A configuration is already being loaded");
+}
+
+void PipelineBenchmark::signalChainLoaded(SignalChainLoader* loader, const String& result)
+{
+	if (!loader->wasSuccessful())
+	{
+		fail(result);
+		return;
+	}
+
+	m_loadReadSeconds = loader->getPrepareSeconds();
+	m_loadBuildSeconds = loader->getBuildSeconds();
+
+	CoreServices::setAcquisitionStatus(true);
+	if (!AccessClass::getAudioComponent()->callbacksAreActive())
+	{
+		fail("Acquisition could not be started");
+		return;
+	}
+
+	m_startTicks = Time::getHighResolutionTicks();
+	startTimer(100);
+}
+
+void PipelineBenchmark::timerCallback()
+{
+	m_cpuUsageSum += AccessClass::getAudioComponent()->deviceManager.getCpuUsage();
+	m_numCpuUsageReadings++;
+
+	if (Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - m_startTicks) >= m_settings.seconds)
+		finish();
+}
+
+void PipelineBenchmark::finish()
+{
+	stopTimer();
+	CoreServices::setAcquisitionStatus(false);
+
+	const var report = createReport();
+	const String json = JSON::toString(report);
+
+	if (!m_settings.reportFile.replaceWithText(json))
+	{
+		fail("Could not write " + m_settings.reportFile.getFullPathName());
+		return;
+	}
+
+	//Short summary for the console, the report has the details
+	Array<var>* processors = report["processors"].getArray();
+	for (int i = 0; i < processors->size(); i++)
+	{
+		const var& p = processors->getReference(i);
+		std::cout << p["name"].toString() << " (" << p["node_id"].toString() << "): mean "
+			<< double(p["block_time_us"]["mean"]) << " us, p99 " << double(p["block_time_us"]["p99"])
+			<< " us, max " << double(p["block_time_us"]["max"]) << " us" << std::endl;
+	}
+	std::cout << "Benchmark report written to " << m_settings.reportFile.getFullPathName() << std::endl;
+
+	JUCEApplication::getInstance()->setApplicationReturnValue(0);
+	JUCEApplication::quit();
+}
+
+void PipelineBenchmark::fail(const String& error)
+{
+	stopTimer();
+	std::cerr << "Benchmark failed: " << error << std::endl;
+
+	if (CoreServices::getAcquisitionStatus())
+		CoreServices::setAcquisitionStatus(false);
+
+	JUCEApplication::getInstance()->setApplicationReturnValue(1);
+	JUCEApplication::quit();
+}
+
+var PipelineBenchmark::createReport() const
+{
+	AudioDeviceManager& deviceManager = AccessClass::getAudioComponent()->deviceManager;
+	AudioDeviceManager::AudioDeviceSetup setup;
+	deviceManager.getAudioDeviceSetup(setup);
+
+	DynamicObject::Ptr machine = new DynamicObject();
+	machine->setProperty("computer", SystemStats::getComputerName());
+	machine->setProperty("os", SystemStats::getOperatingSystemName());
+	machine->setProperty("cpu_vendor", SystemStats::getCpuVendor());
+	machine->setProperty("cpu_count", SystemStats::getNumCpus());
+	machine->setProperty("cpu_mhz", SystemStats::getCpuSpeedInMegaherz());
+	machine->setProperty("memory_mb", SystemStats::getMemorySizeInMegabytes());
+
+	DynamicObject::Ptr report = new DynamicObject();
+	report->setProperty("chain", m_settings.chainFile.getFullPathName());
+	report->setProperty("gui_version", JUCEApplication::getInstance()->getApplicationVersion());
+	report->setProperty("date", Time::getCurrentTime().toISO8601(true));
+	report->setProperty("duration_s", Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - m_startTicks));
+	report->setProperty("real_time", m_settings.realTime);
+	report->setProperty("load_read_s", m_loadReadSeconds);
+	report->setProperty("load_build_s", m_loadBuildSeconds);
+	report->setProperty("buffer_size", setup.bufferSize);
+	report->setProperty("callback_rate_hz", setup.sampleRate / jmax(1, setup.bufferSize));
+	report->setProperty("mean_callback_cpu_usage", m_numCpuUsageReadings > 0 ? m_cpuUsageSum / m_numCpuUsageReadings : 0.0);
+	report->setProperty("machine", var(machine));
+
+	ProcessorGraph* graph = AccessClass::getProcessorGraph();
+	report->setProperty("budget_overruns", graph->getWatchdog()->getNumOverruns());
+
+	Array<GenericProcessor*> processors = graph->getListOfProcessors();
+	processors.add(graph->getRecordNode());
+	processors.add(graph->getAudioNode());
+
+	var processorReports;
+	for (int i = 0; i < processors.size(); i++)
+		processorReports.append(createProcessorReport(processors[i]));
+	report->setProperty("processors", processorReports);
+
+	return var(report);
+}
+
+var PipelineBenchmark::createProcessorReport(const GenericProcessor* processor)
+{
+	const ProcessorTimingStats& stats = processor->getTimingStats();
+
+	DynamicObject::Ptr blockTime = new DynamicObject();
+	blockTime->setProperty("min", stats.getMinBlockTime() * 1e6);
+	blockTime->setProperty("mean", stats.getMeanBlockTime() * 1e6);
+	blockTime->setProperty("p99", stats.getBlockTimePercentile(0.99) * 1e6);
+	blockTime->setProperty("max", stats.getMaxBlockTime() * 1e6);
+
+	var streams;
+	for (int s = 0; s < stats.getNumStreams(); s++)
+	{
+		const uint32 id = stats.getStreamId(s);
+		DynamicObject::Ptr stream = new DynamicObject();
+
+		for (int c = 0; c < processor->getTotalDataChannels(); c++)
+		{
+			const DataChannel* chan = processor->getDataChannel(c);
+			if (GenericProcessor::getProcessorFullId(chan->getSourceNodeID(), chan->getSubProcessorIdx()) == id)
+			{
+				stream->setProperty("source_id", chan->getSourceNodeID());
+				stream->setProperty("subprocessor", chan->getSubProcessorIdx());
+				stream->setProperty("source_name", chan->getSourceName());
+				stream->setProperty("nominal_sample_rate", chan->getSampleRate());
+				break;
+			}
+		}
+		stream->setProperty("samples", stats.getStreamSamples(s));
+		stream->setProperty("samples_per_second", stats.getStreamSampleRate(s));
+		stream->setProperty("throughput_samples_per_second", stats.getStreamThroughput(s));
+		streams.append(var(stream));
+	}
+
+	DynamicObject::Ptr p = new DynamicObject();
+	p->setProperty("name", processor->getName());
+	p->setProperty("node_id", processor->getNodeId());
+	p->setProperty("blocks", stats.getNumBlocks());
+	p->setProperty("block_time_us", var(blockTime));
+	p->setProperty("processing_time_s", stats.getTotalProcessingTime());
+	p->setProperty("load", stats.getElapsedTime() > 0 ? stats.getTotalProcessingTime() / stats.getElapsedTime() : 0.0);
+	p->setProperty("streams", streams);
+	return var(p);
+}
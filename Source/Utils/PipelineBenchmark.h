@@ -0,0 +1,103 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PIPELINEBENCHMARK_H_INCLUDED
+#define PIPELINEBENCHMARK_H_INCLUDED
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../UI/SignalChainLoader.h"
+
+class GenericProcessor;
+
+/**
+	Runs a saved signal chain for a fixed time and writes a JSON report with the
+	per-processor timing collected by GenericProcessor::getTimingStats().
+
+	Started from the command line:
+
+	open-ephys --benchmark chain.xml [--seconds 10] [--output report.json] [--unthrottled]
+
+	The main window is never shown and no audio hardware is opened; the graph is
+	driven by an OfflineAudioDevice using the buffer size stored in the chain.
+	With --unthrottled, callbacks run back to back, which measures the maximum
+	throughput of sources that can produce data on demand.
+
+	The chain is loaded the same way as from the menu, without blocking the message
+	thread, and the report includes how long reading and building it took.
+
+	The application quits when the report has been written, returning 0 on success.
+
+	@see ProcessorTimingStats, OfflineAudioDevice
+*/
+class PipelineBenchmark : private Timer,
+	private SignalChainLoader::Listener
+{
+public:
+	struct Settings
+	{
+		Settings();
+
+		File chainFile;
+		File reportFile;
+		double seconds;
+		bool realTime;
+	};
+
+	/** Returns true if the arguments ask for a benchmark run */
+	static bool isRequested(const StringArray& arguments);
+
+	/** Fills the settings from the command line arguments. Returns false, with an error message, if they are not valid */
+	static bool parseCommandLine(const StringArray& arguments, Settings& settings, String& error);
+
+	static String getUsage();
+
+	PipelineBenchmark(const Settings& settings);
+	~PipelineBenchmark();
+
+	/** Loads the chain, then starts acquisition. Must be called from the message thread */
+	void start();
+
+private:
+	void timerCallback() override;
+	void signalChainLoaded(SignalChainLoader* loader, const String& result) override;
+
+	/** Stops acquisition, writes the report and quits */
+	void finish();
+
+	/** Quits without a report */
+	void fail(const String& error);
+
+	var createReport() const;
+	static var createProcessorReport(const GenericProcessor* processor);
+
+	Settings m_settings;
+	int64 m_startTicks;
+	double m_cpuUsageSum;
+	int m_numCpuUsageReadings;
+	double m_loadReadSeconds;
+	double m_loadBuildSeconds;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PipelineBenchmark);
+};
+
+#endif  // PIPELINEBENCHMARK_H_INCLUDED
@@ -0,0 +1,232 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Measures the compressed binary engine against the data rate of a 1024 channel recording.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-o compression_benchmark Tests/BinaryWriter/compression_benchmark.cpp \
+			Source/Plugins/BinaryWriter/BlockCompressor.cpp Source/Plugins/BinaryWriter/CompressedBlockFile.cpp \
+			Source/Plugins/BinaryWriter/CompressedFileSource.cpp Source/Processors/FileReader/FileSource.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp -lpthread -ldl -lrt
+		./compression_benchmark [threads] [seconds]
+
+	Run from the repository root. The synthetic data is a slow oscillation plus noise of about
+	25 bits rms on every channel, so the ratio is a conservative estimate for real recordings.
+
+	First BlockCompressor alone: ratio, and compression and decompression speed on one thread.
+	Then a whole .oecd file written through CompressedBlockFile with a pool of the given number
+	of threads, in record-thread sized writes with a timestamp gap in the middle, timed until the
+	file is closed, and read back through CompressedFileSource. Exits with a non-zero status if
+	any sample does not match.
+*/
+
+#include "../../Source/Plugins/BinaryWriter/BlockCompressor.h"
+#include "../../Source/Plugins/BinaryWriter/CompressedBlockFile.h"
+#include "../../Source/Plugins/BinaryWriter/CompressedFileSource.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace BinaryRecordingEngine;
+
+namespace
+{
+	const int numChannels = 1024;
+	const float sampleRate = 30000.0f;
+	const int samplesPerBlock = 1024;
+	const int gapSamples = 777;
+
+	HeapBlock<int16> oscillation;
+
+	//Deterministic, so the reader can check every sample without keeping the recording in memory
+	inline int16 getSample(int channel, int64 sample)
+	{
+		uint32 h = uint32(channel) * 0x9e3779b1u ^ uint32(sample) * 0x85ebca6bu ^ uint32(sample >> 32);
+		h ^= h >> 15;
+		h *= 0x2c1b3c6du;
+		h ^= h >> 12;
+		const int noise = int(h & 0xff) + int((h >> 8) & 0xff) + int((h >> 16) & 0xff) - 382;
+		return int16(oscillation[(sample * (1 + channel % 5)) % int64(sampleRate)] + noise / 5);
+	}
+
+	void fillChannel(int16* dest, int channel, int64 firstSample, int nSamples)
+	{
+		for (int i = 0; i < nSamples; i++)
+			dest[i] = getSample(channel, firstSample + i);
+	}
+
+	double secondsSince(int64 ticks)
+	{
+		return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - ticks);
+	}
+
+	bool benchmarkCompressor()
+	{
+		const int numBlocks = 16;
+		BlockCompressor compressor(samplesPerBlock);
+		HeapBlock<int16> samples(samplesPerBlock);
+		HeapBlock<int16> decoded(samplesPerBlock);
+		HeapBlock<uint8> compressed(BlockCompressor::getMaxCompressedSize(samplesPerBlock));
+
+		int64 rawBytes = 0, compressedBytes = 0;
+		double compressSeconds = 0, decompressSeconds = 0;
+		int mismatches = 0;
+
+		for (int b = 0; b < numBlocks; b++)
+		{
+			for (int c = 0; c < numChannels; c++)
+			{
+				fillChannel(samples, c, int64(b) * samplesPerBlock, samplesPerBlock);
+
+				int64 start = Time::getHighResolutionTicks();
+				const int size = compressor.compress(samples, samplesPerBlock, compressed);
+				compressSeconds += secondsSince(start);
+
+				start = Time::getHighResolutionTicks();
+				const bool ok = BlockCompressor::decompress(compressed, size, decoded, samplesPerBlock);
+				decompressSeconds += secondsSince(start);
+
+				if (!ok || memcmp(samples, decoded, samplesPerBlock * sizeof(int16)) != 0)
+					mismatches++;
+				rawBytes += samplesPerBlock * sizeof(int16);
+				compressedBytes += size;
+			}
+		}
+
+		printf("BlockCompressor: ratio %.2f, compress %.1f MB/s, decompress %.1f MB/s per thread\n",
+			double(rawBytes) / compressedBytes, rawBytes / 1048576.0 / compressSeconds, rawBytes / 1048576.0 / decompressSeconds);
+
+		if (mismatches > 0)
+		{
+			printf("FAIL: %d channel blocks did not round trip\n", mismatches);
+			return false;
+		}
+		return true;
+	}
+
+	bool benchmarkFile(int numThreads, double seconds, const File& file)
+	{
+		const int64 numSamples = int64(seconds * sampleRate);
+		const int64 gapAt = numSamples / 2;
+		HeapBlock<int16> samples(2048);
+		Random random(3);
+
+		const int64 start = Time::getHighResolutionTicks();
+		{
+			ThreadPool pool(numThreads);
+			ScopedPointer<CompressedBlockFile> writer = new CompressedBlockFile(numChannels, samplesPerBlock, &pool);
+			for (int c = 0; c < numChannels; c++)
+				writer->setChannelInfo(c, "CH" + String(c + 1), 0.195f);
+			if (!writer->openFile(file.getFullPathName(), sampleRate, 0))
+			{
+				printf("FAIL: could not create %s\n", file.getFullPathName().toRawUTF8());
+				return false;
+			}
+
+			//the record thread hands over whatever arrived since its last pass
+			int64 written = 0;
+			while (written < numSamples)
+			{
+				const int64 end = written < gapAt ? gapAt : numSamples;
+				const int n = int(jmin(end - written, int64(300 + random.nextInt(1500))));
+				const int64 position = written + (written >= gapAt ? gapSamples : 0);
+				for (int c = 0; c < numChannels; c++)
+				{
+					fillChannel(samples, c, written, n);
+					writer->writeChannel(position, c, samples, n);
+				}
+				written += n;
+			}
+			writer = nullptr;
+		}
+		const double wallSeconds = secondsSince(start);
+
+		const double rawMB = double(numSamples) * numChannels * sizeof(int16) / 1048576.0;
+		const double realTimeMB = numChannels * sampleRate * sizeof(int16) / 1048576.0;
+		printf("CompressedBlockFile, %d threads: %.1f MB in %.2f s, %.1f MB/s (real time needs %.1f MB/s), ratio %.2f\n",
+			numThreads, rawMB, wallSeconds, rawMB / wallSeconds, realTimeMB, rawMB * 1048576.0 / file.getSize());
+
+		CompressedFileSource source;
+		if (!source.OpenFile(file))
+		{
+			printf("FAIL: could not read back %s\n", file.getFullPathName().toRawUTF8());
+			return false;
+		}
+		source.setActiveRecord(0);
+		if (source.getActiveNumSamples() != numSamples + gapSamples || source.getActiveNumChannels() != numChannels)
+		{
+			printf("FAIL: read back %d channels, %lld samples\n", source.getActiveNumChannels(), (long long)source.getActiveNumSamples());
+			return false;
+		}
+
+		//the gap reads back as zeroes, as in the uncompressed files
+		HeapBlock<int16> buffer(numChannels * 4096);
+		int64 position = 0;
+		int64 mismatches = 0;
+		int n;
+		while ((n = source.readData(buffer, 4096)) > 0)
+		{
+			for (int i = 0; i < n; i++, position++)
+			{
+				for (int c = 0; c < numChannels; c++)
+				{
+					int16 expected = 0;
+					if (position < gapAt)
+						expected = getSample(c, position);
+					else if (position >= gapAt + gapSamples)
+						expected = getSample(c, position - gapSamples);
+					if (buffer[i * numChannels + c] != expected)
+						mismatches++;
+				}
+			}
+		}
+
+		if (position != numSamples + gapSamples || mismatches > 0)
+		{
+			printf("FAIL: read %lld samples, %lld mismatches\n", (long long)position, (long long)mismatches);
+			return false;
+		}
+		printf("Read back %lld samples per channel, bit exact\n", (long long)position);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int numThreads = argc > 1 ? jmax(1, atoi(argv[1])) : 4;
+	const double seconds = argc > 2 ? jmax(0.1, atof(argv[2])) : 4.0;
+
+	oscillation.malloc(int(sampleRate));
+	for (int i = 0; i < int(sampleRate); i++)
+		oscillation[i] = int16(300 * std::sin(2 * double_Pi * i / sampleRate));
+
+	File file = File::getSpecialLocation(File::tempDirectory).getChildFile("compression_benchmark.oecd");
+
+	bool ok = benchmarkCompressor();
+	ok = benchmarkFile(numThreads, seconds, file) && ok;
+	file.deleteFile();
+
+	return ok ? 0 : 1;
+}
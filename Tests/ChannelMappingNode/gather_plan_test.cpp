@@ -0,0 +1,240 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Checks the in-place channel gather plan against the copy-everything mapping it replaced.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-o gather_plan_test Tests/ChannelMappingNode/gather_plan_test.cpp \
+			Source/Plugins/ChannelMappingNode/ChannelGatherPlan.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp -lpthread -ldl -lrt
+		./gather_plan_test
+
+	Run from the repository root. Random maps of 1 to 12 inputs are built the way the editor
+	does: in order, shuffled, or shuffled with some outputs reading the same input, with some
+	inputs disabled and up to four references. Each output gets its own number of samples.
+	The plan is run on a random buffer and every output sample must equal the one the previous
+	ChannelMappingNode::process computed from a full copy of the input. Each map is then
+	rebuilt with new references, as changing them while acquiring does, and checked again.
+	Last, interleaving 384 channels, a map made of long cycles, must not keep more than one
+	channel per cycle aside.
+	Exits with a non-zero status if any check fails.
+*/
+
+#include "../../Source/Plugins/ChannelMappingNode/ChannelGatherPlan.h"
+
+#include <cstdio>
+#include <random>
+
+namespace
+{
+	const int maxSamples = 40;
+
+	struct Mapping
+	{
+		Array<int> channelArray;
+		Array<bool> enabledChannelArray;
+		Array<int> referenceArray;
+		Array<int> referenceChannels;
+		int numOutputs;
+	};
+
+	void setReferences(Mapping& map, int numInputs, std::mt19937& rng)
+	{
+		for (int r = 0; r < 4; ++r)
+			map.referenceChannels.set(r, (rng() % 2) ? int(rng() % numInputs) : -1);
+		for (int i = 0; i < numInputs; ++i)
+			map.referenceArray.set(i, (rng() % 3 == 0) ? int(rng() % 4) : -1);
+	}
+
+	Mapping randomMapping(int numInputs, std::mt19937& rng)
+	{
+		Mapping map;
+		for (int i = 0; i < 1024; ++i)
+		{
+			map.channelArray.add(i);
+			map.enabledChannelArray.add(true);
+			map.referenceArray.add(-1);
+		}
+		for (int r = 0; r < 16; ++r)
+			map.referenceChannels.add(-1);
+
+		const int mode = rng() % 3;
+		if (mode >= 1)
+		{
+			for (int i = numInputs - 1; i > 0; --i)
+				map.channelArray.swap(i, rng() % (i + 1));
+		}
+		if (mode == 2)
+		{
+			for (int i = 0; i < numInputs; ++i)
+				if (rng() % 4 == 0)
+					map.channelArray.set(i, rng() % numInputs);
+		}
+		for (int i = 0; i < numInputs; ++i)
+			if (rng() % 5 == 0)
+				map.enabledChannelArray.set(i, false);
+
+		setReferences(map, numInputs, rng);
+
+		// as many outputs as updateSettings keeps
+		map.numOutputs = 0;
+		for (int i = 0; i < numInputs; ++i)
+			if (map.enabledChannelArray[map.channelArray[i]])
+				++map.numOutputs;
+		return map;
+	}
+
+	// The mapping as ChannelMappingNode::process did it before the plan, from a full copy of the input
+	void referenceProcess(const Mapping& map, const AudioSampleBuffer& input, AudioSampleBuffer& output,
+		const Array<int>& numSamples)
+	{
+		const int numInputs = input.getNumChannels();
+		int j = 0;
+		int i = 0;
+		while (j < map.numOutputs)
+		{
+			const int realChan = map.channelArray[i];
+			if (realChan < numInputs && map.enabledChannelArray[realChan])
+			{
+				output.copyFrom(j, 0, input.getReadPointer(realChan), numSamples[j]);
+
+				const int reference = map.referenceArray[realChan];
+				if (reference > -1 && map.referenceChannels[reference] > -1 && map.referenceChannels[reference] < numInputs)
+					output.addFrom(j, 0, input, map.channelArray[map.referenceChannels[reference]], 0, numSamples[j], -1.0f);
+				++j;
+			}
+			++i;
+		}
+	}
+
+	// Runs the plan and the previous mapping on the same buffer, true if every output matches
+	bool check(ChannelGatherPlan& plan, const Mapping& map, int numInputs, std::mt19937& rng)
+	{
+		plan.build(map.channelArray, map.enabledChannelArray, map.referenceArray, map.referenceChannels, map.numOutputs);
+		if (plan.getNumOutputs() != map.numOutputs)
+			return false;
+
+		Array<int> numSamples;
+		for (int j = 0; j < map.numOutputs; ++j)
+		{
+			numSamples.add(1 + int(rng() % maxSamples));
+			plan.setNumSamples(j, numSamples[j]);
+		}
+
+		AudioSampleBuffer buffer(numInputs, maxSamples);
+		for (int c = 0; c < numInputs; ++c)
+			for (int s = 0; s < maxSamples; ++s)
+				buffer.setSample(c, s, float(rng() % 1000));
+
+		AudioSampleBuffer input;
+		input.makeCopyOf(buffer);
+		AudioSampleBuffer expected;
+		expected.makeCopyOf(buffer);
+
+		referenceProcess(map, input, expected, numSamples);
+		plan.process(buffer);
+
+		for (int c = 0; c < map.numOutputs; ++c)
+			for (int s = 0; s < numSamples[c]; ++s)
+				if (buffer.getSample(c, s) != expected.getSample(c, s))
+					return false;
+		return true;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(5);
+	const int numTrials = 20000;
+	int numChecked = 0;
+
+	for (int trial = 0; trial < numTrials; ++trial)
+	{
+		const int numInputs = 1 + int(rng() % 12);
+		Mapping map = randomMapping(numInputs, rng);
+
+		ChannelGatherPlan plan;
+		plan.prepare(numInputs);
+
+		for (int rebuild = 0; rebuild < 2; ++rebuild)
+		{
+			if (rebuild > 0)
+				setReferences(map, numInputs, rng);
+
+			if (!check(plan, map, numInputs, rng))
+			{
+				printf("FAIL: map %d of %d inputs differs from the previous mapping", trial, numInputs);
+				if (rebuild > 0)
+					printf(" after changing references");
+				printf("\n");
+				return 1;
+			}
+			++numChecked;
+		}
+	}
+	printf("%d random maps match the previous mapping\n", numChecked);
+
+	// even outputs read the first half of the inputs and odd outputs the second half, a permutation
+	const int numInputs = 384;
+	Mapping map;
+	for (int i = 0; i < 1024; ++i)
+	{
+		map.channelArray.add(i < numInputs ? ((i % 2) ? i / 2 + numInputs / 2 : i / 2) : i);
+		map.enabledChannelArray.add(true);
+		map.referenceArray.add(-1);
+	}
+	for (int r = 0; r < 16; ++r)
+		map.referenceChannels.add(-1);
+	map.numOutputs = numInputs;
+
+	ChannelGatherPlan plan;
+	plan.prepare(numInputs);
+	if (!check(plan, map, numInputs, rng))
+	{
+		printf("FAIL: the 384 channel interleave differs from the previous mapping\n");
+		return 1;
+	}
+
+	// each cycle of the permutation needs one channel kept aside, channels in place need none
+	int numCycles = 0;
+	Array<bool> visited;
+	visited.insertMultiple(0, false, numInputs);
+	for (int i = 0; i < numInputs; ++i)
+	{
+		if (visited[i] || map.channelArray[i] == i)
+			continue;
+		++numCycles;
+		for (int c = i; !visited[c]; c = map.channelArray[c])
+			visited.set(c, true);
+	}
+	printf("384 channel interleave: %d cycles, %d channels saved\n", numCycles, plan.getNumSavedChannels());
+	if (plan.getNumSavedChannels() > numCycles)
+	{
+		printf("FAIL: more channels saved than cycles in the map\n");
+		return 1;
+	}
+
+	printf("OK: the gather plan matches the previous mapping\n");
+	return 0;
+}
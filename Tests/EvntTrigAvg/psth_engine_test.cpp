@@ -0,0 +1,220 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Checks the incremental event-triggered histograms of EvntTrigAvg against a brute-force count.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-o psth_engine_test Tests/EvntTrigAvg/psth_engine_test.cpp \
+			Source/Plugins/EvntTrigAvg/PsthEngine.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp -lpthread -ldl -lrt
+		./psth_engine_test
+
+	Run from the repository root. Random triggers and spikes, some sorted and some not, are fed
+	to a PsthEngine in blocks as the processor does, with the triggers of a block in random
+	order. Windows and bin sizes that do and do not divide each other are tried. At the end
+	every bin of every unit is compared with a count over all spike and trigger pairs, as are
+	the minimum, maximum and mean of each unit, the units themselves and the number of trials.
+	Last, the time to bin 30 s of 100 electrodes with 1 kHz triggers and a 1 s window is shown.
+	Exits with a non-zero status on any difference.
+*/
+
+#include "../../Source/Plugins/EvntTrigAvg/PsthEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const int numElectrodes = 4;
+	const int samplesPerBlock = 1024;
+
+	struct Spike
+	{
+		int electrode;
+		int sortedId;
+		int64 timestamp;
+	};
+
+	struct Case
+	{
+		int64 windowSize;
+		int64 binSize;
+	};
+
+	bool checkCase(const Case& c, std::mt19937_64& generator)
+	{
+		PsthEngine engine;
+		engine.configure(numElectrodes, c.windowSize, c.binSize);
+
+		std::vector<int64> triggers;
+		std::vector<Spike> spikes;
+		std::vector<int64> blockTriggers;
+		int64 t = 0;
+
+		for (int block = 0; block < 3000; block++)
+		{
+			const int64 end = t + samplesPerBlock;
+			blockTriggers.clear();
+			for (int64 x = t; x < end; x++)
+			{
+				if (generator() % 997 == 0)
+					blockTriggers.push_back(x);
+
+				for (int e = 0; e < numElectrodes; e++)
+				{
+					if (generator() % 300 == 0)
+					{
+						const int sortedId = generator() % 3 != 0 ? int(e * 10 + generator() % 3 + 1) : 0;
+						Spike spike = { e, sortedId, x };
+						spikes.push_back(spike);
+						engine.addSpike(e, sortedId, x);
+					}
+				}
+			}
+
+			std::shuffle(blockTriggers.begin(), blockTriggers.end(), generator);
+			for (size_t i = 0; i < blockTriggers.size(); i++)
+				engine.addTrigger(blockTriggers[i]);
+			triggers.insert(triggers.end(), blockTriggers.begin(), blockTriggers.end());
+
+			t = end;
+			engine.advance(t);
+			if (block % 50 == 0)
+				engine.publish();
+		}
+		engine.advance(t + 2 * c.windowSize);
+		engine.publish();
+
+		PsthEngine::Snapshot snapshot;
+		engine.getSnapshot(snapshot);
+
+		const int64 halfWindow = c.windowSize / 2;
+		const int numBins = int(jmax<int64>(1, c.windowSize / c.binSize));
+		int mismatches = 0;
+
+		// one unit per electrode for all its spikes, plus one per sorted ID seen on it
+		size_t expectedUnits = numElectrodes;
+		for (int e = 0; e < numElectrodes; e++)
+			for (int id = 1; id <= 3; id++)
+				expectedUnits += std::any_of(spikes.begin(), spikes.end(), [e, id](const Spike& s) { return s.electrode == e && s.sortedId == e * 10 + id; });
+
+		for (size_t u = 0; u < snapshot.units.size(); u++)
+		{
+			const PsthEngine::Unit& unit = snapshot.units[u];
+			std::vector<uint64> expected(numBins, 0);
+
+			for (size_t s = 0; s < spikes.size(); s++)
+			{
+				if (spikes[s].electrode != unit.electrode || (unit.sortedId != 0 && spikes[s].sortedId != unit.sortedId))
+					continue;
+
+				for (size_t k = 0; k < triggers.size(); k++)
+				{
+					const int64 offset = spikes[s].timestamp - triggers[k] + halfWindow;
+					if (offset >= 0 && offset / c.binSize < numBins)
+						expected[size_t(offset / c.binSize)]++;
+				}
+			}
+
+			uint64 minimum = expected[0], maximum = 0, total = 0;
+			for (int b = 0; b < numBins; b++)
+			{
+				mismatches += snapshot.getCounts(int(u))[b] != expected[b];
+				minimum = jmin(minimum, expected[b]);
+				maximum = jmax(maximum, expected[b]);
+				total += expected[b];
+			}
+
+			const PsthEngine::Summary& summary = snapshot.summaries[u];
+			if (summary.min != float(minimum) || summary.max != float(maximum)
+				|| std::abs(summary.mean - float(total) / numBins) > 1e-3f * jmax(1.0f, summary.mean))
+			{
+				printf("FAIL: unit %d of electrode %d: min %g max %g mean %g, expected %llu %llu %g\n",
+					unit.sortedId, unit.electrode, summary.min, summary.max, summary.mean,
+					(unsigned long long)minimum, (unsigned long long)maximum, float(total) / numBins);
+				mismatches++;
+			}
+		}
+
+		printf("window %lld, bin %lld: %d units, %lld trials, %d spikes, %d mismatching bins or summaries\n",
+			(long long)c.windowSize, (long long)c.binSize, int(snapshot.units.size()), (long long)snapshot.numTrials,
+			int(spikes.size()), mismatches);
+
+		if (mismatches > 0 || snapshot.units.size() != expectedUnits || snapshot.numTrials != int64(triggers.size())
+			|| snapshot.numBins != numBins)
+		{
+			printf("FAIL: %d units (expected %d), %lld trials (expected %d), %d bins (expected %d)\n",
+				int(snapshot.units.size()), int(expectedUnits), (long long)snapshot.numTrials, int(triggers.size()),
+				snapshot.numBins, numBins);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	std::mt19937_64 generator(1);
+	const Case cases[] = { { 3001, 100 }, { 3000, 300 }, { 1000, 1 }, { 500, 7 } };
+
+	bool ok = true;
+	for (const Case& c : cases)
+		ok = checkCase(c, generator) && ok;
+
+	// 100 electrodes with 2 sorted units each, 60 spikes/s per electrode, 1 kHz triggers, 1 s window and 10 ms bins
+	PsthEngine engine;
+	const int electrodes = 100;
+	engine.configure(electrodes, 30000, 300);
+	int64 t = 0;
+	int numSpikes = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int block = 0; block < 30 * 30; block++)
+	{
+		const int64 end = t + 1000;
+		for (int64 x = t; x < end; x += 30)
+			engine.addTrigger(x);
+		for (int e = 0; e < electrodes; e++)
+		{
+			for (int k = 0; k < 2; k++)
+			{
+				engine.addSpike(e, e * 3 + 1 + int(generator() % 2), t + int64(generator() % 1000));
+				numSpikes++;
+			}
+		}
+		t = end;
+		engine.advance(t);
+		if (block % 50 == 0)
+			engine.publish();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("30 s of data, %d spikes against 1000 triggers each: %.3f s (%.1f%% of real time)\n", numSpikes, seconds, seconds / 30 * 100);
+
+	if (ok)
+		printf("OK: the histograms match the brute-force count\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Compares compressed HDF5 datasets with the uncompressed ones KWD and NWB files use.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-I /usr/include/hdf5/serial -o hdf5_compression_benchmark Tests/OpenEphysHDF5Lib/compression_benchmark.cpp \
+			Source/Plugins/CommonLibs/OpenEphysHDF5Lib/HDF5FileFormat.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp \
+			-L/usr/lib/x86_64-linux-gnu/hdf5/serial -lhdf5_cpp -lhdf5 -lpthread -ldl -lrt
+		./hdf5_compression_benchmark [channels] [seconds] [level] [threads]
+
+	Run from the repository root. A continuous dataset and a spike waveform dataset are written
+	as the record engines do, in record-thread sized blocks, three times: uncompressed, with the
+	deflate filter run by HDF5 inside H5Dwrite, and with the chunks compressed on a pool of the
+	given number of threads and written with H5Dwrite_chunk. For each, the file size, the CPU
+	time the record thread spends in the write calls and in closing the file, and the time until
+	the file is closed are shown. On Windows the former is wall time.
+	Every file is then read back with the stock H5Dread, so through the standard filters, and
+	the program exits with a non-zero status if any sample does not match.
+*/
+
+#include <hdf5.h>
+#include "../../Source/Plugins/CommonLibs/OpenEphysHDF5Lib/HDF5FileFormat.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+using namespace OpenEphysHDF5;
+
+namespace
+{
+	const float sampleRate = 30000.0f;
+	const int samplesPerBlock = 1024;
+	const int spikeChannels = 4;
+	const int spikeSamples = 40;
+
+	//Deterministic, so the reader can check every sample without keeping the recording in memory
+	inline int16 getSample(int channel, int64 sample)
+	{
+		uint32 h = uint32(channel) * 0x9e3779b1u ^ uint32(sample) * 0x85ebca6bu ^ uint32(sample >> 32);
+		h ^= h >> 15;
+		h *= 0x2c1b3c6du;
+		h ^= h >> 12;
+		const int noise = int(h & 0xff) + int((h >> 8) & 0xff) + int((h >> 16) & 0xff) - 382;
+		return int16(300 * std::sin(2 * double_Pi * sample * (1 + channel % 5) / sampleRate) + noise / 5);
+	}
+
+	inline int16 getSpikeSample(int64 spike, int index)
+	{
+		const int t = index % spikeSamples;
+		return int16(-(100 + spike % 50) * std::exp(-(t - 10) * (t - 10) / 8.0) + (index * 7 + spike) % 11);
+	}
+
+	double secondsSince(int64 ticks)
+	{
+		return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - ticks);
+	}
+
+	//CPU time of the calling thread, so that compression jobs running on the same cores do not count
+	double threadSeconds()
+	{
+#if JUCE_WINDOWS
+		return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks());
+#else
+		timespec t;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+		return t.tv_sec + t.tv_nsec * 1e-9;
+#endif
+	}
+
+	class BenchmarkFile : public HDF5FileBase
+	{
+	public:
+		BenchmarkFile(const File& file_) : file(file_)
+		{
+			readyToOpen = true;
+		}
+
+		String getFileName() override
+		{
+			return file.getFullPathName();
+		}
+
+		HDF5RecordingData* createContinuous(int numChannels, bool compressed)
+		{
+			return createDataSet(BaseDataType::I16, 0, numChannels, CHUNK_XSIZE, "/data", compressed);
+		}
+
+		HDF5RecordingData* createSpikes(bool compressed)
+		{
+			return createDataSet(BaseDataType::I16, 0, spikeChannels, spikeSamples, 64, "/spikes", compressed);
+		}
+
+	protected:
+		int createFileStructure() override
+		{
+			return 0;
+		}
+
+	private:
+		File file;
+	};
+
+	bool writeFile(const File& file, const String& name, int numChannels, int64 numSamples, int level, ThreadPool* pool, int64& numSpikes)
+	{
+		HeapBlock<int16> samples(samplesPerBlock);
+		HeapBlock<int16> waveform(spikeChannels * spikeSamples);
+		double writeSeconds = 0;
+		numSpikes = 0;
+
+		file.deleteFile();
+		const int64 start = Time::getHighResolutionTicks();
+		{
+			BenchmarkFile h5(file);
+			h5.setCompression(level, pool);
+			if (h5.open(numChannels) != 0)
+			{
+				printf("FAIL: could not create %s\n", file.getFullPathName().toRawUTF8());
+				return false;
+			}
+			ScopedPointer<HDF5RecordingData> continuous = h5.createContinuous(numChannels, level > 0);
+			ScopedPointer<HDF5RecordingData> spikes = h5.createSpikes(level > 0);
+
+			for (int64 written = 0; written < numSamples; written += samplesPerBlock)
+			{
+				const int n = int(jmin(int64(samplesPerBlock), numSamples - written));
+				for (int c = 0; c < numChannels; c++)
+				{
+					for (int i = 0; i < n; i++)
+						samples[i] = getSample(c, written + i);
+					const double callStart = threadSeconds();
+					continuous->writeDataRow(c, n, HDF5FileBase::BaseDataType::I16, samples);
+					writeSeconds += threadSeconds() - callStart;
+				}
+
+				for (int i = 0; i < spikeChannels * spikeSamples; i++)
+					waveform[i] = getSpikeSample(numSpikes, i);
+				const double callStart = threadSeconds();
+				spikes->writeDataBlock(1, HDF5FileBase::BaseDataType::I16, waveform);
+				writeSeconds += threadSeconds() - callStart;
+				numSpikes++;
+			}
+
+			const double closeStart = threadSeconds();
+			continuous = nullptr;
+			spikes = nullptr;
+			h5.close();
+			writeSeconds += threadSeconds() - closeStart;
+		}
+		const double wallSeconds = secondsSince(start);
+
+		const double rawMB = double(numSamples) * numChannels * sizeof(int16) / 1048576.0;
+		printf("%s: %.1f MB file (ratio %.2f), %.2f s of record thread CPU, %.2f s until closed (%.1f MB/s)\n",
+			name.toRawUTF8(), file.getSize() / 1048576.0, rawMB * 1048576.0 / file.getSize(),
+			writeSeconds, wallSeconds, rawMB / wallSeconds);
+		return true;
+	}
+
+	bool readBack(const File& file, int numChannels, int64 numSamples, int64 numSpikes, bool compressed)
+	{
+		hid_t h5 = H5Fopen(file.getFullPathName().toRawUTF8(), H5F_ACC_RDONLY, H5P_DEFAULT);
+		if (h5 < 0)
+		{
+			printf("FAIL: could not reopen %s\n", file.getFullPathName().toRawUTF8());
+			return false;
+		}
+
+		hid_t data = H5Dopen2(h5, "/data", H5P_DEFAULT);
+		hid_t plist = H5Dget_create_plist(data);
+		const int numFilters = H5Pget_nfilters(plist);
+		H5Pclose(plist);
+
+		hid_t space = H5Dget_space(data);
+		hsize_t dims[2] = { 0, 0 };
+		H5Sget_simple_extent_dims(space, dims, nullptr);
+
+		int64 mismatches = 0;
+		const int rowsPerRead = 4096;
+		HeapBlock<int16> buffer(size_t(rowsPerRead) * numChannels);
+		for (hsize_t row = 0; row < dims[0] && dims[1] == hsize_t(numChannels); row += rowsPerRead)
+		{
+			hsize_t offset[2] = { row, 0 };
+			hsize_t count[2] = { jmin(hsize_t(rowsPerRead), dims[0] - row), dims[1] };
+			H5Sselect_hyperslab(space, H5S_SELECT_SET, offset, nullptr, count, nullptr);
+			hid_t memory = H5Screate_simple(2, count, nullptr);
+			if (H5Dread(data, H5T_NATIVE_INT16, memory, space, H5P_DEFAULT, buffer) < 0)
+				mismatches++;
+			H5Sclose(memory);
+
+			for (hsize_t i = 0; i < count[0]; i++)
+				for (int c = 0; c < numChannels; c++)
+					if (buffer[i * numChannels + c] != getSample(c, int64(row + i)))
+						mismatches++;
+		}
+		H5Sclose(space);
+		H5Dclose(data);
+
+		hid_t spikes = H5Dopen2(h5, "/spikes", H5P_DEFAULT);
+		space = H5Dget_space(spikes);
+		hsize_t spikeDims[3] = { 0, 0, 0 };
+		H5Sget_simple_extent_dims(space, spikeDims, nullptr);
+		const int spikeSize = spikeChannels * spikeSamples;
+		HeapBlock<int16> waveforms(size_t(spikeDims[0]) * spikeSize);
+		if (spikeDims[0] > 0 && H5Dread(spikes, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, waveforms) < 0)
+			mismatches++;
+		for (hsize_t s = 0; s < spikeDims[0]; s++)
+			for (int i = 0; i < spikeSize; i++)
+				if (waveforms[s * spikeSize + i] != getSpikeSample(int64(s), i))
+					mismatches++;
+		H5Sclose(space);
+		H5Dclose(spikes);
+		H5Fclose(h5);
+
+		if (dims[0] != hsize_t(numSamples) || dims[1] != hsize_t(numChannels) || spikeDims[0] != hsize_t(numSpikes)
+			|| mismatches > 0 || (numFilters > 0) != compressed)
+		{
+			printf("FAIL: read back %llu x %llu samples, %llu spikes, %d filters, %lld mismatches\n",
+				(unsigned long long)dims[0], (unsigned long long)dims[1], (unsigned long long)spikeDims[0],
+				numFilters, (long long)mismatches);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int numChannels = argc > 1 ? jmax(1, atoi(argv[1])) : 1024;
+	const double seconds = argc > 2 ? jmax(0.1, atof(argv[2])) : 4.0;
+	const int level = argc > 3 ? jlimit(1, 9, atoi(argv[3])) : 1;
+	const int numThreads = argc > 4 ? jmax(1, atoi(argv[4])) : 4;
+	const int64 numSamples = int64(seconds * sampleRate);
+
+	printf("%d channels, %.1f s, %.1f MB of samples, deflate level %d\n", numChannels, seconds,
+		double(numSamples) * numChannels * sizeof(int16) / 1048576.0, level);
+
+	File file = File::getSpecialLocation(File::tempDirectory).getChildFile("hdf5_compression_benchmark.h5");
+	ThreadPool pool(numThreads);
+	bool ok = true;
+	int64 numSpikes;
+
+	if (writeFile(file, "Uncompressed", numChannels, numSamples, 0, nullptr, numSpikes))
+		ok = readBack(file, numChannels, numSamples, numSpikes, false) && ok;
+	else
+		ok = false;
+
+	if (writeFile(file, "Deflate inside H5Dwrite", numChannels, numSamples, level, nullptr, numSpikes))
+		ok = readBack(file, numChannels, numSamples, numSpikes, true) && ok;
+	else
+		ok = false;
+
+	if (writeFile(file, "Chunks compressed on " + String(numThreads) + " threads", numChannels, numSamples, level, &pool, numSpikes))
+		ok = readBack(file, numChannels, numSamples, numSpikes, true) && ok;
+	else
+		ok = false;
+
+	file.deleteFile();
+
+	if (ok)
+		printf("OK: every file read back bit exact with H5Dread\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Checks the target phase mode of the phase detector on synthetic sinusoids.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-o target_phase_test Tests/PhaseDetector/target_phase_test.cpp \
+			Source/Plugins/PhaseDetector/PhaseEstimator.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp -lpthread -ldl -lrt
+		./target_phase_test
+
+	Run from the repository root. For a theta, gamma and ripple band, at two sample rates, a
+	sinusoid inside the band with noise of 30% of its amplitude is fed to a PhaseEstimator in
+	blocks of random size, for each of four target phases. After two seconds to settle, the
+	true phase of the sinusoid is taken at every trigger. The mean phase error must be within
+	2 degrees. Its spread must be within 10 degrees plus one sample, as triggers land on whole
+	samples, and there must be at most one trigger per cycle and no more than 10% of cycles
+	missed. Exits with a non-zero status if any case fails.
+*/
+
+#include "../../Source/Plugins/PhaseDetector/PhaseEstimator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const double twoPi = 6.28318530718;
+	const double settleSeconds = 2.0;
+	const double testSeconds = 20.0;
+	const float noiseLevel = 0.3f;
+
+	struct Case
+	{
+		float lowHz;
+		float highHz;
+		float frequency;
+	};
+
+	// wraps a phase difference to -pi..pi
+	double wrap(double d)
+	{
+		d = std::fmod(d, twoPi);
+		if (d > twoPi / 2)
+			d -= twoPi;
+		else if (d < -twoPi / 2)
+			d += twoPi;
+		return d;
+	}
+}
+
+int main()
+{
+	const float sampleRates[] = { 30000, 2000 };
+	const Case cases[] = { { 4, 8, 6 }, { 4, 8, 7.5f }, { 30, 50, 40 }, { 150, 250, 200 } };
+	const float targets[] = { 0, 90, 180, 270 };
+
+	std::mt19937 generator(1);
+	std::normal_distribution<float> noise(0.0f, noiseLevel);
+	std::uniform_int_distribution<int> blockSize(1, 1024);
+
+	bool ok = true;
+	double worstMean = 0, worstSpread = 0;
+	int numCases = 0;
+
+	for (float sampleRate : sampleRates)
+	{
+		for (const Case& c : cases)
+		{
+			if (c.highHz >= sampleRate / 2)
+				continue;
+
+			for (float targetDegrees : targets)
+			{
+				const double target = targetDegrees * twoPi / 360;
+				const double startPhase = 0.7;
+
+				PhaseEstimator estimator;
+				estimator.prepare(sampleRate, c.lowHz, c.highHz);
+
+				const int64 settle = int64(settleSeconds * sampleRate);
+				const int64 total = settle + int64(testSeconds * sampleRate);
+				std::vector<float> block(1024);
+				Array<int> triggers;
+				double sum = 0, sumSquares = 0;
+				int numTriggers = 0;
+
+				for (int64 t = 0; t < total;)
+				{
+					const int n = int(jmin(int64(blockSize(generator)), total - t));
+					for (int i = 0; i < n; i++)
+						block[i] = float(std::sin(twoPi * c.frequency * (t + i) / sampleRate + startPhase)) + noise(generator);
+
+					triggers.clearQuick();
+					estimator.process(block.data(), n, float(target), triggers);
+
+					for (int k = 0; k < triggers.size(); k++)
+					{
+						if (t + triggers[k] < settle)
+							continue;
+						const double error = wrap(twoPi * c.frequency * (t + triggers[k]) / sampleRate + startPhase - target);
+						sum += error;
+						sumSquares += error * error;
+						numTriggers++;
+					}
+					t += n;
+				}
+
+				const double cycles = testSeconds * c.frequency;
+				const double mean = numTriggers > 0 ? sum / numTriggers * 360 / twoPi : 360;
+				const double spread = numTriggers > 0 ? std::sqrt(jmax(0.0, sumSquares / numTriggers - (sum / numTriggers) * (sum / numTriggers))) * 360 / twoPi : 360;
+				worstMean = jmax(worstMean, std::abs(mean));
+				worstSpread = jmax(worstSpread, spread);
+				numCases++;
+
+				printf("%5g Hz in %g-%g Hz at %g samples/s, target %3g degrees: %d triggers for %.0f cycles, mean error %5.2f, sd %5.2f degrees\n",
+					c.frequency, c.lowHz, c.highHz, sampleRate, targetDegrees, numTriggers, cycles, mean, spread);
+
+				const double sampleDegrees = 360 * c.frequency / sampleRate;
+				if (std::abs(mean) > 2 || spread > 10 + sampleDegrees || numTriggers > cycles + 1 || numTriggers < 0.9 * cycles)
+				{
+					printf("FAIL: %g Hz at %g samples/s, target %g degrees\n", c.frequency, sampleRate, targetDegrees);
+					ok = false;
+				}
+			}
+		}
+	}
+
+	printf("%d cases: worst mean error %.2f degrees, worst sd %.2f degrees\n", numCases, worstMean, worstSpread);
+	if (ok)
+		printf("OK: triggers land on the target phase\n");
+	return ok ? 0 : 1;
+}
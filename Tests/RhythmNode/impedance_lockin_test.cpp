@@ -0,0 +1,192 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Checks the impedance lock-in on synthetic sinusoids, without a board.
+
+		g++ -std=c++11 -O2 -o impedance_lockin_test Tests/RhythmNode/impedance_lockin_test.cpp \
+			Source/Plugins/RhythmNode/ImpedanceLockIn.cpp
+		./impedance_lockin_test
+
+	Run from the repository root. For every board sample rate and a low, middle and high test
+	frequency, the window is chosen as RHDImpedanceMeasure does: a whole number of periods,
+	moved to the end of the acquisition. Each of 16 streams gets a cosine of known amplitude and
+	phase, plus noise and the 0.195 uV quantization of the amplifier, and the lock-in must
+	recover both. It must also agree with the per-sample cos() and sin() computation it replaced.
+	Last, the time to measure one row is compared with that computation.
+	Exits with a non-zero status if any check fails.
+*/
+
+#include "../../Source/Plugins/RhythmNode/ImpedanceLockIn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace RhythmNode;
+
+namespace
+{
+	const double twoPi = 6.28318530718;
+	const int numStreams = 16;
+	const int samplesPerBlock = 60;
+
+	// The measurement the lock-in replaced, with the reference computed for every sample
+	void directMeasure(const double* row, int startIndex, int endIndex, double sampleRate, double frequency,
+		double& realComponent, double& imagComponent)
+	{
+		const double k = twoPi * frequency / sampleRate;
+		double i = 0.0, q = 0.0;
+		for (int t = startIndex; t <= endIndex; ++t)
+		{
+			i += row[t] * cos(k * t);
+			q += row[t] * -1.0 * sin(k * t);
+		}
+		realComponent = 2.0 * i / (endIndex - startIndex + 1);
+		imagComponent = 2.0 * q / (endIndex - startIndex + 1);
+	}
+
+	// wraps a phase difference to -pi..pi
+	double phaseError(double a, double b)
+	{
+		double d = fmod(a - b, twoPi);
+		if (d > twoPi / 2)
+			d -= twoPi;
+		else if (d < -twoPi / 2)
+			d += twoPi;
+		return fabs(d);
+	}
+}
+
+int main()
+{
+	std::mt19937 generator(1);
+	std::normal_distribution<double> noise(0.0, 5.0);
+
+	const double sampleRates[] = { 1000, 1250, 1500, 2000, 2500, 3000, 3333, 5000, 6250, 10000, 12500, 15000, 20000, 25000, 30000 };
+	const double frequencies[] = { 100, 1000, 2500 };
+
+	int numCases = 0;
+	double worstAmplitude = 0, worstPhase = 0, worstDirect = 0;
+
+	for (double sampleRate : sampleRates)
+	{
+		for (double desiredFrequency : frequencies)
+		{
+			const int period = int(sampleRate / desiredFrequency + 0.5);
+			if (period < 4)
+				continue;
+			const double frequency = sampleRate / period;
+
+			// as in runImpedanceMeasurement: 20 ms but no fewer than 5 periods, plus 2 to settle, in whole blocks
+			const int numPeriods = std::max(5, int(0.020 * frequency));
+			const int numBlocks = std::max(2, int(ceil((numPeriods + 2.0) * period / samplesPerBlock)));
+			const int rowLength = samplesPerBlock * numBlocks;
+			int startIndex = 0;
+			int endIndex = numPeriods * period - 1;
+			while (endIndex < rowLength - period)
+			{
+				startIndex += period;
+				endIndex += period;
+			}
+
+			ImpedanceLockIn lockIn;
+			lockIn.setWindow(startIndex, endIndex, sampleRate, frequency);
+
+			std::vector<double> rows(numStreams * rowLength);
+			std::vector<double> amplitudes(numStreams), phases(numStreams);
+			for (int stream = 0; stream < numStreams; ++stream)
+			{
+				amplitudes[stream] = 10.0 + 40.0 * stream;
+				phases[stream] = -3.0 + 0.4 * stream;
+				for (int t = 0; t < rowLength; ++t)
+				{
+					const double v = amplitudes[stream] * cos(twoPi * frequency / sampleRate * t + phases[stream]) + noise(generator);
+					rows[stream * rowLength + t] = 0.195 * floor(v / 0.195 + 0.5);
+				}
+			}
+
+			std::vector<double> realComponents(numStreams), imagComponents(numStreams);
+			lockIn.measure(rows.data(), numStreams, rowLength, realComponents.data(), imagComponents.data());
+
+			for (int stream = 0; stream < numStreams; ++stream)
+			{
+				const double re = realComponents[stream], im = imagComponents[stream];
+				// 5 uV of noise over the window is the bulk of the error on the smallest amplitudes
+				const double tolerance = 5.0 * 5.0 / sqrt(double(endIndex - startIndex + 1)) + 0.01 * amplitudes[stream];
+				const double amplitudeError = fabs(sqrt(re * re + im * im) - amplitudes[stream]);
+				const double phaseErr = phaseError(atan2(im, re), phases[stream]);
+
+				double directRe, directIm;
+				directMeasure(&rows[stream * rowLength], startIndex, endIndex, sampleRate, frequency, directRe, directIm);
+				const double directError = std::max(fabs(directRe - re), fabs(directIm - im)) / amplitudes[stream];
+
+				worstAmplitude = std::max(worstAmplitude, amplitudeError / amplitudes[stream]);
+				worstPhase = std::max(worstPhase, phaseErr);
+				worstDirect = std::max(worstDirect, directError);
+
+				if (amplitudeError > tolerance || phaseErr > tolerance / amplitudes[stream] || directError > 1e-9)
+				{
+					printf("FAIL: %g Hz at %g samples/s, stream %d: amplitude %g (expected %g), phase %g (expected %g), %g from the direct measurement\n",
+						frequency, sampleRate, stream, sqrt(re * re + im * im), amplitudes[stream], atan2(im, re), phases[stream], directError);
+					return 1;
+				}
+				++numCases;
+			}
+		}
+	}
+
+	printf("%d cases: worst amplitude error %.3g%%, worst phase error %.3g degrees, %.3g from the direct measurement\n",
+		numCases, 100 * worstAmplitude, worstPhase * 360 / twoPi, worstDirect);
+
+	// one stream of a 20 ms measurement at 30 kS/s
+	const int rowLength = samplesPerBlock * 10;
+	std::vector<double> row(rowLength);
+	for (int t = 0; t < rowLength; ++t)
+		row[t] = noise(generator);
+	ImpedanceLockIn lockIn;
+	lockIn.setWindow(0, rowLength - 1, 30000, 1000);
+
+	const int repeats = 20000;
+	double re, im, checksum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+	{
+		lockIn.measure(row.data(), 1, rowLength, &re, &im);
+		checksum += re;
+	}
+	const double lockInTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+	start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+	{
+		directMeasure(row.data(), 0, rowLength - 1, 30000, 1000, re, im);
+		checksum += re;
+	}
+	const double directTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+	printf("%d samples per row: lock-in %.2f us, direct %.2f us (checksum %g)\n", rowLength, lockInTime, directTime, checksum);
+
+	printf("OK: the lock-in recovers amplitude and phase\n");
+	return 0;
+}
@@ -0,0 +1,306 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Checks the compiled box and polygon masks against the geometric tests they replace.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-o box_polygon_mask_test Tests/SpikeSorter/box_polygon_mask_test.cpp \
+			Source/Plugins/SpikeSorter/SpikeSortGeometry.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp -lpthread -ldl -lrt
+		./box_polygon_mask_test
+
+	Run from the repository root. Units of 1 to 3 random boxes on 4 channels are compiled for
+	waveforms of 2 to 61 samples at 30 kHz or a random rate, and random waveforms are tested
+	with BoxUnitMask::isWaveFormInside and with Box::isWaveFormInsideAll, the test
+	BoxUnit::isWaveFormInsideAllBoxes runs. Some boxes have whole number or zero sizes, a
+	negative width, or edges placed exactly on sample times, and some waveforms have their
+	samples snapped onto, or one float step off, the top and bottom edges, huge values, or
+	an almost flat trace. Polygons of 0 to 14 vertices, at scales from 1e-3 to 1e3, are
+	compiled the same way and PolygonMask::isPointInside is compared with
+	cPolygon::isPointInside on random points, points on the vertical through a vertex, on an
+	edge, on the whole number grid, and NaN. Every answer must be the same.
+	Last, the time per spike and per point is compared with the geometric tests.
+	Exits with a non-zero status if any answer differs.
+*/
+
+#include "../../Source/Plugins/SpikeSorter/SpikeSortGeometry.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+	const int numChannels = 4;
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+	float random(float low, float high)
+	{
+		return low + uniform(rng) * (high - low);
+	}
+
+	std::vector<Box> randomUnit(float sampleRate, unsigned int totalSamples)
+	{
+		const float spikeTimeSpan = getSpikeTimeSpan(sampleRate, totalSamples);
+		std::vector<Box> boxes;
+		const int numBoxes = 1 + rng() % 3;
+		for (int b = 0; b < numBoxes; b++)
+		{
+			Box box(rng() % numChannels);
+			box.x = random(-0.2f, 1.2f) * spikeTimeSpan;
+			box.w = random(0.0f, 0.8f) * spikeTimeSpan;
+			box.y = random(-200.0f, 200.0f);
+			box.h = random(0.0f, 200.0f);
+			if (rng() % 10 == 0)
+			{
+				box.x = std::round(box.x);
+				box.w = std::round(box.w);
+				box.y = std::round(box.y);
+				box.h = std::round(box.h);
+			}
+			if (rng() % 10 == 0)
+			{
+				// left and right edges on sample times
+				const int first = rng() % totalSamples;
+				const int last = first + rng() % (totalSamples - first);
+				box.x = timeBinToMicrosecond(first, spikeTimeSpan, totalSamples);
+				box.w = timeBinToMicrosecond(last, spikeTimeSpan, totalSamples) - box.x;
+			}
+			if (rng() % 20 == 0)
+				box.h = 0;
+			if (rng() % 20 == 0)
+				box.w = -box.w;
+			boxes.push_back(box);
+		}
+		return boxes;
+	}
+
+	void randomWaveform(std::vector<float>& data, const std::vector<Box>& boxes)
+	{
+		for (int i = 0; i < int(data.size()); i++)
+			data[i] = random(-200.0f, 200.0f);
+
+		switch (rng() % 4)
+		{
+			case 1:
+				// on the top and bottom edges, or one float step away
+				for (int i = 0; i < int(data.size()); i++)
+				{
+					const Box& box = boxes[rng() % boxes.size()];
+					const float values[3] = { float(box.y), float(box.y - box.h), data[i] };
+					data[i] = values[rng() % 3];
+					if (rng() % 3 == 0)
+						data[i] = std::nextafter(data[i], (rng() % 2) ? 1e9f : -1e9f);
+				}
+				break;
+			case 2:
+				for (int i = 0; i < int(data.size()); i++)
+					data[i] *= 1e4f;
+				break;
+			case 3:
+			{
+				const float base = random(-200.0f, 200.0f);
+				for (int i = 0; i < int(data.size()); i++)
+					data[i] = base + random(0.0f, 1e-3f);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	cPolygon randomPolygon(int iteration, float& scale, PointD& centre)
+	{
+		cPolygon polygon;
+		const int numPoints = rng() % 12 + (iteration % 50 == 0 ? 0 : 3);
+		scale = (iteration % 3 == 0) ? 1e-3f : ((iteration % 3 == 1) ? 1.0f : 1e3f);
+		centre = PointD(random(-5.0f, 5.0f) * scale, random(-5.0f, 5.0f) * scale);
+		for (int i = 0; i < numPoints; i++)
+		{
+			// star shaped or, on odd iterations, convex
+			const float angle = (iteration % 2) ? 2 * float_Pi * i / numPoints : random(0.0f, 2 * float_Pi);
+			const float radius = random(0.2f, 1.2f) * scale;
+			polygon.pts.push_back(PointD(centre.X + radius * std::cos(angle), centre.Y + radius * std::sin(angle)));
+		}
+		if (rng() % 5 == 0)
+		{
+			for (int i = 0; i < int(polygon.pts.size()); i++)
+				polygon.pts[i] = PointD(std::round(polygon.pts[i].X), std::round(polygon.pts[i].Y));
+		}
+		polygon.offset = PointD(random(-0.5f, 0.5f) * scale, random(-0.5f, 0.5f) * scale);
+		return polygon;
+	}
+
+	PointD randomPoint(const cPolygon& polygon, int index, float scale, const PointD& centre)
+	{
+		PointD p(centre.X + random(-2.0f, 2.0f) * scale, centre.Y + random(-2.0f, 2.0f) * scale);
+		const int numPoints = int(polygon.pts.size());
+		if (index % 50 == 7)
+			return PointD(NAN, p.Y);
+		if (numPoints == 0)
+			return p;
+
+		const int k = rng() % numPoints;
+		const PointD a = polygon.pts[k] + polygon.offset;
+		const PointD b = polygon.pts[(k + 1) % numPoints] + polygon.offset;
+		switch (index % 4)
+		{
+			case 0:
+				return PointD(a.X, p.Y);
+			case 1:
+			{
+				const float t = uniform(rng);
+				return PointD(a.X + t * (b.X - a.X), a.Y + t * (b.Y - a.Y));
+			}
+			case 2:
+				return PointD(std::round(p.X), std::round(p.Y));
+			default:
+				return p;
+		}
+	}
+
+	double nanosecondsSince(std::chrono::steady_clock::time_point start, int count)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+	}
+}
+
+int main()
+{
+	long numWaveforms = 0, numInside = 0, boxMismatches = 0;
+	float sampleRate = 30000.0f;
+	unsigned int totalSamples = 40;
+
+	for (int iteration = 0; iteration < 300000; iteration++)
+	{
+		if (iteration % 1000 == 0)
+		{
+			sampleRate = (uniform(rng) < 0.5f) ? 30000.0f : random(1000.0f, 41000.0f);
+			totalSamples = 2 + rng() % 60;
+		}
+
+		std::vector<Box> boxes = randomUnit(sampleRate, totalSamples);
+		BoxUnitMask mask;
+		mask.compile(boxes, sampleRate, totalSamples);
+
+		std::vector<float> data(numChannels * totalSamples);
+		for (int s = 0; s < 20; s++)
+		{
+			randomWaveform(data, boxes);
+			const bool expected = Box::isWaveFormInsideAll(boxes, data.data(), sampleRate, totalSamples);
+			const bool inside = mask.isWaveFormInside(data.data(), sampleRate, totalSamples);
+			numWaveforms++;
+			numInside += expected;
+			if (inside != expected)
+			{
+				if (boxMismatches == 0)
+					printf("FAIL: %u samples at %g Hz, box mask says %d, boxes say %d\n", totalSamples, sampleRate, inside, expected);
+				boxMismatches++;
+			}
+		}
+	}
+	printf("boxes: %ld waveforms, %ld inside, %ld mismatches\n", numWaveforms, numInside, boxMismatches);
+
+	long numPoints = 0, numPointsInside = 0, polygonMismatches = 0;
+	for (int iteration = 0; iteration < 20000; iteration++)
+	{
+		float scale;
+		PointD centre;
+		cPolygon polygon = randomPolygon(iteration, scale, centre);
+		PolygonMask mask;
+		mask.compile(polygon);
+
+		for (int s = 0; s < 200; s++)
+		{
+			const PointD p = randomPoint(polygon, s, scale, centre);
+			const bool expected = polygon.isPointInside(p);
+			const bool inside = mask.isPointInside(p);
+			numPoints++;
+			numPointsInside += expected;
+			if (inside != expected)
+			{
+				if (polygonMismatches == 0)
+					printf("FAIL: polygon of %d vertices, mask says %d for (%g, %g), polygon says %d\n",
+						int(polygon.pts.size()), inside, p.X, p.Y, expected);
+				polygonMismatches++;
+			}
+		}
+	}
+	printf("polygons: %ld points, %ld inside, %ld mismatches\n", numPoints, numPointsInside, polygonMismatches);
+
+	// two boxes on 4 channels of 40 samples at 30 kHz, as the sorter sees them
+	{
+		std::vector<Box> boxes;
+		boxes.push_back(Box(300, 50, 500, 100, 0));
+		boxes.push_back(Box(600, -20, 200, 60, 1));
+		BoxUnitMask mask;
+		mask.compile(boxes, 30000.0f, 40);
+
+		const int numSpikes = 1000, repeats = 200;
+		std::vector<float> data(numSpikes * numChannels * 40);
+		for (int i = 0; i < int(data.size()); i++)
+			data[i] = random(-100.0f, 100.0f);
+
+		int checksum = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; r++)
+			for (int s = 0; s < numSpikes; s++)
+				checksum += Box::isWaveFormInsideAll(boxes, &data[s * numChannels * 40], 30000.0f, 40);
+		const double geometric = nanosecondsSince(start, numSpikes * repeats);
+		start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; r++)
+			for (int s = 0; s < numSpikes; s++)
+				checksum -= mask.isWaveFormInside(&data[s * numChannels * 40], 30000.0f, 40);
+		printf("box unit: geometric %.1f ns, mask %.1f ns per spike (checksum %d)\n", geometric, nanosecondsSince(start, numSpikes * repeats), checksum);
+	}
+	{
+		cPolygon polygon;
+		for (int i = 0; i < 12; i++)
+			polygon.pts.push_back(PointD(std::cos(i * float_Pi / 6), std::sin(i * float_Pi / 6)));
+		PolygonMask mask;
+		mask.compile(polygon);
+
+		std::vector<PointD> points;
+		for (int i = 0; i < 100000; i++)
+			points.push_back(PointD(random(-1.5f, 1.5f), random(-1.5f, 1.5f)));
+
+		int checksum = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < int(points.size()); i++)
+			checksum += polygon.isPointInside(points[i]);
+		const double geometric = nanosecondsSince(start, points.size());
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < int(points.size()); i++)
+			checksum -= mask.isPointInside(points[i]);
+		printf("polygon: geometric %.1f ns, mask %.1f ns per point (checksum %d)\n", geometric, nanosecondsSince(start, points.size()), checksum);
+	}
+
+	if (boxMismatches > 0 || polygonMismatches > 0)
+		return 1;
+	printf("OK: the masks give the same answers as the geometric tests\n");
+	return 0;
+}
@@ -0,0 +1,366 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Checks the template matching sorter against ground truth on synthetic tetrode data.
+
+		g++ -std=c++11 -O2 -DLINUX=1 -I JuceLibraryCode -I JuceLibraryCode/modules -I Source/Plugins/Headers \
+			-o template_matching_test Tests/SpikeSorter/template_matching_test.cpp \
+			Source/Plugins/SpikeSorter/SpikeTemplates.cpp \
+			JuceLibraryCode/juce_core.cpp JuceLibraryCode/juce_audio_basics.cpp -lpthread -ldl -lrt
+		./template_matching_test [trials]
+
+	Run from the repository root. Every trial makes 2 to 4 units with random spike shapes on
+	4 channels of 40 samples, learns templates from a 200 spike buffer as the sorter does, and
+	matches 5000 new spikes of the same units with noise of 10 uV rms. Each template is mapped
+	to the unit most of its spikes came from. As a baseline, the same spikes are also sorted by
+	projecting on the first two principal components of the buffer and running k-means in 2D,
+	given the true number of units. The buffer is then learned again with 10% amplitude drift,
+	and the drifted templates must be recognised as the previous ones.
+
+	Last, the time to match a spike against 6 templates and to learn a library are measured.
+	Exits with a non-zero status if agreement with ground truth is below 98%, if fewer than
+	90% of the spikes are matched, or if a drifted unit is taken for a new one.
+*/
+
+#include "../../Source/Plugins/SpikeSorter/SpikeTemplates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	const int numChannels = 4;
+	const int samplesPerChannel = 40;
+	const int dim = numChannels * samplesPerChannel;
+	const int bufferSize = 200;
+	const int numTestSpikes = 5000;
+	const float noiseLevel = 10.0f;
+
+	Random random(7);
+
+	float gaussian()
+	{
+		//Box-Muller
+		const double u = jmax(1e-12, random.nextDouble());
+		return float(std::sqrt(-2.0 * std::log(u)) * std::cos(2 * double_Pi * random.nextDouble()));
+	}
+
+	// a negative peak followed by a slow positive rebound, with a random amplitude and width per channel
+	std::vector<float> makeShape()
+	{
+		std::vector<float> shape(dim);
+		for (int c = 0; c < numChannels; c++)
+		{
+			const float amplitude = -40.0f - random.nextInt(120);
+			const float width = 3.0f + random.nextInt(3);
+			for (int t = 0; t < samplesPerChannel; t++)
+			{
+				const float x = (t - 8) / width;
+				float v = amplitude * std::exp(-x * x);
+				if (t > 8)
+					v -= 0.3f * amplitude * std::exp(-(t - 14) * (t - 14) / 30.0f);
+				shape[c * samplesPerChannel + t] = v;
+			}
+		}
+		return shape;
+	}
+
+	// numSpikes noisy spikes of random units one after the other, and the unit of each
+	void makeSpikes(const std::vector<std::vector<float>>& shapes, int numSpikes, float drift,
+		std::vector<float>& spikes, std::vector<int>& units)
+	{
+		spikes.resize(numSpikes * dim);
+		units.resize(numSpikes);
+		for (int i = 0; i < numSpikes; i++)
+		{
+			units[i] = random.nextInt(int(shapes.size()));
+			for (int j = 0; j < dim; j++)
+				spikes[i * dim + j] = shapes[units[i]][j] * (1 + drift) + gaussian() * noiseLevel;
+		}
+	}
+
+	TemplateLibraryPtr buildLibrary(const TemplateLearner& learner, const TemplateLibrary* previous)
+	{
+		TemplateLibraryPtr library = new TemplateLibrary(dim);
+		const uint8 color[3] = { 255, 255, 255 };
+		for (int u = 0; u < learner.getNumUnits(); u++)
+		{
+			const int p = learner.getPreviousIndex(u);
+			library->addTemplate(learner.getTemplate(u), learner.getMaxDistance(u),
+				previous != nullptr && p >= 0 ? previous->getUnitID(p) : 100 + u, color);
+		}
+		return library;
+	}
+
+	// fraction of the labelled spikes whose label maps to their true unit, each label being
+	// mapped to the unit most of its spikes came from
+	double agreement(const std::vector<int>& labels, int numLabels, const std::vector<int>& units, int numUnits)
+	{
+		std::vector<int> counts(numLabels * numUnits, 0);
+		int labelled = 0;
+		for (size_t i = 0; i < labels.size(); i++)
+		{
+			if (labels[i] >= 0)
+			{
+				counts[labels[i] * numUnits + units[i]]++;
+				labelled++;
+			}
+		}
+		int correct = 0;
+		for (int l = 0; l < numLabels; l++)
+			correct += *std::max_element(counts.begin() + l * numUnits, counts.begin() + (l + 1) * numUnits);
+		return labelled > 0 ? double(correct) / labelled : 0;
+	}
+
+	// first two principal components of the buffer by power iteration, then k-means in 2D
+	std::vector<int> pcaLabels(const std::vector<float>& buffer, const std::vector<float>& spikes, int numUnits)
+	{
+		std::vector<double> mean(dim, 0);
+		for (int i = 0; i < bufferSize; i++)
+			for (int j = 0; j < dim; j++)
+				mean[j] += buffer[i * dim + j] / bufferSize;
+
+		std::vector<double> pcs[2];
+		for (int p = 0; p < 2; p++)
+		{
+			std::vector<double> v(dim);
+			for (int j = 0; j < dim; j++)
+				v[j] = random.nextDouble() - 0.5;
+			for (int iteration = 0; iteration < 200; iteration++)
+			{
+				std::vector<double> w(dim, 0);
+				for (int i = 0; i < bufferSize; i++)
+				{
+					double s = 0;
+					for (int j = 0; j < dim; j++)
+						s += (buffer[i * dim + j] - mean[j]) * v[j];
+					for (int j = 0; j < dim; j++)
+						w[j] += s * (buffer[i * dim + j] - mean[j]);
+				}
+				for (int q = 0; q < p; q++)
+				{
+					double s = 0;
+					for (int j = 0; j < dim; j++)
+						s += w[j] * pcs[q][j];
+					for (int j = 0; j < dim; j++)
+						w[j] -= s * pcs[q][j];
+				}
+				double norm = 0;
+				for (int j = 0; j < dim; j++)
+					norm += w[j] * w[j];
+				norm = std::sqrt(norm);
+				for (int j = 0; j < dim; j++)
+					v[j] = w[j] / norm;
+			}
+			pcs[p] = v;
+		}
+
+		auto project = [&](const float* spike, double* point)
+		{
+			point[0] = point[1] = 0;
+			for (int j = 0; j < dim; j++)
+			{
+				point[0] += (spike[j] - mean[j]) * pcs[0][j];
+				point[1] += (spike[j] - mean[j]) * pcs[1][j];
+			}
+		};
+		auto nearest = [&](const double* point, const std::vector<double>& centers, double& distance)
+		{
+			int best = 0;
+			distance = 1e300;
+			for (int k = 0; k < numUnits; k++)
+			{
+				const double dx = point[0] - centers[2 * k], dy = point[1] - centers[2 * k + 1];
+				if (dx * dx + dy * dy < distance)
+				{
+					distance = dx * dx + dy * dy;
+					best = k;
+				}
+			}
+			return best;
+		};
+
+		std::vector<double> points(2 * bufferSize);
+		for (int i = 0; i < bufferSize; i++)
+			project(&buffer[i * dim], &points[2 * i]);
+
+		double bestError = 1e300;
+		std::vector<double> bestCenters;
+		for (int attempt = 0; attempt < 10; attempt++)
+		{
+			std::vector<double> centers(2 * numUnits);
+			for (int k = 0; k < numUnits; k++)
+			{
+				const int i = random.nextInt(bufferSize);
+				centers[2 * k] = points[2 * i];
+				centers[2 * k + 1] = points[2 * i + 1];
+			}
+			double error = 0;
+			for (int iteration = 0; iteration < 50; iteration++)
+			{
+				std::vector<double> sums(2 * numUnits, 0);
+				std::vector<int> counts(numUnits, 0);
+				error = 0;
+				for (int i = 0; i < bufferSize; i++)
+				{
+					double distance;
+					const int k = nearest(&points[2 * i], centers, distance);
+					sums[2 * k] += points[2 * i];
+					sums[2 * k + 1] += points[2 * i + 1];
+					counts[k]++;
+					error += distance;
+				}
+				for (int k = 0; k < numUnits; k++)
+				{
+					if (counts[k] > 0)
+					{
+						centers[2 * k] = sums[2 * k] / counts[k];
+						centers[2 * k + 1] = sums[2 * k + 1] / counts[k];
+					}
+				}
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				bestCenters = centers;
+			}
+		}
+
+		const int numSpikes = int(spikes.size()) / dim;
+		std::vector<int> labels(numSpikes);
+		for (int i = 0; i < numSpikes; i++)
+		{
+			double point[2], distance;
+			project(&spikes[i * dim], point);
+			labels[i] = nearest(point, bestCenters, distance);
+		}
+		return labels;
+	}
+
+	double secondsSince(int64 ticks)
+	{
+		return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - ticks);
+	}
+
+	void benchmark()
+	{
+		std::vector<float> spikes(bufferSize * dim);
+		for (size_t i = 0; i < spikes.size(); i++)
+			spikes[i] = gaussian() * 30;
+
+		TemplateLibraryPtr library = new TemplateLibrary(dim);
+		const uint8 color[3] = { 255, 255, 255 };
+		for (int k = 0; k < 6; k++)
+			library->addTemplate(&spikes[k * dim], 1e9f, k, color);
+
+		const int repeats = 5000;
+		int checksum = 0;
+		int64 start = Time::getHighResolutionTicks();
+		for (int r = 0; r < repeats; r++)
+			for (int i = 0; i < bufferSize; i++)
+				checksum += library->match(&spikes[i * dim]);
+		printf("match, 6 templates of %d samples: %.1f ns per spike (checksum %d)\n",
+			dim, secondsSince(start) * 1e9 / (double(repeats) * bufferSize), checksum);
+
+		TemplateLearner learner;
+		start = Time::getHighResolutionTicks();
+		learner.learn(spikes.data(), bufferSize, dim, nullptr);
+		printf("learning from %d spikes: %.1f ms\n", bufferSize, secondsSince(start) * 1e3);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int numTrials = argc > 1 ? jmax(1, atoi(argv[1])) : 60;
+
+	int64 totalSpikes = 0, totalMatched = 0;
+	double totalAgreement = 0, totalPca = 0;
+	int rightUnits = 0, driftFailures = 0;
+
+	for (int trial = 0; trial < numTrials; trial++)
+	{
+		const int numUnits = 2 + trial % 3;
+		std::vector<std::vector<float>> shapes;
+		for (int u = 0; u < numUnits; u++)
+			shapes.push_back(makeShape());
+
+		std::vector<float> buffer, spikes;
+		std::vector<int> bufferUnits, units;
+		makeSpikes(shapes, bufferSize, 0, buffer, bufferUnits);
+		makeSpikes(shapes, numTestSpikes, 0, spikes, units);
+
+		TemplateLearner learner;
+		learner.learn(buffer.data(), bufferSize, dim, nullptr);
+		TemplateLibraryPtr library = buildLibrary(learner, nullptr);
+
+		std::vector<int> labels(numTestSpikes);
+		int matched = 0;
+		for (int i = 0; i < numTestSpikes; i++)
+		{
+			labels[i] = library->match(&spikes[i * dim]);
+			matched += labels[i] >= 0;
+		}
+		const double templateAgreement = agreement(labels, library->getNumTemplates(), units, numUnits);
+		const double pcaAgreement = agreement(pcaLabels(buffer, spikes, numUnits), numUnits, units, numUnits);
+
+		//learning again after drift must keep every unit
+		std::vector<float> drifted;
+		makeSpikes(shapes, bufferSize, 0.1f, drifted, bufferUnits);
+		TemplateLearner relearner;
+		relearner.learn(drifted.data(), bufferSize, dim, library);
+		int kept = 0;
+		for (int u = 0; u < relearner.getNumUnits(); u++)
+			kept += relearner.getPreviousIndex(u) >= 0;
+		if (kept < library->getNumTemplates())
+			driftFailures++;
+
+		printf("trial %d: %d units, %d templates, matched %.1f%%, agreement %.2f%% (PCA %.2f%%), %d kept after drift\n",
+			trial, numUnits, library->getNumTemplates(), 100.0 * matched / numTestSpikes,
+			100 * templateAgreement, 100 * pcaAgreement, kept);
+
+		totalSpikes += numTestSpikes;
+		totalMatched += matched;
+		totalAgreement += templateAgreement;
+		totalPca += pcaAgreement;
+		rightUnits += library->getNumTemplates() == numUnits;
+	}
+
+	const double matchedFraction = double(totalMatched) / totalSpikes;
+	const double meanAgreement = totalAgreement / numTrials;
+	printf("matched %.1f%%, agreement %.2f%%, PCA baseline %.2f%%, right number of units %d/%d\n",
+		100 * matchedFraction, 100 * meanAgreement, 100 * totalPca / numTrials, rightUnits, numTrials);
+
+	benchmark();
+
+	if (meanAgreement < 0.98 || matchedFraction < 0.9 || driftFailures > 0)
+	{
+		printf("FAIL: agreement %.2f%%, matched %.1f%%, %d trials lost a unit after drift\n",
+			100 * meanAgreement, 100 * matchedFraction, driftFailures);
+		return 1;
+	}
+	printf("OK: template matching agrees with ground truth\n");
+	return 0;
+}